@@ -16,12 +16,24 @@
     #include "HAL_I2C.h"
     #include "MPU6050.h"
     #include "BSS.h"
-
-    volatile int count_flash = 0;
+    #include "scheduler.h"
+    #include "attitude.h"
+    #include "mountCalib.h"
+    #include "crash.h"
+    #include "bssFsm.h"
+    #include "lights.h"
+    #include <Hardware/SWTIMER_Driver.h>
+
+    static SWTIMER_Timer_t flashTimer;                  // software timer of the flashing
+    static uint16_t fifoReady = 0;                      // samples in the MPU6050 FIFO not read yet
+    static volatile uint8_t frontAmbient = LIGHTS_LEVEL_MAX;    // front light level for the ambient light
+    static uint8_t rearDrive = BSS_LIGHT_OFF;           // drive of the rear light at the last tick
 
 #else
 
     #include "BSS.h"
+    #include "crash.h"
+    #include "bssFsm.h"
     #include <unistd.h>
     // seconds between readings in test scaffold mode. 10 is the lower value to be able to read all info.
     #define INTERVAL_BETWEEN_READING_TEST   10              
@@ -60,6 +72,8 @@ const char* get_class_name(class_t class_enum) {
             return "CLASS_MOVING";
         case CLASS_LOW_AMBIENT_LIGHT:
             return "CLASS_LOW_AMBIENT_LIGHT";
+        case CLASS_CRASH:
+            return "CLASS_CRASH";
         default:
             return "Unknown Class";
     }
@@ -101,34 +115,49 @@ const char* get_class_name(class_t class_enum) {
         // Initialize I2C communication
         I2C_init();
 
-        // Initialization of the accelerometer sensor
+        // Initialization of the accelerometer and gyroscope sensor
         MPU6050_init();
 
+        // The attitude filter and the mounting calibration run at the sample rate of the FIFO
+        attitudeReset(MPU6050_SAMPLE_PERIOD_S);
+        mountCalibReset(MPU6050_SAMPLE_PERIOD_S);
+        crashReset(MPU6050_SAMPLE_PERIOD_S, MPU6050_ACCEL_LSB_PER_G);
+
         // I wait a little bit.
         __delay_cycles(100000);
     }
 
     void _ledInit()
     {
-        // Set front light to output direction
-        GPIO_setAsOutputPin(GPIO_PORT_FRONT_LIGHT,GPIO_PIN_FRONT_LIGHT);
-        // Set rear light to output direction
-        GPIO_setAsOutputPin(GPIO_PORT_REAR_LIGHT,GPIO_PIN_REAR_LIGHT);
+        // PWM of front and rear lights on TIMER_A2, both off
+        lightsInit();
     }
 
-    void _timerFlashInit(const Timer_A_UpModeConfig* upConfig)
+    void _buzzerInit()
     {
-        /* Configuring Timer_A1 for Up Mode */
-        Timer_A_configureUpMode(TIMER_A2_BASE, upConfig);
+        // Set buzzer to output direction, silent
+        GPIO_setAsOutputPin(GPIO_PORT_BUZZER,GPIO_PIN_BUZZER);
+        GPIO_setOutputLowOnPin(GPIO_PORT_BUZZER,GPIO_PIN_BUZZER);
+    }
 
-        /* Enabling interrupts and starting the timer */
-        Interrupt_enableInterrupt(INT_TA2_0);
+    static void flashTimerCallback(void* arg);
 
-        Timer_A_startCounter(TIMER_A2_BASE, TIMER_A_UP_MODE);
+    void _timerFlashInit()
+    {
+        // Periodic software timer, it runs in the TIMER_A1 interrupt
+        SWTIMER_Init();
+        SWTIMER_Create(&flashTimer, flashTimerCallback, NULL);
+        SWTIMER_StartPeriodic(&flashTimer, SWTIMER_MS(FLASH_PERIOD_MS));
+    }
 
+    void _timerFlashSetPeriod(uint16_t ms)
+    {
+        // Longer windows to save power: the state machine counts its durations in the new windows
+        SWTIMER_StartPeriodic(&flashTimer, SWTIMER_MS(ms));
+        bssFsmSetPeriod(ms);
     }
 
-    void _BSSInit(const Timer_A_UpModeConfig* upConfig)
+    void _BSSInit()
     {
         // Halting WDT and disabling master interrupts
         WDT_A_holdTimer();
@@ -150,52 +179,59 @@ const char* get_class_name(class_t class_enum) {
         
         _MPU6050SensorInit();
         _ledInit();
-        _timerFlashInit(upConfig);
+        _buzzerInit();
+        bssFsmInit();
+        _timerFlashInit();
         __delay_cycles(100000);
     }
 
-    __attribute__ ((always_inline)) inline void frontLightUp()
+    __attribute__ ((always_inline)) inline void buzzerOn()
     {
-        GPIO_setOutputHighOnPin(GPIO_PORT_FRONT_LIGHT,GPIO_PIN_FRONT_LIGHT);            // Set front light HIGH
+        GPIO_setOutputHighOnPin(GPIO_PORT_BUZZER,GPIO_PIN_BUZZER);                      // Set buzzer HIGH
     }
 
-    __attribute__ ((always_inline)) inline void rearLightUp()
+    __attribute__ ((always_inline)) inline void buzzerOff()
     {
-        GPIO_setOutputHighOnPin(GPIO_PORT_REAR_LIGHT,GPIO_PIN_REAR_LIGHT);              // Set rear light HIGH
-    }
-
-    __attribute__ ((always_inline)) inline void frontLightDown()
-    {
-        GPIO_setOutputLowOnPin(GPIO_PORT_FRONT_LIGHT,GPIO_PIN_FRONT_LIGHT);             // Set front light LOW
-    }
-
-    __attribute__ ((always_inline)) inline void rearLightDown()
-    {
-        GPIO_setOutputLowOnPin(GPIO_PORT_REAR_LIGHT,GPIO_PIN_REAR_LIGHT);               // Set rear light LOW
-    }
-
-    __attribute__ ((always_inline)) inline void toggleFrontLight()
-    {
-        GPIO_toggleOutputOnPin(GPIO_PORT_FRONT_LIGHT,GPIO_PIN_FRONT_LIGHT);             // toggle front light
-    }
-
-    __attribute__ ((always_inline)) inline void toggleRearLight()
-    {
-        GPIO_toggleOutputOnPin(GPIO_PORT_REAR_LIGHT,GPIO_PIN_REAR_LIGHT);               // toggle rear light
+        GPIO_setOutputLowOnPin(GPIO_PORT_BUZZER,GPIO_PIN_BUZZER);                       // Set buzzer LOW
     }
 
 #endif
 
-void accel_sample(accelReading* result){            // This function read accelerations along x, y, z axis and save it in result, that is a structured variable defined before. 
+bool accel_sample(accelReading* result){            // This function read accelerations along x, y, z axis and save it in result, that is a structured variable defined before. 
     #ifdef SIMULATE_HARDWARE                            
         result->x = readAccelX();                       // read random - HID x acceleration  ----- 
         result->y = readAccelY();                       // read random - HID y acceleration       |--->  TEST SCAFFOLD
         result->z = readAccelZ();                       // read random - HID z acceleration  -----
     #else
-        result->x = MPU6050_readXvalue();               // read x acceleration from MPU6050 sensor
-        result->y = MPU6050_readYvalue();               // read y acceleration from MPU6050 sensor
-        result->z = MPU6050_readZvalue();               // read z acceleration from MPU6050 sensor
+        int16_t raw[6];
+        float accel[3], gyro[3], linear[3];
+        int i;
+        for(i = 0; fifoReady == 0; i++){                // wait the next sample of the fixed rate, at most about MPU6050_SAMPLE_PERIOD_S
+            if(i == FIFO_WAIT_POLLS){
+                return false;                           // sensor stopped or I2C failing: the BSS task does not hang on it
+            }
+            fifoReady = MPU6050_fifoSamples();
+        }
+        --fifoReady;
+        MPU6050_readFifoRaw(raw);                       // burst read of accelerations and angular rates from MPU6050 sensor
+        for(i = 0; i < 3; i++){
+            accel[i] = raw[i] / MPU6050_ACCEL_LSB_PER_G;
+        }
+        mountCalibAddSample(accel);                     // mounting calibration in the sensor frame
+        mountCalibRotate(&raw[0]);                      // fixed point rotation to the bike frame: x forward, z up
+        mountCalibRotate(&raw[3]);
+        crashAddSample(&raw[0]);                        // black box and impact detection on the raw counts
+        for(i = 0; i < 3; i++){
+            accel[i] = raw[i] / MPU6050_ACCEL_LSB_PER_G;
+            gyro[i] = raw[i + 3] / MPU6050_GYRO_LSB_PER_DPS;
+        }
+        attitudeUpdate(accel, gyro);                    // lean, pitch and yaw rate
+        attitudeGetLinearAccel(linear);                 // accelerations without the gravity, independent of the mounting tilt
+        result->x = linear[0];
+        result->y = linear[1];
+        result->z = linear[2];
     #endif
+    return true;
 }
 
 void acquire_window(model_t* model){
@@ -203,17 +239,29 @@ void acquire_window(model_t* model){
     unsigned samplesInWindow = 0;                       // index for iterate sample on window array
 
     while(samplesInWindow < ACCEL_WINDOW_SIZE){         // Fill window array with ACCEL_WINDOW_SIZE sample element
-        accel_sample(&sample);                          // Save in sample values read from sensor
+        if(!accel_sample(&sample)){                     // Save in sample values read from sensor, a short window if it does not come
+            break;
+        }
         model->window[samplesInWindow++] = sample;      // Store element in index given, and increment it
     }  
+    #ifndef SIMULATE_HARDWARE
+        // The sensor clock is not the timer clock: the samples left in the FIFO go to the attitude filter as well, the window keeps the latest ones
+        while(fifoReady > 0){
+            accel_sample(&sample);
+            model->window[samplesInWindow++ % ACCEL_WINDOW_SIZE] = sample;
+        }
+    #endif
+    model->samples = samplesInWindow < ACCEL_WINDOW_SIZE ? samplesInWindow : ACCEL_WINDOW_SIZE;
 }
 
 void compute(model_t* model){
     float sum_acc_x = 0.0;                              // partial sum of x acceleration (initiated to zero)
-    for(int i=0; i<ACCEL_WINDOW_SIZE; i++){             // compute sum of all x acceleration in window array
+    for(unsigned i=0; i<model->samples; i++){           // compute sum of all x acceleration in window array
         sum_acc_x += model->window[i].x;
     }
-    model->averageAcc = (float) sum_acc_x / ACCEL_WINDOW_SIZE;      // save Average acceleration in model variable
+    if(model->samples > 0){                             // without samples the last average holds, the state machine does not see a release
+        model->averageAcc = (float) sum_acc_x / model->samples;     // save Average acceleration in model variable
+    }
 
     #ifdef SIMULATE_HARDWARE
         model->temp = rand_temp();
@@ -224,55 +272,13 @@ void compute(model_t* model){
 }
 
 
-void classify(model_t* model){                          // establish model class
-    switch(model->class){
-        case CLASS_IDLE:
-            count_flash = 0;
-            if(model->temp > T_MAX){
-                model->class = CLASS_ERROR;
-            }
-            else if(model->averageAcc < ACC_THREASHOLD){
-                model->class = CLASS_BRAKING;
-            }
-            else if(model->light < LIGHT_THREASHOLD){
-                model->class = CLASS_LOW_AMBIENT_LIGHT;
-            }else{
-                model->class = CLASS_MOVING;
-            }
-            break;
-        case CLASS_ERROR:
-            if(count_flash < NUM_FLASH){
-                model->class = CLASS_ERROR;
-            }else{
-                if(model->temp > T_MAX){
-                    model->class = CLASS_ERROR;
-                }else{
-                    model->class = CLASS_IDLE;
-                    count_flash = 0;
-                }
-            }
-            break;
-        case CLASS_BRAKING:
-            if(count_flash < NUM_FLASH){
-                model->class = CLASS_BRAKING;
-            }else{
-                model->class = CLASS_IDLE;
-                count_flash = 0;
-            }
-            break;
-        case CLASS_MOVING:
-            frontLightDown();
-            rearLightDown();
-            count_flash = 0;
-            model->class = CLASS_IDLE;
-            break;
-        case CLASS_LOW_AMBIENT_LIGHT:
-            rearLightUp();
-            frontLightUp();
-            count_flash = 0;
-            model->class = CLASS_IDLE;
-            break;
-    }
+void classify(model_t* model){                          // establish model class: one step of the state machine, the thresholds are in bssFsm.h
+    model->class = bssFsmStep(model, crashIsDetected());
+    #ifndef SIMULATE_HARDWARE
+        BssConfig_t config;
+        bssFsmGetConfig(&config);
+        frontAmbient = lightsAmbientLevel(model->light, config.lightOn);    // front brightness for the next ticks
+    #endif
 }
     
 
@@ -287,15 +293,19 @@ void classify(model_t* model){                          // establish model class
                 break;
             case CLASS_BRAKING:
                 printf("\t\t |\n\t\t ------> ");
-                printf(" BUZZER: low, REAR LIGHT: flash, FRONT LIGHT: -, LCD SCREEN: None");
+                printf(" BUZZER: low, REAR LIGHT: ramp up and hold, FRONT LIGHT: -, LCD SCREEN: None");
                 break;
             case CLASS_LOW_AMBIENT_LIGHT:
                 printf("\t\t |\n\t\t ------> ");
-                printf(" BUZZER: low, REAR LIGHT: High, FRONT LIGHT: high, LCD SCREEN: None");
+                printf(" BUZZER: low, REAR LIGHT: tail, FRONT LIGHT: ambient, LCD SCREEN: None");
                 break;
             case CLASS_MOVING:
                 printf("\t\t |\n\t\t ------> ");
-                printf(" BUZZER: low, REAR LIGHT: low, FRONT LIGHT: low, LCD SCREEN: None");
+                printf(" BUZZER: low, REAR LIGHT: day pulses, FRONT LIGHT: day flash, LCD SCREEN: None");
+                break;
+            case CLASS_CRASH:
+                printf("\t\t |\n\t\t ------> ");
+                printf(" BUZZER: pattern, REAR LIGHT: pattern, FRONT LIGHT: pattern, LCD SCREEN: None");
                 break;
             default:
                 break;
@@ -327,17 +337,77 @@ void classify(model_t* model){                          // establish model class
 
 #ifndef SIMULATE_HARDWARE
 
-    void TA2_0_IRQHandler(void)
+    static void rearLight(uint8_t drive, bool on)
     {
-        if(model_BSS.class == CLASS_ERROR){
-            ++count_flash;
-            toggleRearLight();
-            toggleFrontLight();
-        }else if (model_BSS.class == CLASS_BRAKING){
-            ++count_flash;
-            toggleRearLight();
+        bool release = rearDrive == BSS_LIGHT_BRAKE && drive != BSS_LIGHT_BRAKE;   // end of braking: ramp to the next level
+        switch(drive){
+            case BSS_LIGHT_BRAKE:
+                if(rearDrive != BSS_LIGHT_BRAKE){
+                    lightsRampRear(LIGHTS_LEVEL_MAX);           // ramp up once, then hold
+                }
+                break;
+            case BSS_LIGHT_STEADY:
+                if(release){
+                    lightsRampRear(LIGHTS_TAIL_LEVEL);
+                }else if(!lightsRearBusy()){                    // a running ramp or pulse ends by itself
+                    lightsSetRear(LIGHTS_TAIL_LEVEL);
+                }
+                break;
+            case BSS_LIGHT_BLINK:
+                lightsSetRear(on ? LIGHTS_LEVEL_MAX : 0);
+                break;
+            case BSS_LIGHT_FLASH:
+                if(release){
+                    lightsRampRear(0);
+                }else if(on && !lightsRearBusy()){
+                    lightsPulseRear();                          // soft pulse played by the DMA
+                }
+                break;
+            default:
+                if(release){
+                    lightsRampRear(0);
+                }else if(!lightsRearBusy()){
+                    lightsSetRear(0);
+                }
+                break;
+        }
+        rearDrive = drive;
+    }
+
+    static void frontLight(uint8_t drive, bool on)
+    {
+        switch(drive){
+            case BSS_LIGHT_STEADY:
+                lightsSetFront(frontAmbient);                   // proportional to the ambient light
+                break;
+            case BSS_LIGHT_BLINK:
+                lightsSetFront(on ? LIGHTS_LEVEL_MAX : 0);
+                break;
+            case BSS_LIGHT_FLASH:
+                lightsSetFront(on ? LIGHTS_DAY_LEVEL : 0);      // daytime flash
+                break;
+            default:
+                lightsSetFront(0);
+                break;
+        }
+    }
+
+    static void flashTimerCallback(void* arg)
+    {
+        // Pattern of the class, from its entry: the state machine steps at the same rate
+        const BssPattern_t* pattern = bssFsmGetPattern(model_BSS.class);
+        uint8_t tick = 1u << (bssFsmGetDwell() % BSS_PATTERN_TICKS);
+        if(!(pattern->keep & BSS_OUT_REAR)){
+            rearLight(pattern->rearDrive, pattern->rear & tick);
+        }
+        if(!(pattern->keep & BSS_OUT_FRONT)){
+            frontLight(pattern->frontDrive, pattern->front & tick);
+        }
+        if(!(pattern->keep & BSS_OUT_BUZZER)){
+            (pattern->buzzer & tick) ? buzzerOn() : buzzerOff();
         }
-        Timer_A_clearCaptureCompareInterrupt(TIMER_A2_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+        // Run the BSS acquisition at the same rate of the flashing
+        schedPostEvent(SCHED_EVENT_BSS);
     }
 
 
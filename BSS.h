@@ -9,26 +9,28 @@
 #ifndef __BSS_H__
 #define __BSS_H__
 
+#include <stdbool.h>
+
 /*!
     @defgroup BSS_module BSS
     @{
 */
 
-// port 6.6 front light
-#define GPIO_PORT_FRONT_LIGHT   GPIO_PORT_P6            
-#define GPIO_PIN_FRONT_LIGHT    GPIO_PIN6
-// port 6.7 rear light
-#define GPIO_PORT_REAR_LIGHT    GPIO_PORT_P6            
-#define GPIO_PIN_REAR_LIGHT     GPIO_PIN7
+// front light on port 6.6 and rear light on port 6.7: PWM outputs of TIMER_A2, see lights.h
+// port 2.7 buzzer
+#define GPIO_PORT_BUZZER        GPIO_PORT_P2
+#define GPIO_PIN_BUZZER         GPIO_PIN7
 
 #define ACCEL_WINDOW_SIZE 10
-#define ACC_THREASHOLD -0.5
-#define LIGHT_THREASHOLD 30            
+#define FIFO_WAIT_POLLS 64                             // reads of the FIFO count for a sample not there yet, about a sample period of I2C at 400 kHz
+#define ACC_THREASHOLD -0.5                            // default braking threshold, tunable in BSS.CSV (see bssFsm.h)
+#define LIGHT_THREASHOLD 30                            // default light threshold, tunable in BSS.CSV
 #define ACC_MIN -4.5
 #define ACC_MAX 1.0
-#define NUM_FLASH 4
+#define NUM_FLASH 4                                    // default shortest braking and error flashing, in flashes
+#define FLASH_PERIOD_MS 150                            // flashing and BSS acquisition period
 #define T_MIN -20
-#define T_MAX 60
+#define T_MAX 60                                       // default error temperature, tunable in BSS.CSV
 
 
 
@@ -51,6 +53,7 @@ typedef enum {
     CLASS_BRAKING,                  // BSS active, so flash!
     CLASS_MOVING,                   // normal functionality, light off. 
     CLASS_LOW_AMBIENT_LIGHT,        // normal functionality, light on.
+    CLASS_CRASH,                    // crash detected, lights and buzzer alert until cleared
 }class_t;
 
 typedef threeAxis_t accelReading;
@@ -61,6 +64,7 @@ typedef accelReading accelWindow[ACCEL_WINDOW_SIZE];    //!< Windows of accelera
 */
 typedef struct {
     accelWindow window;     //!< Windows of accelerations
+    unsigned samples;       //!< samples in the window, fewer if the sensor stops giving them
     class_t class;          //!< class
     float averageAcc;       //!< average acceleration 
     double temp;            //!< temperature of sensor
@@ -136,51 +140,39 @@ const char* get_class_name(class_t class_enum);
     void _MPU6050SensorInit();
 
     /*!
-        @brief Initialize front and rear lights
+        @brief Initialize front and rear lights, PWM outputs of TIMER_A2
     */
     void _ledInit();
 
     /*!
-        @brief Initialize timer for flashing.
-        @param[in] timer_config: configuration of the timer to flash each 150 milliseconds.
-    */
-    void _timerFlashInit(const Timer_A_UpModeConfig* upConfig);
-
-    /*!
-        @brief Initialize BSS.
-        @param[in] timer_config: configuration of the timer to flash each 150 milliseconds.
+        @brief Initialize the software timer for flashing, each FLASH_PERIOD_MS milliseconds.
     */
-    void _BSSInit(const Timer_A_UpModeConfig* upConfig);
+    void _timerFlashInit();
 
     /*!
-        @brief Set HIGH front light
+        @brief Change the period of flashing and acquisition, set by the power governor (see power.h).
     */
-    __attribute__ ((always_inline)) inline void frontLightUp();
+    void _timerFlashSetPeriod(uint16_t ms);
 
     /*!
-        @brief Set HIGH rear light
-    */
-    __attribute__ ((always_inline)) inline void rearLightUp();
-
-    /*!
-        @brief Set DOWN front light
+        @brief Initialize BSS.
     */
-    __attribute__ ((always_inline)) inline void frontLightDown();
+    void _BSSInit();
 
     /*!
-        @brief Set DOWN rear light
+        @brief Initialize the buzzer
     */
-    __attribute__ ((always_inline)) inline void rearLightDown();
+    void _buzzerInit();
 
     /*!
-        @brief Toggle front light
+        @brief Set HIGH buzzer
     */
-    __attribute__ ((always_inline)) inline void toggleFrontLight();
+    __attribute__ ((always_inline)) inline void buzzerOn();
 
     /*!
-        @brief Toggle rear light
+        @brief Set DOWN buzzer
     */
-    __attribute__ ((always_inline)) inline void toggleRearLight();
+    __attribute__ ((always_inline)) inline void buzzerOff();
 
     /*!
         @brief Read light value from photoresistor
@@ -189,25 +181,26 @@ const char* get_class_name(class_t class_enum);
     double read_light_value();
 
     /*!
-        @brief Read light value from photoresistor.
+        @brief Read the next sample of the MPU6050 FIFO, rotate it to the bike frame, feed the crash detector, update the attitude and remove the gravity.
         @param[in] three_acc: set of x,y,z accelerations to sample.
+        @return false if the FIFO is still empty after FIFO_WAIT_POLLS reads of its count.
     */
-    void accel_sample(accelReading* result);
+    bool accel_sample(accelReading* result);
 
     /*!
-        @brief Acquire a window of accelerations and save it into model struct passed.
+        @brief Acquire a window of accelerations and save it into model struct passed, a short window if the sensor stops.
         @param[in] model: model of an instant.
     */
     void acquire_window(model_t* model);
 
     /*!
-        @brief Compute average acceleration and save light and temperature of the sensor into model passed.
+        @brief Compute average acceleration and save light and temperature of the sensor into model passed, an empty window keeps the last average.
         @param[in] model: model of an instant.
     */
     void compute(model_t* model);
 
     /*!
-        @brief Classify status of the bike and manage it.
+        @brief Classify status of the bike with the state machine of bssFsm.h, the lights follow the pattern of the class.
         @param[in] model: model of an instant.
     */
     void classify(model_t* model);
@@ -1,4 +1,6 @@
 #include "MSPIO.h"
+#include <string.h>
+#include <numFormat.h>
 
 void PrintChar(uint32_t UART, char c)
 {
@@ -8,52 +10,40 @@ void PrintChar(uint32_t UART, char c)
 
 void PrintString(uint32_t UART, char *string)
 {
-    /*while the string is not the null character*/
-    while(*string)
-    {
-        PrintChar(UART, *string);
-        string++;
-    }
+    /*The whole string is queued with a single write*/
+    UART_Write(UART, (uint8_t*)string, strlen(string));
 }
 
-/*Thanks! https://github.com/grbl/grbl/blob/master/grbl/print.c */
 void PrintInteger(uint32_t UART, int integer)
 {
-    if(integer == 0)
-    {
-        PrintChar(UART, '0');
-    }
+    char b[12];
 
-    if(integer < 0)
-    {
-        PrintChar(UART, '-');
-    }
-
-    char b[10];
-    int digit = integer;
+    numFormatInt(b, sizeof(b), integer, 1);
+    PrintString(UART, b);
+}
 
-    uint8_t i = 0;
-    while(digit)
-    {
-        b[i++] = digit % 10;
-        digit /= 10;
-    }
+void PrintFloat(uint32_t UART, double number, uint8_t fracDigits)
+{
+    char b[20];
 
-    while(i)
+    /*Out of range values are printed as "?" instead of pulling in the float printf*/
+    if(numFormatFloat(b, sizeof(b), (float)number, fracDigits) == 0)
     {
-        PrintChar(UART, '0' + b[i-1]);
-        i--;
+        PrintChar(UART, '?');
+        return;
     }
+    PrintString(UART, b);
 }
 
 /*A basic printf for the MSP432. In order to use it properly you need to initialize the correct UART peripheral.
  * The following formats are supported:
  * %c = for char variables
  * %s = for string variables
- * %i = for unsigned integers
+ * %i, %d = for integers
+ * %f = for float variables, with 6 fraction digits or with the precision given as %.Nf (N up to 6)
  * USAGE...
  *
- * MSPrintf(EUSCI_A0_BASE, "Formated string %c, %s, %i", character, string, integer)*/
+ * MSPrintf(EUSCI_A0_BASE, "Formated string %c, %s, %i, %.2f", character, string, integer, number)*/
 
 void MSPrintf(uint32_t UART, const char *fs, ...)
 {
@@ -61,17 +51,32 @@ void MSPrintf(uint32_t UART, const char *fs, ...)
     va_start(valist, fs);
     int i;
     char *s;
+    uint8_t precision;
+
+    const char *span;
 
     while(*fs)
     {
         if(*fs != '%')
         {
-            UART_Write(UART, (uint8_t*)fs, 1);
-            fs++;
+            /*Write the literal text up to the next format with a single write*/
+            span = fs;
+            while(*fs && *fs != '%')
+            {
+                fs++;
+            }
+            UART_Write(UART, (uint8_t*)span, fs - span);
         }
         else
         {
-            switch(*++fs)
+            precision = 6;
+            if(*++fs == '.' && fs[1] >= '0' && fs[1] <= '9')
+            {
+                precision = fs[1] - '0';
+                fs += 2;
+            }
+
+            switch(*fs)
             {
             case 'c':
                 i = va_arg(valist, int);
@@ -82,9 +87,13 @@ void MSPrintf(uint32_t UART, const char *fs, ...)
                 PrintString(UART, s);
                 break;
             case 'i':
+            case 'd':
                 i = va_arg(valist, int);
                 PrintInteger(UART, i);
                 break;
+            case 'f':
+                PrintFloat(UART, va_arg(valist, double), precision);
+                break;
             }
 
             ++fs;
@@ -22,18 +22,10 @@
 #include <stdio.h>
 #include <time.h>
 
+//The parsed sentences are printed only at the debug log level
+#include "log.h"
 #ifndef PRINTF
-    #ifndef SIMULATE_HARDWARE
-        #if !defined(DEBUG) || defined(STAND_ALONE)
-            #define PRINTF(...)
-        #else
-            #include <Devices/MSPIO.h>
-            #define PRINTF(...) MSPrintf(EUSCI_A0_BASE ,__VA_ARGS__)
-        #endif
-    #else
-        #include <stdio.h>
-        #define PRINTF(...) printf(__VA_ARGS__)
-    #endif
+    #define PRINTF(...) LOG_DEBUG(__VA_ARGS__)
 #endif
 /*!
     @addtogroup GPS_Module
@@ -46,6 +38,11 @@
 /* Local Includes*/
 #include "GPS.h"
 #include "GPX.h"
+#include "numFormat.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "energy.h"
+#include "rtc.h"
 #ifndef SIMULATE_HARDWARE
 #include <DMAModule.h>
 #endif
@@ -59,6 +56,9 @@ GpsGSAData_t gpsGSAData;                    //!< GSA data
 GpsGSVData_t gpsGSVData;                    //!< GSV data
 GpsVTGData_t gpsVTGData;                    //!< VTG data
 
+static float gpsLatitude;                   //!< Last GGA latitude in degrees, kept as number for the telemetry
+static float gpsLongitude;                  //!< Last GGA longitude in degrees
+
 #ifndef SIMULATE_HARDWARE
 
 /**
@@ -164,10 +164,29 @@ void gpsDMARestoreChannel(void){
 	            so it wakes up the CPU for processing the data by setting the gpsStringEnd flag
 */
 void DMA_INT1_IRQHandler(void){
+    PROF_ENTER(PROF_ISR_DMA_INT1);
 	//Set the gpsStringEnd flag
     gpsStringEnd = true;
+    ENERGY_COUNT(ENERGY_GPS_UART, RX_BUFFER_SIZE);
+    schedPostEvent(SCHED_EVENT_GPS);
     // Disable the interrupt to allow execution
     MAP_Interrupt_disableSleepOnIsrExit();
+    PROF_EXIT(PROF_ISR_DMA_INT1);
+}
+
+/*!
+    @brief      Change the period of the fixes of the L80
+    @details    The command is short, it is sent polling the TX buffer of the UART: the RX goes on by
+                DMA. The module answers with a PMTK001 sentence, dropped by the parser.
+    @param      ms: fix period, saturated to @ref GPS_FIX_PERIOD_MIN_MS and @ref GPS_FIX_PERIOD_MAX_MS
+*/
+void gpsSetFixPeriod(uint16_t ms){
+    char command[GPS_COMMAND_LEN];
+    size_t len = gpsFormatFixPeriod(command, sizeof(command), ms);
+    size_t i;
+    for(i = 0; i < len; ++i){
+        MAP_UART_transmitData(EUSCI_A2_BASE, (uint_fast8_t)command[i]);
+    }
 }
 
 #endif
@@ -209,6 +228,49 @@ bool nmeaChecksumValidate(const char* sentence, char** nextSentence){
     return false;
 }
 
+/*!
+    @brief      Fix period command
+    @param      buf: destination buffer, at least @ref GPS_COMMAND_LEN bytes
+    @param      size: size of the buffer, terminator included
+    @param      ms: fix period, saturated to @ref GPS_FIX_PERIOD_MIN_MS and @ref GPS_FIX_PERIOD_MAX_MS
+    @return     length of the sentence "$PMTK220,<ms>*<checksum>\r\n", 0 if it does not fit
+*/
+size_t gpsFormatFixPeriod(char* buf, size_t size, uint16_t ms){
+    static const char hex[] = "0123456789ABCDEF";
+    char value[8];
+    size_t valueLen, len, i;
+    uint8_t checksum = 0;
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    buf[0] = '\0';
+    if(ms < GPS_FIX_PERIOD_MIN_MS){
+        ms = GPS_FIX_PERIOD_MIN_MS;
+    }else if(ms > GPS_FIX_PERIOD_MAX_MS){
+        ms = GPS_FIX_PERIOD_MAX_MS;
+    }
+    valueLen = numFormatInt(value, sizeof(value), ms, 1);
+    len = 1 + sizeof(PMTK_SET_FIX_PERIOD) - 1 + 1 + valueLen;
+    if(valueLen == 0 || len + 5 + 1 > size){
+        return 0;
+    }
+    buf[0] = '$';
+    memcpy(buf + 1, PMTK_SET_FIX_PERIOD, sizeof(PMTK_SET_FIX_PERIOD) - 1);
+    buf[sizeof(PMTK_SET_FIX_PERIOD)] = ',';
+    memcpy(buf + sizeof(PMTK_SET_FIX_PERIOD) + 1, value, valueLen);
+    //Checksum of the characters between '$' and '*', as nmeaChecksumValidate
+    for(i = 1; i < len; ++i){
+        checksum ^= (uint8_t)buf[i];
+    }
+    buf[len++] = '*';
+    buf[len++] = hex[checksum >> 4];
+    buf[len++] = hex[checksum & 0x0F];
+    buf[len++] = '\r';
+    buf[len++] = '\n';
+    buf[len] = '\0';
+    return len;
+}
+
 /*!
     @brief    Get time from string
     @details  This function gets the time from a string
@@ -266,6 +328,25 @@ struct tm getDateFromString(const char* time, const char* date){
                        };
 }
 
+/*!
+    @brief    Get the milliseconds from a time string
+    @param    time: String in the format HHMMSS<.SSS>
+    @return   Milliseconds of the time, 0 if there is no fraction
+*/
+uint16_t getMillisFromString(const char* time){
+    const char* fraction = strchr(time, '.');
+    uint16_t ms = 0;
+    uint16_t scale = 100;
+    if(fraction == NULL){
+        return 0;
+    }
+    for(fraction++; *fraction >= '0' && *fraction <= '9' && scale > 0; fraction++){
+        ms += (uint16_t)(*fraction - '0') * scale;
+        scale /= 10;
+    }
+    return ms;
+}
+
 /*!
     @brief    Get latitude from string
     @details  This function gets the latitude from a string
@@ -370,8 +451,10 @@ void gpsParseData(const char* packet){
                     if(fields[4][0] == 'W'){
                         longitude *= -1;
                     }
-                    snprintf(gpsGGAData.latitude, 12, "%f", latitude);
-                    snprintf(gpsGGAData.longitude, 12, "%f", longitude);
+                    numFormatCoordinate(gpsGGAData.latitude, sizeof(gpsGGAData.latitude), latitude);
+                    numFormatCoordinate(gpsGGAData.longitude, sizeof(gpsGGAData.longitude), longitude);
+                    gpsLatitude = latitude;
+                    gpsLongitude = longitude;
                     //Fix
                     gpsGGAData.fix = (GGAFixData_t)atoi(fields[5]);
                     //Satellites
@@ -401,8 +484,8 @@ void gpsParseData(const char* packet){
                     if(fields[5][0] == 'W'){
                         longitude *= -1;
                     }
-                    snprintf(gpsRMCData.latitude, 12, "%f", latitude);
-                    snprintf(gpsRMCData.longitude, 12, "%f", longitude);
+                    numFormatCoordinate(gpsRMCData.latitude, sizeof(gpsRMCData.latitude), latitude);
+                    numFormatCoordinate(gpsRMCData.longitude, sizeof(gpsRMCData.longitude), longitude);
                     //Valid
                     gpsRMCData.valid = fields[1][0] == 'A';
                     //Speed
@@ -411,6 +494,10 @@ void gpsParseData(const char* packet){
                     strcpy(gpsRMCData.course, fields[7]);
                     //Date
                     gpsRMCData.timeInfo = getDateFromString(fields[0], fields[8]);
+                    gpsRMCData.timeMs = getMillisFromString(fields[0]);
+                    if(gpsRMCData.valid){
+                        rtcSync(&gpsRMCData.timeInfo, gpsRMCData.timeMs);
+                    }
                     //Others
                     strcpy(gpsRMCData.others, fields[9]);
 
@@ -514,6 +601,35 @@ void getGpsData(int* sats, float* gpsSpeed, float* gpsAltitude, float* gpsHdop){
     *gpsHdop = atof(gpsGGAData.hdop);
 }
 
+/*!
+    @brief    Get the last position
+    @param    latitude: degrees, negative for S
+    @param    longitude: degrees, negative for W
+    @return   GGA fix type, INVALID if the position is not valid
+*/
+GGAFixData_t getGpsPosition(float* latitude, float* longitude){
+    *latitude = gpsLatitude;
+    *longitude = gpsLongitude;
+    return gpsGGAData.fix;
+}
+
+/*!
+    @brief    Get the course over ground of the last RMC sentence
+    @return   degrees clockwise from the north, not meaningful when the receiver is still
+*/
+float getGpsCourse(void){
+    return atof(gpsRMCData.course);
+}
+
+/*!
+    @brief    The last fix is good enough for the track: 2D or 3D, RMC valid and HDOP under 4
+*/
+bool gpsFixIsValid(void){
+    float hdop = atof(gpsGGAData.hdop);
+    int fix = atoi(gpsGSAData.fix);
+    return fix > 1 && gpsRMCData.valid && hdop < 4;
+}
+
 GpsGGAData_t* getGGAData(void){
     return &gpsGGAData;
 }
@@ -540,19 +656,14 @@ GpsVTGData_t* getVTGData(void){
 */
 bool addPointToGPXFromGPS(FILE_TYPE file){
     static bool fixOk = false;
-    float hdop = atof(gpsGGAData.hdop);
-    int fix = atoi(gpsGSAData.fix);
-    if(fix > 1 && gpsRMCData.valid && hdop < 4){
+    if(gpsFixIsValid()){
         fixOk = true;
-        char timeString[20];
-        //Convert time to string ISO 8601
-        snprintf(timeString, 20, "%d-%02d-%02dT%02d:%02d:%02dZ", gpsRMCData.timeInfo.tm_year + 1900,
-                                                                gpsRMCData.timeInfo.tm_mon + 1,
-                                                                gpsRMCData.timeInfo.tm_mday,
-                                                                gpsRMCData.timeInfo.tm_hour,
-                                                                gpsRMCData.timeInfo.tm_min,
-                                                                gpsRMCData.timeInfo.tm_sec);
-        GPXAddTrackPoint(file, gpsGGAData.latitude, gpsGGAData.longitude, gpsGGAData.altitude, timeString);
+        char timeString[NUMFORMAT_ISO8601_MS_LEN];
+        //Time of the fix in ISO 8601, with the milliseconds of the GPS faster than 1 Hz
+        numFormatISO8601Ms(timeString, sizeof(timeString), &gpsRMCData.timeInfo, gpsRMCData.timeMs);
+        PROF_ENTER(PROF_GPX_ADD_POINT);
+        GPXAddTrackPoint(file, gpsGGAData.latitude, gpsGGAData.longitude, gpsGGAData.altitude, timeString, gpsGSAData.vdop);
+        PROF_EXIT(PROF_GPX_ADD_POINT);
         return true;
     }else{
         PRINTF("Point Not Added because GPS has no valid FIX!\n");
@@ -61,6 +61,12 @@
 #define RX_BUFFER_SIZE 512                  //! Size of RX buffer
                                             //! Uesed also by DMA as max buffer length
 
+//GPS commands
+#define PMTK_SET_FIX_PERIOD "PMTK220"       //! Period of the fixes in ms, from 100 to 10000
+#define GPS_FIX_PERIOD_MIN_MS 100           //! Shortest fix period of the L80
+#define GPS_FIX_PERIOD_MAX_MS 10000         //! Longest fix period of the L80
+#define GPS_COMMAND_LEN 32                  //! Buffer size of a command
+
 //GGA fix data
 typedef enum {INVALID = 0, GPS_FIX, DGPS, GPS_PPS, IRTK, FRTK, DEAD_RECKONING, MANUAL, SIMULATED} GGAFixData_t;
 
@@ -85,6 +91,7 @@ typedef struct{
     char speed[8];                          //! Speed in knots
     char course[8];                         //! Course
     struct tm timeInfo;                     //! Time info
+    uint16_t timeMs;                        //! Milliseconds of the time, for the GPS faster than 1 Hz
     char others[6];                         //! Others fields
 } GpsRMCData_t;
 
@@ -129,11 +136,14 @@ extern volatile bool gpsStringEnd;
 void gpsUartConfig(void);
 void gpsDMAConfiguration(void);
 void gpsDMARestoreChannel(void);
+void gpsSetFixPeriod(uint16_t ms);
 #endif
 
 bool nmeaChecksumValidate(const char* sentence, char** nextSentence);
+size_t gpsFormatFixPeriod(char* buf, size_t size, uint16_t ms);
 time_t getTimeFromString(const char* str);
 struct tm getDateFromString(const char* time, const char* date);
+uint16_t getMillisFromString(const char* time);
 float getLatitudeFromString(char* str);
 float getLongitudeFromString(char* str);
 char* splitString(char* str, char delim, char** next);
@@ -142,9 +152,12 @@ void gpsParseData(const char* packet);
 
 //Getter functions
 void getGpsData(int* sats, float* speed, float* altitude, float* hdop);
+GGAFixData_t getGpsPosition(float* latitude, float* longitude);
+float getGpsCourse(void);
+bool gpsFixIsValid(void);
 // GpsGGAData_t* getGGAData(void);
 // GpsRMCData_t* getRMCData(void);
-// GpsGSAData_t* getGSAData(void);
+GpsGSAData_t* getGSAData(void);
 // GpsGSVData_t* getGSVData(void);
 // GpsVTGData_t* getVTGData(void);
 
@@ -9,6 +9,7 @@
 
 */
 #include "GPX.h"
+#include "profiler.h"
 #include <stdio.h>
 
 /*!
@@ -45,6 +46,19 @@ const char* GPX_TRACK_POINT = "\
             <trkpt lat=\"%s\" lon=\"%s\">\n\
                 <ele>%s</ele>\n\
                 <time>%s</time>\n\
+                <vdop>%s</vdop>\n\
+            </trkpt>\n";
+
+/*!
+    @brief      GPX Estimated Track Point Constant String
+    @details    Constant string of a track point estimated without the GPS (dead reckoning): the
+                fix is "none" and there is no dilution of precision
+*/
+const char* GPX_TRACK_POINT_ESTIMATED = "\
+            <trkpt lat=\"%s\" lon=\"%s\">\n\
+                <ele>%s</ele>\n\
+                <time>%s</time>\n\
+                <fix>none</fix>\n\
             </trkpt>\n";
 
 /*!
@@ -66,6 +80,10 @@ const char* GPX_METADATA = "\
     @brief      GPXInitFile
     @details    Initializes a GPX file with the given filename and populates the handler,
                 it also adds the header to the file.
+                On the SD card f_expand looks for GPX_PREALLOC_SIZE of free contiguous clusters while the
+                file is still empty, as it needs: with opt 0 nothing is allocated, the start of the area
+                only becomes the point of the next allocations, so the file grows in sequence without
+                searching the FAT. If there is no such area the file grows as usual.
     @param      file: Pointer to the file handler
     @param      filename: Name of the file to be created
 
@@ -80,7 +98,8 @@ void GPXInitFile(FILE_TYPE file, const char* filename){
         if(r != FR_OK){
             return;
         }
-        f_printf(file, "%s", GPX_HEADER);
+        f_expand(file, GPX_PREALLOC_SIZE, 0);
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "%s", GPX_HEADER));
     #else
         *file = fopen(filename, "w");
         if(*file == NULL){
@@ -103,7 +122,7 @@ void GPXInitFile(FILE_TYPE file, const char* filename){
 */
 void GPXAddTrackName(FILE_TYPE file, const char* name){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t\t<name>%s</name>\n", name);
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t<name>%s</name>\n", name));
     #else
         if(*file == NULL){
             return;
@@ -124,7 +143,7 @@ void GPXAddTrackName(FILE_TYPE file, const char* name){
 */
 void GPXAddTrackType(FILE_TYPE file, const char* type){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t\t<type>%s</type>\n", type);
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t<type>%s</type>\n", type));
     #else
         if(*file == NULL){
             return;
@@ -147,8 +166,8 @@ void GPXAddTrackType(FILE_TYPE file, const char* type){
 */
 void GPXAddTrack(FILE_TYPE file, const char* time){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, GPX_METADATA, time);
-        f_printf(file, "\t<trk>\n");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, GPX_METADATA, time));
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t<trk>\n"));
     #else
         if(*file == NULL){
             return;
@@ -169,7 +188,7 @@ void GPXAddTrack(FILE_TYPE file, const char* time){
 */
 void GPXAddTrackSegment(FILE_TYPE file){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t\t<trkseg>\n");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t<trkseg>\n"));
     #else
         if(*file == NULL){
             return;
@@ -190,8 +209,8 @@ void GPXAddTrackSegment(FILE_TYPE file){
 */
 void GPXAddNewTrackSegment(FILE_TYPE file){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t\t</trkseg>\n");
-        f_printf(file, "\t\t<trkseg>\n");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t</trkseg>\n"));
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t<trkseg>\n"));
     #else
         if(file == NULL){
             return;
@@ -209,19 +228,44 @@ void GPXAddNewTrackSegment(FILE_TYPE file){
     @param      lon: Longitude of the track point
     @param      ele: Elevation of the track point
     @param      time: Time of the track point
+    @param      vdop: VDOP of the fix, used by the host tools to weight the elevation
+
+    @note       The function will not close the file handler, it is the responsibility of the caller
+                to do so by calling @ref GPXCloseFile
+    @pre        @ref GPXInitFile must be called before this function
+*/
+void GPXAddTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time, const char* vdop){
+    #ifndef SIMULATE_HARDWARE
+        PROF_CALL(PROF_F_WRITE, f_printf(file, GPX_TRACK_POINT, lat, lon, ele, time, vdop));
+    #else
+        if(*file == NULL){
+            return;
+        }
+        fprintf(*file, GPX_TRACK_POINT, lat, lon, ele, time, vdop);
+    #endif
+}
+
+/*!
+    @brief      GPXAddEstimatedTrackPoint
+    @details    Adds a track point estimated without the GPS, flagged with a "none" fix
+    @param      file: Pointer to the file handler
+    @param      lat: Latitude of the track point
+    @param      lon: Longitude of the track point
+    @param      ele: Elevation of the track point
+    @param      time: Time of the track point
 
     @note       The function will not close the file handler, it is the responsibility of the caller
                 to do so by calling @ref GPXCloseFile
     @pre        @ref GPXInitFile must be called before this function
 */
-void GPXAddTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time){
+void GPXAddEstimatedTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, GPX_TRACK_POINT, lat, lon, ele, time);
+        PROF_CALL(PROF_F_WRITE, f_printf(file, GPX_TRACK_POINT_ESTIMATED, lat, lon, ele, time));
     #else
         if(*file == NULL){
             return;
         }
-        fprintf(*file, GPX_TRACK_POINT, lat, lon, ele, time);
+        fprintf(*file, GPX_TRACK_POINT_ESTIMATED, lat, lon, ele, time);
     #endif
 }
 
@@ -237,7 +281,7 @@ void GPXAddTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const ch
 */
 void GPXCloseTrackSegment(FILE_TYPE file){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t\t</trkseg>\n");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t\t</trkseg>\n"));
     #else
         if(*file == NULL){
             return;
@@ -257,7 +301,7 @@ void GPXCloseTrackSegment(FILE_TYPE file){
 */
 void GPXCloseTrack(FILE_TYPE file){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "\t</trk>\n");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "\t</trk>\n"));
     #else
         if(*file == NULL){
             return;
@@ -268,7 +312,7 @@ void GPXCloseTrack(FILE_TYPE file){
 
 /*!
     @brief      GPXCloseFile
-    @details    Closes the current file
+    @details    Closes the current file.
     @param      file: Pointer to the file handler
 
     @note       The function will not close the file handler, it is the responsibility of the caller
@@ -277,7 +321,7 @@ void GPXCloseTrack(FILE_TYPE file){
 */
 void GPXCloseFile(FILE_TYPE file){
     #ifndef SIMULATE_HARDWARE
-        f_printf(file, "</gpx>");
+        PROF_CALL(PROF_F_WRITE, f_printf(file, "</gpx>"));
         f_close(file);
     #else
         if(*file == NULL){
@@ -17,6 +17,7 @@
     #include <fatfs/ff.h>
     #include <fatfs/diskio.h>
     #define FILE_TYPE FIL*      //! Definition for file handler type in the MSP432 version
+    #define GPX_PREALLOC_SIZE   (2UL * 1024 * 1024)     //!< Free contiguous area looked for a ride, about 4 hours at 1 point/s
 
 #else
     #include <stdio.h>
@@ -40,7 +41,8 @@ void GPXAddTrack(FILE_TYPE file, const char* time);
 void GPXAddTrackSegment(FILE_TYPE file);
 void GPXAddNewTrackSegment(FILE_TYPE file);
 
-void GPXAddTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time);
+void GPXAddTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time, const char* vdop);
+void GPXAddEstimatedTrackPoint(FILE_TYPE file, const char* lat, const char* lon, const char* ele, const char* time);
 void GPXCloseTrackSegment(FILE_TYPE file);
 void GPXCloseTrack(FILE_TYPE file);
 void GPXCloseFile(FILE_TYPE file);
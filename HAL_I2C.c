@@ -7,6 +7,7 @@
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include "HAL_I2C.h"
+#include "energy.h"
 
 /*!
     @addtogroup I2C_module
@@ -76,6 +77,8 @@ int16_t I2C_read16(unsigned char writeByte)
     int val = 0;
     int valScratch = 0;
 
+    ENERGY_ON(ENERGY_I2C);
+
     /* Set master to transmit mode PL */
     I2C_setMode(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_MODE);
 
@@ -119,6 +122,8 @@ int16_t I2C_read16(unsigned char writeByte)
     /* Read from I2C RX Register and write to LSB of val */
     val |= valScratch;
 
+    ENERGY_OFF(ENERGY_I2C);
+
     /* Return temperature value */
     return (int16_t)val;
 }
@@ -126,6 +131,7 @@ int16_t I2C_read16(unsigned char writeByte)
 
 int8_t I2C_read8 (unsigned char writeByte)
 {
+    ENERGY_ON(ENERGY_I2C);
 
     I2C_setMode(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_MODE);                              // Sets the mode of the I2C device
 
@@ -139,10 +145,65 @@ int8_t I2C_read8 (unsigned char writeByte)
 
     int8_t val = I2C_masterReceiveSingleByte(EUSCI_B1_BASE);                            // Receives the byte, send STOP to Slave
 
+    ENERGY_OFF(ENERGY_I2C);
+
     return (int8_t)val;
 }
 
 
+/*
+
+  I2C BURST READ OPERATION:
+
+  @brief  Reads consecutive registers of the sensor in a single transaction
+  @param  writeByte Address of the first register to read from
+  @param  data Destination of the registers contents
+  @param  length Number of registers to read
+
+  Same sequence of I2C_read16, the sensor increments the register address after every byte
+  (the FIFO_R_W register is not incremented, it returns the next byte of the FIFO):
+
+      START --> SLAVE ADDRESS --> R/W = READ --> ACK --> DATA --> ACK --> ... --> DATA --> NACK --> STOP
+ */
+
+void I2C_readBurst(unsigned char writeByte, uint8_t* data, uint16_t length)
+{
+    uint16_t i;
+
+    if (length == 0)
+        return;
+
+    ENERGY_ON(ENERGY_I2C);
+
+    I2C_setMode(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_MODE);                              // Set master to transmit mode PL
+
+    I2C_clearInterruptFlag(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_INTERRUPT0);             // Clear any existing interrupt flag PL
+
+    while (I2C_isBusBusy(EUSCI_B1_BASE));                                               // Wait until ready to write PL
+
+    I2C_masterSendMultiByteStart(EUSCI_B1_BASE, writeByte);                             // Initiate start and send the first register
+
+    while(!(I2C_getInterruptStatus(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_INTERRUPT0)));   // Wait for TX to finish
+
+    I2C_masterSendMultiByteStop(EUSCI_B1_BASE);                                         // Initiate stop only
+
+    while(!I2C_getInterruptStatus(EUSCI_B1_BASE, EUSCI_B_I2C_STOP_INTERRUPT));          // Wait for Stop to finish
+
+    I2C_masterReceiveStart(EUSCI_B1_BASE);                                              // Start in receive mode, the slave sends until the STOP
+
+    for (i = 0; i < length - 1; i++)
+    {
+        while(!(I2C_getInterruptStatus(EUSCI_B1_BASE, EUSCI_B_I2C_RECEIVE_INTERRUPT0)));    // Wait for RX buffer to fill
+
+        data[i] = I2C_masterReceiveMultiByteNext(EUSCI_B1_BASE);                        // Read from I2C RX register
+    }
+
+    data[length - 1] = I2C_masterReceiveMultiByteFinish(EUSCI_B1_BASE);                 // Receive the last byte then send STOP condition
+
+    ENERGY_OFF(ENERGY_I2C);
+}
+
+
 /*
 
   I2C WRITE OPERATION:
@@ -163,6 +224,8 @@ int8_t I2C_read8 (unsigned char writeByte)
 
 void I2C_write16 (unsigned char pointer, unsigned int writeByte)
 {
+    ENERGY_ON(ENERGY_I2C);
+
     /* Set master to transmit mode PL */
     I2C_setMode(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_MODE);
 
@@ -180,10 +243,13 @@ void I2C_write16 (unsigned char pointer, unsigned int writeByte)
 
     I2C_masterSendMultiByteFinish(EUSCI_B1_BASE, (unsigned char)(writeByte&0xFF));
 
+    ENERGY_OFF(ENERGY_I2C);
 }
 
 void I2C_write8 (unsigned char pointer, unsigned int writeByte)
 {
+    ENERGY_ON(ENERGY_I2C);
+
     I2C_setMode(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_MODE);                          // Set master to transmit mode PL
 
     I2C_clearInterruptFlag(EUSCI_B1_BASE, EUSCI_B_I2C_TRANSMIT_INTERRUPT0);         // Clear any existing interrupt flag PL
@@ -193,6 +259,8 @@ void I2C_write8 (unsigned char pointer, unsigned int writeByte)
     I2C_masterSendMultiByteStart(EUSCI_B1_BASE, pointer);                           // Sends START, transmits the first data byte of a multi-byte transmission to the Slave
 
     I2C_masterSendMultiByteFinish(EUSCI_B1_BASE, (unsigned char)(writeByte));       // Transmits the last data byte of a multi-byte transmission to the Slave, Sends STOP
+
+    ENERGY_OFF(ENERGY_I2C);
 }
 
 
@@ -38,6 +38,14 @@ int16_t I2C_read16(unsigned char);
 */
 int8_t I2C_read8(unsigned char);
 
+/*!
+    @brief I2C read of consecutive registers in a single transaction
+    @param[in] reg_to_read: first register to read in accelerometer
+    @param[out] data: values read from the registers
+    @param[in] length: number of registers to read
+*/
+void I2C_readBurst(unsigned char writeByte, uint8_t* data, uint16_t length);
+
 /*!
     @brief I2C write 16 bits
     @param[in] pointer: register to write in accelerometer
@@ -0,0 +1,137 @@
+#include "RingBuffer.h"
+
+#ifndef SIMULATE_HARDWARE
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#define MEMORY_BARRIER()    __DMB()
+#else
+#define MEMORY_BARRIER()    __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#include <stddef.h>
+#include <string.h>
+
+bool RINGBUFFER_Init(RINGBUFFER_t *Ring, uint8_t *Storage, uint32_t Size)
+{
+    /* The capacity must be a power of two for the masking */
+    if(Ring == NULL || Storage == NULL || Size == 0 || (Size & (Size - 1)) != 0)
+    {
+        return false;
+    }
+    Ring->Data = Storage;
+    Ring->Mask = Size - 1;
+    Ring->Head = 0;
+    Ring->Tail = 0;
+    Ring->Overflows = 0;
+    return true;
+}
+
+bool RINGBUFFER_Put(RINGBUFFER_t *Ring, uint8_t Byte)
+{
+    uint32_t Head = Ring->Head;
+
+    if(Head - Ring->Tail > Ring->Mask)
+    {
+        Ring->Overflows++;
+        return false;
+    }
+    Ring->Data[Head & Ring->Mask] = Byte;
+    /* The byte must be stored before it is published */
+    MEMORY_BARRIER();
+    Ring->Head = Head + 1;
+    return true;
+}
+
+uint32_t RINGBUFFER_Write(RINGBUFFER_t *Ring, const uint8_t *Data, uint32_t Size)
+{
+    uint32_t Head = Ring->Head;
+    uint32_t Free = Ring->Mask + 1 - (Head - Ring->Tail);
+    uint32_t Offset = Head & Ring->Mask;
+    uint32_t First;
+
+    if(Size > Free)
+    {
+        Ring->Overflows += Size - Free;
+        Size = Free;
+    }
+
+    /* At most two contiguous spans: up to the end of the storage and from the start */
+    First = Ring->Mask + 1 - Offset;
+    if(First > Size)
+    {
+        First = Size;
+    }
+    memcpy((uint8_t *)&Ring->Data[Offset], Data, First);
+    memcpy((uint8_t *)&Ring->Data[0], Data + First, Size - First);
+
+    MEMORY_BARRIER();
+    Ring->Head = Head + Size;
+    return Size;
+}
+
+bool RINGBUFFER_Get(RINGBUFFER_t *Ring, uint8_t *Byte)
+{
+    uint32_t Tail = Ring->Tail;
+
+    if(Ring->Head == Tail)
+    {
+        return false;
+    }
+    /* Read Head before the data it publishes */
+    MEMORY_BARRIER();
+    *Byte = Ring->Data[Tail & Ring->Mask];
+    /* The byte must be read before its slot is released */
+    MEMORY_BARRIER();
+    Ring->Tail = Tail + 1;
+    return true;
+}
+
+uint32_t RINGBUFFER_Read(RINGBUFFER_t *Ring, uint8_t *Data, uint32_t Size)
+{
+    uint32_t Tail = Ring->Tail;
+    uint32_t Count = Ring->Head - Tail;
+    uint32_t Offset = Tail & Ring->Mask;
+    uint32_t First;
+
+    if(Size > Count)
+    {
+        Size = Count;
+    }
+    MEMORY_BARRIER();
+
+    First = Ring->Mask + 1 - Offset;
+    if(First > Size)
+    {
+        First = Size;
+    }
+    memcpy(Data, (const uint8_t *)&Ring->Data[Offset], First);
+    memcpy(Data + First, (const uint8_t *)&Ring->Data[0], Size - First);
+
+    MEMORY_BARRIER();
+    Ring->Tail = Tail + Size;
+    return Size;
+}
+
+void RINGBUFFER_Flush(RINGBUFFER_t *Ring)
+{
+    Ring->Tail = Ring->Head;
+}
+
+uint32_t RINGBUFFER_Count(const RINGBUFFER_t *Ring)
+{
+    return Ring->Head - Ring->Tail;
+}
+
+uint32_t RINGBUFFER_Free(const RINGBUFFER_t *Ring)
+{
+    return Ring->Mask + 1 - (Ring->Head - Ring->Tail);
+}
+
+uint32_t RINGBUFFER_Capacity(const RINGBUFFER_t *Ring)
+{
+    return Ring->Mask + 1;
+}
+
+uint32_t RINGBUFFER_Overflows(const RINGBUFFER_t *Ring)
+{
+    return Ring->Overflows;
+}
@@ -0,0 +1,44 @@
+#ifndef HARDWARE_RINGBUFFER_H_
+#define HARDWARE_RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Single producer single consumer byte ring.
+ *
+ * The capacity is a power of two and the indices run free, the position in the storage is taken
+ * by masking, so a full ring uses all the bytes and Count = Head - Tail is correct across the
+ * wrap of the 32 bit indices. Only the producer writes Head and only the consumer writes Tail:
+ * with one side in an ISR and the other in the main loop no critical section is needed, the
+ * memory barriers order the data accesses against the index updates.
+ *
+ * The bytes that do not fit are dropped and counted in Overflows.
+ */
+
+typedef struct{
+    volatile uint8_t *Data;
+    uint32_t Mask;                          // Capacity - 1
+    volatile uint32_t Head;                 // Write index, owned by the producer
+    volatile uint32_t Tail;                 // Read index, owned by the consumer
+    volatile uint32_t Overflows;            // Bytes dropped because the ring was full
+} RINGBUFFER_t;
+
+bool RINGBUFFER_Init(RINGBUFFER_t *Ring, uint8_t *Storage, uint32_t Size);
+
+/* Producer side */
+bool RINGBUFFER_Put(RINGBUFFER_t *Ring, uint8_t Byte);
+uint32_t RINGBUFFER_Write(RINGBUFFER_t *Ring, const uint8_t *Data, uint32_t Size);
+
+/* Consumer side */
+bool RINGBUFFER_Get(RINGBUFFER_t *Ring, uint8_t *Byte);
+uint32_t RINGBUFFER_Read(RINGBUFFER_t *Ring, uint8_t *Data, uint32_t Size);
+void RINGBUFFER_Flush(RINGBUFFER_t *Ring);
+
+/* Both sides */
+uint32_t RINGBUFFER_Count(const RINGBUFFER_t *Ring);
+uint32_t RINGBUFFER_Free(const RINGBUFFER_t *Ring);
+uint32_t RINGBUFFER_Capacity(const RINGBUFFER_t *Ring);
+uint32_t RINGBUFFER_Overflows(const RINGBUFFER_t *Ring);
+
+#endif /* HARDWARE_RINGBUFFER_H_ */
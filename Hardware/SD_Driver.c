@@ -1,23 +1,35 @@
 #include "GPIO_Driver.h"
 #include "SPI_Driver.h"
-#include "TIMERA_Driver.h"
+#include "SWTIMER_Driver.h"
 #include "UART_Driver.h"
 #include "SD_Driver.h"
 #include <fatfs/ff.h>
 #include <fatfs/diskio.h>
 
-/* Timer_A UpMode Configuration Parameters */
-Timer_A_UpModeConfig upConfig =
-{
-        TIMER_A_CLOCKSOURCE_SMCLK,              // SMCLK Clock Source
-        TIMER_A_CLOCKSOURCE_DIVIDER_64,         // SMCLK/1 = 3MHz
-        30000,                                  // 1 ms tick period
-        TIMER_A_TAIE_INTERRUPT_DISABLE,         // Disable Timer interrupt
-        TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE ,    // Enable CCR0 interrupt
-        TIMER_A_DO_CLEAR                        // Clear value
+/* disk_timerproc must be called every 10 ms */
+static SWTIMER_Timer_t SDTimer;
+
+/*SPI mode 3, the clock is raised by the MMC layer to the card maximum after the initialization*/
+static const eUSCI_SPI_MasterConfig SDSPIConfig = {
+     EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
+     3000000,
+     SD_INIT_SPI_CLOCK,
+     EUSCI_B_SPI_MSB_FIRST,
+     EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT,
+     EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH,
+     EUSCI_B_SPI_3PIN
 };
 
+SPI_Device_t SD_SPIDevice;
+
+static void SD_TimerCallback(void *Arg)
+{
+    disk_timerproc();
+}
+
 void SD_Init(){
-    GPIO_Init(MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN);
-    TIMERA_Init(TIMER_A1_BASE, UP_MODE, &upConfig, disk_timerproc);
+    SPI_InitDevice(&SD_SPIDevice, EUSCI_B0_BASE, &SDSPIConfig, MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN, false);
+    SWTIMER_Init();
+    SWTIMER_Create(&SDTimer, SD_TimerCallback, NULL);
+    SWTIMER_StartPeriodic(&SDTimer, SWTIMER_MS(10));
 }
@@ -3,12 +3,18 @@
 
 #include "GPIO_Driver.h"
 #include "SPI_Driver.h"
-#include "TIMERA_Driver.h"
+#include "SWTIMER_Driver.h"
 #include "UART_Driver.h"
 
 #define MMC_SS_GPIO_PORT  GPIO_PORT_P5
 #define MMC_SS_GPIO_PIN   GPIO_PIN2
 
+/*SPI clock during the card initialization and upper limit of the eUSCI (SMCLK / 3)*/
+#define SD_INIT_SPI_CLOCK 400000
+#define SD_MAX_SPI_CLOCK  16000000
+
+extern SPI_Device_t SD_SPIDevice;
+
 void SD_Init(void);
 
 #endif // __SD_DRIVER_H__
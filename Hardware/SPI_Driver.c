@@ -1,5 +1,48 @@
 #include "SPI_Driver.h"
 
+/*Bus state: the device whose profile is loaded in the eUSCI and if it is in a transfer*/
+typedef struct
+{
+    SPI_Device_t *Active;
+    bool Locked;
+    uint32_t Switches;
+    uint32_t Conflicts;
+} SPI_Bus_t;
+
+static SPI_Bus_t SPIB0Bus;
+static SPI_Bus_t SPIB1Bus;
+
+static SPI_Bus_t *GetBus(uint32_t SPI)
+{
+    switch(SPI)
+    {
+    case EUSCI_B0_BASE:
+        return &SPIB0Bus;
+    case EUSCI_B1_BASE:
+        return &SPIB1Bus;
+    default:
+        return NULL;
+    }
+}
+
+/*Load the profile of the device, the dividers are computed from the current SMCLK*/
+static void ApplyConfig(SPI_Device_t *Device)
+{
+    eUSCI_SPI_MasterConfig Config = Device->Config;
+    uint32_t Source = MAP_CS_getSMCLK();
+    uint32_t Divider = (Source + Config.desiredSpiClock - 1) / Config.desiredSpiClock;
+
+    /*Round the divider up, driverlib truncates it and would exceed the device clock*/
+    Config.selectClockSource = EUSCI_B_SPI_CLOCKSOURCE_SMCLK;
+    Config.clockSourceFrequency = Source;
+    Config.desiredSpiClock = Source / (Divider != 0 ? Divider : 1);
+
+    while(MAP_SPI_isBusy(Device->SPI));
+    MAP_SPI_disableModule(Device->SPI);
+    MAP_SPI_initMaster(Device->SPI, &Config);
+    MAP_SPI_enableModule(Device->SPI);
+}
+
 void SPI_Init(uint32_t SPI, eUSCI_SPI_MasterConfig SPIConfig)
 {
     switch(SPI)
@@ -36,3 +79,118 @@ void SPI_Read(uint32_t SPI, uint8_t *Data, uint32_t Size)
     }
 }
 
+/*Register a device on the bus, its CS is driven high until the first SPI_Acquire*/
+void SPI_InitDevice(SPI_Device_t *Device, uint32_t SPI, const eUSCI_SPI_MasterConfig *Config,
+                    uint32_t CSPort, uint16_t CSPin, bool KeepSelected)
+{
+    SPI_Bus_t *Bus = GetBus(SPI);
+
+    Device->SPI = SPI;
+    Device->Config = *Config;
+    Device->CSPort = CSPort;
+    Device->CSPin = CSPin;
+    Device->KeepSelected = KeepSelected;
+
+    MAP_GPIO_setOutputHighOnPin(CSPort, CSPin);
+    MAP_GPIO_setAsOutputPin(CSPort, CSPin);
+
+    /*A device registered again may have a new profile*/
+    if(Bus && Bus->Active == Device)
+    {
+        Bus->Active = NULL;
+    }
+}
+
+/*
+ * Take the bus for a transfer: deselect the previous device, load the profile of this one if it
+ * is not loaded yet and drive its CS low. Fails if another device is in the middle of a transfer.
+ */
+bool SPI_Acquire(SPI_Device_t *Device)
+{
+    SPI_Bus_t *Bus = GetBus(Device->SPI);
+
+    if(Bus == NULL)
+    {
+        return false;
+    }
+    if(Bus->Active != Device)
+    {
+        if(Bus->Locked)
+        {
+            Bus->Conflicts++;
+            return false;
+        }
+        if(Bus->Active)
+        {
+            while(MAP_SPI_isBusy(Device->SPI));
+            MAP_GPIO_setOutputHighOnPin(Bus->Active->CSPort, Bus->Active->CSPin);
+        }
+        ApplyConfig(Device);
+        Bus->Active = Device;
+        Bus->Switches++;
+    }
+    Bus->Locked = true;
+    MAP_GPIO_setOutputLowOnPin(Device->CSPort, Device->CSPin);
+    return true;
+}
+
+/*End of a transfer: the CS goes high unless the device keeps it low between the transfers*/
+void SPI_Release(SPI_Device_t *Device)
+{
+    SPI_Bus_t *Bus = GetBus(Device->SPI);
+
+    if(Bus == NULL || Bus->Active != Device)
+    {
+        return;
+    }
+    Bus->Locked = false;
+    if(!Device->KeepSelected)
+    {
+        while(MAP_SPI_isBusy(Device->SPI));
+        MAP_GPIO_setOutputHighOnPin(Device->CSPort, Device->CSPin);
+    }
+}
+
+/*Change the clock of a device, applied immediately if its profile is loaded*/
+void SPI_SetDeviceClock(SPI_Device_t *Device, uint32_t Clock)
+{
+    SPI_Bus_t *Bus = GetBus(Device->SPI);
+
+    Device->Config.desiredSpiClock = Clock;
+    if(Bus && Bus->Active == Device)
+    {
+        ApplyConfig(Device);
+    }
+}
+
+uint32_t SPI_GetDeviceClock(SPI_Device_t *Device)
+{
+    return Device->Config.desiredSpiClock;
+}
+
+/*Reload the profile at the next SPI_Acquire, needed after a change of SMCLK*/
+void SPI_Reconfigure(uint32_t SPI)
+{
+    SPI_Bus_t *Bus = GetBus(SPI);
+
+    if(Bus && !Bus->Locked)
+    {
+        if(Bus->Active)
+        {
+            MAP_GPIO_setOutputHighOnPin(Bus->Active->CSPort, Bus->Active->CSPin);
+        }
+        Bus->Active = NULL;
+    }
+}
+
+uint32_t SPI_GetSwitches(uint32_t SPI)
+{
+    SPI_Bus_t *Bus = GetBus(SPI);
+    return Bus ? Bus->Switches : 0;
+}
+
+uint32_t SPI_GetConflicts(uint32_t SPI)
+{
+    SPI_Bus_t *Bus = GetBus(SPI);
+    return Bus ? Bus->Conflicts : 0;
+}
@@ -1,13 +1,36 @@
 #ifndef HARDWARE_SPI_DRIVER_H_
 #define HARDWARE_SPI_DRIVER_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <ti/devices/msp432p4xx/driverlib/rom.h>
 #include <ti/devices/msp432p4xx/driverlib/rom_map.h>
 #include <ti/devices/msp432p4xx/driverlib/spi.h>
 #include <ti/devices/msp432p4xx/driverlib/gpio.h>
+#include <ti/devices/msp432p4xx/driverlib/cs.h>
+
+/*Device sharing a SPI bus: its own clock, phase and polarity and its chip select*/
+typedef struct
+{
+    uint32_t SPI;
+    eUSCI_SPI_MasterConfig Config;
+    uint32_t CSPort;
+    uint16_t CSPin;
+    bool KeepSelected;      /*CS left low after the release, until another device takes the bus*/
+} SPI_Device_t;
 
 void SPI_Init(uint32_t SPI, eUSCI_SPI_MasterConfig SPIConfig);
 void SPI_Write(uint32_t SPI, uint8_t *Data, uint32_t Size);
 void SPI_Read(uint32_t SPI, uint8_t *Data, uint32_t Size);
 
+void SPI_InitDevice(SPI_Device_t *Device, uint32_t SPI, const eUSCI_SPI_MasterConfig *Config,
+                    uint32_t CSPort, uint16_t CSPin, bool KeepSelected);
+bool SPI_Acquire(SPI_Device_t *Device);
+void SPI_Release(SPI_Device_t *Device);
+void SPI_SetDeviceClock(SPI_Device_t *Device, uint32_t Clock);
+uint32_t SPI_GetDeviceClock(SPI_Device_t *Device);
+void SPI_Reconfigure(uint32_t SPI);
+uint32_t SPI_GetSwitches(uint32_t SPI);
+uint32_t SPI_GetConflicts(uint32_t SPI);
+
 #endif /* HARDWARE_SPI_DRIVER_H_ */
@@ -0,0 +1,419 @@
+#include "SWTIMER_Driver.h"
+
+#ifndef SIMULATE_HARDWARE
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "TIMERA_Driver.h"
+#endif
+
+#include <stddef.h>
+
+#define SLOT_MASK           (SWTIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(Level)  ((Level) * SWTIMER_WHEEL_SLOT_BITS)
+#define WHEEL_RANGE         (1UL << (SWTIMER_WHEEL_LEVELS * SWTIMER_WHEEL_SLOT_BITS))
+#define MAX_ALARM_TICKS     0x7FFF          // Half of the 16 bit counter, to extend it to 32 bit safely
+
+static SWTIMER_Timer_t *Wheel[SWTIMER_WHEEL_LEVELS][SWTIMER_WHEEL_SLOTS];
+static uint32_t Occupied[SWTIMER_WHEEL_LEVELS][SWTIMER_WHEEL_SLOTS / 32];
+static uint32_t WheelTime;                  // Last tick processed by the wheel
+static bool Initialized = false;
+
+static void Process(void);
+
+/* ------------------------------------------------------------------------------------------------
+    Hardware dependent part
+   ------------------------------------------------------------------------------------------------ */
+#ifndef SIMULATE_HARDWARE
+
+/* Timer_A ContinuousMode Configuration Parameters */
+static Timer_A_ContinuousModeConfig ContinuousConfig =
+{
+        TIMER_A_CLOCKSOURCE_ACLK,               // ACLK Clock Source
+        TIMER_A_CLOCKSOURCE_DIVIDER_32,         // ACLK/32 = 1024 Hz
+        TIMER_A_TAIE_INTERRUPT_DISABLE,         // Disable overflow interrupt
+        TIMER_A_DO_CLEAR                        // Clear value
+};
+
+/* CCR0 is the alarm of the next expiration */
+static Timer_A_CompareModeConfig AlarmConfig =
+{
+        TIMER_A_CAPTURECOMPARE_REGISTER_0,
+        TIMER_A_CAPTURECOMPARE_INTERRUPT_ENABLE,
+        TIMER_A_OUTPUTMODE_OUTBITVALUE,
+        MAX_ALARM_TICKS
+};
+
+static uint32_t LastNow;
+
+/* Extend the 16 bit counter to 32 bit, it is read at least every MAX_ALARM_TICKS */
+static uint32_t HW_Now(void)
+{
+    uint16_t Counter = MAP_Timer_A_getCounterValue(TIMER_A1_BASE);
+    LastNow += (uint16_t)(Counter - (uint16_t)LastNow);
+    return LastNow;
+}
+
+static void HW_SetAlarm(uint32_t Time)
+{
+    MAP_Timer_A_setCompareValue(TIMER_A1_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0, (uint16_t)Time);
+    /* If the counter has already passed the compare value request the interrupt by software */
+    if((int32_t)(Time - HW_Now()) <= 0)
+    {
+        TIMER_A1->CCTL[0] |= TIMER_A_CCTLN_CCIFG;
+    }
+}
+
+static void HW_Init(void)
+{
+    MAP_Timer_A_initCompare(TIMER_A1_BASE, &AlarmConfig);
+    TIMERA_Init(TIMER_A1_BASE, CONTINUOS_MODE, &ContinuousConfig, Process);
+    LastNow = 0;
+}
+
+#define ENTER_CRITICAL()    bool WasDisabled = MAP_Interrupt_disableMaster()
+#define EXIT_CRITICAL()     if(!WasDisabled){ MAP_Interrupt_enableMaster(); }
+
+#else
+
+static uint32_t SimNow;
+static uint32_t SimAlarm;
+
+static uint32_t HW_Now(void)
+{
+    return SimNow;
+}
+
+static void HW_SetAlarm(uint32_t Time)
+{
+    SimAlarm = Time;
+}
+
+static void HW_Init(void)
+{
+    SimNow = 0;
+}
+
+#define ENTER_CRITICAL()
+#define EXIT_CRITICAL()
+
+/* Move the virtual clock forward, running the timers at their expiration time */
+void SWTIMER_SimAdvance(uint32_t Ticks)
+{
+    uint32_t End = SimNow + Ticks;
+
+    while((int32_t)(End - SimAlarm) >= 0)
+    {
+        SimNow = SimAlarm;
+        Process();
+    }
+    SimNow = End;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+    Wheel
+   ------------------------------------------------------------------------------------------------ */
+
+static uint8_t Ctz32(uint32_t Value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(Value);
+#else
+    static const uint8_t DeBruijn[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    return DeBruijn[((Value & (0u - Value)) * 0x077CB531u) >> 27];
+#endif
+}
+
+/* Distance in slots (1..64) from Current to the next occupied slot, Current last; 0 if empty */
+static uint32_t NextOccupied(uint8_t Level, uint32_t Current)
+{
+    uint64_t Map = ((uint64_t)Occupied[Level][1] << 32) | Occupied[Level][0];
+    uint32_t Rotation = (Current + 1) & SLOT_MASK;
+
+    if(Map == 0)
+    {
+        return 0;
+    }
+    if(Rotation)
+    {
+        Map = (Map >> Rotation) | (Map << (SWTIMER_WHEEL_SLOTS - Rotation));
+    }
+    if((uint32_t)Map)
+    {
+        return Ctz32((uint32_t)Map) + 1;
+    }
+    return Ctz32((uint32_t)(Map >> 32)) + 33;
+}
+
+/* Ticks from WheelTime to the next expiration or cascade, 0 if no timer is active */
+static uint32_t NextEventDistance(void)
+{
+    uint32_t Best = 0;
+    uint8_t Level;
+
+    for(Level = 0; Level < SWTIMER_WHEEL_LEVELS; Level++)
+    {
+        uint32_t Current = (WheelTime >> LEVEL_SHIFT(Level)) & SLOT_MASK;
+        uint32_t Slots = NextOccupied(Level, Current);
+        uint32_t Distance;
+
+        if(Slots == 0)
+        {
+            continue;
+        }
+        Distance = (((WheelTime >> LEVEL_SHIFT(Level)) + Slots) << LEVEL_SHIFT(Level)) - WheelTime;
+        if(Best == 0 || Distance < Best)
+        {
+            Best = Distance;
+        }
+    }
+    return Best;
+}
+
+static void Link(SWTIMER_Timer_t *Timer, uint8_t Level, uint8_t Slot)
+{
+    SWTIMER_Timer_t **Head = &Wheel[Level][Slot];
+
+    Timer->Next = *Head;
+    if(Timer->Next)
+    {
+        Timer->Next->PPrev = &Timer->Next;
+    }
+    *Head = Timer;
+    Timer->PPrev = Head;
+    Timer->Level = Level;
+    Timer->Slot = Slot;
+    Occupied[Level][Slot >> 5] |= 1UL << (Slot & 31);
+}
+
+static void Unlink(SWTIMER_Timer_t *Timer)
+{
+    *Timer->PPrev = Timer->Next;
+    if(Timer->Next)
+    {
+        Timer->Next->PPrev = Timer->PPrev;
+    }
+    Timer->Next = NULL;
+    Timer->PPrev = NULL;
+    /* The timer can be in a list detached by RunSlot: clear the bit only if the slot is empty */
+    if(Wheel[Timer->Level][Timer->Slot] == NULL)
+    {
+        Occupied[Timer->Level][Timer->Slot >> 5] &= ~(1UL << (Timer->Slot & 31));
+    }
+}
+
+static void Insert(SWTIMER_Timer_t *Timer)
+{
+    uint32_t Delta = Timer->Expires - WheelTime;
+
+    if((int32_t)Delta < 0)
+    {
+        Delta = 0;
+        Timer->Expires = WheelTime;
+    }
+
+    if(Delta < SWTIMER_WHEEL_SLOTS)
+    {
+        Link(Timer, 0, Timer->Expires & SLOT_MASK);
+    }
+    else if(Delta < (1UL << LEVEL_SHIFT(2)))
+    {
+        Link(Timer, 1, (Timer->Expires >> LEVEL_SHIFT(1)) & SLOT_MASK);
+    }
+    else if(Delta < WHEEL_RANGE)
+    {
+        Link(Timer, 2, (Timer->Expires >> LEVEL_SHIFT(2)) & SLOT_MASK);
+    }
+    else
+    {
+        /* Beyond the wheel: park it in the farthest slot, it is inserted again when cascaded */
+        Link(Timer, 2, ((WheelTime >> LEVEL_SHIFT(2)) - 1) & SLOT_MASK);
+    }
+}
+
+/* Detach a slot, so the callbacks can safely start and stop timers while it is processed */
+static SWTIMER_Timer_t *Detach(uint8_t Level, uint32_t Slot, SWTIMER_Timer_t **List)
+{
+    *List = Wheel[Level][Slot];
+    Wheel[Level][Slot] = NULL;
+    Occupied[Level][Slot >> 5] &= ~(1UL << (Slot & 31));
+    if(*List)
+    {
+        (*List)->PPrev = List;
+    }
+    return *List;
+}
+
+static void Cascade(uint8_t Level, uint32_t Slot)
+{
+    SWTIMER_Timer_t *List;
+
+    Detach(Level, Slot, &List);
+    while(List)
+    {
+        SWTIMER_Timer_t *Timer = List;
+        Unlink(Timer);
+        Insert(Timer);
+    }
+}
+
+static void RunSlot(uint32_t Slot)
+{
+    SWTIMER_Timer_t *List;
+
+    Detach(0, Slot, &List);
+    while(List)
+    {
+        SWTIMER_Timer_t *Timer = List;
+        Unlink(Timer);
+        if(Timer->Period)
+        {
+            Timer->Expires += Timer->Period;
+            Insert(Timer);
+        }
+        Timer->Callback(Timer->Arg);
+    }
+}
+
+/* Process the tick WheelTime: cascade the upper levels on their boundaries, then run the slot */
+static void Tick(void)
+{
+    uint32_t Index0 = WheelTime & SLOT_MASK;
+
+    if(Index0 == 0)
+    {
+        uint32_t Index1 = (WheelTime >> LEVEL_SHIFT(1)) & SLOT_MASK;
+        if(Index1 == 0)
+        {
+            Cascade(2, (WheelTime >> LEVEL_SHIFT(2)) & SLOT_MASK);
+        }
+        Cascade(1, Index1);
+    }
+    RunSlot(Index0);
+}
+
+static void ProgramAlarm(uint32_t Now)
+{
+    uint32_t Distance = NextEventDistance();
+    uint32_t Target = Now + MAX_ALARM_TICKS;
+
+    if(Distance)
+    {
+        uint32_t Event = WheelTime + Distance;
+        if((int32_t)(Event - Now) <= 0)
+        {
+            Target = Now + 1;
+        }
+        else if(Event - Now < MAX_ALARM_TICKS)
+        {
+            Target = Event;
+        }
+    }
+    HW_SetAlarm(Target);
+}
+
+/* Alarm interrupt: bring the wheel to the current time, jumping over the empty ticks */
+static void Process(void)
+{
+    uint32_t Now = HW_Now();
+
+    while((int32_t)(Now - WheelTime) > 0)
+    {
+        uint32_t Distance = NextEventDistance();
+        if(Distance == 0 || Distance > Now - WheelTime)
+        {
+            WheelTime = Now;
+            break;
+        }
+        WheelTime += Distance;
+        Tick();
+    }
+    ProgramAlarm(Now);
+}
+
+static void Start(SWTIMER_Timer_t *Timer, uint32_t Ticks, uint32_t Period)
+{
+    uint32_t Now;
+
+    if(Ticks == 0)
+    {
+        Ticks = 1;
+    }
+
+    ENTER_CRITICAL();
+    if(Timer->PPrev)
+    {
+        Unlink(Timer);
+    }
+    Now = HW_Now();
+    Timer->Expires = Now + Ticks;
+    Timer->Period = Period;
+    Insert(Timer);
+    ProgramAlarm(Now);
+    EXIT_CRITICAL();
+}
+
+/* ------------------------------------------------------------------------------------------------
+    API
+   ------------------------------------------------------------------------------------------------ */
+
+void SWTIMER_Init(void)
+{
+    if(Initialized)
+    {
+        return;
+    }
+    HW_Init();
+    WheelTime = HW_Now();
+    Initialized = true;
+    ProgramAlarm(WheelTime);
+}
+
+void SWTIMER_Create(SWTIMER_Timer_t *Timer, SWTIMER_Callback_t Callback, void *Arg)
+{
+    Timer->Next = NULL;
+    Timer->PPrev = NULL;
+    Timer->Expires = 0;
+    Timer->Period = 0;
+    Timer->Callback = Callback;
+    Timer->Arg = Arg;
+}
+
+void SWTIMER_StartOneShot(SWTIMER_Timer_t *Timer, uint32_t Ticks)
+{
+    Start(Timer, Ticks, 0);
+}
+
+void SWTIMER_StartPeriodic(SWTIMER_Timer_t *Timer, uint32_t Ticks)
+{
+    Start(Timer, Ticks, Ticks ? Ticks : 1);
+}
+
+void SWTIMER_Stop(SWTIMER_Timer_t *Timer)
+{
+    ENTER_CRITICAL();
+    if(Timer->PPrev)
+    {
+        Unlink(Timer);
+    }
+    EXIT_CRITICAL();
+}
+
+bool SWTIMER_IsActive(const SWTIMER_Timer_t *Timer)
+{
+    return Timer->PPrev != NULL;
+}
+
+uint32_t SWTIMER_Now(void)
+{
+    uint32_t Now;
+
+    ENTER_CRITICAL();
+    Now = HW_Now();
+    EXIT_CRITICAL();
+    return Now;
+}
@@ -0,0 +1,54 @@
+#ifndef HARDWARE_SWTIMER_DRIVER_H_
+#define HARDWARE_SWTIMER_DRIVER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Software timers multiplexed on TIMER_A1.
+ *
+ * The timers are kept in a hierarchical wheel (3 levels of 64 slots, 1 tick resolution up to 64
+ * ticks, 64 ticks up to 4096 and 4096 ticks beyond) with intrusive lists, so starting and stopping
+ * a timer is O(1). TIMER_A1 runs in continuous mode on ACLK/32 and CCR0 is reprogrammed to the next
+ * expiration only (tickless), so an idle wheel does not wake the CPU.
+ *
+ * The callbacks run in the TA1_0 interrupt: keep them short and post a scheduler event for the
+ * heavy work. A callback can start or stop any timer, itself included.
+ *
+ * With SIMULATE_HARDWARE the hardware counter is replaced by a virtual clock moved forward with
+ * SWTIMER_SimAdvance().
+ */
+
+#define SWTIMER_TICK_HZ             1024                                    // ACLK 32768 Hz / 32
+#define SWTIMER_MS(ms)              ((((uint32_t)(ms)) * SWTIMER_TICK_HZ + 999) / 1000)
+
+#define SWTIMER_WHEEL_LEVELS        3
+#define SWTIMER_WHEEL_SLOT_BITS     6
+#define SWTIMER_WHEEL_SLOTS         (1 << SWTIMER_WHEEL_SLOT_BITS)
+
+typedef void (*SWTIMER_Callback_t)(void *Arg);
+
+typedef struct SWTIMER_Timer{
+    struct SWTIMER_Timer *Next;             // Next timer in the slot
+    struct SWTIMER_Timer **PPrev;           // Pointer to the pointer to this timer, NULL if not active
+    uint32_t Expires;                       // Absolute expiration time in ticks
+    uint32_t Period;                        // Reload value in ticks, 0 for one-shot timers
+    SWTIMER_Callback_t Callback;
+    void *Arg;
+    uint8_t Level;                          // Position in the wheel, valid when active
+    uint8_t Slot;
+} SWTIMER_Timer_t;
+
+void SWTIMER_Init(void);
+void SWTIMER_Create(SWTIMER_Timer_t *Timer, SWTIMER_Callback_t Callback, void *Arg);
+void SWTIMER_StartOneShot(SWTIMER_Timer_t *Timer, uint32_t Ticks);
+void SWTIMER_StartPeriodic(SWTIMER_Timer_t *Timer, uint32_t Ticks);
+void SWTIMER_Stop(SWTIMER_Timer_t *Timer);
+bool SWTIMER_IsActive(const SWTIMER_Timer_t *Timer);
+uint32_t SWTIMER_Now(void);
+
+#ifdef SIMULATE_HARDWARE
+void SWTIMER_SimAdvance(uint32_t Ticks);
+#endif
+
+#endif /* HARDWARE_SWTIMER_DRIVER_H_ */
@@ -1,4 +1,5 @@
 #include "TIMERA_Driver.h"
+#include <profiler.h>
 
 void (*TIMER_A0_CB)(void) = 0x0000000;
 void (*TIMER_A1_CB)(void) = 0x0000000;
@@ -8,12 +9,14 @@ void TIMERA_Init(uint32_t TIMER, uint32_t Mode, void *Config, void(*TIMER_CB)(vo
     Timer_A_ContinuousModeConfig *cmc;
     Timer_A_UpModeConfig *upc;
     Timer_A_UpDownModeConfig *udmc;
+    uint_fast16_t CounterMode = TIMER_A_UP_MODE;
 
     switch(Mode)
     {
     case CONTINUOS_MODE:
         cmc = (Timer_A_ContinuousModeConfig*)Config;
         MAP_Timer_A_configureContinuousMode(TIMER, cmc);
+        CounterMode = TIMER_A_CONTINUOUS_MODE;
         break;
     case UP_MODE:
         upc = (Timer_A_UpModeConfig*)Config;
@@ -22,6 +25,7 @@ void TIMERA_Init(uint32_t TIMER, uint32_t Mode, void *Config, void(*TIMER_CB)(vo
     case UPDOWN_MODE:
         udmc = (Timer_A_UpDownModeConfig*)Config;
         MAP_Timer_A_configureUpDownMode(TIMER, udmc);
+        CounterMode = TIMER_A_UPDOWN_MODE;
         break;
     case CAPTURE_MODE:
         break;
@@ -40,12 +44,12 @@ void TIMERA_Init(uint32_t TIMER, uint32_t Mode, void *Config, void(*TIMER_CB)(vo
         case TIMER_A0_BASE:
             TIMER_A0_CB = TIMER_CB;
             MAP_Interrupt_enableInterrupt(INT_TA0_0);
-            MAP_Timer_A_startCounter(TIMER_A0_BASE, TIMER_A_UP_MODE);
+            MAP_Timer_A_startCounter(TIMER_A0_BASE, CounterMode);
             break;
         case TIMER_A1_BASE:
             TIMER_A1_CB = TIMER_CB;
             MAP_Interrupt_enableInterrupt(INT_TA1_0);
-            MAP_Timer_A_startCounter(TIMER_A1_BASE, TIMER_A_UP_MODE);
+            MAP_Timer_A_startCounter(TIMER_A1_BASE, CounterMode);
             break;
         default:
             break;
@@ -63,11 +67,13 @@ void TA0_0_IRQHandler(void)
 
 void TA1_0_IRQHandler(void)
 {
+    PROF_ENTER(PROF_ISR_TA1_0);
     MAP_Timer_A_clearCaptureCompareInterrupt(TIMER_A1_BASE,
                TIMER_A_CAPTURECOMPARE_REGISTER_0);
     if(TIMER_A1_CB)
     {
         TIMER_A1_CB();
     }
+    PROF_EXIT(PROF_ISR_TA1_0);
 }
 
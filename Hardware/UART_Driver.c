@@ -1,31 +1,55 @@
 #include "UART_Driver.h"
+#include "RingBuffer.h"
+#include <stddef.h>
+#include <profiler.h>
 
-/*UARTA0 Ring Buffer Global Variables*/
-volatile uint8_t UARTA0Data[UARTA0_BUFFERSIZE];
-volatile uint32_t UARTA0ReadIndex;
-volatile uint32_t UARTA0WriteIndex;
+#if (UARTA0_BUFFERSIZE & (UARTA0_BUFFERSIZE - 1)) != 0 || (UARTA2_BUFFERSIZE & (UARTA2_BUFFERSIZE - 1)) != 0 || \
+    (UARTA3_BUFFERSIZE & (UARTA3_BUFFERSIZE - 1)) != 0 || (UARTA0_TX_BUFFERSIZE & (UARTA0_TX_BUFFERSIZE - 1)) != 0
+#error "The UART buffer sizes must be powers of two"
+#endif
 
-#define UARTA0_ADVANCE_READ_INDEX          MAP_Interrupt_disableMaster(); UARTA0ReadIndex = (UARTA0ReadIndex + 1) % UARTA0_BUFFERSIZE; MAP_Interrupt_enableMaster();
-#define UARTA0_ADVANCE_WRITE_INDEX         UARTA0WriteIndex = (UARTA0WriteIndex + 1) % UARTA0_BUFFERSIZE
-#define UARTA0_BUFFER_EMPTY                UARTA0ReadIndex == UARTA0WriteIndex ? true : false
-#define UARTA0_BUFFER_FULL                 (UARTA0WriteIndex + 1) % UARTA0_BUFFERSIZE == UARTA0ReadIndex ? true : false
+/*UART RX rings: the ISR is the producer, UART_Read the consumer*/
+static uint8_t UARTA0Data[UARTA0_BUFFERSIZE];
+static RINGBUFFER_t UARTA0Ring;
 
-/*UARTA2 Ring Buffer Global Variables*/
-volatile uint8_t UARTA2Data[UARTA2_BUFFERSIZE];
-volatile uint32_t UARTA2ReadIndex;
-volatile uint32_t UARTA2WriteIndex;
+static uint8_t UARTA2Data[UARTA2_BUFFERSIZE];
+static RINGBUFFER_t UARTA2Ring;
 
-#define UARTA2_ADVANCE_READ_INDEX          MAP_Interrupt_disableMaster(); UARTA2ReadIndex = (UARTA2ReadIndex + 1) % UARTA2_BUFFERSIZE; MAP_Interrupt_enableMaster();
-#define UARTA2_ADVANCE_WRITE_INDEX         UARTA2WriteIndex = (UARTA2WriteIndex + 1) % UARTA2_BUFFERSIZE
-#define UARTA2_BUFFER_EMPTY                UARTA2ReadIndex == UARTA2WriteIndex ? true : false
-#define UARTA2_BUFFER_FULL                 (UARTA2WriteIndex + 1) % UARTA2_BUFFERSIZE == UARTA2ReadIndex ? true : false
-#define UARTA2_AVAILABLE                   UARTA2WriteIndex - UARTA2ReadIndex
+static uint8_t UARTA3Data[UARTA3_BUFFERSIZE];
+static RINGBUFFER_t UARTA3Ring;
+
+/*Optional callbacks called by the RX ISR after a byte has been stored*/
+static void (*UARTA0RxCallback)(void);
+static void (*UARTA2RxCallback)(void);
+static void (*UARTA3RxCallback)(void);
+
+/*UARTA0 TX ring: UART_Write is the producer, the TX interrupt drains it*/
+static uint8_t UARTA0TxData[UARTA0_TX_BUFFERSIZE];
+static RINGBUFFER_t UARTA0TxRing;
+
+static RINGBUFFER_t *GetRing(uint32_t UART)
+{
+    switch(UART)
+    {
+    case EUSCI_A0_BASE:
+        return &UARTA0Ring;
+    case EUSCI_A2_BASE:
+        return &UARTA2Ring;
+    case EUSCI_A3_BASE:
+        return &UARTA3Ring;
+    /*Add more UART rings here*/
+    default:
+        return NULL;
+    }
+}
 
 void UART_Init(uint32_t UART, eUSCI_UART_ConfigV1 UARTConfig)
 {
     switch(UART)
     {
     case EUSCI_A0_BASE:
+        RINGBUFFER_Init(&UARTA0Ring, UARTA0Data, UARTA0_BUFFERSIZE);
+        RINGBUFFER_Init(&UARTA0TxRing, UARTA0TxData, UARTA0_TX_BUFFERSIZE);
         MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1, GPIO_PIN2 | GPIO_PIN3, GPIO_PRIMARY_MODULE_FUNCTION);
         MAP_UART_initModule(UART, &UARTConfig);
         MAP_UART_enableModule(UART);
@@ -33,12 +57,21 @@ void UART_Init(uint32_t UART, eUSCI_UART_ConfigV1 UARTConfig)
         MAP_Interrupt_enableInterrupt(INT_EUSCIA0);
         break;
     case EUSCI_A2_BASE:
+        RINGBUFFER_Init(&UARTA2Ring, UARTA2Data, UARTA2_BUFFERSIZE);
         MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P3, GPIO_PIN2 | GPIO_PIN3, GPIO_PRIMARY_MODULE_FUNCTION);
         MAP_UART_initModule(UART, &UARTConfig);
         MAP_UART_enableModule(UART);
         MAP_UART_enableInterrupt(UART, EUSCI_A_UART_RECEIVE_INTERRUPT);
         MAP_Interrupt_enableInterrupt(INT_EUSCIA2);
         break;
+    case EUSCI_A3_BASE:
+        RINGBUFFER_Init(&UARTA3Ring, UARTA3Data, UARTA3_BUFFERSIZE);
+        MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P9, GPIO_PIN6 | GPIO_PIN7, GPIO_PRIMARY_MODULE_FUNCTION);
+        MAP_UART_initModule(UART, &UARTConfig);
+        MAP_UART_enableModule(UART);
+        MAP_UART_enableInterrupt(UART, EUSCI_A_UART_RECEIVE_INTERRUPT);
+        MAP_Interrupt_enableInterrupt(INT_EUSCIA3);
+        break;
     /*Add more UART modules initialization modules here*/
     default:
         break;
@@ -48,88 +81,128 @@ void UART_Init(uint32_t UART, eUSCI_UART_ConfigV1 UARTConfig)
 void UART_Write(uint32_t UART, uint8_t *Data, uint32_t Size)
 {
     uint32_t i;
-    for(i = 0; i < Size; i++)
-    {
-        MAP_UART_transmitData(UART, Data[i]);
-    }
-}
-
-uint32_t UART_Read(uint32_t UART, uint8_t *Data, uint32_t Size)
-{
-    uint32_t i;
-    int8_t c;
 
     switch(UART)
     {
     case EUSCI_A0_BASE:
-        for(i = 0; i < Size; i++)
+        /*Queue the data, what does not fit is dropped and counted. The TX interrupt fires as
+          soon as it is enabled if the TX buffer is empty, so it starts the transfer*/
+        if(RINGBUFFER_Write(&UARTA0TxRing, Data, Size) != 0)
         {
-            if(UARTA0_BUFFER_EMPTY)
-            {
-                return i;
-            }
-            else
-            {
-                c = UARTA0Data[UARTA0ReadIndex];
-                UARTA0_ADVANCE_READ_INDEX;
-
-                Data[i] = c;
-            }
+            MAP_UART_enableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
         }
-    break;
-
-    case EUSCI_A2_BASE:
+        break;
+    default:
         for(i = 0; i < Size; i++)
         {
-            if(UARTA2_BUFFER_EMPTY)
-            {
-                return i;
-            }
-            else
-            {
-                c = UARTA2Data[UARTA2ReadIndex];
-                UARTA2_ADVANCE_READ_INDEX;
-
-                Data[i] = c;
-            }
+            MAP_UART_transmitData(UART, Data[i]);
         }
-    break;
-    /*More UART reading modules go here*/
+        break;
+    }
+}
+
+void UART_SetRxCallback(uint32_t UART, void(*Callback)(void))
+{
+    switch(UART)
+    {
+    case EUSCI_A0_BASE:
+        UARTA0RxCallback = Callback;
+        break;
+    case EUSCI_A2_BASE:
+        UARTA2RxCallback = Callback;
+        break;
+    case EUSCI_A3_BASE:
+        UARTA3RxCallback = Callback;
+        break;
     default:
+        break;
+    }
+}
+
+/*Wait until the queued data has been handed to the hardware, needs the interrupts enabled*/
+void UART_Flush(uint32_t UART)
+{
+    if(UART == EUSCI_A0_BASE)
+    {
+        while(RINGBUFFER_Count(&UARTA0TxRing) != 0);
+    }
+}
+
+uint32_t UART_GetTxDrops(uint32_t UART)
+{
+    return UART == EUSCI_A0_BASE ? RINGBUFFER_Overflows(&UARTA0TxRing) : 0;
+}
+
+/*Room in the TX ring, for a writer that must not be cut. The other UARTs block, everything fits*/
+uint32_t UART_TxFree(uint32_t UART)
+{
+    return UART == EUSCI_A0_BASE ? RINGBUFFER_Free(&UARTA0TxRing) : UINT32_MAX;
+}
+
+uint32_t UART_Read(uint32_t UART, uint8_t *Data, uint32_t Size)
+{
+    RINGBUFFER_t *Ring = GetRing(UART);
+
+    if(Ring == NULL)
+    {
         return 0;
     }
+    return RINGBUFFER_Read(Ring, Data, Size);
+}
+
+uint32_t UART_Available(uint32_t UART)
+{
+    RINGBUFFER_t *Ring = GetRing(UART);
 
-    return i;
+    return Ring != NULL ? RINGBUFFER_Count(Ring) : 0;
+}
+
+uint32_t UART_GetOverflows(uint32_t UART)
+{
+    RINGBUFFER_t *Ring = GetRing(UART);
+
+    return Ring != NULL ? RINGBUFFER_Overflows(Ring) : 0;
 }
 
 void EUSCIA0_IRQHandler(void)
 {
+    PROF_ENTER(PROF_ISR_EUSCIA0);
     uint8_t c;
     uint32_t status = MAP_UART_getEnabledInterruptStatus(EUSCI_A0_BASE);
 
-    MAP_UART_clearInterruptFlag(EUSCI_A0_BASE, status);
+    /*TXIFG is cleared by writing TXBUF, it must stay set when the ring is empty to restart the
+      transfer when the interrupt is enabled again*/
+    MAP_UART_clearInterruptFlag(EUSCI_A0_BASE, status & ~EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG);
 
     if(status & EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG)
     {
         c = MAP_UART_receiveData(EUSCI_A0_BASE);
 
-        if(UARTA0_BUFFER_FULL)
+        /*The dropped bytes are counted by the ring. No echo: the TX ring has a single producer*/
+        RINGBUFFER_Put(&UARTA0Ring, c);
+        if(UARTA0RxCallback)
+        {
+            UARTA0RxCallback();
+        }
+    }
+
+    if(status & EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG)
+    {
+        if(RINGBUFFER_Get(&UARTA0TxRing, &c))
         {
-            /*TODO: Buffer Overflow, add handler here*/
+            EUSCI_A0->TXBUF = c;
         }
         else
         {
-            UARTA0Data[UARTA0WriteIndex] = c;
-            UARTA0_ADVANCE_WRITE_INDEX;
-
-            /*Transmit data only if it made it to the buffer*/
-            MAP_UART_transmitData(EUSCI_A0_BASE, c);
+            MAP_UART_disableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
         }
     }
+    PROF_EXIT(PROF_ISR_EUSCIA0);
 }
 
 void EUSCIA2_IRQHandler(void)
 {
+    PROF_ENTER(PROF_ISR_EUSCIA2);
     uint8_t c;
     uint32_t status = MAP_UART_getEnabledInterruptStatus(EUSCI_A2_BASE);
     MAP_UART_clearInterruptFlag(EUSCI_A2_BASE, status);
@@ -138,14 +211,31 @@ void EUSCIA2_IRQHandler(void)
     {
         c = MAP_UART_receiveData(EUSCI_A2_BASE);
 
-        if(UARTA2_BUFFER_FULL)
+        /*The dropped bytes are counted by the ring*/
+        RINGBUFFER_Put(&UARTA2Ring, c);
+        if(UARTA2RxCallback)
         {
-            /*TODO: Buffer Overflow, add handler here*/
+            UARTA2RxCallback();
         }
-        else
+    }
+    PROF_EXIT(PROF_ISR_EUSCIA2);
+}
+
+void EUSCIA3_IRQHandler(void)
+{
+    uint8_t c;
+    uint32_t status = MAP_UART_getEnabledInterruptStatus(EUSCI_A3_BASE);
+    MAP_UART_clearInterruptFlag(EUSCI_A3_BASE, status);
+
+    if(status & EUSCI_A_UART_RECEIVE_INTERRUPT)
+    {
+        c = MAP_UART_receiveData(EUSCI_A3_BASE);
+
+        /*The dropped bytes are counted by the ring*/
+        RINGBUFFER_Put(&UARTA3Ring, c);
+        if(UARTA3RxCallback)
         {
-            UARTA2Data[UARTA2WriteIndex] = c;
-            UARTA2_ADVANCE_WRITE_INDEX;
+            UARTA3RxCallback();
         }
     }
 }
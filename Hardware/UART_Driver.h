@@ -7,11 +7,21 @@
 #include <ti/devices/msp432p4xx/driverlib/uart.h>
 #include <ti/devices/msp432p4xx/driverlib/gpio.h>
 
+/*RX buffer sizes, must be powers of two*/
 #define UARTA0_BUFFERSIZE 128
 #define UARTA2_BUFFERSIZE 128
+#define UARTA3_BUFFERSIZE 128
+/*PC UART TX buffer, drained by the TX interrupt*/
+#define UARTA0_TX_BUFFERSIZE 2048
 
 void UART_Init(uint32_t UART, eUSCI_UART_ConfigV1 UARTConfig);
 void UART_Write(uint32_t UART, uint8_t *Data, uint32_t Size);
 uint32_t UART_Read(uint32_t UART, uint8_t *Data, uint32_t Size);
+uint32_t UART_Available(uint32_t UART);
+uint32_t UART_GetOverflows(uint32_t UART);
+void UART_SetRxCallback(uint32_t UART, void(*Callback)(void));
+void UART_Flush(uint32_t UART);
+uint32_t UART_GetTxDrops(uint32_t UART);
+uint32_t UART_TxFree(uint32_t UART);
 
 #endif /* HARDWARE_UART_DRIVER_H_ */
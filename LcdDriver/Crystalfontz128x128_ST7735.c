@@ -38,7 +38,9 @@
 
 #include <ti/grlib/grlib.h>
 #include "Crystalfontz128x128_ST7735.h"
+#ifndef SIMULATE_HARDWARE
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
 #include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
 #include <stdint.h>
 
@@ -62,10 +64,12 @@ void Crystalfontz128x128_Init(eUSCI_SPI_MasterConfig* config)
     HAL_LCD_PortInit();
     HAL_LCD_SpiInit(config);
 
+#ifndef SIMULATE_HARDWARE
     GPIO_setOutputLowOnPin(LCD_RST_PORT, LCD_RST_PIN);
     HAL_LCD_delay(50);
     GPIO_setOutputHighOnPin(LCD_RST_PORT, LCD_RST_PIN);
     HAL_LCD_delay(120);
+#endif
 
     HAL_LCD_writeCommand(CM_SLPOUT);
     HAL_LCD_delay(200);
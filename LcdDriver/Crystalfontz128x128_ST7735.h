@@ -41,7 +41,11 @@
 
 
 #include <stdint.h>
+#ifndef SIMULATE_HARDWARE
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#else
+#include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#endif
 #include <ti/grlib/grlib.h>
 
 // LCD Screen Dimensions
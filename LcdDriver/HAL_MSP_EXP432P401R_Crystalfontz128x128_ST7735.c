@@ -37,11 +37,19 @@
 //
 //*****************************************************************************
 
+#ifndef SIMULATE_HARDWARE
+
 #include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
 #include <ti/grlib/grlib.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <Hardware/SPI_Driver.h>
+#include <energy.h>
 #include <stdint.h>
 
+// The LCD shares EUSCI_B0 with the SD card: the bus manager switches the profile and the chip
+// selects. The LCD keeps its CS low between the writes, until the SD card takes the bus.
+static SPI_Device_t LCDSPIDevice;
+
 void HAL_LCD_PortInit(void)
 {
     // LCD_SCK
@@ -58,10 +66,7 @@ void HAL_LCD_PortInit(void)
 
 void HAL_LCD_SpiInit(eUSCI_SPI_MasterConfig* config)
 {
-    SPI_initMaster(LCD_EUSCI_BASE, config);
-    SPI_enableModule(LCD_EUSCI_BASE);
-
-    GPIO_setOutputLowOnPin(LCD_CS_PORT, LCD_CS_PIN);
+    SPI_InitDevice(&LCDSPIDevice, LCD_EUSCI_BASE, config, LCD_CS_PORT, LCD_CS_PIN, true);
 
     GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
 }
@@ -75,6 +80,9 @@ void HAL_LCD_SpiInit(eUSCI_SPI_MasterConfig* config)
 //*****************************************************************************
 void HAL_LCD_writeCommand(uint8_t command)
 {
+    if (!SPI_Acquire(&LCDSPIDevice))
+        return;
+
     // Set to command mode
     GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
 
@@ -83,12 +91,15 @@ void HAL_LCD_writeCommand(uint8_t command)
 
     // Transmit data
     UCB0TXBUF = command;
+    ENERGY_COUNT(ENERGY_LCD_SPI, 1);
 
     // USCI_B0 Busy? //
     while (UCB0STATW & UCBUSY);
 
     // Set back to data mode
     GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+
+    SPI_Release(&LCDSPIDevice);
 }
 
 
@@ -100,14 +111,20 @@ void HAL_LCD_writeCommand(uint8_t command)
 //*****************************************************************************
 void HAL_LCD_writeData(uint8_t data)
 {
+    if (!SPI_Acquire(&LCDSPIDevice))
+        return;
+
     // USCI_B0 Busy? //
     while (UCB0STATW & UCBUSY);
 
     // Transmit data
     UCB0TXBUF = data;
+    ENERGY_COUNT(ENERGY_LCD_SPI, 1);
 
     // USCI_B0 Busy? //
     while (UCB0STATW & UCBUSY);
+
+    SPI_Release(&LCDSPIDevice);
 }
 
 //*****************************************************************************
@@ -162,3 +179,5 @@ SysCtlDelay(uint32_t ui32Count)
     bx      lr;
 }
 #endif
+
+#endif // SIMULATE_HARDWARE
@@ -42,7 +42,21 @@
 
 
 #include <stdint.h>
+#ifndef SIMULATE_HARDWARE
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#else
+// SPI master configuration as defined by driverlib, the LCD simulator ignores it
+typedef struct _eUSCI_SPI_MasterConfig
+{
+    uint_fast8_t selectClockSource;
+    uint32_t clockSourceFrequency;
+    uint32_t desiredSpiClock;
+    uint_fast16_t msbFirst;
+    uint_fast16_t clockPhase;
+    uint_fast16_t clockPolarity;
+    uint_fast16_t spiMode;
+} eUSCI_SPI_MasterConfig;
+#endif
 //*****************************************************************************
 //
 // User Configuration for the LCD Driver
@@ -83,6 +97,10 @@ extern void HAL_LCD_writeData(uint8_t data);
 extern void HAL_LCD_PortInit(void);
 extern void HAL_LCD_SpiInit(eUSCI_SPI_MasterConfig*);
 
+#if defined( SIMULATE_HARDWARE )
+#define HAL_LCD_delay(x)
+#else
+
 // Custom __delay_cycles() for non CCS Compiler
 #if !defined( __TI_ARM__ )
 #undef __delay_cycles
@@ -91,5 +109,6 @@ void SysCtlDelay(uint32_t);
 #endif
 
 #define HAL_LCD_delay(x)      __delay_cycles(x * 48)
+#endif
 
 #endif /* HAL_MSP_EXP432P401R_CRYSTALFONTZ128X128_ST7735_H_ */
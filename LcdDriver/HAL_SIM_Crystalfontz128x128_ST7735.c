@@ -0,0 +1,341 @@
+/*!
+    @file       HAL_SIM_Crystalfontz128x128_ST7735.c
+    @brief      Host emulator of the Crystalfontz128x128 LCD and of its HAL
+    @details    Implementation of the HAL_LCD_* functions for the PC build. The ST7735 controller
+                is modelled with its 132x132 GRAM: the MADCTL MX/MY/MV bits are applied like on the
+                real chip, so the orientation offsets used by Crystalfontz128x128_SetDrawFrame() land
+                on the visible area (columns 2..129, rows 1..128).
+                Snapshots are rendered as seen with LCD_ORIENTATION_UP, the one used by mainInterface.
+    @date       19/10/2026
+*/
+
+#ifdef SIMULATE_HARDWARE
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#include "Crystalfontz128x128_ST7735.h"
+#include "HAL_SIM_Crystalfontz128x128_ST7735.h"
+
+/*!
+    @addtogroup LCDSim_Module
+    @{
+*/
+
+#define GRAM_SIZE           132                 //!< Columns and rows of the emulated controller memory
+#define VISIBLE_COL_OFFSET  2                   //!< First GRAM column shown by the panel
+#define VISIBLE_ROW_OFFSET  1                   //!< First GRAM row shown by the panel
+#define JOYSTICK_CENTER     8192                //!< ADC value of a centered joystick axis
+
+static uint16_t gram[GRAM_SIZE][GRAM_SIZE];     //!< Controller memory, indexed [row][column]
+static uint16_t framebuffer[LCDSIM_HEIGHT * LCDSIM_WIDTH];  //!< View of the panel returned to the user
+
+static uint8_t  currentCommand = CM_NOP;        //!< Last command received
+static uint8_t  paramIndex;                     //!< Index of the next parameter byte
+static uint8_t  params[4];                      //!< Parameters of CASET and RASET
+static uint8_t  madctl;                         //!< Memory access control register
+static uint16_t colStart, colEnd = GRAM_SIZE - 1;   //!< Column window set by CASET
+static uint16_t rowStart, rowEnd = GRAM_SIZE - 1;   //!< Row window set by RASET
+static uint16_t colCursor, rowCursor;           //!< RAMWR write pointer
+static bool     pixelHighByte = true;           //!< Next RAMWR byte is the MSB of a pixel
+static uint8_t  pixelMSB;                       //!< MSB of the pixel being received
+
+static LCDSim_FrameStats_t frameStats;          //!< Statistics of the current frame
+static LCDSim_FrameStats_t totalStats;          //!< Statistics since the last reset
+
+static uint16_t joystickX = JOYSTICK_CENTER;    //!< Emulated joystick horizontal axis
+static uint16_t joystickY = JOYSTICK_CENTER;    //!< Emulated joystick vertical axis
+static bool     joystickSelect = false;         //!< Emulated joystick button
+
+/*!
+    @brief      Writes a pixel at the current RAMWR position and advances the pointer
+    @details    The address is translated like the ST7735 does: MV exchanges column and row,
+                then MX mirrors the physical column and MY the physical row.
+    @param      value: RGB565 color
+*/
+static void gramWritePixel(uint16_t value){
+    uint16_t col = (madctl & CM_MADCTL_MV) ? rowCursor : colCursor;
+    uint16_t row = (madctl & CM_MADCTL_MV) ? colCursor : rowCursor;
+    if(madctl & CM_MADCTL_MX){
+        col = GRAM_SIZE - 1 - col;
+    }
+    if(madctl & CM_MADCTL_MY){
+        row = GRAM_SIZE - 1 - row;
+    }
+
+    frameStats.pixelsTouched++;
+    if(col < GRAM_SIZE && row < GRAM_SIZE && gram[row][col] != value){
+        gram[row][col] = value;
+        if(col >= VISIBLE_COL_OFFSET && col < VISIBLE_COL_OFFSET + LCDSIM_WIDTH &&
+           row >= VISIBLE_ROW_OFFSET && row < VISIBLE_ROW_OFFSET + LCDSIM_HEIGHT){
+            frameStats.pixelsChanged++;
+        }
+    }
+
+    //Advance inside the window, wrapping to its start like the controller
+    if(++colCursor > colEnd){
+        colCursor = colStart;
+        if(++rowCursor > rowEnd){
+            rowCursor = rowStart;
+        }
+    }
+}
+
+/*!
+    @brief      Converts a RGB565 color to 24 bit RGB
+    @param      value: RGB565 color
+    @param[out] rgb: red, green and blue bytes
+*/
+static void rgb565ToRgb888(uint16_t value, uint8_t rgb[3]){
+    uint8_t r = (value >> 11) & 0x1F;
+    uint8_t g = (value >> 5) & 0x3F;
+    uint8_t b = value & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+/*!
+    @brief      Adds the statistics of a frame to an accumulator
+*/
+static void addStats(LCDSim_FrameStats_t* dst, const LCDSim_FrameStats_t* src){
+    dst->pixelsTouched += src->pixelsTouched;
+    dst->pixelsChanged += src->pixelsChanged;
+    dst->spiBytes += src->spiBytes;
+    dst->commands += src->commands;
+    dst->drawFrames += src->drawFrames;
+}
+
+/*!
+    @brief      Estimated time spent on the bus for a number of bytes
+*/
+static uint32_t busTimeUs(uint32_t spiBytes){
+    return (uint32_t)(((uint64_t)spiBytes * 8 * 1000000) / LCD_SPI_CLOCK_SPEED);
+}
+
+void HAL_LCD_PortInit(void){
+}
+
+void HAL_LCD_SpiInit(eUSCI_SPI_MasterConfig* config){
+    (void)config;
+}
+
+void HAL_LCD_writeCommand(uint8_t command){
+    frameStats.spiBytes++;
+    frameStats.commands++;
+    currentCommand = command;
+    paramIndex = 0;
+
+    switch(command){
+        case CM_CASET:
+            frameStats.drawFrames++;
+            break;
+        case CM_RAMWR:
+            colCursor = colStart;
+            rowCursor = rowStart;
+            pixelHighByte = true;
+            break;
+        case CM_SWRESET:
+            madctl = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+void HAL_LCD_writeData(uint8_t data){
+    frameStats.spiBytes++;
+
+    switch(currentCommand){
+        case CM_CASET:
+        case CM_RASET:
+            if(paramIndex < 4){
+                params[paramIndex++] = data;
+            }
+            if(paramIndex == 4){
+                uint16_t start = ((uint16_t)params[0] << 8) | params[1];
+                uint16_t end = ((uint16_t)params[2] << 8) | params[3];
+                if(currentCommand == CM_CASET){
+                    colStart = start;
+                    colEnd = end;
+                }else{
+                    rowStart = start;
+                    rowEnd = end;
+                }
+            }
+            break;
+        case CM_MADCTL:
+            madctl = data;
+            break;
+        case CM_RAMWR:
+            if(pixelHighByte){
+                pixelMSB = data;
+            }else{
+                gramWritePixel(((uint16_t)pixelMSB << 8) | data);
+            }
+            pixelHighByte = !pixelHighByte;
+            break;
+        default:
+            //Parameters of other commands do not change the image
+            break;
+    }
+}
+
+/*!
+    @brief      Resets the emulated controller, the statistics and the joystick
+*/
+void LCDSim_Reset(void){
+    memset(gram, 0, sizeof(gram));
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&totalStats, 0, sizeof(totalStats));
+    currentCommand = CM_NOP;
+    paramIndex = 0;
+    madctl = 0;
+    colStart = rowStart = 0;
+    colEnd = rowEnd = GRAM_SIZE - 1;
+    pixelHighByte = true;
+    LCDSim_SetJoystick(JOYSTICK_CENTER, JOYSTICK_CENTER, false);
+}
+
+/*!
+    @brief      Gets a pixel of the panel
+    @param      x: column as seen with LCD_ORIENTATION_UP
+    @param      y: row as seen with LCD_ORIENTATION_UP
+    @return     RGB565 color, 0 if the pixel is outside the panel
+*/
+uint16_t LCDSim_GetPixel(uint16_t x, uint16_t y){
+    if(x >= LCDSIM_WIDTH || y >= LCDSIM_HEIGHT){
+        return 0;
+    }
+    //LCD_ORIENTATION_UP mirrors both axes
+    return gram[VISIBLE_ROW_OFFSET + LCDSIM_HEIGHT - 1 - y][VISIBLE_COL_OFFSET + LCDSIM_WIDTH - 1 - x];
+}
+
+/*!
+    @brief      Gets the content of the panel
+    @return     Pointer to LCDSIM_WIDTH x LCDSIM_HEIGHT RGB565 pixels, row major
+    @note       The buffer is updated at every call
+*/
+const uint16_t* LCDSim_GetFramebuffer(void){
+    uint16_t x, y;
+    for(y = 0; y < LCDSIM_HEIGHT; ++y){
+        for(x = 0; x < LCDSIM_WIDTH; ++x){
+            framebuffer[y * LCDSIM_WIDTH + x] = LCDSim_GetPixel(x, y);
+        }
+    }
+    return framebuffer;
+}
+
+/*!
+    @brief      Closes the current frame
+    @details    Returns the statistics collected since the previous call and adds them to the totals.
+    @param[out] stats: statistics of the frame, can be NULL
+*/
+void LCDSim_EndFrame(LCDSim_FrameStats_t* stats){
+    frameStats.busTimeUs = busTimeUs(frameStats.spiBytes);
+    if(stats != NULL){
+        *stats = frameStats;
+    }
+    addStats(&totalStats, &frameStats);
+    memset(&frameStats, 0, sizeof(frameStats));
+}
+
+/*!
+    @brief      Gets the statistics of all the closed frames since @ref LCDSim_Reset
+    @param[out] stats: total statistics
+*/
+void LCDSim_GetTotalStats(LCDSim_FrameStats_t* stats){
+    *stats = totalStats;
+    stats->busTimeUs = busTimeUs(totalStats.spiBytes);
+}
+
+/*!
+    @brief      Saves the panel as a binary PPM image
+    @param      filename: path of the image
+    @return     true if the image was written
+*/
+bool LCDSim_SavePPM(const char* filename){
+    FILE* f = fopen(filename, "wb");
+    uint8_t rgb[3];
+    uint16_t x, y;
+    if(f == NULL){
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", LCDSIM_WIDTH, LCDSIM_HEIGHT);
+    for(y = 0; y < LCDSIM_HEIGHT; ++y){
+        for(x = 0; x < LCDSIM_WIDTH; ++x){
+            rgb565ToRgb888(LCDSim_GetPixel(x, y), rgb);
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+/*!
+    @brief      Compares the panel with a golden image
+    @param      filename: path of a PPM image saved by @ref LCDSim_SavePPM
+    @return     Number of different pixels, -1 if the image can not be read or has a different size
+*/
+int32_t LCDSim_CompareWithPPM(const char* filename){
+    FILE* f = fopen(filename, "rb");
+    int width, height, maxValue;
+    uint8_t rgb[3], golden[3];
+    int32_t differences = 0;
+    uint16_t x, y;
+    if(f == NULL){
+        return -1;
+    }
+    if(fscanf(f, "P6 %d %d %d", &width, &height, &maxValue) != 3 || fgetc(f) == EOF ||
+       width != LCDSIM_WIDTH || height != LCDSIM_HEIGHT || maxValue != 255){
+        fclose(f);
+        return -1;
+    }
+    for(y = 0; y < LCDSIM_HEIGHT; ++y){
+        for(x = 0; x < LCDSIM_WIDTH; ++x){
+            if(fread(golden, 1, 3, f) != 3){
+                fclose(f);
+                return -1;
+            }
+            rgb565ToRgb888(LCDSim_GetPixel(x, y), rgb);
+            if(memcmp(rgb, golden, 3) != 0){
+                differences++;
+            }
+        }
+    }
+    fclose(f);
+    return differences;
+}
+
+/*!
+    @brief      Sets the emulated joystick read by mainInterface
+    @param      x: horizontal axis, 14 bit ADC value
+    @param      y: vertical axis, 14 bit ADC value
+    @param      select: true if the joystick button is pressed
+*/
+void LCDSim_SetJoystick(uint16_t x, uint16_t y, bool select){
+    joystickX = x;
+    joystickY = y;
+    joystickSelect = select;
+}
+
+uint16_t LCDSim_GetJoystickX(void){
+    return joystickX;
+}
+
+uint16_t LCDSim_GetJoystickY(void){
+    return joystickY;
+}
+
+bool LCDSim_GetJoystickSelect(void){
+    return joystickSelect;
+}
+
+/*! @} */ //End of LCDSim_Module
+
+#endif // SIMULATE_HARDWARE
@@ -0,0 +1,61 @@
+/*!
+    @file       HAL_SIM_Crystalfontz128x128_ST7735.h
+    @brief      Host emulator of the Crystalfontz128x128 LCD and of its HAL
+    @details    When the project is built with SIMULATE_HARDWARE the HAL_LCD_* functions declared in
+                HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h are provided by this module instead of
+                the MSP432 one. The bytes sent to the panel are decoded like the ST7735 controller does
+                (CASET, RASET, RAMWR and MADCTL) and written in a 128x128 RGB565 framebuffer, so the
+                unmodified Crystalfontz driver, grlib and mainInterface.c can run on a PC.
+                The framebuffer can be saved as a PPM image and compared with a golden image, and every
+                frame collects the statistics needed to track the cost of a UI change:
+                 - pixels touched and pixels really changed
+                 - bytes sent on the SPI bus
+                 - draw-frame (CASET/RASET) commands
+    @date       19/10/2026
+*/
+
+#ifndef __HAL_SIM_CRYSTALFONTZLCD_H__
+#define __HAL_SIM_CRYSTALFONTZLCD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   LCDSim_Module LCD Simulator
+    @name       LCD Simulator Module
+    @{
+*/
+
+#define LCDSIM_WIDTH    128                     //!< Visible columns of the panel
+#define LCDSIM_HEIGHT   128                     //!< Visible rows of the panel
+
+/*!
+    @brief Statistics collected by the emulator between two @ref LCDSim_EndFrame calls
+*/
+typedef struct{
+    uint32_t pixelsTouched;                     //!< Pixels written by RAMWR (also outside the panel)
+    uint32_t pixelsChanged;                     //!< Pixels whose color has really changed
+    uint32_t spiBytes;                          //!< Bytes sent on the bus, commands included
+    uint32_t commands;                          //!< Commands sent to the controller
+    uint32_t drawFrames;                        //!< Draw-frame commands (CASET/RASET pairs)
+    uint32_t busTimeUs;                         //!< Estimated bus time at LCD_SPI_CLOCK_SPEED
+} LCDSim_FrameStats_t;
+
+void LCDSim_Reset(void);
+const uint16_t* LCDSim_GetFramebuffer(void);
+uint16_t LCDSim_GetPixel(uint16_t x, uint16_t y);
+
+void LCDSim_EndFrame(LCDSim_FrameStats_t* stats);
+void LCDSim_GetTotalStats(LCDSim_FrameStats_t* stats);
+
+bool LCDSim_SavePPM(const char* filename);
+int32_t LCDSim_CompareWithPPM(const char* filename);
+
+void LCDSim_SetJoystick(uint16_t x, uint16_t y, bool select);
+uint16_t LCDSim_GetJoystickX(void);
+uint16_t LCDSim_GetJoystickY(void);
+bool LCDSim_GetJoystickSelect(void);
+
+/*! @} */ //End of LCDSim_Module
+
+#endif // __HAL_SIM_CRYSTALFONTZLCD_H__
@@ -30,14 +30,25 @@ void MPU6050_init(void)
 
     //for (i=10000; i>0;i--);
 
-    I2C_write8(PWR_MGMT_1, MPU6050_INIT_VALUE);        // Internal 8MHz oscillator, enable sensor, no sleep mode.
+    I2C_write8(PWR_MGMT_1, MPU6050_CLKSEL_PLL_XGYRO);  // PLL with gyroscope reference, enable sensor, no sleep mode.
 
     for (i=10000; i>0;i--);
 
     // 0x1C is the ACCEL_CONFIG Register of MPU6050, AFS_SEL[1:0] bit 3,4 of 8-bit register: 0-->2g; 1-->4g; 2-->8g; 3-->16g;
     I2C_write8(MPU6050_ACCEL_CONFIG_REG, MPU6050_AFS_SEL_REG);
 
+    // 0x1B is the GYRO_CONFIG Register of MPU6050, FS_SEL[1:0] bit 3,4 of 8-bit register: 0-->250; 1-->500; 2-->1000; 3-->2000 deg/s;
+    I2C_write8(MPU6050_GYRO_CONFIG_REG, MPU6050_FS_SEL_REG);
+
+    I2C_write8(MPU6050_CONFIG_REG, MPU6050_DLPF_CFG);              // Low pass filter, no FSYNC
+    I2C_write8(MPU6050_SMPLRT_DIV_REG, MPU6050_SMPLRT_DIV);        // Fixed sample rate of the FIFO
+
     for (i=10000; i>0;i--);
+
+    // Accelerations and angular rates to the FIFO, starting from an empty FIFO
+    I2C_write8(MPU6050_FIFO_EN_REG, MPU6050_FIFO_EN_ACCEL_GYRO);
+    I2C_write8(MPU6050_USER_CTRL_REG, MPU6050_USER_CTRL_FIFO_RESET);
+    I2C_write8(MPU6050_USER_CTRL_REG, MPU6050_USER_CTRL_FIFO_EN);
 }
 
 
@@ -88,6 +99,41 @@ double MPU6050_readTemp_chip(void)
     return (double) (signed)((temp_value_15_8 << 8) | temp_value_7_0 ) / 340.0 + 36.53;
 }
 
+uint16_t MPU6050_fifoSamples(void)
+{
+    uint8_t count[2];
+    I2C_setslave(MPU6050_SLAVE_ADDR);           // Specify slave address for MPU6050
+    if(I2C_read8(MPU6050_INT_STATUS_REG) & MPU6050_INT_FIFO_OFLOW){
+        // The oldest bytes have been overwritten, the next sample would start in the middle: start again
+        I2C_write8(MPU6050_USER_CTRL_REG, MPU6050_USER_CTRL_FIFO_RESET | MPU6050_USER_CTRL_FIFO_EN);
+        return 0;
+    }
+    I2C_readBurst(MPU6050_FIFO_COUNTH_REG, count, sizeof(count));
+    return (uint16_t)((count[0] << 8) | count[1]) / MPU6050_FIFO_SAMPLE_BYTES;
+}
+
+void MPU6050_readFifoRaw(int16_t raw[6])
+{
+    uint8_t data[MPU6050_FIFO_SAMPLE_BYTES];
+    int i;
+    I2C_setslave(MPU6050_SLAVE_ADDR);           // Specify slave address for MPU6050
+    I2C_readBurst(MPU6050_FIFO_R_W_REG, data, sizeof(data));
+    for(i = 0; i < 6; i++){                     // Big endian: accelerations x, y, z then angular rates x, y, z
+        raw[i] = (int16_t)((data[2*i] << 8) | data[2*i + 1]);
+    }
+}
+
+void MPU6050_readFifoSample(MPU6050_sample_t* sample)
+{
+    int16_t raw[6];
+    int i;
+    MPU6050_readFifoRaw(raw);
+    for(i = 0; i < 3; i++){
+        sample->accel[i] = raw[i] / MPU6050_ACCEL_LSB_PER_G;
+        sample->gyro[i] = raw[i + 3] / MPU6050_GYRO_LSB_PER_DPS;
+    }
+}
+
 /*
     @}
 */
\ No newline at end of file
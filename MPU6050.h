@@ -8,6 +8,8 @@
 #ifndef __MPU6050_H_
 #define __MPU6050_H_
 
+#include <stdint.h>
+
 /* MPU6050 COSTANTS */
 #define MPU6050_SLAVE_ADDR              0x68
 #define I2C_SCL                         BIT7
@@ -15,7 +17,15 @@
 
 /* MPU6050 SENSOR REGISTER DEFINITIONS */
 #define PWR_MGMT_1                      0x6B
+#define MPU6050_SMPLRT_DIV_REG          0x19
+#define MPU6050_CONFIG_REG              0x1A
+#define MPU6050_GYRO_CONFIG_REG         0x1B
 #define MPU6050_ACCEL_CONFIG_REG        0x1C
+#define MPU6050_FIFO_EN_REG             0x23
+#define MPU6050_INT_STATUS_REG          0x3A
+#define MPU6050_USER_CTRL_REG           0x6A
+#define MPU6050_FIFO_COUNTH_REG         0x72
+#define MPU6050_FIFO_R_W_REG            0x74
 #define WHO_AM_I_REGISTER               0x75           // Who am I register --> Contains the 6-bit I2C address of the MPU-60X0.
 #define ACCEL_XOUT_MS_REG               0x3B
 #define ACCEL_XOUT_LS_REG               0x3C
@@ -25,11 +35,28 @@
 #define ACCEL_ZOUT_LS_REG               0x40
 #define TEMP_OUT_MS_REG                 0x41
 #define TEMP_OUT_LS_REG                 0x42
+#define GYRO_XOUT_MS_REG                0x43
+#define GYRO_YOUT_MS_REG                0x45
+#define GYRO_ZOUT_MS_REG                0x47
 
 /* CONFIGURATION REGISTER SETTINGS */
 #define MPU6050_DEVICE_RESET            0x80           // bit 7 of PWR_MGMT register, when set to 1, resets all internal registers to their default values.
 #define MPU6050_INIT_VALUE              0x00
 #define MPU6050_AFS_SEL_REG             0x10
+#define MPU6050_CLKSEL_PLL_XGYRO        0x01           // PLL with X axis gyroscope reference, more stable than the internal oscillator when the gyro runs.
+#define MPU6050_DLPF_CFG                0x04           // Digital low pass filter: 21 Hz accelerometer, 20 Hz gyroscope, gyroscope output rate 1 kHz.
+#define MPU6050_SMPLRT_DIV              14             // Sample rate = 1 kHz / (1 + 14) = 66.7 Hz --> ACCEL_WINDOW_SIZE samples every FLASH_PERIOD_MS.
+#define MPU6050_FS_SEL_REG              0x08           // FS_SEL[1:0] bit 3,4 of GYRO_CONFIG: 1 --> 500 deg/s.
+#define MPU6050_FIFO_EN_ACCEL_GYRO      0x78           // XG, YG, ZG and ACCEL to the FIFO: 12 bytes for each sample.
+#define MPU6050_USER_CTRL_FIFO_EN       0x40
+#define MPU6050_USER_CTRL_FIFO_RESET    0x04
+#define MPU6050_INT_FIFO_OFLOW          0x10           // bit 4 of INT_STATUS, the FIFO has overflowed.
+
+#define MPU6050_ACCEL_LSB_PER_G         4096.0f        // +-8 g
+#define MPU6050_GYRO_LSB_PER_DPS        65.5f          // +-500 deg/s
+#define MPU6050_FIFO_SAMPLE_BYTES       12
+#define MPU6050_FIFO_SIZE               1024
+#define MPU6050_SAMPLE_PERIOD_S         ((1.0f + MPU6050_SMPLRT_DIV) / 1000.0f)
 
 
 /*!
@@ -38,8 +65,17 @@
 */
 
 /*!
-    @brief Init of accelerometer sensor
-    @details Initialization of MPU6050_ACCEL_CONFIG_REG register with MPU6050_DEVICE_RESET and MPU6050_INIT_VALUE value.
+    @brief Sample of accelerometer and gyroscope read from the FIFO.
+*/
+typedef struct {
+    float accel[3];                 //!< x, y, z acceleration [g]
+    float gyro[3];                  //!< x, y, z angular rate [deg/s]
+} MPU6050_sample_t;
+
+/*!
+    @brief Init of accelerometer and gyroscope sensor
+    @details Initialization of PWR_MGMT_1, sample rate, low pass filter, MPU6050_ACCEL_CONFIG_REG and MPU6050_GYRO_CONFIG_REG registers.
+             The samples are stored in the FIFO at the fixed rate of MPU6050_SMPLRT_DIV, so they are not lost between two BSS windows.
 */
 void MPU6050_init(void);
 
@@ -78,6 +114,27 @@ double MPU6050_readZvalue(void);
 */
 double MPU6050_readTemp_chip(void);
 
+/*!
+    @brief Number of complete samples in the FIFO.
+    @details Read MPU6050_FIFO_COUNTH_REG with a burst read. If the FIFO has overflowed the samples are no longer aligned: the FIFO is reset and 0 is returned.
+    @param[out] samples: number of samples ready.
+*/
+uint16_t MPU6050_fifoSamples(void);
+
+/*!
+    @brief Read the oldest sample of the FIFO as raw counts.
+    @details Burst read of MPU6050_FIFO_SAMPLE_BYTES bytes from MPU6050_FIFO_R_W_REG.
+    @param[out] raw: accelerations x, y, z [1/MPU6050_ACCEL_LSB_PER_G g] and angular rates x, y, z [1/MPU6050_GYRO_LSB_PER_DPS deg/s].
+*/
+void MPU6050_readFifoRaw(int16_t raw[6]);
+
+/*!
+    @brief Read the oldest sample of the FIFO.
+    @details Burst read of MPU6050_FIFO_SAMPLE_BYTES bytes from MPU6050_FIFO_R_W_REG, converted to g and deg/s.
+    @param[out] sample: accelerations and angular rates.
+*/
+void MPU6050_readFifoSample(MPU6050_sample_t* sample);
+
 /*
     @}
 */
@@ -0,0 +1,284 @@
+"""Evaluation of the attitude filter of the bike computer (see attitude.h) on IMU traces.
+
+Runs the same Mahony filter of attitude.c on a trace of accelerometer and gyroscope samples at the
+fixed rate of the MPU6050 FIFO. Without a trace a synthetic ride is generated with its ground truth
+(still start, acceleration, braking, turns with the lean of a coordinated turn, a climb, gyroscope
+bias, vibrations, a unit mounted tilted) and the errors are checked against the limits of the
+regression suite: the exit status is 1 if a limit is exceeded.
+
+Traces are CSV files with a header, one row per sample:
+    ax,ay,az [g], gx,gy,gz [deg/s], optional speed [m/s]
+and, when known, the truth: roll, pitch [deg], yaw_rate [deg/s], lin_x [g].
+
+Usage:
+    python3 Test/attitude.py                                # synthetic ride, regression limits
+    python3 Test/attitude.py --seed 3 --write ride.csv      # save the synthetic trace
+    python3 Test/attitude.py ride.csv --csv out.csv         # recorded trace, per sample estimate
+    python3 Test/attitude.py --check-c build/test/attitudeHost   # same estimate from attitude.c
+"""
+
+import argparse
+import csv
+import math
+import random
+import subprocess
+import sys
+
+SAMPLE_PERIOD = 15 / 1000.0     # s, MPU6050_SAMPLE_PERIOD_S
+KP = 1.0
+KI = 0.02
+KP_START = 10.0
+START_S = 2.0
+ACCEL_GATE = 0.15               # g
+STILL_RATE = 3.0                # deg/s
+STILL_GATE = 0.03               # g
+BIAS_TAU = 4.0                  # s
+YAW_RATE_TAU = 0.1              # s
+STILL_SPEED = 0.5               # m/s
+ALONG_MAX = 5.0                 # m/s^2
+GRAVITY = 9.81
+WINDOW_SIZE = 10                # ACCEL_WINDOW_SIZE, samples averaged by the BSS
+
+# Regression limits on the synthetic rides: rms error, lin_x on the mean of the BSS windows
+LIMITS = {"roll": 2.0, "pitch": 1.0, "yaw_rate": 1.0, "lin_x": 0.03}
+# Largest difference of attitude.c from this model, single against double precision
+C_TOLERANCES = {"roll": 0.01, "pitch": 0.01, "yaw_rate": 0.01, "lin_x": 0.001}
+INPUTS = ("ax", "ay", "az", "gx", "gy", "gz", "speed")
+
+
+class Attitude:
+    """Same filter of attitude.c, one call of update() per sample."""
+
+    def __init__(self, period=SAMPLE_PERIOD):
+        self.period = period
+        self.valid = False
+        self.speed = 0.0
+        self.along = 0.0
+        self.speed_samples = 0
+        self.bias = [0.0, 0.0, 0.0]
+
+    def set_speed(self, speed):
+        if self.speed_samples > 0:
+            along = (speed - self.speed) / (self.speed_samples * self.period)
+            self.along = max(-ALONG_MAX, min(ALONG_MAX, along))
+        self.speed_samples = 0
+        self.speed = speed
+
+    def up_from_q(self):
+        q = self.q
+        self.up = [2 * (q[1] * q[3] - q[0] * q[2]), 2 * (q[0] * q[1] + q[2] * q[3]),
+                   q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]]
+
+    def start(self, accel):
+        roll = math.atan2(accel[1], accel[2])
+        pitch = math.atan2(-accel[0], math.hypot(accel[1], accel[2]))
+        cr, sr = math.cos(roll / 2), math.sin(roll / 2)
+        cp, sp = math.cos(pitch / 2), math.sin(pitch / 2)
+        self.q = [cr * cp, sr * cp, cr * sp, -sr * sp]
+        self.integral = [0.0, 0.0, 0.0]
+        self.yaw_rate = 0.0
+        self.time = 0.0
+        self.up_from_q()
+        self.valid = True
+
+    def update(self, accel, gyro):
+        dt = self.period
+        if not self.valid:
+            self.start(accel)
+        w = [math.radians(gyro[i] - self.bias[i]) for i in range(3)]
+        g = [accel[0] - self.along / GRAVITY, accel[1] - w[2] * self.speed / GRAVITY, accel[2] + w[1] * self.speed / GRAVITY]
+        norm = math.sqrt(sum(v * v for v in g))
+        if abs(norm - 1) < ACCEL_GATE:
+            kp = KP_START if self.time < START_S else KP
+            g = [v / norm for v in g]
+            up = self.up
+            e = [g[1] * up[2] - g[2] * up[1], g[2] * up[0] - g[0] * up[2], g[0] * up[1] - g[1] * up[0]]
+            for i in range(3):
+                if self.time >= START_S:
+                    self.integral[i] += KI * e[i] * dt
+                w[i] += kp * e[i] + self.integral[i]
+        if (self.speed < STILL_SPEED and abs(norm - 1) < STILL_GATE and
+                all(abs(gyro[i] - self.bias[i]) < STILL_RATE for i in range(3))):
+            for i in range(3):
+                self.bias[i] += (gyro[i] - self.bias[i]) * dt / BIAS_TAU
+        q = self.q
+        dq = [-q[1] * w[0] - q[2] * w[1] - q[3] * w[2],
+              q[0] * w[0] + q[2] * w[2] - q[3] * w[1],
+              q[0] * w[1] - q[1] * w[2] + q[3] * w[0],
+              q[0] * w[2] + q[1] * w[1] - q[2] * w[0]]
+        q = [q[i] + 0.5 * dq[i] * dt for i in range(4)]
+        norm = math.sqrt(sum(v * v for v in q))
+        self.q = [v / norm for v in q]
+        self.up_from_q()
+        self.linear = [accel[i] - self.up[i] for i in range(3)]
+        yaw_rate = -sum((gyro[i] - self.bias[i]) * self.up[i] for i in range(3))
+        self.yaw_rate += (yaw_rate - self.yaw_rate) * dt / (YAW_RATE_TAU + dt)
+        if self.time < START_S:
+            self.time += dt
+        self.speed_samples += 1
+
+    @property
+    def roll(self):
+        return math.degrees(math.atan2(self.up[1], self.up[2]))
+
+    @property
+    def pitch(self):
+        return math.degrees(math.asin(max(-1.0, min(1.0, self.up[0]))))
+
+
+def rotation(roll, pitch, yaw):
+    """Sensor to earth (x east, y north, z up), yaw counterclockwise, pitch nose up, roll leaning right"""
+    cr, sr = math.cos(roll), math.sin(roll)
+    cp, sp = math.cos(-pitch), math.sin(-pitch)
+    cy, sy = math.cos(yaw), math.sin(yaw)
+    return [[cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr],
+            [sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr],
+            [-sp, cp * sr, cp * cr]]
+
+
+def synthetic_ride(seed, period=SAMPLE_PERIOD, tilt=True):
+    """Samples of a ride with the truth: list of dicts with ax..gz, speed, roll, pitch, yaw_rate, lin_x"""
+    rnd = random.Random(seed)
+    mount = math.radians(rnd.uniform(-6, 6)) if tilt else 0.0  # Unit tilted on the handlebar
+    bias = [rnd.uniform(-2, 2) for _ in range(3)]           # deg/s
+    # Segments: (duration s, acceleration m/s^2, turn rate deg/s clockwise, grade %)
+    plan = [(6, 0, 0, 0), (8, 1.0, 0, 0), (10, 0, 0, 0), (8, 0, 20, 0), (6, 0, 0, 0), (4, -2.5, 0, 0),
+            (6, 0.6, 0, 0), (20, 0, 0, 6), (6, 0, -25, 0), (10, 0, 0, -4), (3, -3.0, 0, 0), (5, 0, 0, 0)]
+    samples = []
+    speed = 0.0
+    yaw = rnd.uniform(-math.pi, math.pi)
+    grade = 0.0
+    turn = 0.0
+    previous = None
+    t = 0.0
+    for duration, accel, turn_target, grade_target in plan:
+        for _ in range(int(duration / period)):
+            # Smooth transitions of turn rate and grade, first order with 1 s
+            turn += (math.radians(-turn_target) - turn) * period / 1.0
+            grade += (math.atan(grade_target / 100.0) - grade) * period / 1.0
+            along = accel if speed > 0 or accel > 0 else 0.0
+            speed = max(0.0, speed + along * period)
+            if speed == 0:
+                along = 0.0
+            yaw += turn * period
+            roll = math.atan(-speed * turn / GRAVITY)
+            pitch = grade + mount
+            state = (roll, pitch, yaw)
+            if previous is None:
+                previous = state
+            rates = [(state[i] - previous[i]) / period for i in range(3)]
+            previous = state
+            # Body angular rate from the Euler rates (yaw, pitch about -y, roll)
+            sr, cr = math.sin(roll), math.cos(roll)
+            sp, cp = math.sin(-pitch), math.cos(-pitch)
+            w = [rates[0] - rates[2] * sp,
+                 -rates[1] * cr + rates[2] * cp * sr,
+                 rates[1] * sr + rates[2] * cp * cr]
+            # Specific force: along-track and centripetal acceleration plus gravity, in the sensor frame
+            heading = [math.cos(yaw) * math.cos(grade), math.sin(yaw) * math.cos(grade), math.sin(grade)]
+            left = [-math.sin(yaw), math.cos(yaw), 0.0]
+            a = [along * heading[i] + speed * turn * left[i] for i in range(3)]
+            a[2] += GRAVITY
+            r = rotation(roll, pitch, yaw)
+            f = [sum(r[j][i] * a[j] for j in range(3)) / GRAVITY for i in range(3)]
+            vibration = 0.01 + 0.01 * speed
+            sample = {"ax": f[0] + rnd.gauss(0, vibration), "ay": f[1] + rnd.gauss(0, vibration),
+                      "az": f[2] + rnd.gauss(0, vibration)}
+            for i, axis in enumerate("xyz"):
+                sample["g" + axis] = math.degrees(w[i]) + bias[i] + rnd.gauss(0, 0.1)
+            # Truth: the specific force without the gravity, in the sensor frame
+            lin = [sum(r[j][i] * (a[j] - (GRAVITY if j == 2 else 0)) for j in range(3)) / GRAVITY for i in range(3)]
+            sample.update(speed=speed, roll=math.degrees(roll), pitch=math.degrees(pitch),
+                          yaw_rate=-math.degrees(turn), lin_x=lin[0], time=t)
+            samples.append(sample)
+            t += period
+    return samples
+
+
+def read_trace(path):
+    with open(path, newline="") as trace:
+        return [{key: float(value) for key, value in row.items() if value not in (None, "")}
+                for row in csv.DictReader(trace)]
+
+
+def run(samples, period=SAMPLE_PERIOD):
+    """Runs the filter, returns the estimate of every sample. The speed is given once per BSS window"""
+    filt = Attitude(period)
+    out = []
+    for number, sample in enumerate(samples):
+        if number % WINDOW_SIZE == 0:
+            filt.set_speed(sample.get("speed", 0.0))
+        filt.update((sample["ax"], sample["ay"], sample["az"]), (sample["gx"], sample["gy"], sample["gz"]))
+        out.append({"roll": filt.roll, "pitch": filt.pitch, "yaw_rate": filt.yaw_rate, "lin_x": filt.linear[0]})
+    return out
+
+
+def errors(samples, estimates, skip):
+    """Rms and max error of every output with a truth, after the first skip seconds"""
+    result = {}
+    for key in LIMITS:
+        diffs = [e[key] - s[key] for s, e in zip(samples, estimates) if key in s][int(skip / SAMPLE_PERIOD):]
+        if key == "lin_x":
+            diffs = [sum(diffs[i:i + WINDOW_SIZE]) / WINDOW_SIZE for i in range(0, len(diffs) - WINDOW_SIZE + 1, WINDOW_SIZE)]
+        if diffs:
+            result[key] = (math.sqrt(sum(d * d for d in diffs) / len(diffs)), max(abs(d) for d in diffs))
+    return result
+
+
+def check_c(binary, samples, estimates):
+    """Runs the trace through attitude.c (Test/attitudeHost.c), returns the largest difference of every output"""
+    trace = ",".join(INPUTS) + "\n" + "".join(",".join("%.9g" % s.get(key, 0.0) for key in INPUTS) + "\n"
+                                              for s in samples)
+    output = subprocess.run([binary], input=trace, capture_output=True, text=True, check=True).stdout
+    rows = list(csv.DictReader(output.splitlines()))
+    if len(rows) != len(estimates):
+        return {key: math.inf for key in C_TOLERANCES}
+    return {key: max(abs(float(row[key]) - e[key]) for row, e in zip(rows, estimates)) for key in C_TOLERANCES}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Attitude filter on a synthetic or recorded IMU trace")
+    parser.add_argument("trace", nargs="?", help="CSV trace, a synthetic ride without it")
+    parser.add_argument("--seed", type=int, action="append", help="seed of the synthetic ride (repeatable)")
+    parser.add_argument("--write", metavar="FILE", help="write the synthetic trace of the first seed")
+    parser.add_argument("--csv", metavar="FILE", help="write the estimate of every sample")
+    parser.add_argument("--skip", type=float, default=3.0, help="convergence time left out of the errors [s]")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with attitude.c run by Test/attitudeHost.c")
+    args = parser.parse_args()
+
+    traces = [(args.trace, read_trace(args.trace))] if args.trace else \
+        [("seed %d" % seed, synthetic_ride(seed)) for seed in (args.seed or range(5))]
+    if args.write and not args.trace:
+        with open(args.write, "w", newline="") as out:
+            writer = csv.DictWriter(out, ["ax", "ay", "az", "gx", "gy", "gz", "speed", "roll", "pitch", "yaw_rate",
+                                          "lin_x"], extrasaction="ignore")
+            writer.writeheader()
+            writer.writerows({k: "%.5f" % v for k, v in s.items()} for s in traces[0][1])
+
+    failed = False
+    for name, samples in traces:
+        estimates = run(samples)
+        result = errors(samples, estimates, args.skip)
+        print("%-10s %6d samples  %s" % (name, len(samples), "  ".join(
+            "%s rms %.3f max %.3f" % (key, rms, peak) for key, (rms, peak) in result.items()) or "no truth"))
+        for key, (rms, _) in result.items():
+            if rms > LIMITS[key]:
+                print("  %s rms %.3f over the limit %.3f" % (key, rms, LIMITS[key]))
+                failed = True
+        if args.check_c:
+            diffs = check_c(args.check_c, samples, estimates)
+            print("  attitude.c  " + "  ".join("%s max diff %.5f" % item for item in diffs.items()))
+            for key, diff in diffs.items():
+                if diff > C_TOLERANCES[key]:
+                    print("  %s of attitude.c differs by %.5f, over %.5f" % (key, diff, C_TOLERANCES[key]))
+                    failed = True
+        if args.csv:
+            with open(args.csv, "w", newline="") as out:
+                writer = csv.DictWriter(out, ["roll", "pitch", "yaw_rate", "lin_x"])
+                writer.writeheader()
+                writer.writerows({k: "%.4f" % v for k, v in e.items()} for e in estimates)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+/*!
+    @file       attitudeHost.c
+    @brief      Attitude filter of attitude.c on a trace of samples read from the standard input
+    @details    The trace is the CSV of Test/attitude.py: a header, then a row per sample with
+                ax,ay,az [g], gx,gy,gz [deg/s] and speed [m/s]; the other columns are ignored. The
+                speed is given once per BSS window, as the BSS task does. For every sample the
+                estimate is printed as roll,pitch,yaw_rate,lin_x, the same columns of the --csv
+                option of Test/attitude.py, which runs this program with --check-c and compares them.
+
+                Usage:
+                    python3 Test/attitude.py --write ride.csv
+                    build/test/attitudeHost < ride.csv > estimate.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local Includes */
+#include "attitude.h"
+
+#define SAMPLE_PERIOD_S     0.015f      //!< MPU6050_SAMPLE_PERIOD_S
+#define WINDOW_SIZE         10          //!< ACCEL_WINDOW_SIZE
+#define LINE_LEN            512
+#define MAX_COLUMNS         16
+
+static const char* const inputNames[] = {"ax", "ay", "az", "gx", "gy", "gz", "speed"};
+#define INPUTS              (sizeof(inputNames) / sizeof(inputNames[0]))
+
+/*!
+    @brief      Column of every input in the header, -1 if missing
+*/
+static bool parseHeader(char* line, int column[INPUTS]){
+    char* name;
+    int n = 0;
+    uint32_t i;
+
+    for(i = 0; i < INPUTS; ++i){
+        column[i] = -1;
+    }
+    for(name = strtok(line, ",\r\n"); name != NULL; name = strtok(NULL, ",\r\n"), ++n){
+        for(i = 0; i < INPUTS; ++i){
+            if(strcmp(name, inputNames[i]) == 0){
+                column[i] = n;
+            }
+        }
+    }
+    for(i = 0; i < 6; ++i){                 //The speed is optional
+        if(column[i] < 0){
+            fprintf(stderr, "column %s missing\n", inputNames[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void){
+    char line[LINE_LEN];
+    int column[INPUTS];
+    float fields[MAX_COLUMNS], input[INPUTS], linear[3];
+    uint32_t samples = 0, i;
+    char* p;
+    int n;
+
+    if(fgets(line, sizeof(line), stdin) == NULL || !parseHeader(line, column)){
+        return 1;
+    }
+    attitudeReset(SAMPLE_PERIOD_S);
+    printf("roll,pitch,yaw_rate,lin_x\n");
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        for(p = line, n = 0; n < MAX_COLUMNS && *p != '\0' && *p != '\n'; ++n){
+            fields[n] = strtof(p, &p);
+            p += *p == ',';
+        }
+        for(i = 0; i < INPUTS; ++i){
+            input[i] = column[i] >= 0 && column[i] < n ? fields[column[i]] : 0.0f;
+        }
+        if(samples++ % WINDOW_SIZE == 0){
+            attitudeSetSpeed(input[6]);
+        }
+        attitudeUpdate(&input[0], &input[3]);
+        attitudeGetLinearAccel(linear);
+        printf("%.4f,%.4f,%.4f,%.4f\n", attitudeGetRoll(), attitudeGetPitch(), attitudeGetYawRate(), linear[0]);
+    }
+    return 0;
+}
@@ -0,0 +1,324 @@
+"""Evaluation of the state machine of the BSS (see bssFsm.h) on synthetic windows.
+
+Runs the same tables of bssFsm.c and fsm.c, one step per BSS window, and the classifier they
+replace (back to CLASS_IDLE at every window, the flashes counted by the timer) on scenarios near the
+thresholds: noisy light around the threshold, dusk, a sensor hovering around the maximum
+temperature, short and long braking, noisy braking and a crash while braking. The outputs of both
+are compared: the changes of the lights and the windows of braking flash. The thresholds can be
+read from a BSS.CSV file as on the SD, so a tuning is evaluated before it is copied on the card.
+The exit status is 1 if the state machine does not behave as expected.
+
+Usage:
+    python3 Test/bssFsm.py                          # default thresholds
+    python3 Test/bssFsm.py --config BSS.CSV         # thresholds of the SD
+    python3 Test/bssFsm.py --write BSS.CSV          # default file
+    python3 Test/bssFsm.py --check-c build/test/bssFsmHost  # same classes and lights from bssFsm.c
+"""
+
+import argparse
+import math
+import random
+import struct
+import subprocess
+import sys
+
+FLASH_PERIOD_MS = 150
+NUM_FLASH = 4
+PATTERN_TICKS = 8
+ANY = 0xFF
+PREEMPT = 0x01
+IDLE, ERROR, BRAKING, MOVING, LOW, CRASH = range(6)
+NAMES = ("IDLE", "ERROR", "BRAKING", "MOVING", "LOW_AMBIENT_LIGHT", "CRASH")
+
+# name, default, min, max, fraction digits: the same of bfParams
+PARAMS = [
+    ("brake_acc", -0.5, -4.0, 0.0, 2),
+    ("brake_release", 0.1, 0.0, 2.0, 2),
+    ("brake_min_ms", NUM_FLASH * FLASH_PERIOD_MS, 0.0, 10000.0, 0),
+    ("light_on", 30.0, 0.0, 100.0, 1),
+    ("light_hysteresis", 5.0, 0.0, 50.0, 1),
+    ("light_debounce_ms", 1000.0, 0.0, 10000.0, 0),
+    ("t_max", 60.0, 20.0, 85.0, 1),
+    ("t_hysteresis", 5.0, 0.0, 30.0, 1),
+    ("error_debounce_ms", 300.0, 0.0, 10000.0, 0),
+    ("error_min_ms", NUM_FLASH * FLASH_PERIOD_MS, 0.0, 10000.0, 0),
+]
+
+# Patterns of the outputs (rear, front, keep rear, keep front), the same of bfPatterns
+PATTERNS = {IDLE: (0x00, 0x00, True, True), ERROR: (0x55, 0x55, False, False), BRAKING: (0xFF, 0x00, False, True),
+            MOVING: (0x05, 0x01, False, False), LOW: (0xFF, 0xFF, False, False), CRASH: (0x15, 0x15, False, False)}
+
+
+def default_config():
+    return {name: default for name, default, _, _, _ in PARAMS}
+
+
+def read_config(path):
+    """Same parsing of bssFsmParseParam: unknown names and values out of range are skipped"""
+    config = default_config()
+    limits = {name: (low, high) for name, _, low, high, _ in PARAMS}
+    with open(path) as lines:
+        for line in lines:
+            name, _, value = line.strip().partition(",")
+            try:
+                value = float(value)
+            except ValueError:
+                continue
+            if name in limits and limits[name][0] <= value <= limits[name][1]:
+                config[name] = value
+    return config
+
+
+def write_config(path, config):
+    with open(path, "w") as out:
+        out.write("name,value\n")
+        for name, _, _, _, digits in PARAMS:
+            out.write("%s,%.*f\n" % (name, digits, config[name]))
+
+
+class Fsm:
+    """Same engine of fsm.c"""
+
+    def __init__(self, states, transitions, initial):
+        self.states = states                # state: min dwell
+        self.transitions = transitions      # (from, to, flags, debounce, guard)
+        self.state = initial
+        self.dwell = 0
+        self.held = [0] * len(transitions)
+
+    def step(self, inputs):
+        self.dwell += 1
+        dwelt = self.dwell >= self.states[self.state]
+        for i, (origin, to, flags, debounce, guard) in enumerate(self.transitions):
+            if not (origin == self.state or (origin == ANY and to != self.state)):
+                continue
+            if guard is not None and not guard(inputs):
+                self.held[i] = 0
+                continue
+            self.held[i] += 1
+            if self.held[i] > debounce and (dwelt or flags & PREEMPT):
+                self.state = to
+                self.dwell = 0
+                self.held = [0] * len(self.transitions)
+                return True
+        return False
+
+
+def windows(ms):
+    return int(math.ceil(ms / FLASH_PERIOD_MS))
+
+
+def debounce(ms):
+    return max(0, windows(ms) - 1)
+
+
+def bss_fsm(c):
+    """Tables of bssFsm.c with the timings of the configuration"""
+    hot = lambda m: m["temp"] > c["t_max"]
+    cool = lambda m: m["temp"] < c["t_max"] - c["t_hysteresis"]
+    braking = lambda m: m["acc"] < c["brake_acc"]
+    released = lambda m: m["acc"] > c["brake_acc"] + c["brake_release"]
+    dark = lambda m: m["light"] < c["light_on"]
+    bright = lambda m: m["light"] > c["light_on"] + c["light_hysteresis"]
+    error_db = debounce(c["error_debounce_ms"])
+    light_db = debounce(c["light_debounce_ms"])
+    states = {IDLE: 0, ERROR: windows(c["error_min_ms"]), BRAKING: windows(c["brake_min_ms"]),
+              MOVING: 0, LOW: 0, CRASH: 0}
+    transitions = [
+        (ANY, CRASH, PREEMPT, 0, lambda m: m["crash"]),
+        (CRASH, IDLE, 0, 0, lambda m: not m["crash"]),
+        (IDLE, ERROR, 0, error_db, hot),
+        (MOVING, ERROR, 0, error_db, hot),
+        (LOW, ERROR, 0, error_db, hot),
+        (BRAKING, ERROR, 0, error_db, hot),
+        (ERROR, IDLE, 0, 0, cool),
+        (IDLE, BRAKING, 0, 0, braking),
+        (MOVING, BRAKING, 0, 0, braking),
+        (LOW, BRAKING, 0, 0, braking),
+        (BRAKING, IDLE, 0, 0, released),
+        (IDLE, LOW, 0, 0, dark),
+        (IDLE, MOVING, 0, 0, None),
+        (MOVING, LOW, 0, light_db, dark),
+        (LOW, MOVING, 0, light_db, bright),
+    ]
+    return Fsm(states, transitions, IDLE)
+
+
+def run_fsm(trace, config):
+    """Lights of every window with the state machine: (rear, front, class)"""
+    fsm = bss_fsm(config)
+    rear = front = False
+    out = []
+    for m in trace:
+        fsm.step(m)
+        # Timer tick after the step: the pattern from the entry in the class
+        pattern = PATTERNS[fsm.state]
+        tick = 1 << (fsm.dwell % PATTERN_TICKS)
+        if not pattern[2]:
+            rear = bool(pattern[0] & tick)
+        if not pattern[3]:
+            front = bool(pattern[1] & tick)
+        out.append((rear, front, fsm.state))
+    return out
+
+
+def run_old(trace, config):
+    """Classifier before the state machine, with the thresholds of the configuration"""
+    state = IDLE
+    count_flash = 0
+    rear = front = False
+    out = []
+    for m in trace:
+        if state == IDLE:
+            count_flash = 0
+            if m["crash"]:
+                state = CRASH
+            elif m["temp"] > config["t_max"]:
+                state = ERROR
+            elif m["acc"] < config["brake_acc"]:
+                state = BRAKING
+            elif m["light"] < config["light_on"]:
+                state = LOW
+            else:
+                state = MOVING
+        elif state in (ERROR, BRAKING):
+            if count_flash >= NUM_FLASH and not (state == ERROR and m["temp"] > config["t_max"]):
+                state = IDLE
+                count_flash = 0
+        elif state == MOVING:
+            rear = front = False
+            count_flash = 0
+            state = IDLE
+        elif state == LOW:
+            rear = front = True
+            count_flash = 0
+            state = IDLE
+        elif state == CRASH and not m["crash"]:
+            rear = front = False
+            count_flash = 0
+            state = IDLE
+        # Flashing timer
+        if state == ERROR:
+            count_flash += 1
+            rear, front = not rear, not front
+        elif state == BRAKING:
+            count_flash += 1
+            rear = not rear
+        out.append((rear, front, state))
+    return out
+
+
+def trace(n, rnd, acc=0.0, light=60.0, temp=35.0, noise_acc=0.03, noise_light=1.0, noise_temp=0.2):
+    return [{"acc": acc + rnd.gauss(0, noise_acc), "light": light + rnd.gauss(0, noise_light),
+             "temp": temp + rnd.gauss(0, noise_temp), "crash": False} for _ in range(n)]
+
+
+def scenarios(seed):
+    """(name, windows, check of the state machine outputs)"""
+    rnd = random.Random(seed)
+    out = []
+    w = int(1000 / FLASH_PERIOD_MS)       # windows per second
+
+    noisy = trace(60 * w, rnd, light=31.0, noise_light=2.5)
+    out.append(("light near threshold", noisy, lambda r: changes(r) <= 2))
+
+    dusk = trace(90 * w, rnd)
+    for i, m in enumerate(dusk):
+        m["light"] = 60 - 50 * i / len(dusk) + rnd.gauss(0, 3)
+    out.append(("dusk", dusk, lambda r: changes(r) == 1))
+
+    hot = trace(60 * w, rnd, temp=59.0, noise_temp=1.5)
+    out.append(("hot sensor", hot, lambda r: entries(r, ERROR) <= 2))
+
+    short = trace(5 * w, rnd) + trace(1, rnd, acc=-0.8) + trace(5 * w, rnd)
+    out.append(("short braking", short, lambda r: count(r, BRAKING) == windows(NUM_FLASH * FLASH_PERIOD_MS)))
+
+    long_brake = trace(5 * w, rnd) + trace(3 * w, rnd, acc=-0.7) + trace(5 * w, rnd)
+    out.append(("long braking", long_brake, lambda r: entries(r, BRAKING) == 1 and count(r, BRAKING) >= 3 * w))
+
+    edge = trace(5 * w, rnd) + trace(4 * w, rnd, acc=-0.52, noise_acc=0.04) + trace(5 * w, rnd)
+    out.append(("braking near threshold", edge, lambda r: entries(r, BRAKING) <= 2))
+
+    crash = trace(5 * w, rnd) + trace(2, rnd, acc=-1.5) + trace(10 * w, rnd)
+    for m in crash[5 * w + 1:]:
+        m["crash"] = True
+    out.append(("crash while braking", crash, lambda r: r[5 * w + 1][2] == CRASH))
+
+    night = trace(5 * w, rnd, light=10.0) + trace(2 * w, rnd, light=10.0, acc=-0.7) + trace(5 * w, rnd, light=10.0)
+    out.append(("braking at night", night, lambda r: all(front for _, front, s in r[w:] if s == BRAKING)))
+    return out
+
+
+def f32(value):
+    """Value rounded to single precision, as the window average of the model"""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def check_c(binary, trace, result, config_path):
+    """Runs the windows through bssFsm.c (Test/bssFsmHost.c), returns the first window that differs or None"""
+    rows = "acc,light,temp,crash\n" + "".join("%.9g,%.17g,%.17g,%d\n" % (m["acc"], m["light"], m["temp"], m["crash"])
+                                               for m in trace)
+    output = subprocess.run([binary] + ([config_path] if config_path else []), input=rows, capture_output=True,
+                            text=True, check=True).stdout
+    lines = output.splitlines()[1:]
+    for number, (line, (rear, front, state)) in enumerate(zip(lines, result)):
+        if line != "%d,%d,%d" % (state, rear, front):
+            return number, line
+    if len(lines) != len(result):
+        return len(lines), "end"
+    return None
+
+
+def changes(result):
+    """Changes of the lights between day (moving) and night (low ambient light), the flashing of error,
+    braking and crash excluded"""
+    steady = [r[2] for r in result if r[2] in (MOVING, LOW)]
+    return sum(1 for a, b in zip(steady, steady[1:]) if a != b)
+
+
+def entries(result, state):
+    return sum(1 for a, b in zip([None] + result, result) if b[2] == state and (a is None or a[2] != state))
+
+
+def count(result, state):
+    return sum(1 for r in result if r[2] == state)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="BSS state machine on synthetic windows")
+    parser.add_argument("--config", help="BSS.CSV with the thresholds")
+    parser.add_argument("--write", help="write the default BSS.CSV")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with bssFsm.c run by Test/bssFsmHost.c")
+    args = parser.parse_args()
+
+    if args.write:
+        write_config(args.write, default_config())
+    config = read_config(args.config) if args.config else default_config()
+
+    failed = False
+    for name, windows_, check in scenarios(args.seed):
+        for m in windows_:
+            m["acc"] = f32(m["acc"])
+        new = run_fsm(windows_, config)
+        old = run_old(windows_, config)
+        ok = check(new)
+        print("%-24s %4d windows  day/night changes %2d (%2d before)  error entries %2d (%2d)  "
+              "braking %3d windows in %d (%3d in %2d)%s" %
+              (name, len(windows_), changes(new), changes(old), entries(new, ERROR), entries(old, ERROR),
+               count(new, BRAKING), entries(new, BRAKING), count(old, BRAKING), entries(old, BRAKING),
+               "" if ok else "  <-- not as expected"))
+        failed |= not ok
+        if args.check_c:
+            diff = check_c(args.check_c, windows_, new, args.config)
+            if diff:
+                print("  bssFsm.c differs at window %d: %s, %s expected" % (diff[0], diff[1], "%d,%d,%d" % (
+                    new[diff[0]][2], new[diff[0]][0], new[diff[0]][1]) if diff[0] < len(new) else "end"))
+                failed = True
+            else:
+                print("  bssFsm.c same classes and lights")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
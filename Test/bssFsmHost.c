@@ -0,0 +1,87 @@
+/*!
+    @file       bssFsmHost.c
+    @brief      State machine of bssFsm.c and fsm.c on BSS windows read from the standard input
+    @details    The windows are the ones of the scenarios of Test/bssFsm.py: a header, then a row per
+                window with acc [g], light, temp [C] and crash (0 or 1). The thresholds are the
+                defaults, or the ones of a BSS.CSV file parsed by bssFsmParseParam as at the boot.
+                Every window is a step of the machine, then a tick of the flashing timer plays the
+                pattern of the class from its entry as Test/bssFsm.py models it. For every window the
+                program prints the class and the rear and front lights of the pattern, which
+                Test/bssFsm.py --check-c compares with its model.
+
+                Usage:
+                    build/test/bssFsmHost [BSS.CSV] < windows.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "bssFsm.h"
+
+#define LINE_LEN            128
+
+/*!
+    @brief      Thresholds of a BSS.CSV file, the lines not valid are skipped
+*/
+static bool loadConfig(const char* path){
+    char line[LINE_LEN];
+    BssConfig_t config;
+    FILE* file = fopen(path, "r");
+
+    if(file == NULL){
+        perror(path);
+        return false;
+    }
+    bssFsmGetConfig(&config);
+    while(fgets(line, sizeof(line), file) != NULL){
+        line[strcspn(line, "\r\n")] = '\0';
+        bssFsmParseParam(&config, line);
+    }
+    fclose(file);
+    return bssFsmSetConfig(&config);
+}
+
+int main(int argc, char* argv[]){
+    char line[LINE_LEN];
+    model_t model;
+    const BssPattern_t* pattern;
+    double acc;
+    int crash;
+    uint32_t windows = 0;
+    uint8_t tick;
+    bool rear = false, front = false;
+    class_t state;
+
+    memset(&model, 0, sizeof(model));
+    bssFsmInit();
+    if((argc > 1 && !loadConfig(argv[1])) || fgets(line, sizeof(line), stdin) == NULL){
+        return 1;
+    }
+    printf("class,rear,front\n");
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        if(sscanf(line, "%lf,%lf,%lf,%d", &acc, &model.light, &model.temp, &crash) != 4){
+            fprintf(stderr, "bad row %u: %s", (unsigned)windows + 1, line);
+            return 1;
+        }
+        model.averageAcc = (float)acc;
+        state = bssFsmStep(&model, crash != 0);
+        //Tick of the flashing timer after the step
+        pattern = bssFsmGetPattern(state);
+        tick = (uint8_t)(1u << (bssFsmGetDwell() % BSS_PATTERN_TICKS));
+        if(!(pattern->keep & BSS_OUT_REAR)){
+            rear = (pattern->rear & tick) != 0;
+        }
+        if(!(pattern->keep & BSS_OUT_FRONT)){
+            front = (pattern->front & tick) != 0;
+        }
+        printf("%d,%d,%d\n", (int)state, rear, front);
+        windows++;
+    }
+    return 0;
+}
@@ -0,0 +1,302 @@
+"""Evaluation of the crash detection of the bike computer (see crash.h) on synthetic traces.
+
+Runs the same detector of crash.c, on the raw counts of the accelerometer in the bike frame and the
+wheel speed given once per BSS window, on scenarios with a known outcome: crashes on either side,
+upside down, with the wheel spinning in the air, with the rider getting up and riding again, and
+the events that must not raise the alert (potholes, a curb drop, a bike laid down at a stop, the
+rides of Test/attitude.py). For every crash the black box is checked as well: the impact must be in
+the record after the samples before it. The exit status is 1 if an outcome is not the expected one.
+
+Usage:
+    python3 Test/crash.py                       # all the scenarios
+    python3 Test/crash.py --seed 5              # other noise and impacts
+    python3 Test/crash.py --write crash.csv     # record of the first crash, as on the SD
+    python3 Test/crash.py --check-c build/test/crashHost    # same detections and records from crash.c
+"""
+
+import argparse
+import math
+import random
+import subprocess
+import sys
+
+from attitude import SAMPLE_PERIOD, WINDOW_SIZE, synthetic_ride
+
+IMPACT_G = 3.0
+TILT_DEG = 60.0
+UPRIGHT_DEG = 30.0
+STILL_GATE = 0.3                # g
+TILT_S = 2.0
+CONFIRM_S = 10.0
+STOP_SPEED = 0.5                # m/s
+RING_SIZE = 256
+POST_SAMPLES = 64
+ACCEL_LSB_PER_G = 4096.0        # MPU6050.h
+EVENT_HEADER = "time,ride,latitude,longitude,peak_g,tilt_deg,samples,pre_samples\n"
+SAMPLES_HEADER = "t_ms,ax,ay,az\n"
+
+IDLE, IMPACT, DETECTED = 0, 1, 2
+# Largest difference of the summary of crash.c from this model: peak [g], tilt [deg]
+C_PEAK_TOLERANCE = 0.01
+C_TILT_TOLERANCE = 0.1
+
+
+class Crash:
+    """Same detector of crash.c"""
+
+    def __init__(self, period=SAMPLE_PERIOD, counts_per_g=ACCEL_LSB_PER_G):
+        still = STILL_GATE * counts_per_g
+        self.period = period
+        self.counts_per_g = counts_per_g
+        self.impact2 = int((IMPACT_G * counts_per_g) ** 2)
+        self.still_low2 = int((counts_per_g - still) ** 2)
+        self.still_high2 = int((counts_per_g + still) ** 2)
+        self.cos_tilt2 = math.cos(math.radians(TILT_DEG)) ** 2
+        self.cos_upright2 = math.cos(math.radians(UPRIGHT_DEG)) ** 2
+        self.tilt_samples = int(TILT_S / period + 0.5)
+        self.confirm_samples = int(CONFIRM_S / period + 0.5)
+        self.state = IDLE
+        self.ring = [None] * RING_SIZE
+        self.head = 0
+        self.frozen = False
+        self.impact_head = 0
+        self.wheel_stopped = False
+        self.unsaved = False
+        self.since_impact = 0
+        self.peak2 = 0
+        self.lying = 0
+        self.upright = 0
+        self.tilt = 0.0
+
+    def add_sample(self, accel):
+        head = self.head
+        norm2 = sum(v * v for v in accel)
+        still = self.still_low2 <= norm2 <= self.still_high2
+        up2 = float(accel[2]) * accel[2]
+        if not self.frozen:
+            self.ring[head % RING_SIZE] = tuple(accel)
+            self.head = head + 1
+        if self.state == IDLE:
+            if norm2 > self.impact2:
+                self.state = IMPACT
+                self.since_impact = 0
+                self.peak2 = norm2
+                self.lying = 0
+                if not self.frozen:
+                    self.impact_head = head
+        elif self.state == IMPACT:
+            self.peak2 = max(self.peak2, norm2)
+            self.since_impact += 1
+            if self.since_impact >= POST_SAMPLES:
+                self.frozen = True
+            if still:
+                if accel[2] <= 0 or up2 < self.cos_tilt2 * norm2:
+                    self.lying += 1
+                    self.tilt = math.degrees(math.acos(accel[2] / math.sqrt(norm2)))
+                else:
+                    self.lying = 0
+            if self.lying >= self.tilt_samples and self.wheel_stopped:
+                self.state = DETECTED
+                self.frozen = True
+                self.unsaved = True
+                self.upright = 0
+            elif self.since_impact >= self.confirm_samples:
+                self.state = IDLE
+                self.frozen = self.unsaved
+        else:
+            if still:
+                if not self.wheel_stopped and accel[2] > 0 and up2 > self.cos_upright2 * norm2:
+                    self.upright += 1
+                else:
+                    self.upright = 0
+            if self.upright >= self.tilt_samples:
+                self.state = IDLE
+
+    def set_speed(self, speed):
+        self.wheel_stopped = speed < STOP_SPEED
+
+    def set_saved(self):
+        self.unsaved = False
+        if self.state != IMPACT:
+            self.frozen = False
+
+    def record(self):
+        """Samples of the black box, the oldest first, and the samples before the impact"""
+        samples = min(self.head, RING_SIZE)
+        first = self.head - samples
+        return [self.ring[(first + i) % RING_SIZE] for i in range(samples)], self.impact_head - first
+
+
+def counts(accel):
+    return [max(-32768, min(32767, int(round(v * ACCEL_LSB_PER_G)))) for v in accel]
+
+
+def lying(roll, pitch=0.0):
+    """Specific force of the gravity with the bike rotated by roll and pitch [deg]"""
+    r, p = math.radians(roll), math.radians(pitch)
+    return [-math.sin(p), math.sin(r) * math.cos(p), math.cos(r) * math.cos(p)]
+
+
+class Scene:
+    """Trace of (accel [g], wheel speed [m/s]) samples built by phases"""
+
+    def __init__(self, rnd):
+        self.rnd = rnd
+        self.samples = []
+        self.roll = 0.0
+        self.speed = 0.0
+        self.impact = None
+
+    def hold(self, duration, roll=None, speed=None, vibration=0.02):
+        """Moves roll and speed linearly to the targets in the duration"""
+        steps = max(1, int(duration / SAMPLE_PERIOD))
+        roll0, speed0 = self.roll, self.speed
+        roll = roll0 if roll is None else roll
+        speed = speed0 if speed is None else speed
+        for step in range(1, steps + 1):
+            self.roll = roll0 + (roll - roll0) * step / steps
+            self.speed = speed0 + (speed - speed0) * step / steps
+            noise = vibration * (1 + self.speed / 4)
+            accel = [v + self.rnd.gauss(0, noise) for v in lying(self.roll)]
+            self.samples.append((accel, self.speed))
+        return self
+
+    def hit(self, peak):
+        """Impact of a few samples in a random direction"""
+        direction = [self.rnd.gauss(0, 1) for _ in range(3)]
+        norm = math.sqrt(sum(v * v for v in direction))
+        if self.impact is None:
+            self.impact = len(self.samples)
+        for scale in (0.6, 1.0, 0.5):
+            base = lying(self.roll)
+            self.samples.append(([b + scale * peak * d / norm for b, d in zip(base, direction)], self.speed))
+        return self
+
+
+def scenarios(seed):
+    """(name, trace, crash expected, alert still on at the end)"""
+    rnd = random.Random(seed)
+    out = []
+
+    def scene():
+        return Scene(rnd).hold(1, speed=6).hold(10)
+
+    out.append(("crash right", scene().hit(rnd.uniform(4, 8)).hold(0.5, roll=rnd.uniform(75, 100), speed=0).hold(15), True, True))
+    out.append(("crash left", scene().hit(rnd.uniform(4, 8)).hold(0.5, roll=-rnd.uniform(75, 100), speed=0).hold(15), True, True))
+    out.append(("upside down", scene().hit(rnd.uniform(4, 8)).hold(0.8, roll=180, speed=0).hold(15), True, True))
+    out.append(("wheel spinning", scene().hit(rnd.uniform(4, 8)).hold(0.5, roll=85, speed=4)
+                .hold(6, speed=1).hold(0.1, speed=0).hold(10), True, True))
+    out.append(("gets up", scene().hit(rnd.uniform(4, 8)).hold(0.5, roll=90, speed=0).hold(8)
+                .hold(2, roll=0).hold(3, speed=4).hold(10), True, False))
+    out.append(("pothole", scene().hit(rnd.uniform(3.5, 6)).hold(3).hit(rnd.uniform(3.5, 6)).hold(15), False, False))
+    out.append(("curb drop", scene().hit(rnd.uniform(4, 6)).hold(2, speed=0).hold(15), False, False))
+    out.append(("laid down", Scene(rnd).hold(5).hold(2, roll=90).hold(15), False, False))
+    out.append(("rolled over slowly", scene().hold(1, speed=0).hold(3, roll=-95).hold(15), False, False))
+    for ride in range(3):
+        samples = synthetic_ride(seed * 10 + ride, tilt=False)
+        trace = Scene(rnd)
+        trace.samples = [((s["ax"], s["ay"], s["az"]), s["speed"]) for s in samples]
+        out.append(("ride %d" % ride, trace, False, False))
+    return out
+
+
+def run(trace, changes=None):
+    """Detector on the trace as in the BSS task, returns it and the sample of the detection.
+    With changes, the (sample, state) of every change of state are appended to it"""
+    crash = Crash()
+    detected = None
+    state = crash.state
+    for number, (accel, speed) in enumerate(trace.samples):
+        if number % WINDOW_SIZE == 0:
+            crash.set_speed(speed)
+        crash.add_sample(counts(accel))
+        if detected is None and crash.state == DETECTED:
+            detected = number
+        if changes is not None and crash.state != state:
+            state = crash.state
+            changes.append((number, state))
+    return crash, detected
+
+
+def check_c(binary, trace, crash, changes):
+    """Runs the trace through crash.c (Test/crashHost.c), returns the list of the differences"""
+    rows = "ax,ay,az,speed\n" + "".join("%d,%d,%d,%.9g\n" % (*counts(accel), speed) for accel, speed in trace.samples)
+    output = subprocess.run([binary], input=rows, capture_output=True, text=True, check=True).stdout
+    lines = [line.split() for line in output.splitlines()]
+    errors = []
+    changes_c = [(int(line[1]), int(line[2])) for line in lines if line[0] == "state"]
+    if changes_c != changes:
+        errors.append("changes of state %s, %s expected" % (changes_c[:4], changes[:4]))
+    event = [line[1:] for line in lines if line[0] == "event"]
+    record_c = [tuple(int(v) for v in line[1:]) for line in lines if line[0] == "record"]
+    if crash.unsaved:
+        samples, pre = crash.record()
+        if not event:
+            errors.append("no record")
+        elif (abs(float(event[0][0]) - math.sqrt(crash.peak2) / ACCEL_LSB_PER_G) > C_PEAK_TOLERANCE or
+              abs(float(event[0][1]) - crash.tilt) > C_TILT_TOLERANCE or
+              (int(event[0][2]), int(event[0][3])) != (len(samples), pre)):
+            errors.append("event %s, %.3f %.2f %d %d expected" % (" ".join(event[0]), math.sqrt(crash.peak2) /
+                          ACCEL_LSB_PER_G, crash.tilt, len(samples), pre))
+        elif record_c != samples:
+            errors.append("samples of the record differ")
+    elif event:
+        errors.append("record without a crash")
+    return errors
+
+
+def write_record(path, crash):
+    samples, pre = crash.record()
+    with open(path, "w") as out:
+        out.write(EVENT_HEADER)
+        out.write("1970-01-01T00:00:00.000Z,test.gpx,,,%.1f,%.0f,%d,%d\n" %
+                  (math.sqrt(crash.peak2) / ACCEL_LSB_PER_G, crash.tilt, len(samples), pre))
+        out.write(SAMPLES_HEADER)
+        for i, accel in enumerate(samples):
+            out.write("%d,%s\n" % (round((i - pre) * SAMPLE_PERIOD * 1000),
+                                   ",".join("%.3f" % (v / ACCEL_LSB_PER_G) for v in accel)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Crash detection on synthetic traces")
+    parser.add_argument("--seed", type=int, default=1, help="seed of the noise and of the impacts")
+    parser.add_argument("--write", help="CSV file for the record of the first crash")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with crash.c run by Test/crashHost.c")
+    args = parser.parse_args()
+
+    failed = False
+    written = False
+    for name, trace, expected, alert in scenarios(args.seed):
+        changes = []
+        crash, detected = run(trace, changes)
+        line = "%-20s %6d samples  " % (name, len(trace.samples))
+        ok = (detected is not None) == expected and (crash.state == DETECTED) == alert
+        if detected is not None:
+            samples, pre = crash.record()
+            delay = (detected - trace.impact) * SAMPLE_PERIOD
+            impact = samples[pre] if pre < len(samples) else None
+            # The impact sample must be in the record, after the samples before it
+            record_ok = (pre == RING_SIZE - POST_SAMPLES - 1 and impact is not None and
+                         sum(v * v for v in impact) > crash.impact2)
+            ok = ok and record_ok and delay <= CONFIRM_S
+            line += "crash after %4.1f s  peak %4.1f g  tilt %3.0f deg  record %d + %d samples%s" % (
+                delay, math.sqrt(crash.peak2) / ACCEL_LSB_PER_G, crash.tilt, pre, len(samples) - pre,
+                "" if record_ok else " (impact not in the record)")
+            if args.write and not written:
+                write_record(args.write, crash)
+                written = True
+        else:
+            line += "no crash"
+        if crash.state == DETECTED:
+            line += "  alert on"
+        print(line + ("" if ok else "  <-- expected %s" % ("a crash" if expected else "no crash")))
+        failed |= not ok
+        if args.check_c:
+            errors = check_c(args.check_c, trace, crash, changes)
+            print("  crash.c " + ("; ".join(errors) if errors else "same changes of state and record"))
+            failed |= bool(errors)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
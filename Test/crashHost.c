@@ -0,0 +1,74 @@
+/*!
+    @file       crashHost.c
+    @brief      Crash detector of crash.c on raw samples read from the standard input
+    @details    The samples are the raw counts of the accelerometer in the bike frame and the wheel
+                speed, as Test/crash.py makes them for its scenarios: a header, then a row per sample
+                with ax,ay,az [counts] and speed [m/s]. The speed is given once per BSS window, as the
+                BSS task does. The program prints a line for every change of state of the detector,
+                then, if a record is waiting to be saved, the summary of the crash and the samples of
+                the black box, the oldest first:
+                    state <sample> <state>
+                    event <peak g> <tilt deg> <samples> <samples before the impact>
+                    record <ax> <ay> <az>
+                Test/crash.py --check-c compares them with its model.
+
+                Usage:
+                    build/test/crashHost < samples.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Local Includes */
+#include "crash.h"
+
+#define SAMPLE_PERIOD_S     0.015f      //!< MPU6050_SAMPLE_PERIOD_S
+#define WINDOW_SIZE         10          //!< ACCEL_WINDOW_SIZE
+#define ACCEL_LSB_PER_G     4096.0f     //!< MPU6050.h
+#define LINE_LEN            128
+
+int main(void){
+    char line[LINE_LEN];
+    int value[3];
+    int16_t accel[3];
+    float speed;
+    uint32_t samples = 0;
+    uint16_t i;
+    CrashState_t state = CRASH_IDLE;
+    CrashEvent_t event;
+
+    if(fgets(line, sizeof(line), stdin) == NULL){
+        return 1;
+    }
+    crashReset(SAMPLE_PERIOD_S, ACCEL_LSB_PER_G);
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        if(sscanf(line, "%d,%d,%d,%f", &value[0], &value[1], &value[2], &speed) != 4){
+            fprintf(stderr, "bad row %u: %s", (unsigned)samples + 1, line);
+            return 1;
+        }
+        if(samples % WINDOW_SIZE == 0){
+            crashSetSpeed(speed);
+        }
+        accel[0] = (int16_t)value[0];
+        accel[1] = (int16_t)value[1];
+        accel[2] = (int16_t)value[2];
+        crashAddSample(accel);
+        if(crashGetState() != state){
+            state = crashGetState();
+            printf("state %u %d\n", (unsigned)samples, (int)state);
+        }
+        samples++;
+    }
+
+    if(crashGetEvent(&event)){
+        printf("event %.3f %.2f %u %u\n", event.peak, event.tilt, event.samples, event.preSamples);
+        for(i = 0; i < event.samples && crashGetSample(i, accel); ++i){
+            printf("record %d %d %d\n", accel[0], accel[1], accel[2]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,394 @@
+"""Evaluation of the dead reckoning of the bike computer (see deadReckoning.h) on recorded traces.
+
+The fixes of a NMEA log (or of a GPX file) inside the masked windows are dropped as in a tunnel,
+the wheel distance is simulated from the recorded positions and the same algorithm of
+deadReckoning.c estimates the masked points. The estimate is compared with the dropped fixes,
+before and after the blend to the fix that comes back.
+
+Usage:
+    python3 Test/deadReckoning.py Test/NMEAFileCorrected.txt --mask 150:60
+    python3 Test/deadReckoning.py Test/gpxTest.gpx --every 300:60 --wheel-error 0.03
+    python3 Test/deadReckoning.py Test/NMEAFile_new.txt --mask 100:40 --gpx out.gpx
+    python3 Test/deadReckoning.py Test/NMEAFileCorrected.txt --every 120:30 --check-c build/test/deadReckoningHost
+    python3 Test/deadReckoning.py --circle 50:6 --every 55:10
+
+The recorded traces of Test/ are walked, slower than the course threshold of the bike: use
+--min-course-speed 0.5 to evaluate them. With the threshold of the bike every gap is lost, there is
+no course to follow. Test/NMEAFileCorrected.txt with --every 120:30 --min-course-speed 0.5 has 3
+gaps: the ones at 121 s and 244 s are estimated and joined to the fix, in the one at 360 s the
+logger stands still and no point is estimated, as expected.
+
+--check-c runs the same calls on deadReckoning.c (Test/deadReckoningHost.c) and compares the results
+of every step and the estimated points.
+"""
+
+import argparse
+import datetime
+import math
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+MAX_POINTS = 120
+MAX_DISTANCE = 2000.0           # m
+MIN_STEP = 1.0                  # m
+MIN_COURSE_SPEED = 1.5          # m/s
+MAX_FIX_GAP = 2.0               # s
+TURN_FADE = 5.0                 # s
+MAX_TIME = 120.0                # s
+EARTH_RADIUS = 6371000.0
+C_RESULTS = {"0": "idle", "1": "point", "2": "lost"}      # DrResult_t
+C_POINT_TOLERANCE = 1.0         # m, the C accumulates the position in float
+
+
+def wrap(angle):
+    while angle > 180:
+        angle -= 360
+    while angle <= -180:
+        angle += 360
+    return angle
+
+
+def distance(a, b):
+    dy = math.radians(b[0] - a[0])
+    dx = math.radians(b[1] - a[1]) * math.cos(math.radians((a[0] + b[0]) / 2))
+    return EARTH_RADIUS * math.hypot(dx, dy)
+
+
+class DeadReckoning:
+    """Same algorithm of deadReckoning.c, without the yaw rate input."""
+
+    def __init__(self, min_course_speed=MIN_COURSE_SPEED):
+        self.min_course_speed = min_course_speed
+        self.fix = None                     # (time, lat, lon)
+        self.course = None
+        self.turn_rate = 0.0
+        self.lost = False
+        self.points = []                    # [lat, lon, distance from the fix, time]
+
+    def add_fix(self, time, lat, lon, course, speed, wheel):
+        if speed >= self.min_course_speed:
+            if self.course is not None and self.fix and 0 < time - self.fix[0] <= MAX_FIX_GAP:
+                self.turn_rate = wrap(course - self.course) / (time - self.fix[0])
+            else:
+                self.turn_rate = 0.0
+            self.course = course
+        else:
+            self.turn_rate = 0.0
+        self.fix = (time, lat, lon)
+        self.lost = False
+        self.position = [lat, lon]
+        self.heading = self.course
+        self.last_time = time
+        self.last_wheel = wheel
+        self.total = 0.0
+
+    def step(self, time, wheel):
+        """Returns "idle", "point" or "lost" as deadReckoningStep()"""
+        if self.fix is None or self.course is None or self.lost:
+            return "lost"
+        if time - self.fix[0] > MAX_TIME:
+            self.lost = True
+            return "lost"
+        dt = time - self.last_time
+        self.last_time = time
+        self.heading = wrap(self.heading + self.turn_rate * dt)
+        self.turn_rate *= 1 - dt / TURN_FADE if dt < TURN_FADE else 0.0
+        step = wheel - self.last_wheel
+        if step < MIN_STEP:
+            return "idle"
+        self.last_wheel = wheel
+        self.total += step
+        if len(self.points) >= MAX_POINTS or self.total > MAX_DISTANCE:
+            self.lost = True
+            return "lost"
+        self.position[0] += math.degrees(step * math.cos(math.radians(self.heading)) / EARTH_RADIUS)
+        self.position[1] += math.degrees(step * math.sin(math.radians(self.heading)) /
+                                         (EARTH_RADIUS * math.cos(math.radians(self.position[0]))))
+        self.points.append([self.position[0], self.position[1], self.total, time])
+        return "point"
+
+    def reconcile(self, lat, lon):
+        if self.lost or self.total <= 0:
+            return
+        d_lat = lat - self.position[0]
+        d_lon = lon - self.position[1]
+        for point in self.points:
+            point[0] += d_lat * point[2] / self.total
+            point[1] += d_lon * point[2] / self.total
+
+    def clear(self):
+        self.points = []
+
+    def reason(self):
+        """Why the estimate is lost"""
+        if self.fix is None:
+            return "no fix yet"
+        if self.course is None:
+            return "no course, the fixes are slower than the course threshold"
+        return "too long"
+
+
+class RecordedDeadReckoning(DeadReckoning):
+    """The model that writes its calls for Test/deadReckoningHost.c and the results it expects. The
+    inputs are rounded as they are written, the times in ms from the first fix. The C has the course
+    threshold of the bike: the speeds are scaled to it."""
+
+    def __init__(self, min_course_speed=MIN_COURSE_SPEED):
+        super().__init__(min_course_speed)
+        self.start = None
+        self.calls = []
+        self.expected = []
+
+    def ms(self, time):
+        if self.start is None:
+            self.start = time
+        return round((time - self.start) * 1000)
+
+    def add_fix(self, time, lat, lon, course, speed, wheel):
+        scale = MIN_COURSE_SPEED / self.min_course_speed
+        call = "fix,%d,%.7f,%.7f,%.3f,%.3f,%.3f" % (self.ms(time), lat, lon, course, speed * scale, wheel)
+        self.calls.append(call)
+        lat, lon, course, speed, wheel = [float(v) for v in call.split(",")[2:]]
+        super().add_fix(time, lat, lon, course, speed / scale, wheel)
+
+    def step(self, time, wheel):
+        call = "step,%d,%.3f" % (self.ms(time), wheel)
+        self.calls.append(call)
+        result = super().step(time, float(call.split(",")[2]))
+        self.expected.append(("step", result))
+        return result
+
+    def reconcile(self, lat, lon):
+        call = "reconcile,%.7f,%.7f" % (lat, lon)
+        self.calls.append(call)
+        self.expected += [("raw", p[:3]) for p in self.points]
+        super().reconcile(*[float(v) for v in call.split(",")[1:]])
+
+    def clear(self):
+        self.calls.append("clear")
+        self.expected += [("point", p[:3]) for p in self.points] + [("clear", len(self.points))]
+        super().clear()
+
+
+def nmea_coordinate(value, hemisphere):
+    point = value.index(".")
+    degrees = float(value[:point - 2]) + float(value[point - 2:]) / 60
+    return -degrees if hemisphere in ("S", "W") else degrees
+
+
+def nmea_sentences(line):
+    """Sentences of a line with a valid checksum, as nmeaChecksumValidate() in GPS.c: the log has
+    sentences cut and joined on a line, and corrupted coordinates"""
+    for sentence in line.strip().split("$")[1:]:
+        body, star, checksum = sentence.partition("*")
+        value = 0
+        for char in body:
+            value ^= ord(char)
+        if star and checksum[:2].upper() == "%02X" % value:
+            yield body
+
+
+def read_nmea(path):
+    """List of (time [s], lat, lon, course [deg], speed [m/s]) of the valid epochs (RMC then GGA)"""
+    fixes = []
+    rmc = None
+    with open(path, errors="replace") as log:
+        for body in (sentence for line in log for sentence in nmea_sentences(line)):
+            fields = body.split(",")
+            try:
+                if fields[0].endswith("RMC"):
+                    rmc = (float(fields[7] or 0), float(fields[8] or 0) * 0.514444) if fields[2] == "A" else None
+                elif fields[0].endswith("GGA") and rmc and fields[6] not in ("", "0"):
+                    t = fields[1]
+                    time = int(t[0:2]) * 3600 + int(t[2:4]) * 60 + float(t[4:])
+                    fixes.append((time, nmea_coordinate(fields[2], fields[3]), nmea_coordinate(fields[4], fields[5]),
+                                  rmc[1], rmc[0]))
+                    rmc = None
+            except (ValueError, IndexError):
+                continue                            # Corrupted sentence
+    return fixes
+
+
+def read_gpx(path):
+    """Same list from the track points, course and speed from the consecutive points"""
+    points = []
+    for element in ET.parse(path).getroot().iter():
+        if element.tag.endswith("trkpt"):
+            times = [child.text for child in element if child.tag.endswith("time")]
+            if times:
+                time = datetime.datetime.fromisoformat(times[0].strip().replace("Z", "+00:00")).timestamp()
+                points.append((time, float(element.get("lat")), float(element.get("lon"))))
+    fixes = []
+    for previous, point in zip([None] + points, points):
+        course = speed = 0.0
+        if previous and point[0] > previous[0]:
+            step = distance(previous[1:], point[1:])
+            speed = step / (point[0] - previous[0])
+            course = math.degrees(math.atan2(math.radians(point[2] - previous[2]) * math.cos(math.radians(point[1])),
+                                             math.radians(point[1] - previous[1])))
+        fixes.append(point + (course, speed))
+    return fixes
+
+
+def circle(radius, speed, period=2.0, duration=600.0):
+    """Fixes on a circle turning right from the north, a fix every period seconds"""
+    fixes = []
+    for i in range(int(duration / period) + 1):
+        angle = speed * period * i / radius                 # rad, clockwise
+        north = radius * math.sin(angle)
+        east = radius * (1 - math.cos(angle))
+        fixes.append((period * i, 46.0 + math.degrees(north / EARTH_RADIUS),
+                      11.0 + math.degrees(east / (EARTH_RADIUS * math.cos(math.radians(46.0)))),
+                      math.degrees(angle) % 360, speed))
+    return fixes
+
+
+def parse_window(text):
+    start, length = text.split(":")
+    return float(start), float(length)
+
+
+def evaluate(fixes, windows, wheel_error, dr):
+    """Runs the estimate, returns the list of the gaps and the track as (lat, lon, estimated)"""
+    start = fixes[0][0]
+    wheel = 0.0
+    track = []
+    gaps = []
+    gap = None
+    for previous, fix in zip([None] + fixes, fixes):
+        time, lat, lon, course, speed = fix
+        if previous:
+            wheel += distance(previous[1:3], fix[1:3]) * (1 + wheel_error)
+        masked = any(s <= time - start < s + n for s, n in windows)
+        if masked:
+            if gap is None:
+                gap = {"start": time - start, "truth": {}, "points": 0, "lost": False}
+                gaps.append(gap)
+            gap["truth"][time] = (lat, lon)
+            result = dr.step(time, wheel)
+            if result == "lost" and not gap["lost"]:
+                gap["lost"] = dr.reason()
+            if result == "lost" and dr.points:
+                track.extend((p[0], p[1], True) for p in dr.points)
+                dr.clear()
+            continue
+        if dr.points:
+            raw = [(p[3], p[0], p[1]) for p in dr.points]
+            gap["end_error"] = distance(dr.position, (lat, lon))
+            dr.reconcile(lat, lon)
+            gap["raw"] = [distance(gap["truth"][t], (a, b)) for t, a, b in raw]
+            gap["blended"] = [distance(gap["truth"][p[3]], p[:2]) for p in dr.points]
+            gap["points"] = len(dr.points)
+            track.extend((p[0], p[1], True) for p in dr.points)
+            dr.clear()
+        gap = None
+        track.append((lat, lon, False))
+        dr.add_fix(time, lat, lon, course, speed, wheel)
+    return gaps, track
+
+
+def check_c(binary, dr):
+    """Runs the calls of the model on deadReckoning.c (Test/deadReckoningHost.c), returns the differences"""
+    output = subprocess.run([binary], input="".join(c + "\n" for c in dr.calls), capture_output=True, text=True,
+                            check=True).stdout
+    results = []
+    for line in output.splitlines():
+        fields = line.split(",")
+        if fields[0] == "step":
+            results.append(("step", C_RESULTS.get(fields[1], fields[1])))
+        elif fields[0] in ("raw", "point"):
+            results.append((fields[0], [float(v) for v in fields[1:]]))
+        elif fields[0] == "clear":
+            results.append(("clear", int(fields[1])))
+    errors = []
+    if [r[0] for r in results] != [e[0] for e in dr.expected]:
+        errors.append("%d results, %d expected" % (len(results), len(dr.expected)))
+    worst = 0.0
+    for n, (result, expected) in enumerate(zip(results, dr.expected)):
+        if result[0] != expected[0]:
+            break
+        if result[0] in ("raw", "point"):
+            error = distance(result[1], expected[1])
+            worst = max(worst, error)
+            if error > C_POINT_TOLERANCE or abs(result[1][2] - expected[1][2]) > C_POINT_TOLERANCE:
+                errors.append("result %d: point %s, %s expected" % (n, result[1], expected[1]))
+        elif result != expected:
+            errors.append("result %d: %s %s, %s expected" % (n, result[0], result[1], expected[1]))
+    print("deadReckoning.c %d steps, %d points, max distance %.2f m: %s" %
+          (sum(r[0] == "step" for r in results), sum(r[0] == "point" for r in results), worst,
+           "same of the model" if not errors else "differs, " + "; ".join(errors[:3])))
+    return not errors
+
+
+def rms(values):
+    return math.sqrt(sum(v * v for v in values) / len(values)) if values else 0.0
+
+
+def write_gpx(path, track):
+    with open(path, "w") as out:
+        out.write('<?xml version="1.0" encoding="UTF-8"?>\n<gpx version="1.1" creator="deadReckoning.py" '
+                  'xmlns="http://www.topografix.com/GPX/1/1">\n  <trk>\n    <trkseg>\n')
+        for lat, lon, estimated in track:
+            out.write('      <trkpt lat="%.6f" lon="%.6f">%s</trkpt>\n' % (lat, lon, "<fix>none</fix>" if estimated else ""))
+        out.write("    </trkseg>\n  </trk>\n</gpx>\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Dead reckoning on a recorded trace with masked fixes")
+    parser.add_argument("trace", nargs="?", help="NMEA log or GPX file")
+    parser.add_argument("--circle", type=parse_window, metavar="RADIUS:SPEED",
+                        help="synthetic trace on a circle [m, m/s], a fix every 2 s, instead of a file")
+    parser.add_argument("--mask", action="append", type=parse_window, default=[], metavar="START:LENGTH",
+                        help="drop the fixes from START for LENGTH seconds from the first fix (repeatable)")
+    parser.add_argument("--every", type=parse_window, metavar="PERIOD:LENGTH",
+                        help="drop LENGTH seconds of fixes every PERIOD seconds")
+    parser.add_argument("--wheel-error", type=float, default=0.0, help="relative error of the wheel circumference")
+    parser.add_argument("--min-course-speed", type=float, default=MIN_COURSE_SPEED,
+                        help="slower fixes give no course [m/s]")
+    parser.add_argument("--gpx", metavar="FILE", help="write the track with the estimated points")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with deadReckoning.c run by Test/deadReckoningHost.c")
+    parser.add_argument("--expect-joined", type=int, metavar="N", help="fail if the gaps joined to the fix are not N")
+    args = parser.parse_args()
+
+    if args.circle:
+        fixes = circle(*args.circle)
+    elif args.trace:
+        fixes = read_gpx(args.trace) if args.trace.lower().endswith(".gpx") else read_nmea(args.trace)
+    else:
+        parser.error("no trace, give a file or --circle")
+    if not fixes:
+        parser.error("no fixes in %s" % args.trace)
+    windows = list(args.mask)
+    if args.every:
+        period, length = args.every
+        duration = fixes[-1][0] - fixes[0][0]
+        windows += [(t, length) for t in [period * i for i in range(1, int(duration / period) + 1)]]
+    if not windows:
+        parser.error("no masked window, use --mask or --every")
+
+    dr = RecordedDeadReckoning(args.min_course_speed) if args.check_c else DeadReckoning(args.min_course_speed)
+    gaps, track = evaluate(fixes, windows, args.wheel_error, dr)
+    print("fixes %d, gaps %d" % (len(fixes), len(gaps)))
+    for gap in gaps:
+        if "raw" not in gap:
+            print("  at %6.0f s: %s" % (gap["start"], "estimate lost, " + gap["lost"] if gap["lost"] else
+                                        "no estimated point, the wheel has not moved"))
+            continue
+        print("  at %6.0f s: %3d points, error at the fix %6.1f m, raw rms %6.1f max %6.1f m, blended rms %6.1f max %6.1f m%s" %
+              (gap["start"], gap["points"], gap["end_error"], rms(gap["raw"]), max(gap["raw"]),
+               rms(gap["blended"]), max(gap["blended"]), ", estimate lost, " + gap["lost"] if gap["lost"] else ""))
+    if args.gpx:
+        write_gpx(args.gpx, track)
+    ok = True
+    if args.expect_joined is not None:
+        joined = sum("raw" in gap for gap in gaps)
+        print("%d gaps joined to the fix, %d expected" % (joined, args.expect_joined))
+        ok &= joined == args.expect_joined
+    if args.check_c:
+        ok &= check_c(args.check_c, dr)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
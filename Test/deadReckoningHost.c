@@ -0,0 +1,72 @@
+/*!
+    @file       deadReckoningHost.c
+    @brief      Dead reckoning of deadReckoning.c on the PC, for the model of Test/deadReckoning.py
+    @details    Runs the calls read from the standard input, a row per call, as Test/deadReckoning.py
+                makes them from a trace with masked fixes:
+                    fix,<ms>,<latitude>,<longitude>,<course>,<speed>,<wheel>    deadReckoningAddFix
+                    step,<ms>,<wheel>                                           deadReckoningStep
+                    reconcile,<latitude>,<longitude>                            deadReckoningReconcile
+                    clear                                                       deadReckoningClear
+                and prints a row for every step, the points before every reconcile and the points
+                forgotten by every clear:
+                    step,<DrResult_t>
+                    raw,<latitude>,<longitude>,<distance>
+                    point,<latitude>,<longitude>,<distance>
+                    clear,<points>
+                Test/deadReckoning.py --check-c compares them with its model.
+
+                Usage:
+                    build/test/deadReckoningHost < calls.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "deadReckoning.h"
+
+#define LINE_LEN            160
+
+static void printPoints(const char* row){
+    DrPoint_t point;
+    uint8_t i;
+
+    for(i = 0; deadReckoningGetPoint(i, &point); ++i){
+        printf("%s,%.7f,%.7f,%.3f\n", row, point.latitude, point.longitude, point.distance);
+    }
+}
+
+int main(void){
+    char line[LINE_LEN];
+    unsigned long ms;
+    float latitude, longitude, course, speed, wheel;
+    uint32_t rows = 0;
+    RtcTime_t time;
+
+    memset(&time, 0, sizeof(time));
+    deadReckoningReset();
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        rows++;
+        if(sscanf(line, "fix,%lu,%f,%f,%f,%f,%f", &ms, &latitude, &longitude, &course, &speed, &wheel) == 6){
+            deadReckoningAddFix((uint32_t)ms, latitude, longitude, course, speed, wheel);
+        }else if(sscanf(line, "step,%lu,%f", &ms, &wheel) == 2){
+            printf("step,%d\n", (int)deadReckoningStep((uint32_t)ms, wheel, 0.0f, time, 0));
+        }else if(sscanf(line, "reconcile,%f,%f", &latitude, &longitude) == 2){
+            printPoints("raw");
+            deadReckoningReconcile(latitude, longitude);
+        }else if(strncmp(line, "clear", 5) == 0){
+            printPoints("point");
+            printf("clear,%u\n", deadReckoningGetCount());
+            deadReckoningClear();
+        }else{
+            fprintf(stderr, "bad row %u: %s", (unsigned)rows, line);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,309 @@
+"""Evaluation of the elevation pipeline of the bike computer (see elevation.h) on recorded traces.
+
+Runs the same median, Kalman, grade and climb detection of elevation.c on the fixes of a NMEA log
+(GGA altitude, VDOP of the GSA sentence) or of a GPX file (<ele>, <vdop> if present) and compares
+the ascent of the raw and of the filtered altitude. The distance is the one of the GPS fixes, as
+the ride statistics compute it without the wheel sensor.
+
+Usage:
+    python3 Test/elevation.py Test/NMEAFileCorrected.txt
+    python3 Test/elevation.py Test/gpxTest.gpx --csv profile.csv     # per fix: raw, filtered, grade
+    python3 Test/elevation.py Test/gpxTest.gpx --check-c build/test/elevationHost
+
+--check-c runs the same fixes on elevation.c (Test/elevationHost.c) and compares the filtered
+altitude, the grade and the climbing state of every fix and the lines of the climbs file.
+"""
+
+import argparse
+import csv
+import datetime
+import math
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+from deadReckoning import nmea_sentences
+
+MEDIAN_LEN = 5
+SIGMA_PER_VDOP = 1.5            # m
+DEFAULT_VDOP = 2.0
+GRADE_SIGMA = 0.1
+DRIFT_RATE = 0.005              # m^2/s
+GRADE_STEP = 10.0               # m
+GRADE_SAMPLES = 11
+GRADE_MIN_SPAN = 30.0           # m
+CLIMB_MIN_GAIN = 20.0           # m
+CLIMB_MIN_GRADE = 3.0           # %
+CLIMB_END_DROP = 10.0           # m
+CLIMB_END_FLAT = 500.0          # m
+MAX_CLIMBS = 16
+
+MOVING_SPEED = 3.0              # km/h, as in rideStats.h
+ELEVATION_DEADBAND = 5.0        # m, as in rideStats.h
+EARTH_RADIUS = 6371000.0
+C_ALTITUDE_TOLERANCE = 0.01     # m, the C filter runs in float
+C_GRADE_TOLERANCE = 0.05        # %
+
+
+class ElevationFilter:
+    """Same pipeline of elevation.c, one call of add_fix() per fix."""
+
+    def __init__(self):
+        self.raw = []
+        self.altitude = None
+        self.variance = 0.0
+        self.last_time = 0.0
+        self.last_distance = 0.0
+        self.grade_samples = []
+        self.grade = 0.0
+        self.climbing = False
+        self.low = self.high = None         # (altitude, distance, time)
+        self.max_grade = self.high_max_grade = 0.0
+        self.climbs = []
+
+    def add_fix(self, time, altitude, vdop, distance):
+        """time [s], altitude [m], vdop (None or 0 if not known), distance of the ride [m]"""
+        self.raw = (self.raw + [altitude])[-MEDIAN_LEN:]
+        z = sorted(self.raw)[len(self.raw) // 2] if len(self.raw) % 2 else \
+            sum(sorted(self.raw)[len(self.raw) // 2 - 1:len(self.raw) // 2 + 1]) / 2
+        sigma = (vdop if vdop and vdop > 0 else DEFAULT_VDOP) * SIGMA_PER_VDOP
+        r = sigma * sigma
+        if self.altitude is None:
+            self.altitude = z
+            self.variance = r
+            self._set_low(time, distance)
+        else:
+            dd = max(distance - self.last_distance, 0.0)
+            self.variance += GRADE_SIGMA * GRADE_SIGMA * dd * dd + DRIFT_RATE * (time - self.last_time)
+            gain = self.variance / (self.variance + r)
+            self.altitude += gain * (z - self.altitude)
+            self.variance *= 1 - gain
+        self.last_time = time
+        self.last_distance = distance
+        self._update_grade(distance)
+        self._update_climb(time, distance)
+        return self.altitude
+
+    def finish(self):
+        if self.climbing:
+            self._close_climb()
+
+    def _update_grade(self, distance):
+        if not self.grade_samples or distance - self.grade_samples[-1][0] >= GRADE_STEP:
+            self.grade_samples = (self.grade_samples + [(distance, self.altitude)])[-GRADE_SAMPLES:]
+        old_distance, old_altitude = self.grade_samples[0]
+        if distance - old_distance >= GRADE_MIN_SPAN:
+            self.grade = (self.altitude - old_altitude) * 100 / (distance - old_distance)
+
+    def _set_low(self, time, distance):
+        self.low = (self.altitude, distance, time)
+        self.max_grade = 0.0
+
+    def _close_climb(self):
+        self.climbing = False
+        length = self.high[1] - self.low[1]
+        if len(self.climbs) >= MAX_CLIMBS or length <= 0:
+            return
+        gain = self.high[0] - self.low[0]
+        avg = gain * 100 / length
+        self.climbs.append({"start_s": self.low[2], "end_s": self.high[2], "start_m": self.low[1],
+                            "length_m": length, "gain_m": gain, "avg_pct": avg,
+                            "max_pct": max(self.high_max_grade, avg)})
+
+    def _update_climb(self, time, distance):
+        if not self.climbing:
+            if self.altitude - self.low[0] < CLIMB_MIN_GRADE * 0.01 * (distance - self.low[1]):
+                self._set_low(time, distance)
+            else:
+                self.max_grade = max(self.max_grade, self.grade)
+                if self.altitude - self.low[0] >= CLIMB_MIN_GAIN:
+                    self.climbing = True
+                    self.high = (self.altitude, distance, time)
+                    self.high_max_grade = self.max_grade
+            return
+        self.max_grade = max(self.max_grade, self.grade)
+        if self.altitude > self.high[0]:
+            self.high = (self.altitude, distance, time)
+            self.high_max_grade = self.max_grade
+        elif self.high[0] - self.altitude >= CLIMB_END_DROP or distance - self.high[1] >= CLIMB_END_FLAT:
+            self._close_climb()
+            self._set_low(time, distance)
+
+
+def nmea_coordinate(value, hemisphere):
+    if not value:
+        return None
+    point = value.index(".")
+    degrees = float(value[:point - 2]) + float(value[point - 2:]) / 60
+    return -degrees if hemisphere in ("S", "W") else degrees
+
+
+def read_nmea(path):
+    """List of (time [s], lat, lon, altitude, vdop) of the fixes the device logs: checksum valid,
+    GSA fix 2D/3D, RMC valid and HDOP < 4, as addPointToGPXFromGPS()"""
+    fixes = []
+    epoch = {}
+    day = 0.0
+
+    def close():
+        if epoch.get("gga") and epoch.get("rmc") and epoch.get("fix", 0) > 1:
+            time, lat, lon, hdop, altitude = epoch["gga"]
+            if hdop < 4:
+                fixes.append((day + time, lat, lon, altitude, epoch.get("vdop")))
+
+    with open(path, errors="replace") as log:
+        for body in (sentence for line in log for sentence in nmea_sentences(line)):
+            fields = body.split(",")
+            kind = fields[0][2:]
+            try:
+                if kind == "RMC":                   # First sentence of the epoch
+                    close()
+                    epoch = {"rmc": fields[2] == "A"}
+                    if len(fields) > 9 and len(fields[9]) == 6:
+                        day = datetime.datetime.strptime(fields[9], "%d%m%y").replace(
+                            tzinfo=datetime.timezone.utc).timestamp()
+                elif kind == "GGA" and fields[6] not in ("", "0") and fields[9]:
+                    t = fields[1]
+                    time = int(t[0:2]) * 3600 + int(t[2:4]) * 60 + float(t[4:])
+                    epoch["gga"] = (time, nmea_coordinate(fields[2], fields[3]), nmea_coordinate(fields[4], fields[5]),
+                                    float(fields[8] or 99), float(fields[9]))
+                elif kind == "GSA":
+                    epoch["fix"] = int(fields[2] or 0)
+                    epoch["vdop"] = float(fields[17]) if len(fields) > 17 and fields[17] else None
+            except (ValueError, IndexError):
+                continue                            # Corrupted sentence
+    close()
+    return fixes
+
+
+def read_gpx(path):
+    """List of (time [s], lat, lon, ele, vdop) of the track points"""
+    fixes = []
+    for element in ET.parse(path).getroot().iter():
+        if not element.tag.endswith("trkpt"):
+            continue
+        fields = {child.tag.split("}")[-1]: child.text for child in element}
+        if "time" not in fields or "ele" not in fields:
+            continue
+        time = datetime.datetime.fromisoformat(fields["time"].strip().replace("Z", "+00:00")).timestamp()
+        fixes.append((time, float(element.get("lat")), float(element.get("lon")), float(fields["ele"]),
+                      float(fields["vdop"]) if fields.get("vdop") else None))
+    return fixes
+
+
+def distances(fixes):
+    """Distance of the ride at every fix [m], before the step to the fix as the device reads it"""
+    total = 0.0
+    result = []
+    previous = None
+    for time, lat, lon, _, _ in fixes:
+        result.append(total)
+        if previous is not None and time != previous[0]:
+            dy = math.radians(lat - previous[1])
+            dx = math.radians(lon - previous[2]) * math.cos(math.radians((lat + previous[1]) / 2))
+            step = EARTH_RADIUS * math.hypot(dx, dy)
+            if step * 3.6 / (time - previous[0]) >= MOVING_SPEED:
+                total += step
+        previous = (time, lat, lon)
+    return result
+
+
+def ascent(altitudes, deadband=0.0):
+    """Sum of the climbs larger than the deadband, as rideStats.c counts them"""
+    total = 0.0
+    reference = None
+    for altitude in altitudes:
+        if reference is None:
+            reference = altitude
+        elif altitude - reference >= deadband and altitude > reference:
+            total += altitude - reference
+            reference = altitude
+        elif reference - altitude >= deadband and altitude < reference:
+            reference = altitude
+    return total
+
+
+def check_c(binary, fixes, ride_distances):
+    """Runs the fixes on elevation.c (Test/elevationHost.c), returns the differences. The model gets
+    the same rounded inputs, the times in ms from the first fix."""
+    rows = ["%d,%.2f,%.2f,%.3f" % (round((fix[0] - fixes[0][0]) * 1000), fix[3], fix[4] or 0, distance)
+            for fix, distance in zip(fixes, ride_distances)]
+    output = subprocess.run([binary], input="ms,altitude,vdop,distance\n" + "".join(r + "\n" for r in rows),
+                            capture_output=True, text=True, check=True).stdout
+    results = [line.split(",") for line in output.splitlines()]
+    c_fixes = [[float(v) for v in r[1:]] for r in results if r[0] == "fix"]
+    c_climbs = [r[1:] for r in results if r[0] == "climb"]
+
+    pipeline = ElevationFilter()
+    expected = []
+    for row in rows:
+        ms, altitude, vdop, distance = [float(v) for v in row.split(",")]
+        expected.append((pipeline.add_fix(ms / 1000, altitude, vdop, distance), pipeline.grade, pipeline.climbing))
+    pipeline.finish()
+    errors = []
+    if len(c_fixes) != len(expected):
+        errors.append("%d fixes, %d expected" % (len(c_fixes), len(expected)))
+    worst = [0.0, 0.0]
+    for n, (c_fix, (altitude, grade, climbing)) in enumerate(zip(c_fixes, expected)):
+        worst = [max(worst[0], abs(c_fix[0] - altitude)), max(worst[1], abs(c_fix[1] - grade))]
+        if abs(c_fix[0] - altitude) > C_ALTITUDE_TOLERANCE or abs(c_fix[1] - grade) > C_GRADE_TOLERANCE or \
+                bool(c_fix[2]) != climbing:
+            errors.append("fix %d: %.4f m %.4f%% %s, %.4f m %.4f%% %s expected" %
+                          (n, c_fix[0], c_fix[1], bool(c_fix[2]), altitude, grade, climbing))
+    if len(c_climbs) != len(pipeline.climbs):
+        errors.append("%d climbs, %d expected" % (len(c_climbs), len(pipeline.climbs)))
+    for n, (c_climb, climb) in enumerate(zip(c_climbs, pipeline.climbs), 1):
+        values = [n, int(climb["start_s"]), climb["start_m"], climb["length_m"], climb["gain_m"], climb["avg_pct"],
+                  climb["max_pct"]]
+        if int(c_climb[1]) != n or int(c_climb[2]) != values[1] or \
+                any(abs(float(c) - v) > 0.1 + 1e-5 * abs(v) for c, v in zip(c_climb[3:], values[2:])):
+            errors.append("climb %d: %s, %s expected" % (n, ",".join(c_climb).strip(), values))
+    print("elevation.c %d fixes, %d climbs, max difference %.4f m %.4f%%: %s" %
+          (len(c_fixes), len(c_climbs), worst[0], worst[1],
+           "same of the model" if not errors else "differs, " + "; ".join(errors[:3])))
+    return not errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Elevation pipeline on a recorded NMEA or GPX trace")
+    parser.add_argument("trace", help="NMEA log or GPX file")
+    parser.add_argument("--csv", metavar="FILE", help="write time, distance, raw and filtered altitude, grade of every fix")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with elevation.c run by Test/elevationHost.c")
+    args = parser.parse_args()
+
+    fixes = read_gpx(args.trace) if args.trace.lower().endswith(".gpx") else read_nmea(args.trace)
+    if not fixes:
+        parser.error("no fixes in %s" % args.trace)
+    pipeline = ElevationFilter()
+    raw = [fix[3] for fix in fixes]
+    filtered = []
+    rows = []
+    ride_distances = distances(fixes)
+    for fix, distance in zip(fixes, ride_distances):
+        filtered.append(pipeline.add_fix(fix[0], fix[3], fix[4], distance))
+        rows.append((fix[0] - fixes[0][0], distance, fix[3], filtered[-1], pipeline.grade))
+    pipeline.finish()
+
+    print("fixes          %10d" % len(fixes))
+    print("distance_m     %10.1f" % rows[-1][1])
+    print("raw_span_m     %10.1f" % (max(raw) - min(raw)))
+    print("filt_span_m    %10.1f" % (max(filtered) - min(filtered)))
+    print("raw_ascent_m   %10.1f   (every rise)" % ascent(raw))
+    print("raw_ascent_m   %10.1f   (%.0f m deadband)" % (ascent(raw, ELEVATION_DEADBAND), ELEVATION_DEADBAND))
+    print("filt_ascent_m  %10.1f   (%.0f m deadband)" % (ascent(filtered, ELEVATION_DEADBAND), ELEVATION_DEADBAND))
+    print("climbs         %10d" % len(pipeline.climbs))
+    for number, climb in enumerate(pipeline.climbs, 1):
+        print("  %2d: from %6.0f s at %7.0f m, %6.0f m long, +%4.0f m, avg %4.1f%%, max %4.1f%%" %
+              (number, climb["start_s"] - fixes[0][0], climb["start_m"], climb["length_m"], climb["gain_m"],
+               climb["avg_pct"], climb["max_pct"]))
+    if args.csv:
+        with open(args.csv, "w", newline="") as out:
+            writer = csv.writer(out)
+            writer.writerow(["time_s", "distance_m", "raw_m", "filtered_m", "grade_pct"])
+            writer.writerows(("%.1f" % t, "%.1f" % d, "%.2f" % r, "%.2f" % f, "%.1f" % g) for t, d, r, f, g in rows)
+    if args.check_c and not check_c(args.check_c, fixes, ride_distances):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
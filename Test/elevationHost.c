@@ -0,0 +1,58 @@
+/*!
+    @file       elevationHost.c
+    @brief      Elevation pipeline of elevation.c on the PC, for the model of Test/elevation.py
+    @details    Reads the fixes from the standard input, as Test/elevation.py makes them from a NMEA
+                log or a GPX file: a header, then a row per fix with the time from the first fix, the
+                GGA altitude, the VDOP (0 if not known) and the distance of the ride. The program
+                prints a row per fix and, after elevationFinish, the lines of the climbs file:
+                    fix,<filtered altitude>,<grade>,<climbing>
+                    climb,<line of ELEV_CLIMBS_HEADER>
+                Test/elevation.py --check-c compares them with its model.
+
+                Usage:
+                    build/test/elevationHost < fixes.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Local Includes */
+#include "elevation.h"
+
+#define LINE_LEN            128
+#define RIDE_NAME           "HOST.GPX"
+
+int main(void){
+    char line[LINE_LEN];
+    char climb[ELEV_CLIMB_LEN + sizeof(RIDE_NAME)];
+    unsigned long ms;
+    float altitude, vdop, distance;
+    uint32_t rows = 0;
+    uint8_t i;
+
+    if(fgets(line, sizeof(line), stdin) == NULL){
+        return 1;
+    }
+    elevationStart();
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        if(sscanf(line, "%lu,%f,%f,%f", &ms, &altitude, &vdop, &distance) != 4){
+            fprintf(stderr, "bad row %u: %s", (unsigned)rows + 1, line);
+            return 1;
+        }
+        altitude = elevationAddFix((uint32_t)ms, altitude, vdop, distance);
+        printf("fix,%.4f,%.4f,%d\n", altitude, elevationGetGrade(), elevationIsClimbing());
+        rows++;
+    }
+    elevationFinish();
+    for(i = 0; i < elevationGetClimbCount(); ++i){
+        if(elevationFormatClimb(climb, sizeof(climb), RIDE_NAME, i, 0) == 0){
+            return 1;
+        }
+        printf("climb,%s", climb);
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+"""Energy accounting of the subsystems (see energy.h) on the rides of Test/power.py, and comparison of
+the reports of the firmware.
+
+The table of energy.c is run on the current model of power.py: for every mode and class of ride the
+on-time of every subsystem in a second, as the firmware measures it, and its charge. The subsystems
+already in power.py must add up to its current, the ones it does not model (GPS UART, I2C, ADC)
+must stay small. The rides of power.py are then discharged in NORMAL mode and the charge of a whole
+ride is split by subsystem, with the hours of a charge.
+A report of the firmware ('e' on the PC UART and at the end of a ride) is parsed from a log: with
+--baseline the average current of every subsystem is compared with the one of a log of the previous
+firmware, a subsystem that draws more than the tolerance is an energy regression.
+The exit status is 1 if a check fails or a regression is found.
+
+Usage:
+    python3 Test/energy.py                                  # model and self checks
+    python3 Test/energy.py --log new.txt                    # per subsystem table of a firmware report
+    python3 Test/energy.py --log new.txt --baseline old.txt # regressions of new.txt over old.txt
+    python3 Test/energy.py --check-report replay.txt        # totals of a report, e.g. of the host replay
+
+--check-report parses the last report of a log and checks it against the table: every subsystem
+draws its current for its on-time, the rows add up to the total, the average and the hours of a
+charge follow from it and the MCU is always active or in LPM0. The replay of build/myprogram.exe
+on the PC never turns the lights on.
+"""
+
+import argparse
+import re
+import sys
+
+from power import (MODES, NORMAL, SAVING, CAPACITY_MAH, MCU_ACTIVE_MA, MCU_LPM0_MA, GPS_MA, GPS_CPU_MS,
+                   LOG_CPU_MS, UI_CPU_MS, UI_IO_MS, LCD_MA, LCD_REFRESH_MA, BACKLIGHT_MA, BSS_CPU_MS,
+                   BSS_IO_MS, SAMPLE_IO_MS, SAMPLES_PER_S, MPU_MA, OTHER_CPU_MS, SD_IDLE_MA, SD_WRITE_MA,
+                   SD_SECTOR_MS, POINT_BYTES, SYNC_SECTORS, SYNC_BUSY_MS, FRONT_MA, REAR_MA, current,
+                   lights_duty, rides)
+
+# energy.h
+MCLK_MHZ = 48
+GPS_BAUD = 9600
+LCD_SPI_HZ = 16000000
+ADC_CONVERSIONS, ADC_CYCLES = 5, 20
+
+# Table of energy.c: name, current when on [mA], per MHz of MCLK [mA]
+TABLE = [("MCU active", MCU_ACTIVE_MA[0], MCU_ACTIVE_MA[1]),
+         ("MCU LPM0", MCU_LPM0_MA[0], MCU_LPM0_MA[1]),
+         ("GPS", GPS_MA, 0.0),
+         ("GPS UART", 0.10, 0.0),
+         ("LCD SPI", LCD_REFRESH_MA, 0.0),
+         ("SD SPI", SD_WRITE_MA, 0.0),
+         ("I2C", 0.75, 0.0),
+         ("ADC", 0.50, 0.0),
+         ("Front light", FRONT_MA, 0.0),
+         ("Rear light", REAR_MA, 0.0),
+         ("Backlight", BACKLIGHT_MA, 0.0),
+         ("Standby", LCD_MA + MPU_MA + SD_IDLE_MA, 0.0)]
+NAMES = [row[0] for row in TABLE]
+EXTRA = ("GPS UART", "I2C", "ADC")      # not in the model of power.py
+
+# Work of the subsystems not in power.py
+GPS_BYTES_PER_FIX = 520         # RMC, VTG, GGA, GSA, 3 GSV, GLL, TXT of Test/NMEAFile.txt
+ADC_PERIOD_MS = 3.0             # TIMER_A3 trigger of the sequence
+TOLERANCE = 2.0                 # [%] of the average current of a subsystem
+MIN_REGRESSION_MA = 0.05        # smaller changes of a subsystem are noise of the measure
+
+
+def on_time(mode, night, riding):
+    """Fraction of a second every subsystem is on, as the firmware accounts it"""
+    _, _, _, fix_ms, ui_ms, backlight, bss_ms, divider, sync_s, _ = MODES[mode]
+    fixes = 1000.0 / fix_ms
+    refreshes = min(fixes, 1000.0 / ui_ms)
+    windows = 1000.0 / bss_ms
+    # Same split of power.current: CPU work is longer with the divider, the I/O is not
+    cpu = fixes * (GPS_CPU_MS + (LOG_CPU_MS if riding else 0)) + refreshes * UI_CPU_MS + windows * BSS_CPU_MS + OTHER_CPU_MS
+    io = refreshes * UI_IO_MS + windows * BSS_IO_MS + SAMPLES_PER_S * SAMPLE_IO_MS
+    active = min(1.0, (cpu * divider + io) / 1000.0)
+    sd = 0.0
+    if riding:
+        sectors = fixes * POINT_BYTES / 512.0
+        sd = (sectors * SD_SECTOR_MS + (SYNC_SECTORS * SD_SECTOR_MS + SYNC_BUSY_MS) / sync_s) / 1000.0
+    front, rear = lights_duty(night, bss_ms)
+    return {"MCU active": active,
+            "MCU LPM0": 1.0 - active,
+            "GPS": 1.0,
+            "GPS UART": fixes * GPS_BYTES_PER_FIX * 10.0 / GPS_BAUD,
+            "LCD SPI": refreshes * UI_IO_MS / 1000.0,
+            "SD SPI": sd,
+            "I2C": (windows * BSS_IO_MS + SAMPLES_PER_S * SAMPLE_IO_MS) / 1000.0,
+            "ADC": 1000.0 / ADC_PERIOD_MS * ADC_CONVERSIONS * ADC_CYCLES * divider / (MCLK_MHZ * 1e6),
+            "Front light": front,
+            "Rear light": rear,
+            "Backlight": 1.0 if backlight else 0.0,
+            "Standby": 1.0}
+
+
+def currents(mode):
+    """Current of every subsystem when on, at the MCLK of the mode [mA], as energySetMclkDivider"""
+    mhz = MCLK_MHZ / float(MODES[mode][7])
+    return {name: on + per_mhz * mhz for name, on, per_mhz in TABLE}
+
+
+def average(mode, night, riding):
+    """Average current of every subsystem in the mode [mA]"""
+    on = on_time(mode, night, riding)
+    ma = currents(mode)
+    return {name: on[name] * ma[name] for name in NAMES}
+
+
+def ride_charge(ride, capacity):
+    """Whole ride in NORMAL mode until the charge is drawn: hours and charge of every subsystem [mAh]"""
+    charge = dict((name, 0.0) for name in NAMES)
+    left = capacity * 3600.0
+    t = 0
+    while left > 0:
+        night, riding, charging = ride(t)
+        split = average(NORMAL, night, riding)
+        for name in NAMES:
+            charge[name] += split[name] / 3600.0
+        left = min(left - sum(split.values()) + charging, capacity * 3600.0)
+        t += 1
+    return t / 3600.0, charge
+
+
+def format_report(split, elapsed_ms):
+    """Report of energyReport for the average currents of a subsystem over a time"""
+    uah = dict((name, int(split[name] * elapsed_ms / 3600.0)) for name in NAMES)
+    total = sum(uah.values())
+    average_ua = total * 3600000 // elapsed_ms
+    tenths = CAPACITY_MAH * 10000 // average_ua
+    lines = ["Energy: %d ms, %d uAh, average %d uA, a charge lasts %d.%d h" %
+             (elapsed_ms, total, average_ua, tenths // 10, tenths % 10)]
+    lines += ["%s: on %d ms, %d uAh" % (name, 0, uah[name]) for name in NAMES]
+    return "\r\n".join(lines) + "\r\n"
+
+
+REPORT = re.compile(r"Energy: (\d+) ms, (\d+) uAh")
+ROW = re.compile(r"^(.+): on (\d+) ms, (\d+) uAh")
+
+
+def parse_report(text):
+    """Last report of a log: elapsed time [ms] and average current of every subsystem [mA]"""
+    elapsed, rows = None, {}
+    for line in text.splitlines():
+        line = line.strip()
+        match = REPORT.search(line)
+        if match:
+            elapsed, rows = int(match.group(1)), {}
+            continue
+        match = ROW.match(line)
+        if elapsed and match and match.group(1) in NAMES:
+            rows[match.group(1)] = int(match.group(3)) * 3600.0 / elapsed
+    if not elapsed or len(rows) != len(NAMES):
+        return None
+    return elapsed, rows
+
+
+def check_report(text):
+    """Totals of the last report of a log against the table, returns the differences"""
+    header, rows = None, {}
+    for line in text.splitlines():
+        line = line.strip()
+        match = re.search(r"Energy: (\d+) ms, (\d+) uAh, average (\d+) uA, a charge lasts (\d+)\.(\d) h", line)
+        if match:
+            header, rows = [int(v) for v in match.groups()], {}
+            continue
+        match = ROW.match(line)
+        if header and match and match.group(1) in NAMES:
+            rows[match.group(1)] = (int(match.group(2)), int(match.group(3)))
+    parsed = parse_report(text)
+    if header is None or parsed is None or len(rows) != len(NAMES):
+        return ["no complete report"]
+    elapsed, total, average_ua, hours, tenths = header
+    errors = []
+    charges = sum(uah for _, uah in rows.values())
+    # Every row and the total are truncated to the uAh
+    if not charges <= total < charges + len(NAMES):
+        errors.append("total %d uAh, the rows add up to %d uAh" % (total, charges))
+    if average_ua != total * 3600000 // elapsed:
+        errors.append("average %d uA, %d expected" % (average_ua, total * 3600000 // elapsed))
+    expected_tenths = int(CAPACITY_MAH) * 10000 // average_ua if average_ua else 0
+    if hours * 10 + tenths != expected_tenths:
+        errors.append("a charge lasts %d.%d h, %.1f h expected" % (hours, tenths, expected_tenths / 10.0))
+    mcu = rows["MCU active"][0] + rows["MCU LPM0"][0]
+    if not elapsed - 1 <= mcu <= elapsed:
+        errors.append("MCU active and LPM0 %d ms in %d ms" % (mcu, elapsed))
+    if abs(sum(parsed[1].values()) - total * 3600.0 / elapsed) > len(NAMES) * 3600.0 / elapsed:
+        errors.append("average of the parser %.3f mA" % sum(parsed[1].values()))
+    for name, on_ma, per_mhz in TABLE:
+        on_ms, uah = rows[name]
+        # The MCU draws less with a divider of the MCLK, up to 4
+        low, high = [on_ms * (on_ma + per_mhz * MCLK_MHZ / divider) / 3600.0 for divider in (4, 1)]
+        slack = (on_ma + per_mhz * MCLK_MHZ) / 3600.0 + 1
+        if not low - slack <= uah <= high + slack:
+            errors.append("%s: %d uAh in %d ms, %.1f to %.1f uAh expected" % (name, uah, on_ms, low, high))
+    return errors
+
+
+def regressions(new, old, tolerance):
+    """Subsystems of the new report drawing more than the old one: (name, old, new) [mA]"""
+    found = []
+    for name in NAMES + ["total"]:
+        a = sum(old.values()) if name == "total" else old[name]
+        b = sum(new.values()) if name == "total" else new[name]
+        if b - a > max(MIN_REGRESSION_MA, a * tolerance / 100.0):
+            found.append((name, a, b))
+    return found
+
+
+def print_split(title, columns, splits):
+    print("%-20s %s" % (title, "  ".join("%10s" % c for c in columns)))
+    for name in NAMES + ["total"]:
+        print("%-20s %s" % (name, "  ".join("%10.3f" % (sum(s.values()) if name == "total" else s[name])
+                                            for s in splits)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Energy accounting of the subsystems and regressions of the firmware")
+    parser.add_argument("--log", help="log of the PC UART with a report of the firmware")
+    parser.add_argument("--baseline", help="log of the previous firmware, compared with --log")
+    parser.add_argument("--tolerance", type=float, default=TOLERANCE, help="allowed increase of a subsystem [%%]")
+    parser.add_argument("--capacity", type=float, default=CAPACITY_MAH, help="capacity of the cell [mAh]")
+    parser.add_argument("--check-report", metavar="LOG", help="check the totals of the last report of a log")
+    args = parser.parse_args()
+    ok = True
+
+    # The subsystems of power.py add up to its current, the others are small
+    columns, splits = [], []
+    for mode in range(len(MODES)):
+        for night in (False, True):
+            split = average(mode, night, True)
+            base, front, rear, _ = current(mode, night, True)
+            modelled = sum(v for k, v in split.items() if k not in EXTRA)
+            ok &= abs(modelled - (base + FRONT_MA * front + REAR_MA * rear)) < 1e-9
+            ok &= sum(split[k] for k in EXTRA) < 0.02 * modelled
+            columns.append("%s %s" % (MODES[mode][0][:6], "night" if night else "day"))
+            splits.append(split)
+    print_split("average [mA]", columns, splits)
+    print()
+
+    # Charge of whole rides by subsystem
+    names, charges = [], []
+    for name, ride, _ in rides():
+        hours, charge = ride_charge(ride, args.capacity)
+        names.append(name[:10])
+        charges.append(charge)
+        print("%-20s %5.1f h, %6.0f mAh" % (name, hours, sum(charge.values())))
+    print_split("charge [mAh]", names, charges)
+
+    # The parser reads the format of energyReport and finds a regression of the power modes
+    day = average(NORMAL, False, True)
+    parsed = parse_report("junk\r\n" + format_report(day, 3600000) + "Profiler (48 ticks/us):\r\n")
+    ok &= parsed is not None and all(abs(parsed[1][n] - day[n]) < 0.002 for n in NAMES)
+    saving = average(SAVING, False, True)
+    ok &= not regressions(saving, day, TOLERANCE) and bool(regressions(day, saving, TOLERANCE))
+
+    if args.check_report:
+        with open(args.check_report) as f:
+            errors = check_report(f.read())
+        print("%s: energy report %s" % (args.check_report, "consistent with the table" if not errors else
+                                        "differs, " + "; ".join(errors[:3])))
+        ok &= not errors
+
+    if args.log:
+        with open(args.log) as f:
+            new = parse_report(f.read())
+        if new is None:
+            print("%s: no energy report" % args.log)
+            sys.exit(1)
+        print()
+        print("%s: %.1f s" % (args.log, new[0] / 1000.0))
+        if args.baseline:
+            with open(args.baseline) as f:
+                old = parse_report(f.read())
+            if old is None:
+                print("%s: no energy report" % args.baseline)
+                sys.exit(1)
+            print_split("average [mA]", ["baseline", "new"], [old[1], new[1]])
+            for name, a, b in regressions(new[1], old[1], args.tolerance):
+                print("%s: %.3f mA -> %.3f mA  <-- energy regression" % (name, a, b))
+                ok = False
+        else:
+            print_split("average [mA]", ["firmware"], [new[1]])
+        print("a charge of %.0f mAh lasts %.1f h" % (args.capacity, args.capacity / sum(new[1].values())))
+
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
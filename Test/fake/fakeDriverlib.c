@@ -0,0 +1,283 @@
+/*!
+    @file       fakeDriverlib.c
+    @brief      Recorder of the fake driverlib, see fakeDriverlib.h
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <string.h>
+
+/* Fake Includes */
+#include <ti/devices/msp432p4xx/driverlib/gpio.h>
+#include <ti/devices/msp432p4xx/driverlib/cs.h>
+#include <ti/devices/msp432p4xx/driverlib/dma.h>
+#include <ti/devices/msp432p4xx/driverlib/interrupt.h>
+#include "fakeDriverlib.h"
+
+#define FAKE_PORTS  11
+
+//! Channel of the uDMA, basic mode only
+typedef struct{
+    uint32_t control;
+    uint8_t* src;
+    uint8_t* dst;
+    uint32_t size;
+    bool enabled;
+} FakeDMA_t;
+
+static FakeSPI_t fakeSpi[FAKE_SPI_MODULES];
+static uint8_t fakeTxBuf[FAKE_SPI_MODULES];         //!< Addresses of the buffers given to the uDMA
+static uint8_t fakeRxBuf[FAKE_SPI_MODULES];
+static FakeDMA_t fakeDma[FAKE_DMA_CHANNELS];
+static uint16_t fakePortOut[FAKE_PORTS];
+static uint16_t fakePortDir[FAKE_PORTS];
+static uint32_t fakeSmclk;
+static uint64_t fakeNs;                             //!< Clock of the bus
+static void (*fakeTick)(void);
+static uint64_t fakeTickNs;                         //!< Period of the tick, 0 no tick
+static uint64_t fakeNextTickNs;
+static bool fakeInterrupts;
+
+/*!
+    @brief      Everything back to reset, with a SMCLK
+*/
+void fakeReset(uint32_t smclk){
+    memset(fakeSpi, 0, sizeof(fakeSpi));
+    memset(fakeDma, 0, sizeof(fakeDma));
+    memset(fakePortOut, 0, sizeof(fakePortOut));
+    memset(fakePortDir, 0, sizeof(fakePortDir));
+    fakeSmclk = smclk;
+    fakeNs = 0;
+    fakeTick = NULL;
+    fakeTickNs = 0;
+    fakeInterrupts = false;
+}
+
+void fakeSetSMCLK(uint32_t smclk){
+    fakeSmclk = smclk;
+}
+
+static FakeSPI_t* spiOf(uint32_t moduleInstance){
+    uint32_t index = (moduleInstance - EUSCI_B0_BASE) / (EUSCI_B1_BASE - EUSCI_B0_BASE);
+    return index < FAKE_SPI_MODULES ? &fakeSpi[index] : NULL;
+}
+
+const FakeSPI_t* fakeSPI(uint32_t moduleInstance){
+    return spiOf(moduleInstance);
+}
+
+bool fakePinIsHigh(uint_fast8_t port, uint_fast16_t pin){
+    return port < FAKE_PORTS && (fakePortOut[port] & pin) == pin;
+}
+
+bool fakePinIsOutput(uint_fast8_t port, uint_fast16_t pin){
+    return port < FAKE_PORTS && (fakePortDir[port] & pin) == pin;
+}
+
+void fakeSetSPIDevice(uint32_t moduleInstance, FakeSPIDevice_t device){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    if(spi != NULL){
+        spi->device = device;
+    }
+}
+
+uint64_t fakeNowNs(void){
+    return fakeNs;
+}
+
+/*!
+    @brief      Call a function at every period of the clock of the bus, as a timer interrupt
+*/
+void fakeSetTick(void (*tick)(void), uint32_t periodUs){
+    fakeTick = tick;
+    fakeTickNs = (uint64_t)periodUs * 1000u;
+    fakeNextTickNs = fakeNs + fakeTickNs;
+}
+
+static void advance(uint64_t ns){
+    fakeNs += ns;
+    while(fakeTick != NULL && fakeTickNs != 0 && fakeNs >= fakeNextTickNs){
+        fakeNextTickNs += fakeTickNs;
+        fakeTick();
+    }
+}
+
+static uint64_t cyclesNs(uint32_t cycles){
+    return (uint64_t)cycles * 1000000000u / FAKE_MCLK_HZ;
+}
+
+/*!
+    @brief      A byte on the bus: 8 clocks of the SPI, the answer of the device (0xFF without one)
+*/
+static uint8_t exchange(uint32_t moduleInstance, FakeSPI_t* spi, uint8_t mosi){
+    advance(8000000000ull / (spi->clock != 0 ? spi->clock : 1000000));
+    return spi->device != NULL ? spi->device(moduleInstance, mosi) : 0xFF;
+}
+
+/* ------------------------------------------------------------------------------------------------
+    driverlib
+   ------------------------------------------------------------------------------------------------ */
+
+bool SPI_initMaster(uint32_t moduleInstance, const eUSCI_SPI_MasterConfig *config){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    uint32_t divider;
+
+    if(spi == NULL){
+        return false;
+    }
+    //Same prescaler of driverlib: the quotient, truncated
+    divider = config->clockSourceFrequency / config->desiredSpiClock;
+    spi->config = *config;
+    spi->clock = config->clockSourceFrequency / (divider != 0 ? divider : 1);
+    spi->inits++;
+    spi->initWhileEnabled |= spi->enabled;
+    return true;
+}
+
+void SPI_enableModule(uint32_t moduleInstance){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    if(spi != NULL){
+        spi->enabled = true;
+    }
+}
+
+void SPI_disableModule(uint32_t moduleInstance){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    if(spi != NULL){
+        spi->enabled = false;
+    }
+}
+
+uint_fast8_t SPI_isBusy(uint32_t moduleInstance){
+    return 0;
+}
+
+//! Polled byte: the drivers wait for its end, with the cost of the calls
+void SPI_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    if(spi != NULL){
+        advance(cyclesNs(FAKE_POLLED_BYTE_CYCLES));
+        spi->rx = exchange(moduleInstance, spi, (uint8_t)transmitData);
+        spi->polledBytes++;
+    }
+}
+
+uint8_t SPI_receiveData(uint32_t moduleInstance){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    return spi != NULL ? spi->rx : 0xFF;
+}
+
+uintptr_t SPI_getReceiveBufferAddressForDMA(uint32_t moduleInstance){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    return spi != NULL ? (uintptr_t)&fakeRxBuf[spi - fakeSpi] : 0;
+}
+
+uintptr_t SPI_getTransmitBufferAddressForDMA(uint32_t moduleInstance){
+    FakeSPI_t* spi = spiOf(moduleInstance);
+    return spi != NULL ? (uintptr_t)&fakeTxBuf[spi - fakeSpi] : 0;
+}
+
+void DMA_assignChannel(uint32_t mapping){
+}
+
+void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control){
+    fakeDma[channelStructIndex & (FAKE_DMA_CHANNELS - 1)].control = control;
+}
+
+void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode, void *srcAddr, void *dstAddr,
+                            uint32_t transferSize){
+    FakeDMA_t* channel = &fakeDma[channelStructIndex & (FAKE_DMA_CHANNELS - 1)];
+    channel->src = (uint8_t*)srcAddr;
+    channel->dst = (uint8_t*)dstAddr;
+    channel->size = transferSize;
+}
+
+/*!
+    @brief      The channel that feeds the TX buffer of a module starts the exchange: the bytes go
+                back to back on the bus and the received ones to the channel reading its RX buffer
+*/
+static void runExchange(FakeDMA_t* tx){
+    FakeDMA_t* rx = NULL;
+    FakeSPI_t* spi;
+    uint32_t module, i;
+    uint8_t byte = 0xFF;
+
+    for(module = 0; module < FAKE_SPI_MODULES && tx->dst != &fakeTxBuf[module]; ++module);
+    if(module == FAKE_SPI_MODULES){
+        return;
+    }
+    for(i = 0; i < FAKE_DMA_CHANNELS; ++i){
+        if(fakeDma[i].enabled && fakeDma[i].src == &fakeRxBuf[module]){
+            rx = &fakeDma[i];
+        }
+    }
+    spi = &fakeSpi[module];
+    advance(cyclesNs(FAKE_DMA_SETUP_CYCLES));
+    for(i = 0; i < tx->size; ++i){
+        byte = exchange(EUSCI_B0_BASE + module * (EUSCI_B1_BASE - EUSCI_B0_BASE), spi,
+                        tx->src[(tx->control & UDMA_SRC_INC_NONE) == UDMA_SRC_INC_NONE ? 0 : i]);
+        if(rx != NULL && i < rx->size){
+            rx->dst[(rx->control & UDMA_DST_INC_NONE) == UDMA_DST_INC_NONE ? 0 : i] = byte;
+        }
+    }
+    spi->rx = byte;
+    spi->dmaBytes += tx->size;
+    spi->dmaTransfers++;
+    tx->enabled = false;
+    if(rx != NULL){
+        rx->enabled = false;
+    }
+}
+
+void DMA_enableChannel(uint32_t channelNum){
+    FakeDMA_t* channel = &fakeDma[channelNum & (FAKE_DMA_CHANNELS - 1)];
+    channel->enabled = true;
+    runExchange(channel);
+}
+
+void DMA_disableChannel(uint32_t channelNum){
+    fakeDma[channelNum & (FAKE_DMA_CHANNELS - 1)].enabled = false;
+}
+
+bool DMA_isChannelEnabled(uint32_t channelNum){
+    return fakeDma[channelNum & (FAKE_DMA_CHANNELS - 1)].enabled;
+}
+
+void GPIO_setAsOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins){
+    if(selectedPort < FAKE_PORTS){
+        fakePortDir[selectedPort] |= selectedPins;
+    }
+}
+
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins){
+    if(selectedPort < FAKE_PORTS){
+        fakePortOut[selectedPort] |= selectedPins;
+    }
+}
+
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins){
+    if(selectedPort < FAKE_PORTS){
+        fakePortOut[selectedPort] &= ~selectedPins;
+    }
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins,
+                                                uint_fast8_t mode){
+}
+
+uint32_t CS_getSMCLK(void){
+    return fakeSmclk;
+}
+
+bool Interrupt_enableMaster(void){
+    bool was = fakeInterrupts;
+    fakeInterrupts = true;
+    return !was;
+}
+
+bool Interrupt_disableMaster(void){
+    bool was = fakeInterrupts;
+    fakeInterrupts = false;
+    return !was;
+}
@@ -0,0 +1,59 @@
+/*!
+    @file       fakeDriverlib.h
+    @brief      Fake driverlib of the host tests of the drivers in Hardware/
+    @details    The headers in Test/fake/ti take the place of the ones of the SDK (compile with
+                -ITest/fake): the drivers build unchanged on the PC and their calls are recorded here,
+                so a test can set the clocks, read back the level of the pins and the profiles loaded
+                in the eUSCI, as driverlib would program the registers.
+                A device on a SPI bus (e.g. the card model of Test/sdCard.c) answers the bytes sent
+                by the polled calls and by the uDMA. The bytes advance a clock of the bus, with the CPU
+                time of the polled path and of the setup of the uDMA at FAKE_MCLK_HZ, and a tick is
+                called at every period of that clock as the timer interrupts of the firmware.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef TEST_FAKE_DRIVERLIB_H_
+#define TEST_FAKE_DRIVERLIB_H_
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Fake Includes */
+#include <ti/devices/msp432p4xx/driverlib/spi.h>
+
+#define FAKE_SPI_MODULES    4   //!< EUSCI_B0 - EUSCI_B3
+#define FAKE_DMA_CHANNELS   8
+
+#define FAKE_MCLK_HZ            48000000    //!< CPU clock of the costs below
+#define FAKE_POLLED_BYTE_CYCLES 40          //!< SPI_Write + SPI_Read of a byte: calls and polling of the flags
+#define FAKE_DMA_SETUP_CYCLES   300         //!< Programming of the two channels of an exchange
+
+//! Device on a SPI bus: answers a byte sent by the master (MOSI) with the one it shifts out (MISO)
+typedef uint8_t (*FakeSPIDevice_t)(uint32_t moduleInstance, uint8_t mosi);
+
+//! Record of an eUSCI in SPI master mode
+typedef struct{
+    eUSCI_SPI_MasterConfig config;  //!< Profile of the last SPI_initMaster
+    uint32_t clock;                 //!< SPI clock of the profile: driverlib truncates the divider
+    uint32_t inits;                 //!< SPI_initMaster calls
+    bool enabled;
+    bool initWhileEnabled;          //!< An init of the running module, the eUSCI ignores it
+    FakeSPIDevice_t device;
+    uint8_t rx;                     //!< Last byte received
+    uint32_t polledBytes;           //!< Bytes exchanged by SPI_transmitData
+    uint32_t dmaBytes;              //!< Bytes exchanged by the uDMA
+    uint32_t dmaTransfers;
+} FakeSPI_t;
+
+void fakeReset(uint32_t smclk);
+void fakeSetSMCLK(uint32_t smclk);
+const FakeSPI_t* fakeSPI(uint32_t moduleInstance);
+bool fakePinIsHigh(uint_fast8_t port, uint_fast16_t pin);
+bool fakePinIsOutput(uint_fast8_t port, uint_fast16_t pin);
+void fakeSetSPIDevice(uint32_t moduleInstance, FakeSPIDevice_t device);
+uint64_t fakeNowNs(void);
+void fakeSetTick(void (*tick)(void), uint32_t periodUs);
+
+#endif /* TEST_FAKE_DRIVERLIB_H_ */
@@ -0,0 +1,9 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): clock system */
+#ifndef FAKE_CS_H_
+#define FAKE_CS_H_
+
+#include <stdint.h>
+
+uint32_t CS_getSMCLK(void);
+
+#endif /* FAKE_CS_H_ */
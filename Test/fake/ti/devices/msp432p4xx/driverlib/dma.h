@@ -0,0 +1,33 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): uDMA in basic mode */
+#ifndef FAKE_DMA_H_
+#define FAKE_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/devices/msp432p4xx/driverlib/rom.h>
+#include <ti/devices/msp432p4xx/driverlib/rom_map.h>
+
+#define DMA_CH0_EUSCIB0TX0                          0x00000000
+#define DMA_CH1_EUSCIB0RX0                          0x00000001
+
+#define UDMA_PRI_SELECT                             0x00000000
+#define UDMA_ALT_SELECT                             0x00000008
+
+#define UDMA_DST_INC_8                              0x00000000
+#define UDMA_DST_INC_NONE                           0xc0000000
+#define UDMA_SRC_INC_8                              0x00000000
+#define UDMA_SRC_INC_NONE                           0x0c000000
+#define UDMA_SIZE_8                                 0x00000000
+#define UDMA_ARB_1                                  0x00000000
+
+#define UDMA_MODE_BASIC                             0x00000001
+
+void DMA_assignChannel(uint32_t mapping);
+void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control);
+void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode, void *srcAddr, void *dstAddr,
+                            uint32_t transferSize);
+void DMA_enableChannel(uint32_t channelNum);
+void DMA_disableChannel(uint32_t channelNum);
+bool DMA_isChannelEnabled(uint32_t channelNum);
+
+#endif /* FAKE_DMA_H_ */
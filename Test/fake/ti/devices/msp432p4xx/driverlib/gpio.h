@@ -0,0 +1,35 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): digital I/O */
+#ifndef FAKE_GPIO_H_
+#define FAKE_GPIO_H_
+
+#include <stdint.h>
+
+#define GPIO_PORT_P1                                1
+#define GPIO_PORT_P2                                2
+#define GPIO_PORT_P3                                3
+#define GPIO_PORT_P4                                4
+#define GPIO_PORT_P5                                5
+#define GPIO_PORT_P6                                6
+#define GPIO_PORT_P7                                7
+#define GPIO_PORT_P8                                8
+#define GPIO_PORT_P9                                9
+#define GPIO_PORT_P10                               10
+
+#define GPIO_PIN0                                   (0x0001)
+#define GPIO_PIN1                                   (0x0002)
+#define GPIO_PIN2                                   (0x0004)
+#define GPIO_PIN3                                   (0x0008)
+#define GPIO_PIN4                                   (0x0010)
+#define GPIO_PIN5                                   (0x0020)
+#define GPIO_PIN6                                   (0x0040)
+#define GPIO_PIN7                                   (0x0080)
+
+#define GPIO_PRIMARY_MODULE_FUNCTION                (0x01)
+
+void GPIO_setAsOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins,
+                                                uint_fast8_t mode);
+
+#endif /* FAKE_GPIO_H_ */
@@ -0,0 +1,10 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): NVIC */
+#ifndef FAKE_INTERRUPT_H_
+#define FAKE_INTERRUPT_H_
+
+#include <stdbool.h>
+
+bool Interrupt_enableMaster(void);
+bool Interrupt_disableMaster(void);
+
+#endif /* FAKE_INTERRUPT_H_ */
@@ -0,0 +1,4 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): no ROM, the MAP_ calls go to the fake */
+#ifndef FAKE_ROM_H_
+#define FAKE_ROM_H_
+#endif /* FAKE_ROM_H_ */
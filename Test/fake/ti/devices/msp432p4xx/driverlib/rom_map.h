@@ -0,0 +1,31 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): the MAP_ calls of the drivers */
+#ifndef FAKE_ROM_MAP_H_
+#define FAKE_ROM_MAP_H_
+
+#define MAP_SPI_initMaster                          SPI_initMaster
+#define MAP_SPI_enableModule                        SPI_enableModule
+#define MAP_SPI_disableModule                       SPI_disableModule
+#define MAP_SPI_isBusy                              SPI_isBusy
+#define MAP_SPI_transmitData                        SPI_transmitData
+#define MAP_SPI_receiveData                         SPI_receiveData
+#define MAP_SPI_getReceiveBufferAddressForDMA       SPI_getReceiveBufferAddressForDMA
+#define MAP_SPI_getTransmitBufferAddressForDMA      SPI_getTransmitBufferAddressForDMA
+
+#define MAP_DMA_assignChannel                       DMA_assignChannel
+#define MAP_DMA_setChannelControl                   DMA_setChannelControl
+#define MAP_DMA_setChannelTransfer                  DMA_setChannelTransfer
+#define MAP_DMA_enableChannel                       DMA_enableChannel
+#define MAP_DMA_disableChannel                      DMA_disableChannel
+#define MAP_DMA_isChannelEnabled                    DMA_isChannelEnabled
+
+#define MAP_Interrupt_enableMaster                  Interrupt_enableMaster
+#define MAP_Interrupt_disableMaster                 Interrupt_disableMaster
+
+#define MAP_GPIO_setAsOutputPin                     GPIO_setAsOutputPin
+#define MAP_GPIO_setOutputHighOnPin                 GPIO_setOutputHighOnPin
+#define MAP_GPIO_setOutputLowOnPin                  GPIO_setOutputLowOnPin
+#define MAP_GPIO_setAsPeripheralModuleFunctionInputPin  GPIO_setAsPeripheralModuleFunctionInputPin
+
+#define MAP_CS_getSMCLK                             CS_getSMCLK
+
+#endif /* FAKE_ROM_MAP_H_ */
@@ -0,0 +1,44 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): eUSCI in SPI master mode */
+#ifndef FAKE_SPI_H_
+#define FAKE_SPI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EUSCI_B0_BASE                               0x40002000u
+#define EUSCI_B1_BASE                               0x40002400u
+#define EUSCI_B2_BASE                               0x40002800u
+#define EUSCI_B3_BASE                               0x40002C00u
+
+#define EUSCI_B_SPI_CLOCKSOURCE_ACLK                0x40
+#define EUSCI_B_SPI_CLOCKSOURCE_SMCLK               0x80
+#define EUSCI_B_SPI_MSB_FIRST                       0x2000
+#define EUSCI_B_SPI_LSB_FIRST                       0x00
+#define EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT     0x00
+#define EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT     0x8000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH   0x4000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW    0x00
+#define EUSCI_B_SPI_3PIN                            0x00
+
+typedef struct
+{
+    uint_fast8_t selectClockSource;
+    uint32_t clockSourceFrequency;
+    uint32_t desiredSpiClock;
+    uint_fast16_t msbFirst;
+    uint_fast16_t clockPhase;
+    uint_fast16_t clockPolarity;
+    uint_fast16_t spiMode;
+} eUSCI_SPI_MasterConfig;
+
+bool SPI_initMaster(uint32_t moduleInstance, const eUSCI_SPI_MasterConfig *config);
+void SPI_enableModule(uint32_t moduleInstance);
+void SPI_disableModule(uint32_t moduleInstance);
+uint_fast8_t SPI_isBusy(uint32_t moduleInstance);
+void SPI_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData);
+uint8_t SPI_receiveData(uint32_t moduleInstance);
+/* uintptr_t on the host, the same of the uint32_t of driverlib on the target */
+uintptr_t SPI_getReceiveBufferAddressForDMA(uint32_t moduleInstance);
+uintptr_t SPI_getTransmitBufferAddressForDMA(uint32_t moduleInstance);
+
+#endif /* FAKE_SPI_H_ */
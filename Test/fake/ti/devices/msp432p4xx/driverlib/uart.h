@@ -0,0 +1,26 @@
+/* Fake driverlib for the host tests (see Test/fake/fakeDriverlib.h): eUSCI in UART mode, types only */
+#ifndef FAKE_UART_H_
+#define FAKE_UART_H_
+
+#include <stdint.h>
+
+#define EUSCI_A0_BASE                               0x40001000u
+#define EUSCI_A1_BASE                               0x40001400u
+#define EUSCI_A2_BASE                               0x40001800u
+#define EUSCI_A3_BASE                               0x40001C00u
+
+typedef struct
+{
+    uint_fast8_t selectClockSource;
+    uint_fast16_t clockPrescalar;
+    uint_fast8_t firstModReg;
+    uint_fast8_t secondModReg;
+    uint_fast8_t parity;
+    uint_fast16_t msbOrLsbFirst;
+    uint_fast16_t numberofStopBits;
+    uint_fast16_t uartMode;
+    uint_fast8_t overSampling;
+    uint_fast16_t dataLength;
+} eUSCI_UART_ConfigV1;
+
+#endif /* FAKE_UART_H_ */
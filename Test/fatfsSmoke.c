@@ -0,0 +1,102 @@
+/*!
+    @file       fatfsSmoke.c
+    @brief      Smoke test of build/libfatfs.a alone
+    @details    Linked only with the library of "make fatfs", so a symbol of the firmware used by the
+                FatFs sources (as the profiler was) breaks the build of this test. On the RAM disk and
+                on an image file: format, write a file across some clusters, read it back, reserve an
+                area with f_expand, trim it with f_truncate, list and delete. The accesses counted by
+                the simulated drives are printed.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/fatfsSmoke [image, default build/test/fatfsSmoke.img]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "fatfs/ff.h"
+#include "fatfs/sim_disk.h"
+
+#define RAM_SECTORS     2048        //!< 1 MB
+#define IMG_SECTORS     16384       //!< 8 MB
+#define FILE_SIZE       50000
+
+static uint8_t ramDisk[RAM_SECTORS * 512];
+
+static bool check(const char* drive, const char* name, bool ok){
+    printf("%s %-40s %s\n", drive, name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/*!
+    @brief      The whole sequence on a drive, "0:" the image and "1:" the RAM disk
+*/
+static bool testDrive(const char* drive, BYTE pdrv){
+    static FATFS fs;
+    static FIL file;
+    static uint8_t work[FF_MAX_SS];
+    char path[32];
+    uint8_t buffer[1000];
+    uint32_t n, i;
+    UINT done;
+    DIR dir;
+    FILINFO info;
+    SIM_STATS stats;
+    bool ok = true, same = true;
+
+    snprintf(path, sizeof(path), "%sride.gpx", drive);
+    ok &= check(drive, "f_mkfs", f_mkfs(drive, FM_ANY, 0, work, sizeof(work)) == FR_OK);
+    ok &= check(drive, "f_mount", f_mount(&fs, drive, 1) == FR_OK);
+
+    ok &= check(drive, "f_open and f_expand", f_open(&file, path, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK &&
+                f_expand(&file, 256 * 1024, 0) == FR_OK);
+    for(n = 0; n < FILE_SIZE && ok; n += done){
+        for(i = 0; i < sizeof(buffer); ++i){
+            buffer[i] = (uint8_t)((n + i) * 7u);
+        }
+        ok &= f_write(&file, buffer, sizeof(buffer), &done) == FR_OK && done == sizeof(buffer);
+    }
+    ok &= check(drive, "f_write, f_truncate, f_close", ok && f_truncate(&file) == FR_OK && f_close(&file) == FR_OK);
+
+    ok &= check(drive, "f_open to read", f_open(&file, path, FA_READ) == FR_OK && f_size(&file) == FILE_SIZE);
+    for(n = 0; n < FILE_SIZE && ok; n += done){
+        ok &= f_read(&file, buffer, sizeof(buffer), &done) == FR_OK && done == sizeof(buffer);
+        for(i = 0; i < done; ++i){
+            same &= buffer[i] == (uint8_t)((n + i) * 7u);
+        }
+    }
+    ok &= check(drive, "f_read of the same data", ok && same && f_close(&file) == FR_OK);
+
+    ok &= check(drive, "f_readdir", f_opendir(&dir, drive) == FR_OK && f_readdir(&dir, &info) == FR_OK &&
+                strcmp(info.fname, "RIDE.GPX") == 0 && info.fsize == FILE_SIZE && f_closedir(&dir) == FR_OK);
+    ok &= check(drive, "f_unlink", f_unlink(path) == FR_OK && f_stat(path, &info) == FR_NO_FILE);
+    f_mount(NULL, drive, 0);
+
+    SIM_disk_stats(pdrv == 0 ? SIM_IMG : SIM_RAM, &stats);
+    printf("%s %u reads, %u writes, %u KB written\n", drive, (unsigned)stats.reads, (unsigned)stats.writes,
+           (unsigned)(stats.write_bytes / 1024));
+    return ok;
+}
+
+int main(int argc, char* argv[]){
+    const char* image = argc > 1 ? argv[1] : "build/test/fatfsSmoke.img";
+    bool ok = true;
+
+    ok &= check("1:", "RAM_disk_attach", RAM_disk_attach(ramDisk, RAM_SECTORS));
+    ok &= testDrive("1:", 1);
+
+    remove(image);
+    ok &= check("0:", "IMG_disk_open", IMG_disk_open(image, IMG_SECTORS));
+    ok &= testDrive("0:", 0);
+    IMG_disk_close();
+    remove(image);
+
+    return ok ? 0 : 1;
+}
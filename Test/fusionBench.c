@@ -0,0 +1,239 @@
+/*!
+    @file       fusionBench.c
+    @brief      Update cost and accuracy of the speed estimator of fusion.c on a synthetic ride
+    @details    A ride of 20 minutes is generated with its true speed: starts, cruising, braking, a stop
+                and a tunnel of a minute without GPS. The measurements are the ones of the tasks: the
+                mean acceleration of a BSS window every 150 ms with a bias and noise, the wheel speed
+                at every round (mean of the round, as the wheel sensor gives it) and a GPS fix per
+                second with noise on the position and on the speed. The ride is run with and without
+                the wheel sensor and the error of the estimate is checked against the true speed and
+                distance, in the tunnel too.
+                Then the same measurements are replayed many times and every call is timed on the
+                PC, with the cost of the clock subtracted: the mean time of an update of each kind
+                and the time spent per second of ride are printed. These are host numbers, to compare
+                versions of fusion.c, not the cycles of the Cortex-M4F.
+                The exit status is 1 if an accuracy limit is exceeded.
+
+                Usage:
+                    build/test/fusionBench [replays of the benchmark, default 200]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+/* Local Includes */
+#include "fusion.h"
+
+#define RIDE_MS             1200000u
+#define ACCEL_PERIOD_MS     150u        //!< BSS window, 10 samples at 15 ms
+#define GPS_PERIOD_MS       1000u
+#define TUNNEL_START_MS     600000u
+#define TUNNEL_END_MS       660000u
+#define WHEEL_CIRCUMFERENCE 2.1f        //!< [m]
+#define ACCEL_BIAS          0.2f        //!< [m/s^2]
+#define ACCEL_NOISE         0.3f        //!< [m/s^2]
+#define GPS_POS_NOISE       2.0f        //!< [m]
+#define GPS_SPEED_NOISE     0.3f        //!< [m/s]
+#define GPS_HDOP            1.2f
+#define METERS_TO_DEG       (180.0 / (M_PI * 6371000.0))
+#define MAX_EVENTS          40000u
+
+//Limits of the accuracy
+#define MAX_SPEED_RMS       0.5f        //!< [m/s]
+#define MAX_TUNNEL_ERROR    2.5f        //!< Speed after a minute on the accelerometer alone: 0.04 m/s^2 of bias left [m/s]
+#define MAX_DISTANCE_ERROR  0.02f       //!< Fraction of the ride
+
+typedef enum{
+    EVENT_ACCEL,
+    EVENT_WHEEL,
+    EVENT_GPS,
+    EVENT_KINDS
+} EventKind_t;
+
+static const char* const kindNames[EVENT_KINDS] = {"fusionAddAccel", "fusionAddWheel", "fusionAddGps"};
+
+//! A measurement and the truth at its time
+typedef struct{
+    EventKind_t kind;
+    uint32_t ms;
+    float value;                    //!< Acceleration or speed
+    float latitude;
+    float longitude;
+    float trueSpeed;
+    float trueDistance;
+} Event_t;
+
+//! True speed [m/s] at the corners of the ride, linear between them
+static const struct{
+    uint32_t ms;
+    float speed;
+} profile[] = {
+    {0, 0}, {20000, 8}, {300000, 8}, {310000, 3}, {340000, 10}, {590000, 10}, {600000, 7},
+    {660000, 7}, {670000, 9}, {900000, 9}, {915000, 0}, {935000, 0}, {965000, 7}, {RIDE_MS, 7},
+};
+
+static Event_t events[MAX_EVENTS];
+static uint32_t eventCount;
+
+static float trueSpeed(uint32_t ms){
+    uint32_t i;
+    for(i = 1; i < sizeof(profile) / sizeof(profile[0]) - 1 && ms > profile[i].ms; ++i){
+    }
+    return profile[i - 1].speed + (profile[i].speed - profile[i - 1].speed) *
+           (float)(ms - profile[i - 1].ms) / (float)(profile[i].ms - profile[i - 1].ms);
+}
+
+//! Gaussian noise of a fixed sequence, the same ride at every run
+static float noise(float sigma){
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0), w = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return (float)(sigma * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * w));
+}
+
+static void addEvent(EventKind_t kind, uint32_t ms, float value, double distance){
+    if(eventCount < MAX_EVENTS){
+        Event_t* e = &events[eventCount++];
+        e->kind = kind;
+        e->ms = ms;
+        e->value = value;
+        e->trueSpeed = trueSpeed(ms);
+        e->trueDistance = (float)distance;
+        if(kind == EVENT_GPS){                  //Straight road to the north
+            e->latitude = (float)(45.0 + (distance + noise(GPS_POS_NOISE)) * METERS_TO_DEG);
+            e->longitude = (float)(11.0 + noise(GPS_POS_NOISE) * METERS_TO_DEG / cos(45.0 * M_PI / 180.0));
+        }
+    }
+}
+
+/*!
+    @brief      Measurements of the ride, integrated at 1 ms
+*/
+static void makeRide(void){
+    double distance = 0, nextRound = WHEEL_CIRCUMFERENCE;
+    uint32_t ms, lastRoundMs = 0;
+
+    srand(1);
+    for(ms = 1; ms <= RIDE_MS; ++ms){
+        distance += trueSpeed(ms) / 1000.0;
+        if(ms % ACCEL_PERIOD_MS == 0){
+            float accel = (trueSpeed(ms) - trueSpeed(ms - ACCEL_PERIOD_MS)) * 1000.0f / ACCEL_PERIOD_MS;
+            addEvent(EVENT_ACCEL, ms, accel + ACCEL_BIAS + noise(ACCEL_NOISE), distance);
+        }
+        if(distance >= nextRound){
+            addEvent(EVENT_WHEEL, ms, WHEEL_CIRCUMFERENCE * 1000.0f / (float)(ms - lastRoundMs), distance);
+            lastRoundMs = ms;
+            nextRound += WHEEL_CIRCUMFERENCE;
+        }
+        if(ms % GPS_PERIOD_MS == 0 && (ms < TUNNEL_START_MS || ms >= TUNNEL_END_MS)){
+            addEvent(EVENT_GPS, ms, fmaxf(trueSpeed(ms) + noise(GPS_SPEED_NOISE), 0), distance);
+        }
+    }
+}
+
+static void replay(const Event_t* e){
+    switch(e->kind){
+    case EVENT_ACCEL:
+        fusionAddAccel(e->ms, e->value);
+        break;
+    case EVENT_WHEEL:
+        fusionAddWheel(e->ms, e->value);
+        break;
+    default:
+        fusionAddGps(e->ms, e->latitude, e->longitude, e->value, GPS_HDOP);
+        break;
+    }
+}
+
+/*!
+    @brief      The ride through the estimator, with or without the wheel sensor
+    @return     false if a limit is exceeded
+*/
+static bool accuracy(bool wheel){
+    double squares = 0;
+    uint32_t i, samples = 0;
+    float tunnelError = 0, distanceError;
+    const Event_t* last = &events[eventCount - 1];
+
+    fusionReset(0);
+    for(i = 0; i < eventCount; ++i){
+        const Event_t* e = &events[i];
+        if(e->kind == EVENT_WHEEL && !wheel){
+            continue;
+        }
+        replay(e);
+        if(e->kind == EVENT_ACCEL && fusionIsValid()){
+            float error = fusionGetSpeed() - e->trueSpeed;
+            squares += error * error;
+            samples++;
+            if(e->ms < TUNNEL_END_MS && e->ms + ACCEL_PERIOD_MS >= TUNNEL_END_MS){
+                tunnelError = error;
+            }
+        }
+    }
+    float rms = samples > 0 ? (float)sqrt(squares / samples) : INFINITY;
+    distanceError = (fusionGetDistance() - last->trueDistance) / last->trueDistance;
+    bool ok = rms <= MAX_SPEED_RMS && fabsf(tunnelError) <= MAX_TUNNEL_ERROR &&
+              fabsf(distanceError) <= MAX_DISTANCE_ERROR;
+    printf("%-14s speed rms %.3f m/s, end of the tunnel %+.3f m/s, distance %+.2f%%%s\n",
+           wheel ? "wheel and GPS" : "GPS only", rms, tunnelError, distanceError * 100.0f, ok ? "" : "  <-- FAIL");
+    return ok;
+}
+
+static uint64_t nowNs(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/*!
+    @brief      Mean time of the calls of each kind over some replays of the ride
+*/
+static void benchmark(uint32_t replays){
+    uint64_t total[EVENT_KINDS] = {0}, calls[EVENT_KINDS] = {0}, overhead = 0, start;
+    uint32_t r, i;
+    double perRideS = 0;
+
+    //Cost of reading the clock, subtracted from every call
+    for(i = 0; i < 100000u; ++i){
+        start = nowNs();
+        overhead += nowNs() - start;
+    }
+    double clockNs = overhead / 100000.0;
+
+    for(r = 0; r < replays; ++r){
+        fusionReset(0);
+        for(i = 0; i < eventCount; ++i){
+            start = nowNs();
+            replay(&events[i]);
+            total[events[i].kind] += nowNs() - start;
+            calls[events[i].kind]++;
+        }
+    }
+
+    printf("%-16s %10s %8s %12s\n", "update", "calls/s", "ns/call", "us/s of ride");
+    for(i = 0; i < EVENT_KINDS; ++i){
+        double ns = fmax(total[i] / (double)calls[i] - clockNs, 0);
+        double rate = calls[i] / (double)replays / (RIDE_MS / 1000.0);
+        printf("%-16s %10.2f %8.1f %12.3f\n", kindNames[i], rate, ns, rate * ns / 1000.0);
+        perRideS += rate * ns / 1000.0;
+    }
+    printf("%-16s %10s %8s %12.3f  (clock %.1f ns subtracted)\n", "total", "", "", perRideS, clockNs);
+}
+
+int main(int argc, char* argv[]){
+    uint32_t replays = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200u;
+    bool ok = true;
+
+    makeRide();
+    printf("%u measurements in %u s of ride\n", (unsigned)eventCount, (unsigned)(RIDE_MS / 1000));
+    ok &= accuracy(true);
+    ok &= accuracy(false);
+    benchmark(replays > 0 ? replays : 1);
+    return ok ? 0 : 1;
+}
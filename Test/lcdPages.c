@@ -0,0 +1,128 @@
+/*!
+    @file       lcdPages.c
+    @brief      Golden image test of the pages of the LCD on the host emulator
+    @details    The three pages of mainInterface.c are drawn on the emulator of the Crystalfontz LCD
+                with fixed values, moving between them with the joystick as on the device, and every
+                page is compared with its golden image in Test/lcd. A change of the UI that moves a
+                pixel fails the test; when the change is wanted the images are written again with -u
+                and committed with it. The frame statistics of every page are printed as well.
+                The exit status is 1 if a page differs from its image or an image is missing.
+
+                Usage:
+                    build/test/lcdPages [-u] [directory of the images, default Test/lcd]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "mainInterface.h"
+#include "LcdDriver/HAL_SIM_Crystalfontz128x128_ST7735.h"
+
+#define JOYSTICK_CENTER     8192
+#define JOYSTICK_RIGHT      16000
+
+//! SPI profile of the LCD, ignored by the emulator
+static eUSCI_SPI_MasterConfig lcdConfig = {0, LCD_SYSTEM_CLOCK_SPEED, LCD_SPI_CLOCK_SPEED, 0, 0, 0, 0};
+
+/*!
+    @brief      Values shown by the pages, the same at every run
+*/
+static void setValues(void){
+    myParamStruct.distance = 12.34f;
+    myParamStruct.temp = 23.5f;
+    strcpy(myParamStruct.time, "10:42:07");
+    myParamStruct.altitude = 212.0f;
+    myParamStruct.sats = 9;
+    myParamStruct.speed = 27.8f;
+    strcpy(myParamStruct.tripTime, "00:41:15");
+    myParamStruct.grade = 4.5f;
+    myParamStruct2.hdop = 0.92f;
+    myParamStruct2.vdop = 1.35f;
+    myParamStruct2.speed = 27.6f;
+    strcpy(myParamStruct2.fixType, "3D");
+}
+
+/*!
+    @brief      Compare the panel with the image of a page, or write it
+    @return     true if the page is the same of the image or the image has been written
+*/
+static bool checkPage(const char* dir, const char* name, bool update){
+    char path[256];
+    LCDSim_FrameStats_t stats;
+    int32_t differences;
+
+    LCDSim_EndFrame(&stats);
+    printf("%s: %u pixels touched, %u changed, %u SPI bytes, %u draw frames, %u us\n", name,
+           (unsigned)stats.pixelsTouched, (unsigned)stats.pixelsChanged, (unsigned)stats.spiBytes,
+           (unsigned)stats.drawFrames, (unsigned)stats.busTimeUs);
+    snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+    if(update){
+        if(!LCDSim_SavePPM(path)){
+            printf("%s: could not write %s\n", name, path);
+            return false;
+        }
+        printf("%s: written %s\n", name, path);
+        return true;
+    }
+    differences = LCDSim_CompareWithPPM(path);
+    if(differences < 0){
+        printf("%s: no golden image %s, write it with -u\n", name, path);
+        return false;
+    }
+    if(differences != 0){
+        snprintf(path, sizeof(path), "%s/%s.new.ppm", dir, name);
+        LCDSim_SavePPM(path);
+        printf("%s: %d pixels differ, the page is in %s\n", name, (int)differences, path);
+        return false;
+    }
+    return true;
+}
+
+/*!
+    @brief      Move the joystick to the right and back, as the rider does to change page
+*/
+static void nextPage(void){
+    LCDSim_SetJoystick(JOYSTICK_RIGHT, JOYSTICK_CENTER, false);
+    scrollPages();
+    LCDSim_SetJoystick(JOYSTICK_CENTER, JOYSTICK_CENTER, false);
+    scrollPages();
+}
+
+int main(int argc, char* argv[]){
+    const char* dir = "Test/lcd";
+    bool update = false;
+    bool ok = true;
+    int i;
+
+    for(i = 1; i < argc; ++i){
+        if(strcmp(argv[i], "-u") == 0){
+            update = true;
+        }else{
+            dir = argv[i];
+        }
+    }
+
+    //Same initialization of main()
+    LCDSim_Reset();
+    graphicsInitSelected(&lcdConfig);
+    graphicsInitBigFont(&lcdConfig);
+    graphicsInit(&lcdConfig);
+    drawGrid1();
+    setValues();
+
+    showPages();
+    ok &= checkPage(dir, "page1", update);
+    nextPage();
+    showPages();
+    ok &= checkPage(dir, "page2", update);
+    nextPage();
+    showPages();
+    ok &= checkPage(dir, "page3", update);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,399 @@
+"""Model of the PWM engine of the lights (see lights.h) on TIMER_A2 and DMA channel 4.
+
+Builds the same tables of lights.c and runs them count by count on a model of the timer: up mode to
+CCR0, CCR3 and CCR4 in set/reset mode, the DMA writing the next value of a sequence into CCR4 at
+every CCR0 event. Every period of a sequence must have exactly the duty of its level, the off level
+no high count at all, and the ramps must change by one level per period. The BSS ticks of
+bssFsm.c then drive the engine as BSS.c does through day and night rides with braking: the brake
+light must reach full brightness in the ramp time, hold it and fall back to the tail level or off,
+and the power of the lights is compared with the on/off lights they replace.
+The exit status is 1 if a check fails.
+
+Usage:
+    python3 Test/lights.py                      # all the checks
+    python3 Test/lights.py --csv lights.csv     # duty of every period of the rides
+    python3 Test/lights.py --check-c build/test/lightsHost  # same tables and levels from lights.c
+"""
+
+import argparse
+import subprocess
+import sys
+
+ACLK_HZ = 32768
+PERIOD = 128                    # LIGHTS_PWM_PERIOD
+DUTY_MAX = PERIOD - 1
+OFF = PERIOD                    # compare value never reached
+LEVEL_MAX = 63
+GAMMA = 2.2
+TAIL_LEVEL = 40
+DAY_LEVEL = 48
+DIM_LEVEL = 32
+PULSE_EDGE = 16
+PULSE_HOLD = 16
+FRONT_MA = 250.0                # battery current at full duty
+REAR_MA = 60.0
+STEP_MS = 1000.0 * PERIOD / ACLK_HZ
+FLASH_PERIOD_MS = 150
+PATTERN_TICKS = 8
+LIGHT_ON = 30.0                 # default threshold of bssFsm.c
+CPU_COUNT = 57                  # count of the period when the flashing timer writes, any would do
+
+IDLE, ERROR, BRAKING, MOVING, LOW, CRASH = range(6)
+NAMES = ("IDLE", "ERROR", "BRAKING", "MOVING", "LOW_AMBIENT_LIGHT", "CRASH")
+D_OFF, D_STEADY, D_BLINK, D_FLASH, D_BRAKE = range(5)
+REAR, FRONT = 4, 3              # compare registers
+
+# Same patterns of bssFsm.c: rear bits, front bits, keep rear, keep front, rear drive, front drive
+PATTERNS = {IDLE: (0x00, 0x00, True, True, D_OFF, D_OFF), ERROR: (0x55, 0x55, False, False, D_BLINK, D_BLINK),
+            BRAKING: (0xFF, 0x00, False, True, D_BRAKE, D_OFF), MOVING: (0x05, 0x01, False, False, D_FLASH, D_FLASH),
+            LOW: (0xFF, 0xFF, False, False, D_STEADY, D_STEADY), CRASH: (0x15, 0x15, False, False, D_BLINK, D_BLINK)}
+
+
+def duty_of(level):
+    duty = int(DUTY_MAX * (float(level) / LEVEL_MAX) ** GAMMA + 0.5)
+    return 1 if level > 0 and duty == 0 else duty
+
+
+def compare_of(duty):
+    return OFF if duty == 0 else DUTY_MAX - duty
+
+
+RISING = [compare_of(duty_of(level)) for level in range(LEVEL_MAX + 1)]
+FALLING = RISING[::-1]
+PULSE_LEVEL = ([(LEVEL_MAX * (i + 1) + PULSE_EDGE // 2) // PULSE_EDGE for i in range(PULSE_EDGE)] +
+               [LEVEL_MAX] * PULSE_HOLD +
+               [(LEVEL_MAX * (PULSE_EDGE - 1 - i) + PULSE_EDGE // 2) // PULSE_EDGE for i in range(PULSE_EDGE)])
+PULSE = [RISING[level] for level in PULSE_LEVEL]
+
+
+def ambient_level(light, light_on):
+    if light_on <= 0 or light >= light_on:
+        return DIM_LEVEL
+    if light <= 0:
+        return LEVEL_MAX
+    return int(DIM_LEVEL + (LEVEL_MAX - DIM_LEVEL) * (light_on - light) / light_on + 0.5)
+
+
+class Timer:
+    """TIMER_A2 in up mode with two outputs in set/reset mode, DMA channel 4 on the CCR0 event"""
+
+    def __init__(self):
+        self.ccr = {FRONT: OFF, REAR: OFF}
+        self.out = {FRONT: False, REAR: False}
+        self.dma = []                   # values left of the running sequence
+        self.dma_len = 0
+        self.dma_writes = 0
+        self.conflicts = 0              # CCRn equal to CCR0: set and reset at the same count
+
+    def period(self, cpu=None):
+        """One PWM period: high counts of each output. cpu() is called at CPU_COUNT"""
+        high = {FRONT: 0, REAR: 0}
+        for tar in range(PERIOD):
+            if cpu is not None and tar == CPU_COUNT:
+                cpu()
+            for n in (FRONT, REAR):
+                if self.ccr[n] == tar:
+                    self.out[n] = True
+                if tar == PERIOD - 1:
+                    if self.ccr[n] == tar:
+                        self.conflicts += 1
+                    self.out[n] = False
+                high[n] += self.out[n]
+            if tar == PERIOD - 1 and self.dma:
+                # The request of the CCR0 event is served long before the next ACLK count
+                self.ccr[REAR] = self.dma.pop(0)
+                self.dma_writes += 1
+        return high
+
+
+class Lights:
+    """Same engine of lights.c on the model of the timer"""
+
+    def __init__(self, timer):
+        self.timer = timer
+        self.front = 0
+        self.rear = 0
+        self.seq_from = 0
+        self.seq_dir = 0
+        self.cpu_writes = 0
+
+    def start(self, table):
+        self.timer.dma = list(table)
+        self.timer.dma_len = len(table)
+
+    def set_front(self, level):
+        self.front = min(level, LEVEL_MAX)
+        self.timer.ccr[FRONT] = RISING[self.front]
+        self.cpu_writes += 1
+
+    def set_rear(self, level):
+        self.timer.dma = []
+        self.rear = min(level, LEVEL_MAX)
+        self.timer.ccr[REAR] = RISING[self.rear]
+        self.cpu_writes += 1
+
+    def busy(self):
+        return bool(self.timer.dma)
+
+    def get_rear(self):
+        if not self.busy():
+            return self.rear
+        done = self.timer.dma_len - len(self.timer.dma)
+        if done == 0:
+            return self.seq_from
+        if self.seq_dir == 0:
+            return PULSE_LEVEL[done - 1]
+        return self.seq_from + self.seq_dir * done
+
+    def ramp_rear(self, level):
+        start = self.get_rear()
+        level = min(level, LEVEL_MAX)
+        if level == start:
+            self.set_rear(level)
+            return
+        self.seq_from, self.rear = start, level
+        if level > start:
+            self.seq_dir = 1
+            self.start(RISING[start + 1:level + 1])
+        else:
+            self.seq_dir = -1
+            self.start(FALLING[LEVEL_MAX - start + 1:LEVEL_MAX - level + 1])
+
+    def pulse_rear(self):
+        self.seq_from, self.seq_dir, self.rear = self.get_rear(), 0, 0
+        self.start(PULSE)
+
+
+class Bss:
+    """Drive of the lights of BSS.c at every tick of the flashing timer"""
+
+    def __init__(self, lights):
+        self.lights = lights
+        self.rear_drive = D_OFF
+        self.front_ambient = LEVEL_MAX
+
+    def rear_light(self, drive, on):
+        g = self.lights
+        release = self.rear_drive == D_BRAKE and drive != D_BRAKE
+        if drive == D_BRAKE:
+            if self.rear_drive != D_BRAKE:
+                g.ramp_rear(LEVEL_MAX)
+        elif drive == D_STEADY:
+            if release:
+                g.ramp_rear(TAIL_LEVEL)
+            elif not g.busy():
+                g.set_rear(TAIL_LEVEL)
+        elif drive == D_BLINK:
+            g.set_rear(LEVEL_MAX if on else 0)
+        elif drive == D_FLASH:
+            if release:
+                g.ramp_rear(0)
+            elif on and not g.busy():
+                g.pulse_rear()
+        else:
+            if release:
+                g.ramp_rear(0)
+            elif not g.busy():
+                g.set_rear(0)
+        self.rear_drive = drive
+
+    def front_light(self, drive, on):
+        level = {D_STEADY: self.front_ambient, D_BLINK: LEVEL_MAX if on else 0,
+                 D_FLASH: DAY_LEVEL if on else 0}.get(drive, 0)
+        self.lights.set_front(level)
+
+    def tick(self, state, dwell):
+        rear, front, keep_rear, keep_front, rear_drive, front_drive = PATTERNS[state]
+        bit = 1 << (dwell % PATTERN_TICKS)
+        if not keep_rear:
+            self.rear_light(rear_drive, bool(rear & bit))
+        if not keep_front:
+            self.front_light(front_drive, bool(front & bit))
+
+
+def run_sequence(name, start_level, action):
+    """Periods of a DMA sequence: duty of each period against the duty of its level"""
+    timer = Timer()
+    lights = Lights(timer)
+    lights.set_rear(start_level)
+    timer.period()
+    action(lights)
+    levels = []
+    duties = []
+    while True:
+        busy = lights.busy()
+        level_before = lights.get_rear()
+        duties.append(timer.period()[REAR])
+        levels.append(level_before)
+        if not busy:
+            break
+    # The value written at a CCR0 event is the duty of the next period: the level seen before it
+    exact = all(d == duty_of(level) for d, level in zip(duties, levels))
+    steps = [abs(b - a) for a, b in zip(levels, levels[1:])]
+    ok = exact and timer.conflicts == 0 and timer.dma_writes == len(levels) - 1
+    print("%-22s %3d periods %6.1f ms  duty %3d -> %3d  largest step %d levels, %s, DMA writes %d, "
+          "interrupts 0%s" % (name, len(levels) - 1, (len(levels) - 1) * STEP_MS, duties[0], duties[-1],
+                              max(steps) if steps else 0, "every period exact" if exact else "WRONG DUTY",
+                              timer.dma_writes, "" if ok else "  <-- not as expected"))
+    return ok, levels
+
+
+def check_tables():
+    ok = True
+    timer = Timer()
+    for level in range(LEVEL_MAX + 1):
+        timer.ccr[REAR] = RISING[level]
+        timer.period()
+        high = timer.period()[REAR]
+        ok &= high == duty_of(level)
+    ok &= duty_of(0) == 0 and duty_of(LEVEL_MAX) == DUTY_MAX and timer.conflicts == 0
+    ok &= all(duty_of(a) <= duty_of(a + 1) for a in range(LEVEL_MAX))
+    print("%d levels, PWM %.0f Hz, step %.2f ms: level 0 has %d high counts, level %d %d of %d%s" %
+          (LEVEL_MAX + 1, ACLK_HZ / PERIOD, STEP_MS, duty_of(0), LEVEL_MAX, duty_of(LEVEL_MAX), PERIOD,
+           "" if ok else "  <-- not as expected"))
+    return ok
+
+
+def ride(windows):
+    """Duty of every period for a list of (class, ambient light) BSS windows"""
+    timer = Timer()
+    lights = Lights(timer)
+    bss = Bss(lights)
+    state, dwell = None, 0
+    out = []
+    period = 0
+    for index, (new_state, light) in enumerate(windows):
+        dwell = dwell + 1 if new_state == state else 0
+        state = new_state
+        bss.front_ambient = ambient_level(light, LIGHT_ON)
+        end = int((index + 1) * FLASH_PERIOD_MS / STEP_MS)
+        first = True
+        while period < end:
+            cpu = (lambda: bss.tick(state, dwell)) if first else None
+            high = timer.period(cpu)
+            out.append((period * STEP_MS, state, high[REAR], high[FRONT]))
+            first = False
+            period += 1
+    return out, lights, timer
+
+
+def window_list(parts):
+    out = []
+    for state, seconds, light in parts:
+        out += [(state, light)] * int(round(seconds * 1000 / FLASH_PERIOD_MS))
+    return out
+
+
+def check_ride(name, parts, base):
+    """Brake light of a ride: ramp to full, hold, back to the base level of the next class"""
+    samples, lights, timer = ride(window_list(parts))
+    full = duty_of(LEVEL_MAX)
+    ok = timer.conflicts == 0
+    entry = next(i for i, s in enumerate(samples) if s[1] == BRAKING)
+    reach = next(i for i in range(entry, len(samples)) if samples[i][2] == full)
+    attack_ms = samples[reach][0] - samples[entry][0]
+    braking_end = max(i for i, s in enumerate(samples) if s[1] == BRAKING)
+    hold = all(s[2] == full for s in samples[reach:braking_end + 1])
+    after = samples[braking_end + 1:]
+    settle = next(i for i, s in enumerate(after) if s[2] == duty_of(base))
+    release = [s[2] for s in after[:settle + 1]]
+    monotonic = all(b <= a for a, b in zip(release, release[1:]))
+    ok &= attack_ms <= LEVEL_MAX * STEP_MS + FLASH_PERIOD_MS and hold and monotonic
+    energy = {}
+    for _, state, rear, front in samples:
+        e = energy.setdefault(state, [0, 0, 0])
+        e[0] += rear
+        e[1] += front
+        e[2] += 1
+    power = ", ".join("%s rear %2.0f%% front %2.0f%%" % (NAMES[s], 100.0 * e[0] / e[2] / PERIOD,
+                                                         100.0 * e[1] / e[2] / PERIOD)
+                      for s, e in sorted(energy.items()))
+    print("%-22s brake light full in %5.1f ms, %s, back to %d%% in %5.1f ms; CPU writes %d, DMA writes %d%s" %
+          (name, attack_ms, "held" if hold else "NOT HELD", 100 * duty_of(base) // PERIOD,
+           settle * STEP_MS, lights.cpu_writes, timer.dma_writes, "" if ok else "  <-- not as expected"))
+    print("%-22s power %s" % ("", power))
+    return ok, samples
+
+
+def current(front, rear):
+    return (FRONT_MA * duty_of(front) + REAR_MA * duty_of(rear)) / PERIOD
+
+
+# Cases of the host program of lights.c: current every CURRENT_STEP levels, ambient light around the threshold
+CURRENT_STEP = 7
+AMBIENT = [(light * 0.25, LIGHT_ON) for light in range(-4, 141)] + [(10.0, 0.0), (5.0, -1.0)]
+C_CURRENT_TOLERANCE = 0.001     # [mA], printed with 4 decimals
+
+
+def check_c(binary):
+    """Runs the tables, currents and ambient levels of lights.c (Test/lightsHost.c), returns the differences"""
+    rows = "light,light_on\n" + "".join("%.9g,%.9g\n" % case for case in AMBIENT)
+    output = subprocess.run([binary], input=rows, capture_output=True, text=True, check=True).stdout
+    compares, currents, ambients = [], [], []
+    for line in output.splitlines():
+        fields = line.split(",")
+        if fields[0] == "compare":
+            compares.append((int(fields[1]), int(fields[2])))
+        elif fields[0] == "current":
+            currents.append((int(fields[1]), int(fields[2]), float(fields[3])))
+        elif fields[0] == "ambient":
+            ambients.append((float(fields[1]), float(fields[2]), int(fields[3])))
+    errors = []
+    if compares != list(enumerate(RISING)):
+        errors.append("compare values %s" % next(("level %d: %d, %d expected" % (c[0], c[1], RISING[c[0]])
+                                                  for c in compares if c[0] < len(RISING) and c[1] != RISING[c[0]]),
+                                                 "%d levels" % len(compares)))
+    steps = range(0, LEVEL_MAX + 1, CURRENT_STEP)
+    if [c[:2] for c in currents] != [(f, r) for f in steps for r in steps]:
+        errors.append("%d currents" % len(currents))
+    errors += ["current front %d rear %d: %.4f mA, %.4f expected" % (f, r, ma, current(f, r))
+               for f, r, ma in currents if abs(ma - current(f, r)) > C_CURRENT_TOLERANCE]
+    if len(ambients) != len(AMBIENT):
+        errors.append("%d ambient levels" % len(ambients))
+    errors += ["ambient light %g threshold %g: level %d, %d expected" % (light, on, level, ambient_level(light, on))
+               for (light, on, level) in ambients if level != ambient_level(light, on)]
+    print("lights.c %d compare values, %d currents, %d ambient levels: %s" %
+          (len(compares), len(currents), len(ambients), "same of the model" if not errors else
+           "differs, " + "; ".join(errors[:3])))
+    return not errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Model of the PWM engine of the lights")
+    parser.add_argument("--csv", help="write the duty of every period of the rides")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with lights.c run by Test/lightsHost.c")
+    args = parser.parse_args()
+
+    ok = check_tables()
+    for name, start, action in (("ramp up", 0, lambda g: g.ramp_rear(LEVEL_MAX)),
+                                ("ramp down", LEVEL_MAX, lambda g: g.ramp_rear(0)),
+                                ("brake from tail", TAIL_LEVEL, lambda g: g.ramp_rear(LEVEL_MAX)),
+                                ("release to tail", LEVEL_MAX, lambda g: g.ramp_rear(TAIL_LEVEL)),
+                                ("daytime pulse", 0, lambda g: g.pulse_rear())):
+        result, _ = run_sequence(name, start, action)
+        ok &= result
+
+    rides = (("day ride", [(MOVING, 3, 70.0), (BRAKING, 1.2, 70.0), (IDLE, 0.15, 70.0), (MOVING, 3, 70.0)], 0),
+             ("night ride", [(LOW, 3, 8.0), (BRAKING, 1.2, 8.0), (IDLE, 0.15, 8.0), (LOW, 3, 8.0)], TAIL_LEVEL))
+    rows = []
+    for name, parts, base in rides:
+        result, samples = check_ride(name, parts, base)
+        ok &= result
+        rows += [(name,) + s for s in samples]
+
+    # The lights they replace: on/off, the braking flashing at half of the time
+    print("%-22s power LOW_AMBIENT_LIGHT rear 100%% front 100%%, BRAKING rear 50%%" % "on/off lights before")
+
+    if args.check_c:
+        ok &= check_c(args.check_c)
+
+    if args.csv:
+        with open(args.csv, "w") as out:
+            out.write("ride,t_ms,class,rear_counts,front_counts\n")
+            for name, t, state, rear, front in rows:
+                out.write("%s,%.2f,%s,%d,%d\n" % (name, t, NAMES[state], rear, front))
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
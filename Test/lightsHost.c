@@ -0,0 +1,62 @@
+/*!
+    @file       lightsHost.c
+    @brief      Tables and levels of lights.c on the PC
+    @details    The parts of lights.c built on the PC, the same of the firmware: the compare value
+                of every level, the current of the lights at their levels and the front level for
+                the ambient light. The ambient light is read from the standard input, as
+                Test/lights.py makes it: a header, then a row per case with light and light_on, the
+                threshold of the lights. The program prints a row per value:
+                    compare,<level>,<compare value>
+                    current,<front level>,<rear level>,<mA>
+                    ambient,<light>,<light_on>,<front level>
+                Test/lights.py --check-c compares them with its model. The sequences of the rear
+                light run on the DMA and are checked by the model of the timer only.
+
+                Usage:
+                    build/test/lightsHost < ambient.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Local Includes */
+#include "lights.h"
+
+#define CURRENT_STEP        7           //!< Levels between two cases of the current
+#define LINE_LEN            128
+
+int main(void){
+    char line[LINE_LEN];
+    float light, lightOn;
+    uint32_t rows = 0;
+    uint16_t front, rear;
+
+    lightsInit();
+    for(front = 0; front <= LIGHTS_LEVEL_MAX; ++front){
+        printf("compare,%u,%u\n", front, lightsGetCompare((uint8_t)front));
+    }
+    for(front = 0; front <= LIGHTS_LEVEL_MAX; front += CURRENT_STEP){
+        for(rear = 0; rear <= LIGHTS_LEVEL_MAX; rear += CURRENT_STEP){
+            lightsSetFront((uint8_t)front);
+            lightsSetRear((uint8_t)rear);
+            printf("current,%u,%u,%.4f\n", front, rear, lightsGetCurrent());
+        }
+    }
+
+    if(fgets(line, sizeof(line), stdin) == NULL){
+        return 1;
+    }
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        if(sscanf(line, "%f,%f", &light, &lightOn) != 2){
+            fprintf(stderr, "bad row %u: %s", (unsigned)rows + 1, line);
+            return 1;
+        }
+        printf("ambient,%g,%g,%u\n", light, lightOn, lightsAmbientLevel(light, lightOn));
+        rows++;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*!
+    @file       logHost.c
+    @brief      Compile-time level filtering of log.h on the PC, read back through a pipe
+    @details    The program is built once for every LOG_LEVEL (the Makefile builds logHost0 to
+                logHost4). The messages are redirected with logSetHostFd to a non blocking pipe and
+                read back, then the test checks:
+                    - only the messages of the levels up to LOG_LEVEL are written, in order;
+                    - the arguments of the removed messages are not evaluated;
+                    - a message longer than the host line is cut and the rest counted as dropped;
+                    - a full pipe drops the messages and counts them instead of blocking.
+                With LOG_LEVEL_NONE the sink is not built: only the arguments not evaluated are
+                checked.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/logHost<LOG_LEVEL>
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Local Includes */
+#include "log.h"
+
+#define READ_LEN            4096
+#define LONG_LEN            300     //!< Longer than the host line of log.c
+
+static uint32_t failures;
+
+static void check(const char* name, bool ok){
+    printf("%-66s %s\n", name, ok ? "ok" : "FAIL");
+    if(!ok){
+        failures++;
+    }
+}
+
+//! Counts its calls: a message removed by the preprocessor does not evaluate it
+static uint32_t evaluated;
+static int argument(int value){
+    evaluated++;
+    return value;
+}
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+//! Reads what the messages have written in the pipe
+static size_t readPipe(int fd, char* buf, size_t size){
+    ssize_t n;
+    size_t len = 0;
+
+    while(len < size - 1 && (n = read(fd, buf + len, size - 1 - len)) > 0){
+        len += (size_t)n;
+    }
+    buf[len] = '\0';
+    return len;
+}
+#endif
+
+static void logAllLevels(void){
+    LOG_ERROR("error %d\n", argument(LOG_LEVEL_ERROR));
+    LOG_WARN("warn %d\n", argument(LOG_LEVEL_WARN));
+    LOG_INFO("info %d\n", argument(LOG_LEVEL_INFO));
+    LOG_DEBUG("debug %d\n", argument(LOG_LEVEL_DEBUG));
+}
+
+int main(void){
+    printf("LOG_LEVEL %d\n", LOG_LEVEL);
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+    static const char* const expected[] = {"", "error 1\n", "warn 2\n", "info 3\n", "debug 4\n"};
+    char buf[READ_LEN], line[64], message[LONG_LEN + 1];
+    int fds[2];
+    uint32_t drops, written = 0;
+    uint8_t level;
+
+    if(pipe(fds) != 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0 || fcntl(fds[1], F_SETFL, O_NONBLOCK) != 0){
+        printf("no pipe\n");
+        return 1;
+    }
+    logSetHostFd(fds[1]);
+    logAllLevels();
+    check("the arguments of the messages over the level not evaluated", evaluated == LOG_LEVEL);
+    readPipe(fds[0], buf, sizeof(buf));
+    line[0] = '\0';
+    for(level = LOG_LEVEL_ERROR; level <= LOG_LEVEL; ++level){
+        strncat(line, expected[level], sizeof(line) - strlen(line) - 1);
+    }
+    check("only the messages up to LOG_LEVEL written to the pipe, in order", strcmp(buf, line) == 0);
+
+    //A message longer than the line of log.c: the first 255 bytes written, the rest dropped
+    memset(message, 'x', LONG_LEN);
+    message[LONG_LEN] = '\0';
+    drops = logGetHostDrops();
+    LOG_ERROR("%s", message);
+    check("a long message cut to the host line, the rest dropped",
+          readPipe(fds[0], buf, sizeof(buf)) == 255 && logGetHostDrops() - drops == LONG_LEN - 255);
+
+    //A full pipe: the messages are dropped and counted, the caller is not blocked
+    message[200] = '\0';
+    drops = logGetHostDrops();
+    while(logGetHostDrops() == drops && written < 1000000u){
+        LOG_ERROR("%s", message);
+        written++;
+    }
+    check("a full pipe drops the messages instead of blocking",
+          written > 1 && written < 1000000u && logGetHostDrops() - drops == 200);
+    drops = logGetHostDrops();
+    LOG_ERROR("%s", message);
+    check("the next message dropped too while the pipe is full", logGetHostDrops() - drops == 200);
+    readPipe(fds[0], buf, sizeof(buf));
+    drops = logGetHostDrops();
+    LOG_ERROR("%s", message);
+    check("a message written again when the pipe is read", logGetHostDrops() == drops);
+    close(fds[0]);
+    close(fds[1]);
+    logSetHostFd(STDOUT_FILENO);
+#else
+    //No sink: the messages are removed, argument is referenced only here
+    (void)argument;
+    logAllLevels();
+    check("the arguments of the messages not evaluated", evaluated == 0);
+#endif
+
+    printf("%s\n", failures == 0 ? "all checks passed" : "some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
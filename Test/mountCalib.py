@@ -0,0 +1,284 @@
+"""Evaluation of the mounting calibration of the bike computer (see mountCalib.h) on rotated traces.
+
+The synthetic rides of Test/attitude.py are generated in the bike frame and rotated into the
+frame of a sensor mounted at a random orientation. The same calibration of mountCalib.c, the
+rotation of the raw counts in Q14 and the attitude filter of attitude.c run on them as in the
+BSS task. The estimated up and forward axes are compared with the mounting, and the BSS window
+mean of the forward acceleration with the truth, with and without the calibration. The exit
+status is 1 if a limit is exceeded.
+
+Usage:
+    python3 Test/mountCalib.py                          # 10 random mountings
+    python3 Test/mountCalib.py --seed 4 --seed 7        # chosen mountings
+    python3 Test/mountCalib.py --max-tilt 30            # only tilts up to 30 degrees, any heading
+    python3 Test/mountCalib.py --check-c build/test/mountCalibHost   # same windows from mountCalib.c
+"""
+
+import argparse
+import csv
+import math
+import random
+import subprocess
+import sys
+
+from attitude import Attitude, SAMPLE_PERIOD, WINDOW_SIZE, synthetic_ride
+
+Q = 14
+ONE = 1 << Q
+STILL_SPEED = 0.5               # m/s
+STILL_SIGMA = 0.02              # g
+STILL_GATE = 0.05               # g
+STILL_WINDOWS = 20
+MOVED_DEG = 10.0
+MIN_SPEED = 2.0                 # m/s
+MIN_ALONG = 0.5                 # m/s^2
+MAX_LATERAL = 0.1               # g
+FORWARD_WEIGHT = 1.0            # g^2
+GRAVITY = 9.81
+ACCEL_LSB_PER_G = 4096.0        # MPU6050.h
+GYRO_LSB_PER_DPS = 65.5
+
+# Regression limits: axes error [deg], rms of the BSS window mean of the forward acceleration [g]
+LIMITS = {"up": 2.0, "forward": 5.0, "lin_x": 0.03}
+BRAKING = -0.15                 # g, windows of braking in the truth
+# Largest difference of mountCalib.c from this model: counts of the Q14 matrix, window mean of lin_x [g]
+C_MATRIX_TOLERANCE = 2
+C_LIN_X_TOLERANCE = 0.001
+
+
+def dot(a, b):
+    return sum(x * y for x, y in zip(a, b))
+
+
+def normalize(v):
+    norm = math.sqrt(dot(v, v))
+    return [x / norm for x in v] if norm >= 1e-3 else None
+
+
+def lround(x):
+    return int(math.copysign(math.floor(abs(x) + 0.5), x))
+
+
+class MountCalib:
+    """Same calibration of mountCalib.c"""
+
+    def __init__(self, period=SAMPLE_PERIOD):
+        self.period = period
+        self.state = 0                          # 0 uncalibrated, 1 gravity, 2 calibrated
+        self.matrix = [[ONE, 0, 0], [0, ONE, 0], [0, 0, ONE]]
+        self.window = []
+        self.speed = None
+        self.confirmed = False
+        self.gravity = []
+        self.moved = []
+        self.forward_sum = [0.0, 0.0, 0.0]
+        self.forward_weight = 0.0
+
+    def horizontal(self, v):
+        along = dot(v, self.up)
+        return normalize([v[i] - along * self.up[i] for i in range(3)])
+
+    def build(self):
+        if self.state == 1:
+            axis = 0
+            if abs(self.up[0]) > 0.7:
+                axis = 1 if abs(self.up[1]) < abs(self.up[2]) else 2
+            self.forward = self.horizontal([1.0 if i == axis else 0.0 for i in range(3)])
+        u, f = self.up, self.forward
+        left = [u[1] * f[2] - u[2] * f[1], u[2] * f[0] - u[0] * f[2], u[0] * f[1] - u[1] * f[0]]
+        self.matrix = [[lround(v * ONE) for v in row] for row in (f, left, u)]
+
+    def add_sample(self, accel):
+        self.window.append(accel)
+
+    def still(self, up):
+        if self.state == 0:
+            self.gravity.append(up)
+            if len(self.gravity) < STILL_WINDOWS:
+                return False
+            self.up = normalize([sum(v[i] for v in self.gravity) for i in range(3)])
+            self.state = 1
+            self.build()
+            return True
+        if dot(up, self.up) > math.cos(math.radians(MOVED_DEG)):
+            self.moved = []
+            return False
+        self.moved.append(up)
+        if len(self.moved) < STILL_WINDOWS:
+            return False
+        self.up = normalize([sum(v[i] for v in self.moved) for i in range(3)])
+        self.moved = []
+        self.forward_sum = [0.0, 0.0, 0.0]
+        self.forward_weight = 0.0
+        self.state = 1
+        self.build()
+        return True
+
+    def moving(self, mean, along):
+        d = [mean[i] - self.up[i] for i in range(3)]
+        if dot(d, d) - along * along > MAX_LATERAL * MAX_LATERAL:
+            return False
+        self.forward_sum = [self.forward_sum[i] + d[i] * along for i in range(3)]
+        self.forward_weight += along * along
+        if self.forward_weight < FORWARD_WEIGHT:
+            return False
+        forward = self.horizontal(self.forward_sum)
+        self.forward_sum = [0.0, 0.0, 0.0]
+        self.forward_weight = 0.0
+        if forward is None:
+            return False
+        self.forward = forward
+        self.state = 2
+        self.build()
+        return True
+
+    def add_speed(self, speed, confirmed):
+        changed = False
+        count = len(self.window)
+        if count:
+            mean = [sum(a[i] for a in self.window) / count for i in range(3)]
+            norm = math.sqrt(dot(mean, mean))
+            variance = sum(dot(a, a) for a in self.window) / count - norm * norm
+            if speed < STILL_SPEED and variance < STILL_SIGMA ** 2 and abs(norm - 1) < STILL_GATE:
+                changed = self.still([v / norm for v in mean])
+            elif (self.state == 1 and self.speed is not None and self.confirmed and confirmed and
+                  speed >= MIN_SPEED and self.speed >= MIN_SPEED):
+                along = (speed - self.speed) / (count * self.period)
+                if abs(along) >= MIN_ALONG:
+                    changed = self.moving(mean, along / GRAVITY)
+        self.window = []
+        self.speed = speed
+        self.confirmed = confirmed
+        return changed
+
+    def rotate(self, v):
+        out = [(dot(row, v) + (1 << (Q - 1))) >> Q for row in self.matrix]
+        return [max(-32768, min(32767, x)) for x in out]
+
+
+def random_mount(rnd, max_tilt):
+    """Rotation from the sensor to the bike frame: any heading of the box, tilted up to max_tilt"""
+    yaw = rnd.uniform(-math.pi, math.pi)
+    tilt = math.radians(rnd.uniform(0, max_tilt))
+    axis = rnd.uniform(-math.pi, math.pi)
+    # Rodrigues rotation by tilt around a horizontal axis k: cos I + sin [k]x + (1 - cos) k k^T
+    k = [math.cos(axis), math.sin(axis), 0.0]
+    c, s = math.cos(tilt), math.sin(tilt)
+    cross = [[0.0, -k[2], k[1]], [k[2], 0.0, -k[0]], [-k[1], k[0], 0.0]]
+    tilt_m = [[c * (i == j) + s * cross[i][j] + (1 - c) * k[i] * k[j] for j in range(3)] for i in range(3)]
+    cy, sy = math.cos(yaw), math.sin(yaw)
+    yaw_m = [[cy, -sy, 0.0], [sy, cy, 0.0], [0.0, 0.0, 1.0]]
+    return [[sum(tilt_m[i][m] * yaw_m[m][j] for m in range(3)) for j in range(3)] for i in range(3)]
+
+
+def angle(a, b):
+    cross = [a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]]
+    return math.degrees(math.atan2(math.sqrt(dot(cross, cross)), dot(a, b)))
+
+
+def run(samples, mount, calibrate, record=None):
+    """BSS task on the trace rotated by mount, returns the calibration, the window means of lin_x and
+    the window of the last change of the matrix. With record, the raw samples of the sensor and the
+    state and matrix of every window are appended to its "samples" and "windows" lists"""
+    calib = MountCalib()
+    attitude = Attitude()
+    means = []
+    linear = []
+    changed = 0
+    for number, sample in enumerate(samples):
+        if number % WINDOW_SIZE == 0:
+            if linear:
+                means.append(sum(linear) / len(linear))
+                linear = []
+            if calibrate and calib.add_speed(sample["speed"], True):
+                attitude = Attitude()
+                changed = number // WINDOW_SIZE
+            attitude.set_speed(sample["speed"])
+            if record is not None:
+                record["windows"].append((calib.state, [v for row in calib.matrix for v in row]))
+        # Sensor frame: v_sensor = mount^T v_bike, then the raw counts of the FIFO
+        accel = [sum(mount[j][i] * sample["a" + "xyz"[j]] for j in range(3)) for i in range(3)]
+        gyro = [sum(mount[j][i] * sample["g" + "xyz"[j]] for j in range(3)) for i in range(3)]
+        raw_a = [max(-32768, min(32767, lround(v * ACCEL_LSB_PER_G))) for v in accel]
+        raw_g = [max(-32768, min(32767, lround(v * GYRO_LSB_PER_DPS))) for v in gyro]
+        if record is not None:
+            record["samples"].append(raw_a + raw_g + [sample["speed"]])
+        calib.add_sample([v / ACCEL_LSB_PER_G for v in raw_a])
+        raw_a = calib.rotate(raw_a)
+        raw_g = calib.rotate(raw_g)
+        attitude.update([v / ACCEL_LSB_PER_G for v in raw_a], [v / GYRO_LSB_PER_DPS for v in raw_g])
+        linear.append(attitude.linear[0])
+    return calib, means, changed
+
+
+def check_c(binary, record, means):
+    """Runs the raw samples through mountCalib.c (Test/mountCalibHost.c), returns the list of the differences"""
+    trace = "ax,ay,az,gx,gy,gz,speed\n" + "".join("%d,%d,%d,%d,%d,%d,%.9g\n" % tuple(row) for row in record["samples"])
+    output = subprocess.run([binary], input=trace, capture_output=True, text=True, check=True).stdout
+    rows = list(csv.reader(output.splitlines()))[1:]
+    if len(rows) != len(means):
+        return ["%d windows from mountCalib.c, %d expected" % (len(rows), len(means))]
+    errors = []
+    for number, (row, (state, matrix), mean) in enumerate(zip(rows, record["windows"], means)):
+        matrix_c = [int(v) for v in row[1:10]]
+        if int(row[0]) != state:
+            errors.append("window %d: state %s, %d expected" % (number, row[0], state))
+        elif max(abs(a - b) for a, b in zip(matrix_c, matrix)) > C_MATRIX_TOLERANCE:
+            errors.append("window %d: matrix %s, %s expected" % (number, matrix_c, matrix))
+        elif abs(float(row[10]) - mean) > C_LIN_X_TOLERANCE:
+            errors.append("window %d: lin_x %s, %.5f expected" % (number, row[10], mean))
+        if errors:
+            break
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Mounting calibration on synthetic rotated traces")
+    parser.add_argument("--seed", type=int, action="append", help="seed of the ride and of the mounting (repeatable)")
+    parser.add_argument("--max-tilt", type=float, default=90.0, help="largest tilt of the box [deg]")
+    parser.add_argument("--skip", type=float, default=3.0, help="convergence time after the calibration left out of the lin_x error [s]")
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with mountCalib.c run by Test/mountCalibHost.c")
+    args = parser.parse_args()
+
+    failed = False
+    for seed in args.seed or range(10):
+        rnd = random.Random(1000 + seed)
+        mount = random_mount(rnd, args.max_tilt)
+        samples = synthetic_ride(seed, tilt=False)
+        truth = [sum(s["lin_x"] for s in samples[i:i + WINDOW_SIZE]) / WINDOW_SIZE
+                 for i in range(0, len(samples) - WINDOW_SIZE + 1, WINDOW_SIZE)]
+        record = {"samples": [], "windows": []}
+        calib, calibrated, changed = run(samples, mount, True, record)
+        _, raw, _ = run(samples, mount, False)
+        skip = changed + int(args.skip / (SAMPLE_PERIOD * WINDOW_SIZE))
+        result = {}
+        braking = {}
+        for calibrate, means in ((False, raw), (True, calibrated)):
+            diffs = [m - t for m, t in zip(means, truth)][skip:]
+            result[calibrate] = math.sqrt(dot(diffs, diffs) / len(diffs))
+            # Fraction of the braking deceleration seen on the x axis of the BSS
+            pairs = [(m, t) for m, t in zip(means[skip:], truth[skip:]) if t < BRAKING]
+            braking[calibrate] = sum(m for m, _ in pairs) / sum(t for _, t in pairs)
+        rows = [[v / ONE for v in row] for row in calib.matrix]
+        errors = {"up": angle(rows[2], mount[2]), "forward": angle(rows[0], mount[0]), "lin_x": result[True]}
+        tilt = math.degrees(math.acos(max(-1.0, min(1.0, mount[2][2]))))
+        print("seed %2d  tilt %4.1f deg  state %d at %4.1f s  up %4.2f deg  forward %4.2f deg  "
+              "lin_x rms %.3f g (%.3f without)  braking seen %3.0f%% (%4.0f%% without)" %
+              (seed, tilt, calib.state, changed * WINDOW_SIZE * SAMPLE_PERIOD, errors["up"], errors["forward"],
+               result[True], result[False], 100 * braking[True], 100 * braking[False]))
+        for key, limit in LIMITS.items():
+            if calib.state != 2 or errors[key] > limit:
+                print("  %s %.3f over the limit %.3f" % (key, errors[key], limit))
+                failed = True
+        if args.check_c:
+            c_errors = check_c(args.check_c, record, calibrated)
+            for error in c_errors:
+                print("  mountCalib.c " + error)
+            if not c_errors:
+                print("  mountCalib.c same state, matrix and lin_x in %d windows" % len(calibrated))
+            failed |= bool(c_errors)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+/*!
+    @file       mountCalibHost.c
+    @brief      Mounting calibration of mountCalib.c and attitude.c on raw samples read from the standard input
+    @details    The samples are the raw counts of the MPU6050 FIFO in the frame of the sensor, as
+                Test/mountCalib.py makes them from a synthetic ride rotated by a mounting: a header,
+                then a row per sample with ax,ay,az,gx,gy,gz [counts] and speed [m/s], in this order.
+                They go through the calls of the BSS task: at the start of every window the speed to
+                mountCalibAddSpeed (the attitude filter restarts when the matrix changes) and to
+                attitudeSetSpeed, then for every sample mountCalibAddSample, the rotation of the
+                counts and attitudeUpdate. For every complete window a row is printed with the state
+                and the matrix in use in the window and the mean of the forward acceleration, which
+                Test/mountCalib.py --check-c compares with its model.
+
+                Usage:
+                    build/test/mountCalibHost < samples.csv > windows.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Local Includes */
+#include "mountCalib.h"
+#include "attitude.h"
+
+#define SAMPLE_PERIOD_S     0.015f      //!< MPU6050_SAMPLE_PERIOD_S
+#define WINDOW_SIZE         10          //!< ACCEL_WINDOW_SIZE
+#define ACCEL_LSB_PER_G     4096.0f     //!< MPU6050.h
+#define GYRO_LSB_PER_DPS    65.5f
+#define LINE_LEN            256
+
+int main(void){
+    char line[LINE_LEN];
+    int16_t raw[6], matrix[3][3];
+    long value[6];
+    float speed, accel[3], gyro[3], linear[3], sum = 0;
+    uint32_t samples = 0, i;
+    MountState_t state = MOUNT_UNCALIBRATED;
+
+    if(fgets(line, sizeof(line), stdin) == NULL){
+        return 1;
+    }
+    mountCalibReset(SAMPLE_PERIOD_S);
+    attitudeReset(SAMPLE_PERIOD_S);
+    mountCalibGetMatrix(matrix);
+    printf("state,m00,m01,m02,m10,m11,m12,m20,m21,m22,lin_x\n");
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        if(sscanf(line, "%ld,%ld,%ld,%ld,%ld,%ld,%f", &value[0], &value[1], &value[2], &value[3], &value[4],
+                  &value[5], &speed) != 7){
+            fprintf(stderr, "bad row %u: %s", (unsigned)samples + 1, line);
+            return 1;
+        }
+        if(samples % WINDOW_SIZE == 0){
+            if(samples > 0){
+                printf("%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.5f\n", (int)state, matrix[0][0], matrix[0][1],
+                       matrix[0][2], matrix[1][0], matrix[1][1], matrix[1][2], matrix[2][0], matrix[2][1],
+                       matrix[2][2], sum / WINDOW_SIZE);
+            }
+            //Same order of the BSS task
+            if(mountCalibAddSpeed(speed, true)){
+                attitudeReset(SAMPLE_PERIOD_S);
+            }
+            attitudeSetSpeed(speed);
+            state = mountCalibGetState();
+            mountCalibGetMatrix(matrix);
+            sum = 0;
+        }
+        for(i = 0; i < 6; ++i){
+            raw[i] = (int16_t)value[i];
+        }
+        for(i = 0; i < 3; ++i){
+            accel[i] = raw[i] / ACCEL_LSB_PER_G;
+        }
+        mountCalibAddSample(accel);
+        mountCalibRotate(&raw[0]);
+        mountCalibRotate(&raw[3]);
+        for(i = 0; i < 3; ++i){
+            accel[i] = raw[i] / ACCEL_LSB_PER_G;
+            gyro[i] = raw[i + 3] / GYRO_LSB_PER_DPS;
+        }
+        attitudeUpdate(accel, gyro);
+        attitudeGetLinearAccel(linear);
+        sum += linear[0];
+        samples++;
+    }
+    return 0;
+}
@@ -0,0 +1,358 @@
+/*!
+    @file       numFormatHost.c
+    @brief      Output of numFormat.c against snprintf of glibc, and the cost of both on the PC
+    @details    Every function of numFormat.c is checked against the snprintf format it replaces:
+                    - numFormatInt against "%.Nd", the edge values of int32_t included;
+                    - numFormatFixed against "%.Nf" of the scaled value;
+                    - numFormatFloat against "%.Nf" for N = 0..6 on random floats of every magnitude,
+                      on the ties of the rounding (half to even on the exact value) and on the
+                      negatives, the only difference allowed being "0.00" for "-0.00"; NaN and the
+                      values out of int32_t are not printed;
+                    - numFormatTime, numFormatISO8601, numFormatISO8601Ms and numFormatCoordinate
+                      against the "%02u" fields of the formats used before.
+                The worst values of the callers fit in their buffers (the sizes are the ones of the
+                declarations in the modules), and a buffer one byte shorter gives an empty string
+                and 0 without a write past its end.
+                Then the formats of the UI, the GPX coordinates and the GPX timestamps are timed with
+                snprintf and with numFormat.c, the values taken in turn from a table. These are host
+                numbers, to compare the two on the same PC, not the cycles of the Cortex-M4F.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/numFormatHost [calls of the benchmark, default 200000]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/* Local Includes */
+#include "numFormat.h"
+
+#define RANDOM_VALUES       200000u     //!< Random floats for every number of fraction digits
+#define CANARY              '#'
+#define BUF_LEN             64
+
+static uint32_t failures;
+static uint32_t seed = 1;
+
+static void check(const char* name, bool ok){
+    printf("%-66s %s\n", name, ok ? "ok" : "FAIL");
+    if(!ok){
+        failures++;
+    }
+}
+
+//! xorshift32, the same sequence on every host
+static uint32_t random32(void){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+//! Expected output of numFormatFloat: "%.Nf" of glibc without the sign of a zero
+static void expectedFloat(char* buf, size_t size, float value, uint8_t fracDigits){
+    snprintf(buf, size, "%.*f", fracDigits, (double)value);
+    if(buf[0] == '-' && strspn(buf + 1, "0.") == strlen(buf + 1)){
+        memmove(buf, buf + 1, strlen(buf));
+    }
+}
+
+//! Prints the first differences of a function, returns true if there is none
+static bool same(const char* function, const char* got, const char* expected, uint32_t* shown){
+    if(strcmp(got, expected) == 0){
+        return true;
+    }
+    if((*shown)++ < 3){
+        printf("    %s: \"%s\", snprintf \"%s\"\n", function, got, expected);
+    }
+    return false;
+}
+
+/*!
+    @brief      numFormatInt and numFormatFixed
+*/
+static void testIntegers(void){
+    static const int32_t edges[] = {0, 1, -1, 9, -9, 10, -10, 999999, -1000000, INT32_MAX, INT32_MIN,
+                                    INT32_MIN + 1};
+    char got[BUF_LEN], expected[BUF_LEN];
+    uint32_t i, shown = 0, differences = 0;
+    uint8_t digits;
+
+    for(i = 0; i < sizeof(edges) / sizeof(edges[0]) + 100000u; ++i){
+        int32_t value = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : (int32_t)random32() >> (random32() % 32);
+        for(digits = 0; digits <= 12; ++digits){
+            numFormatInt(got, sizeof(got), value, digits);
+            snprintf(expected, sizeof(expected), "%.*d", digits, (int)value);
+            //"%.0d" prints nothing for 0, numFormatInt one digit at least
+            if(digits == 0 && value == 0){
+                strcpy(expected, "0");
+            }
+            differences += !same("numFormatInt", got, expected, &shown);
+        }
+    }
+    check("numFormatInt as \"%.Nd\"", differences == 0);
+
+    differences = 0;
+    for(i = 0; i < sizeof(edges) / sizeof(edges[0]) + 100000u; ++i){
+        int32_t value = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : (int32_t)random32() >> (random32() % 32);
+        for(digits = 0; digits <= NUMFORMAT_MAX_FRAC_DIGITS; ++digits){
+            numFormatFixed(got, sizeof(got), value, digits);
+            //The scaled value is exact in a double, "%.Nf" prints its digits
+            snprintf(expected, sizeof(expected), "%.*f", digits, value / pow(10, digits));
+            if(value < 0 && strspn(expected + 1, "0.") == strlen(expected + 1)){
+                memmove(expected, expected + 1, strlen(expected));
+            }
+            differences += !same("numFormatFixed", got, expected, &shown);
+        }
+    }
+    check("numFormatFixed as \"%.Nf\" of the scaled value", differences == 0);
+    check("numFormatFixed: more than 6 fraction digits not printed",
+          numFormatFixed(got, sizeof(got), 1, NUMFORMAT_MAX_FRAC_DIGITS + 1) == 0 && got[0] == '\0');
+}
+
+/*!
+    @brief      numFormatFloat on random values, ties, negatives and the values not printed
+*/
+static void testFloat(void){
+    static const float ties[] = {0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, -0.625f, 0.0625f, 1.03125f,
+                                 0.5078125f, 1023.5f, 4194304.5f, 0.000003814697265625f, 1e-7f, -1e-9f,
+                                 0.0f, -0.0f, 0.005f, -0.005f, 0.045f, 2147483520.0f, -2147483520.0f};
+    char got[BUF_LEN], expected[BUF_LEN];
+    uint32_t i, shown = 0, differences = 0, values = 0;
+    uint8_t digits;
+    float value;
+
+    for(digits = 0; digits <= NUMFORMAT_MAX_FRAC_DIGITS; ++digits){
+        for(i = 0; i < RANDOM_VALUES; ++i){
+            //Random bits of a float with an exponent from 2^-40 to 2^30: all the magnitudes printed
+            uint32_t bits = (random32() & 0x807FFFFFu) | ((uint32_t)(87 + random32() % 71) << 23);
+            memcpy(&value, &bits, sizeof(value));
+            numFormatFloat(got, sizeof(got), value, digits);
+            expectedFloat(expected, sizeof(expected), value, digits);
+            differences += !same("numFormatFloat", got, expected, &shown);
+            values++;
+        }
+    }
+    printf("%u random floats\n", (unsigned)values);
+    check("numFormatFloat as \"%.Nf\" on random floats", differences == 0);
+
+    differences = 0;
+    for(digits = 0; digits <= NUMFORMAT_MAX_FRAC_DIGITS; ++digits){
+        for(i = 0; i < sizeof(ties) / sizeof(ties[0]); ++i){
+            numFormatFloat(got, sizeof(got), ties[i], digits);
+            expectedFloat(expected, sizeof(expected), ties[i], digits);
+            differences += !same("numFormatFloat", got, expected, &shown);
+        }
+    }
+    check("numFormatFloat: ties rounded half to even, as \"%.Nf\"", differences == 0);
+    check("numFormatFloat: \"0.00\" for -0.001, not \"-0.00\"",
+          numFormatFloat(got, sizeof(got), -0.001f, 2) == 4 && strcmp(got, "0.00") == 0);
+    check("numFormatFloat: -0.375 rounded to \"-0.38\", -0.005 (under the tie) to \"0.00\"",
+          numFormatFloat(got, sizeof(got), -0.375f, 2) == 5 && strcmp(got, "-0.38") == 0 &&
+          numFormatFloat(got, sizeof(got), -0.005f, 2) == 4 && strcmp(got, "0.00") == 0);
+    check("numFormatFloat: NaN, infinities and 2^31 not printed",
+          numFormatFloat(got, sizeof(got), NAN, 2) == 0 && got[0] == '\0' &&
+          numFormatFloat(got, sizeof(got), INFINITY, 2) == 0 && numFormatFloat(got, sizeof(got), -INFINITY, 2) == 0 &&
+          numFormatFloat(got, sizeof(got), 2147483648.0f, 0) == 0 &&
+          numFormatFloat(got, sizeof(got), -2147483648.0f, 0) == 0);
+    check("numFormatFloat: more than 6 fraction digits not printed",
+          numFormatFloat(got, sizeof(got), 1.0f, NUMFORMAT_MAX_FRAC_DIGITS + 1) == 0 && got[0] == '\0');
+}
+
+/*!
+    @brief      Durations, timestamps and coordinates
+*/
+static void testFields(void){
+    char got[BUF_LEN], expected[BUF_LEN];
+    uint32_t i, shown = 0, differences = 0;
+    struct tm timeInfo;
+    float degrees;
+
+    for(i = 0; i < 100000u; ++i){
+        uint32_t seconds = i < 1000u ? i * 397u : random32() % 4000000u;
+        numFormatTime(got, sizeof(got), seconds);
+        snprintf(expected, sizeof(expected), "%02u:%02u:%02u", (unsigned)(seconds / 3600),
+                 (unsigned)(seconds / 60 % 60), (unsigned)(seconds % 60));
+        differences += !same("numFormatTime", got, expected, &shown);
+    }
+    check("numFormatTime as \"%02u:%02u:%02u\", over 99 h too", differences == 0);
+
+    differences = 0;
+    for(i = 0; i < 100000u; ++i){
+        time_t t = (time_t)(random32() % 4102444800u);      //Up to 2100
+        uint16_t ms = (uint16_t)(i % 3 == 0 ? 0 : random32() % 1000);
+        gmtime_r(&t, &timeInfo);
+        numFormatISO8601(got, sizeof(got), &timeInfo);
+        strftime(expected, sizeof(expected), "%Y-%m-%dT%H:%M:%SZ", &timeInfo);
+        differences += !same("numFormatISO8601", got, expected, &shown);
+        numFormatISO8601Ms(got, sizeof(got), &timeInfo, ms);
+        if(ms != 0){
+            snprintf(expected + 19, sizeof(expected) - 19, ".%03uZ", (unsigned)ms);
+        }
+        differences += !same("numFormatISO8601Ms", got, expected, &shown);
+    }
+    check("numFormatISO8601 and numFormatISO8601Ms as strftime and \".%03u\"", differences == 0);
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.tm_year = -1901;
+    check("numFormatISO8601: a year before 0 not printed",
+          numFormatISO8601(got, sizeof(got), &timeInfo) == 0 && got[0] == '\0' &&
+          numFormatISO8601(got, sizeof(got), NULL) == 0);
+
+    differences = 0;
+    for(i = 0; i < 200000u; ++i){
+        degrees = (float)((int32_t)(random32() % 360000001u) - 180000000) / 1e6f;
+        numFormatCoordinate(got, sizeof(got), degrees);
+        snprintf(expected, sizeof(expected), "%f", (double)degrees);
+        differences += !same("numFormatCoordinate", got, expected, &shown);
+    }
+    check("numFormatCoordinate as \"%f\"", differences == 0);
+}
+
+/*!
+    @brief      Output of a function in a buffer of a given size, the bytes after it untouched
+    @return     length returned, or -1 if a byte past the buffer was written
+*/
+static int32_t inBuffer(char* got, size_t size, size_t (*format)(char*, size_t, const void*), const void* arg){
+    char buf[BUF_LEN];
+    size_t len, i;
+
+    memset(buf, CANARY, sizeof(buf));
+    len = format(buf, size, arg);
+    for(i = size; i < sizeof(buf); ++i){
+        if(buf[i] != CANARY){
+            return -1;
+        }
+    }
+    strcpy(got, buf);
+    return (int32_t)len;
+}
+
+typedef struct{
+    float value;
+    uint8_t digits;
+} FloatArg_t;
+
+static size_t formatInt(char* buf, size_t size, const void* arg){
+    return numFormatInt(buf, size, *(const int32_t*)arg, 1);
+}
+
+static size_t formatFloat(char* buf, size_t size, const void* arg){
+    return numFormatFloat(buf, size, ((const FloatArg_t*)arg)->value, ((const FloatArg_t*)arg)->digits);
+}
+
+static size_t formatTime(char* buf, size_t size, const void* arg){
+    return numFormatTime(buf, size, *(const uint32_t*)arg);
+}
+
+static size_t formatISO8601Ms(char* buf, size_t size, const void* arg){
+    return numFormatISO8601Ms(buf, size, (const struct tm*)arg, 999);
+}
+
+/*!
+    @brief      The worst value of a caller in its buffer and in a buffer one byte shorter
+*/
+static void checkCaller(const char* name, size_t size, size_t (*format)(char*, size_t, const void*),
+                        const void* arg, const char* expected){
+    char got[BUF_LEN], line[96];
+    int32_t len = inBuffer(got, size, format, arg);
+    bool ok = len == (int32_t)strlen(expected) && strcmp(got, expected) == 0 && strlen(expected) < size;
+
+    //The same value does not fit in one byte less: empty string and 0
+    len = inBuffer(got, strlen(expected), format, arg);
+    ok &= len == 0 && got[0] == '\0';
+    snprintf(line, sizeof(line), "%s: \"%s\" in %u bytes", name, expected, (unsigned)size);
+    check(line, ok);
+}
+
+/*!
+    @brief      The buffers of the callers
+*/
+static void testBuffers(void){
+    static const int32_t minInt = INT32_MIN, gpsMs = 9999999;
+    static const uint32_t dayS = 99u * 3600u + 59u * 60u + 59u, tripS = 999u * 3600u + 59u * 60u + 59u;
+    static const FloatArg_t coordinate = {-179.999985f, 6}, field1 = {-2147483520.0f, 1},
+                            field2 = {-2147483520.0f, 2}, mspio = {-2147483520.0f, 6};
+    struct tm timeInfo = {59, 59, 23, 31, 11, 8099};        //9999-12-31T23:59:59
+
+    checkCaller("MSPIO.c PrintInteger", 12, formatInt, &minInt, "-2147483648");
+    checkCaller("GPS.c ms of a command", 8, formatInt, &gpsMs, "9999999");
+    checkCaller("rideStats.c, elevation.c, crash.c fields", 16, formatInt, &minInt, "-2147483648");
+    checkCaller("rideStats.c, elevation.c, crash.c, main.c fields", 16, formatFloat, &field2, "-2147483520.00");
+    checkCaller("bssFsm.c value, 1 digit", 16, formatFloat, &field1, "-2147483520.0");
+    checkCaller("MSPIO.c MSPrintf %f", 20, formatFloat, &mspio, "-2147483520.000000");
+    checkCaller("GPS.h, main.c, crash.c coordinates", NUMFORMAT_COORDINATE_LEN, formatFloat, &coordinate,
+                "-179.999985");
+    checkCaller("mainInterface.h time", NUMFORMAT_TIME_LEN, formatTime, &dayS, "99:59:59");
+    checkCaller("mainInterface.h tripTime", 10, formatTime, &tripS, "999:59:59");
+    checkCaller("GPS.c, rtc.c timestamps", NUMFORMAT_ISO8601_MS_LEN, formatISO8601Ms, &timeInfo,
+                "9999-12-31T23:59:59.999Z");
+}
+
+static uint64_t nowNs(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+//! Mean time of a call in ns, the values taken in turn from a table
+#define TIME_CALLS(result, calls, call)                                             \
+    do{                                                                             \
+        uint64_t start_ = nowNs();                                                  \
+        uint32_t n_;                                                                \
+        for(n_ = 0; n_ < (calls); ++n_){                                            \
+            call;                                                                   \
+        }                                                                           \
+        (result) = (nowNs() - start_) / (double)(calls);                            \
+    }while(0)
+
+/*!
+    @brief      Cost of snprintf and numFormat.c for the formats of the firmware
+*/
+static void benchmark(uint32_t calls){
+    static float values[256], coordinates[256];
+    static struct tm times[256];
+    char buf[BUF_LEN];
+    double printfNs, numNs;
+    uint32_t i;
+
+    for(i = 0; i < 256; ++i){
+        time_t t = (time_t)(1700000000u + random32() % 100000000u);
+        values[i] = (float)(random32() % 200000u) / 100.0f - 1000.0f;
+        coordinates[i] = (float)((int32_t)(random32() % 360000001u) - 180000000) / 1e6f;
+        gmtime_r(&t, &times[i]);
+    }
+    printf("%-20s %12s %12s\n", "format", "snprintf ns", "numFormat ns");
+    TIME_CALLS(printfNs, calls, snprintf(buf, sizeof(buf), "%.2f", (double)values[n_ & 255]));
+    TIME_CALLS(numNs, calls, numFormatFloat(buf, sizeof(buf), values[n_ & 255], 2));
+    printf("%-20s %12.1f %12.1f\n", "\"%.2f\"", printfNs, numNs);
+    TIME_CALLS(printfNs, calls, snprintf(buf, sizeof(buf), "%f", (double)coordinates[n_ & 255]));
+    TIME_CALLS(numNs, calls, numFormatCoordinate(buf, sizeof(buf), coordinates[n_ & 255]));
+    printf("%-20s %12.1f %12.1f\n", "\"%f\" coordinate", printfNs, numNs);
+    TIME_CALLS(printfNs, calls,
+               snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02dZ", times[n_ & 255].tm_year + 1900,
+                        times[n_ & 255].tm_mon + 1, times[n_ & 255].tm_mday, times[n_ & 255].tm_hour,
+                        times[n_ & 255].tm_min, times[n_ & 255].tm_sec));
+    TIME_CALLS(numNs, calls, numFormatISO8601(buf, sizeof(buf), &times[n_ & 255]));
+    printf("%-20s %12.1f %12.1f  (%u calls)\n", "ISO 8601", printfNs, numNs, (unsigned)calls);
+}
+
+int main(int argc, char* argv[]){
+    uint32_t calls = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000u;
+
+    testIntegers();
+    testFloat();
+    testFields();
+    testBuffers();
+    benchmark(calls > 0 ? calls : 1);
+    printf("%s\n", failures == 0 ? "all checks passed" : "some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
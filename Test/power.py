@@ -0,0 +1,377 @@
+"""Whole-ride simulation of the battery and of the power governor (see battery.h and power.h).
+
+A Li-ion cell is discharged second by second by a current model of the bike computer: MCU in active
+mode and in LPM0 at the MCLK of the mode, GPS, LCD and backlight, SD writes and syncs, MPU6050 and
+the PWM lights of lights.c in the classes of the ride. The MCU time is split into work bound to the
+CPU, longer with a slower MCLK, and work bound to SPI and I2C, on SMCLK that does not change. The
+voltage seen by the ADC is the open circuit voltage of the cell minus the drop on its internal
+resistance, with the lights on or off at the instant of the conversion, quantized as ADC_MEM4.
+The same filter and discharge curve of battery.c estimate the state of charge and the same table
+of power.c chooses the mode, then every ride is run again in NORMAL mode for the comparison.
+The governor must make the ride last longer, without oscillating between the modes, with the
+estimate of the state of charge close to the true one. The lights are never degraded: they are the
+safety of the rider, only their pattern follows the longer BSS window.
+The exit status is 1 if a check fails.
+
+Usage:
+    python3 Test/power.py                               # all the rides
+    python3 Test/power.py --capacity 2000               # smaller cell [mAh]
+    python3 Test/power.py --csv power.csv               # second by second trace of the rides
+    python3 Test/power.py --check-c build/test/powerHost  # same filter and governor in battery.c and power.c
+
+--check-c feeds the conversions and the loads of the governed rides to batteryAddSample and the
+state of charge to powerUpdate (Test/powerHost.c), and compares the table of the modes, the filtered
+voltage, the state of charge and the mode of every second with the model.
+"""
+
+import argparse
+import random
+import struct
+import subprocess
+import sys
+
+from lights import (PERIOD, LEVEL_MAX, TAIL_LEVEL, DAY_LEVEL, PULSE_LEVEL, STEP_MS, PATTERN_TICKS,
+                    duty_of, ambient_level)
+
+# battery.h
+VREF = 2.5
+DIVIDER = 2.0
+ADC_COUNTS = 16384
+PERIOD_MS = 1000
+FILTER_S = 30.0
+CURVE_V = [3.00, 3.45, 3.60, 3.68, 3.73, 3.77, 3.80, 3.84, 3.90, 3.97, 4.06, 4.20]
+CURVE_SOC = [0, 5, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100]
+
+# power.h and the table of power.c
+MIN_DWELL_MS = 60000
+NORMAL, SAVING, LOW, CRITICAL = range(4)
+# name, enter, exit, GPS fix [ms], UI [ms], backlight, BSS [ms], MCLK divider, SD sync [s], load [mA]
+MODES = [("NORMAL", 0, 0, 1000, 1000, True, 150, 1, 30, 44),
+         ("SAVING", 40, 45, 2000, 2000, False, 150, 2, 60, 26),
+         ("LOW", 20, 25, 5000, 5000, False, 300, 4, 120, 26),
+         ("CRITICAL", 8, 12, 10000, 30000, False, 300, 4, 300, 26)]
+
+# Cell
+CAPACITY_MAH = 2600.0           # 18650
+R_INTERNAL = 0.15               # [ohm]
+ADC_NOISE = 3.0                 # [LSB]
+
+# Current model [mA] and work [ms]
+MCU_ACTIVE_MA = (0.30, 0.090)   # constant, per MHz
+MCU_LPM0_MA = (0.35, 0.015)     # clocks on, CPU off
+GPS_MA = 20.0                   # L80 tracking, about the same at every fix rate
+GPS_CPU_MS = 3.0                # parse of the sentences of a fix at 48 MHz
+LOG_CPU_MS = 0.5                # a GPX point
+UI_CPU_MS, UI_IO_MS = 4.0, 18.0 # a refresh: pages and SPI transfer
+LCD_MA, LCD_REFRESH_MA = 0.8, 2.0
+BACKLIGHT_MA = 18.0
+BSS_CPU_MS, BSS_IO_MS = 1.2, 0.6    # a window: compute, classify, FIFO count
+SAMPLE_IO_MS = 0.3              # a MPU6050 sample on the I2C
+SAMPLES_PER_S = 1000.0 / 15     # MPU6050_SMPLRT_DIV 14
+MPU_MA = 3.9
+OTHER_CPU_MS = 1.0              # ADC, timers, wheel
+SD_IDLE_MA, SD_WRITE_MA = 0.3, 30.0
+SD_SECTOR_MS = 3.0
+POINT_BYTES = 180               # a GPX point
+SYNC_SECTORS, SYNC_BUSY_MS = 3, 10.0
+FRONT_MA, REAR_MA = 250.0, 60.0     # LEDs at full duty
+TAIL, DAY_FRONT, DAY_PULSES = TAIL_LEVEL, DAY_LEVEL, 2     # bssFsm.c: 0x05 behind, 0x01 ahead
+
+C_VOLTAGE_TOLERANCE = 1e-4      # V, the C filter runs in float
+
+
+def soc_from_voltage(v):
+    """Same of batterySocFromVoltage"""
+    if v <= CURVE_V[0]:
+        return 0
+    if v >= CURVE_V[-1]:
+        return 100
+    i = 1
+    while v > CURVE_V[i]:
+        i += 1
+    fraction = (v - CURVE_V[i - 1]) / (CURVE_V[i] - CURVE_V[i - 1])
+    return int(CURVE_SOC[i - 1] + fraction * (CURVE_SOC[i] - CURVE_SOC[i - 1]) + 0.5)
+
+
+def ocv(soc):
+    """Open circuit voltage of the cell, the inverse of the curve"""
+    soc = min(max(soc, 0.0), 100.0)
+    i = 1
+    while soc > CURVE_SOC[i]:
+        i += 1
+    fraction = (soc - CURVE_SOC[i - 1]) / float(CURVE_SOC[i] - CURVE_SOC[i - 1])
+    return CURVE_V[i - 1] + fraction * (CURVE_V[i] - CURVE_V[i - 1])
+
+
+class Battery:
+    """Same filter of battery.c"""
+
+    def __init__(self):
+        self.voltage = 0.0
+        self.valid = False
+
+    def add_sample(self, raw, load_ma):
+        v = raw * VREF * DIVIDER / ADC_COUNTS + R_INTERNAL * load_ma / 1000.0
+        if not self.valid:
+            self.voltage = v
+            self.valid = True
+        else:
+            self.voltage += PERIOD_MS / (1000.0 * FILTER_S) * (v - self.voltage)
+
+    def soc(self):
+        return soc_from_voltage(self.voltage) if self.valid else 100
+
+
+class Governor:
+    """Same of powerUpdate"""
+
+    def __init__(self):
+        self.mode = NORMAL
+        self.entered = 0
+
+    def update(self, soc, now_ms):
+        mode = self.mode
+        while mode + 1 < len(MODES) and soc < MODES[mode + 1][1]:
+            mode += 1
+        if mode == self.mode and mode != NORMAL and soc > MODES[mode][2] and now_ms - self.entered >= MIN_DWELL_MS:
+            mode -= 1
+        if mode == self.mode:
+            return False
+        self.mode = mode
+        self.entered = now_ms
+        return True
+
+
+def lights_duty(night, bss_ms):
+    """Average duty of the front and rear lights in the class of the ride, as BSS.c drives them"""
+    if night:
+        return duty_of(ambient_level(5.0, 30.0)) / float(PERIOD), duty_of(TAIL) / float(PERIOD)
+    pattern_ms = PATTERN_TICKS * bss_ms
+    front = duty_of(DAY_FRONT) / float(PERIOD) * bss_ms / pattern_ms
+    pulse = sum(duty_of(level) for level in PULSE_LEVEL) / float(PERIOD) * STEP_MS
+    rear = DAY_PULSES * pulse / pattern_ms
+    return front, rear
+
+
+def current(mode, night, riding):
+    """Average current of a second in a mode [mA] and the lights duty"""
+    _, _, _, fix_ms, ui_ms, backlight, bss_ms, divider, sync_s, _ = MODES[mode]
+    mhz = 48.0 / divider
+    fixes = 1000.0 / fix_ms
+    refreshes = min(fixes, 1000.0 / ui_ms)      # the GPS task requests the refresh
+    windows = 1000.0 / bss_ms
+    cpu = fixes * (GPS_CPU_MS + (LOG_CPU_MS if riding else 0)) + refreshes * UI_CPU_MS + windows * BSS_CPU_MS + OTHER_CPU_MS
+    io = refreshes * UI_IO_MS + windows * BSS_IO_MS + SAMPLES_PER_S * SAMPLE_IO_MS
+    active = min(1.0, (cpu * divider + io) / 1000.0)
+    mcu = (MCU_ACTIVE_MA[0] + MCU_ACTIVE_MA[1] * mhz) * active + (MCU_LPM0_MA[0] + MCU_LPM0_MA[1] * mhz) * (1 - active)
+    lcd = LCD_MA + LCD_REFRESH_MA * refreshes * UI_IO_MS / 1000.0 + (BACKLIGHT_MA if backlight else 0)
+    sd = SD_IDLE_MA
+    if riding:
+        sectors = fixes * POINT_BYTES / 512.0
+        sd += SD_WRITE_MA * (sectors * SD_SECTOR_MS + (SYNC_SECTORS * SD_SECTOR_MS + SYNC_BUSY_MS) / sync_s) / 1000.0
+    front, rear = lights_duty(night, bss_ms)
+    base = mcu + GPS_MA + lcd + sd + MPU_MA
+    return base, front, rear, {"mcu": mcu, "gps": GPS_MA, "lcd": lcd, "sd": sd, "mpu": MPU_MA,
+                               "lights": FRONT_MA * front + REAR_MA * rear}
+
+
+def run(ride, capacity, governed, rnd, trace=None, samples=None):
+    """Discharge until the cell is empty: hours, seconds per mode, mode changes, worst estimate error.
+    samples, if given, gets (ms, conversion, expected load, filtered voltage, state of charge) of
+    every second, for --check-c"""
+    battery = Battery()
+    governor = Governor()
+    charge = capacity * 3600.0          # [mA s]
+    seconds = [0] * len(MODES)
+    changes = ups = 0
+    worst = 0.0
+    t = 0
+    settled = 0                         # the estimate is checked after the filter has settled
+    while charge > 0:
+        night, riding, charging = ride(t)
+        mode = governor.mode if governed else NORMAL
+        base, front, rear, parts = current(mode, night, riding)
+        # The conversion catches the PWM of the lights on or off
+        instant = base + (FRONT_MA if rnd.random() < front else 0) + (REAR_MA if rnd.random() < rear else 0) - charging
+        true_soc = 100.0 * charge / (capacity * 3600.0)
+        v = ocv(true_soc) - R_INTERNAL * instant / 1000.0
+        raw = int(min(ADC_COUNTS - 1, max(0, v / DIVIDER / VREF * ADC_COUNTS + rnd.gauss(0, ADC_NOISE))))
+        # Expected load of batteryAddSample: the column of the table and the levels of the lights
+        load = MODES[mode][9] + FRONT_MA * front + REAR_MA * rear
+        battery.add_sample(raw, load)
+        if samples is not None:
+            samples.append((t * 1000, raw, load, battery.voltage, battery.soc()))
+        # A charger is not seen by the firmware: its current moves the voltage the other way
+        if charging:
+            settled = t + int(5 * FILTER_S)
+        if t > max(settled, 60):
+            worst = max(worst, abs(battery.soc() - true_soc))
+        if governed:
+            previous = governor.mode
+            if governor.update(battery.soc(), t * 1000):
+                changes += 1
+                ups += governor.mode < previous
+        average = base + FRONT_MA * front + REAR_MA * rear
+        charge = min(charge - average + charging, capacity * 3600.0)
+        seconds[mode] += 1
+        if trace is not None:
+            trace.append((t, MODES[mode][0], night, round(true_soc, 2), battery.soc(), round(battery.voltage, 4),
+                          round(average, 2)) + tuple(round(parts[k], 2) for k in ("mcu", "gps", "lcd", "sd", "mpu", "lights")))
+        t += 1
+        if v < CURVE_V[0]:
+            break
+    return t / 3600.0, seconds, changes, ups, worst
+
+
+def rides():
+    """(name, function of the second: night, riding, charger current [mA], changes back up expected)"""
+    day = lambda t: (False, True, 0)
+    night = lambda t: (True, True, 0)
+    # Day, then riding on into the night after 10 hours
+    evening = lambda t: (t >= 10 * 3600, True, 0)
+    # Day with a tunnel of 2 minutes every 10 minutes: the voltage drops and recovers with the lights
+    tunnels = lambda t: (t % 600 < 120, True, 0)
+    # Day, a stop of 90 minutes with a power bank at 1 A after 26 hours, the logging off
+    bank = lambda t: (False, not 26 * 3600 <= t < 27.5 * 3600, 1000.0 if 26 * 3600 <= t < 27.5 * 3600 else 0)
+    return (("day ride", day, 0), ("night ride", night, 0), ("into the night", evening, 0), ("tunnels", tunnels, 0),
+            ("power bank stop", bank, len(MODES) - 1))
+
+
+def soc_walk(rnd, steps=20000):
+    """(ms, state of charge) around the thresholds of the modes, with steps shorter and longer than
+    the dwell, for the hysteresis and the dwell of powerUpdate"""
+    walk = []
+    now = 0
+    soc = 50
+    for _ in range(steps):
+        now += rnd.choice((1000, 10000, 30000, MIN_DWELL_MS - 1000, MIN_DWELL_MS, 90000))
+        soc = min(100, max(0, soc + rnd.choice((-6, -3, -1, 0, 1, 2, 6))))
+        walk.append((now, soc))
+    return walk
+
+
+def f32(x):
+    """x rounded to a float of the C"""
+    return struct.unpack("f", struct.pack("f", x))[0]
+
+
+def soc_from_voltage_f32(v):
+    """batterySocFromVoltage in float, step by step as the C computes it"""
+    curve = [f32(c) for c in CURVE_V]
+    if v <= curve[0]:
+        return 0
+    if v >= curve[-1]:
+        return 100
+    i = 1
+    while v > curve[i]:
+        i += 1
+    fraction = f32(f32(v - curve[i - 1]) / f32(curve[i] - curve[i - 1]))
+    return int(f32(f32(CURVE_SOC[i - 1] + f32(fraction * (CURVE_SOC[i] - CURVE_SOC[i - 1]))) + 0.5))
+
+
+def check_c(binary, rides_samples, walk):
+    """Runs the conversions of the rides on battery.c and power.c (Test/powerHost.c), returns the
+    differences. The state of charge of the C is compared with the curve, in float, at the voltage of
+    the C and its mode with the governor of the model fed with the same state of charge: the float
+    filter of the C can put the voltage on the other side of a rounding."""
+    rows = []
+    for samples in rides_samples:
+        rows.append("ride\n")
+        rows += ["%d,%d,%.4f\n" % sample[:3] for sample in samples]
+    rows.append("ride\n")
+    rows += ["soc,%d,%d\n" % step for step in walk]
+    output = subprocess.run([binary], input="".join(rows), capture_output=True, text=True, check=True).stdout
+    results = [line.split(",") for line in output.splitlines()]
+    table = [tuple(r[1:2]) + tuple(int(v) for v in r[2:]) for r in results if r[0] == "mode"]
+    c_samples = [(float(r[1]), int(r[2]), int(r[3])) for r in results if r[0] == "sample"]
+    c_walk = [int(r[1]) for r in results if r[0] == "soc"]
+    errors = []
+    if table != [m[:5] + (int(m[5]),) + m[6:] for m in MODES]:
+        errors.append("table of the modes %s" % table)
+    expected = [sample for samples in rides_samples for sample in samples]
+    if len(c_samples) != len(expected):
+        errors.append("%d samples, %d expected" % (len(c_samples), len(expected)))
+    worst = 0.0
+    soc_differences = 0
+    n = 0
+    for samples in rides_samples:
+        governor = Governor()
+        for sample in samples:
+            if n >= len(c_samples):
+                break
+            voltage, soc, mode = c_samples[n]
+            governor.update(soc, sample[0])
+            worst = max(worst, abs(voltage - sample[3]))
+            soc_differences += soc != sample[4]
+            if abs(voltage - sample[3]) > C_VOLTAGE_TOLERANCE or soc != soc_from_voltage_f32(voltage) or \
+                    mode != governor.mode:
+                errors.append("sample %d: %.5f V %d%% %s, %.5f V %d%% %s expected" %
+                              (n, voltage, soc, MODES[mode][0], sample[3], sample[4], MODES[governor.mode][0]))
+            n += 1
+    governor = Governor()
+    modes = []
+    for now, soc in walk:
+        governor.update(soc, now)
+        modes.append(governor.mode)
+    if c_walk != modes:
+        errors.append("walk of the state of charge: %s" % next(("step %d: %s, %s expected" % (n, MODES[c][0], MODES[m][0])
+                                                                for n, (c, m) in enumerate(zip(c_walk, modes)) if c != m),
+                                                               "%d steps, %d expected" % (len(c_walk), len(modes))))
+    print("battery.c and power.c %d samples, max difference %.6f V, %d states of charge 1%% apart, %d mode changes "
+          "in the walk: %s" %
+          (len(c_samples), worst, soc_differences, sum(a != b for a, b in zip(modes, modes[1:])),
+           "same of the model" if not errors else "differs, " + "; ".join(errors[:3])))
+    return not errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Whole-ride simulation of the battery and of the power governor")
+    parser.add_argument("--capacity", type=float, default=CAPACITY_MAH, help="capacity of the cell [mAh]")
+    parser.add_argument("--csv", help="write the second by second trace of the governed rides")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--check-c", metavar="BINARY", help="compare with battery.c and power.c run by Test/powerHost.c")
+    args = parser.parse_args()
+
+    # The curve of battery.c and its inverse
+    ok = all(soc_from_voltage(v) == s for v, s in zip(CURVE_V, CURVE_SOC))
+    ok &= all(abs(soc_from_voltage(ocv(s)) - s) <= 1 for s in range(101))
+
+    print("%-20s %s" % ("mode", "  ".join("%8s" % m[0] for m in MODES)))
+    print("%-20s %s" % ("load [mA]", "  ".join("%8.1f" % current(m, False, True)[0] for m in range(len(MODES)))))
+    for night in (False, True):
+        print("%-20s %s" % ("current %s [mA]" % ("night" if night else "day"),
+                            "  ".join("%8.1f" % (current(m, night, True)[0] + FRONT_MA * current(m, night, True)[1] +
+                                                 REAR_MA * current(m, night, True)[2]) for m in range(len(MODES)))))
+
+    rows = []
+    rides_samples = []
+    for name, ride, expected_ups in rides():
+        trace = [] if args.csv else None
+        samples = [] if args.check_c else None
+        hours, seconds, changes, ups, worst = run(ride, args.capacity, True, random.Random(args.seed), trace, samples)
+        if samples is not None:
+            rides_samples.append(samples)
+        fixed, _, _, _, _ = run(ride, args.capacity, False, random.Random(args.seed))
+        # Down the table once, back up only where the battery is charged
+        result = (hours > fixed and ups <= expected_ups and changes <= len(MODES) - 1 + 2 * expected_ups and
+                  worst <= 5.0)
+        ok &= result
+        print("%-20s %5.1f h (%5.1f h in NORMAL, +%4.1f%%)  %s  changes %d (%d up)  SoC error %4.1f%%%s" %
+              (name, hours, fixed, 100.0 * (hours - fixed) / fixed,
+               " ".join("%s %4.1f h" % (MODES[m][0], seconds[m] / 3600.0) for m in range(len(MODES))),
+               changes, ups, worst, "" if result else "  <-- not as expected"))
+        if trace:
+            rows += [(name,) + row for row in trace]
+
+    if args.csv:
+        with open(args.csv, "w") as out:
+            out.write("ride,t_s,mode,night,soc,soc_estimate,voltage,current_ma,mcu_ma,gps_ma,lcd_ma,sd_ma,mpu_ma,lights_ma\n")
+            for row in rows:
+                out.write(",".join(str(x) for x in row) + "\n")
+    if args.check_c:
+        ok &= check_c(args.check_c, rides_samples, soc_walk(random.Random(args.seed)))
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
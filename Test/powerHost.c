@@ -0,0 +1,67 @@
+/*!
+    @file       powerHost.c
+    @brief      Battery filter of battery.c and governor of power.c on the PC, for the model of
+                Test/power.py
+    @details    Prints the table of the modes, then reads the conversions of the rides from the
+                standard input, as Test/power.py makes them: a row "ride" resets the battery filter
+                and the governor, then a row per second with the time, the conversion and the
+                expected load. Every conversion goes through batteryAddSample, then the state of
+                charge through powerUpdate, as the power task does. The program prints:
+                    mode,<name>,<enter>,<exit>,<GPS ms>,<UI ms>,<backlight>,<BSS ms>,<MCLK div>,<sync s>,<load mA>
+                    sample,<filtered voltage>,<state of charge>,<mode>
+                A row "soc,<ms>,<state of charge>" goes to powerUpdate alone, for the walks of the
+                state of charge around the thresholds, and prints:
+                    soc,<mode>
+                Test/power.py --check-c compares them with its model.
+
+                Usage:
+                    build/test/powerHost < conversions.csv
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local Includes */
+#include "battery.h"
+#include "power.h"
+
+#define LINE_LEN            64
+
+int main(void){
+    char line[LINE_LEN];
+    unsigned long ms;
+    unsigned raw, soc;
+    float loadMa;
+    uint32_t rows = 0;
+    uint8_t mode;
+
+    for(mode = 0; mode < POWER_MODE_COUNT; ++mode){
+        const PowerSettings_t* settings = powerGetSettings((PowerMode_t)mode);
+        printf("mode,%s,%u,%u,%u,%u,%d,%u,%u,%u,%u\n", settings->name, settings->socEnter, settings->socExit,
+               settings->gpsFixMs, settings->uiPeriodMs, settings->backlight, settings->bssPeriodMs,
+               settings->mclkDivider, settings->sdSyncS, settings->loadMa);
+    }
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        rows++;
+        if(strncmp(line, "ride", 4) == 0){
+            batteryReset();
+            powerInit();
+        }else if(sscanf(line, "%lu,%u,%f", &ms, &raw, &loadMa) == 3){
+            batteryAddSample((uint16_t)raw, loadMa);
+            powerUpdate(batteryGetSoc(), (uint32_t)ms);
+            printf("sample,%.9g,%u,%d\n", batteryGetVoltage(), batteryGetSoc(), (int)powerGetMode());
+        }else if(sscanf(line, "soc,%lu,%u", &ms, &soc) == 2){
+            powerUpdate((uint8_t)soc, (uint32_t)ms);
+            printf("soc,%d\n", (int)powerGetMode());
+        }else{
+            fprintf(stderr, "bad row %u: %s", (unsigned)rows, line);
+            return 1;
+        }
+    }
+    return 0;
+}
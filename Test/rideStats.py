@@ -0,0 +1,145 @@
+"""Reference implementation of the ride statistics of the bike computer (see rideStats.h).
+
+Computes from a GPX file the statistics that rideStats.c computes from the GPS epochs, with the
+same parameters, so the numbers of the device (or of the host build) can be checked. The altitudes
+go through the filter of elevation.c (see Test/elevation.py), as the device does before counting them.
+
+Usage:
+    python3 Test/rideStats.py Test/gpxTest.gpx
+    python3 Test/rideStats.py Test/gpxTest.gpx --max-gap 600
+    python3 Test/rideStats.py TEST1.GPX --check RIDES.CSV     # compare with the line of the ride index
+"""
+
+import argparse
+import csv
+import datetime
+import math
+import os
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+from elevation import ElevationFilter
+
+MOVING_SPEED = 3.0              # km/h
+MAX_GAP = 15.0                  # s
+ELEVATION_DEADBAND = 5.0        # m
+MASS = 85.0
+CRR = 0.005
+CDA = 0.5
+AIR_DENSITY = 1.2
+GRAVITY = 9.81
+EARTH_RADIUS = 6371000.0
+
+# Tolerances of the check: the device computes in single precision
+TOLERANCES = {"elapsed_s": 1, "moving_s": 1, "distance_m": 0.002, "avg_kmh": 0.002, "max_kmh": 0.002,
+              "ascent_m": 0.002, "descent_m": 0.002, "kcal": 0.005}
+
+
+def parse_time(text):
+    return datetime.datetime.fromisoformat(text.strip().replace("Z", "+00:00")).timestamp()
+
+
+def f32(value):
+    """Value rounded to single precision, as the device stores the coordinates."""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def read_points(path):
+    """List of (time [s], lat, lon, ele, vdop) of the track points, coordinates in single precision."""
+    points = []
+    for element in ET.parse(path).getroot().iter():
+        if not element.tag.endswith("trkpt"):
+            continue
+        fields = {child.tag.split("}")[-1]: child.text for child in element}
+        if "time" not in fields or "ele" not in fields:
+            continue
+        points.append((parse_time(fields["time"]), f32(float(element.get("lat"))), f32(float(element.get("lon"))),
+                       f32(float(fields["ele"])), float(fields["vdop"]) if fields.get("vdop") else None))
+    return points
+
+
+def ride_stats(points, max_gap=MAX_GAP):
+    """Statistics of the GPS epochs, same algorithm of rideStats.c without the wheel."""
+    stats = {"elapsed_s": 0.0, "moving_s": 0.0, "distance_m": 0.0, "max_kmh": 0.0, "ascent_m": 0.0,
+             "descent_m": 0.0, "work": 0.0}
+    if not points:
+        return stats
+    start = last = points[0][0]
+    previous = None
+    altitude_ref = None
+    elevation = ElevationFilter()
+    for time, lat, lon, ele, vdop in points:
+        ele = elevation.add_fix(time, ele, vdop, stats["distance_m"])
+        speed = 0.0
+        if previous is not None and time != previous[0]:
+            dy = math.radians(lat - previous[1])
+            dx = math.radians(lon - previous[2]) * math.cos(math.radians((lat + previous[1]) / 2))
+            distance = EARTH_RADIUS * math.hypot(dx, dy)
+            speed = distance * 3.6 / (time - previous[0])
+            if time - previous[0] <= max_gap and speed >= MOVING_SPEED:
+                v = speed / 3.6
+                stats["distance_m"] += distance
+                stats["work"] += (CRR * MASS * GRAVITY + 0.5 * AIR_DENSITY * CDA * v * v) * distance
+        previous = (time, lat, lon)
+        if altitude_ref is None:
+            altitude_ref = ele
+        elif ele - altitude_ref >= ELEVATION_DEADBAND:
+            stats["ascent_m"] += ele - altitude_ref
+            stats["work"] += MASS * GRAVITY * (ele - altitude_ref)
+            altitude_ref = ele
+        elif altitude_ref - ele >= ELEVATION_DEADBAND:
+            stats["descent_m"] += altitude_ref - ele
+            altitude_ref = ele
+        if time - last <= max_gap and speed >= MOVING_SPEED:
+            stats["moving_s"] += time - last
+        last = time
+        stats["elapsed_s"] = time - start
+        stats["max_kmh"] = max(stats["max_kmh"], speed)
+    stats["avg_kmh"] = stats["distance_m"] * 3.6 / stats["moving_s"] if stats["moving_s"] else 0.0
+    stats["kcal"] = stats["work"] / 1000
+    del stats["work"]
+    return stats
+
+
+def check(stats, index_path, name):
+    """Compare with the line of the ride in the index, returns the list of the mismatches."""
+    with open(index_path, newline="") as index:
+        rows = [row for row in csv.DictReader(index) if row["name"].upper() == name.upper()]
+    if not rows:
+        return ["%s not in %s" % (name, index_path)]
+    errors = []
+    # Consistency of the device line alone, whatever the reference says
+    row = {field: float(rows[-1][field]) for field in TOLERANCES}
+    if row["avg_kmh"] > row["max_kmh"]:
+        errors.append("device average %.3f km/h above its maximum %.3f" % (row["avg_kmh"], row["max_kmh"]))
+    if row["moving_s"] > row["elapsed_s"]:
+        errors.append("device moving time %.0f s above its elapsed time %.0f" % (row["moving_s"], row["elapsed_s"]))
+    for field, tolerance in TOLERANCES.items():
+        device = row[field]
+        reference = stats[field]
+        limit = tolerance if field.endswith("_s") else max(tolerance * abs(reference), 0.1)
+        if abs(device - reference) > limit:
+            errors.append("%s: device %.3f, reference %.3f" % (field, device, reference))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reference ride statistics of a GPX file")
+    parser.add_argument("gpx")
+    parser.add_argument("--max-gap", type=float, default=MAX_GAP, help="longest gap counted as moving [s]")
+    parser.add_argument("--check", metavar="RIDES.CSV", help="ride index of the device to verify")
+    args = parser.parse_args()
+
+    stats = ride_stats(read_points(args.gpx), args.max_gap)
+    for field, value in stats.items():
+        print("%-11s %12.3f" % (field, value))
+    if args.check:
+        errors = check(stats, args.check, os.path.basename(args.gpx))
+        for error in errors:
+            print(error, file=sys.stderr)
+        sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
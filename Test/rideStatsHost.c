@@ -0,0 +1,150 @@
+/*!
+    @file       rideStatsHost.c
+    @brief      Ride statistics of rideStats.c and elevation.c on the track points of a GPX file
+    @details    Every track point with a time and an altitude is given to the modules as the logging
+                task does with a GPS fix: the altitude filtered by elevationAddFix on the distance up
+                to the previous fix, then rideStatsAddFix. The times are the ones of the points from
+                the first, in ms. At the end the line of the ride index is written with its header, as
+                in RIDES.CSV on the SD, so Test/rideStats.py --check compares it with the reference.
+
+                Usage:
+                    build/test/rideStatsHost Test/gpxTest.gpx build/test/RIDES.CSV
+                    python3 Test/rideStats.py Test/gpxTest.gpx --check build/test/RIDES.CSV
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#define _DEFAULT_SOURCE             //timegm
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Local Includes */
+#include "rideStats.h"
+#include "elevation.h"
+
+#define LINE_LEN    256
+
+//! A track point, the fields found so far
+typedef struct{
+    float latitude;
+    float longitude;
+    float altitude;
+    float vdop;                     //!< 0 if the point has none, as atof of an empty field
+    double time;                    //!< [s]
+    bool hasAltitude;
+    bool hasTime;
+} Point_t;
+
+/*!
+    @brief      Text of an element on a line, as "<ele>1859.27</ele>"
+    @return     pointer to the text, NULL if the element is not on the line
+*/
+static const char* elementText(const char* line, const char* tag){
+    const char* p = strstr(line, tag);
+    return p != NULL ? p + strlen(tag) : NULL;
+}
+
+/*!
+    @brief      ISO 8601 time of the GPX, with or without the fraction of second
+*/
+static bool parseTime(const char* text, double* time){
+    struct tm tm;
+    double seconds;
+
+    memset(&tm, 0, sizeof(tm));
+    if(sscanf(text, "%d-%d-%dT%d:%d:%lf", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+              &seconds) != 6){
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_sec = (int)seconds;
+    *time = (double)timegm(&tm) + (seconds - tm.tm_sec);
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    char line[LINE_LEN], summary[RIDESTATS_SUMMARY_LEN], start[32];
+    const char* name;
+    const char* text;
+    FILE* gpx;
+    FILE* index;
+    Point_t point;
+    RideTotals_t totals;
+    double firstTime = 0;
+    uint32_t points = 0, nowMs = 0;
+    bool inPoint = false;
+
+    if(argc != 3){
+        fprintf(stderr, "usage: %s file.gpx RIDES.CSV\n", argv[0]);
+        return 2;
+    }
+    gpx = fopen(argv[1], "r");
+    if(gpx == NULL){
+        perror(argv[1]);
+        return 1;
+    }
+    name = strrchr(argv[1], '/') != NULL ? strrchr(argv[1], '/') + 1 : argv[1];
+    start[0] = '\0';
+
+    rideStatsStart(0);
+    elevationStart();
+    while(fgets(line, sizeof(line), gpx) != NULL){
+        if((text = elementText(line, "<trkpt lat=\"")) != NULL){
+            memset(&point, 0, sizeof(point));
+            point.latitude = strtof(text, NULL);
+            text = elementText(line, "lon=\"");
+            point.longitude = text != NULL ? strtof(text, NULL) : 0;
+            inPoint = true;
+        }else if(!inPoint){
+            continue;
+        }else if((text = elementText(line, "<ele>")) != NULL){
+            point.altitude = strtof(text, NULL);
+            point.hasAltitude = true;
+        }else if((text = elementText(line, "<vdop>")) != NULL){
+            point.vdop = strtof(text, NULL);
+        }else if((text = elementText(line, "<time>")) != NULL){
+            point.hasTime = parseTime(text, &point.time);
+            if(points == 0 && point.hasTime){
+                snprintf(start, sizeof(start), "%.19s", text);
+            }
+        }else if(strstr(line, "</trkpt>") != NULL){
+            inPoint = false;
+            if(!point.hasAltitude || !point.hasTime){
+                continue;
+            }
+            if(points++ == 0){
+                firstTime = point.time;
+            }
+            nowMs = (uint32_t)((point.time - firstTime) * 1000.0 + 0.5);
+            //Same calls of the logging task at a fix
+            rideStatsGetTotals(&totals);
+            float altitude = elevationAddFix(nowMs, point.altitude, point.vdop, totals.distance);
+            rideStatsAddFix(nowMs, point.latitude, point.longitude, altitude);
+        }
+    }
+    fclose(gpx);
+    rideStatsStop(nowMs);
+    elevationFinish();
+
+    if(rideStatsFormatSummary(summary, sizeof(summary), name, start) == 0){
+        fprintf(stderr, "summary longer than %u characters\n", (unsigned)sizeof(summary));
+        return 1;
+    }
+    index = fopen(argv[2], "w");
+    if(index == NULL){
+        perror(argv[2]);
+        return 1;
+    }
+    fputs(RIDESTATS_INDEX_HEADER, index);
+    fputs(summary, index);
+    fclose(index);
+    printf("%u points: %s", (unsigned)points, summary);
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*!
+    @file       ringBufferStress.c
+    @brief      Stress test of the SPSC ring of Hardware/RingBuffer.c with two threads
+    @details    A producer thread and a consumer thread run on the same ring as the ISR and the main
+                loop do, on different cores of the PC, so a missing barrier or a wrong index shows up
+                as a byte lost, duplicated or out of order. The producer writes a known sequence with
+                Put and Write of random sizes, the bytes refused because the ring is full are skipped
+                and counted, then it waits for the consumer to free some room; the consumer reads with
+                Get and Read of random sizes and checks that it gets exactly the accepted bytes, in
+                order. Every ring size is run with the indices starting just before the 32 bit wrap,
+                and the overflow counter must match the bytes refused.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/ringBufferStress [most bytes of a run, default 2000000]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+/* Local Includes */
+#include "Hardware/RingBuffer.h"
+
+#define MAX_RING_SIZE       1024
+#define MAX_CHUNK           48
+
+//! Shared state of a run
+typedef struct{
+    RINGBUFFER_t ring;
+    uint8_t storage[MAX_RING_SIZE];
+    uint32_t total;                         //!< Bytes of the sequence offered by the producer
+    volatile uint32_t accepted;             //!< Bytes accepted by the ring, final when done is set
+    volatile bool done;                     //!< The producer has finished
+    uint32_t refused;                       //!< Bytes refused because the ring was full
+    uint32_t errors;                        //!< Bytes received wrong by the consumer
+    uint32_t received;                      //!< Bytes received by the consumer
+} Run_t;
+
+/*!
+    @brief      Byte n of the sequence: a hash, so a byte in the wrong place does not match by chance
+*/
+static uint8_t sequenceByte(uint32_t n){
+    n ^= n >> 13;
+    n *= 0x5bd1e995u;
+    n ^= n >> 15;
+    return (uint8_t)n;
+}
+
+/*!
+    @brief      Give the core to the other thread, sched_yield does not always do it on one core
+*/
+static void waitOther(void){
+    struct timespec pause = {0, 1000};
+    nanosleep(&pause, NULL);
+}
+
+/*!
+    @brief      Small pseudo random generator, one per thread
+*/
+static uint32_t nextRandom(uint32_t* state){
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void* producer(void* arg){
+    Run_t* run = (Run_t*)arg;
+    uint8_t chunk[MAX_CHUNK];
+    uint32_t random = 1;
+    uint32_t n = 0, accepted = 0;
+    uint32_t size, written, i;
+
+    while(n < run->total){
+        size = 1 + nextRandom(&random) % MAX_CHUNK;
+        if(size > run->total - n){
+            size = run->total - n;
+        }
+        //The accepted bytes are the sequence without the refused ones: the consumer follows them
+        if(size == 1 || nextRandom(&random) % 2 == 0){
+            for(i = 0; i < size; ++i){
+                if(RINGBUFFER_Put(&run->ring, sequenceByte(accepted))){
+                    ++accepted;
+                }else{
+                    run->refused++;
+                }
+            }
+        }else{
+            for(i = 0; i < size; ++i){
+                chunk[i] = sequenceByte(accepted + i);
+            }
+            written = RINGBUFFER_Write(&run->ring, chunk, size);
+            accepted += written;
+            run->refused += size - written;
+        }
+        n += size;
+        //Full: wait for the consumer, the refused bytes have exercised the overflow path
+        while(RINGBUFFER_Free(&run->ring) == 0){
+            waitOther();
+        }
+    }
+    run->accepted = accepted;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    run->done = true;
+    return NULL;
+}
+
+static void* consumer(void* arg){
+    Run_t* run = (Run_t*)arg;
+    uint8_t chunk[MAX_CHUNK];
+    uint32_t random = 7;
+    uint32_t size, read, i;
+    uint8_t byte;
+    bool done;
+
+    while(1){
+        done = run->done;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if(nextRandom(&random) % 2 == 0){
+            read = RINGBUFFER_Get(&run->ring, &byte) ? 1 : 0;
+            chunk[0] = byte;
+        }else{
+            size = 1 + nextRandom(&random) % MAX_CHUNK;
+            read = RINGBUFFER_Read(&run->ring, chunk, size);
+        }
+        for(i = 0; i < read; ++i){
+            if(chunk[i] != sequenceByte(run->received)){
+                run->errors++;
+            }
+            run->received++;
+        }
+        //Empty after the end of the producer: nothing more will come
+        if(done && read == 0 && RINGBUFFER_Count(&run->ring) == 0){
+            break;
+        }
+        if(read == 0){
+            waitOther();
+        }
+    }
+    return NULL;
+}
+
+/*!
+    @brief      One run on a ring of a size, the indices start before the wrap
+    @return     true if the consumer got the accepted bytes in order and the counters match
+*/
+static bool stressRun(uint32_t ringSize, uint32_t total){
+    static Run_t run;
+    pthread_t producerThread, consumerThread;
+    bool ok;
+
+    run = (Run_t){0};
+    run.total = total;
+    RINGBUFFER_Init(&run.ring, run.storage, ringSize);
+    run.ring.Head = run.ring.Tail = 0u - 3u * ringSize;
+
+    pthread_create(&consumerThread, NULL, consumer, &run);
+    pthread_create(&producerThread, NULL, producer, &run);
+    pthread_join(producerThread, NULL);
+    pthread_join(consumerThread, NULL);
+
+    ok = run.errors == 0 && run.received == run.accepted && run.accepted + run.refused == total &&
+         RINGBUFFER_Overflows(&run.ring) == run.refused;
+    printf("ring %4u: %u bytes, %u received, %u refused, %u overflows, %u errors%s\n", (unsigned)ringSize,
+           (unsigned)total, (unsigned)run.received, (unsigned)run.refused,
+           (unsigned)RINGBUFFER_Overflows(&run.ring), (unsigned)run.errors, ok ? "" : "  <-- FAIL");
+    return ok;
+}
+
+int main(int argc, char* argv[]){
+    static const uint32_t sizes[] = {1, 2, 16, 128, 1024};
+    uint32_t total = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000000u;
+    bool ok = true;
+    uint8_t i;
+
+    //The small rings hand over the core at every few bytes: the same number of fills for all
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i){
+        ok &= stressRun(sizes[i], total < sizes[i] * 4000u ? total : sizes[i] * 4000u);
+    }
+    return ok ? 0 : 1;
+}
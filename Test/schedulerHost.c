@@ -0,0 +1,225 @@
+/*!
+    @file       schedulerHost.c
+    @brief      Test of the core of scheduler.c on the PC
+    @details    The scheduler is built with SIMULATE_HARDWARE: the time is the host clock and LPM0 is
+                a pause of SCHED_SIM_IDLE_US. The test checks:
+                    - the events posted together run their tasks in the order of the table, and an
+                      event posted by a task runs before the lower priority ones still pending;
+                    - the latency from the first post of an event, repeated posts included, and the
+                      run time of the tasks;
+                    - the deadline misses, counted only for the latencies over the deadline;
+                    - the sleep and elapsed times of schedGetStats and schedGetTotals, with
+                      schedRun left from a task with longjmp; the totals are kept by
+                      schedResetStats and schedSetClockDivider.
+                The delays are made with nanosleep: the checks have a margin for a loaded host but
+                never accept a time shorter than the delay.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/schedulerHost
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <time.h>
+
+/* Local Includes */
+#include "scheduler.h"
+
+#define EVENT_HIGH          (1u << 0)
+#define EVENT_MID           (1u << 1)
+#define EVENT_LOW           (1u << 2)
+#define EVENT_STOP          (1u << 3)
+#define DELAY_US            20000u      //!< Delay used for the latencies and the run times
+#define DEADLINE_US         10000u
+#define MARGIN_US           200000u     //!< Max time over the expected one on a loaded host
+#define IDLE_PAUSES         50u         //!< Pauses of schedRun before the stop event
+
+static uint32_t failures;
+static uint8_t order[16];
+static uint8_t orderLen;
+static uint32_t idlePauses;
+static jmp_buf leaveRun;
+
+static void check(const char* name, bool ok){
+    printf("%-66s %s\n", name, ok ? "ok" : "FAIL");
+    if(!ok){
+        failures++;
+    }
+}
+
+static void delayUs(uint32_t us){
+    struct timespec pause = {us / 1000000u, (long)(us % 1000000u) * 1000L};
+    nanosleep(&pause, NULL);
+}
+
+static uint64_t nowUs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+static void record(uint8_t task){
+    if(orderLen < sizeof(order)){
+        order[orderLen++] = task;
+    }
+}
+
+static void highTask(SchedEvents_t events){
+    (void)events;
+    record(0);
+}
+
+//! Posts the high priority event the first time it runs
+static void midTask(SchedEvents_t events){
+    (void)events;
+    record(1);
+    if(orderLen == 2){
+        schedPostEvent(EVENT_HIGH);
+    }
+}
+
+static void lowTask(SchedEvents_t events){
+    (void)events;
+    record(2);
+    delayUs(DELAY_US);
+}
+
+static void stopTask(SchedEvents_t events){
+    (void)events;
+    longjmp(leaveRun, 1);
+}
+
+static const SchedTask_t tasks[] = {
+    {"high", EVENT_HIGH, highTask, DEADLINE_US},
+    {"mid", EVENT_MID, midTask, 0},
+    {"low", EVENT_LOW, lowTask, DEADLINE_US},
+    {"stop", EVENT_STOP, stopTask, 0},
+};
+
+//! Interrupts of the simulator: the stop event after some pauses
+static void idleHook(void){
+    if(++idlePauses == IDLE_PAUSES){
+        schedPostEvent(EVENT_STOP);
+    }
+}
+
+static bool between(uint32_t value, uint32_t min){
+    return value >= min && value < min + MARGIN_US;
+}
+
+/*!
+    @brief      Order of the tasks for events posted together
+*/
+static void testPriority(void){
+    schedInit(tasks, sizeof(tasks) / sizeof(tasks[0]));
+    orderLen = 0;
+    schedPostEvent(EVENT_LOW);
+    schedPostEvent(EVENT_MID | EVENT_HIGH);
+    while(schedRunOnce()){
+    }
+    check("events posted together run by priority",
+          orderLen == 4 && order[0] == 0 && order[1] == 1 && order[2] == 0 && order[3] == 2);
+    check("an event posted by a task runs before the lower ones pending", order[2] == 0);
+    check("no task ready after all the events", !schedRunOnce());
+}
+
+/*!
+    @brief      Latency, run time and deadline misses
+*/
+static void testLatency(void){
+    SchedTaskStats_t high, low;
+
+    schedInit(tasks, sizeof(tasks) / sizeof(tasks[0]));
+    orderLen = 0;
+    schedPostEvent(EVENT_HIGH);
+    schedRunOnce();
+    schedGetTaskStats(0, &high);
+    check("no deadline miss for an event run at once", high.runs == 1 && high.deadlineMisses == 0);
+
+    //The latency is counted from the first post, not from the repeated one
+    schedPostEvent(EVENT_HIGH);
+    delayUs(DELAY_US / 2);
+    schedPostEvent(EVENT_HIGH);
+    delayUs(DELAY_US / 2);
+    schedRunOnce();
+    schedGetTaskStats(0, &high);
+    check("latency from the first of the repeated posts", between(high.maxLatencyUs, DELAY_US));
+    check("deadline miss for a latency over the deadline", high.runs == 2 && high.deadlineMisses == 1);
+
+    //A long task delays the next one: the run time of the first, the latency of the second
+    schedPostEvent(EVENT_LOW | EVENT_HIGH);
+    schedRunOnce();
+    schedRunOnce();
+    schedGetTaskStats(2, &low);
+    check("run time of the task", low.runs == 1 && between(low.maxRunUs, DELAY_US) && low.totalRunMs >= DELAY_US / 1000u);
+    check("latency of a task behind a higher one", low.maxLatencyUs < DEADLINE_US && low.deadlineMisses == 0);
+    schedPostEvent(EVENT_LOW);
+    schedPostEvent(EVENT_HIGH);
+    schedRunOnce();
+    delayUs(DELAY_US);
+    schedRunOnce();
+    schedGetTaskStats(2, &low);
+    check("deadline miss of the low task after a delay", low.runs == 2 && low.deadlineMisses == 1);
+    schedGetTaskStats(0, &high);
+    check("the high task not charged for the delay", high.runs == 4 && high.deadlineMisses == 1);
+    check("statistics of a task out of the table", !schedGetTaskStats(sizeof(tasks) / sizeof(tasks[0]), &low));
+
+    schedResetStats();
+    schedGetTaskStats(0, &high);
+    check("statistics cleared by schedResetStats", high.runs == 0 && high.maxLatencyUs == 0 && high.deadlineMisses == 0);
+}
+
+/*!
+    @brief      Sleep and elapsed times of schedRun
+*/
+static void testTotals(void){
+    SchedStats_t stats;
+    uint64_t elapsed0, sleep0, elapsed1, sleep1, elapsed2, sleep2, start, wall;
+    uint32_t permille;
+
+    schedInit(tasks, sizeof(tasks) / sizeof(tasks[0]));
+    schedSetIdleHook(idleHook);
+    schedGetTotals(&elapsed0, &sleep0);
+    start = nowUs();
+    idlePauses = 0;
+    schedPostEvent(EVENT_LOW);
+    if(setjmp(leaveRun) == 0){
+        schedRun();
+    }
+    wall = nowUs() - start;
+    schedSetIdleHook(NULL);
+
+    schedGetStats(&stats);
+    schedGetTotals(&elapsed1, &sleep1);
+    check("schedRun paused until the stop event", idlePauses == IDLE_PAUSES && stats.wakeups == IDLE_PAUSES);
+    check("sleep time at least the pauses",
+          sleep1 - sleep0 >= (uint64_t)IDLE_PAUSES * SCHED_SIM_IDLE_US && stats.sleepMs >= IDLE_PAUSES * SCHED_SIM_IDLE_US / 1000u);
+    check("elapsed time as the wall clock", elapsed1 - elapsed0 + 1 >= wall && elapsed1 - elapsed0 < wall + MARGIN_US);
+    check("active time at least the run of the task", (elapsed1 - elapsed0) - (sleep1 - sleep0) >= DELAY_US);
+    permille = (uint32_t)((sleep1 - sleep0) * 1000u / (elapsed1 - elapsed0));
+    check("sleep permille of the statistics as the totals",
+          stats.sleepPermille > 0 && stats.sleepPermille < 1000 && stats.sleepPermille + 1 >= permille &&
+          stats.sleepPermille <= permille + 1);
+
+    schedResetStats();
+    schedSetClockDivider(2);
+    schedGetStats(&stats);
+    schedGetTotals(&elapsed2, &sleep2);
+    check("totals kept by schedResetStats and schedSetClockDivider",
+          sleep2 == sleep1 && elapsed2 >= elapsed1 && elapsed2 - elapsed1 < MARGIN_US);
+    check("statistics cleared", stats.sleepMs == 0 && stats.wakeups == 0 && stats.elapsedMs < MARGIN_US / 1000u);
+}
+
+int main(void){
+    testPriority();
+    testLatency();
+    testTotals();
+    printf("%s\n", failures == 0 ? "all checks passed" : "some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
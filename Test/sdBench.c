@@ -0,0 +1,160 @@
+/*!
+    @file       sdBench.c
+    @brief      Benchmark of the sector transfers of fatfs/mmc_MSP432P401r.c, polled and by uDMA
+    @details    The MMC layer runs unchanged on the fake driverlib of Test/fake with the card model of
+                Test/sdCard.c on EUSCI_B0, as on the board. The card is initialized as at the boot (the
+                clock is raised to the TRAN_SPEED of the CSD), then sectors are written and read with
+                single and multiple block commands at some clocks of the bus, with the polled path and
+                with xchg_spi_dma. The time is the one of the bus: the bytes at the SPI clock, the CPU
+                cost of the polled bytes and of the setup of the uDMA (fakeDriverlib.h), the access and
+                programming times of the card (sdCard.h); the sectors per second are printed.
+                Every sector read must be the one written, and the uDMA path must really be used.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/sdBench [sectors of every measure, default 256]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local Includes */
+#include "fatfs/mmc_MSP432P401r.h"
+#include "fake/fakeDriverlib.h"
+#include "sdCard.h"
+
+#define CARD_SECTORS        8192        //!< 4 MB card
+#define SMCLK_HZ            48000000
+#define MULTIPLE_SECTORS    8           //!< Sectors of a multiple block command, a cluster
+
+//! SD profile of SD_Driver.c, the driver is not linked: it needs the software timers
+static const eUSCI_SPI_MasterConfig sdConfig = {
+     EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
+     3000000,
+     SD_INIT_SPI_CLOCK,
+     EUSCI_B_SPI_MSB_FIRST,
+     EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT,
+     EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH,
+     EUSCI_B_SPI_3PIN
+};
+
+SPI_Device_t SD_SPIDevice;
+
+static uint8_t buffer[MULTIPLE_SECTORS * 512];
+static uint32_t failures;
+
+/*!
+    @brief      Byte n of a sector in a round, so a sector of another round does not match
+*/
+static uint8_t sectorByte(uint32_t round, uint32_t sector, uint32_t n){
+    uint32_t x = (sector * 512u + n) * 2654435761u + round * 97u;
+    return (uint8_t)(x >> 24);
+}
+
+static void fill(uint32_t round, uint32_t sector, uint32_t count){
+    uint32_t i;
+    for(i = 0; i < count * 512u; ++i){
+        buffer[i] = sectorByte(round, sector + i / 512u, i % 512u);
+    }
+}
+
+static bool same(uint32_t round, uint32_t sector, uint32_t count){
+    uint32_t i;
+    for(i = 0; i < count * 512u; ++i){
+        if(buffer[i] != sectorByte(round, sector + i / 512u, i % 512u)){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    @brief      Write or read some sectors in commands of a size
+    @return     sectors per second of the bus, 0 if a transfer fails or a sector read is wrong
+*/
+static double measure(bool write, uint32_t count, uint32_t sectors, uint32_t round){
+    uint64_t start = fakeNowNs();
+    uint32_t sector;
+    bool ok = true;
+
+    for(sector = 0; sector < sectors && ok; sector += count){
+        if(write){
+            fill(round, sector, count);
+            ok = MMC_disk_write(buffer, sector, count) == RES_OK;
+        }else{
+            memset(buffer, 0, count * 512u);
+            ok = MMC_disk_read(buffer, sector, count) == RES_OK && same(round, sector, count);
+        }
+    }
+    return ok ? sectors * 1e9 / (double)(fakeNowNs() - start) : 0.0;
+}
+
+int main(int argc, char* argv[]){
+    static const uint32_t clocks[] = {SD_INIT_SPI_CLOCK, 4000000, SD_MAX_SPI_CLOCK};
+    uint32_t sectors = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 256u;
+    uint32_t round = 0, i, dma, dmaBytes;
+    double result[4];
+    SdCardStats_t stats;
+
+    sectors = (sectors + MULTIPLE_SECTORS - 1) / MULTIPLE_SECTORS * MULTIPLE_SECTORS;
+    if(sectors == 0 || sectors > CARD_SECTORS){
+        fprintf(stderr, "sectors from 1 to %u\n", (unsigned)CARD_SECTORS);
+        return 2;
+    }
+
+    //Same start of main(): bus, SD profile, uDMA, then the mount initializes the card
+    fakeReset(SMCLK_HZ);
+    if(!sdCardInit(MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN, CARD_SECTORS)){
+        return 1;
+    }
+    fakeSetSPIDevice(EUSCI_B0_BASE, sdCardExchange);
+    fakeSetTick(disk_timerproc, 10000);
+    SPI_InitDevice(&SD_SPIDevice, EUSCI_B0_BASE, &sdConfig, MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN, false);
+    if(MMC_disk_initialize() != 0){
+        printf("the card was not initialized\n");
+        return 1;
+    }
+    printf("card initialized in %.1f ms, SPI clock raised to %u Hz\n", fakeNowNs() / 1e6,
+           (unsigned)fakeSPI(EUSCI_B0_BASE)->clock);
+    if(fakeSPI(EUSCI_B0_BASE)->clock != SD_MAX_SPI_CLOCK){
+        failures++;
+    }
+
+    printf("%u sectors, sectors/s on the bus (SMCLK %u MHz)\n", (unsigned)sectors, (unsigned)(SMCLK_HZ / 1000000));
+    printf("%10s %7s %10s %10s %10s %10s\n", "clock", "path", "write 1", "write 8", "read 1", "read 8");
+    for(i = 0; i < sizeof(clocks) / sizeof(clocks[0]); ++i){
+        SPI_SetDeviceClock(&SD_SPIDevice, clocks[i]);
+        for(dma = 0; dma < 2; ++dma){
+            MMC_use_dma(dma != 0);
+            dmaBytes = fakeSPI(EUSCI_B0_BASE)->dmaBytes;
+            result[0] = measure(true, 1, sectors, ++round);
+            result[2] = measure(false, 1, sectors, round);
+            result[1] = measure(true, MULTIPLE_SECTORS, sectors, ++round);
+            result[3] = measure(false, MULTIPLE_SECTORS, sectors, round);
+            printf("%10u %7s %10.0f %10.0f %10.0f %10.0f", (unsigned)fakeSPI(EUSCI_B0_BASE)->clock,
+                   dma ? "uDMA" : "polled", result[0], result[1], result[2], result[3]);
+            //The sectors of the uDMA: 4 measures of the data blocks, nothing on the polled path
+            if(result[0] == 0 || result[1] == 0 || result[2] == 0 || result[3] == 0 ||
+               fakeSPI(EUSCI_B0_BASE)->dmaBytes - dmaBytes != (dma ? 4u * sectors * 512u : 0u)){
+                printf("  <-- FAIL");
+                failures++;
+            }
+            printf("\n");
+        }
+    }
+
+    sdCardStats(&stats);
+    printf("card: %u commands, %u blocks read, %u written, %u errors\n", (unsigned)stats.commands,
+           (unsigned)stats.blocksRead, (unsigned)stats.blocksWritten, (unsigned)stats.errors);
+    if(stats.errors != 0){
+        failures++;
+    }
+    sdCardFree();
+    return failures == 0 ? 0 : 1;
+}
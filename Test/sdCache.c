@@ -0,0 +1,171 @@
+/*!
+    @file       sdCache.c
+    @brief      Card operations of an hour of ride with the write-back cache of fatfs/diskio.c
+    @details    A ride is written on a FAT32 image of a 4 GB card (IMG_disk_open, the SD card of diskio.c
+                on the host) as startRide and the GPS task do: the file is created, a contiguous area for
+                the ride looked for with f_expand, a GPX point written at every fix with f_sync at the
+                period of the power mode, and at the end the file is trimmed and closed. The accesses
+                of the card are counted by the image drive with the cost model of a microSD on SPI,
+                for the cases of the cache: without f_expand, with the area allocated (opt 1) and only
+                set as the start of the next allocations (opt 0, as GPXInitFile), without syncs and
+                with the syncs of the modes.
+                The cache is built in with MMC_CACHE_SECTORS: the Makefile builds the test with the
+                cache and without it (sdCache0). With --writes the program prints only the writes
+                of an hour without syncs, with --baseline it checks the writes of the same case
+                against the ones of a build without the cache: every write must carry on average
+                nearly MMC_CACHE_SECTORS sectors.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/sdCache [--writes | --baseline WRITES] [image, default build/test/sdCache.img]
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local Includes */
+#include "fatfs/ff.h"
+#include "fatfs/sim_disk.h"
+
+#ifndef MMC_CACHE_SECTORS
+#define MMC_CACHE_SECTORS   4       //!< Same default of diskio.c
+#endif
+
+#define IMAGE_SECTORS       (8UL * 1024 * 1024)     //!< 4 GB, sparse on the PC
+#define CLUSTER_SIZE        32768                   //!< Allocation unit of a 4 GB SDHC card
+#define PREALLOC_SIZE       (2UL * 1024 * 1024)     //!< GPX_PREALLOC_SIZE of GPX.h
+#define RIDE_S              3600
+#define EXPAND_NONE         2                       //!< No f_expand, the file grows by clusters
+#define CACHE_TOLERANCE     0.95                    //!< Fraction of MMC_CACHE_SECTORS per write
+
+extern const char* GPX_TRACK_POINT;
+
+//! A case: reservation of the area and period of the fixes and of the syncs
+typedef struct{
+    const char* name;
+    uint8_t expand;                 //!< Option of f_expand or EXPAND_NONE
+    uint32_t fixS;
+    uint32_t syncS;                 //!< 0 no sync until the close
+} Case_t;
+
+static const Case_t cases[] = {
+    {"no f_expand, no sync",            EXPAND_NONE,    1,  0},
+    {"f_expand opt 1, no sync",         1,              1,  0},
+    {"f_expand opt 0, no sync",         0,              1,  0},
+    {"NORMAL: fix 1 s, sync 30 s",      0,              1,  30},
+    {"SAVING: fix 2 s, sync 60 s",      0,              2,  60},
+    {"CRITICAL: fix 10 s, sync 300 s",  0,              10, 300},
+};
+
+/*!
+    @brief      Write the ride of a case on a fresh volume
+    @return     false if FatFs fails
+*/
+static bool ride(const Case_t* c, SIM_STATS* stats){
+    static const SIM_MODEL model = SIM_MODEL_SD_SPI;
+    static FATFS fs;
+    static FIL file;
+    static uint8_t work[FF_MAX_SS];
+    char point[256], time[32];
+    uint32_t t;
+    UINT written;
+    FRESULT r;
+
+    f_mount(NULL, "", 0);
+    if(f_mkfs("", FM_FAT32, CLUSTER_SIZE, work, sizeof(work)) != FR_OK || f_mount(&fs, "", 1) != FR_OK ||
+       f_open(&file, "test.gpx", FA_WRITE | FA_CREATE_ALWAYS) != FR_OK){
+        return false;
+    }
+    r = c->expand == EXPAND_NONE ? FR_OK : f_expand(&file, PREALLOC_SIZE, c->expand);
+    SIM_disk_model(SIM_IMG, &model);
+    SIM_disk_reset_stats(SIM_IMG);
+
+    for(t = 0; t < RIDE_S && r == FR_OK; t += c->fixS){
+        snprintf(time, sizeof(time), "2026-10-19T%02u:%02u:%02uZ", (unsigned)(10 + t / 3600),
+                 (unsigned)(t / 60 % 60), (unsigned)(t % 60));
+        snprintf(point, sizeof(point), GPX_TRACK_POINT, "45.4642035", "9.1899815", "122.4", time, "1.35");
+        r = f_write(&file, point, strlen(point), &written);
+        if(r == FR_OK && c->syncS != 0 && (t + c->fixS) % c->syncS == 0){
+            r = f_sync(&file);
+        }
+    }
+    //The clusters allocated by opt 1 beyond the data are given back, with opt 0 there are none
+    if(r == FR_OK){
+        r = f_truncate(&file);
+    }
+    if(f_close(&file) != FR_OK || r != FR_OK){
+        return false;
+    }
+    SIM_disk_stats(SIM_IMG, stats);
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    const char* image = "build/test/sdCache.img";
+    bool writesOnly = false;
+    long baseline = -1;
+    SIM_STATS stats;
+    uint32_t i;
+    int a;
+    bool ok = true;
+
+    for(a = 1; a < argc; ++a){
+        if(strcmp(argv[a], "--writes") == 0){
+            writesOnly = true;
+        }else if(strcmp(argv[a], "--baseline") == 0 && a + 1 < argc){
+            baseline = strtol(argv[++a], NULL, 0);
+        }else{
+            image = argv[a];
+        }
+    }
+    remove(image);
+    if(!IMG_disk_open(image, IMAGE_SECTORS)){
+        fprintf(stderr, "%s: could not create the image\n", image);
+        return 1;
+    }
+
+    if(writesOnly){
+        ok = ride(&cases[2], &stats);
+        printf("%u\n", (unsigned)stats.writes);
+    }else{
+        printf("MMC_CACHE_SECTORS %u, one hour of ride, card of the SIM_MODEL_SD_SPI model\n",
+               (unsigned)MMC_CACHE_SECTORS);
+        printf("%-32s %6s %7s %9s %7s %9s\n", "case", "reads", "writes", "sectors", "erases", "busy ms");
+        for(i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i){
+            if(!ride(&cases[i], &stats)){
+                printf("%-32s FatFs error  <-- FAIL\n", cases[i].name);
+                ok = false;
+                continue;
+            }
+            printf("%-32s %6u %7u %9u %7u %9u\n", cases[i].name, (unsigned)stats.reads,
+                   (unsigned)stats.writes, (unsigned)(stats.write_bytes / 512), (unsigned)stats.erases,
+                   (unsigned)(stats.busy_us / 1000));
+            //The area only reserved is never read back: a read of the FAT or of the directory entry
+            //at the start and at every sync at most
+            if(cases[i].expand == 0 && stats.reads > 2 + (cases[i].syncS ? RIDE_S / cases[i].syncS : 0)){
+                printf("  sectors of the ride read back from an area reserved with opt 0  <-- FAIL\n");
+                ok = false;
+            }
+            if(i == 2 && baseline > 0){
+                printf("  %.2f times fewer writes than without the cache (%ld)", (double)baseline / stats.writes,
+                       baseline);
+                if(stats.writes * MMC_CACHE_SECTORS * CACHE_TOLERANCE > baseline){
+                    printf("  <-- FAIL");
+                    ok = false;
+                }
+                printf("\n");
+            }
+        }
+    }
+
+    f_mount(NULL, "", 0);
+    IMG_disk_close();
+    remove(image);
+    return ok ? 0 : 1;
+}
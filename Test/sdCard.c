@@ -0,0 +1,286 @@
+/*!
+    @file       sdCard.c
+    @brief      Model of a SDHC card in SPI mode, see sdCard.h
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdlib.h>
+#include <string.h>
+
+/* Local Includes */
+#include "sdCard.h"
+#include "fake/fakeDriverlib.h"
+
+#define SECTOR_SIZE     512
+#define QUEUE_SIZE      1024        //!< Bytes the card has to send, a power of two
+
+typedef enum{
+    CARD_COMMAND,                   //!< Waiting for a command
+    CARD_WRITE_TOKEN,               //!< Waiting for the data token of a write
+    CARD_WRITE_DATA,                //!< Receiving a block and its CRC
+} CardState_t;
+
+typedef enum{
+    READ_NONE,
+    READ_SINGLE,
+    READ_MULTIPLE,
+    READ_REGISTER,                  //!< CSD or CID
+} CardRead_t;
+
+static struct{
+    uint8_t csPort;
+    uint16_t csPin;
+    uint8_t* data;
+    uint32_t sectors;
+    CardState_t state;
+    bool idle;                      //!< In the idle state: not initialized yet
+    bool appCommand;                //!< The command follows CMD55
+    uint8_t initCalls;              //!< ACMD41 received, the card is ready at the second
+    uint8_t command[6];
+    uint8_t commandLen;
+    uint8_t queue[QUEUE_SIZE];
+    uint32_t queueHead, queueTail;
+    CardRead_t read;
+    uint32_t readSector;
+    const uint8_t* readRegister;
+    uint64_t readAtNs;              //!< Time the next block of a read is ready
+    uint64_t busyUntilNs;           //!< Time the programming of a block ends
+    bool writeMultiple;
+    uint32_t writeSector;
+    uint8_t block[SECTOR_SIZE + 2];
+    uint32_t blockLen;
+    SdCardStats_t stats;
+} card;
+
+//! CSD version 2.0: TRAN_SPEED 25 Mbit/s, C_SIZE set by sdCardInit
+static uint8_t cardCsd[16] = {0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, 0x00,
+                              0x00, 0x00, 0x7F, 0x80, 0x0A, 0x40, 0x00, 0x01};
+static const uint8_t cardCid[16] = {0x03, 'S', 'D', 'S', 'I', 'M', 'C', 'D',
+                                    0x10, 0x12, 0x34, 0x56, 0x78, 0x01, 0x8A, 0x01};
+
+/*!
+    @brief      New card of some sectors, with every byte erased to 0xFF
+*/
+bool sdCardInit(uint8_t csPort, uint16_t csPin, uint32_t sectors){
+    uint32_t size = sectors / 1024 - 1;
+
+    sdCardFree();
+    memset(&card, 0, sizeof(card));
+    card.data = malloc((size_t)sectors * SECTOR_SIZE);
+    if(card.data == NULL || sectors < 1024){
+        return false;
+    }
+    memset(card.data, 0xFF, (size_t)sectors * SECTOR_SIZE);
+    card.sectors = sectors;
+    card.csPort = csPort;
+    card.csPin = csPin;
+    card.idle = true;
+    cardCsd[7] = (uint8_t)(size >> 16) & 0x3F;
+    cardCsd[8] = (uint8_t)(size >> 8);
+    cardCsd[9] = (uint8_t)size;
+    return true;
+}
+
+void sdCardFree(void){
+    free(card.data);
+    card.data = NULL;
+}
+
+const uint8_t* sdCardSector(uint32_t sector){
+    return sector < card.sectors ? &card.data[(size_t)sector * SECTOR_SIZE] : NULL;
+}
+
+void sdCardStats(SdCardStats_t* stats){
+    *stats = card.stats;
+}
+
+static void send(uint8_t byte){
+    card.queue[card.queueTail++ & (QUEUE_SIZE - 1)] = byte;
+}
+
+static void sendBlock(const uint8_t* data, uint32_t len){
+    send(0xFE);
+    while(len-- > 0){
+        send(*data++);
+    }
+    send(0xFF);                     //CRC, not checked in SPI mode
+    send(0xFF);
+}
+
+//! R1 after the Ncr byte
+static void sendR1(uint8_t flags){
+    send(0xFF);
+    send((card.idle ? 0x01 : 0x00) | flags);
+}
+
+static void execute(void){
+    uint8_t cmd = card.command[0] & 0x3F;
+    uint32_t arg = ((uint32_t)card.command[1] << 24) | ((uint32_t)card.command[2] << 16) |
+                   ((uint32_t)card.command[3] << 8) | card.command[4];
+    bool app = card.appCommand;
+    uint64_t now = fakeNowNs();
+
+    card.stats.commands++;
+    card.appCommand = false;
+    card.queueHead = card.queueTail;    //A command ends the data the card was sending
+    card.read = READ_NONE;
+    switch(cmd){
+    case 0:
+        card.idle = true;
+        card.initCalls = 0;
+        sendR1(0);
+        break;
+    case 8:
+        sendR1(0);
+        send(0x00);
+        send(0x00);
+        send((uint8_t)(arg >> 8) & 0x0F);
+        send((uint8_t)arg);
+        break;
+    case 55:
+        card.appCommand = true;
+        sendR1(0);
+        break;
+    case 41:
+        if(app && ++card.initCalls >= 2){
+            card.idle = false;
+        }
+        sendR1(app ? 0 : 0x04);
+        break;
+    case 58:
+        sendR1(0);
+        send(card.idle ? 0x40 : 0xC0);  //Power up done, CCS: block addressing
+        send(0xFF);
+        send(0x80);
+        send(0x00);
+        break;
+    case 9:
+    case 10:
+        sendR1(0);
+        card.read = READ_REGISTER;
+        card.readRegister = cmd == 9 ? cardCsd : cardCid;
+        card.readAtNs = now;
+        break;
+    case 12:
+        send(0xFF);                     //Stuff byte
+        sendR1(0);
+        break;
+    case 16:
+    case 23:
+        sendR1(0);
+        break;
+    case 17:
+    case 18:
+        if(card.idle || arg >= card.sectors){
+            sendR1(0x40);               //Parameter error
+            break;
+        }
+        sendR1(0);
+        card.read = cmd == 17 ? READ_SINGLE : READ_MULTIPLE;
+        card.readSector = arg;
+        card.readAtNs = now + SD_CARD_READ_US * 1000ull;
+        break;
+    case 24:
+    case 25:
+        if(card.idle || arg >= card.sectors){
+            sendR1(0x40);
+            break;
+        }
+        sendR1(0);
+        card.state = CARD_WRITE_TOKEN;
+        card.writeMultiple = cmd == 25;
+        card.writeSector = arg;
+        break;
+    default:
+        card.stats.errors++;
+        sendR1(0x04);                   //Illegal command
+        break;
+    }
+}
+
+/*!
+    @brief      A block of a read ready to be sent
+*/
+static void readBlock(void){
+    if(card.read == READ_REGISTER){
+        sendBlock(card.readRegister, 16);
+        card.read = READ_NONE;
+        return;
+    }
+    if(card.readSector >= card.sectors){
+        card.read = READ_NONE;
+        return;
+    }
+    sendBlock(&card.data[(size_t)card.readSector * SECTOR_SIZE], SECTOR_SIZE);
+    card.stats.blocksRead++;
+    card.readSector++;
+    if(card.read == READ_SINGLE){
+        card.read = READ_NONE;
+    }else{
+        card.readAtNs = fakeNowNs() + SD_CARD_BLOCK_US * 1000ull;
+    }
+}
+
+static void receive(uint8_t mosi){
+    switch(card.state){
+    case CARD_WRITE_TOKEN:
+        if(mosi == 0xFE || (mosi == 0xFC && card.writeMultiple)){
+            card.state = CARD_WRITE_DATA;
+            card.blockLen = 0;
+        }else if(mosi == 0xFD && card.writeMultiple){
+            card.state = CARD_COMMAND;
+            card.busyUntilNs = fakeNowNs() + 10000u;
+        }else if(mosi != 0xFF){
+            card.stats.errors++;
+        }
+        break;
+    case CARD_WRITE_DATA:
+        card.block[card.blockLen++] = mosi;
+        if(card.blockLen == sizeof(card.block)){
+            if(card.writeSector < card.sectors){
+                memcpy(&card.data[(size_t)card.writeSector * SECTOR_SIZE], card.block, SECTOR_SIZE);
+                card.stats.blocksWritten++;
+                send(0x05);             //Data accepted
+            }else{
+                send(0x0D);             //Write error
+            }
+            card.writeSector++;
+            card.busyUntilNs = fakeNowNs() + SD_CARD_PROGRAM_US * 1000ull;
+            card.state = card.writeMultiple ? CARD_WRITE_TOKEN : CARD_COMMAND;
+        }
+        break;
+    default:
+        if(card.commandLen > 0 || (mosi & 0xC0) == 0x40){
+            card.command[card.commandLen++] = mosi;
+            if(card.commandLen == sizeof(card.command)){
+                card.commandLen = 0;
+                execute();
+            }
+        }
+        break;
+    }
+}
+
+/*!
+    @brief      Byte of the bus: the card shifts out its next byte while it receives one
+*/
+uint8_t sdCardExchange(uint32_t moduleInstance, uint8_t mosi){
+    uint8_t miso;
+
+    if(fakePinIsHigh(card.csPort, card.csPin) || card.data == NULL){
+        card.commandLen = 0;
+        return 0xFF;
+    }
+    if(card.queueHead == card.queueTail && card.read != READ_NONE && fakeNowNs() >= card.readAtNs){
+        readBlock();
+    }
+    if(card.queueHead != card.queueTail){
+        miso = card.queue[card.queueHead++ & (QUEUE_SIZE - 1)];
+    }else{
+        miso = fakeNowNs() < card.busyUntilNs ? 0x00 : 0xFF;
+    }
+    receive(mosi);
+    return miso;
+}
@@ -0,0 +1,38 @@
+/*!
+    @file       sdCard.h
+    @brief      Model of a SDHC card in SPI mode on the fake driverlib
+    @details    The card answers the bytes of the bus as a real one: the initialization (CMD0, CMD8,
+                ACMD41, CMD58), the CSD and the CID, the single and multiple block reads and writes
+                with their tokens and data responses. The card is selected by its CS pin, the access
+                time of a read and the programming of a block are spent on the clock of the fake bus,
+                with the DO line held low while the card is busy as the drivers poll it.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef TEST_SD_CARD_H_
+#define TEST_SD_CARD_H_
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SD_CARD_READ_US     100     //!< Access time of the first block of a read
+#define SD_CARD_BLOCK_US    20      //!< Gap between the blocks of a multiple read
+#define SD_CARD_PROGRAM_US  250     //!< Programming of a written block
+
+//! Counters of the card
+typedef struct{
+    uint32_t commands;
+    uint32_t blocksRead;
+    uint32_t blocksWritten;
+    uint32_t errors;                //!< Malformed commands or data tokens
+} SdCardStats_t;
+
+bool sdCardInit(uint8_t csPort, uint16_t csPin, uint32_t sectors);
+void sdCardFree(void);
+uint8_t sdCardExchange(uint32_t moduleInstance, uint8_t mosi);
+const uint8_t* sdCardSector(uint32_t sector);
+void sdCardStats(SdCardStats_t* stats);
+
+#endif /* TEST_SD_CARD_H_ */
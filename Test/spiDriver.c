@@ -0,0 +1,158 @@
+/*!
+    @file       spiDriver.c
+    @brief      Test of the sharing of a SPI bus of Hardware/SPI_Driver.c on the fake driverlib
+    @details    The LCD and the SD card share EUSCI_B0 with their own profiles. The driver is run on
+                the fake driverlib of Test/fake and the test checks the chip selects, the conflicts
+                of a device that takes the bus during the transfer of another one, the switches of
+                profile (none when the same device takes the bus again) and the reload after a change
+                of SMCLK. The dividers are checked on a grid of SMCLK and device clocks: the clock of
+                the bus must never exceed the one of the device and must be the fastest that does not.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/spiDriver
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Local Includes */
+#include "Hardware/SPI_Driver.h"
+#include "fakeDriverlib.h"
+
+#define LCD_PORT    GPIO_PORT_P5
+#define LCD_CS      GPIO_PIN0
+#define SD_PORT     GPIO_PORT_P4
+#define SD_CS       GPIO_PIN6
+
+static uint32_t failures;
+
+static void check(const char* name, bool ok){
+    printf("%-60s %s\n", name, ok ? "ok" : "FAIL");
+    if(!ok){
+        failures++;
+    }
+}
+
+static eUSCI_SPI_MasterConfig profile(uint32_t clock){
+    eUSCI_SPI_MasterConfig config = {EUSCI_B_SPI_CLOCKSOURCE_SMCLK, 0, clock, EUSCI_B_SPI_MSB_FIRST,
+                                     EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT,
+                                     EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW, EUSCI_B_SPI_3PIN};
+    return config;
+}
+
+/*!
+    @brief      Two devices on a bus: chip selects, conflicts, switches and reloads
+*/
+static void testSharing(void){
+    static SPI_Device_t lcd, sd, other;
+    eUSCI_SPI_MasterConfig lcdConfig = profile(16000000);
+    eUSCI_SPI_MasterConfig sdConfig = profile(400000);
+    const FakeSPI_t* bus = fakeSPI(EUSCI_B0_BASE);
+    uint32_t inits;
+
+    fakeReset(24000000);
+    SPI_InitDevice(&lcd, EUSCI_B0_BASE, &lcdConfig, LCD_PORT, LCD_CS, true);
+    SPI_InitDevice(&sd, EUSCI_B0_BASE, &sdConfig, SD_PORT, SD_CS, false);
+    check("CS of the devices high and output after the init",
+          fakePinIsHigh(LCD_PORT, LCD_CS) && fakePinIsHigh(SD_PORT, SD_CS) &&
+          fakePinIsOutput(LCD_PORT, LCD_CS) && fakePinIsOutput(SD_PORT, SD_CS));
+
+    check("LCD takes the bus", SPI_Acquire(&lcd));
+    check("LCD selected with its profile, the divider rounded up",
+          !fakePinIsHigh(LCD_PORT, LCD_CS) && fakePinIsHigh(SD_PORT, SD_CS) && bus->clock == 12000000);
+    check("profile loaded with the module disabled", bus->enabled && !bus->initWhileEnabled);
+
+    check("SD refused during the transfer of the LCD", !SPI_Acquire(&sd));
+    check("one conflict, the LCD still selected", SPI_GetConflicts(EUSCI_B0_BASE) == 1 &&
+          !fakePinIsHigh(LCD_PORT, LCD_CS) && fakePinIsHigh(SD_PORT, SD_CS));
+
+    SPI_Release(&lcd);
+    check("LCD keeps its CS low after the release", !fakePinIsHigh(LCD_PORT, LCD_CS));
+    check("SD takes the bus after the release", SPI_Acquire(&sd));
+    check("LCD deselected, SD selected at 400 kHz", fakePinIsHigh(LCD_PORT, LCD_CS) &&
+          !fakePinIsHigh(SD_PORT, SD_CS) && bus->clock == 400000);
+    check("two switches", SPI_GetSwitches(EUSCI_B0_BASE) == 2);
+
+    SPI_Release(&sd);
+    check("SD deselected by the release", fakePinIsHigh(SD_PORT, SD_CS));
+    inits = bus->inits;
+    check("SD takes the bus again", SPI_Acquire(&sd));
+    check("no switch and no reload for the same device",
+          SPI_GetSwitches(EUSCI_B0_BASE) == 2 && bus->inits == inits);
+
+    SPI_SetDeviceClock(&sd, 25000000);
+    check("new clock of the active device applied at once",
+          bus->inits == inits + 1 && bus->clock == 24000000 && SPI_GetDeviceClock(&sd) == 25000000);
+    SPI_Release(&sd);
+
+    SPI_SetDeviceClock(&lcd, 8000000);
+    check("new clock of an inactive device not loaded", bus->inits == inits + 1);
+
+    //SMCLK halved by the power mode: the profiles are reloaded with the new dividers
+    SPI_Acquire(&sd);
+    fakeSetSMCLK(12000000);
+    SPI_Reconfigure(EUSCI_B0_BASE);
+    check("no reload while the bus is in a transfer", bus->inits == inits + 1);
+    SPI_Release(&sd);
+    SPI_Reconfigure(EUSCI_B0_BASE);
+    check("SD takes the bus after the change of SMCLK", SPI_Acquire(&sd));
+    check("profile reloaded for the new SMCLK", bus->inits == inits + 2 && bus->clock == 12000000 &&
+          SPI_GetSwitches(EUSCI_B0_BASE) == 3);
+    SPI_Release(&sd);
+
+    check("LCD takes the bus", SPI_Acquire(&lcd));
+    check("LCD at its new clock", bus->clock == 6000000 && bus->config.clockSourceFrequency == 12000000);
+    SPI_Release(&lcd);
+
+    //A device registered again may have a new profile
+    lcdConfig.desiredSpiClock = 4000000;
+    SPI_InitDevice(&lcd, EUSCI_B0_BASE, &lcdConfig, LCD_PORT, LCD_CS, true);
+    check("profile of a device registered again loaded", SPI_Acquire(&lcd) && bus->clock == 4000000);
+    SPI_Release(&lcd);
+
+    SPI_InitDevice(&other, EUSCI_B3_BASE, &sdConfig, SD_PORT, SD_CS, false);
+    check("no bus for EUSCI_B3", !SPI_Acquire(&other) && SPI_GetSwitches(EUSCI_B3_BASE) == 0);
+    check("an unknown bus is not a conflict", SPI_GetConflicts(EUSCI_B0_BASE) == 1);
+}
+
+/*!
+    @brief      Dividers of a grid of SMCLK and device clocks
+*/
+static void testDividers(void){
+    static const uint32_t smclks[] = {1500000, 3000000, 6000000, 12000000, 24000000, 48000000};
+    static const uint32_t clocks[] = {100000, 400000, 1000000, 7000000, 8000000, 16000000, 25000000};
+    static SPI_Device_t device;
+    eUSCI_SPI_MasterConfig config;
+    const FakeSPI_t* bus = fakeSPI(EUSCI_B1_BASE);
+    uint32_t i, j, divider, errors = 0;
+
+    for(i = 0; i < sizeof(smclks) / sizeof(smclks[0]); ++i){
+        for(j = 0; j < sizeof(clocks) / sizeof(clocks[0]); ++j){
+            fakeReset(smclks[i]);
+            config = profile(clocks[j]);
+            SPI_InitDevice(&device, EUSCI_B1_BASE, &config, SD_PORT, SD_CS, false);
+            SPI_Acquire(&device);
+            SPI_Release(&device);
+            divider = smclks[i] / bus->clock;
+            //Not above the device, unless SMCLK itself is, and no smaller divider would do
+            if((bus->clock > clocks[j] && bus->clock != smclks[i]) ||
+               (divider > 1 && smclks[i] / (divider - 1) <= clocks[j])){
+                printf("SMCLK %u Hz, device %u Hz: bus %u Hz\n", (unsigned)smclks[i], (unsigned)clocks[j],
+                       (unsigned)bus->clock);
+                errors++;
+            }
+        }
+    }
+    check("dividers: the fastest clock not above the device", errors == 0);
+}
+
+int main(void){
+    testSharing();
+    testDividers();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+/*!
+    @file       swtimerWheel.c
+    @brief      Test of the software timer wheel of Hardware/SWTIMER_Driver.c on the virtual clock
+    @details    The wheel is built with SIMULATE_HARDWARE and its clock is moved forward with
+                SWTIMER_SimAdvance. The test checks the one-shot and periodic timers, the timers of
+                the upper levels cascaded down to the exact tick, the expirations across the wrap of
+                the 64 slots of a level, the timers beyond the range of the wheel, and the callbacks
+                that stop or start timers, themselves included. Then 300 timers with random delays,
+                periods, stops and restarts are run against a model: every callback must come at the
+                expected tick, none may be missed.
+                The exit status is 1 if a check fails.
+
+                Usage:
+                    build/test/swtimerWheel
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Local Includes */
+#include "Hardware/SWTIMER_Driver.h"
+
+#define LEVEL1_TICKS        (1u << SWTIMER_WHEEL_SLOT_BITS)
+#define LEVEL2_TICKS        (1u << (2 * SWTIMER_WHEEL_SLOT_BITS))
+#define WHEEL_TICKS         (1u << (3 * SWTIMER_WHEEL_SLOT_BITS))
+#define RANDOM_TIMERS       300
+#define RANDOM_STEPS        2000
+
+static uint32_t failures;
+
+static void check(const char* name, bool ok){
+    printf("%-66s %s\n", name, ok ? "ok" : "FAIL");
+    if(!ok){
+        failures++;
+    }
+}
+
+//! A timer of the test and what it has seen
+typedef struct{
+    SWTIMER_Timer_t timer;
+    uint32_t calls;
+    uint32_t lastCall;              //!< Time of the last callback
+    uint32_t due;                   //!< Expected time of the next callback, model of the random test
+    uint32_t period;                //!< 0 for one-shot timers
+    uint32_t early;                 //!< Callbacks at another time than due
+    bool active;                    //!< Model of SWTIMER_IsActive
+} Probe_t;
+
+static void record(void* arg){
+    Probe_t* probe = (Probe_t*)arg;
+    probe->calls++;
+    probe->lastCall = SWTIMER_Now();
+}
+
+static void create(Probe_t* probe, SWTIMER_Callback_t callback){
+    probe->calls = 0;
+    probe->lastCall = 0;
+    SWTIMER_Create(&probe->timer, callback, probe);
+}
+
+/*!
+    @brief      One-shot and periodic timers of the first level
+*/
+static void testBasic(void){
+    static Probe_t once, periodic;
+    uint32_t start = SWTIMER_Now();
+
+    create(&once, record);
+    SWTIMER_StartOneShot(&once.timer, 10);
+    SWTIMER_SimAdvance(9);
+    check("one-shot not run before its time", once.calls == 0 && SWTIMER_IsActive(&once.timer));
+    SWTIMER_SimAdvance(1);
+    check("one-shot run once at its time, then inactive",
+          once.calls == 1 && once.lastCall == start + 10 && !SWTIMER_IsActive(&once.timer));
+    SWTIMER_SimAdvance(100);
+    check("one-shot not run again", once.calls == 1);
+
+    create(&periodic, record);
+    start = SWTIMER_Now();
+    SWTIMER_StartPeriodic(&periodic.timer, 7);
+    SWTIMER_SimAdvance(700);
+    check("periodic of 7 ticks run 100 times in 700 ticks, the last at 700",
+          periodic.calls == 100 && periodic.lastCall == start + 700);
+    SWTIMER_Stop(&periodic.timer);
+    SWTIMER_SimAdvance(100);
+    check("periodic stopped", periodic.calls == 100 && !SWTIMER_IsActive(&periodic.timer));
+}
+
+/*!
+    @brief      Timers of the upper levels and beyond the wheel, cascaded down to their tick
+*/
+static void testCascade(void){
+    static Probe_t probes[5];
+    static const uint32_t delays[5] = {LEVEL1_TICKS + 5, LEVEL2_TICKS - 1, LEVEL2_TICKS + 77,
+                                       WHEEL_TICKS - 3, WHEEL_TICKS + 1000};
+    uint32_t start = SWTIMER_Now();
+    bool ok = true;
+    uint8_t i;
+
+    for(i = 0; i < 5; ++i){
+        create(&probes[i], record);
+        SWTIMER_StartOneShot(&probes[i].timer, delays[i]);
+    }
+    SWTIMER_SimAdvance(WHEEL_TICKS + 2000);
+    for(i = 0; i < 5; ++i){
+        ok &= probes[i].calls == 1 && probes[i].lastCall == start + delays[i];
+    }
+    check("level 1, level 2 and beyond the wheel run at their exact tick", ok);
+}
+
+/*!
+    @brief      Expirations across the wrap of the slots of the first and second level
+*/
+static void testWrap(void){
+    static Probe_t near, far;
+    uint32_t now = SWTIMER_Now();
+    uint32_t start;
+
+    //Slot 60 of the first level, the timer expires in slot 6 of the next turn
+    SWTIMER_SimAdvance((60u - now) & (LEVEL1_TICKS - 1));
+    start = SWTIMER_Now();
+    create(&near, record);
+    SWTIMER_StartOneShot(&near.timer, 10);
+    SWTIMER_SimAdvance(20);
+    check("first level: from slot 60 to slot 6 of the next turn",
+          (start & (LEVEL1_TICKS - 1)) == 60 && near.calls == 1 && near.lastCall == start + 10);
+
+    //Near the end of the second level, the timer crosses the boundary of the third one
+    now = SWTIMER_Now();
+    SWTIMER_SimAdvance((LEVEL2_TICKS - 30u - now) & (LEVEL2_TICKS - 1));
+    start = SWTIMER_Now();
+    create(&far, record);
+    SWTIMER_StartOneShot(&far.timer, 100);
+    SWTIMER_SimAdvance(200);
+    check("second level: across the boundary of the third level",
+          far.calls == 1 && far.lastCall == start + 100);
+}
+
+static Probe_t pair[2], self, restarted;
+
+//! Stops the other timer of the pair, due at the same tick: the order in a slot is not defined
+static void stopPartner(void* arg){
+    record(arg);
+    SWTIMER_Stop(&pair[arg == &pair[0] ? 1 : 0].timer);
+}
+
+//! A one-shot that starts itself again two times
+static void startItself(void* arg){
+    record(arg);
+    if(self.calls < 3){
+        SWTIMER_StartOneShot(&self.timer, 5);
+    }
+}
+
+//! A periodic timer that stops itself at the third call and starts another one
+static void stopItself(void* arg){
+    Probe_t* probe = (Probe_t*)arg;
+    record(arg);
+    if(probe->calls == 3){
+        SWTIMER_Stop(&probe->timer);
+        SWTIMER_StartOneShot(&restarted.timer, LEVEL1_TICKS * 2);
+    }
+}
+
+/*!
+    @brief      Callbacks that stop and start timers, themselves included
+*/
+static void testCallbacks(void){
+    static Probe_t periodic;
+    uint32_t start = SWTIMER_Now();
+
+    create(&pair[0], stopPartner);
+    create(&pair[1], stopPartner);
+    SWTIMER_StartOneShot(&pair[0].timer, 5);
+    SWTIMER_StartOneShot(&pair[1].timer, 5);
+    SWTIMER_SimAdvance(100);
+    check("a timer stopped by a callback of the same tick does not run",
+          pair[0].calls + pair[1].calls == 1 && !SWTIMER_IsActive(&pair[0].timer) && !SWTIMER_IsActive(&pair[1].timer));
+
+    create(&self, startItself);
+    start = SWTIMER_Now();
+    SWTIMER_StartOneShot(&self.timer, 5);
+    SWTIMER_SimAdvance(100);
+    check("a one-shot restarted by its callback runs again 3 times in all",
+          self.calls == 3 && self.lastCall == start + 15 && !SWTIMER_IsActive(&self.timer));
+
+    create(&periodic, stopItself);
+    create(&restarted, record);
+    start = SWTIMER_Now();
+    SWTIMER_StartPeriodic(&periodic.timer, 20);
+    SWTIMER_SimAdvance(LEVEL1_TICKS * 4);
+    check("a periodic stopped by its callback does not run again",
+          periodic.calls == 3 && periodic.lastCall == start + 60 && !SWTIMER_IsActive(&periodic.timer));
+    check("a timer of the second level started by a callback runs at its time",
+          restarted.calls == 1 && restarted.lastCall == start + 60 + LEVEL1_TICKS * 2);
+}
+
+static void modelCallback(void* arg){
+    Probe_t* probe = (Probe_t*)arg;
+    record(arg);
+    if(!probe->active || probe->lastCall != probe->due){
+        probe->early++;
+    }
+    if(probe->period){
+        probe->due += probe->period;
+    }else{
+        probe->active = false;
+    }
+}
+
+//! Random delay, mostly short, some on the upper levels and a few beyond the wheel
+static uint32_t randomDelay(void){
+    switch(rand() % 8){
+    case 0:
+        return 1 + rand() % (WHEEL_TICKS + LEVEL2_TICKS);
+    case 1:
+    case 2:
+        return 1 + rand() % LEVEL2_TICKS;
+    default:
+        return 1 + rand() % (2 * LEVEL1_TICKS);
+    }
+}
+
+static void randomStart(Probe_t* probe){
+    uint32_t delay = randomDelay();
+    probe->period = rand() % 3 == 0 ? delay : 0;
+    probe->due = SWTIMER_Now() + delay;
+    probe->active = true;
+    if(probe->period){
+        SWTIMER_StartPeriodic(&probe->timer, delay);
+    }else{
+        SWTIMER_StartOneShot(&probe->timer, delay);
+    }
+}
+
+/*!
+    @brief      Random timers against a model
+*/
+static void testRandom(void){
+    static Probe_t probes[RANDOM_TIMERS];
+    uint32_t step, i, early = 0, missed = 0, state = 0, calls = 0;
+
+    srand(1);
+    for(i = 0; i < RANDOM_TIMERS; ++i){
+        create(&probes[i], modelCallback);
+        probes[i].early = 0;
+        randomStart(&probes[i]);
+    }
+    for(step = 0; step < RANDOM_STEPS; ++step){
+        SWTIMER_SimAdvance(1 + rand() % 600);
+        //Some timers stopped, some restarted, active or not
+        for(i = 0; i < 3; ++i){
+            Probe_t* probe = &probes[rand() % RANDOM_TIMERS];
+            if(rand() % 2){
+                SWTIMER_Stop(&probe->timer);
+                probe->active = false;
+            }else{
+                randomStart(probe);
+            }
+        }
+        for(i = 0; i < RANDOM_TIMERS; ++i){
+            //An active timer due in the past has been missed
+            missed += probes[i].active && (int32_t)(probes[i].due - SWTIMER_Now()) <= 0;
+            state += probes[i].active != SWTIMER_IsActive(&probes[i].timer);
+        }
+    }
+    for(i = 0; i < RANDOM_TIMERS; ++i){
+        early += probes[i].early;
+        calls += probes[i].calls;
+    }
+    printf("%u timers, %u steps, %u ticks, %u callbacks\n", RANDOM_TIMERS, RANDOM_STEPS, (unsigned)SWTIMER_Now(),
+           (unsigned)calls);
+    check("random timers: every callback at its expected tick", early == 0 && calls > 0);
+    check("random timers: none missed", missed == 0);
+    check("random timers: SWTIMER_IsActive as the model", state == 0);
+}
+
+int main(void){
+    SWTIMER_Init();
+    testBasic();
+    testCascade();
+    testWrap();
+    testCallbacks();
+    testRandom();
+    printf("%s\n", failures == 0 ? "all checks passed" : "some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+"""Reference client of the ride export service of the bike computer (see sync.h).
+
+Packets, in both directions: A5 5A type[1] len[2] payload[len] crc[2], little endian,
+CRC-16/CCITT-FALSE over type, len and payload.
+
+Usage as a library:
+    client = SyncClient(open_serial("/dev/rfcomm0", 115200))
+    for ride in client.list():
+        print(ride)
+    client.get("TEST1.GPX", "test1.gpx")
+
+Usage from the command line:
+    python3 Test/syncClient.py /dev/rfcomm0 list
+    python3 Test/syncClient.py /dev/rfcomm0 get TEST1.GPX [local file]   # resumes a partial file
+    python3 Test/syncClient.py /dev/rfcomm0 get --all                    # every ride not yet downloaded
+    python3 Test/syncClient.py /dev/rfcomm0 delete TEST1.GPX
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import time
+
+from telemetry import crc16, open_serial
+
+SOF = b"\xA5\x5A"
+
+CMD_LIST = 0x01
+CMD_GET = 0x02
+CMD_DELETE = 0x03
+CMD_ABORT = 0x04
+REPLY_LIST = 0x81
+REPLY_LIST_END = 0x82
+REPLY_DATA = 0x83
+REPLY_DATA_END = 0x84
+REPLY_STATUS = 0x85
+
+RESULT_BUSY = 0xFE
+RESULT_BAD_CMD = 0xFF
+
+LIST_ENTRY = struct.Struct("<IHH13s")
+CHUNK_SIZE = 512
+
+# FatFs FRESULT codes
+FRESULTS = ("OK", "DISK_ERR", "INT_ERR", "NOT_READY", "NO_FILE", "NO_PATH", "INVALID_NAME", "DENIED", "EXIST",
+            "INVALID_OBJECT", "WRITE_PROTECTED", "INVALID_DRIVE", "NOT_ENABLED", "NO_FILESYSTEM", "MKFS_ABORTED",
+            "TIMEOUT", "LOCKED", "NOT_ENOUGH_CORE", "TOO_MANY_OPEN_FILES", "INVALID_PARAMETER")
+
+
+def result_name(result):
+    if result == RESULT_BUSY:
+        return "BUSY (recording)"
+    if result == RESULT_BAD_CMD:
+        return "BAD_CMD"
+    return FRESULTS[result] if result < len(FRESULTS) else str(result)
+
+
+class SyncError(Exception):
+    def __init__(self, cmd, result):
+        super().__init__("command 0x%02x failed: %s" % (cmd, result_name(result)))
+        self.cmd = cmd
+        self.result = result
+
+
+def encode_packet(packet_type, payload=b""):
+    body = struct.pack("<BH", packet_type, len(payload)) + payload
+    return SOF + body + struct.pack("<H", crc16(body))
+
+
+def fat_datetime(fdate, ftime):
+    return "%04d-%02d-%02d %02d:%02d:%02d" % ((fdate >> 9) + 1980, (fdate >> 5) & 15, fdate & 31,
+                                              ftime >> 11, (ftime >> 5) & 63, (ftime & 31) * 2)
+
+
+class PacketReader:
+    """Stream parser: feed it the received bytes, it returns the (type, payload) of the valid packets.
+
+    The packets with a bad CRC are counted in bad_packets and skipped.
+    """
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bad_packets = 0
+
+    def feed(self, data):
+        packets = []
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SOF)
+            if start < 0:
+                del self.buffer[:max(0, len(self.buffer) - 1)]
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < 5:
+                break
+            packet_type, length = struct.unpack_from("<BH", self.buffer, 2)
+            if len(self.buffer) < 7 + length:
+                break
+            body = bytes(self.buffer[2:5 + length])
+            crc = struct.unpack_from("<H", self.buffer, 5 + length)[0]
+            if crc != crc16(body):
+                self.bad_packets += 1
+                del self.buffer[:2]
+                continue
+            del self.buffer[:7 + length]
+            packets.append((packet_type, body[3:]))
+        return packets
+
+
+class SyncClient:
+    def __init__(self, fd, timeout=2.0, retries=5):
+        self.fd = fd
+        self.timeout = timeout
+        self.retries = retries
+        self.reader = PacketReader()
+        self.pending = []
+        self.resumes = 0
+
+    def send(self, packet_type, payload=b""):
+        os.write(self.fd, encode_packet(packet_type, payload))
+
+    def receive(self):
+        """Next packet, None after the timeout."""
+        deadline = time.monotonic() + self.timeout
+        while not self.pending:
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None
+            self.pending += self.reader.feed(os.read(self.fd, 4096))
+        return self.pending.pop(0)
+
+    def drain(self):
+        """Discard the packets of an interrupted command."""
+        timeout, self.timeout = self.timeout, 0.2
+        while self.receive() is not None:
+            pass
+        self.timeout = timeout
+
+    def list(self):
+        """Ride index: list of (name, size, date)."""
+        for _ in range(self.retries):
+            self.send(CMD_LIST)
+            rides = []
+            while True:
+                packet = self.receive()
+                if packet is None:
+                    break
+                packet_type, payload = packet
+                if packet_type == REPLY_LIST:
+                    for offset in range(0, len(payload) - LIST_ENTRY.size + 1, LIST_ENTRY.size):
+                        size, fdate, ftime, name = LIST_ENTRY.unpack_from(payload, offset)
+                        rides.append((name.split(b"\0")[0].decode(), size, fat_datetime(fdate, ftime)))
+                elif packet_type == REPLY_LIST_END:
+                    if struct.unpack("<H", payload)[0] == len(rides):
+                        return rides
+                    break
+                elif packet_type == REPLY_STATUS:
+                    raise SyncError(payload[0], payload[1])
+            self.drain()
+        raise TimeoutError("list failed")
+
+    def get(self, name, path, progress=None):
+        """Download a ride, resuming from the size of the local file. Returns the size of the ride."""
+        mode = "r+b" if os.path.exists(path) else "w+b"
+        with open(path, mode) as out:
+            offset = out.seek(0, os.SEEK_END)
+            retries = 0
+            self.send(CMD_GET, struct.pack("<I", offset) + name.encode() + b"\0")
+            while True:
+                packet = self.receive()
+                if packet is not None and packet[0] == REPLY_DATA and \
+                        struct.unpack_from("<I", packet[1])[0] == offset:
+                    out.seek(offset)
+                    out.write(packet[1][4:])
+                    offset += len(packet[1]) - 4
+                    retries = 0
+                    if progress:
+                        progress(offset)
+                    continue
+                if packet is not None and packet[0] == REPLY_DATA_END:
+                    size = struct.unpack("<I", packet[1])[0]
+                    if size == offset:
+                        out.truncate(size)
+                        return size
+                elif packet is not None and packet[0] == REPLY_STATUS:
+                    raise SyncError(packet[1][0], packet[1][1])
+                elif packet is not None and packet[0] == REPLY_DATA and \
+                        struct.unpack_from("<I", packet[1])[0] > offset:
+                    pass                                    # a chunk was lost: resume below
+                elif packet is not None:
+                    continue                                # stale packet of an older request
+                # Lost chunk, short ride or timeout: resume from the first missing byte
+                retries += 1
+                if retries > self.retries:
+                    raise TimeoutError("get %s failed at offset %d" % (name, offset))
+                self.send(CMD_ABORT)
+                self.drain()
+                self.resumes += 1
+                self.send(CMD_GET, struct.pack("<I", offset) + name.encode() + b"\0")
+
+    def delete(self, name):
+        for _ in range(self.retries):
+            self.send(CMD_DELETE, name.encode() + b"\0")
+            while True:
+                packet = self.receive()
+                if packet is None:
+                    break
+                if packet[0] == REPLY_STATUS and packet[1][0] == CMD_DELETE:
+                    if packet[1][1] != 0:
+                        raise SyncError(CMD_DELETE, packet[1][1])
+                    return
+        raise TimeoutError("delete failed")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bike computer ride export client")
+    parser.add_argument("port", help="serial device of the BLE-serial bridge (or a pseudo terminal)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=2.0)
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("list")
+    get = sub.add_parser("get")
+    get.add_argument("name", nargs="?")
+    get.add_argument("path", nargs="?")
+    get.add_argument("--all", action="store_true", help="download every ride missing or partial")
+    delete = sub.add_parser("delete")
+    delete.add_argument("name")
+    args = parser.parse_args()
+
+    client = SyncClient(open_serial(args.port, args.baud), args.timeout)
+    try:
+        if args.command == "list":
+            for name, size, date in client.list():
+                print("%-12s %8d  %s" % (name, size, date))
+        elif args.command == "get":
+            if args.all:
+                rides = [(name, size) for name, size, _ in client.list()
+                         if not os.path.exists(name.lower()) or os.path.getsize(name.lower()) != size]
+            elif args.name:
+                rides = [(args.name, None)]
+            else:
+                parser.error("a ride name or --all is required")
+            for name, _ in rides:
+                path = args.path if args.path and not args.all else name.lower()
+                start = time.monotonic()
+                size = client.get(name, path)
+                elapsed = time.monotonic() - start
+                print("%s: %d bytes in %.1f s (%.1f kB/s), %d resumes, %d bad packets" %
+                      (name, size, elapsed, size / 1024 / max(elapsed, 1e-3), client.resumes,
+                       client.reader.bad_packets))
+        else:
+            client.delete(args.name)
+    except SyncError as error:
+        print(error, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+/*!
+    @file       syncHost.c
+    @brief      Host harness of the ride export service on a pseudo terminal
+    @details    Runs sync.c on the PC as the device does: the rides are on a FatFs volume in an image
+                file (the SD card of diskio.c on the host) and the link of the BLE-serial module is a
+                pseudo terminal, so Test/syncClient.py talks to it unchanged. The harness formats the
+                image, writes some rides of known content (and a file that is not a ride) and a copy
+                of every ride in the directory of the references, then prints the path of the slave
+                of the terminal and serves the commands until it is terminated.
+                SIGUSR1 toggles syncSetBusy as the recording of a ride does, the new state is printed
+                when it is applied. Test/syncLoopback.py runs the whole test.
+
+                Usage:
+                    build/test/syncHost <image file> <directory of the references>
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Local Includes */
+#include "fatfs/ff.h"
+#include "fatfs/sim_disk.h"
+#include "sync.h"
+
+#define IMAGE_SECTORS       8192    //!< 4 MB volume
+
+//! Rides of the volume: the empty one, one shorter than a chunk, one of whole chunks and a long one
+static const struct{
+    const char* name;
+    uint32_t size;
+} rides[] = {
+    {"EMPTY.GPX", 0},
+    {"RIDE0001.GPX", 1000},
+    {"RIDE0002.GPX", 3 * 512},
+    {"RIDE0003.GPX", 70001},
+};
+
+static volatile sig_atomic_t toggleBusy;
+static volatile sig_atomic_t stop;
+
+static void onSignal(int signal){
+    if(signal == SIGUSR1){
+        toggleBusy = 1;
+    }else{
+        stop = 1;
+    }
+}
+
+/*!
+    @brief      Byte n of a ride: depends on the ride, so a wrong file or offset does not match
+*/
+static uint8_t rideByte(uint32_t ride, uint32_t n){
+    n = n * 2654435761u + ride * 40503u;
+    return (uint8_t)(n >> 24);
+}
+
+/*!
+    @brief      Write a file on the volume and its copy in the directory of the references
+*/
+static bool writeFile(const char* dir, const char* name, uint32_t ride, uint32_t size){
+    uint8_t buffer[512];
+    char path[256];
+    FILE* copy;
+    FIL file;
+    UINT written;
+    uint32_t n, i, chunk;
+    bool ok;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    copy = fopen(path, "wb");
+    if(copy == NULL || f_open(&file, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK){
+        if(copy != NULL){
+            fclose(copy);
+        }
+        return false;
+    }
+    ok = true;
+    for(n = 0; n < size && ok; n += chunk){
+        chunk = size - n < sizeof(buffer) ? size - n : sizeof(buffer);
+        for(i = 0; i < chunk; ++i){
+            buffer[i] = rideByte(ride, n + i);
+        }
+        ok = f_write(&file, buffer, chunk, &written) == FR_OK && written == chunk &&
+             fwrite(buffer, 1, chunk, copy) == chunk;
+    }
+    ok &= f_close(&file) == FR_OK;
+    fclose(copy);
+    return ok;
+}
+
+/*!
+    @brief      Open a pseudo terminal, the slave is kept open and raw so no byte is echoed
+    @return     the master, -1 on error
+*/
+static int openTerminal(int* slave){
+    struct termios attrs;
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 ||
+       (*slave = open(ptsname(master), O_RDWR | O_NOCTTY)) < 0){
+        return -1;
+    }
+    tcgetattr(*slave, &attrs);
+    cfmakeraw(&attrs);
+    tcsetattr(*slave, TCSANOW, &attrs);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+int main(int argc, char* argv[]){
+    static FATFS fs;
+    static uint8_t work[FF_MAX_SS];
+    struct pollfd link;
+    bool busy = false;
+    int master, slave;
+    uint32_t i;
+
+    if(argc != 3){
+        fprintf(stderr, "usage: %s <image file> <directory of the references>\n", argv[0]);
+        return 2;
+    }
+
+    //Fresh volume with the rides
+    remove(argv[1]);
+    if(!IMG_disk_open(argv[1], IMAGE_SECTORS) || f_mkfs("", FM_FAT, 0, work, sizeof(work)) != FR_OK ||
+       f_mount(&fs, "", 1) != FR_OK){
+        fprintf(stderr, "%s: could not format the image\n", argv[1]);
+        return 1;
+    }
+    for(i = 0; i < sizeof(rides) / sizeof(rides[0]); ++i){
+        if(!writeFile(argv[2], rides[i].name, i, rides[i].size)){
+            fprintf(stderr, "%s: could not write the ride\n", rides[i].name);
+            return 1;
+        }
+    }
+    if(!writeFile(argv[2], "NOTES.TXT", 99, 100)){
+        return 1;
+    }
+
+    master = openTerminal(&slave);
+    if(master < 0){
+        perror("pseudo terminal");
+        return 1;
+    }
+    signal(SIGUSR1, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGINT, onSignal);
+
+    syncInit();
+    syncSetHostFd(master);
+    printf("%s\n", ptsname(master));
+    fflush(stdout);
+
+    //Same work of the sync task, the poll stands for the RX event of the UART
+    link.fd = master;
+    link.events = POLLIN;
+    while(!stop){
+        if(toggleBusy){
+            toggleBusy = 0;
+            busy = !busy;
+            syncSetBusy(busy);
+            printf("busy %d\n", busy ? 1 : 0);
+            fflush(stdout);
+        }
+        poll(&link, 1, 20);
+        syncProcess();
+    }
+
+    syncSetHostFd(-1);
+    close(slave);
+    close(master);
+    f_mount(NULL, "", 0);
+    IMG_disk_close();
+    return 0;
+}
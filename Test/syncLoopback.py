@@ -0,0 +1,103 @@
+"""Loopback test of the ride export: Test/syncClient.py against sync.c over a pseudo terminal.
+
+The host harness (build/test/syncHost, see Test/syncHost.c) serves a FatFs image with rides of known
+content on a pseudo terminal; the client is run on it as the rider does: the list must have exactly
+the rides (not the other files) with their sizes, every ride downloaded must be the same as the
+reference written by the harness, a partial download must resume to the same file, the commands on
+the SD card must be refused while a ride is recorded, and a deleted ride must leave the list.
+The exit status is 1 if a check fails.
+
+Usage:
+    python3 Test/syncLoopback.py build/test/syncHost
+"""
+
+import argparse
+import filecmp
+import os
+import signal
+import subprocess
+import sys
+import tempfile
+
+CLIENT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "syncClient.py")
+
+
+def client(port, *args):
+    """Run syncClient.py: exit status and output"""
+    run = subprocess.run([sys.executable, CLIENT, port, "--timeout", "1"] + list(args),
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True,
+                         timeout=60)
+    return run.returncode, run.stdout
+
+
+def listed(port):
+    """Rides listed by the client: name -> size, None if the list fails"""
+    status, out = client(port, "list")
+    if status != 0:
+        return None
+    return dict((line.split()[0], int(line.split()[1])) for line in out.splitlines() if line.strip())
+
+
+def check(name, ok, detail=""):
+    print("%-40s %s%s" % (name, "ok" if ok else "FAIL", ("  " + detail.strip()) if detail and not ok else ""))
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Loopback test of the ride export over a pseudo terminal")
+    parser.add_argument("harness", help="host harness of sync.c (build/test/syncHost)")
+    args = parser.parse_args()
+    ok = True
+
+    with tempfile.TemporaryDirectory() as tmp:
+        refs = os.path.join(tmp, "refs")
+        os.mkdir(refs)
+        host = subprocess.Popen([args.harness, os.path.join(tmp, "sd.img"), refs],
+                                stdout=subprocess.PIPE, universal_newlines=True)
+        try:
+            port = host.stdout.readline().strip()
+            if not port:
+                print("the harness did not start")
+                sys.exit(1)
+            rides = dict((name, os.path.getsize(os.path.join(refs, name)))
+                         for name in os.listdir(refs) if name.upper().endswith(".GPX"))
+
+            ok &= check("list", listed(port) == rides, str(listed(port)))
+
+            for name in sorted(rides):
+                path = os.path.join(tmp, name.lower())
+                status, out = client(port, "get", name, path)
+                ok &= check("get " + name, status == 0 and filecmp.cmp(path, os.path.join(refs, name), False), out)
+
+            # Resume of a download stopped in the middle of a chunk
+            name = max(rides, key=rides.get)
+            path = os.path.join(tmp, "partial.gpx")
+            with open(os.path.join(refs, name), "rb") as f:
+                data = f.read()
+            with open(path, "wb") as f:
+                f.write(data[:len(data) // 2 + 17])
+            status, out = client(port, "get", name, path)
+            ok &= check("resume " + name, status == 0 and filecmp.cmp(path, os.path.join(refs, name), False), out)
+
+            # A ride being recorded locks the SD card
+            host.send_signal(signal.SIGUSR1)
+            ok &= check("busy on", host.stdout.readline().strip() == "busy 1")
+            status, out = client(port, "delete", "RIDE0001.GPX")
+            ok &= check("delete refused while busy", status != 0 and listed(port) is None, out)
+            host.send_signal(signal.SIGUSR1)
+            ok &= check("busy off", host.stdout.readline().strip() == "busy 0")
+
+            status, out = client(port, "delete", "RIDE0001.GPX")
+            del rides["RIDE0001.GPX"]
+            ok &= check("delete", status == 0 and listed(port) == rides, out)
+            status, out = client(port, "get", "NOTES.TXT", os.path.join(tmp, "notes.txt"))
+            ok &= check("get of a file that is not a ride", status != 0, out)
+        finally:
+            host.terminate()
+            host.wait()
+
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
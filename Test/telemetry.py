@@ -0,0 +1,280 @@
+"""Decoder of the binary telemetry stream of the bike computer (see telemetry.h).
+
+Frames: COBS(type[1] seq[1] timeMs[4] body[n] crc16[2]) 0x00, little endian,
+CRC-16/CCITT-FALSE over type..body.
+
+Usage as a library:
+    decoder = TelemetryDecoder()
+    for message in decoder.feed(data):
+        print(message)
+
+Usage from the command line:
+    python3 Test/telemetry.py /dev/ttyACM0            # MSP432 XDS110 UART
+    python3 Test/telemetry.py --pty                   # create a pseudo terminal for the simulator
+    python3 Test/telemetry.py /dev/ttyACM0 --only speed,bss
+    python3 Test/telemetry.py --check-c build/test/telemetryHost   # frames of telemetry.c
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+# type: (name, struct format of the body, field names, scale of every field)
+MESSAGES = {
+    1: ("fix", "<iiiBBH", ("latitude", "longitude", "altitude", "sats", "fix", "hdop"), (1e-7, 1e-7, 0.01, 1, 1, 0.01)),
+    2: ("speed", "<HHI", ("wheel_speed", "gps_speed", "distance"), (0.01, 0.01, 1)),
+    3: ("wheel", "<I", ("revolutions",), (1,)),
+    4: ("bss", "<Bh", ("class", "average_acc"), (1, 0.001)),
+    5: ("light", "<H", ("light",), (0.001,)),
+    6: ("temp", "<h", ("temp",), (0.01,)),
+    7: ("profiler", "<BIIII", ("region", "count", "min", "mean", "max"), (1, 1, 1, 1, 1)),
+    8: ("attitude", "<hhhh", ("roll", "pitch", "yaw_rate", "grade"), (0.01, 0.01, 0.01, 0.01)),
+}
+
+BSS_CLASSES = ("IDLE", "ERROR", "BRAKING", "MOVING", "LOW_AMBIENT_LIGHT", "CRASH")
+
+PROFILER_REGIONS = ("acquire_window", "compute", "gpsParseData", "showPages", "GPXAddTrackPoint", "fusion", "f_write",
+                    "TA0_N ISR", "TA1_0 ISR", "ADC14 ISR", "DMA_INT1 ISR", "EUSCIA0 ISR", "EUSCIA2 ISR",
+                    "PORT3 ISR", "PORT5 ISR")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, same as telemCrc16()."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    """COBS encoding without the delimiter, same as telemCobsEncode()."""
+    out = bytearray([0])
+    code_index = 0
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(byte)
+            code += 1
+            if code == 0xFF:
+                out[code_index] = code
+                code_index = len(out)
+                out.append(0)
+                code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """COBS decoding of a frame without the delimiter, None if malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(frame):
+    """Decode a frame (delimiter excluded), returns a dict or None if the frame is not valid."""
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) < 8:
+        return None
+    if crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+        return None
+    msg_type, seq, time_ms = struct.unpack_from("<BBI", raw, 0)
+    body = raw[6:-2]
+    message = {"type": msg_type, "seq": seq, "time_ms": time_ms}
+    if msg_type not in MESSAGES:
+        message["name"] = "unknown"
+        message["body"] = body.hex()
+        return message
+    name, fmt, fields, scales = MESSAGES[msg_type]
+    if len(body) != struct.calcsize(fmt):
+        return None
+    message["name"] = name
+    for field, value, scale in zip(fields, struct.unpack(fmt, body), scales):
+        message[field] = value * scale if scale != 1 else value
+    if name == "bss" and message["class"] < len(BSS_CLASSES):
+        message["class"] = BSS_CLASSES[message["class"]]
+    if name == "profiler" and message["region"] < len(PROFILER_REGIONS):
+        message["region"] = PROFILER_REGIONS[message["region"]]
+    return message
+
+
+class TelemetryDecoder:
+    """Stream decoder: feed it the received bytes, it returns the decoded messages.
+
+    The frames with a bad CRC (e.g. debug text on the same UART) are counted in bad_frames,
+    the gaps in the sequence numbers in lost_frames.
+    """
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.frames = 0
+        self.bad_frames = 0
+        self.lost_frames = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        messages = []
+        self.buffer += data
+        while True:
+            end = self.buffer.find(0)
+            if end < 0:
+                break
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not frame:
+                continue
+            message = decode_frame(frame)
+            if message is None:
+                self.bad_frames += 1
+                continue
+            self.frames += 1
+            if self.last_seq is not None:
+                self.lost_frames += (message["seq"] - self.last_seq - 1) & 0xFF
+            self.last_seq = message["seq"]
+            messages.append(message)
+        return messages
+
+
+def open_serial(path, baud):
+    """Open a serial device (or a pseudo terminal) in raw mode."""
+    import termios
+    import tty
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def open_pty():
+    """Create a pseudo terminal: the simulator writes to the slave, the decoder reads the master."""
+    import tty
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    return master, os.ttyname(slave)
+
+
+def format_message(message):
+    fields = " ".join("%s=%s" % (k, ("%.7g" % v) if isinstance(v, float) else v)
+                      for k, v in message.items() if k not in ("type", "seq", "time_ms", "name"))
+    return "%10.3f %-8s %s" % (message["time_ms"] / 1000.0, message["name"], fields)
+
+
+# Messages sent by Test/telemetryHost.c, in order. The text before the last but one fix has no delimiter:
+# with that fix it is a frame with a bad CRC, and the sequence number of the last fix has a gap
+C_FIX = ("fix", {"latitude": 46.0770483, "longitude": 11.1203667, "altitude": 179.9, "sats": 5, "fix": 1,
+                 "hdop": 2.29})
+C_MESSAGES = [C_FIX,
+              ("speed", {"wheel_speed": 25.37, "gps_speed": 24.9, "distance": 12345}),
+              ("wheel", {"revolutions": 123456}),
+              ("bss", {"class": "MOVING", "average_acc": -0.512}),
+              ("light", {"light": 0.42}),
+              ("temp", {"temp": -5.25}),
+              ("profiler", {"region": "gpsParseData", "count": 1000, "min": 64, "mean": 2048, "max": 65536}),
+              ("attitude", {"roll": -12.5, "pitch": 3.25, "yaw_rate": 45.0, "grade": -7.5}),
+              ("wheel", {"revolutions": 0}),
+              C_FIX]
+C_BAD_FRAMES = 1
+C_LOST_FRAMES = 1
+
+
+def check_c(binary):
+    """Decodes the frames of telemetry.c (Test/telemetryHost.c), returns the list of the differences"""
+    stream = subprocess.run([binary], capture_output=True, check=True).stdout
+    decoder = TelemetryDecoder()
+    messages = decoder.feed(stream)
+    errors = []
+    # The encoder of the C must give the same bytes of the one of this decoder
+    for frame in filter(None, stream.split(b"\0")):
+        raw = cobs_decode(frame)
+        if raw is not None and decode_frame(frame) is not None and cobs_encode(raw) != frame:
+            errors.append("COBS of %s differs: %s" % (raw.hex(), frame.hex()))
+    if not any(0 in cobs_decode(f) for f in filter(None, stream.split(b"\0")) if cobs_decode(f) is not None):
+        errors.append("no frame with zero bytes")
+    if decoder.bad_frames != C_BAD_FRAMES or decoder.lost_frames != C_LOST_FRAMES or decoder.buffer:
+        errors.append("bad frames %d, lost %d (%d and %d expected), %d bytes after the last frame" %
+                      (decoder.bad_frames, decoder.lost_frames, C_BAD_FRAMES, C_LOST_FRAMES, len(decoder.buffer)))
+    if [m["seq"] for m in messages] != list(range(len(messages) - 1)) + [len(messages)]:
+        errors.append("sequence numbers %s" % [m["seq"] for m in messages])
+    if [m["name"] for m in messages] != [name for name, _ in C_MESSAGES]:
+        errors.append("messages %s" % [m["name"] for m in messages])
+    for message, (name, fields) in zip(messages, C_MESSAGES):
+        for field, expected in fields.items():
+            value = message.get(field)
+            scale = MESSAGES[message["type"]][3][MESSAGES[message["type"]][2].index(field)]
+            if isinstance(expected, str):
+                same = value == expected
+            else:
+                # Half a unit of the scale, and the float of the C: 24 bits of mantissa
+                same = abs(value - expected) <= scale / 2 + abs(expected) * 2 ** -23
+            if not same:
+                errors.append("%s %s: %s, %s expected" % (name, field, value, expected))
+    print("telemetry.c %d frames, %d bad: %s" % (decoder.frames, decoder.bad_frames,
+                                                  "same of the decoder" if not errors else "; ".join(errors[:3])))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bike computer telemetry decoder")
+    parser.add_argument("port", nargs="?", help="serial device, e.g. /dev/ttyACM0 or COM3")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--pty", action="store_true", help="create a pseudo terminal and wait for the simulator")
+    parser.add_argument("--only", default="", help="comma separated message names to print")
+    parser.add_argument("--no-start", action="store_true", help="do not send the start command 't'")
+    parser.add_argument("--check-c", metavar="BINARY", help="decode the frames of telemetry.c run by Test/telemetryHost.c")
+    args = parser.parse_args()
+
+    if args.check_c:
+        sys.exit(1 if check_c(args.check_c) else 0)
+
+    if args.pty:
+        fd, name = open_pty()
+        print("Pseudo terminal: %s" % name, file=sys.stderr)
+    elif args.port:
+        fd = open_serial(args.port, args.baud)
+    else:
+        parser.error("a port or --pty is required")
+
+    only = set(filter(None, args.only.split(",")))
+    decoder = TelemetryDecoder()
+    if not args.pty and not args.no_start:
+        os.write(fd, b"t")
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for message in decoder.feed(data):
+                if not only or message["name"] in only:
+                    print(format_message(message), flush=True)
+    except (KeyboardInterrupt, OSError):
+        pass
+    finally:
+        if not args.pty and not args.no_start:
+            os.write(fd, b"q")
+        print("frames %d, bad %d, lost %d" % (decoder.frames, decoder.bad_frames, decoder.lost_frames), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
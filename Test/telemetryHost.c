@@ -0,0 +1,61 @@
+/*!
+    @file       telemetryHost.c
+    @brief      Frames of telemetry.c on the PC, for the decoder of Test/telemetry.py
+    @details    Every message type is sent once with known values, in the order of @ref TelemMsg_t,
+                on the file descriptor set by telemSetHostFd (the standard output). Then:
+                    - a wheel message with 0 revolutions, a body of zero bytes only;
+                    - a line of text, as a PRINTF on the same UART, and the fix message again: the
+                      text has no delimiter, so the decoder sees one frame with a bad CRC and the
+                      fix is lost, as on the UART;
+                    - a speed message sent with the stream disabled, that must not be sent;
+                    - the fix message again, decoded with a gap of one in the sequence numbers.
+                Test/telemetry.py --check-c decodes the stream and compares the values with the
+                ones it expects.
+
+                Usage:
+                    build/test/telemetryHost > frames.bin
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local Includes */
+#include "telemetry.h"
+
+static void sendFix(void){
+    telemSendFix(46.0770483f, 11.1203667f, 179.9f, 5, 1, 2.29f);
+}
+
+int main(void){
+    static const char text[] = "Scheduler: 1000 ms, LPM0 950 permille\r\n";
+
+    telemInit();
+    telemSetHostFd(STDOUT_FILENO);
+    telemEnable(true);
+
+    sendFix();
+    telemSendSpeed(25.37f, 24.9f, 12.345f);
+    telemSendWheel(123456u);
+    telemSendBss(3, -0.512f);
+    telemSendLight(0.42f);
+    telemSendTemp(-5.25f);
+    telemSendProfiler(2, 1000u, 64u, 2048u, 65536u);
+    telemSendAttitude(-12.5f, 3.25f, 45.0f, -7.5f);
+
+    telemSendWheel(0);
+    if(write(STDOUT_FILENO, text, strlen(text)) < 0){
+        return 1;
+    }
+    sendFix();
+    telemEnable(false);
+    telemSendSpeed(1.0f, 1.0f, 1.0f);
+    telemEnable(true);
+    sendFix();
+    return telemGetDrops() == 0 ? 0 : 1;
+}
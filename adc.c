@@ -6,6 +6,10 @@
  */
 #include "adc.h"
 #include "photoresistor.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "energy.h"
+#include "battery.h"
 
 /*!
     @addtogroup ADC_module ADC
@@ -14,6 +18,7 @@
 
 volatile bool flagTemp;     //!< Flag to arise if a new temperature value is sampled
 volatile int16_t conRes;    //!< Intermediate temperature value sampled from ADC unit
+volatile uint16_t batteryRaw;   //!< Last battery sample, see battery.h
 
 // void adcInit()
 // {
@@ -52,6 +57,7 @@ volatile int16_t conRes;    //!< Intermediate temperature value sampled from ADC
 
 void ADC14_IRQHandler(void)
 {
+    PROF_ENTER(PROF_ISR_ADC14);
     uint64_t status;
 
     status = MAP_ADC14_getEnabledInterruptStatus();
@@ -61,6 +67,9 @@ void ADC14_IRQHandler(void)
 
     if (status & ADC_INT0){
         conRes = ((ADC14_getResult(ADC_MEM0) - cal30) * 55);
+        batteryRaw = ADC14_getResult(BATTERY_ADC_MEM);     //end of the previous sequence
+        ENERGY_COUNT(ENERGY_ADC, 1);
+        schedPostEvent(SCHED_EVENT_TEMP);
         Interrupt_disableSleepOnIsrExit();
     } else if (status & ADC_INT3) {
         if(resultPos < LIGHT_BUFFER_LENGTH) {
@@ -68,7 +77,9 @@ void ADC14_IRQHandler(void)
         } else {
             photoresFlag = true;
             ++sendPos;
+            schedPostEvent(SCHED_EVENT_LIGHT);
             MAP_Interrupt_disableSleepOnIsrExit();
         }
     }
+    PROF_EXIT(PROF_ISR_ADC14);
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
 
 extern volatile bool flagTemp;     
 extern volatile int16_t conRes;    
+extern volatile uint16_t batteryRaw;
 
 //void adcInit();
 
@@ -0,0 +1,220 @@
+/*!
+    @file       attitude.c
+    @ingroup    Attitude_Module
+    @brief      Lean angle, pitch and yaw rate from the accelerometer and the gyroscope implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+/* Local Includes */
+#include "attitude.h"
+
+/*!
+    @addtogroup Attitude_Module
+    @{
+*/
+
+#define ATT_GRAVITY                 9.81f               //!< [m/s^2]
+#define ATT_DEG_TO_RAD              0.017453292f
+#define ATT_RAD_TO_DEG              57.29578f
+#define ATT_STILL_SPEED             0.5f                //!< Faster the unit is not still [m/s]
+#define ATT_ALONG_MAX               5.0f                //!< Larger speed changes are steps of the speed input [m/s^2]
+
+static bool attValid = false;
+static float attPeriod;                     //!< Sample period [s]
+static float attTime;                       //!< Time from the reset [s], up to ATT_START_S
+static float attQ[4];                       //!< Quaternion from the sensor to the earth frame
+static float attIntegral[3];                //!< Integral term of the correction [rad/s]
+static float attBias[3];                    //!< Gyroscope bias [deg/s]
+static float attSpeed;                      //!< [m/s]
+static float attAlong;                      //!< Along-track acceleration from the speed [m/s^2]
+static uint16_t attSpeedSamples;            //!< Samples since the last speed
+static float attUp[3];                      //!< Vertical in the sensor frame, from the estimate
+static float attLinear[3];                  //!< Acceleration without the gravity [g]
+static float attYawRate;                    //!< [deg/s], low pass
+
+/*!
+    @brief      Forget the estimate, the next sample starts a new one
+    @param      period: sample period of the IMU [s]
+*/
+void attitudeReset(float period){
+    attValid = false;
+    attPeriod = period;
+    attSpeed = 0;
+    attAlong = 0;
+    attSpeedSamples = 0;
+    attBias[0] = attBias[1] = attBias[2] = 0;
+}
+
+/*!
+    @brief      Speed of the bike, for the centripetal acceleration in the turns
+    @details    The change from the previous speed is the along-track acceleration, removed from the
+                measured gravity as the centripetal one. Called once per BSS window.
+    @param      speed: [m/s]
+*/
+void attitudeSetSpeed(float speed){
+    if(attSpeedSamples > 0){
+        attAlong = (speed - attSpeed) / ((float)attSpeedSamples * attPeriod);
+        if(attAlong > ATT_ALONG_MAX){
+            attAlong = ATT_ALONG_MAX;
+        }else if(attAlong < -ATT_ALONG_MAX){
+            attAlong = -ATT_ALONG_MAX;
+        }
+    }
+    attSpeedSamples = 0;
+    attSpeed = speed;
+}
+
+/*!
+    @brief      Vertical in the sensor frame: third row of the rotation matrix of the quaternion
+*/
+static void attUpdateUp(void){
+    attUp[0] = 2.0f * (attQ[1] * attQ[3] - attQ[0] * attQ[2]);
+    attUp[1] = 2.0f * (attQ[0] * attQ[1] + attQ[2] * attQ[3]);
+    attUp[2] = attQ[0] * attQ[0] - attQ[1] * attQ[1] - attQ[2] * attQ[2] + attQ[3] * attQ[3];
+}
+
+/*!
+    @brief      First sample: roll and pitch from the accelerometer, yaw 0
+*/
+static void attStart(const float accel[3]){
+    float roll = atan2f(accel[1], accel[2]);
+    float pitch = atan2f(-accel[0], sqrtf(accel[1] * accel[1] + accel[2] * accel[2]));
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    attQ[0] = cr * cp;
+    attQ[1] = sr * cp;
+    attQ[2] = cr * sp;
+    attQ[3] = -sr * sp;
+    attIntegral[0] = attIntegral[1] = attIntegral[2] = 0;
+    attYawRate = 0;
+    attTime = 0;
+    attUpdateUp();
+    attValid = true;
+}
+
+/*!
+    @brief      New sample of the IMU, at the fixed period of @ref attitudeReset
+    @param      accel: x, y, z acceleration [g]
+    @param      gyro: x, y, z angular rate [deg/s]
+*/
+void attitudeUpdate(const float accel[3], const float gyro[3]){
+    float w[3];                             //Angular rate without the bias [rad/s]
+    float g[3];                             //Measured gravity
+    float dt = attPeriod;
+    float norm, qDot[4];
+    uint8_t i;
+
+    if(!attValid){
+        attStart(accel);
+    }
+    for(i = 0; i < 3; ++i){
+        w[i] = (gyro[i] - attBias[i]) * ATT_DEG_TO_RAD;
+    }
+
+    //Along-track and centripetal acceleration w x v with v = (speed, 0, 0), removed from the measurement
+    g[0] = accel[0] - attAlong / ATT_GRAVITY;
+    g[1] = accel[1] - w[2] * attSpeed / ATT_GRAVITY;
+    g[2] = accel[2] + w[1] * attSpeed / ATT_GRAVITY;
+
+    //Gravity correction, only when the measurement is close to 1 g
+    norm = sqrtf(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+    if(fabsf(norm - 1.0f) < ATT_ACCEL_GATE){
+        float e[3];
+        float kp = attTime < ATT_START_S ? ATT_KP_START : ATT_KP;
+        for(i = 0; i < 3; ++i){
+            g[i] /= norm;
+        }
+        e[0] = g[1] * attUp[2] - g[2] * attUp[1];
+        e[1] = g[2] * attUp[0] - g[0] * attUp[2];
+        e[2] = g[0] * attUp[1] - g[1] * attUp[0];
+        for(i = 0; i < 3; ++i){
+            if(attTime >= ATT_START_S){
+                attIntegral[i] += ATT_KI * e[i] * dt;
+            }
+            w[i] += kp * e[i] + attIntegral[i];
+        }
+    }
+
+    //Bias learning with the unit still, the vertical axis is not corrected by the gravity
+    if(attSpeed < ATT_STILL_SPEED && fabsf(norm - 1.0f) < ATT_STILL_GATE &&
+       fabsf(gyro[0] - attBias[0]) < ATT_STILL_RATE && fabsf(gyro[1] - attBias[1]) < ATT_STILL_RATE &&
+       fabsf(gyro[2] - attBias[2]) < ATT_STILL_RATE){
+        for(i = 0; i < 3; ++i){
+            attBias[i] += (gyro[i] - attBias[i]) * dt / ATT_BIAS_TAU_S;
+        }
+    }
+
+    //q' = q + 0.5 q (0, w) dt
+    qDot[0] = -attQ[1] * w[0] - attQ[2] * w[1] - attQ[3] * w[2];
+    qDot[1] = attQ[0] * w[0] + attQ[2] * w[2] - attQ[3] * w[1];
+    qDot[2] = attQ[0] * w[1] - attQ[1] * w[2] + attQ[3] * w[0];
+    qDot[3] = attQ[0] * w[2] + attQ[1] * w[1] - attQ[2] * w[0];
+    norm = 0;
+    for(i = 0; i < 4; ++i){
+        attQ[i] += 0.5f * qDot[i] * dt;
+        norm += attQ[i] * attQ[i];
+    }
+    norm = 1.0f / sqrtf(norm);
+    for(i = 0; i < 4; ++i){
+        attQ[i] *= norm;
+    }
+    attUpdateUp();
+
+    for(i = 0; i < 3; ++i){
+        attLinear[i] = accel[i] - attUp[i];
+    }
+    //Rotation around the vertical, clockwise positive as the course
+    float yawRate = -((gyro[0] - attBias[0]) * attUp[0] + (gyro[1] - attBias[1]) * attUp[1] +
+                      (gyro[2] - attBias[2]) * attUp[2]);
+    attYawRate += (yawRate - attYawRate) * dt / (ATT_YAW_RATE_TAU_S + dt);
+    if(attTime < ATT_START_S){
+        attTime += dt;
+    }
+    if(attSpeedSamples < UINT16_MAX){
+        ++attSpeedSamples;
+    }
+}
+
+bool attitudeIsValid(void){
+    return attValid;
+}
+
+/*!
+    @brief      Lean angle [deg], positive leaning right
+*/
+float attitudeGetRoll(void){
+    return attValid ? atan2f(attUp[1], attUp[2]) * ATT_RAD_TO_DEG : 0;
+}
+
+/*!
+    @brief      Pitch [deg], positive nose up
+*/
+float attitudeGetPitch(void){
+    return attValid ? asinf(fmaxf(-1.0f, fminf(1.0f, attUp[0]))) * ATT_RAD_TO_DEG : 0;
+}
+
+/*!
+    @brief      Yaw rate [deg/s], positive turning right
+*/
+float attitudeGetYawRate(void){
+    return attValid ? attYawRate : 0;
+}
+
+/*!
+    @brief      Acceleration of the last sample without the gravity
+    @param      accel: destination, x, y, z in the sensor frame [g]
+*/
+void attitudeGetLinearAccel(float accel[3]){
+    uint8_t i;
+    for(i = 0; i < 3; ++i){
+        accel[i] = attValid ? attLinear[i] : 0;
+    }
+}
+
+/*! @} */ //End of Attitude_Module
@@ -0,0 +1,68 @@
+/*!
+    @file       attitude.h
+    @ingroup    Attitude_Module
+    @brief      Lean angle, pitch and yaw rate from the accelerometer and the gyroscope of the MPU6050
+    @details    Mahony filter on a quaternion, updated at every sample of the FIFO of the MPU6050, at
+                the fixed rate set by its sample rate divider: the gyroscope is integrated and the
+                difference between the measured and the estimated gravity corrects the drift with a
+                proportional and an integral term.
+                On a bike the accelerometer does not measure the gravity alone:
+                - in a turn the bike leans until the sum of gravity and centripetal acceleration is
+                  along its frame, so the accelerometer alone sees no lean at all; the centripetal
+                  acceleration speed x angular rate is removed before the correction, with the speed
+                  of @ref attitudeSetSpeed;
+                - accelerating and braking tilt the measured gravity forward and back: the change of
+                  the speed between two calls of @ref attitudeSetSpeed is removed as well;
+                - bumps change the length of the measured vector: the samples farther than
+                  @ref ATT_ACCEL_GATE from 1 g do not correct the estimate.
+                While the unit is still the gyroscope bias is learned, also on the vertical axis where
+                the accelerometer cannot correct it.
+                The samples are in the bike frame of mountCalib.h: x forward, y left, z up. The outputs are:
+                - roll: lean angle, positive leaning right [deg];
+                - pitch: positive nose up [deg], the grade of the road plus the mounting, a cross-check
+                  of the grade of the GPS altitude;
+                - yaw rate: around the vertical, positive turning right as the course [deg/s];
+                - the acceleration without the gravity, in the sensor frame, used by the BSS so the
+                  braking detection does not depend on the tilt of the unit.
+                The module does not depend on the hardware: Test/attitude.py runs the same filter on
+                synthetic and recorded IMU traces to evaluate it.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __ATTITUDE_H__
+#define __ATTITUDE_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Attitude_Module Attitude
+    @name       Attitude Module
+    @{
+*/
+
+#define ATT_KP                      1.0f        //!< Proportional gain of the gravity correction [rad/s]
+#define ATT_KI                      0.02f       //!< Integral gain of the gravity correction [rad/s^2]
+#define ATT_KP_START                10.0f       //!< Proportional gain while the filter converges
+#define ATT_START_S                 2.0f        //!< Convergence time after the reset [s]
+#define ATT_ACCEL_GATE              0.15f       //!< Farther from 1 g the accelerometer does not correct [g]
+#define ATT_STILL_RATE              3.0f        //!< Slower rotations with the unit still learn the bias [deg/s]
+#define ATT_STILL_GATE              0.03f       //!< Still: acceleration within 1 g +- this [g]
+#define ATT_BIAS_TAU_S              4.0f        //!< Time constant of the bias learning [s]
+#define ATT_YAW_RATE_TAU_S          0.1f        //!< Low pass of the yaw rate output [s]
+
+void attitudeReset(float period);
+void attitudeSetSpeed(float speed);
+void attitudeUpdate(const float accel[3], const float gyro[3]);
+
+bool attitudeIsValid(void);
+float attitudeGetRoll(void);
+float attitudeGetPitch(void);
+float attitudeGetYawRate(void);
+void attitudeGetLinearAccel(float accel[3]);
+
+/*! @} */ //End of Attitude_Module
+
+#endif // __ATTITUDE_H__
@@ -0,0 +1,99 @@
+/*!
+    @file       battery.c
+    @ingroup    Battery_Module
+    @brief      Battery voltage and state of charge implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Local Includes */
+#include "battery.h"
+
+/*!
+    @addtogroup Battery_Module
+    @{
+*/
+
+#define BT_ALPHA                    (BATTERY_PERIOD_MS / (1000.0f * BATTERY_FILTER_S))
+
+//! Open circuit voltage of a Li-ion cell at a low discharge rate [V]
+static const float btCurveVoltage[BATTERY_CURVE_POINTS] = {
+    3.00f, 3.45f, 3.60f, 3.68f, 3.73f, 3.77f, 3.80f, 3.84f, 3.90f, 3.97f, 4.06f, 4.20f
+};
+
+//! State of charge at the voltages of the curve [%]
+static const uint8_t btCurveSoc[BATTERY_CURVE_POINTS] = {
+    0, 5, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100
+};
+
+static float btVoltage;                     //!< Filtered open circuit voltage
+static bool btValid;
+
+/*!
+    @brief      Battery voltage of a conversion, under load
+*/
+float batteryVoltageFromRaw(uint16_t raw){
+    return raw * (BATTERY_VREF * BATTERY_DIVIDER / BATTERY_ADC_COUNTS);
+}
+
+/*!
+    @brief      State of charge of an open circuit voltage, linear between the points of the curve
+    @return     percentage, saturated to 0 and 100
+*/
+uint8_t batterySocFromVoltage(float voltage){
+    uint8_t i;
+    float fraction;
+    if(voltage <= btCurveVoltage[0]){
+        return 0;
+    }
+    if(voltage >= btCurveVoltage[BATTERY_CURVE_POINTS - 1]){
+        return 100;
+    }
+    for(i = 1; voltage > btCurveVoltage[i]; ++i){
+    }
+    fraction = (voltage - btCurveVoltage[i - 1]) / (btCurveVoltage[i] - btCurveVoltage[i - 1]);
+    return (uint8_t)(btCurveSoc[i - 1] + fraction * (btCurveSoc[i] - btCurveSoc[i - 1]) + 0.5f);
+}
+
+void batteryReset(void){
+    btVoltage = 0.0f;
+    btValid = false;
+}
+
+/*!
+    @brief      New conversion, every @ref BATTERY_PERIOD_MS
+    @details    The first one starts the filter, so the state of charge is right at the power on.
+    @param      raw: conversion of @ref BATTERY_ADC_MEM
+    @param      loadMa: current drawn from the battery at the conversion, expected [mA]
+*/
+void batteryAddSample(uint16_t raw, float loadMa){
+    float voltage = batteryVoltageFromRaw(raw) + BATTERY_R_INTERNAL * loadMa / 1000.0f;
+    if(!btValid){
+        btVoltage = voltage;
+        btValid = true;
+    }else{
+        btVoltage += BT_ALPHA * (voltage - btVoltage);
+    }
+}
+
+bool batteryIsValid(void){
+    return btValid;
+}
+
+float batteryGetVoltage(void){
+    return btVoltage;
+}
+
+/*!
+    @brief      State of charge of the filtered voltage
+    @return     percentage, 100 before the first sample
+*/
+uint8_t batteryGetSoc(void){
+    return btValid ? batterySocFromVoltage(btVoltage) : 100;
+}
+
+/*! @} */ //End of Battery_Module
@@ -0,0 +1,61 @@
+/*!
+    @file       battery.h
+    @ingroup    Battery_Module
+    @brief      Battery voltage and state of charge
+    @details    The battery is read by ADC14 on P5.5 (A0) through a divider by
+                @ref BATTERY_DIVIDER, against the 2.5 V internal reference already enabled for the
+                temperature sensor: one more memory, ADC_MEM4, at the end of the sequence triggered
+                by TIMER_A3, so no conversion of its own.
+                The voltage under load is lower than the open circuit one by the drop on the
+                internal resistance of the cell, @ref BATTERY_R_INTERNAL: a sample is corrected with
+                the load expected at that moment, the lights first, and then filtered by an
+                exponential average with a time constant of @ref BATTERY_FILTER_S, so the PWM of
+                the lights and the SD writes do not move the state of charge. The state of charge is the
+                interpolation of the filtered voltage on the discharge curve of a Li-ion cell at a
+                low rate, @ref BATTERY_CURVE_POINTS points from 3.0 V (empty) to 4.2 V (full): flat
+                in the middle and steep at both ends.
+                The module does not depend on the hardware: Test/power.py uses the same curve and
+                filter on whole-ride discharges.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __BATTERY_H__
+#define __BATTERY_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Battery_Module Battery
+    @name       Battery Module
+    @{
+*/
+
+#define BATTERY_PORT                GPIO_PORT_P5
+#define BATTERY_PIN                 GPIO_PIN5   //!< A0
+#define BATTERY_ADC_INPUT           ADC_INPUT_A0
+#define BATTERY_ADC_MEM             ADC_MEM4
+
+#define BATTERY_VREF                2.5f        //!< Internal reference of the conversion [V]
+#define BATTERY_DIVIDER             2.0f        //!< Battery voltage over the pin voltage
+#define BATTERY_ADC_COUNTS          16384       //!< 14 bit conversion
+#define BATTERY_PERIOD_MS           1000        //!< Period of the samples of the filter
+#define BATTERY_FILTER_S            30.0f       //!< Time constant of the filter [s]
+#define BATTERY_R_INTERNAL          0.15f       //!< Internal resistance of the cell [ohm]
+#define BATTERY_CURVE_POINTS        12
+#define BATTERY_CAPACITY_MAH        2600        //!< 18650 cell
+
+void batteryReset(void);
+void batteryAddSample(uint16_t raw, float loadMa);
+bool batteryIsValid(void);
+float batteryGetVoltage(void);
+uint8_t batteryGetSoc(void);
+
+float batteryVoltageFromRaw(uint16_t raw);
+uint8_t batterySocFromVoltage(float voltage);
+
+/*! @} */ //End of Battery_Module
+
+#endif // __BATTERY_H__
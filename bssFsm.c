@@ -0,0 +1,363 @@
+/*!
+    @file       bssFsm.c
+    @ingroup    BssFsm_Module
+    @brief      State machine of the BSS: classes, thresholds and patterns of lights and buzzer implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Local Includes */
+#include "bssFsm.h"
+#include "fsm.h"
+#include "numFormat.h"
+
+/*!
+    @addtogroup BssFsm_Module
+    @{
+*/
+
+//! Inputs of the guards for the current step
+typedef struct{
+    const model_t* model;
+    bool crash;
+} BfInputs_t;
+
+//! Parameter of the configuration file
+typedef struct{
+    const char* name;
+    size_t offset;                              //!< Field of BssConfig_t
+    float min;
+    float max;
+    uint8_t digits;                             //!< Fraction digits in the file
+} BfParam_t;
+
+static const BfParam_t bfParams[] = {
+    {"brake_acc",           offsetof(BssConfig_t, brakeAcc),        -4.0f,  0.0f,       2},
+    {"brake_release",       offsetof(BssConfig_t, brakeRelease),    0.0f,   2.0f,       2},
+    {"brake_min_ms",        offsetof(BssConfig_t, brakeMinMs),      0.0f,   10000.0f,   0},
+    {"light_on",            offsetof(BssConfig_t, lightOn),         0.0f,   100.0f,     1},
+    {"light_hysteresis",    offsetof(BssConfig_t, lightHysteresis), 0.0f,   50.0f,      1},
+    {"light_debounce_ms",   offsetof(BssConfig_t, lightDebounceMs), 0.0f,   10000.0f,   0},
+    {"t_max",               offsetof(BssConfig_t, tMax),            20.0f,  85.0f,      1},
+    {"t_hysteresis",        offsetof(BssConfig_t, tHysteresis),     0.0f,   30.0f,      1},
+    {"error_debounce_ms",   offsetof(BssConfig_t, errorDebounceMs), 0.0f,   10000.0f,   0},
+    {"error_min_ms",        offsetof(BssConfig_t, errorMinMs),      0.0f,   10000.0f,   0},
+};
+#define BF_PARAM_COUNT              (sizeof(bfParams) / sizeof(bfParams[0]))
+
+//! Outputs of the states: flashing, steady, and the transient idle that keeps the previous ones
+static const BssPattern_t bfPatterns[BSS_CLASS_COUNT] = {
+    [CLASS_IDLE]                = {0x00, 0x00, 0x00, BSS_OUT_REAR | BSS_OUT_FRONT | BSS_OUT_BUZZER, BSS_LIGHT_OFF, BSS_LIGHT_OFF},
+    [CLASS_ERROR]               = {0x55, 0x55, 0x00, 0, BSS_LIGHT_BLINK, BSS_LIGHT_BLINK},
+    [CLASS_BRAKING]             = {0xFF, 0x00, 0x00, BSS_OUT_FRONT, BSS_LIGHT_BRAKE, BSS_LIGHT_OFF},
+    [CLASS_MOVING]              = {0x05, 0x01, 0x00, 0, BSS_LIGHT_FLASH, BSS_LIGHT_FLASH},     //double pulse behind, a flash ahead
+    [CLASS_LOW_AMBIENT_LIGHT]   = {0xFF, 0xFF, 0x00, 0, BSS_LIGHT_STEADY, BSS_LIGHT_STEADY},
+    [CLASS_CRASH]               = {0x15, 0x15, 0x15, 0, BSS_LIGHT_BLINK, BSS_LIGHT_BLINK},     //three short pulses and a pause
+};
+
+static BfInputs_t bfInputs;
+static BssConfig_t bfConfig;
+static Fsm_t bfFsm;
+static uint32_t bfEntries[BSS_CLASS_COUNT];
+static uint32_t bfMs[BSS_CLASS_COUNT];         //!< Time spent in the state, closed visits [ms]
+static uint16_t bfPeriodMs;                     //!< BSS window, see bssFsmSetPeriod
+static uint16_t bfDwellBase;                    //!< Windows of the current visit already in bfMs
+
+static bool bfCrash(void* context){
+    return ((const BfInputs_t*)context)->crash;
+}
+
+static bool bfNoCrash(void* context){
+    return !((const BfInputs_t*)context)->crash;
+}
+
+static bool bfHot(void* context){
+    return ((const BfInputs_t*)context)->model->temp > bfConfig.tMax;
+}
+
+static bool bfCool(void* context){
+    return ((const BfInputs_t*)context)->model->temp < bfConfig.tMax - bfConfig.tHysteresis;
+}
+
+static bool bfBraking(void* context){
+    return ((const BfInputs_t*)context)->model->averageAcc < bfConfig.brakeAcc;
+}
+
+static bool bfReleased(void* context){
+    return ((const BfInputs_t*)context)->model->averageAcc > bfConfig.brakeAcc + bfConfig.brakeRelease;
+}
+
+static bool bfDark(void* context){
+    return ((const BfInputs_t*)context)->model->light < bfConfig.lightOn;
+}
+
+static bool bfBright(void* context){
+    return ((const BfInputs_t*)context)->model->light > bfConfig.lightOn + bfConfig.lightHysteresis;
+}
+
+static void bfEntry(void* context, uint8_t state){
+    ++bfEntries[state];
+}
+
+static void bfExit(void* context, uint8_t state){
+    bfMs[state] += (uint32_t)(bfFsm.dwell - bfDwellBase) * bfPeriodMs;
+    bfDwellBase = 0;
+}
+
+//! Minimum dwells from the configuration, see bfApply
+static FsmState_t bfStates[BSS_CLASS_COUNT] = {
+    [CLASS_IDLE]                = {bfEntry, bfExit, 0},
+    [CLASS_ERROR]               = {bfEntry, bfExit, 0},
+    [CLASS_BRAKING]             = {bfEntry, bfExit, 0},
+    [CLASS_MOVING]              = {bfEntry, bfExit, 0},
+    [CLASS_LOW_AMBIENT_LIGHT]   = {bfEntry, bfExit, 0},
+    [CLASS_CRASH]               = {bfEntry, bfExit, 0},
+};
+
+//! In order of priority, debounces from the configuration, see bfApply
+static FsmTransition_t bfTransitions[] = {
+    {FSM_ANY,                   CLASS_CRASH,                FSM_PREEMPT,    0, bfCrash},
+    {CLASS_CRASH,               CLASS_IDLE,                 0,              0, bfNoCrash},
+    {CLASS_IDLE,                CLASS_ERROR,                0,              0, bfHot},
+    {CLASS_MOVING,              CLASS_ERROR,                0,              0, bfHot},
+    {CLASS_LOW_AMBIENT_LIGHT,   CLASS_ERROR,                0,              0, bfHot},
+    {CLASS_BRAKING,             CLASS_ERROR,                0,              0, bfHot},
+    {CLASS_ERROR,               CLASS_IDLE,                 0,              0, bfCool},
+    {CLASS_IDLE,                CLASS_BRAKING,              0,              0, bfBraking},
+    {CLASS_MOVING,              CLASS_BRAKING,              0,              0, bfBraking},
+    {CLASS_LOW_AMBIENT_LIGHT,   CLASS_BRAKING,              0,              0, bfBraking},
+    {CLASS_BRAKING,             CLASS_IDLE,                 0,              0, bfReleased},
+    {CLASS_IDLE,                CLASS_LOW_AMBIENT_LIGHT,    0,              0, bfDark},
+    {CLASS_IDLE,                CLASS_MOVING,               0,              0, NULL},
+    {CLASS_MOVING,              CLASS_LOW_AMBIENT_LIGHT,    0,              0, bfDark},
+    {CLASS_LOW_AMBIENT_LIGHT,   CLASS_MOVING,               0,              0, bfBright},
+};
+#define BF_TRANSITION_COUNT         (sizeof(bfTransitions) / sizeof(bfTransitions[0]))
+
+/*!
+    @brief      Duration in BSS windows, rounded up
+*/
+static uint16_t bfWindows(float ms){
+    return (uint16_t)ceilf(ms / bfPeriodMs);
+}
+
+/*!
+    @brief      Debounce of a condition that must last ms: it fires at the window after the count
+*/
+static uint16_t bfDebounce(float ms){
+    uint16_t windows = bfWindows(ms);
+    return windows > 0 ? windows - 1 : 0;
+}
+
+static float* bfField(BssConfig_t* config, uint8_t param){
+    return (float*)((char*)config + bfParams[param].offset);
+}
+
+/*!
+    @brief      Timings of the tables from the configuration
+*/
+static void bfApply(void){
+    uint8_t i;
+    bfStates[CLASS_BRAKING].minDwell = bfWindows(bfConfig.brakeMinMs);
+    bfStates[CLASS_ERROR].minDwell = bfWindows(bfConfig.errorMinMs);
+    for(i = 0; i < BF_TRANSITION_COUNT; ++i){
+        if(bfTransitions[i].guard == bfHot){
+            bfTransitions[i].debounce = bfDebounce(bfConfig.errorDebounceMs);
+        }else if((bfTransitions[i].guard == bfDark || bfTransitions[i].guard == bfBright) &&
+                 bfTransitions[i].from != CLASS_IDLE){
+            bfTransitions[i].debounce = bfDebounce(bfConfig.lightDebounceMs);
+        }
+    }
+}
+
+/*!
+    @brief      Thresholds of the classifier before the state machine
+*/
+void bssFsmDefaultConfig(BssConfig_t* config){
+    config->brakeAcc = ACC_THREASHOLD;
+    config->brakeRelease = 0.1f;
+    config->brakeMinMs = NUM_FLASH * FLASH_PERIOD_MS;
+    config->lightOn = LIGHT_THREASHOLD;
+    config->lightHysteresis = 5.0f;
+    config->lightDebounceMs = 1000.0f;
+    config->tMax = T_MAX;
+    config->tHysteresis = 5.0f;
+    config->errorDebounceMs = 300.0f;
+    config->errorMinMs = NUM_FLASH * FLASH_PERIOD_MS;
+}
+
+/*!
+    @brief      Default configuration and start in CLASS_IDLE
+*/
+void bssFsmInit(void){
+    bssFsmDefaultConfig(&bfConfig);
+    bfPeriodMs = FLASH_PERIOD_MS;
+    bfDwellBase = 0;
+    bfApply();
+    memset(bfEntries, 0, sizeof(bfEntries));
+    memset(bfMs, 0, sizeof(bfMs));
+    fsmInit(&bfFsm, bfStates, BSS_CLASS_COUNT, bfTransitions, BF_TRANSITION_COUNT, CLASS_IDLE, &bfInputs);
+}
+
+/*!
+    @brief      One BSS window
+    @param      model: averages of the window, temperature and light
+    @param      crash: a crash is detected (see crash.h)
+    @return     class of the bike
+*/
+class_t bssFsmStep(const model_t* model, bool crash){
+    bfInputs.model = model;
+    bfInputs.crash = crash;
+    fsmStep(&bfFsm);
+    return (class_t)fsmGetState(&bfFsm);
+}
+
+class_t bssFsmGetClass(void){
+    return (class_t)fsmGetState(&bfFsm);
+}
+
+/*!
+    @brief      Windows since the entry in the current class, the tick of its pattern
+*/
+uint16_t bssFsmGetDwell(void){
+    return fsmGetDwell(&bfFsm);
+}
+
+const BssPattern_t* bssFsmGetPattern(class_t state){
+    return &bfPatterns[state < BSS_CLASS_COUNT ? state : CLASS_IDLE];
+}
+
+/*!
+    @brief      Entries in a class and time spent in it since the init
+    @param      state: class
+    @param      entries: number of entries
+    @param      ms: time in the class [ms]
+*/
+void bssFsmGetStats(class_t state, uint32_t* entries, uint32_t* ms){
+    if(state >= BSS_CLASS_COUNT){
+        *entries = 0;
+        *ms = 0;
+        return;
+    }
+    *entries = bfEntries[state];
+    *ms = bfMs[state];
+    if(fsmGetState(&bfFsm) == state){
+        *ms += (uint32_t)(fsmGetDwell(&bfFsm) - bfDwellBase) * bfPeriodMs;
+    }
+}
+
+/*!
+    @brief      New BSS window, from the next step
+    @details    The durations of the configuration are converted again in windows of the new period,
+                the time already spent in the current class is counted with the old one.
+    @param      ms: period of the flashing timer [ms]
+*/
+void bssFsmSetPeriod(uint16_t ms){
+    class_t state = (class_t)fsmGetState(&bfFsm);
+    if(ms == 0 || ms == bfPeriodMs){
+        return;
+    }
+    bfMs[state] += (uint32_t)(fsmGetDwell(&bfFsm) - bfDwellBase) * bfPeriodMs;
+    bfDwellBase = fsmGetDwell(&bfFsm);
+    bfPeriodMs = ms;
+    bfApply();
+}
+
+uint16_t bssFsmGetPeriod(void){
+    return bfPeriodMs;
+}
+
+void bssFsmGetConfig(BssConfig_t* config){
+    *config = bfConfig;
+}
+
+/*!
+    @brief      New thresholds, used from the next window
+    @return     false if a value is out of its range: the configuration is not changed
+*/
+bool bssFsmSetConfig(const BssConfig_t* config){
+    BssConfig_t copy = *config;
+    uint8_t i;
+    for(i = 0; i < BF_PARAM_COUNT; ++i){
+        float value = *bfField(&copy, i);
+        if(!(value >= bfParams[i].min && value <= bfParams[i].max)){
+            return false;
+        }
+    }
+    bfConfig = copy;
+    bfApply();
+    return true;
+}
+
+/*!
+    @brief      Line of the configuration file for a parameter
+    @param      buf: destination buffer, at least @ref BSS_CONFIG_LINE_LEN bytes
+    @param      size: size of the buffer, terminator included
+    @param      config: configuration
+    @param      param: index of the parameter
+    @return     length of the line, 0 after the last parameter or if it does not fit
+*/
+size_t bssFsmFormatParam(char* buf, size_t size, const BssConfig_t* config, uint8_t param){
+    char value[16];
+    size_t nameLen, valueLen;
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    buf[0] = '\0';
+    if(param >= BF_PARAM_COUNT){
+        return 0;
+    }
+    nameLen = strlen(bfParams[param].name);
+    valueLen = numFormatFloat(value, sizeof(value), *bfField((BssConfig_t*)config, param), bfParams[param].digits);
+    if(valueLen == 0 || nameLen + valueLen + 3 > size){
+        return 0;
+    }
+    memcpy(buf, bfParams[param].name, nameLen);
+    buf[nameLen] = ',';
+    memcpy(buf + nameLen + 1, value, valueLen);
+    buf[nameLen + 1 + valueLen] = '\n';
+    buf[nameLen + 2 + valueLen] = '\0';
+    return nameLen + 2 + valueLen;
+}
+
+/*!
+    @brief      Set a parameter from a line of the configuration file
+    @param      config: configuration to change
+    @param      line: "name,value", the header and unknown names are ignored
+    @return     true if the parameter has been set, in its range
+*/
+bool bssFsmParseParam(BssConfig_t* config, const char* line){
+    const char* comma = strchr(line, ',');
+    char* end;
+    float value;
+    uint8_t i;
+    if(comma == NULL){
+        return false;
+    }
+    for(i = 0; i < BF_PARAM_COUNT; ++i){
+        size_t len = strlen(bfParams[i].name);
+        if((size_t)(comma - line) == len && strncmp(line, bfParams[i].name, len) == 0){
+            break;
+        }
+    }
+    if(i == BF_PARAM_COUNT){
+        return false;
+    }
+    value = strtof(comma + 1, &end);
+    if(end == comma + 1 || (*end != '\0' && *end != '\r' && *end != '\n') ||
+       !(value >= bfParams[i].min && value <= bfParams[i].max)){
+        return false;
+    }
+    *bfField(config, i) = value;
+    return true;
+}
+
+/*! @} */ //End of BssFsm_Module
@@ -0,0 +1,109 @@
+/*!
+    @file       bssFsm.h
+    @ingroup    BssFsm_Module
+    @brief      State machine of the BSS: classes, thresholds and patterns of lights and buzzer
+    @details    The classes of BSS.h are the states of a table-driven machine (see fsm.h), stepped
+                once per BSS window. A state lasts until one of its transitions fires, it does not
+                go back to CLASS_IDLE at every window:
+                - crash: from every state, also during the minimum dwell;
+                - error: sensor over @ref BssConfig_t tMax for errorDebounceMs, it ends below tMax
+                  minus tHysteresis after errorMinMs;
+                - braking: window average below brakeAcc, at once; it flashes for brakeMinMs at
+                  least and ends above brakeAcc plus brakeRelease;
+                - low ambient light and moving: light below lightOn or above lightOn plus
+                  lightHysteresis for lightDebounceMs.
+                CLASS_IDLE is only the start and the way out of error, braking and crash, so the
+                next window chooses between moving and low ambient light at once.
+                The thresholds are a @ref BssConfig_t that can be changed at run time, each one in
+                its range, and saved as "name,value" lines in @ref BSS_CONFIG_FILE. The durations
+                are rounded up to BSS windows of @ref FLASH_PERIOD_MS, or of the longer window set by
+                the power governor with @ref bssFsmSetPeriod.
+                The lights and the buzzer are not driven by the states: every state has a pattern
+                of @ref BSS_PATTERN_TICKS ticks that the flashing timer plays from the entry in the
+                state, and a @ref BssLight_t for each light that the PWM engine of lights.h turns
+                into brightness levels, ramps and pulses. The entry and exit actions count the
+                entries and the time in each state.
+                The module does not depend on the hardware: Test/bssFsm.py runs the same machine on
+                synthetic windows and compares it with the classifier it replaces.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __BSS_FSM_H__
+#define __BSS_FSM_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Local Includes */
+#include "BSS.h"
+
+/*!
+    @defgroup   BssFsm_Module BSS State Machine
+    @name       BSS State Machine Module
+    @{
+*/
+
+#define BSS_CLASS_COUNT             (CLASS_CRASH + 1)
+#define BSS_PATTERN_TICKS           8           //!< Ticks of FLASH_PERIOD_MS of a pattern
+#define BSS_OUT_REAR                0x01u       //!< Rear light
+#define BSS_OUT_FRONT               0x02u       //!< Front light
+#define BSS_OUT_BUZZER              0x04u       //!< Buzzer
+
+#define BSS_CONFIG_FILE             "BSS.CSV"   //!< Saved thresholds
+#define BSS_CONFIG_HEADER           "name,value\n"
+#define BSS_CONFIG_LINE_LEN         40          //!< Buffer size for a line of the thresholds
+
+//! Thresholds and durations of the transitions
+typedef struct{
+    float brakeAcc;                             //!< Braking: window average below this [g]
+    float brakeRelease;                         //!< Braking ends above brakeAcc + this [g]
+    float brakeMinMs;                           //!< Shortest braking flash [ms]
+    float lightOn;                              //!< Lights on: ambient light below this
+    float lightHysteresis;                      //!< Lights off: ambient light above lightOn + this
+    float lightDebounceMs;                      //!< Light beyond the threshold for this long [ms]
+    float tMax;                                 //!< Error: sensor temperature above this [C]
+    float tHysteresis;                          //!< Error ends below tMax - this [C]
+    float errorDebounceMs;                      //!< Temperature above tMax for this long [ms]
+    float errorMinMs;                           //!< Shortest error signal [ms]
+} BssConfig_t;
+
+//! Drive of a light in a state, the levels are in lights.h
+typedef enum{
+    BSS_LIGHT_OFF,
+    BSS_LIGHT_STEADY,                           //!< Front: level of the ambient light, rear: tail level
+    BSS_LIGHT_BLINK,                            //!< Full brightness in the ticks of the pattern, off in the others
+    BSS_LIGHT_FLASH,                            //!< Daytime flash in the ticks of the pattern: front at day level, rear soft pulse
+    BSS_LIGHT_BRAKE,                            //!< Rear: ramp to full brightness at the entry, back to the next drive at the exit
+} BssLight_t;
+
+//! Pattern of the outputs in a state, bit i for the tick i from the entry
+typedef struct{
+    uint8_t rear;
+    uint8_t front;
+    uint8_t buzzer;
+    uint8_t keep;                               //!< Outputs left as they are, BSS_OUT_*
+    uint8_t rearDrive;                          //!< @ref BssLight_t of the rear light
+    uint8_t frontDrive;                         //!< @ref BssLight_t of the front light
+} BssPattern_t;
+
+void bssFsmInit(void);
+class_t bssFsmStep(const model_t* model, bool crash);
+class_t bssFsmGetClass(void);
+uint16_t bssFsmGetDwell(void);
+const BssPattern_t* bssFsmGetPattern(class_t state);
+void bssFsmGetStats(class_t state, uint32_t* entries, uint32_t* ms);
+void bssFsmSetPeriod(uint16_t ms);
+uint16_t bssFsmGetPeriod(void);
+
+void bssFsmGetConfig(BssConfig_t* config);
+bool bssFsmSetConfig(const BssConfig_t* config);
+void bssFsmDefaultConfig(BssConfig_t* config);
+size_t bssFsmFormatParam(char* buf, size_t size, const BssConfig_t* config, uint8_t param);
+bool bssFsmParseParam(BssConfig_t* config, const char* line);
+
+/*! @} */ //End of BssFsm_Module
+
+#endif // __BSS_FSM_H__
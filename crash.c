@@ -0,0 +1,345 @@
+/*!
+    @file       crash.c
+    @ingroup    Crash_Module
+    @brief      Crash and fall detection with a black box of the accelerations before the event implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/* Local Includes */
+#include "crash.h"
+#include "numFormat.h"
+
+#ifndef SIMULATE_HARDWARE
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#define CRASH_BARRIER()     __DMB()
+#else
+#define CRASH_BARRIER()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/*!
+    @addtogroup Crash_Module
+    @{
+*/
+
+#define CRASH_DEG_TO_RAD            0.017453292f
+#define CRASH_RING_MASK             (CRASH_RING_SIZE - 1u)
+
+static CrashState_t crState = CRASH_IDLE;
+static float crPeriod;                      //!< Sample period [s]
+static float crCountsPerG;
+
+//Thresholds on the squared counts, no square root per sample
+static uint32_t crImpact2;
+static uint32_t crStillLow2;
+static uint32_t crStillHigh2;
+static float crCosTilt2;
+static float crCosUpright2;
+static uint32_t crTiltSamples;
+static uint32_t crConfirmSamples;
+
+//Black box: written only by crashAddSample, read only while frozen
+static int16_t crRing[CRASH_RING_SIZE][3];
+static volatile uint32_t crHead;            //!< Samples written, free running
+static volatile bool crFrozen;
+static uint32_t crImpactHead;               //!< Index of the impact sample
+
+//Detector
+static bool crWheelStopped;
+static bool crUnsaved;
+static uint32_t crSinceImpact;              //!< Samples after the impact
+static uint32_t crPeak2;
+static uint32_t crLying;                    //!< Consecutive lying samples
+static uint32_t crUpright;                  //!< Consecutive upright samples with the wheel turning
+static float crTilt;                        //!< Tilt of the last lying sample [deg]
+
+/*!
+    @brief      Restart the detector and empty the black box
+    @param      period: sample period of the IMU [s]
+    @param      countsPerG: scale of the raw accelerations
+*/
+void crashReset(float period, float countsPerG){
+    float cosTilt = cosf(CRASH_TILT_DEG * CRASH_DEG_TO_RAD);
+    float cosUpright = cosf(CRASH_UPRIGHT_DEG * CRASH_DEG_TO_RAD);
+    float still = CRASH_STILL_GATE * countsPerG;
+    float impact = CRASH_IMPACT_G * countsPerG;
+
+    crPeriod = period;
+    crCountsPerG = countsPerG;
+    crImpact2 = (uint32_t)(impact * impact);
+    crStillLow2 = (uint32_t)((countsPerG - still) * (countsPerG - still));
+    crStillHigh2 = (uint32_t)((countsPerG + still) * (countsPerG + still));
+    crCosTilt2 = cosTilt * cosTilt;
+    crCosUpright2 = cosUpright * cosUpright;
+    crTiltSamples = (uint32_t)(CRASH_TILT_S / period + 0.5f);
+    crConfirmSamples = (uint32_t)(CRASH_CONFIRM_S / period + 0.5f);
+
+    crState = CRASH_IDLE;
+    crHead = 0;
+    crFrozen = false;
+    crWheelStopped = false;
+    crUnsaved = false;
+}
+
+/*!
+    @brief      Sample of the accelerometer in the bike frame
+    @details    Called at every sample of the FIFO: the ring store and a few integer operations
+                while riding, the orientation is checked only after an impact.
+    @param      accel: x, y, z raw counts
+*/
+void crashAddSample(const int16_t accel[3]){
+    uint32_t head = crHead;
+    uint32_t norm2 = (uint32_t)((int32_t)accel[0] * accel[0]) + (uint32_t)((int32_t)accel[1] * accel[1]) +
+                     (uint32_t)((int32_t)accel[2] * accel[2]);
+    bool still = norm2 >= crStillLow2 && norm2 <= crStillHigh2;
+    float up2 = (float)accel[2] * accel[2];
+
+    if(!crFrozen){
+        crRing[head & CRASH_RING_MASK][0] = accel[0];
+        crRing[head & CRASH_RING_MASK][1] = accel[1];
+        crRing[head & CRASH_RING_MASK][2] = accel[2];
+        //The sample must be stored before it is published
+        CRASH_BARRIER();
+        crHead = head + 1;
+    }
+
+    switch(crState){
+        case CRASH_IDLE:
+            if(norm2 > crImpact2){
+                crState = CRASH_IMPACT;
+                crSinceImpact = 0;
+                crPeak2 = norm2;
+                crLying = 0;
+                //A record not saved yet keeps the ring: the alert works, the record is the older one
+                if(!crFrozen){
+                    crImpactHead = head;
+                }
+            }
+            break;
+        case CRASH_IMPACT:
+            if(norm2 > crPeak2){
+                crPeak2 = norm2;
+            }
+            if(++crSinceImpact >= CRASH_POST_SAMPLES){
+                crFrozen = true;
+            }
+            //Gravity farther than CRASH_TILT_DEG from z: z below cos * |a|, z negative upside down
+            if(still){
+                if(accel[2] <= 0 || up2 < crCosTilt2 * (float)norm2){
+                    ++crLying;
+                    crTilt = acosf((float)accel[2] / sqrtf((float)norm2)) / CRASH_DEG_TO_RAD;
+                }else{
+                    crLying = 0;
+                }
+            }
+            if(crLying >= crTiltSamples && crWheelStopped){
+                crState = CRASH_DETECTED;
+                crFrozen = true;
+                crUnsaved = true;
+                crUpright = 0;
+            }else if(crSinceImpact >= crConfirmSamples){
+                //A bump or a hard braking: back to recording
+                crState = CRASH_IDLE;
+                crFrozen = crUnsaved;
+            }
+            break;
+        case CRASH_DETECTED:
+            if(still){
+                if(!crWheelStopped && accel[2] > 0 && up2 > crCosUpright2 * (float)norm2){
+                    ++crUpright;
+                }else{
+                    crUpright = 0;
+                }
+            }
+            if(crUpright >= crTiltSamples){
+                crState = CRASH_IDLE;
+            }
+            break;
+    }
+}
+
+/*!
+    @brief      Speed of the wheel, at every BSS window
+    @param      speed: [m/s], 0 if the wheel is silent
+*/
+void crashSetSpeed(float speed){
+    crWheelStopped = speed < CRASH_STOP_SPEED;
+}
+
+/*!
+    @brief      End the alert, the record is kept until it is saved
+*/
+void crashClear(void){
+    if(crState != CRASH_IDLE){
+        crState = CRASH_IDLE;
+        crFrozen = crUnsaved;
+    }
+}
+
+CrashState_t crashGetState(void){
+    return crState;
+}
+
+bool crashIsDetected(void){
+    return crState == CRASH_DETECTED;
+}
+
+/*!
+    @brief      A record is waiting to be saved
+*/
+bool crashIsUnsaved(void){
+    return crUnsaved;
+}
+
+/*!
+    @brief      The record has been saved: the ring records again
+*/
+void crashSetSaved(void){
+    crUnsaved = false;
+    if(crState != CRASH_IMPACT){
+        crFrozen = false;
+    }
+}
+
+/*!
+    @brief      Summary of the crash of the record
+    @return     false if there is no record
+*/
+bool crashGetEvent(CrashEvent_t* event){
+    uint32_t head = crHead;
+    uint32_t samples = head < CRASH_RING_SIZE ? head : CRASH_RING_SIZE;
+    if(!crUnsaved){
+        return false;
+    }
+    event->peak = sqrtf((float)crPeak2) / crCountsPerG;
+    event->tilt = crTilt;
+    event->samples = (uint16_t)samples;
+    event->preSamples = (uint16_t)(crImpactHead - (head - samples));
+    return true;
+}
+
+/*!
+    @brief      Sample of the record, the oldest first
+    @param      sample: index, below the samples of @ref crashGetEvent
+    @param      accel: x, y, z raw counts
+    @return     false if there is no record or the index is out of it
+*/
+bool crashGetSample(uint16_t sample, int16_t accel[3]){
+    uint32_t head = crHead;
+    uint32_t samples = head < CRASH_RING_SIZE ? head : CRASH_RING_SIZE;
+    uint32_t index = (head - samples + sample) & CRASH_RING_MASK;
+    if(!crUnsaved || !crFrozen || sample >= samples){
+        return false;
+    }
+    accel[0] = crRing[index][0];
+    accel[1] = crRing[index][1];
+    accel[2] = crRing[index][2];
+    return true;
+}
+
+static char* crPutField(char* p, char* end, const char* field, char separator){
+    size_t len = strlen(field);
+    if(p == NULL || (size_t)(end - p) < len + 1){
+        return NULL;
+    }
+    memcpy(p, field, len);
+    p += len;
+    *p++ = separator;
+    return p;
+}
+
+/*!
+    @brief      Line of the record with the summary of the crash
+    @details    The fields are the ones of @ref CRASH_EVENT_HEADER, the position is empty without a fix.
+    @param      buf: destination buffer, at least @ref CRASH_LINE_LEN bytes
+    @param      size: size of the buffer, terminator included
+    @param      time: time of the crash
+    @param      ride: file of the ride
+    @param      fix: the position is valid
+    @param      latitude: [deg]
+    @param      longitude: [deg]
+    @return     length of the line, 0 if there is no record or it does not fit
+*/
+size_t crashFormatEvent(char* buf, size_t size, const char* time, const char* ride, bool fix, float latitude, float longitude){
+    CrashEvent_t event;
+    char field[NUMFORMAT_COORDINATE_LEN];
+    char* end = buf + size - 1;
+    char* p = buf;
+
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    buf[0] = '\0';
+    if(!crashGetEvent(&event)){
+        return 0;
+    }
+    p = crPutField(p, end, time, ',');
+    p = crPutField(p, end, ride, ',');
+    field[0] = '\0';
+    if(fix){
+        numFormatCoordinate(field, sizeof(field), latitude);
+    }
+    p = crPutField(p, end, field, ',');
+    if(fix){
+        numFormatCoordinate(field, sizeof(field), longitude);
+    }
+    p = crPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), event.peak, 1);
+    p = crPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), event.tilt, 0);
+    p = crPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), event.samples, 1);
+    p = crPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), event.preSamples, 1);
+    p = crPutField(p, end, field, '\n');
+    if(p == NULL){
+        buf[0] = '\0';
+        return 0;
+    }
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/*!
+    @brief      Line of the record for a sample: time from the impact [ms] and accelerations [g]
+    @param      buf: destination buffer, at least @ref CRASH_LINE_LEN bytes
+    @param      size: size of the buffer, terminator included
+    @param      sample: index of the sample, the oldest first
+    @return     length of the line, 0 if the sample is not in the record or it does not fit
+*/
+size_t crashFormatSample(char* buf, size_t size, uint16_t sample){
+    CrashEvent_t event;
+    int16_t accel[3];
+    char field[16];
+    char* end = buf + size - 1;
+    char* p = buf;
+    uint8_t i;
+
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    buf[0] = '\0';
+    if(!crashGetEvent(&event) || !crashGetSample(sample, accel)){
+        return 0;
+    }
+    numFormatInt(field, sizeof(field), (int32_t)lroundf(((int32_t)sample - event.preSamples) * crPeriod * 1000.0f), 1);
+    p = crPutField(p, end, field, ',');
+    for(i = 0; i < 3; ++i){
+        numFormatFixed(field, sizeof(field), (int32_t)lroundf(accel[i] * 1000.0f / crCountsPerG), 3);
+        p = crPutField(p, end, field, i < 2 ? ',' : '\n');
+    }
+    if(p == NULL){
+        buf[0] = '\0';
+        return 0;
+    }
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/*! @} */ //End of Crash_Module
@@ -0,0 +1,89 @@
+/*!
+    @file       crash.h
+    @ingroup    Crash_Module
+    @brief      Crash and fall detection with a black box of the accelerations before the event
+    @details    A crash is the sequence:
+                - an impact: the acceleration of a sample above @ref CRASH_IMPACT_G;
+                - then, within @ref CRASH_CONFIRM_S, the bike lying: the gravity farther than
+                  @ref CRASH_TILT_DEG from the z axis of the bike for @ref CRASH_TILT_S, counting only
+                  the samples within @ref CRASH_STILL_GATE of 1 g, with the wheel stopped.
+                A pothole or a hard braking has the impact but not the orientation, a bike laid
+                down at a stop has the orientation but not the impact.
+                Every sample of the MPU6050, already in the bike frame, is stored in a ring of
+                @ref CRASH_RING_SIZE samples: the raw counts, a store and an index increment, and no
+                other work while riding. At the impact the ring goes on for @ref CRASH_POST_SAMPLES
+                samples and then it is frozen, so it keeps the seconds before the impact and the
+                first second after it. Only the producer writes the index and the samples are
+                published after a memory barrier, as in Hardware/RingBuffer.h: the reader of a
+                frozen ring needs no lock. The ring is released when the record has been saved or
+                the impact is not confirmed.
+                The alert lasts until @ref crashClear or until the bike is upright again for
+                @ref CRASH_TILT_S with the wheel turning.
+                The module does not depend on the hardware: Test/crash.py runs the same detector
+                on synthetic crash traces and on the rides of Test/attitude.py.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __CRASH_H__
+#define __CRASH_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    @defgroup   Crash_Module Crash Detection
+    @name       Crash Detection Module
+    @{
+*/
+
+#define CRASH_IMPACT_G              3.0f        //!< Impact: acceleration above this [g]
+#define CRASH_TILT_DEG              60.0f       //!< Lying: gravity farther than this from the bike z axis [deg]
+#define CRASH_UPRIGHT_DEG           30.0f       //!< Upright again: gravity closer than this [deg]
+#define CRASH_STILL_GATE            0.3f        //!< Orientation samples within 1 g +- this [g]
+#define CRASH_TILT_S                2.0f        //!< Duration of the orientation [s]
+#define CRASH_CONFIRM_S             10.0f       //!< Impacts not confirmed in this time are dropped [s]
+#define CRASH_STOP_SPEED            0.5f        //!< Slower the wheel is stopped [m/s]
+
+#define CRASH_RING_SIZE             256u        //!< Samples of the black box, power of two (3.8 s at 66.7 Hz)
+#define CRASH_POST_SAMPLES          64u         //!< Samples kept after the impact
+
+#define CRASH_FILE_NAME             "crash%d.csv" //!< Record of a crash, numbered as the rides
+#define CRASH_EVENT_HEADER          "time,ride,latitude,longitude,peak_g,tilt_deg,samples,pre_samples\n"
+#define CRASH_SAMPLES_HEADER        "t_ms,ax,ay,az\n"
+#define CRASH_LINE_LEN              112         //!< Buffer size for a line of the record
+
+//! State of the detector
+typedef enum{
+    CRASH_IDLE = 0,                             //!< Riding, the ring is recording
+    CRASH_IMPACT,                               //!< Impact seen, waiting for the orientation
+    CRASH_DETECTED,                             //!< Crash, alert on
+} CrashState_t;
+
+//! Summary of a crash
+typedef struct{
+    float peak;                                 //!< Largest acceleration [g]
+    float tilt;                                 //!< Angle between the gravity and the bike z axis [deg]
+    uint16_t samples;                           //!< Samples in the record
+    uint16_t preSamples;                        //!< Samples before the impact
+} CrashEvent_t;
+
+void crashReset(float period, float countsPerG);
+void crashAddSample(const int16_t accel[3]);
+void crashSetSpeed(float speed);
+void crashClear(void);
+
+CrashState_t crashGetState(void);
+bool crashIsDetected(void);
+bool crashIsUnsaved(void);
+void crashSetSaved(void);
+bool crashGetEvent(CrashEvent_t* event);
+bool crashGetSample(uint16_t sample, int16_t accel[3]);
+size_t crashFormatEvent(char* buf, size_t size, const char* time, const char* ride, bool fix, float latitude, float longitude);
+size_t crashFormatSample(char* buf, size_t size, uint16_t sample);
+
+/*! @} */ //End of Crash_Module
+
+#endif // __CRASH_H__
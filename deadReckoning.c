@@ -0,0 +1,225 @@
+/*!
+    @file       deadReckoning.c
+    @ingroup    DeadReckoning_Module
+    @brief      Continuation of the track while the GPS has no fix implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+/* Local Includes */
+#include "deadReckoning.h"
+
+/*!
+    @addtogroup DeadReckoning_Module
+    @{
+*/
+
+#define DR_EARTH_RADIUS             6371000.0f          //!< [m]
+#define DR_DEG_TO_RAD               0.017453292f
+#define DR_RAD_TO_DEG               57.29578f
+
+//Last fix
+static bool drFixSeen = false;
+static uint32_t drFixMs;
+static bool drCourseValid;
+static float drCourse;                      //!< Course of the last fix fast enough [deg]
+
+//Estimate
+static bool drLost;
+static float drLatitude;
+static float drLongitude;
+static float drHeading;                     //!< [deg], clockwise from the north
+static float drTurnRate;                    //!< [deg/s]
+static uint32_t drLastMs;
+static float drLastDistance;                //!< Distance of the wheel at the last point [m]
+static float drTotal;                       //!< Distance from the last fix [m]
+
+//Yaw rate input
+static bool drYawSeen;
+static uint32_t drYawMs;
+static float drYawRate;
+
+static DrPoint_t drPoints[DR_MAX_POINTS];
+static uint8_t drCount;
+
+/*!
+    @brief      Angle in (-180, 180]
+*/
+static float drWrap(float angle){
+    while(angle > 180.0f){
+        angle -= 360.0f;
+    }
+    while(angle <= -180.0f){
+        angle += 360.0f;
+    }
+    return angle;
+}
+
+/*!
+    @brief      Start of a new ride, the fixes and the points are forgotten
+*/
+void deadReckoningReset(void){
+    drFixSeen = false;
+    drCourseValid = false;
+    drLost = false;
+    drYawSeen = false;
+    drCount = 0;
+}
+
+/*!
+    @brief      Valid fix, the start of the next estimate
+    @details    Without a fix, @ref deadReckoningReconcile and @ref deadReckoningClear must be called
+                before this function for the estimated points.
+    @param      nowMs: time of the fix [ms]
+    @param      latitude: [deg]
+    @param      longitude: [deg]
+    @param      course: course over ground [deg]
+    @param      speed: GPS speed [m/s], the course of the slow fixes is not used
+    @param      distance: distance of the wheel [m]
+*/
+void deadReckoningAddFix(uint32_t nowMs, float latitude, float longitude, float course, float speed, float distance){
+    if(speed >= DR_MIN_COURSE_SPEED){
+        if(drCourseValid && drFixSeen && nowMs - drFixMs <= DR_MAX_FIX_GAP_MS && nowMs != drFixMs){
+            drTurnRate = drWrap(course - drCourse) * 1000.0f / (float)(nowMs - drFixMs);
+        }else{
+            drTurnRate = 0;
+        }
+        drCourse = course;
+        drCourseValid = true;
+    }else{
+        drTurnRate = 0;
+    }
+    drFixSeen = true;
+    drFixMs = nowMs;
+    drLost = false;
+    drLatitude = latitude;
+    drLongitude = longitude;
+    drHeading = drCourse;
+    drLastMs = nowMs;
+    drLastDistance = distance;
+    drTotal = 0;
+}
+
+/*!
+    @brief      Yaw rate of the gyroscope
+    @param      nowMs: time of the sample [ms]
+    @param      yawRate: [deg/s], positive turning right (clockwise seen from above)
+*/
+void deadReckoningAddYawRate(uint32_t nowMs, float yawRate){
+    drYawSeen = true;
+    drYawMs = nowMs;
+    drYawRate = yawRate;
+}
+
+/*!
+    @brief      Propagate the estimate without a fix
+    @details    The heading is updated at every call, a point is added when the wheel has travelled
+                at least @ref DR_MIN_STEP meters from the last point.
+    @param      nowMs: current time [ms]
+    @param      distance: distance of the wheel [m]
+    @param      altitude: altitude of the point [m]
+    @param      time: time of the point
+    @param      ms: milliseconds of the time
+    @return     @ref DR_POINT if a point has been added, @ref DR_LOST without an estimate
+*/
+DrResult_t deadReckoningStep(uint32_t nowMs, float distance, float altitude, RtcTime_t time, uint16_t ms){
+    if(!drFixSeen || !drCourseValid || drLost){
+        return DR_LOST;
+    }
+    if(nowMs - drFixMs > DR_MAX_TIME_MS){
+        drLost = true;
+        return DR_LOST;
+    }
+    float dt = (float)(nowMs - drLastMs) / 1000.0f;
+    drLastMs = nowMs;
+    if(drYawSeen && nowMs - drYawMs <= DR_YAW_TIMEOUT_MS){
+        drHeading += drYawRate * dt;
+    }else{
+        drHeading += drTurnRate * dt;
+        drTurnRate *= dt < DR_TURN_FADE_S ? 1.0f - dt / DR_TURN_FADE_S : 0.0f;
+    }
+    drHeading = drWrap(drHeading);
+
+    float step = distance - drLastDistance;
+    if(step < DR_MIN_STEP){
+        return DR_IDLE;
+    }
+    drLastDistance = distance;
+    drTotal += step;
+    if(drCount >= DR_MAX_POINTS || drTotal > DR_MAX_DISTANCE){
+        drLost = true;
+        return DR_LOST;
+    }
+    drLatitude += step * cosf(drHeading * DR_DEG_TO_RAD) / DR_EARTH_RADIUS * DR_RAD_TO_DEG;
+    drLongitude += step * sinf(drHeading * DR_DEG_TO_RAD) / (DR_EARTH_RADIUS * cosf(drLatitude * DR_DEG_TO_RAD)) * DR_RAD_TO_DEG;
+
+    DrPoint_t* point = &drPoints[drCount++];
+    point->latitude = drLatitude;
+    point->longitude = drLongitude;
+    point->altitude = altitude;
+    point->distance = drTotal;
+    point->time = time;
+    point->ms = ms;
+    return DR_POINT;
+}
+
+/*!
+    @brief      There are estimated points not written yet
+*/
+bool deadReckoningIsActive(void){
+    return drCount > 0;
+}
+
+uint8_t deadReckoningGetCount(void){
+    return drCount;
+}
+
+/*!
+    @brief      An estimated point
+    @param      point: index of the point, from 0
+    @param      data: destination
+    @return     false if the point does not exist
+*/
+bool deadReckoningGetPoint(uint8_t point, DrPoint_t* data){
+    if(point >= drCount){
+        return false;
+    }
+    *data = drPoints[point];
+    return true;
+}
+
+/*!
+    @brief      Blend the estimated points to the fix that came back
+    @details    The error of the estimate at the fix is spread in proportion to the distance of the
+                points from the last fix: the first point almost does not move, the last one moves
+                by nearly the whole error.
+    @param      latitude: the new fix [deg]
+    @param      longitude: the new fix [deg]
+*/
+void deadReckoningReconcile(float latitude, float longitude){
+    if(drLost || drTotal <= 0){
+        return;
+    }
+    float dLatitude = latitude - drLatitude;
+    float dLongitude = longitude - drLongitude;
+    uint8_t i;
+    for(i = 0; i < drCount; ++i){
+        float weight = drPoints[i].distance / drTotal;
+        drPoints[i].latitude += dLatitude * weight;
+        drPoints[i].longitude += dLongitude * weight;
+    }
+}
+
+/*!
+    @brief      Forget the estimated points, after they are written
+*/
+void deadReckoningClear(void){
+    drCount = 0;
+}
+
+/*! @} */ //End of DeadReckoning_Module
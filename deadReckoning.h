@@ -0,0 +1,79 @@
+/*!
+    @file       deadReckoning.h
+    @ingroup    DeadReckoning_Module
+    @brief      Continuation of the track while the GPS has no fix
+    @details    Without a fix the position is propagated with the wheel distance along the course of
+                the last fix. The heading change comes from a yaw rate input (the gyroscope, when it is
+                read) or, without it, from the turn rate of the last fixes, that fades out in
+                @ref DR_TURN_FADE_S seconds. The accelerometer alone cannot give the heading change of
+                a bike: in a turn the bike leans and the lateral acceleration is almost zero in the
+                frame of the sensor.
+                The estimated points are kept in RAM. When the fix comes back, the error between the
+                estimate and the fix is spread on the points in proportion to the distance travelled
+                from the loss of the fix, so the track joins the new fix without a jump, and the points
+                are written flagged as estimated. After @ref DR_MAX_POINTS points or
+                @ref DR_MAX_DISTANCE meters the estimate is too uncertain: the points are written as
+                they are and the track is broken as before; the same after @ref DR_MAX_TIME_MS
+                without a fix, so without a wheel sensor the track is not joined across long gaps.
+                The module does not depend on the hardware: Test/deadReckoning.py runs the same
+                algorithm on a NMEA log with masked fixes to evaluate it, and compares it with this
+                file run by Test/deadReckoningHost.c.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __DEAD_RECKONING_H__
+#define __DEAD_RECKONING_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Local Includes */
+#include "rtc.h"
+
+/*!
+    @defgroup   DeadReckoning_Module Dead Reckoning
+    @name       Dead Reckoning Module
+    @{
+*/
+
+#define DR_MAX_POINTS               120         //!< Estimated points kept until the fix comes back
+#define DR_MAX_DISTANCE             2000.0f     //!< Longest estimated distance [m]
+#define DR_MIN_STEP                 1.0f        //!< Shorter movements do not add a point [m]
+#define DR_MIN_COURSE_SPEED         1.5f        //!< Slower, the GPS course is noise [m/s]
+#define DR_MAX_FIX_GAP_MS           2000u       //!< Longer gaps between two fixes give no turn rate
+#define DR_YAW_TIMEOUT_MS           1000u       //!< Older yaw rates are not used
+#define DR_TURN_FADE_S              5.0f        //!< Time to forget the turn rate of the last fixes
+#define DR_MAX_TIME_MS              120000u     //!< Longest estimate, also without the wheel [ms]
+
+//! Estimated point
+typedef struct{
+    float latitude;                         //!< [deg]
+    float longitude;                        //!< [deg]
+    float altitude;                         //!< [m]
+    float distance;                         //!< Distance from the last fix [m]
+    RtcTime_t time;                         //!< Time of the point
+    uint16_t ms;                            //!< Milliseconds of the time
+} DrPoint_t;
+
+//! Result of a step of the estimate
+typedef enum{
+    DR_IDLE = 0,                            //!< Nothing added, the wheel has not moved
+    DR_POINT,                               //!< A point has been added
+    DR_LOST,                                //!< No estimate: no fix yet or the limits have been reached
+} DrResult_t;
+
+void deadReckoningReset(void);
+void deadReckoningAddFix(uint32_t nowMs, float latitude, float longitude, float course, float speed, float distance);
+void deadReckoningAddYawRate(uint32_t nowMs, float yawRate);
+DrResult_t deadReckoningStep(uint32_t nowMs, float distance, float altitude, RtcTime_t time, uint16_t ms);
+bool deadReckoningIsActive(void);
+uint8_t deadReckoningGetCount(void);
+bool deadReckoningGetPoint(uint8_t point, DrPoint_t* data);
+void deadReckoningReconcile(float latitude, float longitude);
+void deadReckoningClear(void);
+
+/*! @} */ //End of DeadReckoning_Module
+
+#endif // __DEAD_RECKONING_H__
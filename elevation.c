@@ -0,0 +1,327 @@
+/*!
+    @file       elevation.c
+    @ingroup    Elevation_Module
+    @brief      Smoothing of the GPS altitude, grade and climb detection implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+/* Local Includes */
+#include "elevation.h"
+#include "numFormat.h"
+
+/*!
+    @addtogroup Elevation_Module
+    @{
+*/
+
+//Median filter
+static float elevRaw[ELEV_MEDIAN_LEN];
+static uint8_t elevRawCount;
+static uint8_t elevRawHead;
+
+//Kalman filter
+static bool elevValid = false;
+static float elevAltitude;                  //!< Estimate [m]
+static float elevVariance;                  //!< Variance of the estimate [m^2]
+static uint32_t elevLastMs;
+static float elevLastDistance;
+
+//Grade: altitudes sampled along the distance
+static float elevGradeDistance[ELEV_GRADE_SAMPLES];
+static float elevGradeAltitude[ELEV_GRADE_SAMPLES];
+static uint8_t elevGradeCount;
+static uint8_t elevGradeHead;               //!< Next sample to write, the oldest one when full
+static float elevGrade;
+
+//Climbs: the low point is the last point from which the road rises at the minimum grade
+static bool elevClimbing;
+static float elevLowAltitude;
+static float elevLowDistance;
+static uint32_t elevLowMs;
+static float elevHighAltitude;
+static float elevHighDistance;
+static uint32_t elevHighMs;
+static float elevMaxGrade;                  //!< Steepest grade since the low point
+static float elevHighMaxGrade;              //!< Steepest grade up to the high point
+static ElevationClimb_t elevClimbs[ELEV_MAX_CLIMBS];
+static uint8_t elevClimbCount;
+
+/*!
+    @brief      Start a new ride, the filter and the climbs are cleared
+*/
+void elevationStart(void){
+    elevRawCount = 0;
+    elevRawHead = 0;
+    elevValid = false;
+    elevGradeCount = 0;
+    elevGradeHead = 0;
+    elevGrade = 0;
+    elevClimbing = false;
+    elevClimbCount = 0;
+}
+
+/*!
+    @brief      Median of the last raw altitudes
+*/
+static float elevMedian(float altitude){
+    float sorted[ELEV_MEDIAN_LEN];
+    uint8_t i, j;
+
+    elevRaw[elevRawHead] = altitude;
+    elevRawHead = (elevRawHead + 1) % ELEV_MEDIAN_LEN;
+    if(elevRawCount < ELEV_MEDIAN_LEN){
+        elevRawCount++;
+    }
+    //Insertion sort, a handful of values
+    for(i = 0; i < elevRawCount; ++i){
+        float value = elevRaw[i];
+        for(j = i; j > 0 && sorted[j - 1] > value; --j){
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+    if(elevRawCount % 2){
+        return sorted[elevRawCount / 2];
+    }
+    return (sorted[elevRawCount / 2 - 1] + sorted[elevRawCount / 2]) * 0.5f;
+}
+
+/*!
+    @brief      Grade over the last @ref ELEV_GRADE_SPAN meters
+    @details    An altitude is sampled every @ref ELEV_GRADE_STEP meters, the grade is from the oldest
+                sample to the current estimate. Stopped, the grade keeps the last value.
+*/
+static void elevUpdateGrade(float distance){
+    uint8_t newest = (elevGradeHead + ELEV_GRADE_SAMPLES - 1) % ELEV_GRADE_SAMPLES;
+    uint8_t oldest;
+
+    if(elevGradeCount == 0 || distance - elevGradeDistance[newest] >= ELEV_GRADE_STEP){
+        elevGradeDistance[elevGradeHead] = distance;
+        elevGradeAltitude[elevGradeHead] = elevAltitude;
+        elevGradeHead = (elevGradeHead + 1) % ELEV_GRADE_SAMPLES;
+        if(elevGradeCount < ELEV_GRADE_SAMPLES){
+            elevGradeCount++;
+        }
+    }
+    oldest = elevGradeCount < ELEV_GRADE_SAMPLES ? 0 : elevGradeHead;
+    if(distance - elevGradeDistance[oldest] >= ELEV_GRADE_MIN_SPAN){
+        elevGrade = (elevAltitude - elevGradeAltitude[oldest]) * 100.0f / (distance - elevGradeDistance[oldest]);
+    }
+}
+
+/*!
+    @brief      Store the running climb, from the low point to the high point
+*/
+static void elevCloseClimb(void){
+    float length = elevHighDistance - elevLowDistance;
+    elevClimbing = false;
+    if(elevClimbCount >= ELEV_MAX_CLIMBS || length <= 0){
+        return;
+    }
+    ElevationClimb_t* climb = &elevClimbs[elevClimbCount++];
+    climb->startMs = elevLowMs;
+    climb->endMs = elevHighMs;
+    climb->startDistance = elevLowDistance;
+    climb->length = length;
+    climb->gain = elevHighAltitude - elevLowAltitude;
+    climb->avgGrade = climb->gain * 100.0f / length;
+    //A climb shorter than the grade span can be steeper than the grade seen
+    climb->maxGrade = elevHighMaxGrade > climb->avgGrade ? elevHighMaxGrade : climb->avgGrade;
+}
+
+static void elevSetLow(uint32_t nowMs, float distance){
+    elevLowAltitude = elevAltitude;
+    elevLowDistance = distance;
+    elevLowMs = nowMs;
+    elevMaxGrade = 0;
+}
+
+/*!
+    @brief      Climb segmentation on the filtered altitude
+*/
+static void elevUpdateClimb(uint32_t nowMs, float distance){
+    if(!elevClimbing){
+        if(elevAltitude - elevLowAltitude < ELEV_CLIMB_MIN_GRADE * 0.01f * (distance - elevLowDistance)){
+            elevSetLow(nowMs, distance);            //Not rising enough: the climb, if any, starts here
+        }else{
+            if(elevGrade > elevMaxGrade){
+                elevMaxGrade = elevGrade;
+            }
+            if(elevAltitude - elevLowAltitude >= ELEV_CLIMB_MIN_GAIN){
+                elevClimbing = true;
+                elevHighAltitude = elevAltitude;
+                elevHighDistance = distance;
+                elevHighMs = nowMs;
+                elevHighMaxGrade = elevMaxGrade;
+            }
+        }
+        return;
+    }
+    if(elevGrade > elevMaxGrade){
+        elevMaxGrade = elevGrade;
+    }
+    if(elevAltitude > elevHighAltitude){
+        elevHighAltitude = elevAltitude;
+        elevHighDistance = distance;
+        elevHighMs = nowMs;
+        elevHighMaxGrade = elevMaxGrade;
+    }else if(elevHighAltitude - elevAltitude >= ELEV_CLIMB_END_DROP ||
+             distance - elevHighDistance >= ELEV_CLIMB_END_FLAT){
+        elevCloseClimb();
+        elevSetLow(nowMs, distance);
+    }
+}
+
+/*!
+    @brief      New GPS fix
+    @param      nowMs: time of the fix [ms]
+    @param      altitude: GGA altitude [m]
+    @param      vdop: VDOP of the fix, 0 or NAN if not known
+    @param      distance: distance of the ride [m]
+    @return     filtered altitude [m]
+*/
+float elevationAddFix(uint32_t nowMs, float altitude, float vdop, float distance){
+    float z = elevMedian(altitude);
+    float sigma = (vdop > 0 ? vdop : ELEV_DEFAULT_VDOP) * ELEV_SIGMA_PER_VDOP;
+    float r = sigma * sigma;
+
+    if(!elevValid){
+        elevAltitude = z;
+        elevVariance = r;
+        elevValid = true;
+        elevSetLow(nowMs, distance);
+    }else{
+        float dd = distance > elevLastDistance ? distance - elevLastDistance : 0;
+        float dt = (float)(nowMs - elevLastMs) / 1000.0f;
+        float gain;
+        elevVariance += ELEV_GRADE_SIGMA * ELEV_GRADE_SIGMA * dd * dd + ELEV_DRIFT_RATE * dt;
+        gain = elevVariance / (elevVariance + r);
+        elevAltitude += gain * (z - elevAltitude);
+        elevVariance *= 1.0f - gain;
+    }
+    elevLastMs = nowMs;
+    elevLastDistance = distance;
+    elevUpdateGrade(distance);
+    elevUpdateClimb(nowMs, distance);
+    return elevAltitude;
+}
+
+/*!
+    @brief      End of the ride: a climb still running is stored up to its high point
+*/
+void elevationFinish(void){
+    if(elevClimbing){
+        elevCloseClimb();
+    }
+}
+
+bool elevationIsValid(void){
+    return elevValid;
+}
+
+/*!
+    @brief      Filtered altitude [m], NAN before the first fix
+*/
+float elevationGetAltitude(void){
+    return elevValid ? elevAltitude : NAN;
+}
+
+/*!
+    @brief      Grade over the last @ref ELEV_GRADE_SPAN meters [%]
+*/
+float elevationGetGrade(void){
+    return elevGrade;
+}
+
+bool elevationIsClimbing(void){
+    return elevClimbing;
+}
+
+uint8_t elevationGetClimbCount(void){
+    return elevClimbCount;
+}
+
+/*!
+    @brief      A detected climb
+    @param      climb: index of the climb, from 0
+    @param      data: destination
+    @return     false if the climb does not exist
+*/
+bool elevationGetClimb(uint8_t climb, ElevationClimb_t* data){
+    if(climb >= elevClimbCount){
+        return false;
+    }
+    *data = elevClimbs[climb];
+    return true;
+}
+
+/*!
+    @brief      Append a field and the separator
+    @return     position after the separator, NULL if it does not fit
+*/
+static char* elevPutField(char* p, char* end, const char* field, char separator){
+    size_t len = strlen(field);
+    if(p == NULL || (size_t)(end - p) < len + 1){
+        return NULL;
+    }
+    memcpy(p, field, len);
+    p += len;
+    *p++ = separator;
+    return p;
+}
+
+/*!
+    @brief      Line of the climbs file for a climb
+    @details    The fields are the ones of @ref ELEV_CLIMBS_HEADER, the line ends with '\n'.
+    @param      buf: destination buffer
+    @param      size: size of the buffer, terminator included
+    @param      ride: name of the GPX file
+    @param      climb: index of the climb, from 0 (the file counts from 1)
+    @param      rideStartMs: time of the start of the ride [ms], same time base of the fixes
+    @return     number of characters written, 0 if the climb does not exist or the buffer is too small
+*/
+size_t elevationFormatClimb(char* buf, size_t size, const char* ride, uint8_t climb, uint32_t rideStartMs){
+    ElevationClimb_t data;
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    buf[0] = '\0';
+    if(!elevationGetClimb(climb, &data)){
+        return 0;
+    }
+    char field[16];
+    char* end = buf + size - 1;
+    char* p = buf;
+
+    p = elevPutField(p, end, ride, ',');
+    numFormatInt(field, sizeof(field), climb + 1, 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), (int32_t)((data.startMs - rideStartMs) / 1000), 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), data.startDistance, 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), data.length, 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), data.gain, 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), data.avgGrade, 1);
+    p = elevPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), data.maxGrade, 1);
+    p = elevPutField(p, end, field, '\n');
+    if(p == NULL){
+        buf[0] = '\0';
+        return 0;
+    }
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/*! @} */ //End of Elevation_Module
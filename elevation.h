@@ -0,0 +1,88 @@
+/*!
+    @file       elevation.h
+    @ingroup    Elevation_Module
+    @brief      Smoothing of the GPS altitude, grade and climb detection
+    @details    The GGA altitude of the L80 swings by meters even with the receiver standing still, so
+                adding up its changes overcounts the ascent. The pipeline at every fix is:
+                - a median of the last @ref ELEV_MEDIAN_LEN altitudes, that removes the isolated jumps;
+                - a one state Kalman filter: the measurement noise is the VDOP of the GSA sentence
+                  times @ref ELEV_SIGMA_PER_VDOP, the process noise grows with the distance travelled
+                  (at most @ref ELEV_GRADE_SIGMA of grade) plus a small drift in time, so the estimate
+                  holds still while the bike is stopped;
+                - the grade over the last @ref ELEV_GRADE_SPAN meters of distance, from the altitudes
+                  sampled every @ref ELEV_GRADE_STEP meters;
+                - the climb segmentation: a climb starts from the last low point once the road has
+                  risen @ref ELEV_CLIMB_MIN_GAIN meters at @ref ELEV_CLIMB_MIN_GRADE on average and ends
+                  at its high point, once the road has dropped @ref ELEV_CLIMB_END_DROP meters from it
+                  or has not gone higher for @ref ELEV_CLIMB_END_FLAT meters.
+                The distance is the one of the ride statistics: the wheel while it turns, the GPS
+                fixes without the wheel sensor.
+                The module does not depend on the hardware: Test/elevation.py runs the same pipeline
+                on recorded NMEA or GPX traces to evaluate it, and compares it with this file run by
+                Test/elevationHost.c.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __ELEVATION_H__
+#define __ELEVATION_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    @defgroup   Elevation_Module Elevation
+    @name       Elevation Module
+    @{
+*/
+
+#define ELEV_MEDIAN_LEN             5           //!< Altitudes of the median filter
+#define ELEV_SIGMA_PER_VDOP         1.5f        //!< Vertical error for a unit VDOP [m]
+#define ELEV_DEFAULT_VDOP           2.0f        //!< Used when the GSA sentence has no VDOP
+#define ELEV_GRADE_SIGMA            0.1f        //!< Change of altitude per meter of distance (1 sigma)
+#define ELEV_DRIFT_RATE             0.005f      //!< Drift of the altitude in time [m^2/s]
+
+#define ELEV_GRADE_STEP             10.0f       //!< Distance between the grade samples [m]
+#define ELEV_GRADE_SAMPLES          11          //!< Grade over (ELEV_GRADE_SAMPLES - 1) steps
+#define ELEV_GRADE_SPAN             ((ELEV_GRADE_SAMPLES - 1) * ELEV_GRADE_STEP)
+#define ELEV_GRADE_MIN_SPAN         30.0f       //!< Shorter distances give no grade [m]
+
+#define ELEV_CLIMB_MIN_GAIN         20.0f       //!< [m]
+#define ELEV_CLIMB_MIN_GRADE        3.0f        //!< Average grade of a climb [%]
+#define ELEV_CLIMB_END_DROP         10.0f       //!< Drop from the top that ends a climb [m]
+#define ELEV_CLIMB_END_FLAT         500.0f      //!< Distance without a new top that ends a climb [m]
+#define ELEV_MAX_CLIMBS             16
+
+#define ELEV_CLIMBS_FILE            "CLIMBS.CSV" //!< Climbs of the rides, one line per climb
+#define ELEV_CLIMBS_HEADER          "ride,climb,start_s,start_m,length_m,gain_m,avg_pct,max_pct\n"
+#define ELEV_CLIMB_LEN              64          //!< Buffer size for a line of the climbs file, without the ride name
+
+//! A detected climb
+typedef struct{
+    uint32_t startMs;                       //!< Time of the bottom, same time base of the fixes
+    uint32_t endMs;                         //!< Time of the top
+    float startDistance;                    //!< Distance of the ride at the bottom [m]
+    float length;                           //!< [m]
+    float gain;                             //!< [m]
+    float avgGrade;                         //!< [%]
+    float maxGrade;                         //!< Steepest grade over @ref ELEV_GRADE_SPAN meters [%]
+} ElevationClimb_t;
+
+void elevationStart(void);
+float elevationAddFix(uint32_t nowMs, float altitude, float vdop, float distance);
+void elevationFinish(void);
+
+bool elevationIsValid(void);
+float elevationGetAltitude(void);
+float elevationGetGrade(void);
+bool elevationIsClimbing(void);
+uint8_t elevationGetClimbCount(void);
+bool elevationGetClimb(uint8_t climb, ElevationClimb_t* data);
+
+size_t elevationFormatClimb(char* buf, size_t size, const char* ride, uint8_t climb, uint32_t rideStartMs);
+
+/*! @} */ //End of Elevation_Module
+
+#endif // __ELEVATION_H__
@@ -0,0 +1,236 @@
+/*!
+    @file       energy.c
+    @ingroup    Energy_Module
+    @brief      Energy accounting implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Local Includes */
+#include "energy.h"
+#include "lights.h"
+#include "battery.h"
+
+/*!
+    @addtogroup Energy_Module
+    @{
+*/
+
+#define EN_NS_OF_BITS(bits, hz)     ((uint32_t)((bits) * 1000000000ull / (hz)))
+
+//! Currents of the subsystems, the same of Test/power.py
+static const EnergyComponentInfo_t enComponents[ENERGY_NUM_COMPONENTS] = {
+    //Name          On [mA]             Per MHz [mA]    Event [ns]                                                  MCLK
+    {"MCU active",  0.30f,              0.090f,         0,                                                          false},
+    {"MCU LPM0",    0.35f,              0.015f,         0,                                                          false},
+    {"GPS",         20.0f,              0.0f,           0,                                                          false},
+    {"GPS UART",    0.10f,              0.0f,           EN_NS_OF_BITS(10, ENERGY_GPS_BAUD),                         false},
+    {"LCD SPI",     2.0f,               0.0f,           EN_NS_OF_BITS(8, ENERGY_LCD_SPI_HZ),                        false},
+    {"SD SPI",      30.0f,              0.0f,           0,                                                          false},
+    {"I2C",         0.75f,              0.0f,           0,                                                          false},
+    {"ADC",         0.50f,              0.0f,           EN_NS_OF_BITS(ENERGY_ADC_CONVERSIONS * ENERGY_ADC_CYCLES,
+                                                                      ENERGY_MCLK_MHZ * 1000000u),                  true},
+    {"Front light", LIGHTS_FRONT_MA,    0.0f,           0,                                                          false},
+    {"Rear light",  LIGHTS_REAR_MA,     0.0f,           0,                                                          false},
+    {"Backlight",   18.0f,              0.0f,           0,                                                          false},
+    {"Standby",     5.0f,               0.0f,           0,                                                          false},
+};
+
+/*!
+    @brief      Row of the table of a subsystem
+    @return     NULL if the subsystem does not exist
+*/
+const EnergyComponentInfo_t* energyGetInfo(EnergyComponent_t component){
+    return component < ENERGY_NUM_COMPONENTS ? &enComponents[component] : NULL;
+}
+
+#if ENERGY_ENABLED
+
+#include "log.h"
+#define PRINTF(...) LOG_INFO(__VA_ARGS__)
+
+static uint8_t enDivider = 1;                                   //!< MCLK divider of the 48 MHz DCO
+static uint32_t enCurrentUa[ENERGY_NUM_COMPONENTS];             //!< Currents at the MCLK of now [uA]
+static uint64_t enOnNs[ENERGY_NUM_COMPONENTS];                  //!< Time on
+static uint64_t enCharge[ENERGY_NUM_COMPONENTS];                //!< Charge [uA us]
+static uint32_t enStart[ENERGY_NUM_COMPONENTS];                 //!< Start of the open interval, profiler ticks
+static volatile uint32_t enEvents[ENERGY_NUM_COMPONENTS];       //!< Events counted, never reset
+static uint32_t enEventsDone[ENERGY_NUM_COMPONENTS];            //!< Events already in the on-time
+
+/*!
+    @brief      Add a time on to a subsystem, at its current of now
+*/
+static void enAdd(EnergyComponent_t component, uint64_t ns){
+    enOnNs[component] += ns;
+    enCharge[component] += enCurrentUa[component] * ns / 1000u;
+}
+
+/*!
+    @brief      Initialize the accounting
+    @details    The time base is the one of the profiler, started by profInit.
+*/
+void energyInit(void){
+    energySetMclkDivider(1);
+    memset((void*)enEvents, 0, sizeof(enEvents));
+    energyReset();
+}
+
+/*!
+    @brief      Clear the on-time and the charge of all the subsystems
+    @details    The events counted and not yet converted are dropped.
+*/
+void energyReset(void){
+    uint8_t i;
+    memset(enOnNs, 0, sizeof(enOnNs));
+    memset(enCharge, 0, sizeof(enCharge));
+    for(i = 0; i < ENERGY_NUM_COMPONENTS; ++i){
+        enEventsDone[i] = enEvents[i];
+    }
+}
+
+/*!
+    @brief      New MCLK divider of the 48 MHz DCO
+    @details    The events counted so far are converted at the old one.
+    @param      divider: MCLK = DCO / divider, 1, 2 or 4
+*/
+void energySetMclkDivider(uint8_t divider){
+    uint8_t i;
+    energyUpdate();
+    enDivider = divider != 0 ? divider : 1;
+    for(i = 0; i < ENERGY_NUM_COMPONENTS; ++i){
+        enCurrentUa[i] = (uint32_t)(1000.0f * (enComponents[i].currentMa +
+                                               enComponents[i].perMhzMa * ENERGY_MCLK_MHZ / enDivider) + 0.5f);
+    }
+}
+
+/*!
+    @brief      Start an interval, called by @ref ENERGY_ON
+*/
+void energyOn(EnergyComponent_t component){
+    if(component < ENERGY_NUM_COMPONENTS){
+        enStart[component] = profNow();
+    }
+}
+
+/*!
+    @brief      End an interval, called by @ref ENERGY_OFF
+    @details    The profiler ticks are MCLK cycles on the target: their length follows the divider.
+*/
+void energyOff(EnergyComponent_t component){
+    uint64_t ticks;
+    if(component >= ENERGY_NUM_COMPONENTS){
+        return;
+    }
+    ticks = profNow() - enStart[component];
+#ifndef SIMULATE_HARDWARE
+    ticks *= enDivider;
+#endif
+    enAdd(component, ticks * 1000u / PROF_TICKS_PER_US);
+}
+
+/*!
+    @brief      Count events, called by @ref ENERGY_COUNT
+    @details    Only a counter: the events are converted into time by @ref energyUpdate.
+*/
+void energyCount(EnergyComponent_t component, uint32_t n){
+    if(component < ENERGY_NUM_COMPONENTS){
+        enEvents[component] += n;
+    }
+}
+
+/*!
+    @brief      Add a time on to a subsystem
+    @param      us: time on, for a light the time at full duty [us]
+*/
+void energyAddUs(EnergyComponent_t component, uint32_t us){
+    if(component < ENERGY_NUM_COMPONENTS){
+        enAdd(component, (uint64_t)us * 1000u);
+    }
+}
+
+/*!
+    @brief      Convert the events counted since the last call
+    @details    Called at least at every change of the MCLK divider and before a report.
+*/
+void energyUpdate(void){
+    uint8_t i;
+    uint32_t events, ns;
+    for(i = 0; i < ENERGY_NUM_COMPONENTS; ++i){
+        if(enComponents[i].eventNs == 0){
+            continue;
+        }
+        events = enEvents[i];
+        ns = enComponents[i].eventNs * (enComponents[i].onMclk ? enDivider : 1);
+        enAdd((EnergyComponent_t)i, (uint64_t)(events - enEventsDone[i]) * ns);
+        enEventsDone[i] = events;
+    }
+}
+
+/*!
+    @brief      Get the statistics of a subsystem
+    @param      stats: filled with the statistics
+    @return     false if the subsystem does not exist
+*/
+bool energyGetStats(EnergyComponent_t component, EnergyStats_t* stats){
+    if(component >= ENERGY_NUM_COMPONENTS || stats == NULL){
+        return false;
+    }
+    stats->name = enComponents[component].name;
+    stats->onMs = (uint32_t)(enOnNs[component] / 1000000u);
+    stats->chargeUah = (uint32_t)(enCharge[component] / 3600000000ull);
+    return true;
+}
+
+/*!
+    @brief      Time accounted, the MCU is always active or in LPM0
+*/
+uint32_t energyGetElapsedMs(void){
+    return (uint32_t)((enOnNs[ENERGY_MCU_ACTIVE] + enOnNs[ENERGY_MCU_LPM0]) / 1000000u);
+}
+
+/*!
+    @brief      Charge drawn by all the subsystems [uAh]
+*/
+uint32_t energyGetTotalUah(void){
+    uint64_t charge = 0;
+    uint8_t i;
+    for(i = 0; i < ENERGY_NUM_COMPONENTS; ++i){
+        charge += enCharge[i];
+    }
+    return (uint32_t)(charge / 3600000000ull);
+}
+
+/*!
+    @brief      Print the charge of every subsystem on the PC UART
+    @details    The average current gives the hours of a charge of a @ref BATTERY_CAPACITY_MAH cell.
+                Test/energy.py reads this format.
+*/
+void energyReport(void){
+    EnergyStats_t stats;
+    uint32_t elapsedMs, totalUah, averageUa, tenthsOfHour;
+    uint8_t i;
+
+    energyUpdate();
+    elapsedMs = energyGetElapsedMs();
+    totalUah = energyGetTotalUah();
+    averageUa = elapsedMs != 0 ? (uint32_t)((uint64_t)totalUah * 3600000u / elapsedMs) : 0;
+    tenthsOfHour = averageUa != 0 ? BATTERY_CAPACITY_MAH * 10000u / averageUa : 0;
+    PRINTF("Energy: %u ms, %u uAh, average %u uA, a charge lasts %u.%u h\r\n", (unsigned)elapsedMs,
+                                                                                (unsigned)totalUah,
+                                                                                (unsigned)averageUa,
+                                                                                (unsigned)(tenthsOfHour / 10),
+                                                                                (unsigned)(tenthsOfHour % 10));
+    for(i = 0; i < ENERGY_NUM_COMPONENTS; ++i){
+        energyGetStats((EnergyComponent_t)i, &stats);
+        PRINTF("%s: on %u ms, %u uAh\r\n", stats.name, (unsigned)stats.onMs, (unsigned)stats.chargeUah);
+    }
+}
+
+#endif // ENERGY_ENABLED
+
+/*! @} */ // Energy_Module
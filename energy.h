@@ -0,0 +1,140 @@
+/*!
+    @file       energy.h
+    @ingroup    Energy_Module
+    @brief      Energy accounting: on-time and charge of every subsystem
+    @details    Every subsystem is a row of a table with the current it draws from the battery when on
+                and the time it has been on; the charge is the integral of the two, so the mAh of a
+                ride can be split by subsystem and the hours of a charge estimated from the average
+                current. The on-time comes from three kinds of instrumentation:
+                - intervals between @ref ENERGY_ON and @ref ENERGY_OFF, measured on the time base of
+                  the profiler: the I2C transactions and the SD transfers, with the busy wait of the
+                  card while it programs a sector;
+                - events of a fixed length counted with @ref ENERGY_COUNT, cheap enough for the ISRs
+                  and the loops on a byte: the bytes received from the GPS (10 bits at 9600 baud),
+                  the bytes sent to the LCD (8 bits at @ref ENERGY_LCD_SPI_HZ) and the sequences of
+                  the ADC (5 conversions on MCLK);
+                - time added with @ref energyAddUs every @ref POWER_PERIOD_MS by the power task:
+                  active and LPM0 from the scheduler, the lights from the duty of their PWM, the
+                  backlight and the loads always on.
+                The charge is integrated at the MCLK of the moment: the MCU and the ADC draw a current
+                and, for the ADC, take a time that depend on the divider chosen by the governor.
+                The currents are the same of the model of Test/power.py; Test/energy.py runs the
+                table on the same rides and compares a report of the firmware with a previous one,
+                so a change of the firmware can be checked for energy regressions.
+                The accounting is enabled with the profiler, whose time base it uses: define
+                ENERGY_ENABLED to 0 or 1 to force it.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __ENERGY_H__
+#define __ENERGY_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Local Includes */
+#include "profiler.h"
+
+/*!
+    @defgroup   Energy_Module Energy
+    @name       Energy Module
+    @{
+*/
+
+#ifndef ENERGY_ENABLED
+    #define ENERGY_ENABLED          PROFILER_ENABLED
+#endif
+
+#if ENERGY_ENABLED && !PROFILER_ENABLED
+    #error "The energy accounting needs the time base of the profiler"
+#endif
+
+#define ENERGY_MCLK_MHZ             48          //!< MCLK with the divider at 1
+#define ENERGY_GPS_BAUD             9600        //!< GPS UART, 8N1
+#define ENERGY_LCD_SPI_HZ           16000000    //!< LCD_SPI_CLOCK_SPEED
+#define ENERGY_ADC_CONVERSIONS      5           //!< ADC_MEM0 to BATTERY_ADC_MEM
+#define ENERGY_ADC_CYCLES           20          //!< MCLK cycles of a conversion: 4 of sample and hold, 16 of conversion
+
+//! Subsystems, the rows of the report
+typedef enum{
+    ENERGY_MCU_ACTIVE = 0,                      //!< CPU running
+    ENERGY_MCU_LPM0,                            //!< CPU off, clocks on
+    ENERGY_GPS,                                 //!< L80 receiver tracking
+    ENERGY_GPS_UART,                            //!< eUSCI_A2 receiving, per byte
+    ENERGY_LCD_SPI,                             //!< LCD refresh, per byte on the SPI
+    ENERGY_SD_SPI,                              //!< SD selected: commands, sectors and busy
+    ENERGY_I2C,                                 //!< MPU6050 transactions
+    ENERGY_ADC,                                 //!< ADC14 sequences
+    ENERGY_FRONT_LIGHT,                         //!< Front light, time at full duty
+    ENERGY_REAR_LIGHT,                          //!< Rear light, time at full duty
+    ENERGY_BACKLIGHT,                           //!< LCD backlight
+    ENERGY_STANDBY,                             //!< Always on: LCD logic, MPU6050, SD idle
+    ENERGY_NUM_COMPONENTS
+} EnergyComponent_t;
+
+//! Row of the table of the subsystems
+typedef struct{
+    const char* name;
+    float currentMa;                            //!< Current when on [mA]
+    float perMhzMa;                             //!< Current per MHz of MCLK [mA]
+    uint32_t eventNs;                           //!< Length of an event of @ref ENERGY_COUNT, 0 for none [ns]
+    bool onMclk;                                //!< The event is clocked by MCLK, longer with the divider
+} EnergyComponentInfo_t;
+
+//! Statistics of a subsystem
+typedef struct{
+    const char* name;                           //!< Name of the subsystem
+    uint32_t onMs;                              //!< Time on
+    uint32_t chargeUah;                         //!< Charge drawn [uAh]
+} EnergyStats_t;
+
+const EnergyComponentInfo_t* energyGetInfo(EnergyComponent_t component);
+
+#if ENERGY_ENABLED
+
+/*!
+    @brief    Start an interval of a subsystem
+    @details  A subsystem must be measured always from the same context, task or ISR.
+*/
+#define ENERGY_ON(component)            energyOn(component)
+//! End an interval of a subsystem
+#define ENERGY_OFF(component)           energyOff(component)
+//! Count events of a subsystem, also from an ISR
+#define ENERGY_COUNT(component, n)      energyCount((component), (n))
+
+void energyInit(void);
+void energyReset(void);
+void energySetMclkDivider(uint8_t divider);
+void energyOn(EnergyComponent_t component);
+void energyOff(EnergyComponent_t component);
+void energyCount(EnergyComponent_t component, uint32_t n);
+void energyAddUs(EnergyComponent_t component, uint32_t us);
+void energyUpdate(void);
+bool energyGetStats(EnergyComponent_t component, EnergyStats_t* stats);
+uint32_t energyGetElapsedMs(void);
+uint32_t energyGetTotalUah(void);
+void energyReport(void);
+
+#else
+
+#define ENERGY_ON(component)
+#define ENERGY_OFF(component)
+#define ENERGY_COUNT(component, n)
+
+#define energyInit()
+#define energyReset()
+#define energySetMclkDivider(divider)
+#define energyAddUs(component, us)
+#define energyUpdate()
+#define energyGetStats(component, stats)    false
+#define energyGetElapsedMs()                0
+#define energyGetTotalUah()                 0
+#define energyReport()
+
+#endif // ENERGY_ENABLED
+
+/*! @} */ //End of Energy_Module
+
+#endif // __ENERGY_H__
@@ -7,13 +7,90 @@
 /* storage control modules to the FatFs module with a defined API.       */
 /*-----------------------------------------------------------------------*/
 
+#include <string.h>
 #include "diskio.h"		/* FatFs lower layer API */
+#include "sim_disk.h"
+#ifndef SIMULATE_HARDWARE
 #include "mmc_MSP432P401r.h"
+#else
+/* On the host the SD card is an image file (IMG_disk_open) */
+#define MMC_disk_initialize	IMG_disk_initialize
+#define MMC_disk_status		IMG_disk_status
+#define MMC_disk_read		IMG_disk_read
+#define MMC_disk_write		IMG_disk_write
+#define MMC_disk_ioctl		IMG_disk_ioctl
+#endif
 
 /* Definitions of physical drive number for each drive */
-#define DEV_MMC     0   /* Example: Map MMC/SD card to physical drive 1 */
-#define DEV_RAM		1	/* Example: Map Ramdisk to physical drive 0 */
-#define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
+#define DEV_MMC     0   /* MMC/SD card, an image file on the host */
+#define DEV_RAM		1	/* RAM disk (RAM_disk_attach) */
+
+/* Write-back cache of the MMC: consecutive sector writes are collected and  */
+/* written with a single CMD25. Flushed when full, by CTRL_SYNC (f_sync and  */
+/* f_close) and before a read or a write outside the cached run.             */
+#ifndef MMC_CACHE_SECTORS
+#define MMC_CACHE_SECTORS	4	/* 0 disables the cache */
+#endif
+
+
+#if MMC_CACHE_SECTORS
+static BYTE CacheData[MMC_CACHE_SECTORS][512];
+static DWORD CacheSector;		/* First sector of the cached run */
+static UINT CacheCount;			/* Sectors in the cache */
+
+static DRESULT cache_flush (void)
+{
+	DRESULT res = RES_OK;
+
+	if (CacheCount) {
+		res = MMC_disk_write(CacheData[0], CacheSector, CacheCount);
+		CacheCount = 0;			/* On error the data is lost, as with a failed direct write */
+	}
+	return res;
+}
+
+static DRESULT cache_write (const BYTE *buff, DWORD sector, UINT count)
+{
+	DRESULT res;
+
+	if (CacheCount && sector >= CacheSector && sector <= CacheSector + CacheCount
+		&& sector + count <= CacheSector + MMC_CACHE_SECTORS) {
+		/* Rewrite or extension of the cached run */
+		memcpy(CacheData[sector - CacheSector], buff, count * 512);
+		if (sector + count > CacheSector + CacheCount)
+			CacheCount = sector + count - CacheSector;
+		return CacheCount == MMC_CACHE_SECTORS ? cache_flush() : RES_OK;
+	}
+
+	res = cache_flush();
+	if (res != RES_OK) return res;
+	if (count >= MMC_CACHE_SECTORS)	/* Long runs go straight to the card */
+		return MMC_disk_write(buff, sector, count);
+	memcpy(CacheData[0], buff, count * 512);
+	CacheSector = sector;
+	CacheCount = count;
+	return RES_OK;
+}
+
+static DRESULT cache_read (BYTE *buff, DWORD sector, UINT count)
+{
+	DRESULT res;
+
+	if (CacheCount && sector >= CacheSector && sector + count <= CacheSector + CacheCount) {
+		memcpy(buff, CacheData[sector - CacheSector], count * 512);
+		return RES_OK;
+	}
+	if (CacheCount && sector < CacheSector + CacheCount && sector + count > CacheSector) {
+		res = cache_flush();	/* Partial overlap */
+		if (res != RES_OK) return res;
+	}
+	return MMC_disk_read(buff, sector, count);
+}
+#else
+#define cache_flush()					RES_OK
+#define cache_write(buff, sector, count)	MMC_disk_write(buff, sector, count)
+#define cache_read(buff, sector, count)		MMC_disk_read(buff, sector, count)
+#endif
 
 
 /*-----------------------------------------------------------------------*/
@@ -25,15 +102,14 @@ DSTATUS disk_status (
 )
 {
 	DSTATUS stat;
-	//int result;
 
 	switch (pdrv) {
 	case DEV_RAM :
-		//result = RAM_disk_status();
+		stat = RAM_disk_status();
 
 		// translate the reslut code here
 
-		return RES_NOTRDY;
+		return stat;
 
 	case DEV_MMC :
 	    stat = MMC_disk_status();
@@ -42,12 +118,6 @@ DSTATUS disk_status (
 
 		return stat;
 
-	case DEV_USB :
-		//result = USB_disk_status();
-
-		// translate the reslut code here
-
-		return RES_NOTRDY;
 	}
 	return STA_NOINIT;
 }
@@ -63,15 +133,14 @@ DSTATUS disk_initialize (
 )
 {
 	DSTATUS stat;
-//	/int result;
 
 	switch (pdrv) {
 	case DEV_RAM :
-		//result = RAM_disk_initialize();
+		stat = RAM_disk_initialize();
 
 		// translate the reslut code here
 
-		return RES_NOTRDY;
+		return stat;
 
 	case DEV_MMC :
 	    stat = MMC_disk_initialize();
@@ -80,12 +149,6 @@ DSTATUS disk_initialize (
 
 		return stat;
 
-	case DEV_USB :
-		//result = USB_disk_initialize();
-
-		// translate the reslut code here
-
-		return RES_NOTRDY;
 	}
 	return STA_NOINIT;
 }
@@ -104,35 +167,26 @@ DRESULT disk_read (
 )
 {
 	DRESULT res;
-	//int result;
 
 	switch (pdrv) {
 	case DEV_RAM :
 		// translate the arguments here
 
-		//result = RAM_disk_read(buff, sector, count);
+		res = RAM_disk_read(buff, sector, count);
 
 		// translate the reslut code here
 
-		return RES_NOTRDY;
+		return res;
 
 	case DEV_MMC :
 		// translate the arguments here
 
-	    res = MMC_disk_read(buff, sector, count);
+	    res = cache_read(buff, sector, count);
 
 		// translate the reslut code here
 
 		return res;
 
-	case DEV_USB :
-		// translate the arguments here
-
-		//result = USB_disk_read(buff, sector, count);
-
-		// translate the reslut code here
-
-		return RES_NOTRDY;
 	}
 
 	return RES_PARERR;
@@ -152,35 +206,26 @@ DRESULT disk_write (
 )
 {
 	DRESULT res;
-	//int result;
 
 	switch (pdrv) {
 	case DEV_RAM :
 		// translate the arguments here
 
-		//result = RAM_disk_write(buff, sector, count);
+		res = RAM_disk_write(buff, sector, count);
 
 		// translate the reslut code here
 
-		return RES_NOTRDY;
+		return res;
 
 	case DEV_MMC :
 		// translate the arguments here
 
-	    res = MMC_disk_write(buff, sector, count);
+	    res = cache_write(buff, sector, count);
 
 		// translate the reslut code here
 
 		return res;
 
-	case DEV_USB :
-		// translate the arguments here
-
-		//result = USB_disk_write(buff, sector, count);
-
-		// translate the reslut code here
-
-		return RES_NOTRDY;
 	}
 
 	return RES_PARERR;
@@ -199,27 +244,26 @@ DRESULT disk_ioctl (
 )
 {
 	DRESULT res;
-	//int result;
 
 	switch (pdrv) {
 	case DEV_RAM :
+		res = RAM_disk_ioctl(cmd, buff);
 
 		// Process of the command for the RAM drive
 
-		return RES_NOTRDY;
+		return res;
 
 	case DEV_MMC :
+	    if (cmd == CTRL_SYNC || cmd == CTRL_POWER) {
+	        res = cache_flush();
+	        if (res != RES_OK) return res;
+	    }
 	    res = MMC_disk_ioctl(cmd,buff);
 
 	    // Process of the command for the MMC/SD card
 
 		return res;
 
-	case DEV_USB :
-
-		// Process of the command the USB drive
-
-		return RES_NOTRDY;
 	}
 
 	return RES_PARERR;
@@ -1,4 +1,5 @@
 #include "mmc_MSP432P401r.h"
+#include "energy.h"
 
 /* MMC/SD command */
 #define CMD0    (0x40+0)    /* GO_IDLE_STATE */
@@ -25,14 +26,28 @@
 #ifndef MMC_SS_GPIO_PIN
   #error "undefined MMC_SS_GPIO_PIN"
 #endif
-#define DESELECT    GPIO_High(MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN);
-#define SELECT      GPIO_Low(MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN);
+/* The SPI bus is shared with the LCD: the bus manager loads the SD profile and drives the CS.
+ * The card draws its write current while selected, busy included: the energy accounting times it */
+#define DESELECT    ENERGY_OFF(ENERGY_SD_SPI); SPI_Release(&SD_SPIDevice);
+#define SELECT      SPI_Acquire(&SD_SPIDevice); ENERGY_ON(ENERGY_SD_SPI);
+
+
+/* Sector transfers by uDMA on the EUSCI_B0 channels, MMC_use_dma() enables them at run time */
+#ifndef MMC_USE_DMA
+#define MMC_USE_DMA 1
+#endif
+#if MMC_USE_DMA
+#include <ti/devices/msp432p4xx/driverlib/dma.h>
+#endif
+#define DMA_TX_CHANNEL  0           /* DMA_CH0_EUSCIB0TX0 */
+#define DMA_RX_CHANNEL  1           /* DMA_CH1_EUSCIB0RX0 */
 
 
 static volatile DSTATUS Stat = STA_NOINIT;
 static volatile UINT Timer1, Timer2;
 static BYTE CardType;
 static BYTE PowerFlag = 0;
+static bool UseDMA = false;
 
 static void xmit_spi(BYTE dat)
 {
@@ -58,6 +73,50 @@ static void rcvr_spi_m(BYTE *dst)
     *dst = rcvr_spi();
 }
 
+#if MMC_USE_DMA
+/* Exchange a block with the card by DMA: tx NULL sends 0xFF, rx NULL discards the received bytes.
+ * The RX channel ends after the last bit is shifted, so its completion ends the whole exchange. */
+static bool xchg_spi_dma(BYTE *rx, const BYTE *tx, UINT n)
+{
+    static const BYTE ff = 0xFF;
+    static BYTE dummy;
+
+    MAP_DMA_setChannelControl(DMA_CH1_EUSCIB0RX0 | UDMA_PRI_SELECT,
+            UDMA_SIZE_8 | UDMA_SRC_INC_NONE | (rx ? UDMA_DST_INC_8 : UDMA_DST_INC_NONE) | UDMA_ARB_1);
+    MAP_DMA_setChannelTransfer(DMA_CH1_EUSCIB0RX0 | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+            (void*)MAP_SPI_getReceiveBufferAddressForDMA(SPI_BASE), rx ? rx : &dummy, n);
+    MAP_DMA_setChannelControl(DMA_CH0_EUSCIB0TX0 | UDMA_PRI_SELECT,
+            UDMA_SIZE_8 | (tx ? UDMA_SRC_INC_8 : UDMA_SRC_INC_NONE) | UDMA_DST_INC_NONE | UDMA_ARB_1);
+    MAP_DMA_setChannelTransfer(DMA_CH0_EUSCIB0TX0 | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+            (void*)(tx ? tx : &ff), (void*)MAP_SPI_getTransmitBufferAddressForDMA(SPI_BASE), n);
+
+    MAP_SPI_receiveData(SPI_BASE);              /* Clear a stale RXIFG */
+    MAP_DMA_enableChannel(DMA_RX_CHANNEL);
+    MAP_DMA_enableChannel(DMA_TX_CHANNEL);      /* TXIFG is set: the transfer starts */
+
+    Timer2 = 10;                                /* 100 ms, a sector takes 10 ms at 400 kHz */
+    while (MAP_DMA_isChannelEnabled(DMA_RX_CHANNEL) && Timer2) ;
+    if (MAP_DMA_isChannelEnabled(DMA_RX_CHANNEL)) {
+        MAP_DMA_disableChannel(DMA_TX_CHANNEL);
+        MAP_DMA_disableChannel(DMA_RX_CHANNEL);
+        UseDMA = false;                         /* Fall back to the polled path */
+        return false;
+    }
+    return true;
+}
+#endif
+
+void MMC_use_dma(bool enable)
+{
+#if MMC_USE_DMA
+    if (enable) {
+        MAP_DMA_assignChannel(DMA_CH0_EUSCIB0TX0);
+        MAP_DMA_assignChannel(DMA_CH1_EUSCIB0RX0);
+    }
+    UseDMA = enable;
+#endif
+}
+
 static BYTE wait_ready(void)
 {
     BYTE res;
@@ -77,14 +136,16 @@ static void send_initial_clock_train(void)
     uint32_t ui32RcvDat = 0;
     uint32_t ui32XmitDat = 0xFF;
 
-    DESELECT
+    /* At least 74 clocks with CS high: take the bus for the SD profile, then release the CS */
+    SELECT
+    GPIO_High(MMC_SS_GPIO_PORT, MMC_SS_GPIO_PIN);
 
     for(i = 0; i < 10; i++)
     {
         SPI_Write(SPI_BASE, (uint8_t*)&ui32XmitDat, 1);
         SPI_Read(SPI_BASE, (uint8_t*)&ui32RcvDat, 1);
     }
-
+    DESELECT
 }
 
 static void power_on(void)
@@ -93,11 +154,6 @@ static void power_on(void)
     PowerFlag = 1;
 }
 
-static void set_max_speed(void)
-{
-
-}
-
 static void power_off(void)
 {
     PowerFlag = 0;
@@ -118,6 +174,11 @@ static bool rcvr_datablock (BYTE *buff, UINT btr)
     } while ((token == 0xFF) && Timer1);
     if(token != 0xFE) return false;    /* If not valid data token, retutn with error */
 
+#if MMC_USE_DMA
+    if (UseDMA && btr == 512) {     /* Sectors by DMA, the short registers polled */
+        if (!xchg_spi_dma(buff, 0, btr)) return false;
+    } else
+#endif
     do {                            /* Receive the data block into buffer */
         rcvr_spi_m(buff++);
         rcvr_spi_m(buff++);
@@ -136,11 +197,18 @@ static bool xmit_datablock (const BYTE *buff, BYTE token)
 
     xmit_spi(token);                    /* Xmit data token */
     if (token != 0xFD) {    /* Is data token */
-        wc = 0;
-        do {                            /* Xmit the 512 byte data block to MMC */
-            xmit_spi(*buff++);
-            xmit_spi(*buff++);
-        } while (--wc);
+#if MMC_USE_DMA
+        if (UseDMA) {
+            if (!xchg_spi_dma(0, buff, 512)) return false;
+        } else
+#endif
+        {
+            wc = 0;
+            do {                            /* Xmit the 512 byte data block to MMC */
+                xmit_spi(*buff++);
+                xmit_spi(*buff++);
+            } while (--wc);
+        }
         xmit_spi(0xFF);                    /* CRC (Dummy) */
         xmit_spi(0xFF);
         resp = rcvr_spi();                /* Reveive data response */
@@ -207,6 +275,31 @@ static BYTE send_cmd12 (void)
     return res;            /* Return with the response value */
 }
 
+/* Raise the SPI clock to the TRAN_SPEED of the CSD, limited by the eUSCI */
+static void set_max_speed(void)
+{
+    static const BYTE mult[16] = {0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80};
+    BYTE csd[16], unit;
+    DWORD clock;
+
+    SELECT
+    if (send_cmd(CMD9, 0) != 0 || !rcvr_datablock(csd, 16)) {
+        DESELECT
+        rcvr_spi();
+        return;                     /* Keep the initialization clock */
+    }
+    DESELECT
+    rcvr_spi();
+
+    /* TRAN_SPEED: bits 2:0 rate unit 100 kbit/s * 10^n, bits 6:3 multiplier x10 */
+    clock = 10000;
+    for (unit = csd[3] & 7; unit; unit--) clock *= 10;
+    clock *= mult[(csd[3] >> 3) & 15];
+    if (clock == 0 || clock > SD_MAX_SPI_CLOCK) clock = SD_MAX_SPI_CLOCK;
+    if (clock > SD_INIT_SPI_CLOCK)
+        SPI_SetDeviceClock(&SD_SPIDevice, clock);
+}
+
 DSTATUS MMC_disk_initialize (void)
 {
     BYTE n, ty, ocr[4];
@@ -429,8 +522,4 @@ void disk_timerproc(void)
         if (n) Timer2 = --n;
 }
 
-DWORD get_fattime(void)
-{
-    return 0;
-}
 
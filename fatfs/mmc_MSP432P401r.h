@@ -1,6 +1,7 @@
 #ifndef FATFS_MMC_MSP432P401R_H_
 #define FATFS_MMC_MSP432P401R_H_
 
+#include <stdbool.h>
 #include "integer.h"
 #include "diskio.h"
 #include "Hardware/SPI_Driver.h"
@@ -12,5 +13,6 @@ DSTATUS MMC_disk_status (void);
 DRESULT MMC_disk_read (BYTE* buff, DWORD sector, UINT count);
 DRESULT MMC_disk_write (const BYTE* buff, DWORD sector, UINT count);
 DRESULT MMC_disk_ioctl (BYTE cmd, void* buff);
+void MMC_use_dma(bool enable);
 
 #endif /* FATFS_MMC_MSP432P401R_H_ */
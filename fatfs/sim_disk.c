@@ -0,0 +1,267 @@
+#include <string.h>
+#include "sim_disk.h"
+
+#ifdef SIMULATE_HARDWARE
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#define SECTOR_SIZE     512
+
+
+typedef struct {
+    SIM_MODEL model;
+    SIM_STATS stats;
+    DWORD open[SIM_OPEN_BLOCKS];    /* Open erase blocks, most recent first */
+    UINT nopen;
+} SIM_DRIVE;
+
+static SIM_DRIVE Drive[SIM_DRIVES];
+
+static BYTE* RamData;
+static DWORD RamSectors;
+static DSTATUS RamStat = STA_NOINIT;
+
+#ifdef SIMULATE_HARDWARE
+static int ImgFd = -1;
+static DWORD ImgSectors;
+static DSTATUS ImgStat = STA_NOINIT;
+#endif
+
+
+/*-----------------------------------------------------------------------*/
+/* Cost model                                                            */
+/*-----------------------------------------------------------------------*/
+
+static void wait_us (const SIM_DRIVE* drv, DWORD us)
+{
+#ifdef SIMULATE_HARDWARE
+    struct timespec t;
+
+    if (drv->model.realtime && us) {
+        t.tv_sec = us / 1000000;
+        t.tv_nsec = (long)(us % 1000000) * 1000;
+        nanosleep(&t, NULL);
+    }
+#else
+    (void)drv;
+    (void)us;
+#endif
+}
+
+static void account_read (SIM_DRIVE* drv, UINT count)
+{
+    DWORD us = drv->model.read_cmd + drv->model.read_sector * count;
+
+    drv->stats.reads++;
+    drv->stats.read_bytes += (QWORD)count * SECTOR_SIZE;
+    drv->stats.busy_us += us;
+    wait_us(drv, us);
+}
+
+/* A write to an erase block not open costs an erase: the card closes the least */
+/* recently used block (merge) and opens the new one */
+static void account_write (SIM_DRIVE* drv, DWORD sector, UINT count)
+{
+    DWORD us = drv->model.write_cmd + drv->model.write_sector * count;
+    DWORD blk, last;
+    UINT i;
+
+    if (drv->model.erase_block) {
+        last = (sector + count - 1) / drv->model.erase_block;
+        for (blk = sector / drv->model.erase_block; blk <= last; blk++) {
+            for (i = 0; i < drv->nopen && drv->open[i] != blk; i++) ;
+            if (i == drv->nopen) {      /* Not open */
+                if (drv->nopen < SIM_OPEN_BLOCKS) drv->nopen++;
+                i = drv->nopen - 1;
+                drv->stats.erases++;
+                us += drv->model.erase;
+            }
+            for ( ; i > 0; i--) drv->open[i] = drv->open[i - 1];
+            drv->open[0] = blk;
+        }
+    }
+    drv->stats.writes++;
+    drv->stats.write_bytes += (QWORD)count * SECTOR_SIZE;
+    drv->stats.busy_us += us;
+    wait_us(drv, us);
+}
+
+void SIM_disk_model (BYTE drv, const SIM_MODEL* model)
+{
+    if (drv >= SIM_DRIVES) return;
+    if (model) {
+        Drive[drv].model = *model;
+    } else {
+        memset(&Drive[drv].model, 0, sizeof(SIM_MODEL));
+    }
+    Drive[drv].nopen = 0;
+}
+
+void SIM_disk_stats (BYTE drv, SIM_STATS* stats)
+{
+    if (drv < SIM_DRIVES) *stats = Drive[drv].stats;
+}
+
+void SIM_disk_reset_stats (BYTE drv)
+{
+    if (drv < SIM_DRIVES) memset(&Drive[drv].stats, 0, sizeof(SIM_STATS));
+}
+
+/* Ioctl common to the simulated drives */
+static DRESULT sim_ioctl (const SIM_DRIVE* drv, DWORD sectors, BYTE cmd, void* buff)
+{
+    switch (cmd) {
+    case CTRL_SYNC :
+    case CTRL_TRIM :
+    case CTRL_POWER :
+        return RES_OK;
+
+    case GET_SECTOR_COUNT :
+        *(DWORD*)buff = sectors;
+        return RES_OK;
+
+    case GET_SECTOR_SIZE :
+        *(WORD*)buff = SECTOR_SIZE;
+        return RES_OK;
+
+    case GET_BLOCK_SIZE :
+        *(DWORD*)buff = drv->model.erase_block ? drv->model.erase_block : 1;
+        return RES_OK;
+    }
+    return RES_PARERR;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* RAM disk                                                              */
+/*-----------------------------------------------------------------------*/
+
+/* Memory of the RAM disk, provided by the caller (sectors * 512 bytes) */
+bool RAM_disk_attach (BYTE* mem, DWORD sectors)
+{
+    RamData = mem;
+    RamSectors = mem ? sectors : 0;
+    RamStat = STA_NOINIT;
+    Drive[SIM_RAM].nopen = 0;
+    return RamSectors != 0;
+}
+
+DSTATUS RAM_disk_initialize (void)
+{
+    RamStat = RamSectors ? 0 : STA_NOINIT | STA_NODISK;
+    return RamStat;
+}
+
+DSTATUS RAM_disk_status (void)
+{
+    return RamStat;
+}
+
+DRESULT RAM_disk_read (BYTE* buff, DWORD sector, UINT count)
+{
+    if (!count) return RES_PARERR;
+    if (RamStat & STA_NOINIT) return RES_NOTRDY;
+    if (sector >= RamSectors || count > RamSectors - sector) return RES_PARERR;
+
+    memcpy(buff, RamData + sector * SECTOR_SIZE, count * SECTOR_SIZE);
+    account_read(&Drive[SIM_RAM], count);
+    return RES_OK;
+}
+
+DRESULT RAM_disk_write (const BYTE* buff, DWORD sector, UINT count)
+{
+    if (!count) return RES_PARERR;
+    if (RamStat & STA_NOINIT) return RES_NOTRDY;
+    if (sector >= RamSectors || count > RamSectors - sector) return RES_PARERR;
+
+    memcpy(RamData + sector * SECTOR_SIZE, buff, count * SECTOR_SIZE);
+    account_write(&Drive[SIM_RAM], sector, count);
+    return RES_OK;
+}
+
+DRESULT RAM_disk_ioctl (BYTE cmd, void* buff)
+{
+    if (RamStat & STA_NOINIT) return RES_NOTRDY;
+    return sim_ioctl(&Drive[SIM_RAM], RamSectors, cmd, buff);
+}
+
+
+#ifdef SIMULATE_HARDWARE
+/*-----------------------------------------------------------------------*/
+/* Image file (host only)                                                */
+/*-----------------------------------------------------------------------*/
+
+/* Open a disk image, e.g. a dump of the SD card. sectors != 0 creates or */
+/* extends the image to that size, 0 takes the size of the file */
+bool IMG_disk_open (const char* path, DWORD sectors)
+{
+    struct stat st;
+
+    IMG_disk_close();
+    ImgFd = open(path, sectors ? O_RDWR | O_CREAT : O_RDWR, 0644);
+    if (ImgFd < 0) return false;
+    if (fstat(ImgFd, &st) != 0 ||
+        (sectors && (off_t)sectors * SECTOR_SIZE > st.st_size &&
+         ftruncate(ImgFd, (off_t)sectors * SECTOR_SIZE) != 0)) {
+        IMG_disk_close();
+        return false;
+    }
+    ImgSectors = sectors ? sectors : (DWORD)(st.st_size / SECTOR_SIZE);
+    Drive[SIM_IMG].nopen = 0;
+    return ImgSectors != 0;
+}
+
+void IMG_disk_close (void)
+{
+    if (ImgFd >= 0) close(ImgFd);
+    ImgFd = -1;
+    ImgSectors = 0;
+    ImgStat = STA_NOINIT;
+}
+
+DSTATUS IMG_disk_initialize (void)
+{
+    ImgStat = ImgFd >= 0 ? 0 : STA_NOINIT | STA_NODISK;
+    return ImgStat;
+}
+
+DSTATUS IMG_disk_status (void)
+{
+    return ImgStat;
+}
+
+DRESULT IMG_disk_read (BYTE* buff, DWORD sector, UINT count)
+{
+    size_t n = (size_t)count * SECTOR_SIZE;
+
+    if (!count) return RES_PARERR;
+    if (ImgStat & STA_NOINIT) return RES_NOTRDY;
+    if (sector >= ImgSectors || count > ImgSectors - sector) return RES_PARERR;
+
+    if (pread(ImgFd, buff, n, (off_t)sector * SECTOR_SIZE) != (ssize_t)n) return RES_ERROR;
+    account_read(&Drive[SIM_IMG], count);
+    return RES_OK;
+}
+
+DRESULT IMG_disk_write (const BYTE* buff, DWORD sector, UINT count)
+{
+    size_t n = (size_t)count * SECTOR_SIZE;
+
+    if (!count) return RES_PARERR;
+    if (ImgStat & STA_NOINIT) return RES_NOTRDY;
+    if (sector >= ImgSectors || count > ImgSectors - sector) return RES_PARERR;
+
+    if (pwrite(ImgFd, buff, n, (off_t)sector * SECTOR_SIZE) != (ssize_t)n) return RES_ERROR;
+    account_write(&Drive[SIM_IMG], sector, count);
+    return RES_OK;
+}
+
+DRESULT IMG_disk_ioctl (BYTE cmd, void* buff)
+{
+    if (ImgStat & STA_NOINIT) return RES_NOTRDY;
+    return sim_ioctl(&Drive[SIM_IMG], ImgSectors, cmd, buff);
+}
+#endif
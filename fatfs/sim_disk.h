@@ -0,0 +1,63 @@
+#ifndef FATFS_SIM_DISK_H_
+#define FATFS_SIM_DISK_H_
+
+/* Simulated drives: a RAM disk and, on the host (SIMULATE_HARDWARE), an image file.  */
+/* They run the FatFs code without the SD card, with a cost model of an SD card and  */
+/* counters of the accesses, so the performance of the SD path can be measured.       */
+
+#include <stdbool.h>
+#include "integer.h"
+#include "diskio.h"
+
+#define SIM_RAM     0           /* Drive index of the RAM disk */
+#define SIM_IMG     1           /* Drive index of the image file */
+#define SIM_DRIVES  2
+
+#define SIM_OPEN_BLOCKS 4       /* Erase blocks the modelled card keeps open */
+
+/* Cost model, times in us. All zero: no cost, the accesses are only counted */
+typedef struct {
+    DWORD read_cmd;             /* Command and access latency of a read */
+    DWORD read_sector;          /* Transfer of a sector read */
+    DWORD write_cmd;            /* Command latency of a write */
+    DWORD write_sector;         /* Transfer and program of a sector */
+    DWORD erase_block;          /* Sectors of an erase block (allocation unit), 0 no erase model */
+    DWORD erase;                /* Erase of a block not among the SIM_OPEN_BLOCKS open ones */
+    bool realtime;              /* Also sleep for the cost (host only), otherwise only accounted */
+} SIM_MODEL;
+
+/* Access counters */
+typedef struct {
+    DWORD reads;                /* disk_read calls */
+    DWORD writes;               /* disk_write calls */
+    QWORD read_bytes;
+    QWORD write_bytes;
+    DWORD erases;               /* Erase blocks opened */
+    QWORD busy_us;              /* Time spent according to the model */
+} SIM_STATS;
+
+/* Typical microSD card on a 16 MHz SPI bus */
+#define SIM_MODEL_SD_SPI    {300, 330, 250, 400, 256, 20000, false}
+
+void SIM_disk_model (BYTE drv, const SIM_MODEL* model);
+void SIM_disk_stats (BYTE drv, SIM_STATS* stats);
+void SIM_disk_reset_stats (BYTE drv);
+
+bool RAM_disk_attach (BYTE* mem, DWORD sectors);
+DSTATUS RAM_disk_initialize (void);
+DSTATUS RAM_disk_status (void);
+DRESULT RAM_disk_read (BYTE* buff, DWORD sector, UINT count);
+DRESULT RAM_disk_write (const BYTE* buff, DWORD sector, UINT count);
+DRESULT RAM_disk_ioctl (BYTE cmd, void* buff);
+
+#ifdef SIMULATE_HARDWARE
+bool IMG_disk_open (const char* path, DWORD sectors);
+void IMG_disk_close (void);
+DSTATUS IMG_disk_initialize (void);
+DSTATUS IMG_disk_status (void);
+DRESULT IMG_disk_read (BYTE* buff, DWORD sector, UINT count);
+DRESULT IMG_disk_write (const BYTE* buff, DWORD sector, UINT count);
+DRESULT IMG_disk_ioctl (BYTE cmd, void* buff);
+#endif
+
+#endif /* FATFS_SIM_DISK_H_ */
@@ -0,0 +1,113 @@
+/*!
+    @file       fsm.c
+    @ingroup    Fsm_Module
+    @brief      Table-driven finite state machine implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Local Includes */
+#include "fsm.h"
+
+/*!
+    @addtogroup Fsm_Module
+    @{
+*/
+
+/*!
+    @brief      Prepare a machine and enter the initial state
+    @param      fsm: machine
+    @param      states: table of the states, indexed by the state number
+    @param      stateCount: states in the table
+    @param      transitions: table of the transitions, in order of priority
+    @param      transitionCount: transitions in the table, at most @ref FSM_MAX_TRANSITIONS
+    @param      initial: first state, its entry action is called
+    @param      context: passed to guards and actions
+    @return     false if the tables are not valid
+*/
+bool fsmInit(Fsm_t* fsm, const FsmState_t* states, uint8_t stateCount,
+             const FsmTransition_t* transitions, uint8_t transitionCount, uint8_t initial, void* context){
+    uint8_t i;
+    if(fsm == NULL || states == NULL || transitions == NULL || initial >= stateCount ||
+       transitionCount > FSM_MAX_TRANSITIONS){
+        return false;
+    }
+    for(i = 0; i < transitionCount; ++i){
+        if(transitions[i].to >= stateCount || (transitions[i].from != FSM_ANY && transitions[i].from >= stateCount)){
+            return false;
+        }
+    }
+    fsm->states = states;
+    fsm->stateCount = stateCount;
+    fsm->transitions = transitions;
+    fsm->transitionCount = transitionCount;
+    fsm->context = context;
+    fsm->state = initial;
+    fsm->dwell = 0;
+    memset(fsm->held, 0, sizeof(fsm->held));
+    if(states[initial].entry != NULL){
+        states[initial].entry(context, initial);
+    }
+    return true;
+}
+
+/*!
+    @brief      One step of the machine: debounce the guards and take at most one transition
+    @param      fsm: machine
+    @return     true if the state has changed
+*/
+bool fsmStep(Fsm_t* fsm){
+    const FsmTransition_t* t;
+    uint8_t state = fsm->state;
+    bool dwelt;
+    uint8_t i;
+
+    if(fsm->dwell < UINT16_MAX){
+        ++fsm->dwell;
+    }
+    dwelt = fsm->dwell >= fsm->states[state].minDwell;
+    for(i = 0; i < fsm->transitionCount; ++i){
+        t = &fsm->transitions[i];
+        if(!(t->from == state || (t->from == FSM_ANY && t->to != state))){
+            continue;
+        }
+        if(t->guard != NULL && !t->guard(fsm->context)){
+            fsm->held[i] = 0;
+            continue;
+        }
+        if(fsm->held[i] < UINT16_MAX){
+            ++fsm->held[i];
+        }
+        if(fsm->held[i] > t->debounce && (dwelt || (t->flags & FSM_PREEMPT))){
+            if(fsm->states[state].exit != NULL){
+                fsm->states[state].exit(fsm->context, state);
+            }
+            fsm->state = t->to;
+            fsm->dwell = 0;
+            memset(fsm->held, 0, sizeof(fsm->held));
+            if(fsm->states[t->to].entry != NULL){
+                fsm->states[t->to].entry(fsm->context, t->to);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t fsmGetState(const Fsm_t* fsm){
+    return fsm->state;
+}
+
+/*!
+    @brief      Steps since the machine entered the current state, saturated
+*/
+uint16_t fsmGetDwell(const Fsm_t* fsm){
+    return fsm->dwell;
+}
+
+/*! @} */ //End of Fsm_Module
@@ -0,0 +1,76 @@
+/*!
+    @file       fsm.h
+    @ingroup    Fsm_Module
+    @brief      Table-driven finite state machine
+    @details    The behaviour of a machine is data: a table of states and a table of transitions.
+                - A state has the entry and exit actions and the minimum dwell, the steps it lasts
+                  at least before a transition can leave it.
+                - A transition has the origin (or @ref FSM_ANY), the destination, the guard and the
+                  debounce: the guard must be true for more than debounce consecutive steps. The
+                  transitions with @ref FSM_PREEMPT ignore the minimum dwell.
+                At every @ref fsmStep the transitions of the current state are checked in the order
+                of the table, the first that fires wins: exit of the old state, entry of the new one,
+                then the dwell and all the debounce counters restart. The tables are not copied and
+                can be changed between two steps, e.g. new timings from a configuration.
+                The module does not depend on the hardware.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __FSM_H__
+#define __FSM_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Fsm_Module State Machine
+    @name       State Machine Module
+    @{
+*/
+
+#define FSM_ANY                     0xFFu       //!< Origin of a transition valid from every other state
+#define FSM_MAX_TRANSITIONS         32u         //!< Debounce counters of a machine
+#define FSM_PREEMPT                 0x01u       //!< Transition flag: fires also before the minimum dwell
+
+typedef bool (*FsmGuard_t)(void* context);
+typedef void (*FsmAction_t)(void* context, uint8_t state);
+
+//! State
+typedef struct{
+    FsmAction_t entry;                          //!< Called entering the state, can be NULL
+    FsmAction_t exit;                           //!< Called leaving the state, can be NULL
+    uint16_t minDwell;                          //!< Steps in the state before a transition [steps]
+} FsmState_t;
+
+//! Transition
+typedef struct{
+    uint8_t from;                               //!< Origin, @ref FSM_ANY for every state but the destination
+    uint8_t to;                                 //!< Destination
+    uint8_t flags;                              //!< @ref FSM_PREEMPT
+    uint16_t debounce;                          //!< Consecutive steps of the guard true before it fires [steps]
+    FsmGuard_t guard;                           //!< Condition, NULL is always true
+} FsmTransition_t;
+
+//! Machine
+typedef struct{
+    const FsmState_t* states;
+    uint8_t stateCount;
+    const FsmTransition_t* transitions;
+    uint8_t transitionCount;
+    void* context;                              //!< Passed to guards and actions
+    uint8_t state;
+    uint16_t dwell;                             //!< Steps in the current state, saturated
+    uint16_t held[FSM_MAX_TRANSITIONS];         //!< Consecutive steps of each guard true
+} Fsm_t;
+
+bool fsmInit(Fsm_t* fsm, const FsmState_t* states, uint8_t stateCount,
+             const FsmTransition_t* transitions, uint8_t transitionCount, uint8_t initial, void* context);
+bool fsmStep(Fsm_t* fsm);
+uint8_t fsmGetState(const Fsm_t* fsm);
+uint16_t fsmGetDwell(const Fsm_t* fsm);
+
+/*! @} */ //End of Fsm_Module
+
+#endif // __FSM_H__
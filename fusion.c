@@ -0,0 +1,284 @@
+/*!
+    @file       fusion.c
+    @ingroup    Fusion_Module
+    @brief      Speed and along-track position estimator implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/* Local Includes */
+#include "fusion.h"
+
+/*!
+    @addtogroup Fusion_Module
+    @{
+*/
+
+#define FUSION_EARTH_RADIUS         6371000.0f          //!< [m]
+#define FUSION_DEG_TO_RAD           0.017453292f
+#define FUSION_WHEEL_TIMEOUT_MS     3000u               //!< Wheel silent for longer: source is not the wheel
+
+enum{FUS_S = 0, FUS_V, FUS_B, FUS_STATES};
+
+static bool fusValid = false;
+static float fusX[FUS_STATES];              //!< Position, speed and bias
+static float fusP[FUS_STATES][FUS_STATES];  //!< Covariance of the estimate
+static float fusAccel;                      //!< Last acceleration input [m/s^2]
+static uint32_t fusLastMs;                  //!< Time of the estimate
+static uint32_t fusSpeedMs;                 //!< Last speed correction, wheel or GPS
+
+static bool fusWheelSeen;
+static uint32_t fusWheelMs;
+
+static bool fusGpsSeen;
+static uint32_t fusGpsMs;
+static float fusGpsLatitude;
+static float fusGpsLongitude;
+static float fusGpsPosition;                //!< Position of the estimate at the last fix
+
+/*!
+    @brief      Forget the estimate, the next speed measurement starts a new one from position 0
+    @param      nowMs: time of the reset [ms], same time base of the measurements
+*/
+void fusionReset(uint32_t nowMs){
+    fusValid = false;
+    fusAccel = 0;
+    fusLastMs = nowMs;
+    fusWheelSeen = false;
+    fusGpsSeen = false;
+}
+
+/*!
+    @brief      First speed measurement: position 0 and bias unknown
+*/
+static void fusStart(uint32_t nowMs, float speed, float r){
+    memset(fusP, 0, sizeof(fusP));
+    fusX[FUS_S] = 0;
+    fusX[FUS_V] = speed;
+    fusX[FUS_B] = 0;
+    fusP[FUS_V][FUS_V] = r;
+    fusP[FUS_B][FUS_B] = FUSION_BIAS_SIGMA0 * FUSION_BIAS_SIGMA0;
+    fusLastMs = nowMs;
+    fusValid = true;
+}
+
+/*!
+    @brief      Prediction up to nowMs with the last acceleration
+    @details    x' = F x + G u with u the acceleration without the bias, P' = F P F^T + Q.
+                After @ref FUSION_MAX_COAST_MS without speed corrections the acceleration is no
+                longer integrated and the speed is held.
+*/
+static void fusPredict(uint32_t nowMs){
+    float dt = (float)(nowMs - fusLastMs) / 1000.0f;
+    float F[FUS_STATES][FUS_STATES];
+    float FP[FUS_STATES][FUS_STATES];
+    float qa = FUSION_ACCEL_SIGMA * FUSION_ACCEL_SIGMA;
+    bool integrate = nowMs - fusSpeedMs <= FUSION_MAX_COAST_MS;
+    float c = integrate ? dt : 0;               //Sensitivity of the speed to the bias
+    float u = integrate ? fusAccel - fusX[FUS_B] : 0;
+    uint8_t i, j, k;
+
+    fusLastMs = nowMs;
+    if(!fusValid || dt <= 0){
+        return;
+    }
+    fusX[FUS_S] += fusX[FUS_V] * dt + 0.5f * u * dt * dt;
+    fusX[FUS_V] += u * dt;
+    if(fusX[FUS_V] < 0){
+        fusX[FUS_V] = 0;                        //The bike does not go backwards
+    }
+
+    memset(F, 0, sizeof(F));
+    F[FUS_S][FUS_S] = 1;
+    F[FUS_S][FUS_V] = dt;
+    F[FUS_S][FUS_B] = -0.5f * c * dt;
+    F[FUS_V][FUS_V] = 1;
+    F[FUS_V][FUS_B] = -c;
+    F[FUS_B][FUS_B] = 1;
+    for(i = 0; i < FUS_STATES; ++i){
+        for(j = 0; j < FUS_STATES; ++j){
+            FP[i][j] = 0;
+            for(k = i; k < FUS_STATES; ++k){    //F is upper triangular
+                FP[i][j] += F[i][k] * fusP[k][j];
+            }
+        }
+    }
+    for(i = 0; i < FUS_STATES; ++i){
+        for(j = i; j < FUS_STATES; ++j){
+            float sum = 0;
+            for(k = j; k < FUS_STATES; ++k){
+                sum += FP[i][k] * F[j][k];
+            }
+            fusP[i][j] = sum;
+            fusP[j][i] = sum;
+        }
+    }
+    //White acceleration noise on position and speed, random walk of the bias
+    fusP[FUS_S][FUS_S] += qa * dt * dt * dt * dt * 0.25f;
+    fusP[FUS_S][FUS_V] += qa * dt * dt * dt * 0.5f;
+    fusP[FUS_V][FUS_S] = fusP[FUS_S][FUS_V];
+    fusP[FUS_V][FUS_V] += qa * dt * dt;
+    fusP[FUS_B][FUS_B] += FUSION_BIAS_DRIFT * dt;
+}
+
+/*!
+    @brief      Correction with the measurement of a single state
+    @param      state: measured state, H is the unit vector of the state
+    @param      z: measurement
+    @param      r: variance of the measurement
+*/
+static void fusCorrect(uint8_t state, float z, float r){
+    float row[FUS_STATES];
+    float gain[FUS_STATES];
+    float innovation = z - fusX[state];
+    float s = fusP[state][state] + r;
+    uint8_t i, j;
+
+    for(i = 0; i < FUS_STATES; ++i){
+        row[i] = fusP[state][i];
+        gain[i] = row[i] / s;
+        fusX[i] += gain[i] * innovation;
+    }
+    for(i = 0; i < FUS_STATES; ++i){
+        for(j = 0; j < FUS_STATES; ++j){
+            fusP[i][j] -= gain[i] * row[j];
+        }
+    }
+    if(fusX[FUS_V] < 0){
+        fusX[FUS_V] = 0;
+    }
+}
+
+/*!
+    @brief      Longitudinal acceleration, drives the prediction until the next sample
+    @param      nowMs: time of the sample [ms]
+    @param      accel: acceleration along the direction of travel without the gravity [m/s^2]
+*/
+void fusionAddAccel(uint32_t nowMs, float accel){
+    fusPredict(nowMs);
+    if(accel > FUSION_ACCEL_MAX){
+        accel = FUSION_ACCEL_MAX;
+    }else if(accel < -FUSION_ACCEL_MAX){
+        accel = -FUSION_ACCEL_MAX;
+    }
+    fusAccel = accel;
+}
+
+/*!
+    @brief      Wheel speed, at every wheel round
+    @param      nowMs: time of the round [ms]
+    @param      speed: [m/s]
+*/
+void fusionAddWheel(uint32_t nowMs, float speed){
+    float r = FUSION_WHEEL_SIGMA * FUSION_WHEEL_SIGMA;
+    fusPredict(nowMs);
+    if(!fusValid){
+        fusStart(nowMs, speed, r);
+    }else{
+        fusCorrect(FUS_V, speed, r);
+    }
+    fusWheelSeen = true;
+    fusWheelMs = nowMs;
+    fusSpeedMs = nowMs;
+}
+
+/*!
+    @brief      GPS fix: speed and distance from the previous fix
+    @details    The distance between two fixes measures the position change since the previous fix,
+                the steps slower than @ref FUSION_MOVING_SPEED are jitter of a stopped receiver and
+                are not used. The fixes with a HDOP over @ref FUSION_GPS_MAX_HDOP are discarded.
+    @param      nowMs: time of the fix [ms]
+    @param      latitude: [deg]
+    @param      longitude: [deg]
+    @param      speed: GPS speed [m/s]
+    @param      hdop: HDOP of the fix
+*/
+void fusionAddGps(uint32_t nowMs, float latitude, float longitude, float speed, float hdop){
+    if(!(hdop > 0 && hdop <= FUSION_GPS_MAX_HDOP)){
+        return;
+    }
+    if(fusGpsSeen && nowMs - fusGpsMs < FUSION_GPS_MIN_INTERVAL_MS){
+        return;
+    }
+    float sigma = FUSION_GPS_SPEED_SIGMA * hdop;
+    fusPredict(nowMs);
+    if(!fusValid){
+        fusStart(nowMs, speed, sigma * sigma);
+    }else{
+        fusCorrect(FUS_V, speed, sigma * sigma);
+        if(fusGpsSeen && nowMs - fusGpsMs <= FUSION_GPS_TIMEOUT_MS){
+            float dy = (latitude - fusGpsLatitude) * FUSION_DEG_TO_RAD;
+            float dx = (longitude - fusGpsLongitude) * FUSION_DEG_TO_RAD *
+                       cosf((latitude + fusGpsLatitude) * 0.5f * FUSION_DEG_TO_RAD);
+            float distance = FUSION_EARTH_RADIUS * sqrtf(dx * dx + dy * dy);
+            if(distance * 1000.0f >= FUSION_MOVING_SPEED * (float)(nowMs - fusGpsMs)){
+                //The errors of both fixes are in the distance
+                sigma = FUSION_GPS_POS_SIGMA * hdop;
+                fusCorrect(FUS_S, fusGpsPosition + distance, 2.0f * sigma * sigma);
+            }
+        }
+    }
+    fusGpsSeen = true;
+    fusGpsMs = nowMs;
+    fusGpsLatitude = latitude;
+    fusGpsLongitude = longitude;
+    fusGpsPosition = fusX[FUS_S];
+    fusSpeedMs = nowMs;
+}
+
+bool fusionIsValid(void){
+    return fusValid;
+}
+
+/*!
+    @brief      Estimated speed [m/s], at the last sample
+*/
+float fusionGetSpeed(void){
+    return fusValid ? fusX[FUS_V] : 0;
+}
+
+/*!
+    @brief      Standard deviation of the speed [m/s], grows while coasting
+*/
+float fusionGetSpeedSigma(void){
+    return fusValid ? sqrtf(fusP[FUS_V][FUS_V]) : INFINITY;
+}
+
+/*!
+    @brief      Along-track position from the reset [m]
+*/
+float fusionGetDistance(void){
+    return fusValid ? fusX[FUS_S] : 0;
+}
+
+/*!
+    @brief      Estimated bias of the acceleration [m/s^2]
+*/
+float fusionGetBias(void){
+    return fusValid ? fusX[FUS_B] : 0;
+}
+
+/*!
+    @brief      Source that is correcting the estimate
+    @param      nowMs: current time [ms]
+*/
+FusionSource_t fusionGetSource(uint32_t nowMs){
+    if(!fusValid){
+        return FUSION_SOURCE_NONE;
+    }
+    if(fusWheelSeen && nowMs - fusWheelMs <= FUSION_WHEEL_TIMEOUT_MS){
+        return FUSION_SOURCE_WHEEL;
+    }
+    if(fusGpsSeen && nowMs - fusGpsMs <= FUSION_GPS_TIMEOUT_MS){
+        return FUSION_SOURCE_GPS;
+    }
+    return FUSION_SOURCE_COAST;
+}
+
+/*! @} */ //End of Fusion_Module
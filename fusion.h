@@ -0,0 +1,76 @@
+/*!
+    @file       fusion.h
+    @ingroup    Fusion_Module
+    @brief      Speed and along-track position estimator fusing wheel, GPS and accelerometer
+    @details    The wheel speed and the GPS speed disagree and each one has its defects: the wheel
+                speed is the mean of the last revolution and stops updating when the wheel stops, the
+                GPS is late and missing in tunnels and under trees. The estimator is a Kalman filter
+                on three states:
+                - s: along-track position from the reset [m];
+                - v: speed [m/s];
+                - b: bias of the longitudinal acceleration [m/s^2] (mounting, calibration).
+                The longitudinal acceleration of the MPU6050, averaged on the BSS window and without
+                the gravity (see attitude.h), drives the prediction; the wheel speed, the GPS speed and
+                the distance between two GPS fixes correct it. The model is linear, so the extended
+                filter reduces to the plain Kalman filter; the measurements are scalar and select a
+                single state, so an update is a handful of single precision operations and no
+                matrix inversion.
+                Without wheel and GPS the estimate coasts on the accelerometer for at most
+                @ref FUSION_MAX_COAST_MS, then the speed is held.
+                The module does not depend on the hardware.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __FUSION_H__
+#define __FUSION_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Fusion_Module Sensor Fusion
+    @name       Sensor Fusion Module
+    @{
+*/
+
+#define FUSION_GRAVITY              9.81f
+#define FUSION_ACCEL_SIGMA          0.5f        //!< Noise of the acceleration input [m/s^2]
+#define FUSION_BIAS_DRIFT           0.0005f     //!< Random walk of the bias [(m/s^2)^2/s]
+#define FUSION_BIAS_SIGMA0          0.3f        //!< Initial uncertainty of the bias [m/s^2]
+#define FUSION_ACCEL_MAX            15.0f       //!< Larger accelerations are shocks, not speed changes [m/s^2]
+
+#define FUSION_WHEEL_SIGMA          0.2f        //!< Wheel speed [m/s]
+#define FUSION_GPS_SPEED_SIGMA      0.3f        //!< GPS speed for a unit HDOP [m/s]
+#define FUSION_GPS_POS_SIGMA        2.5f        //!< GPS position for a unit HDOP [m]
+#define FUSION_GPS_MAX_HDOP         4.0f        //!< Worse fixes are not used, as in the GPX track
+#define FUSION_GPS_MIN_INTERVAL_MS  500u        //!< Fixes closer in time are the same epoch
+#define FUSION_GPS_TIMEOUT_MS       5000u       //!< Longer gaps restart the position measurement
+#define FUSION_MOVING_SPEED         (3.0f / 3.6f) //!< Slower GPS steps are jitter [m/s]
+
+#define FUSION_MAX_COAST_MS         30000u      //!< Longest prediction on the accelerometer alone
+
+//! Source of the last speed correction
+typedef enum{
+    FUSION_SOURCE_NONE = 0,                     //!< No measurement yet
+    FUSION_SOURCE_WHEEL,
+    FUSION_SOURCE_GPS,
+    FUSION_SOURCE_COAST,                        //!< Accelerometer only, wheel and GPS missing
+} FusionSource_t;
+
+void fusionReset(uint32_t nowMs);
+void fusionAddAccel(uint32_t nowMs, float accel);
+void fusionAddWheel(uint32_t nowMs, float speed);
+void fusionAddGps(uint32_t nowMs, float latitude, float longitude, float speed, float hdop);
+
+bool fusionIsValid(void);
+float fusionGetSpeed(void);
+float fusionGetSpeedSigma(void);
+float fusionGetDistance(void);
+float fusionGetBias(void);
+FusionSource_t fusionGetSource(uint32_t nowMs);
+
+/*! @} */ //End of Fusion_Module
+
+#endif // __FUSION_H__
@@ -0,0 +1,384 @@
+/*!
+    @file       lights.c
+    @ingroup    Lights_Module
+    @brief      PWM engine of the front and rear lights implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifndef SIMULATE_HARDWARE
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/devices/msp432p4xx/inc/msp.h>
+/* Hardware Includes */
+#include <Hardware/SWTIMER_Driver.h>
+#endif
+
+/* Local Includes */
+#include "lights.h"
+
+/*!
+    @addtogroup Lights_Module
+    @{
+*/
+
+#define LG_LEVELS                   (LIGHTS_LEVEL_MAX + 1)
+#define LG_OFF                      LIGHTS_PWM_PERIOD           //!< Compare value never reached
+
+//Tables of compare values, read by the DMA
+static uint16_t lgRising[LG_LEVELS];        //!< Level i
+static uint16_t lgFalling[LG_LEVELS];       //!< Level LIGHTS_LEVEL_MAX - i
+static uint16_t lgPulse[LIGHTS_PULSE_LEN];
+static uint8_t lgPulseLevel[LIGHTS_PULSE_LEN];
+
+static uint8_t lgFront;
+static uint8_t lgRear;                      //!< Level at the end of the sequence
+static uint8_t lgSeqFrom;                   //!< Level at the start of the sequence
+static int8_t lgSeqDir;                     //!< 1 rising ramp, -1 falling ramp, 0 pulse
+static uint16_t lgSeqLen;
+
+/*!
+    @brief      Compare value of a duty in set/reset mode
+    @param      duty: high counts of a period, up to @ref LIGHTS_DUTY_MAX
+*/
+static uint16_t lgCompareOf(uint16_t duty){
+    return duty == 0 ? LG_OFF : (uint16_t)(LIGHTS_DUTY_MAX - duty);
+}
+
+/*!
+    @brief      Duty of a level, uniform steps of brightness to the eye
+    @details    At least one count for every level above 0, so a dim light is not off.
+*/
+static uint16_t lgDutyOf(uint8_t level){
+    uint16_t duty = (uint16_t)(LIGHTS_DUTY_MAX * powf((float)level / LIGHTS_LEVEL_MAX, LIGHTS_GAMMA) + 0.5f);
+    if(level > 0 && duty == 0){
+        duty = 1;
+    }
+    return duty;
+}
+
+/*!
+    @brief      Build the tables of the ramps and of the pulse
+    @details    The pulse rises in @ref LIGHTS_PULSE_EDGE steps to full brightness, holds it for
+                @ref LIGHTS_PULSE_HOLD steps and falls back to off in as many steps.
+*/
+static void lgBuildTables(void){
+    uint16_t i;
+    for(i = 0; i < LG_LEVELS; ++i){
+        lgRising[i] = lgCompareOf(lgDutyOf((uint8_t)i));
+    }
+    for(i = 0; i < LG_LEVELS; ++i){
+        lgFalling[i] = lgRising[LIGHTS_LEVEL_MAX - i];
+    }
+    for(i = 0; i < LIGHTS_PULSE_EDGE; ++i){
+        lgPulseLevel[i] = (uint8_t)((LIGHTS_LEVEL_MAX * (i + 1) + LIGHTS_PULSE_EDGE / 2) / LIGHTS_PULSE_EDGE);
+        lgPulseLevel[LIGHTS_PULSE_EDGE + LIGHTS_PULSE_HOLD + i] =
+            (uint8_t)((LIGHTS_LEVEL_MAX * (LIGHTS_PULSE_EDGE - 1 - i) + LIGHTS_PULSE_EDGE / 2) / LIGHTS_PULSE_EDGE);
+    }
+    for(i = 0; i < LIGHTS_PULSE_HOLD; ++i){
+        lgPulseLevel[LIGHTS_PULSE_EDGE + i] = LIGHTS_LEVEL_MAX;
+    }
+    for(i = 0; i < LIGHTS_PULSE_LEN; ++i){
+        lgPulse[i] = lgRising[lgPulseLevel[i]];
+    }
+}
+
+/*!
+    @brief      Compare value of a level
+    @param      level: brightness, saturated to @ref LIGHTS_LEVEL_MAX
+*/
+uint16_t lightsGetCompare(uint8_t level){
+    return lgRising[level > LIGHTS_LEVEL_MAX ? LIGHTS_LEVEL_MAX : level];
+}
+
+/*!
+    @brief      Front light level for the ambient light
+    @details    Full brightness in the dark, linear down to @ref LIGHTS_DIM_LEVEL at the threshold
+                of the lights: less power at dusk, when the light is seen anyway.
+    @param      light: ambient light, the unit of @ref lightOn
+    @param      lightOn: threshold of the lights on
+*/
+uint8_t lightsAmbientLevel(float light, float lightOn){
+    float level;
+    if(lightOn <= 0.0f || light >= lightOn){
+        return LIGHTS_DIM_LEVEL;
+    }
+    if(light <= 0.0f){
+        return LIGHTS_LEVEL_MAX;
+    }
+    level = LIGHTS_DIM_LEVEL + (LIGHTS_LEVEL_MAX - LIGHTS_DIM_LEVEL) * (lightOn - light) / lightOn;
+    return (uint8_t)(level + 0.5f);
+}
+
+uint8_t lightsGetFront(void){
+    return lgFront;
+}
+
+/*!
+    @brief      Battery current of the lights at their levels now, average over a PWM period [mA]
+*/
+float lightsGetCurrent(void){
+    return (LIGHTS_FRONT_MA * lgDutyOf(lightsGetFront()) + LIGHTS_REAR_MA * lgDutyOf(lightsGetRear())) / LIGHTS_PWM_PERIOD;
+}
+
+#ifndef SIMULATE_HARDWARE
+
+#define LG_TICKS_PER_PERIOD         (LIGHTS_PWM_PERIOD * SWTIMER_TICK_HZ / LIGHTS_ACLK_HZ)
+
+#define LG_ENTER_CRITICAL()         bool wasDisabled = MAP_Interrupt_disableMaster()
+#define LG_EXIT_CRITICAL()          if(!wasDisabled){ MAP_Interrupt_enableMaster(); }
+
+//On-time of the outputs, for the energy accounting
+static const uint16_t* lgSeqTable;          //!< Table of the last sequence of the rear light
+static uint16_t lgSeqDone;                  //!< Steps of the sequence already accounted
+static uint32_t lgFrontSince;               //!< End of the last period accounted, software timer ticks
+static uint32_t lgRearSince;
+static uint64_t lgFrontHigh;                //!< ACLK counts at high level since the init
+static uint64_t lgRearHigh;
+
+/*!
+    @brief      Duty of a compare value, the inverse of lgCompareOf
+*/
+static uint16_t lgDutyOfCompare(uint16_t compare){
+    return compare >= LG_OFF ? 0 : (uint16_t)(LIGHTS_DUTY_MAX - compare);
+}
+
+/*!
+    @brief      Account the high counts of the whole PWM periods since the last call
+    @details    Called before every change of a level and by lightsGetOnTime. A sequence of the rear light is accounted step by step from its
+                table, then the last level until now.
+                The levels change in the flashing timer ISR and the on-time is read by the power
+                task: the accounting runs with the interrupts disabled.
+*/
+static void lgAccount(void){
+    uint32_t now;
+    uint32_t periods;
+    LG_ENTER_CRITICAL();
+
+    now = SWTIMER_Now();
+    periods = (now - lgFrontSince) / LG_TICKS_PER_PERIOD;
+    lgFrontSince += periods * LG_TICKS_PER_PERIOD;
+    lgFrontHigh += (uint64_t)lgDutyOfCompare(lgRising[lgFront]) * periods;
+
+    periods = (now - lgRearSince) / LG_TICKS_PER_PERIOD;
+    lgRearSince += periods * LG_TICKS_PER_PERIOD;
+    while(periods > 0 && lgSeqDone < lgSeqLen){
+        lgRearHigh += lgDutyOfCompare(lgSeqTable[lgSeqDone++]);
+        periods--;
+    }
+    lgRearHigh += (uint64_t)lgDutyOfCompare(lgRising[lgRear]) * periods;
+    LG_EXIT_CRITICAL();
+}
+
+//! Up mode on ACLK, no interrupts: CCR0 only triggers the DMA
+static const Timer_A_UpModeConfig lgUpConfig = {
+    TIMER_A_CLOCKSOURCE_ACLK,
+    TIMER_A_CLOCKSOURCE_DIVIDER_1,
+    LIGHTS_PWM_PERIOD - 1,
+    TIMER_A_TAIE_INTERRUPT_DISABLE,
+    TIMER_A_CCIE_CCR0_INTERRUPT_DISABLE,
+    TIMER_A_DO_CLEAR
+};
+
+static const Timer_A_CompareModeConfig lgFrontConfig = {
+    TIMER_A_CAPTURECOMPARE_REGISTER_3,
+    TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+    TIMER_A_OUTPUTMODE_SET_RESET,
+    LG_OFF
+};
+
+static const Timer_A_CompareModeConfig lgRearConfig = {
+    TIMER_A_CAPTURECOMPARE_REGISTER_4,
+    TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+    TIMER_A_OUTPUTMODE_SET_RESET,
+    LG_OFF
+};
+
+/*!
+    @brief      Copy a table into TA2CCR4, one value per PWM period
+    @details    The channel in basic mode stops by itself at the end, its completion interrupt
+                is not enabled.
+*/
+static void lgStart(const uint16_t* table, uint16_t len){
+    MAP_DMA_disableChannel(LIGHTS_DMA_CHANNEL);
+    MAP_DMA_setChannelTransfer(DMA_CH4_TIMERA2CCR0 | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC,
+                               (void*) table,
+                               (void*) &TIMER_A2->CCR[LIGHTS_CCR_REAR],
+                               len);
+    lgSeqTable = table;
+    lgSeqDone = 0;
+    lgSeqLen = len;
+    MAP_DMA_enableChannel(LIGHTS_DMA_CHANNEL);
+}
+
+/*!
+    @brief      PWM and DMA initialization, both lights off
+    @details    The DMA module must be already initialized with dmaInit.
+*/
+void lightsInit(void){
+    lgBuildTables();
+    lgFront = 0;
+    lgRear = 0;
+    lgSeqLen = 0;
+    lgFrontSince = SWTIMER_Now();
+    lgRearSince = lgFrontSince;
+    MAP_GPIO_setAsPeripheralModuleFunctionOutputPin(LIGHTS_PORT, LIGHTS_PIN_FRONT | LIGHTS_PIN_REAR,
+                                                    GPIO_PRIMARY_MODULE_FUNCTION);
+    MAP_Timer_A_configureUpMode(LIGHTS_TIMER, &lgUpConfig);
+    MAP_Timer_A_initCompare(LIGHTS_TIMER, &lgFrontConfig);
+    MAP_Timer_A_initCompare(LIGHTS_TIMER, &lgRearConfig);
+
+    MAP_DMA_assignChannel(DMA_CH4_TIMERA2CCR0);
+    MAP_DMA_setChannelControl(DMA_CH4_TIMERA2CCR0 | UDMA_PRI_SELECT,
+                              UDMA_SIZE_16 | UDMA_SRC_INC_16 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+
+    MAP_Timer_A_startCounter(LIGHTS_TIMER, TIMER_A_UP_MODE);
+}
+
+/*!
+    @brief      Front light level, from the next PWM period
+*/
+void lightsSetFront(uint8_t level){
+    lgAccount();
+    lgFront = level > LIGHTS_LEVEL_MAX ? LIGHTS_LEVEL_MAX : level;
+    MAP_Timer_A_setCompareValue(LIGHTS_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_3, lgRising[lgFront]);
+}
+
+/*!
+    @brief      Rear light level at once, the running sequence is stopped
+*/
+void lightsSetRear(uint8_t level){
+    MAP_DMA_disableChannel(LIGHTS_DMA_CHANNEL);
+    lgAccount();
+    lgSeqLen = 0;
+    lgRear = level > LIGHTS_LEVEL_MAX ? LIGHTS_LEVEL_MAX : level;
+    MAP_Timer_A_setCompareValue(LIGHTS_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_4, lgRising[lgRear]);
+}
+
+/*!
+    @brief      Ramp of the rear light from its current level, one level per PWM period
+    @details    The full range takes @ref LIGHTS_LEVEL_MAX steps of @ref LIGHTS_STEP_MS.
+*/
+void lightsRampRear(uint8_t level){
+    uint8_t from = lightsGetRear();
+    lgAccount();
+    if(level > LIGHTS_LEVEL_MAX){
+        level = LIGHTS_LEVEL_MAX;
+    }
+    if(level == from){
+        lightsSetRear(level);
+        return;
+    }
+    lgSeqFrom = from;
+    lgRear = level;
+    if(level > from){
+        lgSeqDir = 1;
+        lgStart(&lgRising[from + 1], level - from);
+    }else{
+        lgSeqDir = -1;
+        lgStart(&lgFalling[LIGHTS_LEVEL_MAX - from + 1], from - level);
+    }
+}
+
+/*!
+    @brief      Soft pulse of the rear light, from off to full brightness and back to off
+*/
+void lightsPulseRear(void){
+    lgSeqFrom = lightsGetRear();
+    lgAccount();
+    lgSeqDir = 0;
+    lgRear = 0;
+    lgStart(lgPulse, LIGHTS_PULSE_LEN);
+}
+
+bool lightsRearBusy(void){
+    return MAP_DMA_isChannelEnabled(LIGHTS_DMA_CHANNEL);
+}
+
+/*!
+    @brief      Rear light level now, also in the middle of a sequence
+*/
+uint8_t lightsGetRear(void){
+    uint16_t done;
+    if(!lightsRearBusy()){
+        return lgRear;
+    }
+    done = lgSeqLen - MAP_DMA_getChannelSize(DMA_CH4_TIMERA2CCR0 | UDMA_PRI_SELECT);
+    if(done == 0){
+        return lgSeqFrom;
+    }
+    if(lgSeqDir == 0){
+        return lgPulseLevel[done - 1];
+    }
+    return (uint8_t)(lgSeqFrom + lgSeqDir * (int16_t)done);
+}
+
+/*!
+    @brief      On-time of the lights at full duty since the init, the high time of their outputs
+    @details    For the energy accounting: the values wrap, the difference of two calls closer than
+                an hour is the on-time between them.
+    @param      frontUs: filled with the on-time of the front light [us]
+    @param      rearUs: filled with the on-time of the rear light [us]
+*/
+void lightsGetOnTime(uint32_t* frontUs, uint32_t* rearUs){
+    uint64_t frontHigh, rearHigh;
+    LG_ENTER_CRITICAL();
+    lgAccount();
+    frontHigh = lgFrontHigh;
+    rearHigh = lgRearHigh;
+    LG_EXIT_CRITICAL();
+    *frontUs = (uint32_t)(frontHigh * 1000000u / LIGHTS_ACLK_HZ);
+    *rearUs = (uint32_t)(rearHigh * 1000000u / LIGHTS_ACLK_HZ);
+}
+
+#else
+
+//No timer on the PC: the sequences end at once
+
+void lightsInit(void){
+    lgBuildTables();
+    lgFront = 0;
+    lgRear = 0;
+}
+
+void lightsSetFront(uint8_t level){
+    lgFront = level > LIGHTS_LEVEL_MAX ? LIGHTS_LEVEL_MAX : level;
+}
+
+void lightsSetRear(uint8_t level){
+    lgRear = level > LIGHTS_LEVEL_MAX ? LIGHTS_LEVEL_MAX : level;
+}
+
+void lightsRampRear(uint8_t level){
+    lightsSetRear(level);
+}
+
+void lightsPulseRear(void){
+    lgSeqFrom = lgRear;
+    lgSeqDir = 0;
+    lgSeqLen = LIGHTS_PULSE_LEN;
+    lgRear = 0;
+}
+
+bool lightsRearBusy(void){
+    return false;
+}
+
+uint8_t lightsGetRear(void){
+    return lgRear;
+}
+
+void lightsGetOnTime(uint32_t* frontUs, uint32_t* rearUs){
+    *frontUs = 0;
+    *rearUs = 0;
+}
+
+#endif
+
+/*! @} */ //End of Lights_Module
@@ -0,0 +1,79 @@
+/*!
+    @file       lights.h
+    @ingroup    Lights_Module
+    @brief      PWM engine of the front and rear lights
+    @details    The lights are two PWM outputs of TIMER_A2 in up mode on ACLK: P6.6 front (TA2.3)
+                and P6.7 rear (TA2.4), @ref LIGHTS_PWM_PERIOD counts, so 256 Hz and no flicker.
+                The brightness is a level from 0 to @ref LIGHTS_LEVEL_MAX, uniform to the eye: the
+                duty is the level to the power of @ref LIGHTS_GAMMA, precomputed as compare values.
+                The outputs are in set/reset mode, set at CCRn and reset at CCR0: the duty is
+                CCR0 - CCRn counts and a compare value beyond CCR0 keeps the light off, without the
+                one count pulse of a zero compare value.
+                The sequences of the rear light, the ramps of the brake light and the pulses of
+                the daytime flash, are tables of compare values copied into TA2CCR4 by DMA channel
+                4 in basic mode, one value at every CCR0 event: one step per PWM period
+                (@ref LIGHTS_STEP_MS), no interrupt per step and none at the end, the last value
+                stays in the register. A new value is written while the counter is at CCR0 or 0,
+                so every period has the duty of one level.
+                The high time of the outputs is accounted at every change of a level, step by step
+                along a sequence, for the energy accounting of energy.h.
+                Test/lights.py builds the same tables and runs them on a model of the timer.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __LIGHTS_H__
+#define __LIGHTS_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Lights_Module Lights
+    @name       Lights Module
+    @{
+*/
+
+#define LIGHTS_TIMER                TIMER_A2_BASE
+#define LIGHTS_PORT                 GPIO_PORT_P6
+#define LIGHTS_PIN_FRONT            GPIO_PIN6   //!< TA2.3
+#define LIGHTS_PIN_REAR             GPIO_PIN7   //!< TA2.4
+#define LIGHTS_CCR_FRONT            3
+#define LIGHTS_CCR_REAR             4
+#define LIGHTS_DMA_CHANNEL          4           //!< DMA channel of TA2CCR0
+
+#define LIGHTS_ACLK_HZ              32768
+#define LIGHTS_PWM_PERIOD           128         //!< ACLK counts of a period
+#define LIGHTS_DUTY_MAX             (LIGHTS_PWM_PERIOD - 1)     //!< Longest high time [counts]
+#define LIGHTS_STEP_MS              (1000.0f * LIGHTS_PWM_PERIOD / LIGHTS_ACLK_HZ)
+#define LIGHTS_LEVEL_MAX            63          //!< Full brightness
+#define LIGHTS_GAMMA                2.2f
+
+#define LIGHTS_TAIL_LEVEL           40          //!< Rear light at night, a third of the power
+#define LIGHTS_DAY_LEVEL            48          //!< Front daytime flash
+#define LIGHTS_DIM_LEVEL            32          //!< Front light with the ambient light at the threshold
+#define LIGHTS_PULSE_EDGE           16          //!< Steps of a rising or falling edge of a pulse
+#define LIGHTS_PULSE_HOLD           16          //!< Steps of a pulse at full brightness
+#define LIGHTS_PULSE_LEN            (2 * LIGHTS_PULSE_EDGE + LIGHTS_PULSE_HOLD)
+
+#define LIGHTS_FRONT_MA             250.0f      //!< Battery current of the front light at full duty
+#define LIGHTS_REAR_MA              60.0f       //!< Battery current of the rear light at full duty
+
+void lightsInit(void);
+void lightsSetFront(uint8_t level);
+void lightsSetRear(uint8_t level);
+void lightsRampRear(uint8_t level);
+void lightsPulseRear(void);
+bool lightsRearBusy(void);
+uint8_t lightsGetFront(void);
+uint8_t lightsGetRear(void);
+
+uint16_t lightsGetCompare(uint8_t level);
+uint8_t lightsAmbientLevel(float light, float lightOn);
+float lightsGetCurrent(void);
+void lightsGetOnTime(uint32_t* frontUs, uint32_t* rearUs);
+
+/*! @} */ //End of Lights_Module
+
+#endif // __LIGHTS_H__
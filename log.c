@@ -0,0 +1,81 @@
+/*!
+    @file       log.c
+    @ingroup    Log_Module
+    @brief      Host sink of the log messages
+    @details    On the target the messages go directly to MSPrintf, only the host needs an
+                implementation.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifdef SIMULATE_HARDWARE
+
+#define _POSIX_C_SOURCE 200112L
+
+/* Standard Includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+/* Local Includes */
+#include "log.h"
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+
+/*!
+    @addtogroup Log_Module
+    @{
+*/
+
+#define LOG_HOST_LINE_LEN   256     //!< Longest message, the exceeding part is dropped
+
+static int logHostFd = STDOUT_FILENO;   //!< Destination of the messages
+static uint32_t logHostDrops;           //!< Bytes not written, like the drops of the UART ring
+
+/*!
+    @brief    Redirect the messages
+    @details  With a non blocking fd (e.g. a pipe read by a test) a full pipe drops the message
+              instead of blocking, as the TX ring does on the target.
+    @param    fd: file descriptor
+*/
+void logSetHostFd(int fd){
+    logHostFd = fd;
+}
+
+/*!
+    @brief    Get the number of bytes dropped
+    @return   bytes not written because the message was too long or the fd was full
+*/
+uint32_t logGetHostDrops(void){
+    return logHostDrops;
+}
+
+/*!
+    @brief    Format a message and write it to the fd
+    @param    format: printf format
+*/
+void logHostPrintf(const char* format, ...){
+    char line[LOG_HOST_LINE_LEN];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if(len < 0){
+        return;
+    }
+    if(len >= (int)sizeof(line)){
+        logHostDrops += len - (sizeof(line) - 1);
+        len = sizeof(line) - 1;
+    }
+    ssize_t written = write(logHostFd, line, len);
+    if(written < len){
+        logHostDrops += len - (written > 0 ? written : 0);
+    }
+}
+
+/*! @} */ // Log_Module
+
+#endif // LOG_LEVEL > LOG_LEVEL_NONE
+
+#endif // SIMULATE_HARDWARE
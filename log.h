@@ -0,0 +1,82 @@
+/*!
+    @file       log.h
+    @ingroup    Log_Module
+    @brief      Leveled debug output on the PC UART
+    @details    The messages are formatted with MSPrintf into the TX ring of UART0, drained by the TX
+                interrupt, so a print does not stall the caller for the transmission time; when the
+                ring is full the bytes are dropped and counted (see UART_GetTxDrops).
+                The level is selected at compile time with LOG_LEVEL: the messages above it are
+                removed by the preprocessor. By default a DEBUG build prints everything, a release or
+                STAND_ALONE build prints nothing.
+                With SIMULATE_HARDWARE the messages are written to a file descriptor (stdout by
+                default), that can be redirected to a pipe with @ref logSetHostFd for the tests
+                (Test/logHost.c checks the levels through one).
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __LOG_H__
+#define __LOG_H__
+
+/* Standard Includes */
+#include <stdint.h>
+
+/*!
+    @defgroup   Log_Module Log
+    @name       Log Module
+    @{
+*/
+
+#define LOG_LEVEL_NONE      0       //!< No output
+#define LOG_LEVEL_ERROR     1       //!< Errors only
+#define LOG_LEVEL_WARN      2       //!< Errors and warnings
+#define LOG_LEVEL_INFO      3       //!< Main events (start/stop, reports)
+#define LOG_LEVEL_DEBUG     4       //!< Everything, e.g. the parsed NMEA sentences
+
+#ifndef LOG_LEVEL
+    #if defined(SIMULATE_HARDWARE) || (defined(DEBUG) && !defined(STAND_ALONE))
+        #define LOG_LEVEL   LOG_LEVEL_DEBUG
+    #else
+        #define LOG_LEVEL   LOG_LEVEL_NONE
+    #endif
+#endif
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+    #ifndef SIMULATE_HARDWARE
+        #include <Devices/MSPIO.h>
+        #define LOG_PRINT(...)  MSPrintf(EUSCI_A0_BASE, __VA_ARGS__)
+    #else
+        #define LOG_PRINT(...)  logHostPrintf(__VA_ARGS__)
+        void logHostPrintf(const char* format, ...);
+        void logSetHostFd(int fd);
+        uint32_t logGetHostDrops(void);
+    #endif
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+    #define LOG_ERROR(...)      LOG_PRINT(__VA_ARGS__)
+#else
+    #define LOG_ERROR(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+    #define LOG_WARN(...)       LOG_PRINT(__VA_ARGS__)
+#else
+    #define LOG_WARN(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+    #define LOG_INFO(...)       LOG_PRINT(__VA_ARGS__)
+#else
+    #define LOG_INFO(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    #define LOG_DEBUG(...)      LOG_PRINT(__VA_ARGS__)
+#else
+    #define LOG_DEBUG(...)
+#endif
+
+/*! @} */ //End of Log_Module
+
+#endif // __LOG_H__
@@ -27,6 +27,9 @@
                   |                 |
                   |             P5.1|----< BTN Start
                   |             P3.5|----< BTN Stop
+                  |                 |
+                  |          P5.5/A0|----< Battery, divider by 2
+                  |             P2.6|----> LCD    Backlight
                   -------------------
              @endcode
  	@date       03/02/2024
@@ -42,9 +45,11 @@
 	#include <Hardware/GPIO_Driver.h>
 	#include <Hardware/CS_Driver.h>
 	#include <Hardware/TIMERA_Driver.h>
+	#include <Hardware/SWTIMER_Driver.h>
 	#include <Hardware/SD_Driver.h>
 	#include <fatfs/ff.h>
 	#include <fatfs/diskio.h>
+	#include <fatfs/mmc_MSP432P401r.h>
 	#include <Devices/MSPIO.h>
     #include <DMAModule.h>
     //LCD
@@ -58,6 +63,16 @@
     #include "HAL_I2C.h"
     #include "MPU6050.h"
     #include "BSS.h"
+    //Scheduler
+    #include "scheduler.h"
+    //Profiler
+    #include "profiler.h"
+    //Energy accounting
+    #include "energy.h"
+    //Telemetry
+    #include "telemetry.h"
+    //Phone sync
+    #include "sync.h"
 
 #else
 	#include <stdlib.h>
@@ -68,9 +83,13 @@
     #include <stdint.h>
     #include <time.h>
     #include "BSS.h"
+    //Energy accounting of the replay
+    #include "profiler.h"
+    #include "energy.h"
 #endif
 
 //Standard includes
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -86,18 +105,35 @@
 #include "GPX.h"
 //GPS
 #include "GPS.h"
-
-#ifndef SIMULATE_HARDWARE
-    #if !defined(DEBUG) || defined(STAND_ALONE)
-        #define PRINTF(...)
-    #else
-        #include <Devices/MSPIO.h>
-        #define PRINTF(...) MSPrintf(EUSCI_A0_BASE ,__VA_ARGS__)
-    #endif
-#else
-    #include <stdio.h>
-    #define PRINTF(...) printf(__VA_ARGS__)
-#endif
+//Clock disciplined by the GPS
+#include "rtc.h"
+#include "numFormat.h"
+//Ride statistics
+#include "rideStats.h"
+//Elevation filter and climbs
+#include "elevation.h"
+//Speed from wheel, GPS and accelerometer
+#include "fusion.h"
+//Track without the GPS
+#include "deadReckoning.h"
+//Lean, pitch and yaw rate from the MPU6050
+#include "attitude.h"
+//Orientation of the MPU6050 on the bike
+#include "mountCalib.h"
+//Crash detection and black box
+#include "crash.h"
+//State machine and thresholds of the BSS
+#include "bssFsm.h"
+//PWM engine of the lights
+#include "lights.h"
+
+//Battery state of charge and power governor
+#include "battery.h"
+#include "power.h"
+
+//Asynchronous output on the PC UART, see log.h for the levels
+#include "log.h"
+#define PRINTF(...) LOG_INFO(__VA_ARGS__)
 
     //.
 // volatile bool flagTemp;     //!< Flag to arise if a new temperature value is sampled
@@ -147,23 +183,16 @@ const Timer_A_ContinuousModeConfig speedContinuousModeConfig =
         TIMER_A_OUTPUTMODE_OUTBITVALUE            // Output bit value
     };
 
-    // THIS TIMER IS FOR LED FLASHING   --> Timer_A Up Configuration Parameter
-    const Timer_A_UpModeConfig bssUpConfig =
-    {
-        TIMER_A_CLOCKSOURCE_ACLK,               // ACLK = 32,768 KhZ
-        TIMER_A_CLOCKSOURCE_DIVIDER_32,         // ACLK/32 = 1 KhZ --> 1 tick = 1 millisecond
-        150,                                    // generate interrupt every 150 millisecond == 150 tick
-        TIMER_A_TAIE_INTERRUPT_DISABLE,         // Disable Timer interrupt
-        TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE,     // Enable CCR0 interrupt
-        TIMER_A_DO_CLEAR                        // Clear value
-    };
-
 //Buttons defines
 #define BTN_START_PORT      GPIO_PORT_P5
 #define BTN_START_PIN       GPIO_PIN1
 #define BTN_STOP_PORT       GPIO_PORT_P3
 #define BTN_STOP_PIN        GPIO_PIN5
 
+//LCD backlight of the MKII, switched by the power governor
+#define LCD_BACKLIGHT_PORT  GPIO_PORT_P2
+#define LCD_BACKLIGHT_PIN   GPIO_PIN6
+
 #define GPX_TEST_FILENAME   "test.gpx"
 FIL file;
 #define GPX_TEST_FILE       file
@@ -189,8 +218,8 @@ eUSCI_UART_ConfigV1 UART0Config = {
 
 /*!
     @brief      SPI Configuration Parameter.
-    @details    These are the configuration parameters to
-                make the eUSCI B SPI module to operate with a 500KHz clock.
+    @details    Initial configuration of the eUSCI B SPI module. The SD card and the LCD register
+                their own profiles on the SPI bus manager, that loads them when a device takes the bus.
 */
 eUSCI_SPI_MasterConfig SPI0MasterConfig = {
      EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
@@ -202,7 +231,10 @@ eUSCI_SPI_MasterConfig SPI0MasterConfig = {
      EUSCI_B_SPI_3PIN
 };
 
-eUSCI_SPI_MasterConfig config = {
+/*!
+    @brief      LCD SPI profile, loaded by the SPI bus manager when the LCD takes EUSCI_B0
+*/
+eUSCI_SPI_MasterConfig LCDMasterConfig = {
     EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
     LCD_SYSTEM_CLOCK_SPEED,
     LCD_SPI_CLOCK_SPEED,
@@ -217,10 +249,821 @@ DIR DI;
 FILINFO FI;
 FIL file;
 
-//Buttons Global Variables
-bool btnStartStateP = true;
-bool btnStopStateP = true;
+//Light averaging
+static uint_fast16_t lightToSendAverage = 0;
+
+//Telemetry tick
+static SWTIMER_Timer_t telemTimer;
+static uint8_t telemProfRegion = 0;         //!< Profiler region sent by the next profiler message
+
+//Ride summary written in the ride index at the end of the ride
+static char rideFileName[15];
+static char rideStartTime[NUMFORMAT_ISO8601_MS_LEN];
+static uint32_t rideStartMs;
+
+static float wheelSpeed = 0;                //!< Speed of the last wheel round [km/h], the LCD shows the fused one
+static bool trackBroken;                    //!< The track segment has been closed at the loss of the fix
+
+//Power governor, the settings of the current mode
+static SWTIMER_Timer_t powerTimer;
+static uint32_t uiPeriodMs;                 //!< Shortest period of the LCD refresh requested by the GPS
+static uint32_t uiLastMs;
+static uint32_t sdSyncMs;                   //!< Period of the sync of the GPX file
+static uint32_t sdSyncLastMs;
+
+/*!
+    @brief      Time base of the ride statistics
+    @return     milliseconds from the software timers time base, not stepped by the GPS like the clock
+*/
+static uint32_t rideNowMs(void){
+    return (uint32_t)(((uint64_t)SWTIMER_Now() * 1000u) / SWTIMER_TICK_HZ);
+}
+
+/*!
+    @brief      Append the summary of the ride to the ride index, the header is written in a new index
+*/
+static void writeRideSummary(void){
+    FIL index;
+    char line[RIDESTATS_SUMMARY_LEN];
+    UINT written;
+
+    if(rideStatsFormatSummary(line, sizeof(line), rideFileName, rideStartTime) == 0){
+        return;
+    }
+    PRINTF("Ride: %s", line);
+    if(f_open(&index, RIDESTATS_INDEX_FILE, FA_WRITE | FA_OPEN_APPEND) != FR_OK){
+        PRINTF("Could not open the ride index\r\n");
+        return;
+    }
+    if(f_size(&index) == 0){
+        PROF_CALL(PROF_F_WRITE, f_write(&index, RIDESTATS_INDEX_HEADER, sizeof(RIDESTATS_INDEX_HEADER) - 1, &written));
+    }
+    PROF_CALL(PROF_F_WRITE, f_write(&index, line, strlen(line), &written));
+    f_close(&index);
+}
+
+/*!
+    @brief      Append the climbs of the ride to the climbs file, the header is written in a new file
+*/
+static void writeClimbs(uint32_t rideStartMs){
+    FIL climbs;
+    char line[sizeof(rideFileName) + ELEV_CLIMB_LEN];
+    UINT written;
+    uint8_t i;
+
+    if(elevationGetClimbCount() == 0){
+        return;
+    }
+    if(f_open(&climbs, ELEV_CLIMBS_FILE, FA_WRITE | FA_OPEN_APPEND) != FR_OK){
+        PRINTF("Could not open the climbs file\r\n");
+        return;
+    }
+    if(f_size(&climbs) == 0){
+        PROF_CALL(PROF_F_WRITE, f_write(&climbs, ELEV_CLIMBS_HEADER, sizeof(ELEV_CLIMBS_HEADER) - 1, &written));
+    }
+    for(i = 0; i < elevationGetClimbCount(); ++i){
+        if(elevationFormatClimb(line, sizeof(line), rideFileName, i, rideStartMs) != 0){
+            PRINTF("Climb: %s", line);
+            PROF_CALL(PROF_F_WRITE, f_write(&climbs, line, strlen(line), &written));
+        }
+    }
+    f_close(&climbs);
+}
+
+/*!
+    @brief      Load the mounting calibration saved by a previous ride, if any
+*/
+static void loadMountCalib(void){
+    FIL mount;
+    char line[MOUNT_LINE_LEN];
+
+    if(f_open(&mount, MOUNT_FILE, FA_READ) != FR_OK){
+        PRINTF("No mounting calibration, it starts from the sensor axes\r\n");
+        return;
+    }
+    //Header, then the calibration
+    if(f_gets(line, sizeof(line), &mount) == NULL || f_gets(line, sizeof(line), &mount) == NULL || !mountCalibParse(line)){
+        PRINTF("Invalid mounting calibration\r\n");
+    }else{
+        PRINTF("Mounting calibration loaded, state %d\r\n", (int)mountCalibGetState());
+    }
+    f_close(&mount);
+}
+
+/*!
+    @brief      Save the mounting calibration if it has changed
+*/
+static void saveMountCalib(void){
+    FIL mount;
+    char line[MOUNT_LINE_LEN];
+    UINT written;
+
+    if(!mountCalibIsUnsaved() || mountCalibFormat(line, sizeof(line)) == 0){
+        return;
+    }
+    if(f_open(&mount, MOUNT_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK){
+        PRINTF("Could not open the mounting calibration\r\n");
+        return;
+    }
+    PROF_CALL(PROF_F_WRITE, f_write(&mount, MOUNT_HEADER, sizeof(MOUNT_HEADER) - 1, &written));
+    PROF_CALL(PROF_F_WRITE, f_write(&mount, line, strlen(line), &written));
+    if(f_close(&mount) == FR_OK){
+        mountCalibSetSaved();
+        PRINTF("Mounting calibration: %s", line);
+    }
+}
+
+/*!
+    @brief      Load the thresholds of the BSS, the file is created with the current ones if it is missing
+    @details    Unknown names and values out of range are skipped, the other values are used from the
+                next BSS window.
+*/
+static void loadBssConfig(void){
+    FIL file;
+    char line[BSS_CONFIG_LINE_LEN];
+    BssConfig_t config;
+    UINT written;
+    uint8_t param;
+    int loaded = 0;
+
+    bssFsmGetConfig(&config);
+    if(f_open(&file, BSS_CONFIG_FILE, FA_READ) == FR_OK){
+        while(f_gets(line, sizeof(line), &file) != NULL){
+            if(bssFsmParseParam(&config, line)){
+                ++loaded;
+            }
+        }
+        f_close(&file);
+        bssFsmSetConfig(&config);
+        PRINTF("BSS thresholds loaded, %d values\r\n", loaded);
+        return;
+    }
+    if(f_open(&file, BSS_CONFIG_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK){
+        PRINTF("Could not create the BSS thresholds\r\n");
+        return;
+    }
+    PROF_CALL(PROF_F_WRITE, f_write(&file, BSS_CONFIG_HEADER, sizeof(BSS_CONFIG_HEADER) - 1, &written));
+    for(param = 0; bssFsmFormatParam(line, sizeof(line), &config, param) != 0; ++param){
+        PROF_CALL(PROF_F_WRITE, f_write(&file, line, strlen(line), &written));
+    }
+    f_close(&file);
+    PRINTF("BSS thresholds saved with the defaults\r\n");
+}
+
+/*!
+    @brief      Print the entries and the time in each class of the BSS and the levels of the lights
+*/
+static void printBssReport(void){
+    uint32_t entries, ms;
+    uint8_t state;
+    for(state = 0; state < BSS_CLASS_COUNT; ++state){
+        bssFsmGetStats((class_t)state, &entries, &ms);
+        PRINTF("%s: %u entries, %u s\r\n", get_class_name((class_t)state), (unsigned)entries, (unsigned)(ms / 1000));
+    }
+    PRINTF("Lights: front %u, rear %u of %u\r\n", lightsGetFront(), lightsGetRear(), LIGHTS_LEVEL_MAX);
+}
+
+/*!
+    @brief      Write the black box of a crash in a new "crash<x>.csv" file
+    @details    The summary of the crash, then the samples before and after the impact. The record
+                is written once: if the file cannot be written it is dropped, so the SD is not
+                retried at every BSS window.
+*/
+static void writeCrashRecord(void){
+    FIL record;
+    char fileName[15];
+    char time[NUMFORMAT_ISO8601_MS_LEN];
+    char line[CRASH_LINE_LEN];
+    CrashEvent_t event;
+    float latitude = 0, longitude = 0;
+    bool fix;
+    uint16_t ms;
+    uint16_t i;
+    UINT written;
+    int fileIndex = 1;
+
+    if(!crashGetEvent(&event)){
+        return;
+    }
+    do{
+        snprintf(fileName, sizeof(fileName), CRASH_FILE_NAME, fileIndex);
+        fileIndex++;
+    }while(f_stat(fileName, &FI) == FR_OK && fileIndex <= 999);
+    if(f_open(&record, fileName, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK){
+        PRINTF("Could not open the crash record\r\n");
+        crashSetSaved();
+        return;
+    }
+    rtcFormatISO8601(time, sizeof(time), rtcNow(&ms), ms);
+    fix = getGpsPosition(&latitude, &longitude) != INVALID;
+    PROF_CALL(PROF_F_WRITE, f_write(&record, CRASH_EVENT_HEADER, sizeof(CRASH_EVENT_HEADER) - 1, &written));
+    if(crashFormatEvent(line, sizeof(line), time, rideFileName, fix, latitude, longitude) != 0){
+        PRINTF("Crash: %s", line);
+        PROF_CALL(PROF_F_WRITE, f_write(&record, line, strlen(line), &written));
+    }
+    PROF_CALL(PROF_F_WRITE, f_write(&record, CRASH_SAMPLES_HEADER, sizeof(CRASH_SAMPLES_HEADER) - 1, &written));
+    for(i = 0; i < event.samples; ++i){
+        if(crashFormatSample(line, sizeof(line), i) != 0){
+            PROF_CALL(PROF_F_WRITE, f_write(&record, line, strlen(line), &written));
+        }
+    }
+    if(f_close(&record) != FR_OK){
+        PRINTF("Could not write the crash record\r\n");
+    }else{
+        PRINTF("Crash record saved in %s\r\n", fileName);
+    }
+    crashSetSaved();
+}
+
+/*!
+    @brief      Write the points estimated without the GPS in the GPX file
+*/
+static void writeDeadReckoning(void){
+    DrPoint_t point;
+    char lat[NUMFORMAT_COORDINATE_LEN];
+    char lon[NUMFORMAT_COORDINATE_LEN];
+    char ele[16];
+    char time[NUMFORMAT_ISO8601_MS_LEN];
+    uint8_t i;
+
+    for(i = 0; deadReckoningGetPoint(i, &point); ++i){
+        numFormatCoordinate(lat, sizeof(lat), point.latitude);
+        numFormatCoordinate(lon, sizeof(lon), point.longitude);
+        numFormatFloat(ele, sizeof(ele), point.altitude, 1);
+        rtcFormatISO8601(time, sizeof(time), point.time, point.ms);
+        GPXAddEstimatedTrackPoint(&GPX_TEST_FILE, lat, lon, ele, time);
+    }
+    deadReckoningClear();
+}
+
+/*!
+    @brief      Switch on the leds of the STOP state
+*/
+static void setStopLeds(void){
+    MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN1);
+    MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN2);
+    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P1, GPIO_PIN0);
+}
+
+/*!
+    @brief      Print the scheduler statistics on the PC UART
+*/
+static void printSchedulerReport(void){
+    SchedStats_t stats;
+    SchedTaskStats_t taskStats;
+    uint8_t i;
+
+    schedGetStats(&stats);
+    PRINTF("Scheduler: %d ms, LPM0 %d permille, %d wakeups\r\n", (int)stats.elapsedMs, (int)stats.sleepPermille, (int)stats.wakeups);
+    for(i = 0; schedGetTaskStats(i, &taskStats); ++i){
+        PRINTF("%s: runs %d, max latency %d us, max run %d us, deadline misses %d\r\n", taskStats.name, (int)taskStats.runs,
+                                                                                        (int)taskStats.maxLatencyUs,
+                                                                                        (int)taskStats.maxRunUs,
+                                                                                        (int)taskStats.deadlineMisses);
+    }
+    PRINTF("UART0: %d bytes dropped, %d telemetry frames dropped\r\n", (int)UART_GetTxDrops(EUSCI_A0_BASE),
+                                                                         (int)telemGetDrops());
+}
+
+/*!
+    @brief      Open a new GPX file and start the tracking
+    @details    The file is called "test.gpx" or "test<xxx>.gpx" if it already exists.
+*/
+static void startRide(void){
+    FRESULT r;
+    bool defaultFile = true;
+    char newFileName[15];
+    int fileIndex = 1;
+
+    r = f_stat(GPX_TEST_FILENAME, &FI);                     //Check if file already exists
+    if(r == FR_OK){                                         //If file already exists
+        defaultFile = false;
+        do{
+            snprintf(newFileName, 14, "test%d.gpx", fileIndex);
+            fileIndex++;
+            r = f_stat(newFileName, &FI);
+        }while(r != FR_NO_FILE && fileIndex <= 999);
+        r = f_open(&GPX_TEST_FILE, newFileName, FA_WRITE | FA_CREATE_ALWAYS);
+    }else if(r == FR_NO_FILE){
+        r = f_open(&GPX_TEST_FILE, GPX_TEST_FILENAME, FA_WRITE | FA_CREATE_ALWAYS);
+    }
+    /*Check for errors. Trap MSP432 if there is an error*/
+    if(r != FR_OK){
+        PRINTF("Could not open file, returned: %d\r\n", (int)r);
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+        while(1);
+    }
+    strcpy(rideFileName, defaultFile ? GPX_TEST_FILENAME : newFileName);
+    GPXInitFile(&GPX_TEST_FILE, rideFileName);
+    //Start of the ride, 1970 if the GPS has not set the clock yet
+    rtcFormatISO8601(rideStartTime, sizeof(rideStartTime), rtcNow(NULL), 0);
+    GPXAddTrack(&GPX_TEST_FILE, rideStartTime);
+    GPXAddTrackSegment(&GPX_TEST_FILE);
+    rideStartMs = rideNowMs();
+    sdSyncLastMs = rideStartMs;
+    rideStatsStart(rideStartMs);
+    elevationStart();
+    fusionReset(rideStartMs);
+    deadReckoningReset();
+    trackBroken = true;                     //No segment to close before the first fix
+    computerState = START;
+    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN2);
+    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN0);
+    PRINTF("START TRACKING!!\r\n");
+    syncSetBusy(true);
+    schedResetStats();
+    profReset();
+    energyReset();
+}
+
+/*!
+    @brief      Close the GPX file and stop the tracking
+*/
+static void stopRide(void){
+    writeDeadReckoning();                   //The fix did not come back, as they are
+    GPXCloseTrackSegment(&GPX_TEST_FILE);
+    GPXCloseTrack(&GPX_TEST_FILE);
+    GPXCloseFile(&GPX_TEST_FILE);
+    rideStatsStop(rideNowMs());
+    elevationFinish();
+    writeRideSummary();
+    writeClimbs(rideStartMs);
+    saveMountCalib();
+    computerState = STOP;
+    syncSetBusy(false);
+    PRINTF("STOP TRACKING!!\r\n");
 
+    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN0);
+    setStopLeds();
+
+    //Report the scheduler and profiler statistics and the energy of the ride
+    printSchedulerReport();
+    UART_Flush(EUSCI_A0_BASE);
+    profReport();
+    UART_Flush(EUSCI_A0_BASE);
+    energyReport();
+    schedResetStats();
+    profReset();
+    energyReset();
+}
+
+/*!
+    @brief      BSS task: acquire a window of accelerations, compute and classify it
+*/
+static void bssTask(SchedEvents_t events){
+    model_t* model = get_model();
+    FusionSource_t source = fusionGetSource(rideNowMs());
+    //The last window is closed by the speed: a new mounting matrix changes the frame of the attitude
+    if(mountCalibAddSpeed(fusionGetSpeed(), source == FUSION_SOURCE_WHEEL || source == FUSION_SOURCE_GPS)){
+        attitudeReset(MPU6050_SAMPLE_PERIOD_S);
+        PRINTF("Mounting calibration, state %d\r\n", (int)mountCalibGetState());
+    }
+    attitudeSetSpeed(fusionGetSpeed());
+    //Wheel silent, the source is not the wheel: stopped
+    crashSetSpeed(source == FUSION_SOURCE_WHEEL ? fusionGetSpeed() : 0.0f);
+    PROF_ENTER(PROF_ACQUIRE_WINDOW);
+    acquire_window(model);
+    PROF_EXIT(PROF_ACQUIRE_WINDOW);
+    PROF_ENTER(PROF_COMPUTE);
+    compute(model);
+    PROF_EXIT(PROF_COMPUTE);
+    classify(model);
+    //Only on a crash: the black box is frozen until it is on the SD
+    if(crashIsUnsaved()){
+        writeCrashRecord();
+    }
+    if(attitudeIsValid()){
+        deadReckoningAddYawRate(rideNowMs(), attitudeGetYawRate());
+    }
+    //The window is already without the gravity, grade and mounting included
+    PROF_ENTER(PROF_FUSION);
+    fusionAddAccel(rideNowMs(), model->averageAcc * FUSION_GRAVITY);
+    PROF_EXIT(PROF_FUSION);
+}
+
+/*!
+    @brief      Buttons task: start the tracking in STOP state and stop it in START state
+*/
+static void buttonTask(SchedEvents_t events){
+    switch (computerState){
+        case STOP:
+            if(!MAP_GPIO_getInputPinValue(BTN_START_PORT, BTN_START_PIN)){
+                startRide();
+            }
+            break;
+        case START:
+            if(!MAP_GPIO_getInputPinValue(BTN_STOP_PORT, BTN_STOP_PIN)){
+                stopRide();
+            }
+            break;
+    }
+}
+
+/*!
+    @brief      Speed task: compute speed and distance travelled when the wheel has completed one round
+*/
+static void speedTask(SchedEvents_t events){
+    uint32_t nowMs = rideNowMs();
+    wheelSpeed = speedCompute(getTimerAcapturedValue());
+    myParamStruct.distance = distanceCovered();
+    rideStatsAddSpeed(nowMs, wheelSpeed, myParamStruct.distance);
+    PROF_ENTER(PROF_FUSION);
+    fusionAddWheel(nowMs, wheelSpeed / 3.6f);
+    PROF_EXIT(PROF_FUSION);
+    speedFlag = false;
+}
+
+/*!
+    @brief      Light task: when 4 light values have been captured, calculate average value and scale it (0 to 1)
+*/
+static void lightTask(SchedEvents_t events){
+    uint8_t i;
+    uint_fast16_t samplingAverage = 0;
+
+    for(i=0; i<LIGHT_BUFFER_LENGTH; i++){
+        samplingAverage = samplingAverage + getResultBuffer()[i];
+    }
+    samplingAverage /= LIGHT_BUFFER_LENGTH;
+
+    if(sendPos < 60){
+        lightToSend[sendPos] = samplingAverage;
+    } else {
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1,GPIO_PIN0);
+        for(i=0; i<MAX_LIGHT_SAMPLES; i++){
+            lightToSendAverage += lightToSend[i];
+        }
+        lightToSendAverage /= MAX_LIGHT_SAMPLES;
+        set_light(photoresistorConverter(lightToSendAverage));
+        sendPos = 0;
+    }
+    resultPos = 0;
+    photoresFlag = false;
+}
+
+/*!
+    @brief      Temperature task: convert the last temperature sample
+*/
+static void tempTask(SchedEvents_t events){
+    myParamStruct.temp = (conRes / calDifference) + 30.0f;
+    rideStatsAddTemperature(myParamStruct.temp);
+    flagTemp = false;
+}
+
+/*!
+    @brief      GPS task: parse the received sentences and restart the DMA
+    @details    Requests a LCD refresh, at most once per refresh period of the power mode, and,
+                during the tracking, a new point in the GPX file.
+*/
+static void gpsTask(SchedEvents_t events){
+    float latitude, longitude;
+    PROF_ENTER(PROF_GPS_PARSE);
+    gpsParseData((char*)&gpsUartBuffer);
+    PROF_EXIT(PROF_GPS_PARSE);
+    getGpsData(&myParamStruct.sats, &myParamStruct2.speed, &myParamStruct.altitude, &myParamStruct2.hdop);
+    if(getGpsPosition(&latitude, &longitude) != INVALID){
+        PROF_ENTER(PROF_FUSION);
+        fusionAddGps(rideNowMs(), latitude, longitude, myParamStruct2.speed / 3.6f, myParamStruct2.hdop);
+        PROF_EXIT(PROF_FUSION);
+    }
+    gpsStringEnd = false;
+    gpsDMARestoreChannel();
+    if(computerState == START){
+        schedPostEvent(SCHED_EVENT_LOG);
+    }
+    //Refresh period of the power mode
+    if(rideNowMs() - uiLastMs >= uiPeriodMs){
+        uiLastMs = rideNowMs();
+        schedPostEvent(SCHED_EVENT_UI);
+    }
+}
+
+/*!
+    @brief      Logging task: add the last GPS point to the GPX file
+    @details    Without a fix the track goes on with the points estimated by the dead reckoning.
+                The file is synced on the SD once per sync period of the power mode.
+*/
+static void logTask(SchedEvents_t events){
+    if(computerState != START){
+        return;
+    }
+    uint32_t nowMs = rideNowMs();
+    float wheelDistance = myParamStruct.distance * 1000.0f;
+    MAP_GPIO_toggleOutputOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    if(gpsFixIsValid()){
+        float latitude, longitude, altitude;
+        RideTotals_t totals;
+        getGpsPosition(&latitude, &longitude);
+        //The estimated points go before the fix, blended to it
+        if(deadReckoningIsActive()){
+            deadReckoningReconcile(latitude, longitude);
+            writeDeadReckoning();
+        }
+        addPointToGPXFromGPS(&GPX_TEST_FILE);
+        trackBroken = false;
+        deadReckoningAddFix(nowMs, latitude, longitude, getGpsCourse(), myParamStruct2.speed / 3.6f, wheelDistance);
+        //Altitude filtered on the distance up to the previous fix, the ride statistics count the filtered one
+        rideStatsGetTotals(&totals);
+        altitude = elevationAddFix(nowMs, myParamStruct.altitude, atof(getGSAData()->vdop), totals.distance);
+        rideStatsAddFix(nowMs, latitude, longitude, altitude);
+    }else{
+        uint16_t ms;
+        RtcTime_t now = rtcNow(&ms);
+        float altitude = elevationIsValid() ? elevationGetAltitude() : myParamStruct.altitude;
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN0);
+        //Without an estimate the track is broken, once for every loss of the fix
+        if(deadReckoningStep(nowMs, wheelDistance, altitude, now, ms) == DR_LOST && !trackBroken){
+            writeDeadReckoning();
+            GPXAddNewTrackSegment(&GPX_TEST_FILE);
+            trackBroken = true;
+        }
+    }
+    //The points are on the SD only at the close: a sync per period bounds the track lost with the battery
+    if(nowMs - sdSyncLastMs >= sdSyncMs){
+        sdSyncLastMs = nowMs;
+        f_sync(&GPX_TEST_FILE);
+    }
+}
+
+/*!
+    @brief      Print the battery and the power mode
+*/
+static void printPowerReport(void){
+    PRINTF("Battery: %u mV, %u%%, mode %s\r\n", (unsigned)(batteryGetVoltage() * 1000.0f), batteryGetSoc(),
+                                                 powerGetSettings(powerGetMode())->name);
+}
+
+/*!
+    @brief      Settings of the power mode to the subsystems
+*/
+static void applyPowerMode(void){
+    const PowerSettings_t* settings = powerGetSettings(powerGetMode());
+    gpsSetFixPeriod(settings->gpsFixMs);
+    uiPeriodMs = settings->uiPeriodMs;
+    if(settings->backlight){
+        MAP_GPIO_setOutputHighOnPin(LCD_BACKLIGHT_PORT, LCD_BACKLIGHT_PIN);
+    }else{
+        MAP_GPIO_setOutputLowOnPin(LCD_BACKLIGHT_PORT, LCD_BACKLIGHT_PIN);
+    }
+    _timerFlashSetPeriod(settings->bssPeriodMs);
+    //Only MCLK: SMCLK keeps the baud rates and the SPI and I2C clocks, ACLK the software timers.
+    //The time base of the scheduler, the profiler and the energy accounting follow the divider
+    MAP_CS_initClockSignal(CS_MCLK, CS_DCOCLK_SELECT, settings->mclkDivider == 4 ? CS_CLOCK_DIVIDER_4 :
+                                                      settings->mclkDivider == 2 ? CS_CLOCK_DIVIDER_2 :
+                                                                                   CS_CLOCK_DIVIDER_1);
+    schedSetClockDivider(settings->mclkDivider);
+    profSetClockDivider(settings->mclkDivider);
+    energySetMclkDivider(settings->mclkDivider);
+    sdSyncMs = settings->sdSyncS * 1000u;
+    //The next one may be far: what is in the cache goes on the SD now
+    if(computerState == START && powerGetMode() == POWER_CRITICAL){
+        sdSyncLastMs = rideNowMs();
+        f_sync(&GPX_TEST_FILE);
+    }
+    printPowerReport();
+}
+
+/*!
+    @brief      Power timer callback, wakes up the power task
+*/
+static void powerTimerCallback(void* arg){
+    schedPostEvent(SCHED_EVENT_POWER);
+}
+
+/*!
+    @brief      Add the last period to the energy accounting
+    @details    Active and LPM0 from the scheduler, the lights from the high time of their outputs;
+                the GPS, the loads always on and the backlight, if on, for the whole period. The
+                counted events are converted at the MCLK of the period.
+*/
+static void accountEnergy(void){
+#if ENERGY_ENABLED
+    static uint64_t lastElapsedUs, lastSleepUs;
+    static uint32_t lastFrontUs, lastRearUs;
+    uint64_t elapsedUs, sleepUs;
+    uint32_t frontUs, rearUs, periodUs, sleptUs;
+
+    schedGetTotals(&elapsedUs, &sleepUs);
+    lightsGetOnTime(&frontUs, &rearUs);
+    periodUs = (uint32_t)(elapsedUs - lastElapsedUs);
+    sleptUs = (uint32_t)(sleepUs - lastSleepUs);
+    if(sleptUs > periodUs){
+        sleptUs = periodUs;
+    }
+    energyAddUs(ENERGY_MCU_ACTIVE, periodUs - sleptUs);
+    energyAddUs(ENERGY_MCU_LPM0, sleptUs);
+    energyAddUs(ENERGY_GPS, periodUs);
+    energyAddUs(ENERGY_STANDBY, periodUs);
+    if(powerGetSettings(powerGetMode())->backlight){
+        energyAddUs(ENERGY_BACKLIGHT, periodUs);
+    }
+    energyAddUs(ENERGY_FRONT_LIGHT, frontUs - lastFrontUs);
+    energyAddUs(ENERGY_REAR_LIGHT, rearUs - lastRearUs);
+    energyUpdate();
+    lastElapsedUs = elapsedUs;
+    lastSleepUs = sleepUs;
+    lastFrontUs = frontUs;
+    lastRearUs = rearUs;
+#endif
+}
+
+/*!
+    @brief      Power task: account the energy, filter the battery voltage and run the governor
+    @details    The energy of the period is accounted before a change of the mode, at its MCLK.
+*/
+static void powerTask(SchedEvents_t events){
+    accountEnergy();
+    //Zero before the first conversion
+    if(batteryRaw != 0){
+        batteryAddSample(batteryRaw, powerGetSettings(powerGetMode())->loadMa + lightsGetCurrent());
+    }
+    if(batteryIsValid() && powerUpdate(batteryGetSoc(), rideNowMs())){
+        applyPowerMode();
+    }
+}
+
+/*!
+    @brief      PC UART receive callback, wakes up the console task
+*/
+static void consoleRxCallback(void){
+    schedPostEvent(SCHED_EVENT_CONSOLE);
+}
+
+/*!
+    @brief      Console task: handle the commands received from the PC UART
+    @details    'p' prints the scheduler and profiler statistics, 'r' resets them and the energy,
+                't' starts the binary telemetry stream and 'q' stops it, 'l' closes a lap of the ride,
+                'm' restarts the mounting calibration, 'c' clears the crash alert, 'b' reloads the
+                thresholds of the BSS from the SD and prints the time in each class, 'v' prints the
+                battery and the power mode, 'e' prints the energy of every subsystem.
+*/
+static void consoleTask(SchedEvents_t events){
+    uint8_t cmd;
+    while(UART_Read(EUSCI_A0_BASE, &cmd, 1) == 1){
+        switch(cmd){
+            case 'p':
+            case 'P':
+                printSchedulerReport();
+                UART_Flush(EUSCI_A0_BASE);
+                profReport();
+                break;
+            case 'r':
+            case 'R':
+                schedResetStats();
+                profReset();
+                energyReset();
+                break;
+            case 't':
+            case 'T':
+                telemEnable(true);
+                SWTIMER_StartPeriodic(&telemTimer, SWTIMER_MS(TELEM_TICK_MS));
+                break;
+            case 'q':
+            case 'Q':
+                telemEnable(false);
+                SWTIMER_Stop(&telemTimer);
+                break;
+            case 'l':
+            case 'L':
+                if(rideStatsLap(rideNowMs())){
+                    RideTotals_t lap;
+                    rideStatsGetLap(rideStatsGetLapCount() - 1, &lap);
+                    PRINTF("Lap %d: %d s, %d m\r\n", (int)rideStatsGetLapCount(), (int)(lap.elapsedMs / 1000), (int)lap.distance);
+                }
+                break;
+            case 'm':
+            case 'M':
+                mountCalibReset(MPU6050_SAMPLE_PERIOD_S);
+                attitudeReset(MPU6050_SAMPLE_PERIOD_S);
+                PRINTF("Mounting calibration restarted\r\n");
+                break;
+            case 'c':
+            case 'C':
+                if(crashIsDetected()){
+                    crashClear();
+                    PRINTF("Crash alert cleared\r\n");
+                }
+                break;
+            case 'b':
+            case 'B':
+                loadBssConfig();
+                printBssReport();
+                break;
+            case 'v':
+            case 'V':
+                printPowerReport();
+                break;
+            case 'e':
+            case 'E':
+                energyReport();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/*!
+    @brief      UI task: read the joystick and refresh the LCD
+*/
+static void uiTask(SchedEvents_t events){
+    RideTotals_t totals;
+    struct tm now;
+
+    //Clock and moving time of the ride
+    rtcToCalendar(rtcNow(NULL), &now);
+    numFormatTime(myParamStruct.time, sizeof(myParamStruct.time), (uint32_t)(now.tm_hour * 3600 + now.tm_min * 60 + now.tm_sec));
+    rideStatsGetTotals(&totals);
+    numFormatTime(myParamStruct.tripTime, sizeof(myParamStruct.tripTime), totals.movingMs / 1000);
+    myParamStruct.grade = elevationGetGrade();
+    if(fusionIsValid()){
+        myParamStruct.speed = fusionGetSpeed() * 3.6f;
+    }
+
+    //Setting Wheel from LCD
+    setWheelDiameter(wheelDim);
+    scrollPages();
+    PROF_ENTER(PROF_SHOW_PAGES);
+    showPages();
+    PROF_EXIT(PROF_SHOW_PAGES);
+    GrFlush(&g_sContext);
+    Interrupt_enableInterrupt(INT_ADC14);
+}
+
+/*!
+    @brief      Telemetry timer callback, wakes up the telemetry task
+*/
+static void telemTimerCallback(void* arg){
+    schedPostEvent(SCHED_EVENT_TELEM);
+}
+
+/*!
+    @brief      Telemetry task: send the messages whose period has elapsed
+    @details    The values are sent as they are in the other tasks, nothing is computed here.
+*/
+static void telemTask(SchedEvents_t events){
+    model_t* model = get_model();
+
+    if(telemIsDue(TELEM_MSG_FIX)){
+        float latitude, longitude;
+        uint8_t fix = (uint8_t)getGpsPosition(&latitude, &longitude);
+        telemSendFix(latitude, longitude, myParamStruct.altitude, (uint8_t)myParamStruct.sats, fix, myParamStruct2.hdop);
+    }
+    if(telemIsDue(TELEM_MSG_SPEED)){
+        telemSendSpeed(wheelSpeed, myParamStruct2.speed, myParamStruct.distance);
+    }
+    if(telemIsDue(TELEM_MSG_WHEEL)){
+        telemSendWheel(getRoundsCounter());
+    }
+    if(telemIsDue(TELEM_MSG_BSS)){
+        telemSendBss((uint8_t)model->class, model->averageAcc);
+    }
+    if(telemIsDue(TELEM_MSG_ATTITUDE)){
+        telemSendAttitude(attitudeGetRoll(), attitudeGetPitch(), attitudeGetYawRate(), elevationGetGrade());
+    }
+    if(telemIsDue(TELEM_MSG_LIGHT)){
+        telemSendLight((float)model->light);
+    }
+    if(telemIsDue(TELEM_MSG_TEMP)){
+        telemSendTemp(myParamStruct.temp);
+    }
+    if(telemIsDue(TELEM_MSG_PROFILER)){
+        //One region per message, round robin
+        ProfStats_t stats;
+        if(profGetStats((ProfRegion_t)telemProfRegion, &stats)){
+            telemSendProfiler(telemProfRegion, stats.count, stats.min, stats.mean, stats.max);
+        }
+        telemProfRegion = (telemProfRegion + 1) % PROF_NUM_REGIONS;
+    }
+}
+
+/*!
+    @brief      Sync task: phone commands and export of the rides
+*/
+static void syncTask(SchedEvents_t events){
+    syncProcess();
+}
+
+/*!
+    @brief      Task table, sorted by priority
+    @details    The BSS has the highest priority for safety, the GPS follows because the bytes received
+                before the DMA is restarted are lost.
+*/
+static const SchedTask_t schedulerTasks[] = {
+    //Name      Event                   Function        Deadline [us]
+    {"BSS",     SCHED_EVENT_BSS,        bssTask,        50000},
+    {"GPS",     SCHED_EVENT_GPS,        gpsTask,        10000},
+    {"BUTTON",  SCHED_EVENT_BUTTON,     buttonTask,     100000},
+    {"SPEED",   SCHED_EVENT_SPEED,      speedTask,      100000},
+    {"LOG",     SCHED_EVENT_LOG,        logTask,        1000000},
+    {"LIGHT",   SCHED_EVENT_LIGHT,      lightTask,      1000000},
+    {"TEMP",    SCHED_EVENT_TEMP,       tempTask,       1000000},
+    {"UI",      SCHED_EVENT_UI,         uiTask,         500000},
+    {"CONSOLE", SCHED_EVENT_CONSOLE,    consoleTask,    100000},
+    {"TELEM",   SCHED_EVENT_TELEM,      telemTask,      TELEM_TICK_MS * 1000},
+    {"SYNC",    SCHED_EVENT_SYNC,       syncTask,       0},
+    {"POWER",   SCHED_EVENT_POWER,      powerTask,      POWER_PERIOD_MS * 1000},
+};
+#define SCHEDULER_NUM_TASKS (sizeof(schedulerTasks) / sizeof(schedulerTasks[0]))
 
 /*!
     @brief      Main function
@@ -231,20 +1074,12 @@ bool btnStopStateP = true;
                 After signal a sampling loop save it on the SD card in a file called "test<xxx>.gpx" in
                 the root directory, where <xxx> is a progressive number whit runs;
                 so if the file test.gpx alredy exists then the "test1.gpx" will be created.
+                After the initialization the work is done by the tasks in @ref schedulerTasks, woken up by
+                the events posted by the ISRs; when no task is ready the CPU sleeps in LPM0.
 */
 void main(void){
     model_t* model = get_model();
     model->class = CLASS_IDLE;
-    //Variables
-    //FILE
-    bool defaultFile = true;
-    char newFileName[15];
-    //Buttons
-    bool status;
-    //GPS
-    bool gpsAddPoint = false;
-
-
 
     WDT_A_holdTimer();	// stop watchdog timer
 	CS_Init();
@@ -263,6 +1098,16 @@ void main(void){
     //PC UART config
     UART_Init(EUSCI_A0_BASE, UART0Config);
 
+    //Cycle counter for the profiler, the report is sent on the PC UART
+    profInit();
+    energyInit();
+
+    //Software timers on TIMER_A1, used by the SD Card and by the BSS flashing
+    SWTIMER_Init();
+
+    //Clock of the file timestamps on the RTC_C, set by the GPS
+    rtcInit();
+
     //Initialize all hardware required for the SD Card
     SPI_Init(EUSCI_B0_BASE, SPI0MasterConfig);
     SD_Init();
@@ -273,16 +1118,14 @@ void main(void){
 	dmaInit();
 	//Enable DMA for EUSCI_A2 RX
 	gpsDMAConfiguration();
+    //SD card sectors by DMA on channels 0 and 1, before the card is mounted
+    MMC_use_dma(true);
 
     resultPos = 0;
     sendPos = 0;
 
     timerInit(&speedContinuousModeConfig, &speedCaptureModeConfig);
 
-    //myParamStruct.distance=20.0;
-    //myParamStruct.speed=30.6;
-
-
     //Enabling NVIC
     Interrupt_enableMaster();
 
@@ -303,197 +1146,93 @@ void main(void){
     if(r != FR_OK){
         PRINTF("Could not open root directory, returned: %d\r\n", (int)r);
         MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
-//        while(1);
     }else{
         PRINTF("Opened DIR!\r\n");
         MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN1);
     }
 
-    //Configuring GPIO for buttons
+    //Configuring GPIO for buttons, a press wakes up the button task
     MAP_GPIO_setAsInputPin(BTN_START_PORT, BTN_START_PIN);
     MAP_GPIO_setAsInputPin(BTN_STOP_PORT, BTN_STOP_PIN);
-
-    //LCD configuration
-    graphicsInitSelected(&SPI0MasterConfig);
-    graphicsInitBigFont(&SPI0MasterConfig);
-    graphicsInit(&SPI0MasterConfig);
+    MAP_GPIO_interruptEdgeSelect(BTN_START_PORT, BTN_START_PIN, GPIO_HIGH_TO_LOW_TRANSITION);
+    MAP_GPIO_interruptEdgeSelect(BTN_STOP_PORT, BTN_STOP_PIN, GPIO_HIGH_TO_LOW_TRANSITION);
+    MAP_GPIO_clearInterruptFlag(BTN_START_PORT, BTN_START_PIN);
+    MAP_GPIO_clearInterruptFlag(BTN_STOP_PORT, BTN_STOP_PIN);
+    MAP_GPIO_enableInterrupt(BTN_START_PORT, BTN_START_PIN);
+    MAP_GPIO_enableInterrupt(BTN_STOP_PORT, BTN_STOP_PIN);
+    MAP_Interrupt_enableInterrupt(INT_PORT5);
+    MAP_Interrupt_enableInterrupt(INT_PORT3);
+
+    //LCD configuration, backlight on
+    MAP_GPIO_setAsOutputPin(LCD_BACKLIGHT_PORT, LCD_BACKLIGHT_PIN);
+    MAP_GPIO_setOutputHighOnPin(LCD_BACKLIGHT_PORT, LCD_BACKLIGHT_PIN);
+    graphicsInitSelected(&LCDMasterConfig);
+    graphicsInitBigFont(&LCDMasterConfig);
+    graphicsInit(&LCDMasterConfig);
     drawGrid1();
 
-    //adcInit();
     temperatureInit();
     ADC14Init(&photoresistorUpModeConfig, &photoresistorCompareConfig);
 
     //BSS Init();
-    _BSSInit(&bssUpConfig);
-    Interrupt_enableMaster();   // Enabling MASTER interrupts
+    _BSSInit();
+    loadMountCalib();
+    loadBssConfig();
+    //SMCLK changed: the SPI profiles are reloaded with the new dividers at the next transfer
+    SPI_Reconfigure(EUSCI_B0_BASE);
+
+    //Scheduler Init, after _BSSInit because the time base depends on MCLK
+    schedInit(schedulerTasks, SCHEDULER_NUM_TASKS);
+    //The commands of the PC are handled as they arrive, also when the LCD is not refreshed
+    UART_SetRxCallback(EUSCI_A0_BASE, consoleRxCallback);
+    setStopLeds();
+    schedPostEvent(SCHED_EVENT_UI);
+
+    //Telemetry, the stream and its timer are started from the PC with 't'
+    telemInit();
+    SWTIMER_Create(&telemTimer, telemTimerCallback, NULL);
+
+    //Phone sync on the BLE-serial module, same 115200 baud setting of the PC UART
+    UART_Init(SYNC_UART, UART0Config);
+    syncInit();
+
+    //Power governor, from the normal mode; the battery is sampled with the ADC sequence
+    batteryReset();
+    powerInit();
+    uiPeriodMs = powerGetSettings(POWER_NORMAL)->uiPeriodMs;
+    sdSyncMs = powerGetSettings(POWER_NORMAL)->sdSyncS * 1000u;
+    SWTIMER_Create(&powerTimer, powerTimerCallback, NULL);
+    SWTIMER_StartPeriodic(&powerTimer, SWTIMER_MS(POWER_PERIOD_MS));
 
-    uint8_t i;
-    uint_fast16_t samplingAverage = 0;
-    uint_fast16_t lightToSendAverage = 0;
-
-    uint8_t id;
-
-    while(1){ 
-
-        // BSS functions
-        acquire_window(model);
-        compute(model);
-        classify(model);
-
-        id = MPU6050_readDeviceId();
-
-        //Setting Wheel from LCD
-        setWheelDiameter(wheelDim);
-
-    
-        //if wheel has completed one round, compute speed and distance travelled
-        if(speedFlag){
-            myParamStruct.speed = speedCompute(getTimerAcapturedValue());
-            myParamStruct.distance = distanceCovered();
-            speedFlag = false;
-        }
-            
-
-        //if 4 light values have been captured, calculate average value and scale it (0 to 1)
-        if(photoresFlag){
-            for(i=0; i<LIGHT_BUFFER_LENGTH; i++){
-                samplingAverage = samplingAverage + getResultBuffer()[i];
-            }
-            samplingAverage /= LIGHT_BUFFER_LENGTH;
-
-            if(sendPos < 60){
-                lightToSend[sendPos] = samplingAverage;
-            } else {
-                // printf("in else\n");
-                MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1,GPIO_PIN0);
-                for(i=0; i<MAX_LIGHT_SAMPLES; i++){
-                    lightToSendAverage += lightToSend[i];
-                }
-                lightToSendAverage /= MAX_LIGHT_SAMPLES;
-                // printf("lightToSendAverage averaged: %d\n",lightToSendAverage);
-                set_light(photoresistorConverter(lightToSendAverage));
-                // printf("Converted average: %f \n\n",convertedAverage);
-                sendPos = 0;
-            }
-            //ADC14_disableInterrupt(ADC_INT0);
-            resultPos = 0;
-//           printf("Average: %d\n",average);
-
-            photoresFlag = false;
-
-        }
-
-        //if data is present, parse it
-        if(gpsStringEnd == true){
-            gpsParseData((char*)&gpsUartBuffer);
-            getGpsData(&myParamStruct.sats, &myParamStruct2.speed, &myParamStruct.altitude, &myParamStruct2.hdop);
-            gpsStringEnd = false;
-            gpsAddPoint = true;
-            gpsDMARestoreChannel();
-        }
-        //If temperature is read then convert it
-        if (flagTemp){
-            myParamStruct.temp = (conRes / calDifference) + 30.0f;
-            //tempF = tempC * 9.0f / 5.0f + 32.0f;
-            flagTemp = false;
-        }
+    Interrupt_enableMaster();   // Enabling MASTER interrupts
 
-        //Computer FSM
-        switch (computerState){
-            case STOP:
-                //Leds
-                MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN1);
-                MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN2);
-                MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P1, GPIO_PIN0);
-
-                //Detecting Start button press
-                status = !MAP_GPIO_getInputPinValue(BTN_START_PORT, BTN_START_PIN);
-                if(status && !btnStartStateP){
-                    btnStartStateP = true;
-                    //Open the file
-                    int fileIndex = 1;
-                    r = f_stat(GPX_TEST_FILENAME, &FI);                     //Check if file already exists
-                    if(r == FR_OK){                                         //If file already exists
-                        defaultFile = false;
-                        do{
-                            snprintf(newFileName, 14, "test%d.gpx", fileIndex);
-                            fileIndex++;
-                            r = f_stat(newFileName, &FI);
-                        }while(r != FR_NO_FILE && fileIndex <= 999);
-                        r = f_open(&GPX_TEST_FILE, newFileName, FA_WRITE | FA_CREATE_ALWAYS);
-                    }else if(r == FR_NO_FILE){
-                        r = f_open(&GPX_TEST_FILE, GPX_TEST_FILENAME, FA_WRITE | FA_CREATE_ALWAYS);
-                    }
-                    // r = f_open(&GPX_TEST_FILE, GPX_TEST_FILENAME, FA_WRITE | FA_CREATE_ALWAYS);
-                    /*Check for errors. Trap MSP432 if there is an error*/
-                    if(r != FR_OK){
-                        PRINTF("Could not open file, returned: %d\r\n", (int)r);
-                        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
-                        while(1);
-                    }
-
-                    if(defaultFile){
-                        GPXInitFile(&GPX_TEST_FILE, GPX_TEST_FILENAME);
-                    }else{
-                        GPXInitFile(&GPX_TEST_FILE, newFileName);
-                    }
-                    GPXAddTrack(&GPX_TEST_FILE, "2024-01-10T00:00:00Z");
-                    GPXAddTrackSegment(&GPX_TEST_FILE);
-                    computerState = START;
-                    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN2);
-                    PRINTF("START TRACKING!!\r\n");
-                }
-                //LCD Update
-                if(gpsAddPoint){
-                    scrollPages();
-                    showPages();
-                    GrFlush(&g_sContext);
-                    Interrupt_enableInterrupt(INT_ADC14);
-                    gpsAddPoint = false;
-                }
+    schedRun();
+}
 
-                btnStartStateP = status;
-                break;
-            case START:
-                MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN0);
-                //Detecting Stop button press
-                status = !MAP_GPIO_getInputPinValue(BTN_STOP_PORT, BTN_STOP_PIN);
-                //Add point to GPX file and update LCD
-                if(gpsAddPoint){
-                    //GPX
-                    MAP_GPIO_toggleOutputOnPin(GPIO_PORT_P1, GPIO_PIN0);
-                    bool pointAdded = addPointToGPXFromGPS(&GPX_TEST_FILE);
-                    if(!pointAdded){
-                        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN0);
-                    }
-
-                    //LCD
-                    scrollPages();
-                    showPages();
-                    GrFlush(&g_sContext);
-                    Interrupt_enableInterrupt(INT_ADC14);
-                    
-                    gpsAddPoint = false;
-                }
-                if(status){
-                    btnStopStateP = true;
-                    GPXCloseTrackSegment(&GPX_TEST_FILE);
-                    GPXCloseTrack(&GPX_TEST_FILE);
-                    GPXCloseFile(&GPX_TEST_FILE);
-                    computerState = STOP;
-                    PRINTF("STOP TRACKING!!\r\n");
-
-                    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN0);
-                }
-                //Go to sleep
-                MAP_Interrupt_enableSleepOnIsrExit();
-                MAP_PCM_gotoLPM0InterruptSafe();
-                btnStopStateP = status;
-                break;
-        }
+/*!
+    @brief      Start button interrupt handler
+*/
+void PORT5_IRQHandler(void){
+    PROF_ENTER(PROF_ISR_PORT5);
+    uint32_t status = MAP_GPIO_getEnabledInterruptStatus(BTN_START_PORT);
+    MAP_GPIO_clearInterruptFlag(BTN_START_PORT, status);
+    if(status & BTN_START_PIN){
+        schedPostEvent(SCHED_EVENT_BUTTON);
+    }
+    PROF_EXIT(PROF_ISR_PORT5);
+}
 
-        //MAP_Interrupt_enableSleepOnIsrExit();
+/*!
+    @brief      Stop button interrupt handler
+*/
+void PORT3_IRQHandler(void){
+    PROF_ENTER(PROF_ISR_PORT3);
+    uint32_t status = MAP_GPIO_getEnabledInterruptStatus(BTN_STOP_PORT);
+    MAP_GPIO_clearInterruptFlag(BTN_STOP_PORT, status);
+    if(status & BTN_STOP_PIN){
+        schedPostEvent(SCHED_EVENT_BUTTON);
     }
+    PROF_EXIT(PROF_ISR_PORT3);
 }
 
 /*! 
@@ -538,62 +1277,102 @@ void main(void){
 }*/
 #else
 
-#define GPX_TEST_FILENAME   "Test/results/test.gpx"
-#define GPX_TEST_FILE       file
-int main(void){
+#define NMEA_TEST_FILENAME  "Test/NMEAFileCorrected.txt"
+#define GPX_TEST_FILENAME   "build/test.gpx"
+
+/*!
+    @brief      Add a burst of the replay to the energy accounting
+    @details    The same subsystems of the power task on the target, over the time the GPS UART takes
+                to receive the burst: the parse is the active time, the rest is LPM0. The backlight
+                is on as in the NORMAL mode, the lights are from lightsGetOnTime, always off on the
+                host.
+    @param      bytes: bytes of the burst
+    @param      activeUs: time of the parse of the burst [us]
+*/
+static void replayAccountEnergy(size_t bytes, uint32_t activeUs){
+#if ENERGY_ENABLED
+    static uint32_t lastFrontUs, lastRearUs;
+    uint32_t periodUs = (uint32_t)(bytes * 10u * 1000000ull / ENERGY_GPS_BAUD);
+    uint32_t frontUs, rearUs;
+
+    if(activeUs > periodUs){
+        activeUs = periodUs;
+    }
+    lightsGetOnTime(&frontUs, &rearUs);
+    ENERGY_COUNT(ENERGY_GPS_UART, bytes);
+    energyAddUs(ENERGY_MCU_ACTIVE, activeUs);
+    energyAddUs(ENERGY_MCU_LPM0, periodUs - activeUs);
+    energyAddUs(ENERGY_GPS, periodUs);
+    energyAddUs(ENERGY_STANDBY, periodUs);
+    energyAddUs(ENERGY_BACKLIGHT, periodUs);
+    energyAddUs(ENERGY_FRONT_LIGHT, frontUs - lastFrontUs);
+    energyAddUs(ENERGY_REAR_LIGHT, rearUs - lastRearUs);
+    energyUpdate();
+    lastFrontUs = frontUs;
+    lastRearUs = rearUs;
+#endif
+}
+
+/*!
+    @brief      Replay of a NMEA log into a GPX track
+    @details    The log is read in bursts of the GPS DMA buffer and every burst goes through the
+                calls of the GPS and logging tasks: the sentences are parsed and, with a valid fix,
+                a point is added to the track. A sentence across two bursts is lost, as on the target.
+                At the end the energy of the replay is printed as energyReport does on the target,
+                for Test/energy.py --check-report.
+
+                Usage:
+                    build/myprogram.exe [NMEA log] [GPX file]
+*/
+int main(int argc, char* argv[]){
+    const char* nmeaName = argc > 1 ? argv[1] : NMEA_TEST_FILENAME;
+    const char* gpxName = argc > 2 ? argv[2] : GPX_TEST_FILENAME;
+    char gpsData[RX_BUFFER_SIZE];
+    char startTime[NUMFORMAT_ISO8601_MS_LEN];
+    uint32_t bursts = 0, points = 0;
+    uint32_t start;
+    size_t len;
     FILE* NMEA;
     FILE* GPX;
-    NMEA = fopen("Test/NMEAFileCorrected.txt", "r");
+
+    NMEA = fopen(nmeaName, "r");
     if(NMEA == NULL){
         printf("Error opening NMEA file!\r\n");
         return -1;
     }
-    GPX = fopen(GPX_TEST_FILENAME, "w");
-    do{
-        fflush(stdout);
-        srand(time(NULL));
-        
-        while(1){
-            acquire_window(&model);
-            compute(&model);
-            classify(&model);
-            print_model(&model);
-            execute(model.class);
-            sleep(10);
-        }
-        return 0;
-        PRINTF("Get command: P/s [Play/Stop]\r\n");
-        fflush(stdin);
-        char cmd = getchar();
-        switch(cmd){
-            case 'P':
-            case 'p':
-                PRINTF("Start!\r\n");
-                GPXInitFile(GPX, GPX_TEST_FILENAME);
-                GPXAddTrack(GPX, "Test Track", "Test Description", "2024-01-10T00:00:00Z");
-                GPXAddTrackSegment(GPX);
-                computerState = START;
-                break;
-            case 'C':
-            case 'c':
-                PRINTF("Continue!\r\n");
-                break;
-            case 'S':
-            case 's':
-                PRINTF("Stop!\r\n");
-                GPXCloseTrackSegment(&GPX);
-                GPXCloseTrack(&GPX);
-                GPXCloseFile(&GPX);
-                computerState = STOP;
-                break;
-        }
-        if(computerState == START){
-            char gpsData[RX_BUFFER_SIZE];
-            fread(gpsData, sizeof(char), RX_BUFFER_SIZE, NMEA);
-            gpsStringEnd = true;
-            addPointToGPXFromGPS(gpsData, &GPX);
+    GPXInitFile(&GPX, gpxName);
+    if(GPX == NULL){
+        printf("Error opening GPX file!\r\n");
+        fclose(NMEA);
+        return -1;
+    }
+    rtcFormatISO8601(startTime, sizeof(startTime), rtcNow(NULL), 0);
+    GPXAddTrack(&GPX, startTime);
+    GPXAddTrackSegment(&GPX);
+    computerState = START;
+    profInit();
+    energyInit();
+    lightsInit();
+
+    while((len = fread(gpsData, sizeof(char), RX_BUFFER_SIZE - 1, NMEA)) > 0){
+        gpsData[len] = '\0';
+        start = profNow();
+        gpsParseData(gpsData);
+        if(addPointToGPXFromGPS(&GPX)){
+            points++;
         }
-    }while(computerState != STOP);
-	return 0;
+        replayAccountEnergy(len, (profNow() - start) / PROF_TICKS_PER_US);
+        bursts++;
+    }
+
+    GPXCloseTrackSegment(&GPX);
+    GPXCloseTrack(&GPX);
+    GPXCloseFile(&GPX);
+    computerState = STOP;
+    fclose(NMEA);
+    printf("%u bursts, %u points in %s\r\n", (unsigned)bursts, (unsigned)points, gpxName);
+    fflush(stdout);
+    energyReport();
+    return 0;
 }
 #endif
@@ -5,13 +5,29 @@
     @author Federica Lorenzini
 */
 #include "mainInterface.h"
+#ifndef SIMULATE_HARDWARE
 #include <ti/devices/msp432p4xx/inc/msp.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#else
+#include "LcdDriver/HAL_SIM_Crystalfontz128x128_ST7735.h"
+#endif
 #include <ti/grlib/grlib.h>
 #include "LcdDriver/Crystalfontz128x128_ST7735.h"
 #include "LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#include "numFormat.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef SIMULATE_HARDWARE
+    #define JOYSTICK_X()        MAP_ADC14_getResult(ADC_MEM1)   //!< Joystick horizontal axis
+    #define JOYSTICK_Y()        MAP_ADC14_getResult(ADC_MEM2)   //!< Joystick vertical axis
+    #define JOYSTICK_SELECT()   (!(P4IN & GPIO_PIN1))           //!< Joystick button pressed
+#else
+    #define JOYSTICK_X()        LCDSim_GetJoystickX()
+    #define JOYSTICK_Y()        LCDSim_GetJoystickY()
+    #define JOYSTICK_SELECT()   LCDSim_GetJoystickSelect()
+#endif
 
 /*!
     @addtogroup LCD_module
@@ -92,40 +108,41 @@ void showPage1(toShowPage1 *paramToShow1)
     switch (selectDist)
     {
     case 0:
-        snprintf(tmpString, 39, "%2.2f", paramToShow1->distance);
+        numFormatFloat(tmpString, 39, paramToShow1->distance, 2);
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 10, 1);
         snprintf(tmpString, 39, "km");
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 40, multipleData.yMin + 10, 1);
         break;
     case 1:
-        snprintf(tmpString, 39, "%2.2f", metres);
+        numFormatFloat(tmpString, 39, metres, 2);
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 10, 1);
         snprintf(tmpString, 39, "m");
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 58, multipleData.yMin + 10, 1);
         break;
     case 2:
-        snprintf(tmpString, 39, "%2.2f", miles);
+        numFormatFloat(tmpString, 39, miles, 2);
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 10, 1);
         snprintf(tmpString, 39, "mi");
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 40, multipleData.yMin + 10, 1);
         break;
     }
-    snprintf(tmpString, 39, "%4.2f m", paramToShow1->altitude);
+    numFormatFloat(tmpString, 36, paramToShow1->altitude, 2);
+    strcat(tmpString, " m");
     GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 35, 1);
 
-    snprintf(tmpString, 39, "%d", paramToShow1->sats);
+    numFormatInt(tmpString, 39, paramToShow1->sats, 1);
     GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 60, 1);
 
     switch (selectTemp)
     {
     case 0:
-        snprintf(tmpString, 39, "%2.1f", paramToShow1->temp);
+        numFormatFloat(tmpString, 39, paramToShow1->temp, 1);
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 85, 1);
         snprintf(tmpString, 39, "C");
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 50, multipleData.yMin + 85, 1);
         break;
     case 1:
-        snprintf(tmpString, 39, "%2.2f", fahrenheit);
+        numFormatFloat(tmpString, 39, fahrenheit, 2);
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 7, multipleData.yMin + 85, 1);
         snprintf(tmpString, 39, "F");
         GrStringDraw(&g_sContext, (int8_t *)tmpString, -1, multipleData.xMin + 50, multipleData.yMin + 85, 1);
@@ -140,19 +157,19 @@ void showPage1(toShowPage1 *paramToShow1)
     switch (selectSpeed)
     {
     case 0:
-        snprintf(tmpString, 39, "%2.1f", paramToShow1->speed);
+        numFormatFloat(tmpString, 39, paramToShow1->speed, 1);
         GrStringDrawCentered(&g_sContextBig, (int8_t *)tmpString, -1, 96, 55, 1);
         snprintf(tmpString, 39, "km/h");
         GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 96, 70, 1);
         break;
     case 1:
-        snprintf(tmpString, 39, "%2.1f", ms);
+        numFormatFloat(tmpString, 39, ms, 1);
         GrStringDrawCentered(&g_sContextBig, (int8_t *)tmpString, -1, 96, 55, 1);
         snprintf(tmpString, 39, "m/s");
         GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 96, 70, 1);
         break;
     case 2:
-        snprintf(tmpString, 39, "%2.1f", mih);
+        numFormatFloat(tmpString, 39, mih, 1);
         GrStringDrawCentered(&g_sContextBig, (int8_t *)tmpString, -1, 96, 55, 1);
         snprintf(tmpString, 39, "mi/h");
         GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 96, 70, 1);
@@ -161,6 +178,11 @@ void showPage1(toShowPage1 *paramToShow1)
         break;
     }
 
+    // grade of the road
+    numFormatFloat(tmpString, 36, paramToShow1->grade, 1);
+    strcat(tmpString, " %");
+    GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 96, 88, 1);
+
     // trip time
     snprintf(tmpString, 39, "%s", paramToShow1->tripTime);
     GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 64, 118, 1);
@@ -177,13 +199,13 @@ void showPage2(toShowPage2 *paramToShow2)
 {
     char tmpString[40] = "/0";
 
-    snprintf(tmpString, 39, "%.2f", paramToShow2->hdop);
+    numFormatFloat(tmpString, 39, paramToShow2->hdop, 2);
     GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 80, 40, 1);
 
-    snprintf(tmpString, 39, "%.2f", paramToShow2->vdop);
+    numFormatFloat(tmpString, 39, paramToShow2->vdop, 2);
     GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 80, 60, 1);
 
-    snprintf(tmpString, 39, "%.2f", paramToShow2->speed);
+    numFormatFloat(tmpString, 39, paramToShow2->speed, 2);
     GrStringDrawCentered(&g_sContext, (int8_t *)tmpString, -1, 80, 80, 1);
 
     snprintf(tmpString, 39, "%s", paramToShow2->fixType);
@@ -193,7 +215,7 @@ void showPage3()
 {
     GrStringDrawCentered(&g_sContext, (int8_t *)"MENU", -1, 64, 10, 1);
     /*Using joystick's vertical axis (y) to choice which field should be converted*/
-    int Yaxis = MAP_ADC14_getResult(ADC_MEM2);
+    int Yaxis = JOYSTICK_Y();
     switch (Ycounter)
     {
     case 1:
@@ -215,7 +237,7 @@ void showPage3()
             GrStringDraw(&g_sContextSelected, (int8_t *)"km", -1, 45, 20, 1);
             GrStringDraw(&g_sContext, (int8_t *)"m", -1, 75, 20, 1);
             GrStringDraw(&g_sContext, (int8_t *)"mi", -1, 100, 20, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectDist = 1;
             }
@@ -225,7 +247,7 @@ void showPage3()
             GrStringDraw(&g_sContext, (int8_t *)"km", -1, 45, 20, 1);
             GrStringDraw(&g_sContextSelected, (int8_t *)"m", -1, 75, 20, 1);
             GrStringDraw(&g_sContext, (int8_t *)"mi", -1, 100, 20, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectDist = 2;
             }
@@ -235,7 +257,7 @@ void showPage3()
             GrStringDraw(&g_sContext, (int8_t *)"km", -1, 45, 20, 1);
             GrStringDraw(&g_sContext, (int8_t *)"m", -1, 75, 20, 1);
             GrStringDraw(&g_sContextSelected, (int8_t *)"mi", -1, 100, 20, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectDist = 0;
             }
@@ -263,7 +285,7 @@ void showPage3()
             GrStringDraw(&g_sContextSelected, (int8_t *)"km/h", -1, 45, 40, 1);
             GrStringDraw(&g_sContext, (int8_t *)"m/s", -1, 75, 40, 1);
             GrStringDraw(&g_sContext, (int8_t *)"mi/h", -1, 100, 40, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectSpeed = 1;
             }
@@ -273,7 +295,7 @@ void showPage3()
             GrStringDraw(&g_sContext, (int8_t *)"km/h", -1, 45, 40, 1);
             GrStringDraw(&g_sContextSelected, (int8_t *)"m/s", -1, 75, 40, 1);
             GrStringDraw(&g_sContext, (int8_t *)"mi/h", -1, 100, 40, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectSpeed = 2;
             }
@@ -283,7 +305,7 @@ void showPage3()
             GrStringDraw(&g_sContext, (int8_t *)"km/h", -1, 45, 40, 1);
             GrStringDraw(&g_sContext, (int8_t *)"m/s", -1, 75, 40, 1);
             GrStringDraw(&g_sContextSelected, (int8_t *)"mi/h", -1, 100, 40, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectSpeed = 0;
             }
@@ -310,7 +332,7 @@ void showPage3()
         case 0:
             GrStringDraw(&g_sContextSelected, (int8_t *)"C", -1, 45, 60, 1);
             GrStringDraw(&g_sContext, (int8_t *)"F", -1, 90, 60, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectTemp = 1;
             }
@@ -319,7 +341,7 @@ void showPage3()
             fahrenheit = (myParamStruct.temp * 1.8) + 32.0;
             GrStringDraw(&g_sContext, (int8_t *)"C", -1, 45, 60, 1);
             GrStringDraw(&g_sContextSelected, (int8_t *)"F", -1, 90, 60, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectTemp = 0;
             }
@@ -346,28 +368,28 @@ void showPage3()
         {
         case 0:
             GrStringDraw(&g_sContextSelected, (int8_t *)"29 in", -1, 80, 92, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectWheel = 1;
             }
             break;
         case 1:
             GrStringDraw(&g_sContextSelected, (int8_t *)"27 in", -1, 80, 92, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectWheel = 2;
             }
             break;
         case 2:
             GrStringDraw(&g_sContextSelected, (int8_t *)"26 in", -1, 80, 92, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectWheel = 3;
             }
             break;
         case 3:
             GrStringDraw(&g_sContextSelected, (int8_t *)"28 in", -1, 80, 92, 1);
-            if (!(P4IN & GPIO_PIN1))
+            if (JOYSTICK_SELECT())
             {
                 selectWheel = 0;
             }
@@ -386,8 +408,8 @@ void showPage3()
 }
 void scrollPages()
 {
-    int Xaxis = MAP_ADC14_getResult(ADC_MEM1);
-    int diff = abs(MAP_ADC14_getResult(ADC_MEM1) - XaxisPrev);
+    int Xaxis = JOYSTICK_X();
+    int diff = abs((int)JOYSTICK_X() - XaxisPrev);
     switch (myPage)
     {
     case PAGE_1:
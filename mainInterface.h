@@ -8,8 +8,10 @@
 #ifndef MAININTERFACE_H_
 #define MAININTERFACE_H_
 
+#ifndef SIMULATE_HARDWARE
 #include <ti/devices/msp432p4xx/inc/msp.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
 #include <ti/grlib/grlib.h>
 #include "LcdDriver/Crystalfontz128x128_ST7735.h"
 #include "LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
@@ -51,6 +53,7 @@ typedef struct toShowPage1
     int sats;
     float speed;
     char tripTime[10];
+    float grade;                //!< Grade of the road [%]
 } toShowPage1;
 extern toShowPage1 myParamStruct;
 
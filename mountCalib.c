@@ -0,0 +1,385 @@
+/*!
+    @file       mountCalib.c
+    @ingroup    MountCalib_Module
+    @brief      Automatic calibration of the mounting orientation of the MPU6050 implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Local Includes */
+#include "mountCalib.h"
+
+/*!
+    @addtogroup MountCalib_Module
+    @{
+*/
+
+#define MOUNT_STANDARD_GRAVITY      9.81f               //!< [m/s^2]
+#define MOUNT_DEG_TO_RAD            0.017453292f
+#define MOUNT_ROW_TOLERANCE         0.02f               //!< Norm and orthogonality of a loaded matrix
+
+static MountState_t mcState = MOUNT_UNCALIBRATED;
+static int16_t mcMatrix[3][3] = {{MOUNT_ONE, 0, 0}, {0, MOUNT_ONE, 0}, {0, 0, MOUNT_ONE}};
+static bool mcUnsaved;
+static float mcPeriod;                      //!< Sample period [s]
+static float mcUp[3];                       //!< Up in the sensor frame
+static float mcForward[3];                  //!< Forward in the sensor frame
+
+//Current window
+static float mcSum[3];
+static float mcSumSq;
+static uint16_t mcCount;
+
+//Speed at the start of the window
+static bool mcSpeedSeen;
+static bool mcSpeedConfirmed;
+static float mcSpeed;
+
+//Gravity
+static float mcGravitySum[3];
+static uint8_t mcGravityCount;
+static float mcMovedSum[3];                 //!< Still windows away from the calibrated up
+static uint8_t mcMovedCount;
+
+//Forward axis
+static float mcForwardSum[3];
+static float mcForwardWeight;               //!< Sum of the squared speed changes [g^2]
+
+static float mcDot(const float a[3], const float b[3]){
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/*!
+    @brief      Normalize a vector
+    @return     false if the vector is too short to have a direction
+*/
+static bool mcNormalize(float v[3]){
+    float norm = sqrtf(mcDot(v, v));
+    if(norm < 1e-3f){
+        return false;
+    }
+    v[0] /= norm;
+    v[1] /= norm;
+    v[2] /= norm;
+    return true;
+}
+
+static void mcClear(float v[3]){
+    v[0] = v[1] = v[2] = 0;
+}
+
+/*!
+    @brief      Component of v orthogonal to up, normalized
+*/
+static bool mcHorizontal(float v[3]){
+    float along = mcDot(v, mcUp);
+    v[0] -= along * mcUp[0];
+    v[1] -= along * mcUp[1];
+    v[2] -= along * mcUp[2];
+    return mcNormalize(v);
+}
+
+/*!
+    @brief      Rotation matrix in Q14 from up and forward: rows forward, left = up x forward, up
+*/
+static void mcBuild(void){
+    float left[3];
+    float* rows[3] = {mcForward, left, mcUp};
+    uint8_t i, j;
+
+    if(mcState == MOUNT_GRAVITY){
+        //Forward not known yet: the sensor axis closest to the horizontal plane, x if it is not too steep
+        uint8_t axis = 0;
+        if(fabsf(mcUp[0]) > 0.7f){
+            axis = fabsf(mcUp[1]) < fabsf(mcUp[2]) ? 1 : 2;
+        }
+        mcClear(mcForward);
+        mcForward[axis] = 1.0f;
+        mcHorizontal(mcForward);
+    }
+    left[0] = mcUp[1] * mcForward[2] - mcUp[2] * mcForward[1];
+    left[1] = mcUp[2] * mcForward[0] - mcUp[0] * mcForward[2];
+    left[2] = mcUp[0] * mcForward[1] - mcUp[1] * mcForward[0];
+    for(i = 0; i < 3; ++i){
+        for(j = 0; j < 3; ++j){
+            mcMatrix[i][j] = (int16_t)lroundf(rows[i][j] * MOUNT_ONE);
+        }
+    }
+    mcUnsaved = true;
+}
+
+/*!
+    @brief      Restart the calibration from the identity
+    @param      period: sample period of the IMU [s]
+*/
+void mountCalibReset(float period){
+    uint8_t i, j;
+    mcPeriod = period;
+    mcState = MOUNT_UNCALIBRATED;
+    for(i = 0; i < 3; ++i){
+        for(j = 0; j < 3; ++j){
+            mcMatrix[i][j] = i == j ? MOUNT_ONE : 0;
+        }
+    }
+    mcClear(mcSum);
+    mcSumSq = 0;
+    mcCount = 0;
+    mcSpeedSeen = false;
+    mcClear(mcGravitySum);
+    mcGravityCount = 0;
+    mcClear(mcMovedSum);
+    mcMovedCount = 0;
+    mcClear(mcForwardSum);
+    mcForwardWeight = 0;
+}
+
+/*!
+    @brief      Raw sample of the accelerometer, in the sensor frame
+    @param      accel: x, y, z [g]
+*/
+void mountCalibAddSample(const float accel[3]){
+    mcSum[0] += accel[0];
+    mcSum[1] += accel[1];
+    mcSum[2] += accel[2];
+    mcSumSq += mcDot(accel, accel);
+    ++mcCount;
+}
+
+/*!
+    @brief      Window with the bike still
+    @param      up: direction of the mean acceleration of the window
+    @return     true if the matrix has changed
+*/
+static bool mcStill(const float up[3]){
+    uint8_t i;
+    if(mcState == MOUNT_UNCALIBRATED){
+        for(i = 0; i < 3; ++i){
+            mcGravitySum[i] += up[i];
+        }
+        if(++mcGravityCount < MOUNT_STILL_WINDOWS){
+            return false;
+        }
+        for(i = 0; i < 3; ++i){
+            mcUp[i] = mcGravitySum[i];
+        }
+        mcNormalize(mcUp);
+        mcState = MOUNT_GRAVITY;
+        mcBuild();
+        return true;
+    }
+    if(mcDot(up, mcUp) > cosf(MOUNT_MOVED_DEG * MOUNT_DEG_TO_RAD)){
+        mcClear(mcMovedSum);
+        mcMovedCount = 0;
+        return false;
+    }
+    //Mounted again: the still windows away from the old up are the new gravity, forward is lost
+    for(i = 0; i < 3; ++i){
+        mcMovedSum[i] += up[i];
+    }
+    if(++mcMovedCount < MOUNT_STILL_WINDOWS){
+        return false;
+    }
+    for(i = 0; i < 3; ++i){
+        mcUp[i] = mcMovedSum[i];
+    }
+    mcNormalize(mcUp);
+    mcClear(mcMovedSum);
+    mcMovedCount = 0;
+    mcClear(mcForwardSum);
+    mcForwardWeight = 0;
+    mcState = MOUNT_GRAVITY;
+    mcBuild();
+    return true;
+}
+
+/*!
+    @brief      Window with a confirmed change of speed
+    @param      mean: mean acceleration of the window [g]
+    @param      along: change of speed [g]
+    @return     true if the matrix has changed
+*/
+static bool mcMoving(const float mean[3], float along){
+    float d[3];
+    uint8_t i;
+    for(i = 0; i < 3; ++i){
+        d[i] = mean[i] - mcUp[i];
+    }
+    //Lateral part of the acceleration: a turn or a bump, the window is not used
+    if(mcDot(d, d) - along * along > MOUNT_MAX_LATERAL * MOUNT_MAX_LATERAL){
+        return false;
+    }
+    for(i = 0; i < 3; ++i){
+        mcForwardSum[i] += d[i] * along;
+    }
+    mcForwardWeight += along * along;
+    if(mcForwardWeight < MOUNT_FORWARD_WEIGHT){
+        return false;
+    }
+    for(i = 0; i < 3; ++i){
+        mcForward[i] = mcForwardSum[i];
+    }
+    mcClear(mcForwardSum);
+    mcForwardWeight = 0;
+    if(!mcHorizontal(mcForward)){
+        return false;
+    }
+    mcState = MOUNT_CALIBRATED;
+    mcBuild();
+    return true;
+}
+
+/*!
+    @brief      Speed at the end of a BSS window, closes the window of the samples
+    @param      speed: [m/s]
+    @param      confirmed: the speed is measured by the wheel or by the GPS
+    @return     true if the matrix has changed: the estimates in the bike frame must restart
+*/
+bool mountCalibAddSpeed(float speed, bool confirmed){
+    bool changed = false;
+    if(mcCount > 0){
+        float mean[3] = {mcSum[0] / mcCount, mcSum[1] / mcCount, mcSum[2] / mcCount};
+        float norm = sqrtf(mcDot(mean, mean));
+        float variance = mcSumSq / mcCount - norm * norm;
+        if(speed < MOUNT_STILL_SPEED && variance < MOUNT_STILL_SIGMA * MOUNT_STILL_SIGMA &&
+           fabsf(norm - 1.0f) < MOUNT_STILL_GATE){
+            mean[0] /= norm;
+            mean[1] /= norm;
+            mean[2] /= norm;
+            changed = mcStill(mean);
+        }else if(mcState == MOUNT_GRAVITY && mcSpeedSeen && mcSpeedConfirmed && confirmed &&
+                 speed >= MOUNT_MIN_SPEED && mcSpeed >= MOUNT_MIN_SPEED){
+            float along = (speed - mcSpeed) / ((float)mcCount * mcPeriod);
+            if(fabsf(along) >= MOUNT_MIN_ALONG){
+                changed = mcMoving(mean, along / MOUNT_STANDARD_GRAVITY);
+            }
+        }
+    }
+    mcClear(mcSum);
+    mcSumSq = 0;
+    mcCount = 0;
+    mcSpeedSeen = true;
+    mcSpeedConfirmed = confirmed;
+    mcSpeed = speed;
+    return changed;
+}
+
+/*!
+    @brief      Rotate a raw vector from the sensor to the bike frame, in fixed point
+    @param      v: raw counts, rotated in place
+*/
+void mountCalibRotate(int16_t v[3]){
+    int32_t out[3];
+    uint8_t i;
+    for(i = 0; i < 3; ++i){
+        out[i] = ((int32_t)mcMatrix[i][0] * v[0] + (int32_t)mcMatrix[i][1] * v[1] +
+                  (int32_t)mcMatrix[i][2] * v[2] + (1 << (MOUNT_Q - 1))) >> MOUNT_Q;
+    }
+    for(i = 0; i < 3; ++i){
+        v[i] = out[i] > INT16_MAX ? INT16_MAX : out[i] < INT16_MIN ? INT16_MIN : (int16_t)out[i];
+    }
+}
+
+MountState_t mountCalibGetState(void){
+    return mcState;
+}
+
+/*!
+    @brief      Rotation matrix from the sensor to the bike frame, Q14
+*/
+void mountCalibGetMatrix(int16_t matrix[3][3]){
+    uint8_t i, j;
+    for(i = 0; i < 3; ++i){
+        for(j = 0; j < 3; ++j){
+            matrix[i][j] = mcMatrix[i][j];
+        }
+    }
+}
+
+/*!
+    @brief      The matrix has changed since the last save or load
+*/
+bool mountCalibIsUnsaved(void){
+    return mcUnsaved;
+}
+
+void mountCalibSetSaved(void){
+    mcUnsaved = false;
+}
+
+/*!
+    @brief      Line of the calibration file, after @ref MOUNT_HEADER
+    @param      buf: destination, at least @ref MOUNT_LINE_LEN bytes
+    @param      size: size of buf
+    @return     length of the line, 0 if it does not fit
+*/
+size_t mountCalibFormat(char* buf, size_t size){
+    int len = snprintf(buf, size, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", (int)mcState,
+                       mcMatrix[0][0], mcMatrix[0][1], mcMatrix[0][2],
+                       mcMatrix[1][0], mcMatrix[1][1], mcMatrix[1][2],
+                       mcMatrix[2][0], mcMatrix[2][1], mcMatrix[2][2]);
+    return len > 0 && (size_t)len < size ? (size_t)len : 0;
+}
+
+/*!
+    @brief      Load a saved calibration
+    @details    The matrix must be a rotation: rows of unit length and orthogonal within
+                @ref MOUNT_ROW_TOLERANCE, otherwise the calibration is not changed.
+    @param      line: line written by @ref mountCalibFormat
+    @return     true if the calibration has been loaded
+*/
+bool mountCalibParse(const char* line){
+    float rows[3][3];
+    int16_t matrix[3][3];
+    char* end;
+    long state = strtol(line, &end, 10);
+    uint8_t i, j;
+
+    if(end == line || state < MOUNT_UNCALIBRATED || state > MOUNT_CALIBRATED){
+        return false;
+    }
+    for(i = 0; i < 3; ++i){
+        for(j = 0; j < 3; ++j){
+            line = end;
+            if(*line++ != ','){
+                return false;
+            }
+            long value = strtol(line, &end, 10);
+            if(end == line || value < INT16_MIN || value > INT16_MAX){
+                return false;
+            }
+            matrix[i][j] = (int16_t)value;
+            rows[i][j] = (float)value / MOUNT_ONE;
+        }
+    }
+    for(i = 0; i < 3; ++i){
+        if(fabsf(mcDot(rows[i], rows[i]) - 1.0f) > MOUNT_ROW_TOLERANCE ||
+           fabsf(mcDot(rows[i], rows[(i + 1) % 3])) > MOUNT_ROW_TOLERANCE){
+            return false;
+        }
+    }
+    for(i = 0; i < 3; ++i){
+        for(j = 0; j < 3; ++j){
+            mcMatrix[i][j] = matrix[i][j];
+        }
+        mcForward[i] = rows[0][i];
+        mcUp[i] = rows[2][i];
+    }
+    mcState = (MountState_t)state;
+    mcClear(mcGravitySum);
+    mcGravityCount = 0;
+    mcClear(mcMovedSum);
+    mcMovedCount = 0;
+    mcClear(mcForwardSum);
+    mcForwardWeight = 0;
+    mcUnsaved = false;
+    return true;
+}
+
+/*! @} */ //End of MountCalib_Module
@@ -0,0 +1,82 @@
+/*!
+    @file       mountCalib.h
+    @ingroup    MountCalib_Module
+    @brief      Automatic calibration of the mounting orientation of the MPU6050
+    @details    The BSS and the attitude filter expect the x axis of the samples forward and z up, so
+                a box mounted rotated or tilted would move the braking acceleration off the x axis.
+                The calibration finds the rotation from the sensor to the bike frame by itself:
+                - up: the mean acceleration of the BSS windows with the bike still (speed below
+                  @ref MOUNT_STILL_SPEED, the samples of the window within @ref MOUNT_STILL_SIGMA of
+                  their mean, the mean within @ref MOUNT_STILL_GATE of 1 g), over
+                  @ref MOUNT_STILL_WINDOWS windows;
+                - forward: the acceleration without the gravity of the windows where the wheel or the
+                  GPS confirm a change of speed of at least @ref MOUNT_MIN_ALONG, weighted with the
+                  change, so braking counts as well and the turns average out, until the sum of the
+                  squared changes reaches @ref MOUNT_FORWARD_WEIGHT; the component along up is
+                  removed. Until it is known, forward is the sensor x axis on the horizontal plane.
+                The rows of the rotation matrix are forward, left and up in the sensor frame. It is
+                kept in Q14 and applied in fixed point to the raw samples of accelerometer and
+                gyroscope, before any other processing.
+                The matrix is saved in @ref MOUNT_FILE and loaded at the power on. If the still
+                gravity moves by more than @ref MOUNT_MOVED_DEG for @ref MOUNT_STILL_WINDOWS windows
+                the box has been mounted again and the calibration restarts.
+                The module does not depend on the hardware: Test/mountCalib.py runs the same
+                calibration on synthetic traces with the sensor rotated to evaluate it.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __MOUNT_CALIB_H__
+#define __MOUNT_CALIB_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    @defgroup   MountCalib_Module Mounting Calibration
+    @name       Mounting Calibration Module
+    @{
+*/
+
+#define MOUNT_Q                     14          //!< Fractional bits of the matrix
+#define MOUNT_ONE                   (1 << MOUNT_Q)
+
+#define MOUNT_STILL_SPEED           0.5f        //!< Faster the bike is not still [m/s]
+#define MOUNT_STILL_SIGMA           0.02f       //!< Standard deviation of the samples of a still window [g]
+#define MOUNT_STILL_GATE            0.05f       //!< Mean of a still window within 1 g +- this [g]
+#define MOUNT_STILL_WINDOWS         20          //!< Still windows for the gravity (3 s of BSS windows)
+#define MOUNT_MOVED_DEG             10.0f       //!< Larger changes of the still gravity restart the calibration
+
+#define MOUNT_MIN_SPEED             2.0f        //!< Slower the speed changes are not used [m/s]
+#define MOUNT_MIN_ALONG             0.5f        //!< Smallest confirmed change of speed [m/s^2]
+#define MOUNT_MAX_LATERAL           0.1f        //!< Acceleration not explained by the change of speed, a turn [g]
+#define MOUNT_FORWARD_WEIGHT        1.0f        //!< Sum of the squared speed changes for the forward axis [g^2]
+
+#define MOUNT_FILE                  "MOUNT.CSV" //!< Saved calibration
+#define MOUNT_HEADER                "state,fx,fy,fz,lx,ly,lz,ux,uy,uz\n"
+#define MOUNT_LINE_LEN              80          //!< Buffer size for the line of the calibration
+
+//! Progress of the calibration
+typedef enum{
+    MOUNT_UNCALIBRATED = 0,                     //!< Identity, the sensor frame is the bike frame
+    MOUNT_GRAVITY,                              //!< Up known, forward from the sensor x axis
+    MOUNT_CALIBRATED,                           //!< Up and forward known
+} MountState_t;
+
+void mountCalibReset(float period);
+void mountCalibAddSample(const float accel[3]);
+bool mountCalibAddSpeed(float speed, bool confirmed);
+void mountCalibRotate(int16_t v[3]);
+
+MountState_t mountCalibGetState(void);
+void mountCalibGetMatrix(int16_t matrix[3][3]);
+bool mountCalibIsUnsaved(void);
+void mountCalibSetSaved(void);
+size_t mountCalibFormat(char* buf, size_t size);
+bool mountCalibParse(const char* line);
+
+/*! @} */ //End of MountCalib_Module
+
+#endif // __MOUNT_CALIB_H__
@@ -0,0 +1,291 @@
+/*!
+    @file       numFormat.c
+    @ingroup    NumFormat_Module
+    @brief      Integer-only number formatting function implementations
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/* Local Includes */
+#include "numFormat.h"
+
+/*!
+    @addtogroup NumFormat_Module
+    @{
+*/
+
+//! Powers of ten used to scale the fraction part
+static const uint32_t pow10Table[NUMFORMAT_MAX_FRAC_DIGITS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+/*!
+    @brief    Write the decimal digits of an unsigned value
+    @details  The digits are generated backwards in a local buffer and then copied after the
+              cursor, padding with zeros up to minDigits.
+    @param    p: write cursor
+    @param    end: last usable position (reserved for the terminator)
+    @param    value: value to print
+    @param    minDigits: minimum number of digits, zero padded
+    @return   the new cursor or NULL if the digits do not fit
+*/
+static char* putUnsigned(char* p, const char* end, uint32_t value, uint8_t minDigits){
+    char digits[10];
+    uint8_t n = 0;
+    do{
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    }while(value != 0);
+
+    uint8_t width = n > minDigits ? n : minDigits;
+    if(p == NULL || end - p < width){
+        return NULL;
+    }
+    while(width > n){
+        *p++ = '0';
+        width--;
+    }
+    while(n > 0){
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+/*!
+    @brief    Write a single character
+    @param    p: write cursor
+    @param    end: last usable position (reserved for the terminator)
+    @param    c: character
+    @return   the new cursor or NULL if the character does not fit
+*/
+static char* putChar(char* p, const char* end, char c){
+    if(p == NULL || p >= end){
+        return NULL;
+    }
+    *p++ = c;
+    return p;
+}
+
+/*!
+    @brief    Terminate the string and compute the returned length
+    @details  If the cursor is NULL the conversion has overflowed and the buffer is cleared.
+    @param    buf: start of the buffer
+    @param    p: write cursor
+    @return   number of characters written, terminator excluded
+*/
+static size_t terminate(char* buf, char* p){
+    if(p == NULL){
+        buf[0] = '\0';
+        return 0;
+    }
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/*!
+    @brief    Format an integer
+    @param    buf: destination buffer
+    @param    size: size of the buffer, terminator included
+    @param    value: value to print
+    @param    minDigits: minimum number of digits, zero padded (sign excluded)
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatInt(char* buf, size_t size, int32_t value, uint8_t minDigits){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    char* end = buf + size - 1;
+    char* p = buf;
+    uint32_t magnitude = (uint32_t)value;
+    if(value < 0){
+        p = putChar(p, end, '-');
+        magnitude = 0u - magnitude;
+    }
+    p = putUnsigned(p, end, magnitude, minDigits);
+    return terminate(buf, p);
+}
+
+/*!
+    @brief    Format a fixed point value
+    @details  The value is interpreted as an integer scaled by 10^fracDigits,
+              e.g. numFormatFixed(buf, size, -1234, 2) gives "-12.34".
+    @param    buf: destination buffer
+    @param    size: size of the buffer, terminator included
+    @param    value: scaled value
+    @param    fracDigits: number of fraction digits (max @ref NUMFORMAT_MAX_FRAC_DIGITS)
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatFixed(char* buf, size_t size, int32_t value, uint8_t fracDigits){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    if(fracDigits > NUMFORMAT_MAX_FRAC_DIGITS){
+        buf[0] = '\0';
+        return 0;
+    }
+    char* end = buf + size - 1;
+    char* p = buf;
+    uint32_t magnitude = (uint32_t)value;
+    if(value < 0){
+        p = putChar(p, end, '-');
+        magnitude = 0u - magnitude;
+    }
+    p = putUnsigned(p, end, magnitude / pow10Table[fracDigits], 1);
+    if(fracDigits > 0){
+        p = putChar(p, end, '.');
+        p = putUnsigned(p, end, magnitude % pow10Table[fracDigits], fracDigits);
+    }
+    return terminate(buf, p);
+}
+
+/*!
+    @brief    Format a float with a fixed number of fraction digits
+    @details  Equivalent to snprintf("%.Nf") for values whose integer part fits in 31 bits.
+              The integer part is split before scaling, so that the fraction keeps the full float
+              precision and the rounding matches the one of newlib (round half to even).
+              NaN and out of range values are not printed.
+    @param    buf: destination buffer
+    @param    size: size of the buffer, terminator included
+    @param    value: value to print
+    @param    fracDigits: number of fraction digits (max @ref NUMFORMAT_MAX_FRAC_DIGITS)
+    @return   number of characters written, 0 if the value cannot be printed
+*/
+size_t numFormatFloat(char* buf, size_t size, float value, uint8_t fracDigits){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    // The comparisons are false for NaN too
+    if(fracDigits > NUMFORMAT_MAX_FRAC_DIGITS || !(value > -2147483648.0f && value < 2147483648.0f)){
+        buf[0] = '\0';
+        return 0;
+    }
+    char* end = buf + size - 1;
+    char* p = buf;
+    bool negative = value < 0.0f;
+    if(negative){
+        value = -value;
+    }
+    uint32_t intPart = (uint32_t)value;
+    uint32_t scale = pow10Table[fracDigits];
+    // The fraction is taken in Q64 as two Q32 words (exact, scaling by powers of two: the bits of
+    // the values under 2^-9 go beyond 2^-32) and multiplied by the scale with two 32x32->64
+    // multiplies, so the rounding is done on the exact value like printf does
+    float fracQ32 = (value - (float)intPart) * 4294967296.0f;
+    uint32_t fracHi = (uint32_t)fracQ32;
+    uint32_t fracLo = (uint32_t)((fracQ32 - (float)fracHi) * 4294967296.0f);
+    uint64_t scaledLo = (uint64_t)fracLo * scale;
+    uint64_t scaledHi = (uint64_t)fracHi * scale + (scaledLo >> 32);
+    uint32_t fracPart = (uint32_t)(scaledHi >> 32);
+    uint32_t remainder = (uint32_t)scaledHi;
+    // Round half to even, a remainder exactly half only if the low word is 0
+    uint32_t lastDigit = fracDigits > 0 ? fracPart : intPart;
+    if(remainder > 0x80000000u || (remainder == 0x80000000u && ((uint32_t)scaledLo != 0 || (lastDigit & 1)))){
+        fracPart++;
+    }
+    if(fracPart >= scale){
+        fracPart -= scale;
+        intPart++;
+    }
+    // Avoid printing "-0.00"
+    if(negative && (intPart != 0 || fracPart != 0)){
+        p = putChar(p, end, '-');
+    }
+    p = putUnsigned(p, end, intPart, 1);
+    if(fracDigits > 0){
+        p = putChar(p, end, '.');
+        p = putUnsigned(p, end, fracPart, fracDigits);
+    }
+    return terminate(buf, p);
+}
+
+/*!
+    @brief    Format a duration as HH:MM:SS
+    @details  Hours are printed with at least two digits and are not wrapped at 24.
+    @param    buf: destination buffer (at least @ref NUMFORMAT_TIME_LEN bytes for durations under 100 h)
+    @param    size: size of the buffer, terminator included
+    @param    seconds: duration in seconds
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatTime(char* buf, size_t size, uint32_t seconds){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    char* end = buf + size - 1;
+    char* p = buf;
+    p = putUnsigned(p, end, seconds / 3600, 2);
+    p = putChar(p, end, ':');
+    p = putUnsigned(p, end, (seconds / 60) % 60, 2);
+    p = putChar(p, end, ':');
+    p = putUnsigned(p, end, seconds % 60, 2);
+    return terminate(buf, p);
+}
+
+/*!
+    @brief    Format a date as an ISO 8601 UTC timestamp
+    @details  The output is "YYYY-MM-DDTHH:MM:SSZ", as used in the GPX files.
+    @param    buf: destination buffer (at least @ref NUMFORMAT_ISO8601_LEN bytes)
+    @param    size: size of the buffer, terminator included
+    @param    timeInfo: broken down time, as filled by getDateFromString
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatISO8601(char* buf, size_t size, const struct tm* timeInfo){
+    return numFormatISO8601Ms(buf, size, timeInfo, 0);
+}
+
+/*!
+    @brief    Format a date with milliseconds as an ISO 8601 UTC timestamp
+    @details  The output is "YYYY-MM-DDTHH:MM:SS.mmmZ" for the fixes of a GPS faster than 1 Hz;
+              the fraction is left out when ms is 0, as in @ref numFormatISO8601.
+    @param    buf: destination buffer (at least @ref NUMFORMAT_ISO8601_MS_LEN bytes)
+    @param    size: size of the buffer, terminator included
+    @param    timeInfo: broken down time
+    @param    ms: milliseconds, 0-999
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatISO8601Ms(char* buf, size_t size, const struct tm* timeInfo, uint16_t ms){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    if(timeInfo == NULL || timeInfo->tm_year < -1900){
+        buf[0] = '\0';
+        return 0;
+    }
+    char* end = buf + size - 1;
+    char* p = buf;
+    p = putUnsigned(p, end, (uint32_t)(timeInfo->tm_year + 1900), 4);
+    p = putChar(p, end, '-');
+    p = putUnsigned(p, end, (uint32_t)(timeInfo->tm_mon + 1), 2);
+    p = putChar(p, end, '-');
+    p = putUnsigned(p, end, (uint32_t)timeInfo->tm_mday, 2);
+    p = putChar(p, end, 'T');
+    p = putUnsigned(p, end, (uint32_t)timeInfo->tm_hour, 2);
+    p = putChar(p, end, ':');
+    p = putUnsigned(p, end, (uint32_t)timeInfo->tm_min, 2);
+    p = putChar(p, end, ':');
+    p = putUnsigned(p, end, (uint32_t)timeInfo->tm_sec, 2);
+    if(ms != 0){
+        p = putChar(p, end, '.');
+        p = putUnsigned(p, end, ms % 1000, 3);
+    }
+    p = putChar(p, end, 'Z');
+    return terminate(buf, p);
+}
+
+/*!
+    @brief    Format a coordinate in decimal degrees
+    @details  Six fraction digits are printed, the same output of the "%f" used before
+              (about 0.1 m of resolution).
+    @param    buf: destination buffer (at least @ref NUMFORMAT_COORDINATE_LEN bytes)
+    @param    size: size of the buffer, terminator included
+    @param    degrees: latitude or longitude, negative for S and W
+    @return   number of characters written, 0 if the buffer is too small
+*/
+size_t numFormatCoordinate(char* buf, size_t size, float degrees){
+    return numFormatFloat(buf, size, degrees, 6);
+}
+
+/*! @} */ // NumFormat_Module
@@ -0,0 +1,45 @@
+/*!
+    @file       numFormat.h
+    @ingroup    NumFormat_Module
+    @brief      Integer-only number formatting functions
+    @details    This module replaces snprintf("%f") in the UI and GPS paths, so that newlib float printf
+                support does not need to be linked. All the conversions are done with 32 bit integers:
+                float values are scaled and rounded once and then printed digit by digit.
+                Every function receives the destination buffer and its size and never writes more than
+                size bytes: if the result does not fit, the buffer is left as an empty string and 0 is
+                returned.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __NUM_FORMAT_H__
+#define __NUM_FORMAT_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+/*!
+    @defgroup   NumFormat_Module Number Formatting
+    @name       Number Formatting Module
+    @{
+*/
+
+#define NUMFORMAT_MAX_FRAC_DIGITS   6       //!< Max fraction digits supported by numFormatFloat
+#define NUMFORMAT_ISO8601_LEN       21      //!< Buffer size for "YYYY-MM-DDTHH:MM:SSZ"
+#define NUMFORMAT_ISO8601_MS_LEN    25      //!< Buffer size for "YYYY-MM-DDTHH:MM:SS.mmmZ"
+#define NUMFORMAT_TIME_LEN          9       //!< Buffer size for "HH:MM:SS"
+#define NUMFORMAT_COORDINATE_LEN    12      //!< Buffer size for "-ddd.dddddd"
+
+size_t numFormatInt(char* buf, size_t size, int32_t value, uint8_t minDigits);
+size_t numFormatFixed(char* buf, size_t size, int32_t value, uint8_t fracDigits);
+size_t numFormatFloat(char* buf, size_t size, float value, uint8_t fracDigits);
+size_t numFormatTime(char* buf, size_t size, uint32_t seconds);
+size_t numFormatISO8601(char* buf, size_t size, const struct tm* timeInfo);
+size_t numFormatISO8601Ms(char* buf, size_t size, const struct tm* timeInfo, uint16_t ms);
+size_t numFormatCoordinate(char* buf, size_t size, float degrees);
+
+/*! @} */ //End of NumFormat_Module
+
+#endif // __NUM_FORMAT_H__
@@ -6,6 +6,7 @@
 */
 
 #include "photoresistor.h"
+#include "battery.h"
 
 /* DriverLib Includes */
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
@@ -74,16 +75,19 @@ void ADC14Init(const Timer_A_UpModeConfig* upModeConfig,
     MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P5, GPIO_PIN4, GPIO_TERTIARY_MODULE_FUNCTION);
     MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P6, GPIO_PIN0, GPIO_TERTIARY_MODULE_FUNCTION);
     MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P4, GPIO_PIN4, GPIO_TERTIARY_MODULE_FUNCTION);
+    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(BATTERY_PORT, BATTERY_PIN, GPIO_TERTIARY_MODULE_FUNCTION);
 
     /* Configuring ADC Memory */
     //MAP_ADC14_configureSingleSampleMode(ADC_MEM3, true);
     //MAP_ADC14_configureConversionMemory(ADC_MEM3, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A1, false);
     //MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, ADC_MEM2, true);
-    MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, ADC_MEM3, true);
+    MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, BATTERY_ADC_MEM, true);
     MAP_ADC14_configureConversionMemory(ADC_MEM0, ADC_VREFPOS_INTBUF_VREFNEG_VSS, ADC_INPUT_A22, false);
     MAP_ADC14_configureConversionMemory(ADC_MEM1, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A15, false);
     MAP_ADC14_configureConversionMemory(ADC_MEM2, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A9, false);
     MAP_ADC14_configureConversionMemory(ADC_MEM3, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A1, false);
+    //Battery on the internal reference, the supply is not a reference for its own voltage
+    MAP_ADC14_configureConversionMemory(BATTERY_ADC_MEM, ADC_VREFPOS_INTBUF_VREFNEG_VSS, BATTERY_ADC_INPUT, false);
 
     /* Configuring Timer_A in continuous mode and sourced from ACLK */
     MAP_Timer_A_configureUpMode(TIMER_A3_BASE, upModeConfig);
@@ -0,0 +1,71 @@
+/*!
+    @file       power.c
+    @ingroup    Power_Module
+    @brief      Power governor implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Local Includes */
+#include "power.h"
+
+/*!
+    @addtogroup Power_Module
+    @{
+*/
+
+//! Policy of the governor, the same of Test/power.py
+static const PowerSettings_t pwModes[POWER_MODE_COUNT] = {
+    //Name          Enter   Exit    GPS [ms]    UI [ms]     Backlight   BSS [ms]    MCLK div    SD sync [s] Load [mA]
+    {"NORMAL",      0,      0,      1000,       1000,       true,       150,        1,          30,         44},
+    {"SAVING",      40,     45,     2000,       2000,       false,      150,        2,          60,         26},
+    {"LOW",         20,     25,     5000,       5000,       false,      300,        4,          120,        26},
+    {"CRITICAL",    8,      12,     10000,      30000,      false,      300,        4,          300,        26},
+};
+
+static PowerMode_t pwMode;
+static uint32_t pwEnteredMs;                //!< Time of the entry in the current mode
+
+void powerInit(void){
+    pwMode = POWER_NORMAL;
+    pwEnteredMs = 0;
+}
+
+/*!
+    @brief      Choose the mode for the state of charge
+    @param      soc: state of charge of the battery [%]
+    @param      nowMs: current time [ms]
+    @return     true if the mode has changed
+*/
+bool powerUpdate(uint8_t soc, uint32_t nowMs){
+    PowerMode_t mode = pwMode;
+    //At once to the mode with the least power whose threshold is crossed
+    while(mode + 1 < POWER_MODE_COUNT && soc < pwModes[mode + 1].socEnter){
+        mode = (PowerMode_t)(mode + 1);
+    }
+    //Back one row, after the dwell
+    if(mode == pwMode && mode != POWER_NORMAL && soc > pwModes[mode].socExit &&
+       nowMs - pwEnteredMs >= POWER_MIN_DWELL_MS){
+        mode = (PowerMode_t)(mode - 1);
+    }
+    if(mode == pwMode){
+        return false;
+    }
+    pwMode = mode;
+    pwEnteredMs = nowMs;
+    return true;
+}
+
+PowerMode_t powerGetMode(void){
+    return pwMode;
+}
+
+const PowerSettings_t* powerGetSettings(PowerMode_t mode){
+    return &pwModes[mode < POWER_MODE_COUNT ? mode : POWER_NORMAL];
+}
+
+/*! @} */ //End of Power_Module
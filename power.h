@@ -0,0 +1,77 @@
+/*!
+    @file       power.h
+    @ingroup    Power_Module
+    @brief      Power governor: modes of operation chosen by the state of charge of the battery
+    @details    Every mode is a row of a table with the threshold of state of charge below which it
+                is entered, the one above which it is left and the settings of the subsystems that
+                take most of the power:
+                - GPS fix period, sent to the L80 with PMTK220: fewer fixes, fewer sentences to
+                  receive and parse and fewer points in the GPX file;
+                - LCD refresh period and backlight;
+                - BSS window: flashing and acquisition period, the MPU6050 keeps its rate and the
+                  extra samples of a longer window stay in its FIFO;
+                - MCLK divider of the 48 MHz DCO: the tasks are slower but the current in active
+                  mode is lower, SMCLK and so UART, SPI and I2C are not changed;
+                - period of the sync of the GPX file on the SD: every sync writes the FAT and the
+                  directory entry, a crash or an empty battery loses at most one period.
+                The last column is the current expected in the mode without the lights, for the drop
+                on the internal resistance of the battery (see battery.h). The lights are never
+                dimmed by the governor, only their pattern follows the BSS window: the backlight is
+                the largest load it can remove.
+                A mode with less power is entered as soon as the state of charge is below its
+                threshold, a mode with more power only after @ref POWER_MIN_DWELL_MS in the current
+                one and one row at a time: with the hysteresis between the two thresholds the
+                recovery of the voltage when the lights go off does not make the modes oscillate.
+                The module does not depend on the hardware: Test/power.py runs the same table on
+                power models of whole rides, and compares it with this file run by Test/powerHost.c.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __POWER_H__
+#define __POWER_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Power_Module Power Governor
+    @name       Power Governor Module
+    @{
+*/
+
+#define POWER_PERIOD_MS             1000        //!< Period of the governor
+#define POWER_MIN_DWELL_MS          60000u      //!< Shortest time in a mode before one with more power
+
+//! Modes in order of power
+typedef enum{
+    POWER_NORMAL = 0,
+    POWER_SAVING,
+    POWER_LOW,
+    POWER_CRITICAL,
+    POWER_MODE_COUNT
+} PowerMode_t;
+
+//! Row of the table of the modes
+typedef struct{
+    const char* name;
+    uint8_t socEnter;                           //!< Entered below this state of charge [%]
+    uint8_t socExit;                            //!< Left above this state of charge [%]
+    uint16_t gpsFixMs;                          //!< GPS fix period [ms]
+    uint16_t uiPeriodMs;                        //!< Shortest period of the LCD refresh [ms]
+    bool backlight;                             //!< LCD backlight on
+    uint16_t bssPeriodMs;                       //!< BSS window [ms]
+    uint8_t mclkDivider;                        //!< MCLK = DCO / this: 1, 2 or 4
+    uint16_t sdSyncS;                           //!< Period of the sync of the GPX file [s]
+    uint16_t loadMa;                            //!< Battery current without the lights, from Test/power.py [mA]
+} PowerSettings_t;
+
+void powerInit(void);
+bool powerUpdate(uint8_t soc, uint32_t nowMs);
+PowerMode_t powerGetMode(void);
+const PowerSettings_t* powerGetSettings(PowerMode_t mode);
+
+/*! @} */ //End of Power_Module
+
+#endif // __POWER_H__
@@ -0,0 +1,217 @@
+/*!
+    @file       profiler.c
+    @ingroup    Profiler_Module
+    @brief      Cycle counting profiler implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifdef SIMULATE_HARDWARE
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Local Includes */
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "log.h"
+#define PRINTF(...) LOG_INFO(__VA_ARGS__)
+
+/*!
+    @addtogroup Profiler_Module
+    @{
+*/
+
+//! Per region bookkeeping
+typedef struct{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROF_HIST_BUCKETS];
+} ProfData_t;
+
+//! Names of the regions, in the order of @ref ProfRegion_t
+static const char* const profNames[PROF_NUM_REGIONS] = {
+    "acquire_window",
+    "compute",
+    "gpsParseData",
+    "showPages",
+    "GPXAddTrackPoint",
+    "fusion",
+    "f_write",
+    "TA0_N ISR",
+    "TA1_0 ISR",
+    "ADC14 ISR",
+    "DMA_INT1 ISR",
+    "EUSCIA0 ISR",
+    "EUSCIA2 ISR",
+    "PORT3 ISR",
+    "PORT5 ISR",
+};
+
+static ProfData_t profData[PROF_NUM_REGIONS];           //!< Statistics of the regions
+static uint8_t profDivider = 1;                         //!< MCLK divider of the 48 MHz DCO, see profSetClockDivider
+
+#ifndef SIMULATE_HARDWARE
+
+/*!
+    @brief    Enable the DWT cycle counter
+*/
+static void profPortInit(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#else
+
+static void profPortInit(void){
+}
+
+/*!
+    @brief    Read the time base
+    @return   host monotonic clock in nanoseconds, truncated to 32 bits
+*/
+uint32_t profNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+#endif
+
+/*!
+    @brief    Initialize the profiler
+    @details  Starts the time base and clears the statistics.
+*/
+void profInit(void){
+    profPortInit();
+    profReset();
+}
+
+/*!
+    @brief    New MCLK divider of the 48 MHz DCO
+    @details  The DWT counts MCLK cycles: from now on the measures are multiplied by the divider, so
+              the statistics stay in ticks of @ref PROF_TICKS_PER_US and the ones already recorded keep
+              their meaning. A region running across the change is scaled by the new divider. On the
+              host the time base does not depend on the clock.
+    @param    divider: MCLK = DCO / divider, 1, 2 or 4
+*/
+void profSetClockDivider(uint8_t divider){
+    profDivider = divider != 0 ? divider : 1;
+}
+
+/*!
+    @brief    Record a measure
+    @details  Called by @ref PROF_EXIT. A region must be measured always from the same context (task or
+              ISR), different regions can be recorded by different contexts.
+    @param    region: measured region
+    @param    ticks: duration of the region, in ticks of the time base
+*/
+void profRecord(ProfRegion_t region, uint32_t ticks){
+    if(region >= PROF_NUM_REGIONS){
+        return;
+    }
+#ifndef SIMULATE_HARDWARE
+    ticks *= profDivider;
+#endif
+    ProfData_t* data = &profData[region];
+    data->count++;
+    data->total += ticks;
+    if(ticks < data->min){
+        data->min = ticks;
+    }
+    if(ticks > data->max){
+        data->max = ticks;
+    }
+
+    //Bucket = floor(log2(ticks)) - PROF_HIST_FIRST_BIT, saturated at both ends
+    uint8_t bucket = 0;
+    uint32_t limit = ticks >> (PROF_HIST_FIRST_BIT + 1);
+    while(limit != 0 && bucket < PROF_HIST_BUCKETS - 1){
+        limit >>= 1;
+        bucket++;
+    }
+    data->hist[bucket]++;
+}
+
+/*!
+    @brief    Get the statistics of a region
+    @param    region: region to read
+    @param    stats: filled with the statistics, in ticks
+    @return   false if the region does not exist
+*/
+bool profGetStats(ProfRegion_t region, ProfStats_t* stats){
+    if(region >= PROF_NUM_REGIONS || stats == NULL){
+        return false;
+    }
+    const ProfData_t* data = &profData[region];
+    stats->name = profNames[region];
+    stats->count = data->count;
+    stats->min = data->count != 0 ? data->min : 0;
+    stats->max = data->max;
+    stats->mean = data->count != 0 ? (uint32_t)(data->total / data->count) : 0;
+    memcpy(stats->hist, data->hist, sizeof(stats->hist));
+    return true;
+}
+
+/*!
+    @brief    Clear the statistics of all the regions
+*/
+void profReset(void){
+    uint8_t i;
+    memset(profData, 0, sizeof(profData));
+    for(i = 0; i < PROF_NUM_REGIONS; ++i){
+        profData[i].min = UINT32_MAX;
+    }
+}
+
+/*!
+    @brief    Print the statistics on the PC UART
+    @details  Only the regions measured at least once are printed. The histogram lists the non empty
+              buckets as "2^k:n", n measures between 2^k and 2^(k+1) ticks. The first bucket is printed
+              as "<2^k:n", the measures under 2^(PROF_HIST_FIRST_BIT + 1) ticks, and the last one as
+              ">=2^k:n", the measures of 2^k ticks and longer.
+*/
+void profReport(void){
+    ProfStats_t stats;
+    uint8_t i, b;
+
+    PRINTF("Profiler (%d ticks/us):\r\n", (int)PROF_TICKS_PER_US);
+    for(i = 0; i < PROF_NUM_REGIONS; ++i){
+        profGetStats((ProfRegion_t)i, &stats);
+        if(stats.count == 0){
+            continue;
+        }
+        PRINTF("%s: n %d, min %d, mean %d, max %d ticks (max %d us)\r\n", stats.name, (int)stats.count,
+                                                                           (int)stats.min, (int)stats.mean,
+                                                                           (int)stats.max,
+                                                                           (int)(stats.max / PROF_TICKS_PER_US));
+        PRINTF("   ");
+        for(b = 0; b < PROF_HIST_BUCKETS; ++b){
+            if(stats.hist[b] == 0){
+                continue;
+            }
+            if(b == 0){
+                PRINTF(" <2^%d:%d", (int)(PROF_HIST_FIRST_BIT + 1), (int)stats.hist[b]);
+            }else if(b == PROF_HIST_BUCKETS - 1){
+                PRINTF(" >=2^%d:%d", (int)(b + PROF_HIST_FIRST_BIT), (int)stats.hist[b]);
+            }else{
+                PRINTF(" 2^%d:%d", (int)(b + PROF_HIST_FIRST_BIT), (int)stats.hist[b]);
+            }
+        }
+        PRINTF("\r\n");
+    }
+}
+
+/*! @} */ // Profiler_Module
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,135 @@
+/*!
+    @file       profiler.h
+    @ingroup    Profiler_Module
+    @brief      Cycle counting profiler for the hot paths
+    @details    Every region is measured between @ref PROF_ENTER and @ref PROF_EXIT; for each region the
+                profiler keeps the number of runs, the min, the max, the total (for the mean) and a
+                histogram with power of two buckets, all in static tables.
+                On the target the time base is the DWT cycle counter of the Cortex-M4, which counts MCLK
+                cycles: the measures are scaled by the MCLK divider (@ref profSetClockDivider), so the
+                statistics are always in cycles of the 48 MHz DCO. On the host (SIMULATE_HARDWARE) it is
+                clock_gettime (1 tick = 1 ns), so the same macros work in the simulator and in the
+                benchmarks.
+                The times are inclusive: a region interrupted by an ISR counts the ISR too.
+                The profiler is enabled when the PC UART is available (DEBUG and not STAND_ALONE) and on
+                the host; define PROFILER_ENABLED to 0 or 1 to force it.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SIMULATE_HARDWARE
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#endif
+
+/*!
+    @defgroup   Profiler_Module Profiler
+    @name       Profiler Module
+    @{
+*/
+
+#ifndef PROFILER_ENABLED
+    #if defined(SIMULATE_HARDWARE) || (defined(DEBUG) && !defined(STAND_ALONE))
+        #define PROFILER_ENABLED    1
+    #else
+        #define PROFILER_ENABLED    0
+    #endif
+#endif
+
+#ifndef SIMULATE_HARDWARE
+    #define PROF_TICKS_PER_US       48          //!< Ticks per microsecond, DCO cycles at 48 MHz
+#else
+    #define PROF_TICKS_PER_US       1000        //!< Host ticks per microsecond (nanoseconds)
+#endif
+
+#define PROF_HIST_BUCKETS           16          //!< Number of histogram buckets
+#define PROF_HIST_FIRST_BIT         6           //!< Bucket 0 holds the times under 2^(PROF_HIST_FIRST_BIT + 1) ticks
+
+//! Profiled regions
+typedef enum{
+    PROF_ACQUIRE_WINDOW = 0,                    //!< BSS: acquire_window()
+    PROF_COMPUTE,                               //!< BSS: compute()
+    PROF_GPS_PARSE,                             //!< gpsParseData()
+    PROF_SHOW_PAGES,                            //!< showPages()
+    PROF_GPX_ADD_POINT,                         //!< GPXAddTrackPoint()
+    PROF_FUSION,                                //!< fusionAddAccel(), fusionAddWheel(), fusionAddGps()
+    PROF_F_WRITE,                               //!< FatFs f_write() and f_printf() of the GPX and CSV files
+    PROF_ISR_TA0_N,                             //!< Speed capture ISR
+    PROF_ISR_TA1_0,                             //!< Software timers ISR
+    PROF_ISR_ADC14,                             //!< Temperature and light ISR
+    PROF_ISR_DMA_INT1,                          //!< GPS DMA ISR
+    PROF_ISR_EUSCIA0,                           //!< PC UART ISR
+    PROF_ISR_EUSCIA2,                           //!< GPS UART ISR
+    PROF_ISR_PORT3,                             //!< Stop button ISR
+    PROF_ISR_PORT5,                             //!< Start button ISR
+    PROF_NUM_REGIONS
+} ProfRegion_t;
+
+//! Statistics of a region, times in ticks
+typedef struct{
+    const char* name;                           //!< Name of the region
+    uint32_t count;                             //!< Number of measures
+    uint32_t min;                               //!< Shortest measure
+    uint32_t max;                               //!< Longest measure
+    uint32_t mean;                              //!< Mean of the measures
+    uint32_t hist[PROF_HIST_BUCKETS];           //!< Bucket i counts the measures in [2^(i+FIRST_BIT), 2^(i+FIRST_BIT+1)), the last one also the longer
+} ProfStats_t;
+
+#if PROFILER_ENABLED
+
+#ifndef SIMULATE_HARDWARE
+/*!
+    @brief    Read the time base
+    @return   DWT cycle counter
+*/
+static inline uint32_t profNow(void){
+    return DWT->CYCCNT;
+}
+#else
+uint32_t profNow(void);
+#endif
+
+/*!
+    @brief    Start measuring a region
+    @details  Declares a local variable, so @ref PROF_EXIT must be in the same scope.
+*/
+#define PROF_ENTER(region)      uint32_t profStart_##region = profNow()
+//! Stop measuring a region and record the time
+#define PROF_EXIT(region)       profRecord((region), profNow() - profStart_##region)
+/*!
+    @brief    Measure a single statement, a call repeated in the same scope included
+*/
+#define PROF_CALL(region, ...)  do{ PROF_ENTER(region); __VA_ARGS__; PROF_EXIT(region); }while(0)
+
+void profInit(void);
+void profSetClockDivider(uint8_t divider);
+void profRecord(ProfRegion_t region, uint32_t ticks);
+bool profGetStats(ProfRegion_t region, ProfStats_t* stats);
+void profReset(void);
+void profReport(void);
+
+#else
+
+#define PROF_ENTER(region)
+#define PROF_EXIT(region)
+#define PROF_CALL(region, ...)  do{ __VA_ARGS__; }while(0)
+
+#define profInit()
+#define profSetClockDivider(divider)
+#define profRecord(region, ticks)
+#define profGetStats(region, stats)     false
+#define profReset()
+#define profReport()
+
+#endif // PROFILER_ENABLED
+
+/*! @} */ //End of Profiler_Module
+
+#endif // __PROFILER_H__
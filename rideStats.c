@@ -0,0 +1,338 @@
+/*!
+    @file       rideStats.c
+    @ingroup    RideStats_Module
+    @brief      Streaming statistics of the ride implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+/* Local Includes */
+#include "rideStats.h"
+#include "numFormat.h"
+
+/*!
+    @addtogroup RideStats_Module
+    @{
+*/
+
+#define RIDESTATS_EARTH_RADIUS      6371000.0f          //!< [m]
+#define RIDESTATS_DEG_TO_RAD        0.017453292f
+
+static bool statsRunning = false;
+static RideTotals_t statsTotals;
+static uint32_t statsStartMs;
+static uint32_t statsLastMs;                //!< Last epoch, wheel or GPS
+
+//Wheel
+static bool statsWheelSeen;
+static uint32_t statsWheelMs;               //!< Last wheel epoch
+static float statsWheelKm;                  //!< Distance of the wheel at the last epoch
+static float statsWheelSpeed;
+
+//GPS
+static bool statsFixValid;
+static uint32_t statsFixMs;
+static float statsLatitude;
+static float statsLongitude;
+static bool statsAltitudeValid;
+static float statsAltitudeRef;              //!< Last counted altitude
+
+static float statsMaxTemp;
+
+//Laps: the totals at the start of the running lap and the closed laps
+static RideTotals_t statsLapStart;
+static float statsLapMaxSpeed;
+static RideTotals_t statsLaps[RIDESTATS_MAX_LAPS];
+static uint8_t statsLapCount;
+
+/*!
+    @brief      Start a new ride, all the statistics are cleared
+    @param      nowMs: time of the start [ms], same time base of the epochs
+*/
+void rideStatsStart(uint32_t nowMs){
+    memset(&statsTotals, 0, sizeof(statsTotals));
+    memset(&statsLapStart, 0, sizeof(statsLapStart));
+    statsStartMs = nowMs;
+    statsLastMs = nowMs;
+    statsWheelSeen = false;
+    statsWheelSpeed = 0;
+    statsFixValid = false;
+    statsAltitudeValid = false;
+    statsMaxTemp = -INFINITY;
+    statsLapMaxSpeed = 0;
+    statsLapCount = 0;
+    statsRunning = true;
+}
+
+/*!
+    @brief      End of the ride, the statistics are kept until the next start
+    @param      nowMs: time of the end [ms]
+*/
+void rideStatsStop(uint32_t nowMs){
+    if(statsRunning){
+        statsTotals.elapsedMs = nowMs - statsStartMs;
+    }
+    statsRunning = false;
+}
+
+bool rideStatsIsRunning(void){
+    return statsRunning;
+}
+
+/*!
+    @brief      Common part of the epochs: time and max speed
+    @details    The time from the previous epoch is moving time if the speed is over the auto-pause
+                threshold and the gap is not a loss of the sensors.
+*/
+static void statsAdvance(uint32_t nowMs, float speed){
+    uint32_t dt = nowMs - statsLastMs;
+    if(dt <= RIDESTATS_MAX_GAP_MS && speed >= RIDESTATS_MOVING_SPEED){
+        statsTotals.movingMs += dt;
+    }
+    statsLastMs = nowMs;
+    statsTotals.elapsedMs = nowMs - statsStartMs;
+    if(speed > statsTotals.maxSpeed){
+        statsTotals.maxSpeed = speed;
+    }
+    if(speed > statsLapMaxSpeed){
+        statsLapMaxSpeed = speed;
+    }
+}
+
+/*!
+    @brief      Distance travelled at a speed: distance and work against rolling resistance and drag
+    @param      distance: [m]
+    @param      speed: [km/h]
+*/
+static void statsAddDistance(float distance, float speed){
+    float v = speed / 3.6f;
+    statsTotals.distance += distance;
+    statsTotals.work += (RIDESTATS_CRR * RIDESTATS_MASS * RIDESTATS_GRAVITY +
+                         0.5f * RIDESTATS_AIR_DENSITY * RIDESTATS_CDA * v * v) * distance;
+}
+
+/*!
+    @brief      Wheel epoch, at every wheel round
+    @param      nowMs: time of the epoch [ms]
+    @param      speed: wheel speed [km/h]
+    @param      distanceKm: distance of the wheel since the reset of the counter [km]
+*/
+void rideStatsAddSpeed(uint32_t nowMs, float speed, float distanceKm){
+    if(!statsRunning){
+        return;
+    }
+    if(statsWheelSeen && distanceKm >= statsWheelKm){
+        statsAddDistance((distanceKm - statsWheelKm) * 1000.0f, speed);
+    }
+    statsWheelSeen = true;
+    statsWheelKm = distanceKm;
+    statsWheelMs = nowMs;
+    statsWheelSpeed = speed;
+    statsAdvance(nowMs, speed);
+}
+
+/*!
+    @brief      GPS epoch, at every valid fix
+    @details    The distance from the previous fix is the equirectangular approximation, accurate to
+                well below a meter for the few meters between two fixes. It is counted only when the
+                time from the previous fix is counted as moving, so the average speed is never above
+                the maximum.
+    @param      nowMs: time of the fix [ms]
+    @param      latitude: [deg]
+    @param      longitude: [deg]
+    @param      altitude: [m]
+*/
+void rideStatsAddFix(uint32_t nowMs, float latitude, float longitude, float altitude){
+    if(!statsRunning){
+        return;
+    }
+    float speed;
+    if(statsWheelSeen && nowMs - statsWheelMs <= RIDESTATS_WHEEL_TIMEOUT_MS){
+        speed = statsWheelSpeed;                        //Distance already counted by the wheel
+    }else if(statsFixValid && nowMs != statsFixMs){
+        float dy = (latitude - statsLatitude) * RIDESTATS_DEG_TO_RAD;
+        float dx = (longitude - statsLongitude) * RIDESTATS_DEG_TO_RAD *
+                   cosf((latitude + statsLatitude) * 0.5f * RIDESTATS_DEG_TO_RAD);
+        float distance = RIDESTATS_EARTH_RADIUS * sqrtf(dx * dx + dy * dy);
+        speed = distance * 3600.0f / (float)(nowMs - statsFixMs);
+        //Jitter of a stopped receiver is not distance, a gap is a pause: same rule of the moving time
+        if(nowMs - statsFixMs <= RIDESTATS_MAX_GAP_MS && speed >= RIDESTATS_MOVING_SPEED){
+            statsAddDistance(distance, speed);
+        }
+    }else{
+        speed = 0;
+    }
+    statsFixValid = true;
+    statsFixMs = nowMs;
+    statsLatitude = latitude;
+    statsLongitude = longitude;
+
+    //Elevation with deadband, the climbs add the potential energy to the work
+    if(!statsAltitudeValid){
+        statsAltitudeRef = altitude;
+        statsAltitudeValid = true;
+    }else if(altitude - statsAltitudeRef >= RIDESTATS_ELEVATION_DEADBAND){
+        statsTotals.ascent += altitude - statsAltitudeRef;
+        statsTotals.work += RIDESTATS_MASS * RIDESTATS_GRAVITY * (altitude - statsAltitudeRef);
+        statsAltitudeRef = altitude;
+    }else if(statsAltitudeRef - altitude >= RIDESTATS_ELEVATION_DEADBAND){
+        statsTotals.descent += statsAltitudeRef - altitude;
+        statsAltitudeRef = altitude;
+    }
+    statsAdvance(nowMs, speed);
+}
+
+/*!
+    @brief      Temperature sample
+    @param      temp: [degC]
+*/
+void rideStatsAddTemperature(float temp){
+    if(statsRunning && temp > statsMaxTemp){
+        statsMaxTemp = temp;
+    }
+}
+
+/*!
+    @brief      Close the running lap and start a new one
+    @param      nowMs: time of the split [ms]
+    @return     false if @ref RIDESTATS_MAX_LAPS laps are already stored
+*/
+bool rideStatsLap(uint32_t nowMs){
+    if(!statsRunning || statsLapCount >= RIDESTATS_MAX_LAPS){
+        return false;
+    }
+    statsTotals.elapsedMs = nowMs - statsStartMs;
+    RideTotals_t* lap = &statsLaps[statsLapCount++];
+    lap->elapsedMs = statsTotals.elapsedMs - statsLapStart.elapsedMs;
+    lap->movingMs = statsTotals.movingMs - statsLapStart.movingMs;
+    lap->distance = statsTotals.distance - statsLapStart.distance;
+    lap->maxSpeed = statsLapMaxSpeed;
+    lap->ascent = statsTotals.ascent - statsLapStart.ascent;
+    lap->descent = statsTotals.descent - statsLapStart.descent;
+    lap->work = statsTotals.work - statsLapStart.work;
+    statsLapStart = statsTotals;
+    statsLapMaxSpeed = 0;
+    return true;
+}
+
+void rideStatsGetTotals(RideTotals_t* totals){
+    *totals = statsTotals;
+}
+
+/*!
+    @brief      Totals of a closed lap
+    @param      lap: index of the lap, from 0
+    @param      totals: destination
+    @return     false if the lap does not exist
+*/
+bool rideStatsGetLap(uint8_t lap, RideTotals_t* totals){
+    if(lap >= statsLapCount){
+        return false;
+    }
+    *totals = statsLaps[lap];
+    return true;
+}
+
+uint8_t rideStatsGetLapCount(void){
+    return statsLapCount;
+}
+
+/*!
+    @brief      Max temperature of the ride, NAN without samples
+*/
+float rideStatsGetMaxTemperature(void){
+    return isinf(statsMaxTemp) ? NAN : statsMaxTemp;
+}
+
+/*!
+    @brief      Average speed on the moving time [km/h]
+*/
+float rideStatsAverageSpeed(const RideTotals_t* totals){
+    if(totals->movingMs == 0){
+        return 0;
+    }
+    return totals->distance * 3600.0f / (float)totals->movingMs;
+}
+
+/*!
+    @brief      Calories burned [kcal], 1 kJ of work is about 1 kcal (gross efficiency about 24%)
+*/
+float rideStatsCalories(const RideTotals_t* totals){
+    return totals->work / 1000.0f;
+}
+
+/*!
+    @brief      Append a field and the separator
+    @return     position after the separator, NULL if it does not fit
+*/
+static char* statsPutField(char* p, char* end, const char* field, char separator){
+    size_t len = strlen(field);
+    if(p == NULL || (size_t)(end - p) < len + 1){
+        return NULL;
+    }
+    memcpy(p, field, len);
+    p += len;
+    *p++ = separator;
+    return p;
+}
+
+/*!
+    @brief      Line of the ride index with the totals of the ride
+    @details    The fields are the ones of @ref RIDESTATS_INDEX_HEADER, the line ends with '\n'.
+    @param      buf: destination buffer (at least @ref RIDESTATS_SUMMARY_LEN bytes)
+    @param      size: size of the buffer, terminator included
+    @param      name: name of the GPX file
+    @param      start: start time in ISO 8601
+    @return     number of characters written, 0 if the buffer is too small
+*/
+size_t rideStatsFormatSummary(char* buf, size_t size, const char* name, const char* start){
+    if(buf == NULL || size == 0){
+        return 0;
+    }
+    char field[16];
+    char* end = buf + size - 1;
+    char* p = buf;
+    float maxTemp = rideStatsGetMaxTemperature();
+
+    p = statsPutField(p, end, name, ',');
+    p = statsPutField(p, end, start, ',');
+    numFormatInt(field, sizeof(field), (int32_t)(statsTotals.elapsedMs / 1000), 1);
+    p = statsPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), (int32_t)(statsTotals.movingMs / 1000), 1);
+    p = statsPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), statsTotals.distance, 1);
+    p = statsPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), rideStatsAverageSpeed(&statsTotals), 2);
+    p = statsPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), statsTotals.maxSpeed, 2);
+    p = statsPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), statsTotals.ascent, 1);
+    p = statsPutField(p, end, field, ',');
+    numFormatFloat(field, sizeof(field), statsTotals.descent, 1);
+    p = statsPutField(p, end, field, ',');
+    if(isnan(maxTemp)){
+        field[0] = '\0';
+    }else{
+        numFormatFloat(field, sizeof(field), maxTemp, 1);
+    }
+    p = statsPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), (int32_t)(rideStatsCalories(&statsTotals) + 0.5f), 1);
+    p = statsPutField(p, end, field, ',');
+    numFormatInt(field, sizeof(field), statsLapCount, 1);
+    p = statsPutField(p, end, field, '\n');
+    if(p == NULL){
+        buf[0] = '\0';
+        return 0;
+    }
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+/*! @} */ // RideStats_Module
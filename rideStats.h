@@ -0,0 +1,85 @@
+/*!
+    @file       rideStats.h
+    @ingroup    RideStats_Module
+    @brief      Streaming statistics of the ride
+    @details    Accumulators updated in constant time at every epoch of the wheel sensor and of the
+                GPS: elapsed and moving time with auto-pause, distance, average and max speed,
+                ascent and descent, max temperature and an estimate of the calories.
+                The distance and the speed come from the wheel while it turns, from the GPS fixes
+                when the wheel sensor is silent for more than @ref RIDESTATS_WHEEL_TIMEOUT_MS (no
+                sensor or sensor lost). The elevation comes from the GPS only, filtered by the
+                Elevation module: a change is counted when it exceeds @ref RIDESTATS_ELEVATION_DEADBAND
+                from the last counted altitude, so the residual noise does not add up to a climb.
+                The calories are the mechanical work of a rolling resistance, aerodynamic drag and
+                climbing model: with a gross efficiency of about 24%, 1 kJ of work is about 1 kcal
+                burned.
+                The module does not depend on the hardware: Test/rideStats.py computes the same
+                statistics from a GPX file as reference.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __RIDE_STATS_H__
+#define __RIDE_STATS_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    @defgroup   RideStats_Module Ride Statistics
+    @name       Ride Statistics Module
+    @{
+*/
+
+#define RIDESTATS_MOVING_SPEED          3.0f        //!< Auto-pause below this speed [km/h]
+#ifndef RIDESTATS_MAX_GAP_MS
+#define RIDESTATS_MAX_GAP_MS            15000u      //!< Longer gaps between epochs are pauses
+#endif
+#define RIDESTATS_WHEEL_TIMEOUT_MS      3000u       //!< Wheel silent for longer: speed from the GPS
+#define RIDESTATS_ELEVATION_DEADBAND    5.0f        //!< Smallest counted elevation change [m]
+#define RIDESTATS_MAX_LAPS              16
+
+//Energy model
+#define RIDESTATS_MASS                  85.0f       //!< Rider and bike [kg]
+#define RIDESTATS_CRR                   0.005f      //!< Rolling resistance coefficient
+#define RIDESTATS_CDA                   0.5f        //!< Drag area [m^2]
+#define RIDESTATS_AIR_DENSITY           1.2f        //!< [kg/m^3]
+#define RIDESTATS_GRAVITY               9.81f
+
+#define RIDESTATS_INDEX_FILE            "RIDES.CSV" //!< Summaries of the rides, one line per ride
+#define RIDESTATS_INDEX_HEADER          "name,start,elapsed_s,moving_s,distance_m,avg_kmh,max_kmh,ascent_m,descent_m,max_temp_c,kcal,laps\n"
+#define RIDESTATS_SUMMARY_LEN           128         //!< Buffer size for a line of the index
+
+//! Totals of the ride or of a lap
+typedef struct{
+    uint32_t elapsedMs;
+    uint32_t movingMs;
+    float distance;                         //!< [m]
+    float maxSpeed;                         //!< [km/h]
+    float ascent;                           //!< [m]
+    float descent;                          //!< [m]
+    float work;                             //!< Mechanical work [J]
+} RideTotals_t;
+
+void rideStatsStart(uint32_t nowMs);
+void rideStatsStop(uint32_t nowMs);
+bool rideStatsIsRunning(void);
+void rideStatsAddSpeed(uint32_t nowMs, float speed, float distanceKm);
+void rideStatsAddFix(uint32_t nowMs, float latitude, float longitude, float altitude);
+void rideStatsAddTemperature(float temp);
+bool rideStatsLap(uint32_t nowMs);
+
+void rideStatsGetTotals(RideTotals_t* totals);
+bool rideStatsGetLap(uint8_t lap, RideTotals_t* totals);
+uint8_t rideStatsGetLapCount(void);
+float rideStatsGetMaxTemperature(void);
+float rideStatsAverageSpeed(const RideTotals_t* totals);
+float rideStatsCalories(const RideTotals_t* totals);
+
+size_t rideStatsFormatSummary(char* buf, size_t size, const char* name, const char* start);
+
+/*! @} */ //End of RideStats_Module
+
+#endif // __RIDE_STATS_H__
@@ -0,0 +1,312 @@
+/*!
+    @file       rtc.c
+    @ingroup    Rtc_Module
+    @brief      Real time clock disciplined by the GPS implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef SIMULATE_HARDWARE
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/* Local Includes */
+#include <fatfs/ff.h>
+#include "rtc.h"
+#include "numFormat.h"
+
+/*!
+    @addtogroup Rtc_Module
+    @{
+*/
+
+#define RTC_TICKS_BITS      15                      //!< The prescalers count 32768 ticks per second
+#define RTC_TICKS_MASK      ((1UL << RTC_TICKS_BITS) - 1)
+#define RTC_EPOCH_DAYS      719468UL                //!< Days from 0000-03-01 to 1970-01-01
+
+//! Last converted date: a conversion of the same day only computes the time of day
+typedef struct{
+    uint32_t day;                           //!< Days since 1970-01-01
+    uint16_t year;
+    uint8_t mon;                            //!< 1-12
+    uint8_t mday;
+    uint8_t wday;
+    uint16_t yday;
+} RtcDayCache_t;
+
+static RtcDayCache_t rtcDay = {0, 1970, 1, 1, 4, 0};
+static bool rtcSynced = false;
+static int32_t rtcLastCorrection;           //!< Step of the last synchronization [ms]
+
+/*!
+    @brief      Days since 1970-01-01 of a date of the Gregorian calendar
+    @param      year: year, 1970 or later
+    @param      mon: month, 1-12
+    @param      mday: day of the month, 1-31
+*/
+static uint32_t rtcDaysFromCivil(uint32_t year, uint32_t mon, uint32_t mday){
+    year -= mon <= 2;
+    uint32_t era = year / 400;
+    uint32_t yoe = year - era * 400;
+    uint32_t doy = (153 * (mon > 2 ? mon - 3 : mon + 9) + 2) / 5 + mday - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - RTC_EPOCH_DAYS;
+}
+
+/*!
+    @brief      Load the date of a day in the cache
+    @param      day: days since 1970-01-01
+*/
+static void rtcLoadDay(uint32_t day){
+    uint32_t z = day + RTC_EPOCH_DAYS;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t mon = mp < 10 ? mp + 3 : mp - 9;
+    uint32_t year = yoe + era * 400 + (mon <= 2);
+
+    rtcDay.day = day;
+    rtcDay.year = (uint16_t)year;
+    rtcDay.mon = (uint8_t)mon;
+    rtcDay.mday = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    rtcDay.wday = (uint8_t)((day + 4) % 7);                 //1970-01-01 was a Thursday
+    rtcDay.yday = (uint16_t)(day - rtcDaysFromCivil(year, 1, 1));
+}
+
+/*!
+    @brief      Convert a broken down UTC time to seconds since 1970
+    @param      timeInfo: broken down time, as filled by getDateFromString
+    @return     seconds since 1970-01-01 00:00:00 UTC, 0 if the date is before 1970
+*/
+RtcTime_t rtcFromCalendar(const struct tm* timeInfo){
+    uint32_t year = (uint32_t)(timeInfo->tm_year + 1900);
+    uint32_t mon = (uint32_t)(timeInfo->tm_mon + 1);
+    uint32_t mday = (uint32_t)timeInfo->tm_mday;
+    if(timeInfo->tm_year < 70 || mon < 1 || mon > 12 || mday < 1 || mday > 31){
+        return 0;
+    }
+    uint32_t day;
+    if(year == rtcDay.year && mon == rtcDay.mon && mday == rtcDay.mday){
+        day = rtcDay.day;
+    }else{
+        day = rtcDaysFromCivil(year, mon, mday);
+    }
+    return day * RTC_SECONDS_PER_DAY + (uint32_t)timeInfo->tm_hour * 3600 +
+           (uint32_t)timeInfo->tm_min * 60 + (uint32_t)timeInfo->tm_sec;
+}
+
+/*!
+    @brief      Convert seconds since 1970 to a broken down UTC time
+    @details    The date is computed only when the day changes from the previous call.
+    @param      time: seconds since 1970-01-01 00:00:00 UTC
+    @param      timeInfo: broken down time
+*/
+void rtcToCalendar(RtcTime_t time, struct tm* timeInfo){
+    uint32_t day = time / RTC_SECONDS_PER_DAY;
+    uint32_t seconds = time % RTC_SECONDS_PER_DAY;
+    if(day != rtcDay.day){
+        rtcLoadDay(day);
+    }
+    timeInfo->tm_year = rtcDay.year - 1900;
+    timeInfo->tm_mon = rtcDay.mon - 1;
+    timeInfo->tm_mday = rtcDay.mday;
+    timeInfo->tm_wday = rtcDay.wday;
+    timeInfo->tm_yday = rtcDay.yday;
+    timeInfo->tm_hour = (int)(seconds / 3600);
+    timeInfo->tm_min = (int)(seconds / 60 % 60);
+    timeInfo->tm_sec = (int)(seconds % 60);
+    timeInfo->tm_isdst = 0;
+}
+
+/*!
+    @brief      Format a time as an ISO 8601 UTC timestamp
+    @param      buf: destination buffer (at least @ref NUMFORMAT_ISO8601_MS_LEN bytes)
+    @param      size: size of the buffer, terminator included
+    @param      time: seconds since 1970-01-01 00:00:00 UTC
+    @param      ms: milliseconds, printed only if not 0
+    @return     number of characters written, 0 if the buffer is too small
+*/
+size_t rtcFormatISO8601(char* buf, size_t size, RtcTime_t time, uint16_t ms){
+    struct tm timeInfo;
+    rtcToCalendar(time, &timeInfo);
+    return numFormatISO8601Ms(buf, size, &timeInfo, ms);
+}
+
+/*!
+    @brief      True after the first synchronization with the GPS
+*/
+bool rtcIsSynced(void){
+    return rtcSynced;
+}
+
+/*!
+    @brief      Step applied by the last synchronization
+    @return     GPS time minus clock time before the synchronization [ms], 0 at the first one
+*/
+int32_t rtcGetLastCorrection(void){
+    return rtcLastCorrection;
+}
+
+#ifndef SIMULATE_HARDWARE
+
+static volatile uint32_t rtcSeconds;        //!< Seconds counted by the RTC_C interrupt
+static uint16_t rtcPhase;                   //!< Ticks added to the prescalers by the synchronization
+
+/*!
+    @brief      Ticks of the running second from the RTC_C prescalers
+    @details    RT0PS counts the 32768 Hz clock and RT1PS its overflows at 128 Hz: the 7 low bits of
+                RT1PS and RT0PS are the ticks since the last increment of the seconds.
+*/
+static uint16_t rtcReadPrescalers(void){
+    uint8_t ps1, ps0;
+    do{
+        ps1 = MAP_RTC_C_getPrescaleValue(RTC_C_PRESCALE_1);
+        ps0 = MAP_RTC_C_getPrescaleValue(RTC_C_PRESCALE_0);
+    }while(ps1 != MAP_RTC_C_getPrescaleValue(RTC_C_PRESCALE_1));
+    return (uint16_t)((ps1 & 0x7F) << 8 | ps0);
+}
+
+/*!
+    @brief      Clock in ticks of 1/32768 s, without the phase
+    @details    A new second not yet counted by the interrupt is counted here and its flag cleared.
+    @note       To be called with the interrupts disabled
+*/
+static uint64_t rtcReadTicks(void){
+    uint16_t ticks = rtcReadPrescalers();
+    if((MAP_RTC_C_getInterruptStatus() & RTC_C_CLOCK_READ_READY_INTERRUPT) && ticks < (1U << (RTC_TICKS_BITS - 1))){
+        MAP_RTC_C_clearInterruptFlag(RTC_C_CLOCK_READ_READY_INTERRUPT);
+        rtcSeconds++;
+    }
+    return ((uint64_t)rtcSeconds << RTC_TICKS_BITS) + ticks;
+}
+
+/*!
+    @brief      Start the RTC_C module
+    @details    The calendar of the RTC_C is not used, it only counts the seconds: the read ready
+                interrupt, once per second, increments the software counter.
+*/
+void rtcInit(void){
+    const RTC_C_Calendar calendar = {0, 0, 0, 4, 1, 1, 1970};
+    MAP_RTC_C_initCalendar(&calendar, RTC_C_FORMAT_BINARY);
+    MAP_RTC_C_clearInterruptFlag(RTC_C_CLOCK_READ_READY_INTERRUPT);
+    MAP_RTC_C_enableInterrupt(RTC_C_CLOCK_READ_READY_INTERRUPT);
+    MAP_RTC_C_startClock();
+    MAP_Interrupt_enableInterrupt(INT_RTC_C);
+}
+
+/*!
+    @brief      Set the clock to the GPS time
+    @details    The seconds are stepped and the fraction is kept as a phase on the prescalers, so
+                the RTC_C is never stopped.
+    @param      timeInfo: UTC date and time of a valid RMC sentence
+    @param      ms: milliseconds of the RMC time
+*/
+void rtcSync(const struct tm* timeInfo, uint16_t ms){
+    if(timeInfo->tm_year + 1900 < RTC_MIN_VALID_YEAR){
+        return;
+    }
+    uint64_t target = ((uint64_t)rtcFromCalendar(timeInfo) << RTC_TICKS_BITS) +
+                      (((uint32_t)ms << RTC_TICKS_BITS) + 500) / 1000;
+
+    bool wasDisabled = MAP_Interrupt_disableMaster();
+    uint64_t ticks = rtcReadTicks();
+    int64_t correction = (int64_t)(target - (ticks + rtcPhase));
+    int64_t diff = (int64_t)(target - ticks);
+    rtcSeconds += (int32_t)(diff >> RTC_TICKS_BITS);                //Floor, also for negative steps
+    rtcPhase = (uint16_t)(diff & RTC_TICKS_MASK);
+    if(!wasDisabled){
+        MAP_Interrupt_enableMaster();
+    }
+
+    rtcLastCorrection = rtcSynced ? (int32_t)(correction * 1000 / (1 << RTC_TICKS_BITS)) : 0;
+    rtcSynced = true;
+}
+
+/*!
+    @brief      Current time
+    @param      ms: milliseconds of the current second, can be NULL
+    @return     seconds since 1970-01-01 00:00:00 UTC
+*/
+RtcTime_t rtcNow(uint16_t* ms){
+    bool wasDisabled = MAP_Interrupt_disableMaster();
+    uint64_t ticks = rtcReadTicks() + rtcPhase;
+    if(!wasDisabled){
+        MAP_Interrupt_enableMaster();
+    }
+    if(ms != NULL){
+        *ms = (uint16_t)(((ticks & RTC_TICKS_MASK) * 1000) >> RTC_TICKS_BITS);
+    }
+    return (RtcTime_t)(ticks >> RTC_TICKS_BITS);
+}
+
+/*!
+    @brief      RTC_C interrupt handler: one more second
+*/
+void RTC_C_IRQHandler(void){
+    uint_fast8_t status = MAP_RTC_C_getEnabledInterruptStatus();
+    MAP_RTC_C_clearInterruptFlag(status);
+    if(status & RTC_C_CLOCK_READ_READY_INTERRUPT){
+        rtcSeconds++;
+    }
+}
+
+#else
+
+static int64_t rtcHostOffset;               //!< GPS time minus host time [ms]
+
+static int64_t rtcHostMs(void){
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void rtcInit(void){
+    rtcHostOffset = 0;
+}
+
+void rtcSync(const struct tm* timeInfo, uint16_t ms){
+    if(timeInfo->tm_year + 1900 < RTC_MIN_VALID_YEAR){
+        return;
+    }
+    int64_t target = (int64_t)rtcFromCalendar(timeInfo) * 1000 + ms;
+    int64_t offset = target - rtcHostMs();
+    rtcLastCorrection = rtcSynced ? (int32_t)(offset - rtcHostOffset) : 0;
+    rtcHostOffset = offset;
+    rtcSynced = true;
+}
+
+RtcTime_t rtcNow(uint16_t* ms){
+    int64_t now = rtcHostMs() + rtcHostOffset;
+    if(ms != NULL){
+        *ms = (uint16_t)(now % 1000);
+    }
+    return (RtcTime_t)(now / 1000);
+}
+
+#endif
+
+/*!
+    @brief      Timestamp of the files written by FatFs
+    @details    UTC time of the clock, the FatFs default date until the first synchronization.
+    @return     FAT date and time: year since 1980, month, day, hours, minutes, seconds / 2
+*/
+DWORD get_fattime(void){
+    if(!rtcSynced){
+        return (DWORD)(FF_NORTC_YEAR - 1980) << 25 | (DWORD)FF_NORTC_MON << 21 | (DWORD)FF_NORTC_MDAY << 16;
+    }
+    struct tm timeInfo;
+    rtcToCalendar(rtcNow(NULL), &timeInfo);
+    return (DWORD)(timeInfo.tm_year - 80) << 25 | (DWORD)(timeInfo.tm_mon + 1) << 21 | (DWORD)timeInfo.tm_mday << 16 |
+           (DWORD)timeInfo.tm_hour << 11 | (DWORD)timeInfo.tm_min << 5 | (DWORD)timeInfo.tm_sec >> 1;
+}
+
+/*! @} */ // Rtc_Module
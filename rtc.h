@@ -0,0 +1,50 @@
+/*!
+    @file       rtc.h
+    @ingroup    Rtc_Module
+    @brief      Real time clock disciplined by the GPS
+    @details    Software clock counting the UTC seconds since 1970-01-01. Between the fixes it runs on
+                the RTC_C module, clocked by the 32768 Hz crystal also in the low power modes: the
+                RTC_C interrupt counts the seconds and the prescalers give the fraction of second.
+                Every valid RMC sentence sets the clock to the GPS time (@ref rtcSync).
+                The calendar conversions use the day number of the last converted date, so inside the
+                same day only the time of day is computed and mktime/gmtime are never called.
+                The clock feeds the timestamps of the files on the SD card (get_fattime) and the
+                metadata of the GPX files.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __RTC_H__
+#define __RTC_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/*!
+    @defgroup   Rtc_Module RTC
+    @name       RTC Module
+    @{
+*/
+
+#define RTC_SECONDS_PER_DAY     86400UL
+#define RTC_MIN_VALID_YEAR      2020        //!< Older GPS dates are not accepted (receiver without almanac)
+
+//! Seconds since 1970-01-01 00:00:00 UTC
+typedef uint32_t RtcTime_t;
+
+void rtcInit(void);
+void rtcSync(const struct tm* timeInfo, uint16_t ms);
+bool rtcIsSynced(void);
+RtcTime_t rtcNow(uint16_t* ms);
+int32_t rtcGetLastCorrection(void);
+
+RtcTime_t rtcFromCalendar(const struct tm* timeInfo);
+void rtcToCalendar(RtcTime_t time, struct tm* timeInfo);
+size_t rtcFormatISO8601(char* buf, size_t size, RtcTime_t time, uint16_t ms);
+
+/*! @} */ //End of Rtc_Module
+
+#endif // __RTC_H__
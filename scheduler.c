@@ -0,0 +1,329 @@
+/*!
+    @file       scheduler.c
+    @ingroup    Scheduler_Module
+    @brief      Cooperative event-driven scheduler implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef SIMULATE_HARDWARE
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#else
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Local Includes */
+#include "scheduler.h"
+
+/*!
+    @addtogroup Scheduler_Module
+    @{
+*/
+
+//! Per task bookkeeping, times in timer ticks
+typedef struct{
+    uint32_t runs;
+    uint32_t deadlineMisses;
+    uint32_t maxLatency;
+    uint32_t maxRun;
+    uint64_t totalRun;
+} SchedTaskData_t;
+
+static const SchedTask_t* schedTasks;                   //!< Task table, sorted by priority
+static uint8_t schedNumTasks;                           //!< Number of tasks in the table
+static SchedTaskData_t schedData[SCHED_MAX_TASKS];      //!< Statistics of the tasks
+
+static volatile SchedEvents_t schedPending;             //!< Events posted and not yet consumed
+static volatile uint32_t schedPostTime[32];             //!< Time of the first post of every pending event
+
+static uint32_t schedLastUpdate;                        //!< Last time the elapsed time was updated
+static uint64_t schedElapsed;                           //!< Elapsed ticks since the last reset
+static uint64_t schedSleep;                             //!< Ticks spent in LPM0 since the last reset
+static uint32_t schedWakeups;                           //!< Wakeups since the last reset
+static uint64_t schedTotalUs;                           //!< Elapsed time before the last reset, since the init
+static uint64_t schedTotalSleepUs;                      //!< Time in LPM0 before the last reset, since the init
+static uint32_t schedTicksPerMs = SCHED_TICKS_PER_US * 1000u;   //!< Time base ticks per millisecond, see schedSetClockDivider
+
+/* ------------------------------------------------------------------------------------------------
+    Hardware dependent part
+   ------------------------------------------------------------------------------------------------ */
+#ifndef SIMULATE_HARDWARE
+
+/*!
+    @brief    Start the time base of the scheduler
+    @details  Timer32 module 0 is used free running at MCLK/16, without interrupts, so it does not
+              wake the CPU and keeps counting in LPM0.
+*/
+static void schedPortInit(void){
+    MAP_Timer32_initModule(TIMER32_0_BASE, TIMER32_PRESCALER_16, TIMER32_32BIT, TIMER32_FREE_RUN_MODE);
+    MAP_Timer32_startTimer(TIMER32_0_BASE, false);
+    //Wakeups are handled by the scheduler, not by the sleep on exit
+    MAP_Interrupt_disableSleepOnIsrExit();
+}
+
+/*!
+    @brief    Read the time base
+    @return   current time in ticks (Timer32 counts down)
+*/
+static inline uint32_t schedNow(void){
+    return ~MAP_Timer32_getValue(TIMER32_0_BASE);
+}
+
+#define SCHED_ENTER_CRITICAL()  bool wasDisabled = MAP_Interrupt_disableMaster()
+#define SCHED_EXIT_CRITICAL()   if(!wasDisabled){ MAP_Interrupt_enableMaster(); }
+
+/*!
+    @brief    Go to LPM0 if no event is pending
+    @details  The pending events are checked with the interrupts disabled, so an event posted
+              between the check and the WFI still wakes up the CPU.
+*/
+static void schedIdle(void){
+    SCHED_ENTER_CRITICAL();
+    if(schedPending == 0){
+        uint32_t start = schedNow();
+        MAP_PCM_gotoLPM0InterruptSafe();
+        schedSleep += schedNow() - start;
+        schedWakeups++;
+    }
+    SCHED_EXIT_CRITICAL();
+}
+
+#else
+
+static void schedPortInit(void){
+}
+
+static inline uint32_t schedNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+//On the host the events are posted by the same thread
+#define SCHED_ENTER_CRITICAL()
+#define SCHED_EXIT_CRITICAL()
+
+static void (*schedIdleHook)(void);                    //!< Interrupts of the simulator, see schedSetIdleHook
+
+/*!
+    @brief    Set the function called at the end of every pause of the host
+    @details  It plays the interrupts that would wake the CPU from LPM0: it can post events. The
+              time spent in it is active time.
+    @param    hook: function to call, NULL for none
+*/
+void schedSetIdleHook(void (*hook)(void)){
+    schedIdleHook = hook;
+}
+
+static void schedIdle(void){
+    if(schedPending == 0){
+        uint32_t start = schedNow();
+        struct timespec pause = {0, SCHED_SIM_IDLE_US * 1000L};
+        nanosleep(&pause, NULL);
+        schedSleep += schedNow() - start;
+        schedWakeups++;
+        if(schedIdleHook != NULL){
+            schedIdleHook();
+        }
+    }
+}
+
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+    Core
+   ------------------------------------------------------------------------------------------------ */
+
+/*!
+    @brief    Update the elapsed time
+    @details  Called often enough to never miss a wrap of the 32 bit time base.
+*/
+static void schedUpdateElapsed(void){
+    uint32_t now = schedNow();
+    schedElapsed += now - schedLastUpdate;
+    schedLastUpdate = now;
+}
+
+/*!
+    @brief    Initialize the scheduler
+    @param    tasks: task table sorted by priority, must stay valid while the scheduler runs
+    @param    numTasks: number of tasks (max @ref SCHED_MAX_TASKS)
+*/
+void schedInit(const SchedTask_t* tasks, uint8_t numTasks){
+    schedPortInit();
+    schedTasks = tasks;
+    schedNumTasks = numTasks > SCHED_MAX_TASKS ? SCHED_MAX_TASKS : numTasks;
+    schedPending = 0;
+    schedResetStats();
+}
+
+/*!
+    @brief    Post one or more events
+    @details  Can be called from ISRs and from tasks. The time of the first post of an event is kept
+              until the event is consumed, so the latency includes all the repeated posts.
+    @param    events: events to post
+*/
+void schedPostEvent(SchedEvents_t events){
+    SCHED_ENTER_CRITICAL();
+    SchedEvents_t newEvents = events & ~schedPending;
+    if(newEvents != 0){
+        uint32_t now = schedNow();
+        for(uint8_t i = 0; newEvents != 0; ++i, newEvents >>= 1){
+            if(newEvents & 1){
+                schedPostTime[i] = now;
+            }
+        }
+        schedPending |= events;
+    }
+    SCHED_EXIT_CRITICAL();
+}
+
+/*!
+    @brief    Run the highest priority ready task
+    @return   true if a task has been run, false if no task was ready
+*/
+bool schedRunOnce(void){
+    for(uint8_t t = 0; t < schedNumTasks; ++t){
+        const SchedTask_t* task = &schedTasks[t];
+        if((schedPending & task->events) == 0){
+            continue;
+        }
+
+        //Consume the events and compute the latency from the oldest post
+        SchedEvents_t events;
+        uint32_t start;
+        uint32_t latency = 0;
+        {
+            SCHED_ENTER_CRITICAL();
+            events = schedPending & task->events;
+            schedPending &= ~events;
+            start = schedNow();
+            SchedEvents_t e = events;
+            for(uint8_t i = 0; e != 0; ++i, e >>= 1){
+                if((e & 1) && start - schedPostTime[i] > latency){
+                    latency = start - schedPostTime[i];
+                }
+            }
+            SCHED_EXIT_CRITICAL();
+        }
+
+        task->function(events);
+
+        uint32_t run = schedNow() - start;
+        SchedTaskData_t* data = &schedData[t];
+        data->runs++;
+        data->totalRun += run;
+        if(run > data->maxRun){
+            data->maxRun = run;
+        }
+        if(latency > data->maxLatency){
+            data->maxLatency = latency;
+        }
+        if(task->deadlineUs != 0 && (uint64_t)latency * 1000u > (uint64_t)task->deadlineUs * schedTicksPerMs){
+            data->deadlineMisses++;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*!
+    @brief    Scheduler main loop
+    @details  Runs the ready tasks by priority and sleeps when there is nothing to do. After every
+              task the table is scanned again from the highest priority. Never returns.
+*/
+void schedRun(void){
+    while(1){
+        if(!schedRunOnce()){
+            schedIdle();
+        }
+        schedUpdateElapsed();
+    }
+}
+
+/*!
+    @brief    Get the statistics of a task
+    @param    task: index of the task in the table
+    @param    stats: filled with the statistics, times converted in microseconds/milliseconds
+    @return   false if the task does not exist
+*/
+bool schedGetTaskStats(uint8_t task, SchedTaskStats_t* stats){
+    if(task >= schedNumTasks || stats == NULL){
+        return false;
+    }
+    const SchedTaskData_t* data = &schedData[task];
+    stats->name = schedTasks[task].name;
+    stats->runs = data->runs;
+    stats->deadlineMisses = data->deadlineMisses;
+    stats->maxLatencyUs = (uint32_t)(((uint64_t)data->maxLatency * 1000u) / schedTicksPerMs);
+    stats->maxRunUs = (uint32_t)(((uint64_t)data->maxRun * 1000u) / schedTicksPerMs);
+    stats->totalRunMs = (uint32_t)(data->totalRun / schedTicksPerMs);
+    return true;
+}
+
+/*!
+    @brief    Get the global statistics of the scheduler
+    @param    stats: filled with the statistics
+*/
+void schedGetStats(SchedStats_t* stats){
+    if(stats == NULL){
+        return;
+    }
+    schedUpdateElapsed();
+    stats->elapsedMs = (uint32_t)(schedElapsed / schedTicksPerMs);
+    stats->sleepMs = (uint32_t)(schedSleep / schedTicksPerMs);
+    stats->wakeups = schedWakeups;
+    stats->sleepPermille = schedElapsed != 0 ? (uint16_t)((schedSleep * 1000u) / schedElapsed) : 0;
+}
+
+/*!
+    @brief    Reset the task and global statistics
+*/
+void schedResetStats(void){
+    //The totals keep the time of the statistics cleared, at the rate it was counted
+    schedTotalUs += schedElapsed * 1000u / schedTicksPerMs;
+    schedTotalSleepUs += schedSleep * 1000u / schedTicksPerMs;
+    memset(schedData, 0, sizeof(schedData));
+    schedLastUpdate = schedNow();
+    schedElapsed = 0;
+    schedSleep = 0;
+    schedWakeups = 0;
+}
+
+/*!
+    @brief    Get the elapsed time and the time in LPM0 since the init
+    @details  Not cleared by @ref schedResetStats nor by a change of the clock, for the energy
+              accounting: the differences between two calls are the active and sleep times.
+    @param    elapsedUs: filled with the elapsed time [us]
+    @param    sleepUs: filled with the time in LPM0 [us]
+*/
+void schedGetTotals(uint64_t* elapsedUs, uint64_t* sleepUs){
+    schedUpdateElapsed();
+    *elapsedUs = schedTotalUs + schedElapsed * 1000u / schedTicksPerMs;
+    *sleepUs = schedTotalSleepUs + schedSleep * 1000u / schedTicksPerMs;
+}
+
+/*!
+    @brief    New MCLK divider of the 48 MHz DCO
+    @details  The time base runs on MCLK: the conversions of the statistics follow the divider. The
+              statistics are reset, the old ticks would be converted with the new rate. On the host
+              the time base does not depend on the clock and only the statistics are reset.
+    @param    divider: MCLK = DCO / divider, 1, 2 or 4
+*/
+void schedSetClockDivider(uint8_t divider){
+    schedUpdateElapsed();
+    schedResetStats();
+#ifndef SIMULATE_HARDWARE
+    schedTicksPerMs = SCHED_TICKS_PER_US * 1000u / (divider != 0 ? divider : 1);
+#endif
+}
+
+/*! @} */ // Scheduler_Module
@@ -0,0 +1,103 @@
+/*!
+    @file       scheduler.h
+    @ingroup    Scheduler_Module
+    @brief      Cooperative event-driven scheduler
+    @details    Run-to-completion scheduler that replaces the polling super-loop of main().
+                The ISRs only post events in a bitmap with @ref schedPostEvent, the main loop runs the
+                highest priority task that has pending events and puts the CPU in LPM0 when nothing is
+                ready. For every task the scheduler tracks the latency from the first post of an event
+                to the start of the task, the run time and the deadline misses; globally it tracks the
+                time spent sleeping.
+                The core does not depend on the hardware: with SIMULATE_HARDWARE the time is read from
+                the host clock and the sleep is replaced by a short pause, so it can run on a PC.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Scheduler_Module Scheduler
+    @name       Scheduler Module
+    @{
+*/
+
+#define SCHED_MAX_TASKS         16          //!< Max number of tasks in the table
+
+#ifndef SIMULATE_HARDWARE
+    #define SCHED_TICKS_PER_US  3           //!< Timer32 ticks per microsecond (MCLK 48 MHz / 16), see schedSetClockDivider
+#else
+    #define SCHED_TICKS_PER_US  1           //!< Host clock ticks per microsecond
+    #define SCHED_SIM_IDLE_US   1000        //!< Pause used on the host instead of LPM0
+#endif
+
+//Application events, every event must be handled by a single task
+#define SCHED_EVENT_BSS         (1u << 0)   //!< BSS flashing software timer tick
+#define SCHED_EVENT_BUTTON      (1u << 1)   //!< Start or stop button pressed
+#define SCHED_EVENT_SPEED       (1u << 2)   //!< Wheel round captured (TA0 CCR2)
+#define SCHED_EVENT_GPS         (1u << 3)   //!< GPS DMA buffer full
+#define SCHED_EVENT_LOG         (1u << 4)   //!< New GPS data to save in the GPX file
+#define SCHED_EVENT_LIGHT       (1u << 5)   //!< Photoresistor samples ready
+#define SCHED_EVENT_TEMP        (1u << 6)   //!< Temperature sample ready
+#define SCHED_EVENT_UI          (1u << 7)   //!< LCD refresh requested
+#define SCHED_EVENT_TELEM       (1u << 8)   //!< Telemetry tick
+#define SCHED_EVENT_SYNC        (1u << 9)   //!< Sync command received or packet sent
+#define SCHED_EVENT_POWER       (1u << 10)  //!< Power governor tick
+#define SCHED_EVENT_CONSOLE     (1u << 11)  //!< Command received on the PC UART
+
+typedef uint32_t SchedEvents_t;                             //!< Event bitmap
+typedef void (*SchedTaskFunction_t)(SchedEvents_t events);  //!< Task function, receives the consumed events
+
+/*!
+    @brief  Task descriptor
+    @details The position in the table passed to @ref schedInit is the priority: index 0 is the
+             highest priority task.
+*/
+typedef struct{
+    const char* name;                       //!< Name used in the reports
+    SchedEvents_t events;                   //!< Events that make the task ready
+    SchedTaskFunction_t function;           //!< Function to run
+    uint32_t deadlineUs;                    //!< Max latency from the post to the start, 0 for none
+} SchedTask_t;
+
+//! Statistics of a single task
+typedef struct{
+    const char* name;                       //!< Name of the task
+    uint32_t runs;                          //!< Number of executions
+    uint32_t deadlineMisses;                //!< Executions started after the deadline
+    uint32_t maxLatencyUs;                  //!< Worst latency from the post to the start
+    uint32_t maxRunUs;                      //!< Worst execution time
+    uint32_t totalRunMs;                    //!< Total execution time
+} SchedTaskStats_t;
+
+//! Global statistics of the scheduler
+typedef struct{
+    uint32_t elapsedMs;                     //!< Time since the last reset of the statistics
+    uint32_t sleepMs;                       //!< Time spent in LPM0
+    uint32_t wakeups;                       //!< Number of wakeups from LPM0
+    uint16_t sleepPermille;                 //!< Time spent in LPM0 over the elapsed time, in permille
+} SchedStats_t;
+
+void schedInit(const SchedTask_t* tasks, uint8_t numTasks);
+void schedPostEvent(SchedEvents_t events);
+bool schedRunOnce(void);
+void schedRun(void);
+
+bool schedGetTaskStats(uint8_t task, SchedTaskStats_t* stats);
+void schedGetStats(SchedStats_t* stats);
+void schedResetStats(void);
+void schedGetTotals(uint64_t* elapsedUs, uint64_t* sleepUs);
+void schedSetClockDivider(uint8_t divider);
+
+#ifdef SIMULATE_HARDWARE
+void schedSetIdleHook(void (*hook)(void));
+#endif
+
+/*! @} */ //End of Scheduler_Module
+
+#endif // __SCHEDULER_H__
@@ -6,6 +6,8 @@
 */
 
 #include "speed.h"
+#include "scheduler.h"
+#include "profiler.h"
 
 /* DriverLib Includes */
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
@@ -61,6 +63,13 @@ void resetRoundsCounter(){
     roundsCounter = 0;
 }
 
+/*!
+    @brief    Get the number of rounds of the wheel since the last reset.
+*/
+uint32_t getRoundsCounter(){
+    return roundsCounter;
+}
+
 /*!
     @brief    Computes speed using captured value from sensor.
     @param    capturedValue: number of timer ticks saved in capture register when interrupt is triggered.
@@ -108,11 +117,13 @@ void timerInit(const Timer_A_ContinuousModeConfig* continuousModeConfig,
 
 void TA0_N_IRQHandler(void)
 {
+    PROF_ENTER(PROF_ISR_TA0_N);
     uint32_t timer = TIMER_A0->IV;
 
     if(timer == 4){
 
         speedFlag = true;
+        schedPostEvent(SCHED_EVENT_SPEED);
         ++roundsCounter;
         timerAcapturedValue = MAP_Timer_A_getCaptureCompareCount(TIMER_A0_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_2);
         Timer_A_clearCaptureCompareInterrupt(TIMER_A0_BASE,TIMER_A_CAPTURECOMPARE_REGISTER_2);
@@ -125,6 +136,7 @@ void TA0_N_IRQHandler(void)
         Timer_A_clearInterruptFlag(TIMER_A0_BASE);
 
     }
+    PROF_EXIT(PROF_ISR_TA0_N);
 }
 
 ///}
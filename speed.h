@@ -29,6 +29,7 @@ void timerInit(const Timer_A_ContinuousModeConfig* continuousModeConfig,
 uint_fast16_t getTimerAcapturedValue();
 float distanceCovered();
 void resetRoundsCounter();
+uint32_t getRoundsCounter();
 /*
     @}
 */
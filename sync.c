@@ -0,0 +1,560 @@
+/*!
+    @file       sync.c
+    @ingroup    Sync_Module
+    @brief      Export of the stored rides implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef SIMULATE_HARDWARE
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/devices/msp432p4xx/driverlib/dma.h>
+
+/* Driver Includes */
+#include <Hardware/UART_Driver.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Local Includes */
+#include <fatfs/ff.h>
+#include "sync.h"
+#include "telemetry.h"
+#include "scheduler.h"
+
+/*!
+    @addtogroup Sync_Module
+    @{
+*/
+
+//! Packet buffer, owned by the task while free and by the DMA while ready
+typedef struct{
+    uint8_t data[SYNC_HEADER_LEN + SYNC_MAX_PAYLOAD + SYNC_CRC_LEN];
+    uint16_t len;                           //!< Length of the packet
+    volatile bool ready;                    //!< Waiting for the DMA or being sent
+} SyncTxBuffer_t;
+
+//! Running operation
+typedef enum{
+    SYNC_IDLE,
+    SYNC_LISTING,
+    SYNC_STREAMING,
+} SyncMode_t;
+
+//! Receiver states
+typedef enum{
+    SYNC_RX_SOF0,
+    SYNC_RX_SOF1,
+    SYNC_RX_TYPE,
+    SYNC_RX_LEN0,
+    SYNC_RX_LEN1,
+    SYNC_RX_PAYLOAD,
+    SYNC_RX_CRC0,
+    SYNC_RX_CRC1,
+} SyncRxState_t;
+
+//Two packet buffers: the task reads the SD card in one while the DMA sends the other
+static SyncTxBuffer_t syncTx[2];
+static uint8_t syncFillIndex;               //!< Next buffer filled by the task
+static volatile uint8_t syncSendIndex;      //!< Next buffer sent by the DMA
+static volatile bool syncDmaRunning;
+
+//Receiver, rxData holds type, len and payload for the CRC
+static SyncRxState_t syncRxState;
+static uint8_t syncRxData[3 + SYNC_MAX_CMD_PAYLOAD];
+static uint16_t syncRxLen;
+static uint16_t syncRxCount;
+static uint16_t syncRxCrc;
+
+static SyncMode_t syncMode;
+static bool syncBusy;                       //!< A ride is being recorded
+static FIL syncFile;                        //!< Ride being streamed
+static DIR syncDir;                         //!< Ride index being listed
+static uint16_t syncListCount;              //!< Rides listed so far
+static bool syncListEnd;                    //!< All the entries sent, LIST_END missing
+
+//Pending STATUS reply, sent before any other packet
+static bool syncStatusPending;
+static uint8_t syncStatusCmd;
+static uint8_t syncStatusResult;
+
+/* ------------------------------------------------------------------------------------------------
+    Hardware dependent part
+   ------------------------------------------------------------------------------------------------ */
+#ifndef SIMULATE_HARDWARE
+
+/*!
+    @brief    Send the next ready buffer, if the DMA is idle
+    @note     Called by the task with the interrupts disabled and by the DMA interrupt
+*/
+static void syncStartDma(void){
+    SyncTxBuffer_t* buffer = &syncTx[syncSendIndex];
+    if(syncDmaRunning || !buffer->ready){
+        return;
+    }
+    syncDmaRunning = true;
+    MAP_DMA_setChannelTransfer(DMA_CH6_EUSCIA3TX | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC,
+                               (void*) buffer->data,
+                               (void*) UART_getTransmitBufferAddressForDMA(SYNC_UART),
+                               buffer->len);
+    MAP_DMA_enableChannel(SYNC_DMA_CHANNEL);
+}
+
+/*!
+    @brief    Hand the filled buffers to the DMA
+*/
+static void syncPortSend(void){
+    bool wasDisabled = MAP_Interrupt_disableMaster();
+    syncStartDma();
+    if(!wasDisabled){
+        MAP_Interrupt_enableMaster();
+    }
+}
+
+/*!
+    @brief    Read the received bytes
+    @return   number of bytes copied in data
+*/
+static uint32_t syncPortRead(uint8_t* data, uint32_t size){
+    return UART_Read(SYNC_UART, data, size);
+}
+
+/*!
+    @brief    UART RX callback, wakes up the task
+*/
+static void syncRxCallback(void){
+    schedPostEvent(SCHED_EVENT_SYNC);
+}
+
+/*!
+    @brief    DMA and UART initialization
+    @details  The UART must be already initialized with UART_Init. The TX is served by the DMA
+              channel 6 in basic mode, triggered by TXIFG; the end of a packet raises DMA_INT2.
+*/
+static void syncPortInit(void){
+    MAP_DMA_assignChannel(DMA_CH6_EUSCIA3TX);
+    MAP_DMA_setChannelControl(DMA_CH6_EUSCIA3TX | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+    MAP_DMA_assignInterrupt(INT_DMA_INT2, SYNC_DMA_CHANNEL);
+    MAP_DMA_clearInterruptFlag(SYNC_DMA_CHANNEL);
+    MAP_Interrupt_enableInterrupt(INT_DMA_INT2);
+    MAP_DMA_enableInterrupt(INT_DMA_INT2);
+    UART_SetRxCallback(SYNC_UART, syncRxCallback);
+}
+
+/*!
+    @brief      DMA completion interrupt handler
+    @details    Frees the sent buffer, starts the next one and wakes up the task to fill the free one.
+*/
+void DMA_INT2_IRQHandler(void){
+    MAP_DMA_clearInterruptFlag(SYNC_DMA_CHANNEL);
+    syncTx[syncSendIndex].ready = false;
+    syncSendIndex ^= 1;
+    syncDmaRunning = false;
+    syncStartDma();
+    schedPostEvent(SCHED_EVENT_SYNC);
+}
+
+#else
+
+static int syncHostFd = -1;                 //!< Link of the simulator, e.g. a pseudo terminal
+
+/*!
+    @brief    Set the file descriptor of the link
+    @param    fd: descriptor used for both the commands and the replies, -1 to disconnect
+*/
+void syncSetHostFd(int fd){
+    syncHostFd = fd;
+}
+
+/*!
+    @brief    Write the ready buffers, the write stands for the DMA transfer
+*/
+static void syncPortSend(void){
+    while(syncTx[syncSendIndex].ready){
+        SyncTxBuffer_t* buffer = &syncTx[syncSendIndex];
+        uint16_t sent = 0;
+        while(syncHostFd >= 0 && sent < buffer->len){
+            ssize_t n = write(syncHostFd, buffer->data + sent, buffer->len - sent);
+            if(n < 0 && errno == EAGAIN){
+                continue;                           //Full link: wait as the DMA would
+            }
+            if(n <= 0){
+                break;
+            }
+            sent += (uint16_t)n;
+        }
+        buffer->ready = false;
+        syncSendIndex ^= 1;
+    }
+}
+
+static uint32_t syncPortRead(uint8_t* data, uint32_t size){
+    ssize_t n = syncHostFd >= 0 ? read(syncHostFd, data, size) : -1;
+    return n > 0 ? (uint32_t)n : 0;
+}
+
+static void syncPortInit(void){
+}
+
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+    Packets
+   ------------------------------------------------------------------------------------------------ */
+
+/*!
+    @brief    Get the buffer to fill
+    @return   the payload of the next free buffer, NULL if both buffers are in use
+*/
+static uint8_t* syncBeginPacket(void){
+    SyncTxBuffer_t* buffer = &syncTx[syncFillIndex];
+    return buffer->ready ? NULL : buffer->data + SYNC_HEADER_LEN;
+}
+
+/*!
+    @brief    Complete the header and the CRC of the buffer and queue it for the DMA
+    @param    type: packet type
+    @param    len: length of the payload already written
+*/
+static void syncEndPacket(SyncPacket_t type, uint16_t len){
+    SyncTxBuffer_t* buffer = &syncTx[syncFillIndex];
+    uint8_t* data = buffer->data;
+    uint16_t crc;
+
+    data[0] = SYNC_SOF0;
+    data[1] = SYNC_SOF1;
+    data[2] = (uint8_t)type;
+    data[3] = (uint8_t)len;
+    data[4] = (uint8_t)(len >> 8);
+    crc = telemCrc16(&data[2], 3 + len);
+    data[SYNC_HEADER_LEN + len] = (uint8_t)crc;
+    data[SYNC_HEADER_LEN + len + 1] = (uint8_t)(crc >> 8);
+    buffer->len = SYNC_HEADER_LEN + len + SYNC_CRC_LEN;
+    buffer->ready = true;
+    syncFillIndex ^= 1;
+}
+
+static void putU16(uint8_t* p, uint16_t v){
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t* p, uint32_t v){
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*!
+    @brief    Queue a STATUS reply
+*/
+static void syncStatus(uint8_t cmd, uint8_t result){
+    syncStatusPending = true;
+    syncStatusCmd = cmd;
+    syncStatusResult = result;
+}
+
+/*!
+    @brief    Close the running list or transfer
+*/
+static void syncStop(void){
+    if(syncMode == SYNC_STREAMING){
+        f_close(&syncFile);
+    }else if(syncMode == SYNC_LISTING){
+        f_closedir(&syncDir);
+    }
+    syncMode = SYNC_IDLE;
+}
+
+/*!
+    @brief    Check the extension of a ride
+    @param    name: 8.3 name, upper case as returned by FatFs without LFN
+*/
+static bool syncIsRide(const char* name){
+    const char* dot = strrchr(name, '.');
+    return dot != NULL && (strcmp(dot, ".GPX") == 0 || strcmp(dot, ".gpx") == 0);
+}
+
+/*!
+    @brief    Copy the name of a command payload
+    @return   false if the name is empty, too long or not a ride
+*/
+static bool syncGetName(const uint8_t* payload, uint16_t len, char* name){
+    uint16_t i;
+    for(i = 0; i < len && payload[i] != '\0'; ++i){
+        if(i >= SYNC_NAME_LEN - 1){
+            return false;
+        }
+        name[i] = (char)payload[i];
+    }
+    name[i] = '\0';
+    return i > 0 && syncIsRide(name);
+}
+
+/*!
+    @brief    Fill a packet of the ride index
+    @details  Sends up to @ref SYNC_LIST_MAX_ENTRIES rides per packet, then LIST_END.
+*/
+static void syncFillList(uint8_t* payload){
+    FILINFO info;
+    uint16_t entries = 0;
+    FRESULT r;
+
+    if(syncListEnd){
+        putU16(payload, syncListCount);
+        syncEndPacket(SYNC_REPLY_LIST_END, 2);
+        syncStop();
+        return;
+    }
+    while(entries < SYNC_LIST_MAX_ENTRIES){
+        r = f_readdir(&syncDir, &info);
+        if(r != FR_OK){
+            syncStop();
+            syncStatus(SYNC_CMD_LIST, (uint8_t)r);
+            return;
+        }
+        if(info.fname[0] == '\0'){
+            syncListEnd = true;
+            break;
+        }
+        if((info.fattrib & AM_DIR) || !syncIsRide(info.fname)){
+            continue;
+        }
+        uint8_t* entry = payload + entries * SYNC_LIST_ENTRY_LEN;
+        putU32(entry, (uint32_t)info.fsize);
+        putU16(entry + 4, info.fdate);
+        putU16(entry + 6, info.ftime);
+        memset(entry + 8, 0, SYNC_NAME_LEN);
+        strncpy((char*)entry + 8, info.fname, SYNC_NAME_LEN - 1);
+        entries++;
+    }
+    syncListCount += entries;
+    if(entries != 0){
+        syncEndPacket(SYNC_REPLY_LIST, entries * SYNC_LIST_ENTRY_LEN);
+    }else{
+        syncFillList(payload);                      //Nothing found in this pass: LIST_END
+    }
+}
+
+/*!
+    @brief    Fill a DATA packet of the streamed ride
+    @details  A chunk ends on a sector boundary, so after a resume from an unaligned offset only the
+              first chunk is short and the following ones are read by FatFs straight into the buffer.
+*/
+static void syncFillData(uint8_t* payload){
+    uint32_t offset = (uint32_t)f_tell(&syncFile);
+    UINT chunk = SYNC_CHUNK_SIZE - (offset % SYNC_CHUNK_SIZE);
+    UINT read;
+    FRESULT r;
+
+    r = f_read(&syncFile, payload + 4, chunk, &read);
+    if(r != FR_OK){
+        syncStop();
+        syncStatus(SYNC_CMD_GET, (uint8_t)r);
+        return;
+    }
+    if(read == 0){
+        putU32(payload, (uint32_t)f_size(&syncFile));
+        syncEndPacket(SYNC_REPLY_DATA_END, 4);
+        syncStop();
+        return;
+    }
+    putU32(payload, offset);
+    syncEndPacket(SYNC_REPLY_DATA, 4 + read);
+}
+
+/*!
+    @brief    Execute a received command
+*/
+static void syncExecute(uint8_t cmd, const uint8_t* payload, uint16_t len){
+    char name[SYNC_NAME_LEN];
+    FRESULT r;
+
+    switch(cmd){
+        case SYNC_CMD_LIST:
+        case SYNC_CMD_GET:
+        case SYNC_CMD_DELETE:
+            if(syncBusy){
+                syncStatus(cmd, SYNC_RESULT_BUSY);
+                return;
+            }
+            break;
+        case SYNC_CMD_ABORT:
+            syncStop();
+            syncStatus(cmd, FR_OK);
+            return;
+        default:
+            syncStatus(cmd, SYNC_RESULT_BAD_CMD);
+            return;
+    }
+
+    //A new command replaces the running one
+    syncStop();
+    if(cmd == SYNC_CMD_LIST){
+        r = f_opendir(&syncDir, "/");
+        if(r != FR_OK){
+            syncStatus(cmd, (uint8_t)r);
+            return;
+        }
+        syncListCount = 0;
+        syncListEnd = false;
+        syncMode = SYNC_LISTING;
+    }else if(cmd == SYNC_CMD_GET){
+        if(len < 5 || !syncGetName(payload + 4, len - 4, name)){
+            syncStatus(cmd, SYNC_RESULT_BAD_CMD);
+            return;
+        }
+        uint32_t offset = getU32(payload);
+        r = f_open(&syncFile, name, FA_READ);
+        if(r == FR_OK && offset > f_size(&syncFile)){
+            f_close(&syncFile);
+            r = FR_INVALID_PARAMETER;
+        }
+        if(r == FR_OK){
+            r = f_lseek(&syncFile, offset);
+        }
+        if(r != FR_OK){
+            syncStatus(cmd, (uint8_t)r);
+            return;
+        }
+        syncMode = SYNC_STREAMING;
+    }else{
+        if(!syncGetName(payload, len, name)){
+            syncStatus(cmd, SYNC_RESULT_BAD_CMD);
+            return;
+        }
+        syncStatus(cmd, (uint8_t)f_unlink(name));
+    }
+}
+
+/*!
+    @brief    Parse the received bytes
+    @details  A packet with a bad CRC is discarded, the client retries after its timeout.
+*/
+static void syncReceive(const uint8_t* data, uint32_t size){
+    uint32_t i;
+    for(i = 0; i < size; ++i){
+        uint8_t c = data[i];
+        switch(syncRxState){
+            case SYNC_RX_SOF0:
+                syncRxState = c == SYNC_SOF0 ? SYNC_RX_SOF1 : SYNC_RX_SOF0;
+                break;
+            case SYNC_RX_SOF1:
+                syncRxState = c == SYNC_SOF1 ? SYNC_RX_TYPE : (c == SYNC_SOF0 ? SYNC_RX_SOF1 : SYNC_RX_SOF0);
+                break;
+            case SYNC_RX_TYPE:
+                syncRxData[0] = c;
+                syncRxState = SYNC_RX_LEN0;
+                break;
+            case SYNC_RX_LEN0:
+                syncRxData[1] = c;
+                syncRxState = SYNC_RX_LEN1;
+                break;
+            case SYNC_RX_LEN1:
+                syncRxData[2] = c;
+                syncRxLen = syncRxData[1] | ((uint16_t)c << 8);
+                syncRxCount = 0;
+                if(syncRxLen > SYNC_MAX_CMD_PAYLOAD){
+                    syncStatus(syncRxData[0], SYNC_RESULT_BAD_CMD);
+                    syncRxState = SYNC_RX_SOF0;
+                }else{
+                    syncRxState = syncRxLen != 0 ? SYNC_RX_PAYLOAD : SYNC_RX_CRC0;
+                }
+                break;
+            case SYNC_RX_PAYLOAD:
+                syncRxData[3 + syncRxCount++] = c;
+                if(syncRxCount == syncRxLen){
+                    syncRxState = SYNC_RX_CRC0;
+                }
+                break;
+            case SYNC_RX_CRC0:
+                syncRxCrc = c;
+                syncRxState = SYNC_RX_CRC1;
+                break;
+            case SYNC_RX_CRC1:
+                syncRxCrc |= (uint16_t)c << 8;
+                if(syncRxCrc == telemCrc16(syncRxData, 3 + syncRxLen)){
+                    syncExecute(syncRxData[0], &syncRxData[3], syncRxLen);
+                }
+                syncRxState = SYNC_RX_SOF0;
+                break;
+        }
+    }
+}
+
+/*!
+    @brief    Initialize the sync service
+    @details  On the target the UART SYNC_UART must be already initialized.
+*/
+void syncInit(void){
+    memset(syncTx, 0, sizeof(syncTx));
+    syncFillIndex = 0;
+    syncSendIndex = 0;
+    syncDmaRunning = false;
+    syncRxState = SYNC_RX_SOF0;
+    syncMode = SYNC_IDLE;
+    syncBusy = false;
+    syncStatusPending = false;
+    syncPortInit();
+}
+
+/*!
+    @brief    Enable or disable the commands that access the SD card
+    @details  Set while a ride is being recorded, a running list or transfer is stopped and the client
+              receives a BUSY status.
+    @param    busy: true to refuse the SD card commands
+*/
+void syncSetBusy(bool busy){
+    if(busy && syncMode != SYNC_IDLE){
+        syncStatus(syncMode == SYNC_STREAMING ? SYNC_CMD_GET : SYNC_CMD_LIST, SYNC_RESULT_BUSY);
+        syncStop();
+        schedPostEvent(SCHED_EVENT_SYNC);
+    }
+    syncBusy = busy;
+}
+
+/*!
+    @brief    Sync task body
+    @details  Runs on SCHED_EVENT_SYNC, posted by the UART RX and at the end of every DMA transfer:
+              executes the received commands and fills the free packet buffers.
+*/
+void syncProcess(void){
+    uint8_t rx[16];
+    uint32_t n;
+    uint8_t* payload;
+
+    while((n = syncPortRead(rx, sizeof(rx))) != 0){
+        syncReceive(rx, n);
+    }
+
+    while((syncStatusPending || syncMode != SYNC_IDLE) && (payload = syncBeginPacket()) != NULL){
+        if(syncStatusPending){
+            syncStatusPending = false;
+            payload[0] = syncStatusCmd;
+            payload[1] = syncStatusResult;
+            syncEndPacket(SYNC_REPLY_STATUS, 2);
+        }else if(syncMode == SYNC_LISTING){
+            syncFillList(payload);
+        }else{
+            syncFillData(payload);
+        }
+        syncPortSend();
+    }
+}
+
+/*! @} */ // Sync_Module
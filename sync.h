@@ -0,0 +1,79 @@
+/*!
+    @file       sync.h
+    @ingroup    Sync_Module
+    @brief      Export of the stored rides to a phone on a serial link
+    @details    File transfer service on EUSCI_A3 (P9.6 RX, P9.7 TX), bridged to the phone by a
+                BLE-serial module; Test/syncClient.py is the reference client.
+                Every packet, in both directions, is
+                @code
+                    0xA5 0x5A type[1] len[2] payload[len] crc[2]
+                @endcode
+                all the fields little endian, the CRC is CRC-16/CCITT-FALSE of type, len and payload
+                (see @ref telemCrc16).
+                The rides are the *.gpx files in the root directory of the SD card: the directory is
+                the ride index and a ride is addressed by its 8.3 name.
+                A ride is streamed in DATA packets of up to @ref SYNC_CHUNK_SIZE bytes aligned to the
+                sectors, so FatFs reads the sectors straight into the packet buffer, and the packet
+                is sent by the DMA while the next one is read. A transfer interrupted by the link is
+                resumed with a GET from the offset of the first missing byte.
+                The commands that touch the SD card are refused with @ref SYNC_RESULT_BUSY while a
+                ride is being recorded.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __SYNC_H__
+#define __SYNC_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+    @defgroup   Sync_Module Sync
+    @name       Sync Module
+    @{
+*/
+
+#define SYNC_UART               EUSCI_A3_BASE   //!< UART of the BLE-serial module
+#define SYNC_DMA_CHANNEL        6               //!< DMA channel of EUSCI_A3 TX
+
+#define SYNC_SOF0               0xA5            //!< First start of frame byte
+#define SYNC_SOF1               0x5A            //!< Second start of frame byte
+#define SYNC_HEADER_LEN         5               //!< SOF + type + len
+#define SYNC_CRC_LEN            2
+#define SYNC_CHUNK_SIZE         512             //!< Data bytes of a DATA packet, one sector
+#define SYNC_MAX_PAYLOAD        (4 + SYNC_CHUNK_SIZE)   //!< Longest payload sent (DATA)
+#define SYNC_MAX_CMD_PAYLOAD    32              //!< Longest payload received
+#define SYNC_NAME_LEN           13              //!< 8.3 name with the terminator
+#define SYNC_LIST_ENTRY_LEN     (4 + 2 + 2 + SYNC_NAME_LEN)
+#define SYNC_LIST_MAX_ENTRIES   24              //!< Entries of a LIST packet
+
+//! Packet types, the values are part of the protocol
+typedef enum{
+    SYNC_CMD_LIST = 0x01,       //!< List the rides, no payload
+    SYNC_CMD_GET = 0x02,        //!< Stream a ride: uint32 offset, name
+    SYNC_CMD_DELETE = 0x03,     //!< Delete a ride: name
+    SYNC_CMD_ABORT = 0x04,      //!< Stop the running list or transfer, no payload
+    SYNC_REPLY_LIST = 0x81,     //!< Entries of uint32 size, uint16 FAT date, uint16 FAT time, char name[13]
+    SYNC_REPLY_LIST_END = 0x82, //!< uint16 number of rides
+    SYNC_REPLY_DATA = 0x83,     //!< uint32 offset, data
+    SYNC_REPLY_DATA_END = 0x84, //!< uint32 size of the ride
+    SYNC_REPLY_STATUS = 0x85,   //!< uint8 command, uint8 result
+} SyncPacket_t;
+
+//! Results of the STATUS reply besides the FatFs FRESULT codes
+#define SYNC_RESULT_BUSY        0xFE    //!< A ride is being recorded
+#define SYNC_RESULT_BAD_CMD     0xFF    //!< Unknown or malformed command
+
+void syncInit(void);
+void syncSetBusy(bool busy);
+void syncProcess(void);
+
+#ifdef SIMULATE_HARDWARE
+void syncSetHostFd(int fd);
+#endif
+
+/*! @} */ //End of Sync_Module
+
+#endif // __SYNC_H__
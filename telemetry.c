@@ -0,0 +1,429 @@
+/*!
+    @file       telemetry.c
+    @ingroup    Telemetry_Module
+    @brief      Binary live telemetry implementation
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef SIMULATE_HARDWARE
+/* Driver Includes */
+#include <Hardware/UART_Driver.h>
+#include <Hardware/SWTIMER_Driver.h>
+#else
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Local Includes */
+#include "telemetry.h"
+
+/*!
+    @addtogroup Telemetry_Module
+    @{
+*/
+
+//! Default periods [ms], 0 disables a message
+static const uint16_t telemDefaultPeriod[TELEM_NUM_MSG] = {
+    [TELEM_MSG_FIX]         = 1000,
+    [TELEM_MSG_SPEED]       = 20,
+    [TELEM_MSG_WHEEL]       = 100,
+    [TELEM_MSG_BSS]         = 20,
+    [TELEM_MSG_LIGHT]       = 1000,
+    [TELEM_MSG_TEMP]        = 1000,
+    [TELEM_MSG_PROFILER]    = 200,
+    [TELEM_MSG_ATTITUDE]    = 200,
+};
+
+static uint16_t telemPeriod[TELEM_NUM_MSG];     //!< Period of every message [ms]
+static uint32_t telemNext[TELEM_NUM_MSG];       //!< Time of the next send of every message [ms]
+static uint8_t telemSeq;                        //!< Sequence number, to detect the lost frames
+static uint32_t telemDrops;                     //!< Frames not sent because the TX ring was full
+static bool telemEnabled;                       //!< Stream on/off
+
+/* ------------------------------------------------------------------------------------------------
+    Hardware dependent part
+   ------------------------------------------------------------------------------------------------ */
+#ifndef SIMULATE_HARDWARE
+
+/*!
+    @brief    Time of the messages
+    @return   milliseconds from the software timers time base
+*/
+static uint32_t telemNowMs(void){
+    return (uint32_t)(((uint64_t)SWTIMER_Now() * 1000u) / SWTIMER_TICK_HZ);
+}
+
+//! Room for a frame: a frame cut by a full ring would be joined by the decoder with the next one
+static size_t telemTxFree(void){
+    return UART_TxFree(EUSCI_A0_BASE);
+}
+
+static void telemWrite(const uint8_t* data, size_t len){
+    UART_Write(EUSCI_A0_BASE, (uint8_t*)data, len);
+}
+
+#else
+
+static int telemHostFd = STDOUT_FILENO;         //!< Destination of the frames on the host
+
+/*!
+    @brief    Redirect the frames, e.g. to a pseudo terminal read by Test/telemetry.py
+    @param    fd: file descriptor
+*/
+void telemSetHostFd(int fd){
+    telemHostFd = fd;
+}
+
+static uint32_t telemNowMs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + ts.tv_nsec / 1000000);
+}
+
+static size_t telemTxFree(void){
+    return SIZE_MAX;
+}
+
+static void telemWrite(const uint8_t* data, size_t len){
+    if(write(telemHostFd, data, len) < 0){
+        //Dropped like on a full TX ring
+    }
+}
+
+#endif
+
+/* ------------------------------------------------------------------------------------------------
+    Framing
+   ------------------------------------------------------------------------------------------------ */
+
+/*!
+    @brief    CRC-16/CCITT-FALSE
+    @param    data: bytes to check
+    @param    len: number of bytes
+    @return   CRC (poly 0x1021, init 0xFFFF, no reflection, no final xor)
+*/
+uint16_t telemCrc16(const uint8_t* data, size_t len){
+    uint16_t crc = 0xFFFF;
+    uint8_t bit;
+    while(len-- > 0){
+        crc ^= (uint16_t)(*data++) << 8;
+        for(bit = 0; bit < 8; ++bit){
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*!
+    @brief    COBS encoding
+    @details  Every zero is replaced by the distance to the next one, the first byte is the distance
+              to the first zero. The delimiter is not added.
+    @param    in: bytes to encode
+    @param    len: number of bytes
+    @param    out: encoded bytes, at least len + len / 254 + 1 bytes
+    @return   number of encoded bytes
+*/
+size_t telemCobsEncode(const uint8_t* in, size_t len, uint8_t* out){
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+    size_t i;
+    for(i = 0; i < len; ++i){
+        if(in[i] == 0){
+            out[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+        }else{
+            out[outIndex++] = in[i];
+            code++;
+            if(code == 0xFF){
+                out[codeIndex] = code;
+                codeIndex = outIndex++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+//! Little endian writers, return the position after the field
+static uint8_t* put16(uint8_t* p, uint16_t value){
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t value){
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+//! Convert a float with a scale factor, saturating to the int32 range
+static int32_t scaleToInt(float value, float scale){
+    float scaled = value * scale;
+    if(!(scaled > -2147483648.0f)){
+        return INT32_MIN;
+    }
+    if(scaled >= 2147483648.0f){
+        return INT32_MAX;
+    }
+    return (int32_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+//! Same as scaleToInt, saturating to the uint16/int16 ranges
+static uint16_t scaleToU16(float value, float scale){
+    int32_t v = scaleToInt(value, scale);
+    return v < 0 ? 0 : (v > 0xFFFF ? 0xFFFF : (uint16_t)v);
+}
+
+static uint16_t scaleToI16(float value, float scale){
+    int32_t v = scaleToInt(value, scale);
+    return (uint16_t)(int16_t)(v < INT16_MIN ? INT16_MIN : (v > INT16_MAX ? INT16_MAX : v));
+}
+
+/*!
+    @brief    Frame and send a message
+    @details  The frame is written whole or not at all: if the TX ring has no room for it, it is
+              dropped and counted. Its sequence number is used anyway, so the receiver counts it
+              as lost.
+    @param    type: message type
+    @param    body: payload of the message
+    @param    len: length of the payload (max @ref TELEM_MAX_BODY)
+*/
+static void telemSend(TelemMsg_t type, const uint8_t* body, uint8_t len){
+    uint8_t raw[TELEM_HEADER_LEN + TELEM_MAX_BODY + TELEM_CRC_LEN];
+    uint8_t frame[TELEM_MAX_FRAME];
+    uint8_t* p = raw;
+    uint8_t i;
+    size_t n;
+
+    if(!telemEnabled || len > TELEM_MAX_BODY){
+        return;
+    }
+    *p++ = (uint8_t)type;
+    *p++ = telemSeq++;
+    p = put32(p, telemNowMs());
+    for(i = 0; i < len; ++i){
+        *p++ = body[i];
+    }
+    p = put16(p, telemCrc16(raw, p - raw));
+
+    n = telemCobsEncode(raw, p - raw, frame);
+    frame[n++] = 0;
+    if(telemTxFree() < n){
+        telemDrops++;
+        return;
+    }
+    telemWrite(frame, n);
+}
+
+/* ------------------------------------------------------------------------------------------------
+    Rates
+   ------------------------------------------------------------------------------------------------ */
+
+/*!
+    @brief    Initialize the periods to the defaults, the stream starts disabled
+*/
+void telemInit(void){
+    uint8_t i;
+    for(i = 0; i < TELEM_NUM_MSG; ++i){
+        telemPeriod[i] = telemDefaultPeriod[i];
+        telemNext[i] = 0;
+    }
+    telemSeq = 0;
+    telemDrops = 0;
+    telemEnabled = false;
+}
+
+/*!
+    @brief    Start or stop the stream
+    @param    enable: true to start
+*/
+void telemEnable(bool enable){
+    uint8_t i;
+    uint32_t now = telemNowMs();
+    for(i = 0; i < TELEM_NUM_MSG; ++i){
+        telemNext[i] = now;
+    }
+    telemEnabled = enable;
+}
+
+/*!
+    @brief    Check if the stream is enabled
+    @return   true if the messages are sent
+*/
+bool telemIsEnabled(void){
+    return telemEnabled;
+}
+
+/*!
+    @brief    Frames dropped because the TX ring was full
+    @return   number of frames since the init
+*/
+uint32_t telemGetDrops(void){
+    return telemDrops;
+}
+
+/*!
+    @brief    Set the period of a message
+    @param    msg: message type
+    @param    periodMs: period, rounded up to @ref TELEM_TICK_MS by the task; 0 disables the message
+*/
+void telemSetPeriod(TelemMsg_t msg, uint16_t periodMs){
+    if(msg < TELEM_NUM_MSG){
+        telemPeriod[msg] = periodMs;
+    }
+}
+
+/*!
+    @brief    Check if a message must be sent now
+    @details  When it returns true the next send is scheduled one period later; if the task has been
+              late for more than a period the missed sends are skipped.
+    @param    msg: message type
+    @return   true if the stream is enabled and the period of the message has elapsed
+*/
+bool telemIsDue(TelemMsg_t msg){
+    if(!telemEnabled || msg >= TELEM_NUM_MSG || telemPeriod[msg] == 0){
+        return false;
+    }
+    uint32_t now = telemNowMs();
+    if((int32_t)(now - telemNext[msg]) < 0){
+        return false;
+    }
+    telemNext[msg] += telemPeriod[msg];
+    if((int32_t)(now - telemNext[msg]) >= 0){
+        telemNext[msg] = now + telemPeriod[msg];
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------------------------------------
+    Messages
+   ------------------------------------------------------------------------------------------------ */
+
+/*!
+    @brief    Send the position
+    @param    latitude: degrees, negative for S
+    @param    longitude: degrees, negative for W
+    @param    altitude: meters
+    @param    sats: satellites used
+    @param    fix: GGA fix type
+    @param    hdop: horizontal dilution of precision
+*/
+void telemSendFix(float latitude, float longitude, float altitude, uint8_t sats, uint8_t fix, float hdop){
+    uint8_t body[16];
+    uint8_t* p = body;
+    p = put32(p, (uint32_t)scaleToInt(latitude, 1e7f));
+    p = put32(p, (uint32_t)scaleToInt(longitude, 1e7f));
+    p = put32(p, (uint32_t)scaleToInt(altitude, 100.0f));
+    *p++ = sats;
+    *p++ = fix;
+    p = put16(p, scaleToU16(hdop, 100.0f));
+    telemSend(TELEM_MSG_FIX, body, p - body);
+}
+
+/*!
+    @brief    Send the speed and the distance
+    @param    wheelSpeed: speed from the wheel sensor [km/h]
+    @param    gpsSpeed: speed from the GPS [km/h]
+    @param    distance: distance covered [km]
+*/
+void telemSendSpeed(float wheelSpeed, float gpsSpeed, float distance){
+    uint8_t body[8];
+    uint8_t* p = body;
+    p = put16(p, scaleToU16(wheelSpeed, 100.0f));
+    p = put16(p, scaleToU16(gpsSpeed, 100.0f));
+    p = put32(p, (uint32_t)scaleToInt(distance, 1000.0f));
+    telemSend(TELEM_MSG_SPEED, body, p - body);
+}
+
+/*!
+    @brief    Send the wheel revolutions counter
+    @param    revolutions: revolutions since the start
+*/
+void telemSendWheel(uint32_t revolutions){
+    uint8_t body[4];
+    put32(body, revolutions);
+    telemSend(TELEM_MSG_WHEEL, body, sizeof(body));
+}
+
+/*!
+    @brief    Send the BSS state
+    @param    bssClass: class_t of the BSS model
+    @param    averageAcc: average acceleration of the last window [g]
+*/
+void telemSendBss(uint8_t bssClass, float averageAcc){
+    uint8_t body[3];
+    body[0] = bssClass;
+    put16(&body[1], scaleToI16(averageAcc, 1000.0f));
+    telemSend(TELEM_MSG_BSS, body, sizeof(body));
+}
+
+/*!
+    @brief    Send the ambient light
+    @param    light: light scaled from 0 to 1
+*/
+void telemSendLight(float light){
+    uint8_t body[2];
+    put16(body, scaleToU16(light, 1000.0f));
+    telemSend(TELEM_MSG_LIGHT, body, sizeof(body));
+}
+
+/*!
+    @brief    Send the temperature
+    @param    temp: degrees Celsius
+*/
+void telemSendTemp(float temp){
+    uint8_t body[2];
+    put16(body, scaleToI16(temp, 100.0f));
+    telemSend(TELEM_MSG_TEMP, body, sizeof(body));
+}
+
+/*!
+    @brief    Send the attitude of the bike
+    @param    roll: lean angle, positive leaning right [deg]
+    @param    pitch: positive nose up [deg]
+    @param    yawRate: positive turning right [deg/s]
+    @param    grade: grade of the GPS altitude [%], to cross-check the pitch
+*/
+void telemSendAttitude(float roll, float pitch, float yawRate, float grade){
+    uint8_t body[8];
+    uint8_t* p = body;
+    p = put16(p, scaleToI16(roll, 100.0f));
+    p = put16(p, scaleToI16(pitch, 100.0f));
+    p = put16(p, scaleToI16(yawRate, 100.0f));
+    p = put16(p, scaleToI16(grade, 100.0f));
+    telemSend(TELEM_MSG_ATTITUDE, body, p - body);
+}
+
+/*!
+    @brief    Send the counters of a profiler region
+    @param    region: ProfRegion_t
+    @param    count: number of measures
+    @param    min: shortest measure [ticks]
+    @param    mean: mean [ticks]
+    @param    max: longest measure [ticks]
+*/
+void telemSendProfiler(uint8_t region, uint32_t count, uint32_t min, uint32_t mean, uint32_t max){
+    uint8_t body[17];
+    uint8_t* p = body;
+    *p++ = region;
+    p = put32(p, count);
+    p = put32(p, min);
+    p = put32(p, mean);
+    p = put32(p, max);
+    telemSend(TELEM_MSG_PROFILER, body, p - body);
+}
+
+/*! @} */ // Telemetry_Module
@@ -0,0 +1,80 @@
+/*!
+    @file       telemetry.h
+    @ingroup    Telemetry_Module
+    @brief      Binary live telemetry on the PC UART
+    @details    Compact binary messages sent on EUSCI_A0 instead of formatted text, decoded on the PC
+                by Test/telemetry.py.
+                Every message is framed as
+                @code
+                    COBS( type[1] seq[1] timeMs[4] body[n] crc[2] ) 0x00
+                @endcode
+                all the fields little endian. The CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+                of type, seq, timeMs and body. The COBS encoding removes the zeros, so 0x00 only
+                delimits the frames and the decoder resynchronizes on the next one after any error;
+                text printed on the same UART is discarded as frames with a bad CRC.
+                Every message type has its own period, the task calls @ref telemIsDue to know which
+                messages to send.
+    @date       19/10/2026
+    @author     Alan Masutti
+*/
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    @defgroup   Telemetry_Module Telemetry
+    @name       Telemetry Module
+    @{
+*/
+
+#define TELEM_TICK_MS           10          //!< Period of the telemetry task, shortest period of a message
+#define TELEM_MAX_BODY          24          //!< Longest body of a message
+#define TELEM_HEADER_LEN        6           //!< type + seq + timeMs
+#define TELEM_CRC_LEN           2
+//! Longest encoded frame: COBS overhead of 1 byte (frames under 254 bytes) plus the delimiter
+#define TELEM_MAX_FRAME         (TELEM_HEADER_LEN + TELEM_MAX_BODY + TELEM_CRC_LEN + 2)
+
+//! Message types, the values are part of the protocol
+typedef enum{
+    TELEM_MSG_FIX = 1,          //!< int32 lat, int32 lon [1e-7 deg], int32 altitude [cm], uint8 sats, uint8 fix, uint16 hdop [x100]
+    TELEM_MSG_SPEED = 2,        //!< uint16 wheel speed, uint16 GPS speed [km/h x100], uint32 distance [m]
+    TELEM_MSG_WHEEL = 3,        //!< uint32 wheel revolutions, the rate (cadence of the wheel) is computed by the receiver
+    TELEM_MSG_BSS = 4,          //!< uint8 class, int16 average acceleration [mg]
+    TELEM_MSG_LIGHT = 5,        //!< uint16 ambient light [permille]
+    TELEM_MSG_TEMP = 6,         //!< int16 temperature [degC x100]
+    TELEM_MSG_PROFILER = 7,     //!< uint8 region, uint32 count, uint32 min, uint32 mean, uint32 max [ticks, PROF_TICKS_PER_US per us]
+    TELEM_MSG_ATTITUDE = 8,     //!< int16 roll, int16 pitch [deg x100], int16 yaw rate [deg/s x100], int16 GPS grade [% x100]
+    TELEM_NUM_MSG
+} TelemMsg_t;
+
+void telemInit(void);
+void telemEnable(bool enable);
+bool telemIsEnabled(void);
+uint32_t telemGetDrops(void);
+void telemSetPeriod(TelemMsg_t msg, uint16_t periodMs);
+bool telemIsDue(TelemMsg_t msg);
+
+void telemSendFix(float latitude, float longitude, float altitude, uint8_t sats, uint8_t fix, float hdop);
+void telemSendSpeed(float wheelSpeed, float gpsSpeed, float distance);
+void telemSendWheel(uint32_t revolutions);
+void telemSendBss(uint8_t bssClass, float averageAcc);
+void telemSendLight(float light);
+void telemSendTemp(float temp);
+void telemSendAttitude(float roll, float pitch, float yawRate, float grade);
+void telemSendProfiler(uint8_t region, uint32_t count, uint32_t min, uint32_t mean, uint32_t max);
+
+uint16_t telemCrc16(const uint8_t* data, size_t len);
+size_t telemCobsEncode(const uint8_t* in, size_t len, uint8_t* out);
+
+#ifdef SIMULATE_HARDWARE
+void telemSetHostFd(int fd);
+#endif
+
+/*! @} */ //End of Telemetry_Module
+
+#endif // __TELEMETRY_H__